@@ -0,0 +1,579 @@
+#include "BezierPatch.h"
+#include <algorithm>
+#include <cmath>
+#include "Common/ParallelFor.h"
+
+#ifdef BEZIER_PATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace HLSL;
+
+const float PotteryControlPoints[PotteryControlPointCount][3] =
+{
+	// Handle
+	{ -1.6f, 0.0f, 2.025f }, { -1.6f, -0.3f, 2.025f },
+	{ -1.5f, -0.3f, 2.25f }, { -1.5f, 0.0f, 2.25f },
+	{ -2.3f, 0.0f, 2.025f }, { -2.3f, -0.3f, 2.025f },
+	{ -2.5f, -0.3f, 2.25f }, { -2.5f, 0.0f, 2.25f },
+	{ -2.7f, 0.0f, 2.025f }, { -2.7f, -0.3f, 2.025f },
+	{ -3.0f, -0.3f, 2.25f }, { -3.0f, 0.0f, 2.25f },
+	{ -2.7f, 0.0f, 1.8f }, { -2.7f, -0.3f, 1.8f },
+	{ -3.0f, -0.3f, 1.8f }, { -3.0f, 0.0f, 1.8f },
+	{ -2.7f, 0.0f, 1.575f }, { -2.7f, -0.3f, 1.575f },
+	{ -3.0f, -0.3f, 1.35f }, { -3.0f, 0.0f, 1.35f },
+	{ -2.5f, 0.0f, 1.125f }, { -2.5f, -0.3f, 1.125f },
+	{ -2.65f, -0.3f, 0.9375f }, { -2.65f, 0.0f, 0.9375f },
+	{ -2.0f, 0.0f, 0.9f }, { -2.0f, -0.3f, 0.9f },
+	{ -1.9f, -0.3f, 0.6f }, { -1.9f, 0.0f, 0.6f },
+
+	{ -1.6f, 0.0f, 2.025f }, { -1.6f, 0.3f, 2.025f },
+	{ -1.5f, 0.3f, 2.25f }, { -1.5f, 0.0f, 2.25f },
+	{ -2.3f, 0.0f, 2.025f }, { -2.3f, 0.3f, 2.025f },
+	{ -2.5f, 0.3f, 2.25f }, { -2.5f, 0.0f, 2.25f },
+	{ -2.7f, 0.0f, 2.025f }, { -2.7f, 0.3f, 2.025f },
+	{ -3.0f, 0.3f, 2.25f }, { -3.0f, 0.0f, 2.25f },
+	{ -2.7f, 0.0f, 1.8f }, { -2.7f, 0.3f, 1.8f },
+	{ -3.0f, 0.3f, 1.8f }, { -3.0f, 0.0f, 1.8f },
+	{ -2.7f, 0.0f, 1.575f }, { -2.7f, 0.3f, 1.575f },
+	{ -3.0f, 0.3f, 1.35f }, { -3.0f, 0.0f, 1.35f },
+	{ -2.5f, 0.0f, 1.125f }, { -2.5f, 0.3f, 1.125f },
+	{ -2.65f, 0.3f, 0.9375f }, { -2.65f, 0.0f, 0.9375f },
+	{ -2.0f, 0.0f, 0.9f }, { -2.0f, 0.3f, 0.9f },
+	{ -1.9f, 0.3f, 0.6f }, { -1.9f, 0.0f, 0.6f },
+
+	// Body
+	{ 1.5f, 0.0f, 2.4f }, { 1.5f, -0.84f, 2.4f },
+	{ 0.84f, -1.5f, 2.4f }, { 0.0f, -1.5f, 2.4f },
+	{ 1.75f, 0.0f, 1.875f }, { 1.75f, -0.98f, 1.875f },
+	{ 0.98f, -1.75f, 1.875f }, { 0.0f, -1.75f, 1.875f },
+	{ 2.0f, 0.0f, 1.35f }, { 2.0f, -1.12f, 1.35f },
+	{ 1.12f, -2.0f, 1.35f }, { 0.0f, -2.0f, 1.35f },
+	{ 2.0f, 0.0f, 0.9f }, { 2.0f, -1.12f, 0.9f },
+	{ 1.12f, -2.0f, 0.9f }, { 0.0f, -2.0f, 0.9f },
+	{ 2.0f, 0.0f, 0.45f }, { 2.0f, -1.12f, 0.45f },
+	{ 1.12f, -2.0f, 0.45f }, { 0.0f, -2.0f, 0.45f },
+	{ 1.5f, 0.0f, 0.225f }, { 1.5f, -0.84f, 0.225f },
+	{ 0.84f, -1.5f, 0.225f }, { 0.0f, -1.5f, 0.225f },
+	{ 1.5f, 0.0f, 0.15f }, { 1.5f, -0.84f, 0.15f },
+	{ 0.84f, -1.5f, 0.15f }, { 0.0f, -1.5f, 0.15f },
+
+	{ 1.5f, 0.0f, 2.4f }, { 1.5f, 0.84f, 2.4f },
+	{ 0.84f, 1.5f, 2.4f }, { 0.0f, 1.5f, 2.4f },
+	{ 1.75f, 0.0f, 1.875f }, { 1.75f, 0.98f, 1.875f },
+	{ 0.98f, 1.75f, 1.875f }, { 0.0f, 1.75f, 1.875f },
+	{ 2.0f, 0.0f, 1.35f }, { 2.0f, 1.12f, 1.35f },
+	{ 1.12f, 2.0f, 1.35f }, { 0.0f, 2.0f, 1.35f },
+	{ 2.0f, 0.0f, 0.9f }, { 2.0f, 1.12f, 0.9f },
+	{ 1.12f, 2.0f, 0.9f }, { 0.0f, 2.0f, 0.9f },
+	{ 2.0f, 0.0f, 0.45f }, { 2.0f, 1.12f, 0.45f },
+	{ 1.12f, 2.0f, 0.45f }, { 0.0f, 2.0f, 0.45f },
+	{ 1.5f, 0.0f, 0.225f }, { 1.5f, 0.84f, 0.225f },
+	{ 0.84f, 1.5f, 0.225f }, { 0.0f, 1.5f, 0.225f },
+	{ 1.5f, 0.0f, 0.15f }, { 1.5f, 0.84f, 0.15f },
+	{ 0.84f, 1.5f, 0.15f }, { 0.0f, 1.5f, 0.15f },
+
+	{ -1.5f, 0.0f, 2.4f }, { -1.5f, -0.84f, 2.4f },
+	{ -0.84f, -1.5f, 2.4f }, { 0.0f, -1.5f, 2.4f },
+	{ -1.75f, 0.0f, 1.875f }, { -1.75f, -0.98f, 1.875f },
+	{ -0.98f, -1.75f, 1.875f }, { 0.0f, -1.75f, 1.875f },
+	{ -2.0f, 0.0f, 1.35f }, { -2.0f, -1.12f, 1.35f },
+	{ -1.12f, -2.0f, 1.35f }, { 0.0f, -2.0f, 1.35f },
+	{ -2.0f, 0.0f, 0.9f }, { -2.0f, -1.12f, 0.9f },
+	{ -1.12f, -2.0f, 0.9f }, { 0.0f, -2.0f, 0.9f },
+	{ -2.0f, 0.0f, 0.45f }, { -2.0f, -1.12f, 0.45f },
+	{ -1.12f, -2.0f, 0.45f }, { 0.0f, -2.0f, 0.45f },
+	{ -1.5f, 0.0f, 0.225f }, { -1.5f, -0.84f, 0.225f },
+	{ -0.84f, -1.5f, 0.225f }, { 0.0f, -1.5f, 0.225f },
+	{ -1.5f, 0.0f, 0.15f }, { -1.5f, -0.84f, 0.15f },
+	{ -0.84f, -1.5f, 0.15f }, { 0.0f, -1.5f, 0.15f },
+
+	{ -1.5f, 0.0f, 2.4f }, { -1.5f, 0.84f, 2.4f },
+	{ -0.84f, 1.5f, 2.4f }, { 0.0f, 1.5f, 2.4f },
+	{ -1.75f, 0.0f, 1.875f }, { -1.75f, 0.98f, 1.875f },
+	{ -0.98f, 1.75f, 1.875f }, { 0.0f, 1.75f, 1.875f },
+	{ -2.0f, 0.0f, 1.35f }, { -2.0f, 1.12f, 1.35f },
+	{ -1.12f, 2.0f, 1.35f }, { 0.0f, 2.0f, 1.35f },
+	{ -2.0f, 0.0f, 0.9f }, { -2.0f, 1.12f, 0.9f },
+	{ -1.12f, 2.0f, 0.9f }, { 0.0f, 2.0f, 0.9f },
+	{ -2.0f, 0.0f, 0.45f }, { -2.0f, 1.12f, 0.45f },
+	{ -1.12f, 2.0f, 0.45f }, { 0.0f, 2.0f, 0.45f },
+	{ -1.5f, 0.0f, 0.225f }, { -1.5f, 0.84f, 0.225f },
+	{ -0.84f, 1.5f, 0.225f }, { 0.0f, 1.5f, 0.225f },
+	{ -1.5f, 0.0f, 0.15f }, { -1.5f, 0.84f, 0.15f },
+	{ -0.84f, 1.5f, 0.15f }, { 0.0f, 1.5f, 0.15f },
+};
+
+const unsigned int PotteryPatchIndices[PotteryPatchCount * 16] =
+{
+	// Handle
+	0, 1, 2, 3, 4, 5, 6, 7,
+	8, 9, 10, 11, 12, 13, 14, 15,
+	12, 13, 14, 15, 16, 17, 18, 19,
+	20, 21, 22, 23, 24, 25, 26, 27,
+
+	28, 29, 30, 31, 32, 33, 34, 35,
+	36, 37, 38, 39, 40, 41, 42, 43,
+	40, 41, 42, 43, 44, 45, 46, 47,
+	48, 49, 50, 51, 52, 53, 54, 55,
+
+	// Body
+	56, 57, 58, 59, 60, 61, 62, 63,
+	64, 65, 66, 67, 68, 69, 70, 71,
+	68, 69, 70, 71, 72, 73, 74, 75,
+	76, 77, 78, 79, 80, 81, 82, 83,
+
+	84, 85, 86, 87, 88, 89, 90, 91,
+	92, 93, 94, 95, 96, 97, 98, 99,
+	96, 97, 98, 99, 100, 101, 102, 103,
+	104, 105, 106, 107, 108, 109, 110, 111,
+
+	112, 113, 114, 115, 116, 117, 118, 119,
+	120, 121, 122, 123, 124, 125, 126, 127,
+	124, 125, 126, 127, 128, 129, 130, 131,
+	132, 133, 134, 135, 136, 137, 138, 139,
+
+	140, 141, 142, 143, 144, 145, 146, 147,
+	148, 149, 150, 151, 152, 153, 154, 155,
+	152, 153, 154, 155, 156, 157, 158, 159,
+	160, 161, 162, 163, 164, 165, 166, 167,
+};
+
+void GetPotteryPatches(std::vector<BezierPatch>& patches)
+{
+	patches.resize(PotteryPatchCount);
+	for (auto patch = 0; patch < PotteryPatchCount; patch++)
+	{
+		for (auto point = 0; point < 16; point++)
+		{
+			const auto* position = PotteryControlPoints[PotteryPatchIndices[patch * 16 + point]];
+			patches[patch].points[point] = float3(position[0], position[1], position[2]);
+		}
+	}
+}
+
+namespace
+{
+	// Cross products shorter than this fraction of their partials' lengths are taken as no
+	// normal, where a row of control points collapses to a point
+	const float DegenerateNormal = 1e-12f;
+
+	// DS_Pottery's
+	float4 BernsteinBasis(float t)
+	{
+		const auto invT = 1.0f - t;
+		return float4(invT * invT * invT, 3.0f * t * invT * invT, 3.0f * t * t * invT, t * t * t);
+	}
+
+	float4 BernsteinDerivative(float t)
+	{
+		const auto invT = 1.0f - t;
+		return float4(-3.0f * invT * invT, 3.0f * invT * invT - 6.0f * t * invT, 6.0f * t * invT - 3.0f * t * t, 3.0f * t * t);
+	}
+
+	float3 Sum4(const float3& a, const float3& b, const float3& c, const float3& d, const float4& weights)
+	{
+		return a * weights.x + b * weights.y + c * weights.z + d * weights.w;
+	}
+
+	// DS_Pottery's EvaluateBezier
+	float3 EvaluateBezier(const float3* points, const float4& basisU, const float4& basisV)
+	{
+		auto value = basisV.x * Sum4(points[0], points[1], points[2], points[3], basisU);
+		value += basisV.y * Sum4(points[4], points[5], points[6], points[7], basisU);
+		value += basisV.z * Sum4(points[8], points[9], points[10], points[11], basisU);
+		value += basisV.w * Sum4(points[12], points[13], points[14], points[15], basisU);
+		return value;
+	}
+
+	// Where the partials are parallel or one is zero, the normal a little way in toward the
+	// middle of the patch
+	float3 DegenerateVertexNormal(const BezierPatch& patch, const float2& uv)
+	{
+		const auto u = uv.x + (0.5f - uv.x) * 1e-3f;
+		const auto v = uv.y + (0.5f - uv.y) * 1e-3f;
+		const auto normal = cross(EvaluateBezier(patch.points, BernsteinDerivative(u), BernsteinBasis(v)),
+			EvaluateBezier(patch.points, BernsteinBasis(u), BernsteinDerivative(v)));
+		const auto lengthSquared = dot(normal, normal);
+		return lengthSquared > 0.0f ? normal / std::sqrt(lengthSquared) : float3(0.0f);
+	}
+
+	// The SSE2 path does the same operations in the same order
+	void FinishVertex(const BezierPatch& patch, BezierVertex& vertex)
+	{
+		const auto normal = cross(vertex.tangent, vertex.bitangent);
+		const auto lengthSquared = dot(normal, normal);
+		if (lengthSquared > DegenerateNormal * dot(vertex.tangent, vertex.tangent) * dot(vertex.bitangent, vertex.bitangent))
+		{
+			vertex.normal = normal / std::sqrt(lengthSquared);
+		}
+		else vertex.normal = DegenerateVertexNormal(patch, vertex.uv);
+	}
+
+	void WriteGridIndices(int segments, std::uint32_t vertexStart, std::uint32_t* indices)
+	{
+		const auto rowLength = static_cast<std::uint32_t>(segments + 1);
+		for (auto row = 0; row < segments; row++)
+		{
+			for (auto column = 0; column < segments; column++)
+			{
+				const auto corner = vertexStart + row * rowLength + column;
+				*indices++ = corner;
+				*indices++ = corner + 1;
+				*indices++ = corner + rowLength;
+				*indices++ = corner + 1;
+				*indices++ = corner + rowLength + 1;
+				*indices++ = corner + rowLength;
+			}
+		}
+	}
+
+	void EvaluatePatchGridScalar(const BezierPatch& patch, const BezierGridBasis& basis, BezierVertex* vertices)
+	{
+		const auto segments = basis.segments;
+		const auto* points = patch.points;
+		for (auto row = 0; row <= segments; row++)
+		{
+			// The four columns' curves at this v, and their v derivatives
+			const auto& basisV = basis.values[row];
+			const auto& derivativeV = basis.derivatives[row];
+			float3 column[4];
+			float3 columnDerivative[4];
+			for (auto k = 0; k < 4; k++)
+			{
+				column[k] = Sum4(points[k], points[4 + k], points[8 + k], points[12 + k], basisV);
+				columnDerivative[k] = Sum4(points[k], points[4 + k], points[8 + k], points[12 + k], derivativeV);
+			}
+
+			for (auto i = 0; i <= segments; i++)
+			{
+				const auto& basisU = basis.values[i];
+				auto& vertex = *vertices++;
+				vertex.position = Sum4(column[0], column[1], column[2], column[3], basisU);
+				vertex.tangent = Sum4(column[0], column[1], column[2], column[3], basis.derivatives[i]);
+				vertex.bitangent = Sum4(columnDerivative[0], columnDerivative[1], columnDerivative[2], columnDerivative[3], basisU);
+				vertex.uv = float2(static_cast<float>(i) / segments, static_cast<float>(row) / segments);
+				FinishVertex(patch, vertex);
+			}
+		}
+	}
+
+#ifdef BEZIER_PATCH_SSE2
+	struct Vector3SSE2
+	{
+		__m128 x, y, z;
+	};
+
+	Vector3SSE2 Sum4(const Vector3SSE2* points, int stride, const float4& weights)
+	{
+		const auto wx = _mm_set1_ps(weights.x);
+		const auto wy = _mm_set1_ps(weights.y);
+		const auto wz = _mm_set1_ps(weights.z);
+		const auto ww = _mm_set1_ps(weights.w);
+		const auto sum = [&](__m128 Vector3SSE2::* component)
+		{
+			return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(points[0].*component, wx), _mm_mul_ps(points[stride].*component, wy)),
+				_mm_mul_ps(points[2 * stride].*component, wz)), _mm_mul_ps(points[3 * stride].*component, ww));
+		};
+		return { sum(&Vector3SSE2::x), sum(&Vector3SSE2::y), sum(&Vector3SSE2::z) };
+	}
+
+	__m128 Dot(const Vector3SSE2& a, const Vector3SSE2& b)
+	{
+		return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z));
+	}
+
+	// EvaluatePatchGridScalar for four patches at once, one in each lane
+	void EvaluatePatchGridSSE2(const BezierPatch* patches, const BezierGridBasis& basis, BezierVertex* const vertices[4])
+	{
+		const auto segments = basis.segments;
+		Vector3SSE2 points[16];
+		for (auto point = 0; point < 16; point++)
+		{
+			const auto lane = [&](int patch) { return patches[patch].points[point]; };
+			points[point] = { _mm_setr_ps(lane(0).x, lane(1).x, lane(2).x, lane(3).x),
+				_mm_setr_ps(lane(0).y, lane(1).y, lane(2).y, lane(3).y),
+				_mm_setr_ps(lane(0).z, lane(1).z, lane(2).z, lane(3).z) };
+		}
+		const auto degenerate = _mm_set1_ps(DegenerateNormal);
+
+		// The vertex's twelve components for each lane
+		alignas(16) float out[12][4];
+		auto vertex = 0;
+		for (auto row = 0; row <= segments; row++)
+		{
+			Vector3SSE2 column[4];
+			Vector3SSE2 columnDerivative[4];
+			for (auto k = 0; k < 4; k++)
+			{
+				column[k] = Sum4(points + k, 4, basis.values[row]);
+				columnDerivative[k] = Sum4(points + k, 4, basis.derivatives[row]);
+			}
+
+			for (auto i = 0; i <= segments; i++, vertex++)
+			{
+				const auto position = Sum4(column, 1, basis.values[i]);
+				const auto tangent = Sum4(column, 1, basis.derivatives[i]);
+				const auto bitangent = Sum4(columnDerivative, 1, basis.values[i]);
+				const Vector3SSE2 normal =
+				{
+					_mm_sub_ps(_mm_mul_ps(tangent.y, bitangent.z), _mm_mul_ps(tangent.z, bitangent.y)),
+					_mm_sub_ps(_mm_mul_ps(tangent.z, bitangent.x), _mm_mul_ps(tangent.x, bitangent.z)),
+					_mm_sub_ps(_mm_mul_ps(tangent.x, bitangent.y), _mm_mul_ps(tangent.y, bitangent.x)),
+				};
+				const auto lengthSquared = Dot(normal, normal);
+				const auto limit = _mm_mul_ps(_mm_mul_ps(degenerate, Dot(tangent, tangent)), Dot(bitangent, bitangent));
+				const auto goodBits = _mm_movemask_ps(_mm_cmpgt_ps(lengthSquared, limit));
+				const auto length = _mm_sqrt_ps(lengthSquared);
+
+				const __m128 components[12] =
+				{
+					position.x, position.y, position.z,
+					_mm_div_ps(normal.x, length), _mm_div_ps(normal.y, length), _mm_div_ps(normal.z, length),
+					tangent.x, tangent.y, tangent.z,
+					bitangent.x, bitangent.y, bitangent.z,
+				};
+				for (auto component = 0; component < 12; component++) _mm_store_ps(out[component], components[component]);
+
+				const auto uv = float2(static_cast<float>(i) / segments, static_cast<float>(row) / segments);
+				for (auto lane = 0; lane < 4; lane++)
+				{
+					auto& result = vertices[lane][vertex];
+					result.position = float3(out[0][lane], out[1][lane], out[2][lane]);
+					result.normal = float3(out[3][lane], out[4][lane], out[5][lane]);
+					result.tangent = float3(out[6][lane], out[7][lane], out[8][lane]);
+					result.bitangent = float3(out[9][lane], out[10][lane], out[11][lane]);
+					result.uv = uv;
+					if (!(goodBits >> lane & 1)) result.normal = DegenerateVertexNormal(patches[lane], uv);
+				}
+			}
+		}
+	}
+#endif
+
+	void ResizeGridMesh(int patchCount, int segments, TessellatedMesh<BezierVertex>& mesh)
+	{
+		const auto patchVertices = (segments + 1) * (segments + 1);
+		const auto patchIndices = 6 * segments * segments;
+		mesh.vertices.resize(static_cast<std::size_t>(patchCount) * patchVertices);
+		mesh.indices.resize(static_cast<std::size_t>(patchCount) * patchIndices);
+		mesh.patchVertexStart.resize(patchCount + 1);
+		mesh.patchIndexStart.resize(patchCount + 1);
+		for (auto patch = 0; patch <= patchCount; patch++)
+		{
+			mesh.patchVertexStart[patch] = patch * patchVertices;
+			mesh.patchIndexStart[patch] = patch * patchIndices;
+		}
+	}
+}
+
+void EvaluateBezierNaive(const BezierPatch& patch, float u, float v, BezierVertex& vertex)
+{
+	const auto basisU = BernsteinBasis(u);
+	const auto basisV = BernsteinBasis(v);
+	vertex.position = EvaluateBezier(patch.points, basisU, basisV);
+	vertex.tangent = EvaluateBezier(patch.points, BernsteinDerivative(u), basisV);
+	vertex.bitangent = EvaluateBezier(patch.points, basisU, BernsteinDerivative(v));
+	vertex.uv = float2(u, v);
+	FinishVertex(patch, vertex);
+}
+
+BezierGridBasis MakeBezierGridBasis(int segments)
+{
+	BezierGridBasis basis;
+	basis.segments = segments;
+	for (auto i = 0; i <= segments; i++)
+	{
+		const auto t = static_cast<float>(i) / segments;
+		basis.values.push_back(BernsteinBasis(t));
+		basis.derivatives.push_back(BernsteinDerivative(t));
+	}
+	return basis;
+}
+
+void EvaluateBezierGrid(const std::vector<BezierPatch>& patches, const BezierGridBasis& basis,
+	const BezierEvaluationSettings& settings, TessellatedMesh<BezierVertex>& mesh)
+{
+	const auto count = static_cast<int>(patches.size());
+	ResizeGridMesh(count, basis.segments, mesh);
+
+	// Four patches to a block, for the SSE2 path's lanes
+	ParallelFor(0, (count + 3) / 4, settings.threads, [&](int block)
+	{
+		const auto begin = block * 4;
+		const auto end = std::min(begin + 4, count);
+		auto patch = begin;
+#ifdef BEZIER_PATCH_SSE2
+		if (settings.simd && end - begin == 4)
+		{
+			BezierVertex* const vertices[4] =
+			{
+				&mesh.vertices[mesh.patchVertexStart[begin]], &mesh.vertices[mesh.patchVertexStart[begin + 1]],
+				&mesh.vertices[mesh.patchVertexStart[begin + 2]], &mesh.vertices[mesh.patchVertexStart[begin + 3]],
+			};
+			EvaluatePatchGridSSE2(&patches[begin], basis, vertices);
+			patch = end;
+		}
+#endif
+		for (; patch < end; patch++) EvaluatePatchGridScalar(patches[patch], basis, &mesh.vertices[mesh.patchVertexStart[patch]]);
+		for (patch = begin; patch < end; patch++)
+		{
+			WriteGridIndices(basis.segments, mesh.patchVertexStart[patch], &mesh.indices[mesh.patchIndexStart[patch]]);
+		}
+	});
+}
+
+namespace
+{
+	// |a - 2 b + c|
+	float SecondDifference(const float3& a, const float3& b, const float3& c)
+	{
+		return length(a - b * 2.0f + c);
+	}
+
+	// Segments a cubic needs so its chords stay within tolerance: a chord over 1 / n is at most
+	// max|C''| / (8 n^2) from the curve, and |C''| is at most 6 times the largest second
+	// difference of the control points
+	float EdgeFactor(const float3& p0, const float3& p1, const float3& p2, const float3& p3, float tolerance)
+	{
+		const auto difference = std::max(SecondDifference(p0, p1, p2), SecondDifference(p1, p2, p3));
+		return std::max(1.0f, std::ceil(std::sqrt(0.75f * difference / tolerance)));
+	}
+}
+
+TessellationFactors BezierFlatnessFactors(const BezierPatch& patch, float tolerance)
+{
+	const auto* p = patch.points;
+	TessellationFactors factors;
+	factors.edges[0] = EdgeFactor(p[0], p[4], p[8], p[12], tolerance);		// u = 0
+	factors.edges[1] = EdgeFactor(p[0], p[1], p[2], p[3], tolerance);		// v = 0
+	factors.edges[2] = EdgeFactor(p[3], p[7], p[11], p[15], tolerance);		// u = 1
+	factors.edges[3] = EdgeFactor(p[12], p[13], p[14], p[15], tolerance);	// v = 1
+
+	// A triangulated grid of steps du by dv is within (du^2 Muu + 2 du dv Muv + dv^2 Mvv) / 8
+	// of the surface, the M's bounding its second partials: 6 times the net's largest second
+	// differences along u and v and 9 times its largest mixed one. Splitting the Muv term
+	// between the two directions keeps each within half the tolerance.
+	auto uu = 0.0f;
+	auto vv = 0.0f;
+	auto uv = 0.0f;
+	for (auto row = 0; row < 4; row++)
+	{
+		for (auto k = 0; k < 2; k++)
+		{
+			uu = std::max(uu, SecondDifference(p[row * 4 + k], p[row * 4 + k + 1], p[row * 4 + k + 2]));
+			vv = std::max(vv, SecondDifference(p[k * 4 + row], p[(k + 1) * 4 + row], p[(k + 2) * 4 + row]));
+		}
+	}
+	for (auto row = 0; row < 3; row++)
+	{
+		for (auto k = 0; k < 3; k++)
+		{
+			uv = std::max(uv, length(p[(row + 1) * 4 + k + 1] - p[(row + 1) * 4 + k] - p[row * 4 + k + 1] + p[row * 4 + k]));
+		}
+	}
+	factors.inside[0] = std::max(1.0f, std::ceil(std::sqrt((6.0f * uu + 9.0f * uv) / (4.0f * tolerance))));
+	factors.inside[1] = std::max(1.0f, std::ceil(std::sqrt((6.0f * vv + 9.0f * uv) / (4.0f * tolerance))));
+	return factors;
+}
+
+BezierTessellator::BezierTessellator(const std::vector<BezierPatch>& patches)
+	: _patches(patches), _tessellator(TessellatorDomain::Quad, TessellatorPartitioning::Integer)
+{
+}
+
+const BezierTessellator::LocationBasis& BezierTessellator::FindBasis(const TessellatedPatch& patch)
+{
+	auto& basis = _bases[&patch];
+	if (basis) return *basis;
+
+	basis.reset(new LocationBasis());
+	for (const auto& location : patch.locations)
+	{
+		basis->u.push_back(BernsteinBasis(location.x));
+		basis->du.push_back(BernsteinDerivative(location.x));
+		basis->v.push_back(BernsteinBasis(location.y));
+		basis->dv.push_back(BernsteinDerivative(location.y));
+	}
+	return *basis;
+}
+
+void BezierTessellator::Tessellate(float tolerance, TessellatedMesh<BezierVertex>& mesh, int threads)
+{
+	const auto count = GetPatchCount();
+	std::vector<const TessellatedPatch*> tessellated(count);
+	std::vector<const LocationBasis*> bases(count);
+	mesh.patchVertexStart.assign(count + 1, 0);
+	mesh.patchIndexStart.assign(count + 1, 0);
+	for (auto patch = 0; patch < count; patch++)
+	{
+		tessellated[patch] = &_tessellator.Tessellate(BezierFlatnessFactors(_patches[patch], tolerance));
+		bases[patch] = &FindBasis(*tessellated[patch]);
+		mesh.patchVertexStart[patch + 1] = mesh.patchVertexStart[patch] + static_cast<int>(tessellated[patch]->locations.size());
+		mesh.patchIndexStart[patch + 1] = mesh.patchIndexStart[patch] + static_cast<int>(tessellated[patch]->indices.size());
+	}
+	mesh.vertices.resize(mesh.patchVertexStart[count]);
+	mesh.indices.resize(mesh.patchIndexStart[count]);
+
+	ParallelFor(0, count, threads, [&](int patch)
+	{
+		const auto& source = *tessellated[patch];
+		const auto& basis = *bases[patch];
+		const auto* points = _patches[patch].points;
+		const auto vertexStart = mesh.patchVertexStart[patch];
+		for (std::size_t i = 0; i < source.locations.size(); i++)
+		{
+			// The rows folded with the u basis, then summed with the v one
+			float3 row[4];
+			float3 rowDerivative[4];
+			for (auto r = 0; r < 4; r++)
+			{
+				row[r] = Sum4(points[r * 4], points[r * 4 + 1], points[r * 4 + 2], points[r * 4 + 3], basis.u[i]);
+				rowDerivative[r] = Sum4(points[r * 4], points[r * 4 + 1], points[r * 4 + 2], points[r * 4 + 3], basis.du[i]);
+			}
+			auto& vertex = mesh.vertices[vertexStart + i];
+			vertex.position = Sum4(row[0], row[1], row[2], row[3], basis.v[i]);
+			vertex.tangent = Sum4(rowDerivative[0], rowDerivative[1], rowDerivative[2], rowDerivative[3], basis.v[i]);
+			vertex.bitangent = Sum4(row[0], row[1], row[2], row[3], basis.dv[i]);
+			vertex.uv = float2(source.locations[i].x, source.locations[i].y);
+			FinishVertex(_patches[patch], vertex);
+		}
+		const auto indexStart = mesh.patchIndexStart[patch];
+		for (std::size_t i = 0; i < source.indices.size(); i++) mesh.indices[indexStart + i] = vertexStart + source.indices[i];
+	}, 4);
+}
+
+BezierLODCache::BezierLODCache(const std::vector<BezierPatch>& patches, float finestTolerance, int levels)
+	: _tessellator(patches), _finestTolerance(finestTolerance), _meshes(levels)
+{
+}
+
+int BezierLODCache::GetBuiltLevelCount() const
+{
+	return static_cast<int>(std::count_if(_meshes.begin(), _meshes.end(), [](const std::unique_ptr<TessellatedMesh<BezierVertex>>& mesh) { return mesh != nullptr; }));
+}
+
+float BezierLODCache::GetTolerance(int level) const
+{
+	return std::ldexp(_finestTolerance, level);
+}
+
+int BezierLODCache::SelectLevel(float distance, float pixelScale, float pixelTolerance) const
+{
+	// As DS_Terrain's spacing: units the pixels span at the distance
+	const auto tolerance = pixelTolerance * distance / pixelScale;
+	if (!(tolerance >= 2.0f * _finestTolerance)) return 0;
+	const auto level = static_cast<int>(std::floor(std::log2(tolerance / _finestTolerance)));
+	return std::min(level, GetLevelCount() - 1);
+}
+
+const TessellatedMesh<BezierVertex>& BezierLODCache::GetMesh(int level)
+{
+	auto& mesh = _meshes[level];
+	if (!mesh)
+	{
+		mesh.reset(new TessellatedMesh<BezierVertex>());
+		_tessellator.Tessellate(GetTolerance(level), *mesh);
+	}
+	return *mesh;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Common/ShaderMath.h"
+#include "Tessellator.h"
+
+// SSE2 is compiled in on x86 and x64, other platforms only have the scalar path
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BEZIER_PATCH_SSE2
+#endif
+
+// Pottery's teapot, the control points and the 16 indices of each patch it draws
+const int PotteryControlPointCount = 168;
+const int PotteryPatchCount = 12;
+extern const float PotteryControlPoints[PotteryControlPointCount][3];
+extern const unsigned int PotteryPatchIndices[PotteryPatchCount * 16];
+
+// A bicubic Bezier patch as DS_Pottery takes it, four rows along v of four points along u
+struct BezierPatch
+{
+	HLSL::float3 points[16];
+};
+
+void GetPotteryPatches(std::vector<BezierPatch>& patches);
+
+struct BezierVertex
+{
+	HLSL::float3 position;
+	HLSL::float3 normal;		// cross(tangent, bitangent) normalized
+	HLSL::float3 tangent;		// dP/du
+	HLSL::float3 bitangent;		// dP/dv
+	HLSL::float2 uv;
+};
+
+// DS_Pottery's way, both Bernstein bases worked out at the point and summed over all 16 control points
+void EvaluateBezierNaive(const BezierPatch& patch, float u, float v, BezierVertex& vertex);
+
+// The Bernstein basis and its derivative at segments + 1 evenly spaced parameters, shared by every patch and both directions
+struct BezierGridBasis
+{
+	int segments;
+	std::vector<HLSL::float4> values;
+	std::vector<HLSL::float4> derivatives;
+};
+
+BezierGridBasis MakeBezierGridBasis(int segments);
+
+struct BezierEvaluationSettings
+{
+	bool simd = true;		// SSE2 where compiled in, four patches at once
+	int threads = 0;		// 0 uses every hardware thread
+};
+
+// Every patch on the basis' grid, rows of u along v, each control point row folded with the v basis once per grid row
+void EvaluateBezierGrid(const std::vector<BezierPatch>& patches, const BezierGridBasis& basis,
+	const BezierEvaluationSettings& settings, TessellatedMesh<BezierVertex>& mesh);
+
+// Integer factors keeping triangles within tolerance of the surface, each edge's from its own four control points so shared edges agree
+TessellationFactors BezierFlatnessFactors(const BezierPatch& patch, float tolerance);
+
+// Patches tessellated to a flatness tolerance through the CPU tessellator, each distinct tessellation's bases kept with it
+class BezierTessellator
+{
+public: // Structors
+	explicit BezierTessellator(const std::vector<BezierPatch>& patches);
+
+public: // Accessors
+	int GetPatchCount() const { return static_cast<int>(_patches.size()); }
+	int GetCachedBasisCount() const { return static_cast<int>(_bases.size()); }
+
+public: // Functions
+	// Not for several threads at once, the evaluation itself runs on threads
+	void Tessellate(float tolerance, TessellatedMesh<BezierVertex>& mesh, int threads = 0);
+
+private: // Types
+	// Bases at each location of one tessellated patch
+	struct LocationBasis
+	{
+		std::vector<HLSL::float4> u, du, v, dv;
+	};
+
+private: // Functions
+	const LocationBasis& FindBasis(const TessellatedPatch& patch);
+
+private: // Data
+	std::vector<BezierPatch> _patches;
+	Tessellator _tessellator;
+	std::unordered_map<const TessellatedPatch*, std::unique_ptr<LocationBasis>> _bases;
+};
+
+// Meshes of the patches at tolerances doubling from the finest, each built the first time it is asked for
+class BezierLODCache
+{
+public: // Structors
+	BezierLODCache(const std::vector<BezierPatch>& patches, float finestTolerance, int levels);
+
+public: // Accessors
+	int GetLevelCount() const { return static_cast<int>(_meshes.size()); }
+	int GetBuiltLevelCount() const;
+	float GetTolerance(int level) const;
+
+public: // Functions
+	// The coarsest level within pixelTolerance pixels, pixelScale being the pixels for one unit one unit away
+	int SelectLevel(float distance, float pixelScale, float pixelTolerance) const;
+	const TessellatedMesh<BezierVertex>& GetMesh(int level);
+
+private: // Data
+	BezierTessellator _tessellator;
+	float _finestTolerance;
+	std::vector<std::unique_ptr<TessellatedMesh<BezierVertex>>> _meshes;
+};
@@ -230,6 +230,11 @@ void DX::DeviceResources::CreateWindowSizeDependentResources()
 	m_d2dContext->SetTarget(nullptr);
 	m_d2dTargetBitmap = nullptr;
 	m_d3dDepthStencilView = nullptr;
+	m_d3dDepthStencil = nullptr;
+	ID3D11ShaderResourceView* nullResources[] = {nullptr};
+	m_d3dContext->PSSetShaderResources(0, ARRAYSIZE(nullResources), nullResources);
+	m_sceneDepthView = nullptr;
+	m_sceneDepth = nullptr;
 	m_d3dContext->Flush1(D3D11_CONTEXT_TYPE_ALL, nullptr);
 
 	UpdateRenderTargetSize();
@@ -381,8 +386,9 @@ void DX::DeviceResources::CreateWindowSizeDependentResources()
 		);
 
 	// Create a depth stencil view for use with 3D rendering if needed.
+	// Typeless so it can be copied into the scene depth the ray passes read.
 	CD3D11_TEXTURE2D_DESC1 depthStencilDesc(
-		DXGI_FORMAT_D24_UNORM_S8_UINT, 
+		DXGI_FORMAT_R24G8_TYPELESS, 
 		lround(m_d3dRenderTargetSize.Width),
 		lround(m_d3dRenderTargetSize.Height),
 		1, // This depth stencil view has only one texture.
@@ -390,23 +396,50 @@ void DX::DeviceResources::CreateWindowSizeDependentResources()
 		D3D11_BIND_DEPTH_STENCIL
 		);
 
-	ComPtr<ID3D11Texture2D1> depthStencil;
 	DX::ThrowIfFailed(
 		m_d3dDevice->CreateTexture2D1(
 			&depthStencilDesc,
 			nullptr,
-			&depthStencil
+			&m_d3dDepthStencil
 			)
 		);
 
-	CD3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc(D3D11_DSV_DIMENSION_TEXTURE2D);
+	CD3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc(D3D11_DSV_DIMENSION_TEXTURE2D, DXGI_FORMAT_D24_UNORM_S8_UINT);
 	DX::ThrowIfFailed(
 		m_d3dDevice->CreateDepthStencilView(
-			depthStencil.Get(),
+			m_d3dDepthStencil.Get(),
 			&depthStencilViewDesc,
 			&m_d3dDepthStencilView
 			)
 		);
+
+	// A copy of the depth buffer the ray marched and ray traced passes clamp their rays to.
+	// The depth stencil itself stays bound for writing while they run, so they cannot read it.
+	CD3D11_TEXTURE2D_DESC1 sceneDepthDesc(
+		DXGI_FORMAT_R24G8_TYPELESS,
+		lround(m_d3dRenderTargetSize.Width),
+		lround(m_d3dRenderTargetSize.Height),
+		1,
+		1,
+		D3D11_BIND_SHADER_RESOURCE
+		);
+
+	DX::ThrowIfFailed(
+		m_d3dDevice->CreateTexture2D1(
+			&sceneDepthDesc,
+			nullptr,
+			&m_sceneDepth
+			)
+		);
+
+	CD3D11_SHADER_RESOURCE_VIEW_DESC sceneDepthViewDesc(D3D11_SRV_DIMENSION_TEXTURE2D, DXGI_FORMAT_R24_UNORM_X8_TYPELESS);
+	DX::ThrowIfFailed(
+		m_d3dDevice->CreateShaderResourceView(
+			m_sceneDepth.Get(),
+			&sceneDepthViewDesc,
+			&m_sceneDepthView
+			)
+		);
 	
 	// Set the 3D rendering viewport to target the entire window.
 	m_screenViewport = CD3D11_VIEWPORT(
@@ -617,6 +650,12 @@ void DX::DeviceResources::Trim()
 	dxgiDevice->Trim();
 }
 
+// Copies what has been drawn into the depth buffer so far to the scene depth shader resource.
+void DX::DeviceResources::CopySceneDepth()
+{
+	m_d3dContext->CopyResource(m_sceneDepth.Get(), m_d3dDepthStencil.Get());
+}
+
 // Present the contents of the swap chain to the screen.
 void DX::DeviceResources::Present() 
 {
@@ -22,6 +22,7 @@ namespace DX
 		void HandleDeviceLost();
 		void RegisterDeviceNotify(IDeviceNotify* deviceNotify);
 		void Trim();
+		void CopySceneDepth();
 		void Present();
 
 		// The size of the render target, in pixels.
@@ -38,6 +39,8 @@ namespace DX
 		D3D_FEATURE_LEVEL			GetDeviceFeatureLevel() const			{ return m_d3dFeatureLevel; }
 		ID3D11RenderTargetView1*	GetBackBufferRenderTargetView() const	{ return m_d3dRenderTargetView.Get(); }
 		ID3D11DepthStencilView*		GetDepthStencilView() const				{ return m_d3dDepthStencilView.Get(); }
+		// Depth as of the last CopySceneDepth, for passes that stop their rays at the rasterized geometry
+		ID3D11ShaderResourceView*	GetSceneDepthShaderResourceView() const	{ return m_sceneDepthView.Get(); }
 		D3D11_VIEWPORT				GetScreenViewport() const				{ return m_screenViewport; }
 		DirectX::XMFLOAT4X4			GetOrientationTransform3D() const		{ return m_orientationTransform3D; }
 
@@ -64,7 +67,10 @@ namespace DX
 
 		// Direct3D rendering objects. Required for 3D.
 		Microsoft::WRL::ComPtr<ID3D11RenderTargetView1>	m_d3dRenderTargetView;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D1>		m_d3dDepthStencil;
 		Microsoft::WRL::ComPtr<ID3D11DepthStencilView>	m_d3dDepthStencilView;
+		Microsoft::WRL::ComPtr<ID3D11Texture2D1>		m_sceneDepth;
+		Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>	m_sceneDepthView;
 		D3D11_VIEWPORT									m_screenViewport;
 
 		// Direct2D drawing components.
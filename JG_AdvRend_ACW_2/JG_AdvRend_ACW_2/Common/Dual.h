@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cmath>
+#include "ShaderMath.h"
+
+// Forward mode dual number, a value and its gradient, so a templated distance function gives both in one evaluation
+struct Dual
+{
+	float v;
+	HLSL::float3 d;
+
+	Dual() : v(0.0f), d() {}
+	Dual(float value) : v(value), d() {}
+	Dual(float value, const HLSL::float3& gradient) : v(value), d(gradient) {}
+};
+
+using Dual2 = HLSL::Vector2<Dual>;
+using Dual3 = HLSL::Vector3<Dual>;
+
+// Seeds x, y and z with the unit gradients
+inline Dual3 MakeDualPoint(const HLSL::float3& p)
+{
+	return Dual3(Dual(p.x, HLSL::float3(1.0f, 0.0f, 0.0f)), Dual(p.y, HLSL::float3(0.0f, 1.0f, 0.0f)), Dual(p.z, HLSL::float3(0.0f, 0.0f, 1.0f)));
+}
+
+inline float ValueOf(const Dual& a) { return a.v; }
+
+inline Dual operator-(const Dual& a) { return Dual(-a.v, -a.d); }
+inline Dual operator+(const Dual& a, const Dual& b) { return Dual(a.v + b.v, a.d + b.d); }
+inline Dual operator-(const Dual& a, const Dual& b) { return Dual(a.v - b.v, a.d - b.d); }
+inline Dual operator*(const Dual& a, const Dual& b) { return Dual(a.v * b.v, a.d * b.v + b.d * a.v); }
+inline Dual operator/(const Dual& a, const Dual& b) { return Dual(a.v / b.v, (a.d * b.v - b.d * a.v) / (b.v * b.v)); }
+
+inline Dual& operator+=(Dual& a, const Dual& b) { return a = a + b; }
+inline Dual& operator-=(Dual& a, const Dual& b) { return a = a - b; }
+inline Dual& operator*=(Dual& a, const Dual& b) { return a = a * b; }
+inline Dual& operator/=(Dual& a, const Dual& b) { return a = a / b; }
+
+inline bool operator<(const Dual& a, const Dual& b) { return a.v < b.v; }
+inline bool operator>(const Dual& a, const Dual& b) { return a.v > b.v; }
+inline bool operator<=(const Dual& a, const Dual& b) { return a.v <= b.v; }
+inline bool operator>=(const Dual& a, const Dual& b) { return a.v >= b.v; }
+
+// The derivative of sqrt and pow is unbounded at 0, report a zero gradient there and let the caller fall back
+inline Dual sqrt(const Dual& a)
+{
+	const auto s = std::sqrt(a.v);
+	return Dual(s, a.d * (s > 0.0f ? 0.5f / s : 0.0f));
+}
+
+inline Dual pow(const Dual& a, float e)
+{
+	const auto p = std::pow(a.v, e);
+	return Dual(p, a.d * (a.v > 0.0f ? e * p / a.v : 0.0f));
+}
+
+inline Dual abs(const Dual& a) { return a.v < 0.0f ? -a : a; }
+inline Dual min(const Dual& a, const Dual& b) { return b.v < a.v ? b : a; }
+inline Dual max(const Dual& a, const Dual& b) { return b.v > a.v ? b : a; }
+inline Dual clamp(const Dual& a, float lo, float hi) { return a.v < lo ? Dual(lo) : (a.v > hi ? Dual(hi) : a); }
+inline Dual sign(const Dual& a) { return Dual(HLSL::sign(a.v)); }
+inline Dual cos(const Dual& a) { return Dual(std::cos(a.v), a.d * -std::sin(a.v)); }
+inline Dual sin(const Dual& a) { return Dual(std::sin(a.v), a.d * std::cos(a.v)); }
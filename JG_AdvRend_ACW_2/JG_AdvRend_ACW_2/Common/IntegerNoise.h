@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include "ShaderMath.h"
+
+// CPU mirrors of IntegerNoise.hlsli, each noise float4(value, d/dx, d/dy, d/dz), coordinates within an int's range
+namespace HLSL
+{
+	using uint3 = Vector3<std::uint32_t>;
+	using int3 = Vector3<std::int32_t>;
+
+	// PCG3D from Jarzynski and Olano, Hash Functions for GPU Rendering (JCGT 2020)
+	inline uint3 pcg3d(uint3 v)
+	{
+		v.x = v.x * 1664525u + 1013904223u;
+		v.y = v.y * 1664525u + 1013904223u;
+		v.z = v.z * 1664525u + 1013904223u;
+		v.x += v.y * v.z;
+		v.y += v.z * v.x;
+		v.z += v.x * v.y;
+		v.x ^= v.x >> 16u;
+		v.y ^= v.y >> 16u;
+		v.z ^= v.z >> 16u;
+		v.x += v.y * v.z;
+		v.y += v.z * v.x;
+		v.z += v.x * v.y;
+		return v;
+	}
+
+	// Top 24 bits over 2^24, exact in a float
+	inline float hashToUnit(std::uint32_t h)
+	{
+		return static_cast<float>(h >> 8u) * (1.0f / 16777216.0f);
+	}
+
+	// asuint, two's complement like the GPU
+	inline uint3 asuint(const int3& p)
+	{
+		return uint3(static_cast<std::uint32_t>(p.x), static_cast<std::uint32_t>(p.y), static_cast<std::uint32_t>(p.z));
+	}
+
+	inline int3 operator+(const int3& a, const int3& b)
+	{
+		return int3(a.x + b.x, a.y + b.y, a.z + b.z);
+	}
+
+	// Lattice point's value in [0, 1)
+	inline float latticeValue(const int3& p)
+	{
+		return hashToUnit(pcg3d(asuint(p)).x);
+	}
+
+	// Lattice point's gradient, each component in [-1, 1)
+	inline float3 latticeGradient(const int3& p)
+	{
+		const auto h = pcg3d(asuint(p));
+		return float3(hashToUnit(h.x) * 2.0f - 1.0f, hashToUnit(h.y) * 2.0f - 1.0f, hashToUnit(h.z) * 2.0f - 1.0f);
+	}
+
+	// Quintic fade 6t^5 - 15t^4 + 10t^3 and its derivative, so the noise's second derivative is continuous too
+	inline float quinticFade(float t)
+	{
+		return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+	}
+
+	inline float quinticFadeDerivative(float t)
+	{
+		return 30.0f * t * t * (t * (t - 2.0f) + 1.0f);
+	}
+
+	inline float3 quinticFade(const float3& t)
+	{
+		return float3(quinticFade(t.x), quinticFade(t.y), quinticFade(t.z));
+	}
+
+	inline float3 quinticFadeDerivative(const float3& t)
+	{
+		return float3(quinticFadeDerivative(t.x), quinticFadeDerivative(t.y), quinticFadeDerivative(t.z));
+	}
+
+	// Trilinear blend of the corner values through the fade, in [0, 1]
+	inline float4 valueNoised(const float3& x)
+	{
+		const auto p = floor(x);
+		const auto w = x - p;
+		const auto u = quinticFade(w);
+		const auto du = quinticFadeDerivative(w);
+		const auto i = int3(p);
+
+		const auto a = latticeValue(i + int3(0, 0, 0));
+		const auto b = latticeValue(i + int3(1, 0, 0));
+		const auto c = latticeValue(i + int3(0, 1, 0));
+		const auto d = latticeValue(i + int3(1, 1, 0));
+		const auto e = latticeValue(i + int3(0, 0, 1));
+		const auto f = latticeValue(i + int3(1, 0, 1));
+		const auto g = latticeValue(i + int3(0, 1, 1));
+		const auto h = latticeValue(i + int3(1, 1, 1));
+
+		const auto k0 = a;
+		const auto k1 = b - a;
+		const auto k2 = c - a;
+		const auto k3 = e - a;
+		const auto k4 = a - b - c + d;
+		const auto k5 = a - c - e + g;
+		const auto k6 = a - b - e + f;
+		const auto k7 = -a + b + c - d + e - f - g + h;
+
+		const auto value = k0 + k1 * u.x + k2 * u.y + k3 * u.z + k4 * u.x * u.y + k5 * u.y * u.z + k6 * u.z * u.x + k7 * u.x * u.y * u.z;
+		const auto derivative = du * float3(k1 + k4 * u.y + k6 * u.z + k7 * u.y * u.z,
+			k2 + k5 * u.z + k4 * u.x + k7 * u.z * u.x,
+			k3 + k6 * u.x + k5 * u.y + k7 * u.x * u.y);
+		return float4(value, derivative);
+	}
+
+	// Perlin's gradient noise, the blend of each corner's gradient dotted with the offset from it, about [-1, 1]
+	inline float4 gradientNoised(const float3& x)
+	{
+		const auto p = floor(x);
+		const auto w = x - p;
+		const auto u = quinticFade(w);
+		const auto du = quinticFadeDerivative(w);
+		const auto i = int3(p);
+
+		const auto ga = latticeGradient(i + int3(0, 0, 0));
+		const auto gb = latticeGradient(i + int3(1, 0, 0));
+		const auto gc = latticeGradient(i + int3(0, 1, 0));
+		const auto gd = latticeGradient(i + int3(1, 1, 0));
+		const auto ge = latticeGradient(i + int3(0, 0, 1));
+		const auto gf = latticeGradient(i + int3(1, 0, 1));
+		const auto gg = latticeGradient(i + int3(0, 1, 1));
+		const auto gh = latticeGradient(i + int3(1, 1, 1));
+
+		const auto va = dot(ga, w - float3(0.0f, 0.0f, 0.0f));
+		const auto vb = dot(gb, w - float3(1.0f, 0.0f, 0.0f));
+		const auto vc = dot(gc, w - float3(0.0f, 1.0f, 0.0f));
+		const auto vd = dot(gd, w - float3(1.0f, 1.0f, 0.0f));
+		const auto ve = dot(ge, w - float3(0.0f, 0.0f, 1.0f));
+		const auto vf = dot(gf, w - float3(1.0f, 0.0f, 1.0f));
+		const auto vg = dot(gg, w - float3(0.0f, 1.0f, 1.0f));
+		const auto vh = dot(gh, w - float3(1.0f, 1.0f, 1.0f));
+
+		const auto k1 = vb - va;
+		const auto k2 = vc - va;
+		const auto k3 = ve - va;
+		const auto k4 = va - vb - vc + vd;
+		const auto k5 = va - vc - ve + vg;
+		const auto k6 = va - vb - ve + vf;
+		const auto k7 = -va + vb + vc - vd + ve - vf - vg + vh;
+
+		const auto value = va + k1 * u.x + k2 * u.y + k3 * u.z + k4 * u.x * u.y + k5 * u.y * u.z + k6 * u.z * u.x + k7 * u.x * u.y * u.z;
+
+		// The blended gradients, plus the fade's slope times the change in the corners' values
+		const auto derivative = ga + u.x * (gb - ga) + u.y * (gc - ga) + u.z * (ge - ga)
+			+ u.x * u.y * (ga - gb - gc + gd) + u.y * u.z * (ga - gc - ge + gg) + u.z * u.x * (ga - gb - ge + gf)
+			+ u.x * u.y * u.z * (-ga + gb + gc - gd + ge - gf - gg + gh)
+			+ du * float3(k1 + k4 * u.y + k6 * u.z + k7 * u.y * u.z,
+				k2 + k5 * u.z + k4 * u.x + k7 * u.z * u.x,
+				k3 + k6 * u.x + k5 * u.y + k7 * u.x * u.y);
+		return float4(value, derivative);
+	}
+
+	// One simplex corner's contribution (0.5 - r^2)^4 (g . r) and its derivative. A radius past
+	// sqrt(0.5), like the 0.6 often used, reaches over the opposite face and leaves seams.
+	inline float4 simplexCorner(const float3& r, const int3& p)
+	{
+		const auto t = 0.5f - dot(r, r);
+		if (t <= 0.0f) return float4(0.0f, 0.0f, 0.0f, 0.0f);
+
+		const auto g = latticeGradient(p);
+		const auto gr = dot(g, r);
+		const auto t2 = t * t;
+		const auto t4 = t2 * t2;
+		return float4(t4 * gr, t4 * g - (8.0f * t2 * t * gr) * r);
+	}
+
+	// Gustavson's simplex noise over the four corners of the skewed lattice's tetrahedron, about [-1, 1]
+	inline float4 simplexNoised(const float3& x)
+	{
+		const auto F3 = 1.0f / 3.0f;
+		const auto G3 = 1.0f / 6.0f;
+
+		const auto s = floor(x + float3((x.x + x.y + x.z) * F3));
+		const auto x0 = x - s + float3((s.x + s.y + s.z) * G3);
+
+		// Order of x0's components picks the tetrahedron
+		const auto o = x0 - x0.yzx();
+		const float3 e(step(0.0f, o.x), step(0.0f, o.y), step(0.0f, o.z));
+		const auto i1 = e * (float3(1.0f) - e.zxy());
+		const auto i2 = float3(1.0f) - e.zxy() * (float3(1.0f) - e);
+
+		const auto x1 = x0 - i1 + float3(G3);
+		const auto x2 = x0 - i2 + float3(2.0f * G3);
+		const auto x3 = x0 - float3(1.0f) + float3(3.0f * G3);
+		const auto i = int3(s);
+
+		const auto sum = simplexCorner(x0, i) + simplexCorner(x1, i + int3(i1)) + simplexCorner(x2, i + int3(i2)) + simplexCorner(x3, i + int3(1, 1, 1));
+		return 64.0f * sum;
+	}
+
+	// fbm of valueNoised with its derivative, each octave's scaled by its frequency, normalised to [0, 1]
+	inline float4 fbmd(const float3& x, int octaves, float frequency, float lacunarity, float gain)
+	{
+		auto sum = float4(0.0f, 0.0f, 0.0f, 0.0f);
+		auto amplitude = 1.0f;
+		auto totalAmplitude = 0.0f;
+		for (auto octave = 0; octave < octaves; octave++)
+		{
+			const auto n = valueNoised(x * frequency);
+			sum = sum + amplitude * float4(n.x, n.yzw() * frequency);
+			totalAmplitude += amplitude;
+			amplitude *= gain;
+			frequency *= lacunarity;
+		}
+		return float4(sum.x / totalAmplitude, sum.y / totalAmplitude, sum.z / totalAmplitude, sum.w / totalAmplitude);
+	}
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include "ShaderMath.h"
+
+// Closed interval [lo, hi] with conservative arithmetic, rounding isn't directed so compare with a tolerance
+struct Interval
+{
+	float lo;
+	float hi;
+
+	Interval() : lo(0.0f), hi(0.0f) {}
+	Interval(float value) : lo(value), hi(value) {}
+	Interval(float lo, float hi) : lo(lo), hi(hi) {}
+
+	static Interval Everything() { return Interval(-std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()); }
+
+	bool Contains(float value) const { return lo <= value && value <= hi; }
+	float Width() const { return hi - lo; }
+
+	// Comparisons that hold for every value in the interval
+	bool AlwaysLess(const Interval& b) const { return hi < b.lo; }
+	bool AlwaysGreater(const Interval& b) const { return lo > b.hi; }
+};
+
+using Interval2 = HLSL::Vector2<Interval>;
+using Interval3 = HLSL::Vector3<Interval>;
+
+inline Interval Hull(const Interval& a, const Interval& b) { return Interval(a.lo < b.lo ? a.lo : b.lo, a.hi > b.hi ? a.hi : b.hi); }
+inline Interval2 Hull(const Interval2& a, const Interval2& b) { return Interval2(Hull(a.x, b.x), Hull(a.y, b.y)); }
+inline Interval3 Hull(const Interval3& a, const Interval3& b) { return Interval3(Hull(a.x, b.x), Hull(a.y, b.y), Hull(a.z, b.z)); }
+
+inline Interval operator-(const Interval& a) { return Interval(-a.hi, -a.lo); }
+inline Interval operator+(const Interval& a, const Interval& b) { return Interval(a.lo + b.lo, a.hi + b.hi); }
+inline Interval operator-(const Interval& a, const Interval& b) { return Interval(a.lo - b.hi, a.hi - b.lo); }
+
+inline Interval operator*(const Interval& a, const Interval& b)
+{
+	const float p0 = a.lo * b.lo, p1 = a.lo * b.hi, p2 = a.hi * b.lo, p3 = a.hi * b.hi;
+	return Interval(std::fmin(std::fmin(p0, p1), std::fmin(p2, p3)), std::fmax(std::fmax(p0, p1), std::fmax(p2, p3)));
+}
+
+inline Interval operator/(const Interval& a, const Interval& b)
+{
+	if (b.lo <= 0.0f && b.hi >= 0.0f) return Interval::Everything();
+	return a * Interval(1.0f / b.hi, 1.0f / b.lo);
+}
+
+inline Interval& operator+=(Interval& a, const Interval& b) { return a = a + b; }
+inline Interval& operator-=(Interval& a, const Interval& b) { return a = a - b; }
+inline Interval& operator*=(Interval& a, const Interval& b) { return a = a * b; }
+inline Interval& operator/=(Interval& a, const Interval& b) { return a = a / b; }
+
+inline Interval abs(const Interval& a)
+{
+	if (a.lo >= 0.0f) return a;
+	if (a.hi <= 0.0f) return -a;
+	return Interval(0.0f, std::fmax(-a.lo, a.hi));
+}
+
+inline Interval sqr(const Interval& a)
+{
+	const auto m = abs(a);
+	return Interval(m.lo * m.lo, m.hi * m.hi);
+}
+
+inline Interval sqrt(const Interval& a)
+{
+	return Interval(std::sqrt(std::fmax(a.lo, 0.0f)), std::sqrt(std::fmax(a.hi, 0.0f)));
+}
+
+// x^e for x >= 0, negative inputs are clamped to 0
+inline Interval pow(const Interval& a, float e)
+{
+	return Interval(std::pow(std::fmax(a.lo, 0.0f), e), std::pow(std::fmax(a.hi, 0.0f), e));
+}
+
+inline Interval min(const Interval& a, const Interval& b) { return Interval(std::fmin(a.lo, b.lo), std::fmin(a.hi, b.hi)); }
+inline Interval max(const Interval& a, const Interval& b) { return Interval(std::fmax(a.lo, b.lo), std::fmax(a.hi, b.hi)); }
+inline Interval clamp(const Interval& a, float lo, float hi) { return min(max(a, Interval(lo)), Interval(hi)); }
+
+inline Interval sign(const Interval& a)
+{
+	return Interval(a.lo > 0.0f ? 1.0f : (a.lo < 0.0f ? -1.0f : 0.0f), a.hi > 0.0f ? 1.0f : (a.hi < 0.0f ? -1.0f : 0.0f));
+}
+
+inline Interval cos(const Interval& a)
+{
+	const float twoPi = 6.28318531f;
+	if (a.Width() >= twoPi) return Interval(-1.0f, 1.0f);
+
+	// Shift so lo is in [0, 2pi) and look for the extrema at 0, pi, 2pi, 3pi inside the range
+	const auto shift = std::floor(a.lo / twoPi) * twoPi;
+	const auto lo = a.lo - shift, hi = a.hi - shift;
+	const float pi = 3.14159265f;
+
+	auto rlo = std::fmin(std::cos(lo), std::cos(hi));
+	auto rhi = std::fmax(std::cos(lo), std::cos(hi));
+	if (lo <= pi && hi >= pi) rlo = -1.0f;
+	if (hi >= twoPi) rhi = 1.0f;
+	if (hi >= 3.0f * pi) rlo = -1.0f;
+	return Interval(rlo, rhi);
+}
+
+inline Interval sin(const Interval& a)
+{
+	return cos(a - Interval(1.57079633f));
+}
+
+inline Interval length(const Interval2& v) { return sqrt(sqr(v.x) + sqr(v.y)); }
+inline Interval length(const Interval3& v) { return sqrt(sqr(v.x) + sqr(v.y) + sqr(v.z)); }
+inline Interval dot2(const Interval2& v) { return sqr(v.x) + sqr(v.y); }
+inline Interval dot2(const Interval3& v) { return sqr(v.x) + sqr(v.y) + sqr(v.z); }
+
+inline Interval3 ToInterval(const HLSL::float3& v) { return Interval3(Interval(v.x), Interval(v.y), Interval(v.z)); }
+inline Interval2 ToInterval(const HLSL::float2& v) { return Interval2(Interval(v.x), Interval(v.y)); }
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Vyukov's bounded MPMC queue, push and pop failing rather than waiting, the capacity rounded up to a power of two
+template <typename T>
+class LockFreeQueue
+{
+public: // Structors
+	explicit LockFreeQueue(std::size_t capacity);
+	LockFreeQueue(const LockFreeQueue&) = delete;
+	LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+public: // Accessors
+	std::size_t GetCapacity() const { return _mask + 1; }
+
+public: // Functions
+	bool TryPush(const T& value);
+	bool TryPop(T& value);
+
+private: // Types
+	struct Slot
+	{
+		std::atomic<std::size_t> sequence;
+		T value;
+	};
+
+private: // Data
+	std::unique_ptr<Slot[]> _slots;
+	std::size_t _mask;
+	// On their own cache lines, producers and consumers don't share one
+	alignas(64) std::atomic<std::size_t> _head;
+	alignas(64) std::atomic<std::size_t> _tail;
+};
+
+template <typename T>
+LockFreeQueue<T>::LockFreeQueue(std::size_t capacity)
+	: _head(0), _tail(0)
+{
+	std::size_t size = 2;
+	while (size < capacity) size *= 2;
+	_slots.reset(new Slot[size]);
+	_mask = size - 1;
+	for (std::size_t i = 0; i < size; i++) _slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T>
+bool LockFreeQueue<T>::TryPush(const T& value)
+{
+	auto position = _head.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		auto& slot = _slots[position & _mask];
+		const auto sequence = slot.sequence.load(std::memory_order_acquire);
+		const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+		if (difference == 0)
+		{
+			// The slot is free for this position, claim it
+			if (_head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				slot.value = value;
+				slot.sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			// Still holding the value from a lap ago
+			return false;
+		}
+		else position = _head.load(std::memory_order_relaxed);
+	}
+}
+
+template <typename T>
+bool LockFreeQueue<T>::TryPop(T& value)
+{
+	auto position = _tail.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		auto& slot = _slots[position & _mask];
+		const auto sequence = slot.sequence.load(std::memory_order_acquire);
+		const auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+		if (difference == 0)
+		{
+			if (_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				value = slot.value;
+				// Free for the push a lap on
+				slot.sequence.store(position + _mask + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (difference < 0)
+		{
+			// Not pushed yet
+			return false;
+		}
+		else position = _tail.load(std::memory_order_relaxed);
+	}
+}
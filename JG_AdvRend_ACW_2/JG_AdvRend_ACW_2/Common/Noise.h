@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cmath>
+#include "ShaderMath.h"
+
+// CPU mirrors of iq's hash and value noise and Noise.hlsli's fractal sums, differing from the GPU's in the last bits
+namespace HLSL
+{
+	// sin in double rounded to float is the nearest float to the sine on every C runtime,
+	// where sinf is up to an ulp out and differs between them. The rest is float like the GPU.
+	inline float hash(float n)
+	{
+		return frac(static_cast<float>(std::sin(static_cast<double>(n))) * 43758.5453f);
+	}
+
+	inline float noise(const float3& x)
+	{
+		const auto p = floor(x);
+		auto f = frac(x);
+
+		f = f * f * (float3(3.0f, 3.0f, 3.0f) - 2.0f * f);
+		const auto n = p.x + p.y * 57.0f + 113.0f * p.z;
+
+		return lerp(lerp(lerp(hash(n + 0.0f), hash(n + 1.0f), f.x),
+			lerp(hash(n + 57.0f), hash(n + 58.0f), f.x), f.y),
+			lerp(lerp(hash(n + 113.0f), hash(n + 114.0f), f.x),
+				lerp(hash(n + 170.0f), hash(n + 171.0f), f.x), f.y), f.z);
+	}
+
+	// Sum of octaves, each lacunarity times the frequency and gain times the amplitude of the last, normalised to [0, 1]
+	inline float fbm(const float3& x, int octaves, float frequency, float lacunarity, float gain)
+	{
+		auto sum = 0.0f;
+		auto amplitude = 1.0f;
+		auto totalAmplitude = 0.0f;
+		for (auto octave = 0; octave < octaves; octave++)
+		{
+			sum += amplitude * noise(x * frequency);
+			totalAmplitude += amplitude;
+			amplitude *= gain;
+			frequency *= lacunarity;
+		}
+		return sum / totalAmplitude;
+	}
+
+	// fbm of 1 - |2 noise - 1| squared, sharp crests where the noise crosses 0.5
+	inline float ridged(const float3& x, int octaves, float frequency, float lacunarity, float gain)
+	{
+		auto sum = 0.0f;
+		auto amplitude = 1.0f;
+		auto totalAmplitude = 0.0f;
+		for (auto octave = 0; octave < octaves; octave++)
+		{
+			const auto ridge = 1.0f - std::abs(2.0f * noise(x * frequency) - 1.0f);
+			sum += amplitude * ridge * ridge;
+			totalAmplitude += amplitude;
+			amplitude *= gain;
+			frequency *= lacunarity;
+		}
+		return sum / totalAmplitude;
+	}
+}
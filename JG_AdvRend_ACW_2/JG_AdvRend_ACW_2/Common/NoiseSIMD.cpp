@@ -0,0 +1,139 @@
+#include "NoiseSIMD.h"
+#include "Noise.h"
+#include "NoiseSIMDKernel.h"
+
+#if defined(NOISE_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using namespace NoiseSIMD;
+
+namespace
+{
+	bool CpuHasAVX2()
+	{
+#if defined(NOISE_SIMD_X86) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		// The OS has to save the upper halves of the registers too
+		__cpuid(info, 1);
+		const auto osxsave = (info[2] & (1 << 27)) != 0;
+		const auto avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#elif defined(NOISE_SIMD_X86) && defined(__GNUC__)
+		return __builtin_cpu_supports("avx2") != 0;
+#else
+		return false;
+#endif
+	}
+
+	Backend Resolve(Backend backend)
+	{
+		return backend == Backend::Best ? DetectBackend() : backend;
+	}
+
+	void ScalarFractal(const float* x, const float* y, const float* z, float* out, int count, const FractalSettings& settings, bool ridged)
+	{
+		for (auto i = 0; i < count; i++)
+		{
+			const auto p = HLSL::float3(x[i], y[i], z[i]);
+			out[i] = ridged
+				? HLSL::ridged(p, settings.octaves, settings.frequency, settings.lacunarity, settings.gain)
+				: HLSL::fbm(p, settings.octaves, settings.frequency, settings.lacunarity, settings.gain);
+		}
+	}
+
+	void Fractal(const float* x, const float* y, const float* z, float* out, int count, const FractalSettings& settings, bool ridged, Backend backend)
+	{
+		switch (Resolve(backend))
+		{
+#ifdef NOISE_SIMD_X86
+		case Backend::AVX2:
+			NoiseSIMDAVX2::Fractal(x, y, z, out, count, settings, ridged);
+			break;
+		case Backend::SSE2:
+			NoiseSIMDSSE2::Fractal(x, y, z, out, count, settings, ridged);
+			break;
+#endif
+		default:
+			ScalarFractal(x, y, z, out, count, settings, ridged);
+			break;
+		}
+	}
+}
+
+Backend NoiseSIMD::DetectBackend()
+{
+	static const auto backend = CpuHasAVX2() ? Backend::AVX2 : IsSupported(Backend::SSE2) ? Backend::SSE2 : Backend::Scalar;
+	return backend;
+}
+
+bool NoiseSIMD::IsSupported(Backend backend)
+{
+	switch (backend)
+	{
+	case Backend::Best:
+	case Backend::Scalar:
+		return true;
+#ifdef NOISE_SIMD_X86
+	case Backend::SSE2:
+		// Every x64 processor, and every x86 one Windows 8 and later run on
+		return true;
+	case Backend::AVX2:
+		return DetectBackend() == Backend::AVX2;
+#endif
+	default:
+		return false;
+	}
+}
+
+const char* NoiseSIMD::BackendName(Backend backend)
+{
+	switch (Resolve(backend))
+	{
+	case Backend::SSE2: return "SSE2";
+	case Backend::AVX2: return "AVX2";
+	default: return "Scalar";
+	}
+}
+
+void NoiseSIMD::Noise8(const float* x, const float* y, const float* z, float* out, Backend backend)
+{
+	Noise(x, y, z, out, 8, backend);
+}
+
+void NoiseSIMD::Noise(const float* x, const float* y, const float* z, float* out, int count, Backend backend)
+{
+	switch (Resolve(backend))
+	{
+#ifdef NOISE_SIMD_X86
+	case Backend::AVX2:
+		NoiseSIMDAVX2::Noise(x, y, z, out, count);
+		break;
+	case Backend::SSE2:
+		NoiseSIMDSSE2::Noise(x, y, z, out, count);
+		break;
+#endif
+	default:
+		for (auto i = 0; i < count; i++)
+		{
+			out[i] = HLSL::noise(HLSL::float3(x[i], y[i], z[i]));
+		}
+		break;
+	}
+}
+
+void NoiseSIMD::Fbm(const float* x, const float* y, const float* z, float* out, int count, const FractalSettings& settings, Backend backend)
+{
+	Fractal(x, y, z, out, count, settings, false, backend);
+}
+
+void NoiseSIMD::Ridged(const float* x, const float* y, const float* z, float* out, int count, const FractalSettings& settings, Backend backend)
+{
+	Fractal(x, y, z, out, count, settings, true, backend);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// The SSE2 and AVX2 backends are compiled in on x86 and x64, other platforms fall back to Scalar
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NOISE_SIMD_X86
+#endif
+
+// Noise.h's hash value noise over structure of arrays points, bit identical on every backend. The vector kernels match
+// HLSL::noise while |floor(x) + 57 floor(y) + 113 floor(z)| + 171 < 2^20, about 6000 on each axis, past it a vector runs the scalar mirror
+namespace NoiseSIMD
+{
+	enum class Backend
+	{
+		Best,	// the widest the CPU supports
+		Scalar,	// HLSL::noise one point at a time
+		SSE2,
+		AVX2,
+	};
+
+	struct FractalSettings
+	{
+		int octaves = 4;
+		float frequency = 1.0f;		// of the first octave
+		float lacunarity = 2.0f;	// frequency of each octave over the last
+		float gain = 0.5f;			// amplitude of each octave over the last
+	};
+
+	// Best resolved, Scalar when no vector instruction set is compiled in for the platform
+	Backend DetectBackend();
+	bool IsSupported(Backend backend);
+	const char* BackendName(Backend backend);
+
+	// Exactly 8 points
+	void Noise8(const float* x, const float* y, const float* z, float* out, Backend backend = Backend::Best);
+
+	// Any number of points, the tail past the last whole vector is padded
+	void Noise(const float* x, const float* y, const float* z, float* out, int count, Backend backend = Backend::Best);
+	void Fbm(const float* x, const float* y, const float* z, float* out, int count, const FractalSettings& settings, Backend backend = Backend::Best);
+	void Ridged(const float* x, const float* y, const float* z, float* out, int count, const FractalSettings& settings, Backend backend = Backend::Best);
+}
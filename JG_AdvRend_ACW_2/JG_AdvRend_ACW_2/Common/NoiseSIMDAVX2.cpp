@@ -0,0 +1,76 @@
+#include "NoiseSIMD.h"
+
+#ifdef NOISE_SIMD_X86
+
+// Only reached once NoiseSIMD::DetectBackend has found AVX2. MSVC compiles this file
+// with /arch:AVX2 (see the project file). GCC and Clang take the target from here on,
+// after the standard headers so none of their inline functions are built for AVX2,
+// and before the kernel so its templates are.
+#if defined(__GNUC__) && !defined(__AVX2__)
+#pragma GCC target("avx2")
+#endif
+
+#include <immintrin.h>
+#include "NoiseSIMDKernel.h"
+
+namespace
+{
+	struct Ops
+	{
+		using Float = __m256;
+		using Double = __m256d;
+		static const int Width = 8;
+
+		static Float Set(float value) { return _mm256_set1_ps(value); }
+		static Double SetDouble(double value) { return _mm256_set1_pd(value); }
+		static Float Load(const float* p) { return _mm256_loadu_ps(p); }
+		static void Store(float* p, Float v) { _mm256_storeu_ps(p, v); }
+
+		// No fused multiply-add, the products round like the scalar mirror's
+		static Float Add(Float a, Float b) { return _mm256_add_ps(a, b); }
+		static Float Sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+		static Float Mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+		static Float Div(Float a, Float b) { return _mm256_div_ps(a, b); }
+		static Float AndNot(Float a, Float b) { return _mm256_andnot_ps(a, b); }
+		static Float Or(Float a, Float b) { return _mm256_or_ps(a, b); }
+		static Float Max(Float a, Float b) { return _mm256_max_ps(a, b); }
+		static Float GreaterEqual(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+		static bool Any(Float mask) { return _mm256_movemask_ps(mask) != 0; }
+		static Float Floor(Float v) { return _mm256_floor_ps(v); }
+
+		static Double Add(Double a, Double b) { return _mm256_add_pd(a, b); }
+		static Double Sub(Double a, Double b) { return _mm256_sub_pd(a, b); }
+		static Double Mul(Double a, Double b) { return _mm256_mul_pd(a, b); }
+		static Double And(Double a, Double b) { return _mm256_and_pd(a, b); }
+		static Double AndNot(Double a, Double b) { return _mm256_andnot_pd(a, b); }
+		static Double Or(Double a, Double b) { return _mm256_or_pd(a, b); }
+		static Double Xor(Double a, Double b) { return _mm256_xor_pd(a, b); }
+		static Double Equal(Double a, Double b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+		static Double GreaterEqual(Double a, Double b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+
+		static Double WidenLow(Float v) { return _mm256_cvtps_pd(_mm256_castps256_ps128(v)); }
+		static Double WidenHigh(Float v) { return _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)); }
+		static Float Narrow(Double low, Double high) { return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(low)), _mm256_cvtpd_ps(high), 1); }
+	};
+
+	// Not a lambda: GCC would build a captureless lambda's function pointer conversion without AVX2
+	struct NoiseFunction
+	{
+		Ops::Float operator()(Ops::Float px, Ops::Float py, Ops::Float pz) const { return NoiseSIMDKernel::Noise<Ops>(px, py, pz); }
+	};
+}
+
+void NoiseSIMDAVX2::Noise(const float* x, const float* y, const float* z, float* out, int count)
+{
+	NoiseSIMDKernel::Batch<Ops>(x, y, z, out, count, NoiseFunction());
+}
+
+void NoiseSIMDAVX2::Fractal(const float* x, const float* y, const float* z, float* out, int count, const NoiseSIMD::FractalSettings& settings, bool ridged)
+{
+	NoiseSIMDKernel::Batch<Ops>(x, y, z, out, count, [&settings, ridged](Ops::Float px, Ops::Float py, Ops::Float pz)
+	{
+		return NoiseSIMDKernel::Fractal<Ops>(px, py, pz, settings, ridged);
+	});
+}
+
+#endif
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "NoiseSIMD.h"
+
+// Entry points of NoiseSIMDSSE2.cpp and NoiseSIMDAVX2.cpp, defined on x86 only
+namespace NoiseSIMDSSE2
+{
+	void Noise(const float* x, const float* y, const float* z, float* out, int count);
+	void Fractal(const float* x, const float* y, const float* z, float* out, int count, const NoiseSIMD::FractalSettings& settings, bool ridged);
+}
+
+namespace NoiseSIMDAVX2
+{
+	void Noise(const float* x, const float* y, const float* z, float* out, int count);
+	void Fractal(const float* x, const float* y, const float* z, float* out, int count, const NoiseSIMD::FractalSettings& settings, bool ridged);
+}
+
+// The noise written once over a vector type, instantiated by each instruction set file with its own Ops and compiler target
+namespace NoiseSIMDKernel
+{
+	// Rounds to the nearest whole number by adding and taking away 1.5 * 2^52, below 2^51
+	template <typename Ops>
+	typename Ops::Double Round(typename Ops::Double x)
+	{
+		const auto magic = Ops::SetDouble(6755399441055744.0);
+		return Ops::Sub(Ops::Add(x, magic), magic);
+	}
+
+	// fdlibm's sin and cos kernels after reducing by the nearest multiple of pi / 2, good
+	// to about an ulp of a double for |x| below 2^20
+	template <typename Ops>
+	typename Ops::Double SinDouble(typename Ops::Double x)
+	{
+		const auto q = Round<Ops>(Ops::Mul(x, Ops::SetDouble(6.36619772367581382433e-01)));
+		// pi / 2 in two parts, the first 33 bits long so q times it is exact
+		const auto r = Ops::Sub(Ops::Sub(x, Ops::Mul(q, Ops::SetDouble(1.57079632673412561417e+00))), Ops::Mul(q, Ops::SetDouble(6.07710050650619224932e-11)));
+		const auto z = Ops::Mul(r, r);
+
+		auto sine = Ops::SetDouble(1.58969099521155010221e-10);
+		sine = Ops::Add(Ops::Mul(sine, z), Ops::SetDouble(-2.50507602534068634195e-08));
+		sine = Ops::Add(Ops::Mul(sine, z), Ops::SetDouble(2.75573137070700676789e-06));
+		sine = Ops::Add(Ops::Mul(sine, z), Ops::SetDouble(-1.98412698298579493134e-04));
+		sine = Ops::Add(Ops::Mul(sine, z), Ops::SetDouble(8.33333333332248946124e-03));
+		sine = Ops::Add(Ops::Mul(sine, z), Ops::SetDouble(-1.66666666666666324348e-01));
+		sine = Ops::Add(r, Ops::Mul(Ops::Mul(r, z), sine));
+
+		auto cosine = Ops::SetDouble(-1.13596475577881948265e-11);
+		cosine = Ops::Add(Ops::Mul(cosine, z), Ops::SetDouble(2.08757232129817482790e-09));
+		cosine = Ops::Add(Ops::Mul(cosine, z), Ops::SetDouble(-2.75573143513906633035e-07));
+		cosine = Ops::Add(Ops::Mul(cosine, z), Ops::SetDouble(2.48015872894767294178e-05));
+		cosine = Ops::Add(Ops::Mul(cosine, z), Ops::SetDouble(-1.38888888888741095749e-03));
+		cosine = Ops::Add(Ops::Mul(cosine, z), Ops::SetDouble(4.16666666666666019037e-02));
+		cosine = Ops::Add(Ops::Sub(Ops::SetDouble(1.0), Ops::Mul(Ops::SetDouble(0.5), z)), Ops::Mul(Ops::Mul(z, z), cosine));
+
+		// q mod 4 is the quadrant, odd ones take the cos and the last two are negative.
+		// q / 2 and q / 4 only end in quarters, so rounding below the halves floors them.
+		const auto odd = Ops::Sub(q, Ops::Mul(Ops::SetDouble(2.0), Round<Ops>(Ops::Sub(Ops::Mul(q, Ops::SetDouble(0.5)), Ops::SetDouble(0.25)))));
+		const auto quadrant = Ops::Sub(q, Ops::Mul(Ops::SetDouble(4.0), Round<Ops>(Ops::Sub(Ops::Mul(q, Ops::SetDouble(0.25)), Ops::SetDouble(0.375)))));
+		const auto useCosine = Ops::Equal(odd, Ops::SetDouble(1.0));
+		const auto negative = Ops::GreaterEqual(quadrant, Ops::SetDouble(2.0));
+
+		const auto result = Ops::Or(Ops::And(useCosine, cosine), Ops::AndNot(useCosine, sine));
+		return Ops::Xor(result, Ops::And(negative, Ops::SetDouble(-0.0)));
+	}
+
+	// In double and rounded once, as the scalar mirror's sin is; a float polynomial is an ulp out, which hash scales up
+	template <typename Ops>
+	typename Ops::Float Sin(typename Ops::Float x)
+	{
+		return Ops::Narrow(SinDouble<Ops>(Ops::WidenLow(x)), SinDouble<Ops>(Ops::WidenHigh(x)));
+	}
+
+	template <typename Ops>
+	typename Ops::Float Hash(typename Ops::Float n)
+	{
+		const auto scaled = Ops::Mul(Sin<Ops>(n), Ops::Set(43758.5453f));
+		return Ops::Sub(scaled, Ops::Floor(scaled));
+	}
+
+	template <typename Ops>
+	typename Ops::Float Lerp(typename Ops::Float a, typename Ops::Float b, typename Ops::Float t)
+	{
+		return Ops::Add(a, Ops::Mul(Ops::Sub(b, a), t));
+	}
+
+	template <typename Ops>
+	typename Ops::Float Abs(typename Ops::Float v)
+	{
+		return Ops::AndNot(Ops::Set(-0.0f), v);
+	}
+
+	// HLSL::noise lane by lane, out of line so no vector target's code generation reaches it
+	template <typename Ops>
+	typename Ops::Float ScalarNoise(typename Ops::Float x, typename Ops::Float y, typename Ops::Float z)
+	{
+		float lanesX[Ops::Width];
+		float lanesY[Ops::Width];
+		float lanesZ[Ops::Width];
+		float lanesOut[Ops::Width];
+		Ops::Store(lanesX, x);
+		Ops::Store(lanesY, y);
+		Ops::Store(lanesZ, z);
+		NoiseSIMD::Noise(lanesX, lanesY, lanesZ, lanesOut, Ops::Width, NoiseSIMD::Backend::Scalar);
+		return Ops::Load(lanesOut);
+	}
+
+	// Same operations in the same order as HLSL::noise
+	template <typename Ops>
+	typename Ops::Float Noise(typename Ops::Float x, typename Ops::Float y, typename Ops::Float z)
+	{
+		const auto px = Ops::Floor(x);
+		const auto py = Ops::Floor(y);
+		const auto pz = Ops::Floor(z);
+		auto fx = Ops::Sub(x, px);
+		auto fy = Ops::Sub(y, py);
+		auto fz = Ops::Sub(z, pz);
+
+		const auto three = Ops::Set(3.0f);
+		const auto two = Ops::Set(2.0f);
+		fx = Ops::Mul(Ops::Mul(fx, fx), Ops::Sub(three, Ops::Mul(two, fx)));
+		fy = Ops::Mul(Ops::Mul(fy, fy), Ops::Sub(three, Ops::Mul(two, fy)));
+		fz = Ops::Mul(Ops::Mul(fz, fz), Ops::Sub(three, Ops::Mul(two, fz)));
+		const auto n = Ops::Add(Ops::Add(px, Ops::Mul(py, Ops::Set(57.0f))), Ops::Mul(Ops::Set(113.0f), pz));
+
+		// SinDouble is good to an ulp for hash arguments below 2^20 and Floor is exact below 2^31, past either the lanes would drift
+		const auto largest = Ops::Max(Ops::Max(Abs<Ops>(x), Abs<Ops>(y)), Abs<Ops>(z));
+		if (Ops::Any(Ops::Or(Ops::GreaterEqual(Abs<Ops>(n), Ops::Set(1048576.0f - 171.0f)), Ops::GreaterEqual(largest, Ops::Set(2147483648.0f)))))
+		{
+			return ScalarNoise<Ops>(x, y, z);
+		}
+
+		const auto h000 = Hash<Ops>(n);
+		const auto h100 = Hash<Ops>(Ops::Add(n, Ops::Set(1.0f)));
+		const auto h010 = Hash<Ops>(Ops::Add(n, Ops::Set(57.0f)));
+		const auto h110 = Hash<Ops>(Ops::Add(n, Ops::Set(58.0f)));
+		const auto h001 = Hash<Ops>(Ops::Add(n, Ops::Set(113.0f)));
+		const auto h101 = Hash<Ops>(Ops::Add(n, Ops::Set(114.0f)));
+		const auto h011 = Hash<Ops>(Ops::Add(n, Ops::Set(170.0f)));
+		const auto h111 = Hash<Ops>(Ops::Add(n, Ops::Set(171.0f)));
+
+		return Lerp<Ops>(Lerp<Ops>(Lerp<Ops>(h000, h100, fx), Lerp<Ops>(h010, h110, fx), fy),
+			Lerp<Ops>(Lerp<Ops>(h001, h101, fx), Lerp<Ops>(h011, h111, fx), fy), fz);
+	}
+
+	// HLSL::fbm, or HLSL::ridged when ridged
+	template <typename Ops>
+	typename Ops::Float Fractal(typename Ops::Float x, typename Ops::Float y, typename Ops::Float z, const NoiseSIMD::FractalSettings& settings, bool ridged)
+	{
+		auto sum = Ops::Set(0.0f);
+		auto amplitude = 1.0f;
+		auto totalAmplitude = 0.0f;
+		auto frequency = settings.frequency;
+		for (auto octave = 0; octave < settings.octaves; octave++)
+		{
+			const auto scale = Ops::Set(frequency);
+			const auto value = Noise<Ops>(Ops::Mul(x, scale), Ops::Mul(y, scale), Ops::Mul(z, scale));
+			if (ridged)
+			{
+				const auto ridge = Ops::Sub(Ops::Set(1.0f), Ops::AndNot(Ops::Set(-0.0f), Ops::Sub(Ops::Mul(Ops::Set(2.0f), value), Ops::Set(1.0f))));
+				sum = Ops::Add(sum, Ops::Mul(Ops::Mul(Ops::Set(amplitude), ridge), ridge));
+			}
+			else
+			{
+				sum = Ops::Add(sum, Ops::Mul(Ops::Set(amplitude), value));
+			}
+			totalAmplitude += amplitude;
+			amplitude *= settings.gain;
+			frequency *= settings.lacunarity;
+		}
+		return Ops::Div(sum, Ops::Set(totalAmplitude));
+	}
+
+	// Whole vectors straight from the arrays, the tail through a zero padded copy
+	template <typename Ops, typename Function>
+	void Batch(const float* x, const float* y, const float* z, float* out, int count, const Function& function)
+	{
+		auto i = 0;
+		for (; i + Ops::Width <= count; i += Ops::Width)
+		{
+			Ops::Store(out + i, function(Ops::Load(x + i), Ops::Load(y + i), Ops::Load(z + i)));
+		}
+
+		if (i == count) return;
+
+		float tailX[Ops::Width] = {};
+		float tailY[Ops::Width] = {};
+		float tailZ[Ops::Width] = {};
+		float tailOut[Ops::Width];
+		for (auto j = i; j < count; j++)
+		{
+			tailX[j - i] = x[j];
+			tailY[j - i] = y[j];
+			tailZ[j - i] = z[j];
+		}
+		Ops::Store(tailOut, function(Ops::Load(tailX), Ops::Load(tailY), Ops::Load(tailZ)));
+		for (auto j = i; j < count; j++)
+		{
+			out[j] = tailOut[j - i];
+		}
+	}
+}
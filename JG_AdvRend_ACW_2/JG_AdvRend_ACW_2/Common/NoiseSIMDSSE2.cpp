@@ -0,0 +1,70 @@
+#include "NoiseSIMDKernel.h"
+
+#ifdef NOISE_SIMD_X86
+
+#include <emmintrin.h>
+
+namespace
+{
+	// Two doubles to a register for sin
+	struct Ops
+	{
+		using Float = __m128;
+		using Double = __m128d;
+		static const int Width = 4;
+
+		static Float Set(float value) { return _mm_set1_ps(value); }
+		static Double SetDouble(double value) { return _mm_set1_pd(value); }
+		static Float Load(const float* p) { return _mm_loadu_ps(p); }
+		static void Store(float* p, Float v) { _mm_storeu_ps(p, v); }
+
+		static Float Add(Float a, Float b) { return _mm_add_ps(a, b); }
+		static Float Sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+		static Float Mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+		static Float Div(Float a, Float b) { return _mm_div_ps(a, b); }
+		static Float AndNot(Float a, Float b) { return _mm_andnot_ps(a, b); }
+		static Float Or(Float a, Float b) { return _mm_or_ps(a, b); }
+		static Float Max(Float a, Float b) { return _mm_max_ps(a, b); }
+		static Float GreaterEqual(Float a, Float b) { return _mm_cmpge_ps(a, b); }
+		static bool Any(Float mask) { return _mm_movemask_ps(mask) != 0; }
+
+		// Truncation rounds negative values up, take one back where it did. Exact below 2^31.
+		static Float Floor(Float v)
+		{
+			const auto truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+			return _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, v), _mm_set1_ps(1.0f)));
+		}
+
+		static Double Add(Double a, Double b) { return _mm_add_pd(a, b); }
+		static Double Sub(Double a, Double b) { return _mm_sub_pd(a, b); }
+		static Double Mul(Double a, Double b) { return _mm_mul_pd(a, b); }
+		static Double And(Double a, Double b) { return _mm_and_pd(a, b); }
+		static Double AndNot(Double a, Double b) { return _mm_andnot_pd(a, b); }
+		static Double Or(Double a, Double b) { return _mm_or_pd(a, b); }
+		static Double Xor(Double a, Double b) { return _mm_xor_pd(a, b); }
+		static Double Equal(Double a, Double b) { return _mm_cmpeq_pd(a, b); }
+		static Double GreaterEqual(Double a, Double b) { return _mm_cmpge_pd(a, b); }
+
+		static Double WidenLow(Float v) { return _mm_cvtps_pd(v); }
+		static Double WidenHigh(Float v) { return _mm_cvtps_pd(_mm_movehl_ps(v, v)); }
+		static Float Narrow(Double low, Double high) { return _mm_movelh_ps(_mm_cvtpd_ps(low), _mm_cvtpd_ps(high)); }
+	};
+}
+
+void NoiseSIMDSSE2::Noise(const float* x, const float* y, const float* z, float* out, int count)
+{
+	NoiseSIMDKernel::Batch<Ops>(x, y, z, out, count, [](Ops::Float px, Ops::Float py, Ops::Float pz)
+	{
+		return NoiseSIMDKernel::Noise<Ops>(px, py, pz);
+	});
+}
+
+void NoiseSIMDSSE2::Fractal(const float* x, const float* y, const float* z, float* out, int count, const NoiseSIMD::FractalSettings& settings, bool ridged)
+{
+	NoiseSIMDKernel::Batch<Ops>(x, y, z, out, count, [&settings, ridged](Ops::Float px, Ops::Float py, Ops::Float pz)
+	{
+		return NoiseSIMDKernel::Fractal<Ops>(px, py, pz, settings, ridged);
+	});
+}
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// 0 means one thread per hardware thread
+inline int ResolveThreadCount(int threadCount)
+{
+	return threadCount > 0 ? threadCount : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// body(i) for every i in [begin, end) on threads, threadCount 0 using every hardware thread and 1 running inline
+template <typename Body>
+void ParallelFor(int begin, int end, int threadCount, const Body& body, int chunkSize = 1)
+{
+	threadCount = std::min(ResolveThreadCount(threadCount), std::max(1, (end - begin + chunkSize - 1) / chunkSize));
+
+	if (threadCount <= 1)
+	{
+		for (auto i = begin; i < end; i++) body(i);
+		return;
+	}
+
+	std::atomic<int> next(begin);
+	const auto worker = [&]()
+	{
+		for (;;)
+		{
+			const auto first = next.fetch_add(chunkSize);
+			if (first >= end) return;
+
+			const auto last = std::min(end, first + chunkSize);
+			for (auto i = first; i < last; i++) body(i);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (auto t = 1; t < threadCount; t++) threads.emplace_back(worker);
+	worker();
+	for (auto& thread : threads) thread.join();
+}
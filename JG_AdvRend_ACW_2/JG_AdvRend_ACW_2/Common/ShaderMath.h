@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cmath>
+
+// CPU mirrors of the HLSL vector types and intrinsics, for porting shader code line for line
+namespace HLSL
+{
+	// Scalar intrinsics
+	inline float min(float a, float b) { return a < b ? a : b; }
+	inline float max(float a, float b) { return a > b ? a : b; }
+	inline float clamp(float x, float lo, float hi) { return min(max(x, lo), hi); }
+	inline float saturate(float x) { return clamp(x, 0.0f, 1.0f); }
+	inline float lerp(float a, float b, float t) { return a + (b - a) * t; }
+	inline float sign(float x) { return x > 0.0f ? 1.0f : (x < 0.0f ? -1.0f : 0.0f); }
+	inline float frac(float x) { return x - std::floor(x); }
+	inline float step(float edge, float x) { return x >= edge ? 1.0f : 0.0f; }
+
+	inline float smoothstep(float edge0, float edge1, float x)
+	{
+		const float t = saturate((x - edge0) / (edge1 - edge0));
+		return t * t * (3.0f - 2.0f * t);
+	}
+
+	template<typename T>
+	struct Vector2
+	{
+		T x, y;
+
+		Vector2() : x(0), y(0) {}
+		explicit Vector2(T s) : x(s), y(s) {}
+		Vector2(T x, T y) : x(x), y(y) {}
+		template<typename U> explicit Vector2(const Vector2<U>& v) : x(T(v.x)), y(T(v.y)) {}
+
+		Vector2& operator+=(const Vector2& v) { x += v.x; y += v.y; return *this; }
+		Vector2& operator-=(const Vector2& v) { x -= v.x; y -= v.y; return *this; }
+		Vector2& operator*=(T s) { x *= s; y *= s; return *this; }
+		Vector2& operator/=(T s) { x /= s; y /= s; return *this; }
+	};
+
+	template<typename T>
+	struct Vector3
+	{
+		T x, y, z;
+
+		Vector3() : x(0), y(0), z(0) {}
+		explicit Vector3(T s) : x(s), y(s), z(s) {}
+		Vector3(T x, T y, T z) : x(x), y(y), z(z) {}
+		Vector3(const Vector2<T>& xy, T z) : x(xy.x), y(xy.y), z(z) {}
+		// Converts between scalar types, e.g. float3 constants into a dual number or interval vector
+		template<typename U> explicit Vector3(const Vector3<U>& v) : x(T(v.x)), y(T(v.y)), z(T(v.z)) {}
+
+		// Swizzles used by the shaders
+		Vector2<T> xy() const { return Vector2<T>(x, y); }
+		Vector2<T> xz() const { return Vector2<T>(x, z); }
+		Vector2<T> yz() const { return Vector2<T>(y, z); }
+		Vector3<T> yzx() const { return Vector3<T>(y, z, x); }
+		Vector3<T> zxy() const { return Vector3<T>(z, x, y); }
+
+		T& operator[](int i) { return (&x)[i]; }
+		const T& operator[](int i) const { return (&x)[i]; }
+
+		Vector3& operator+=(const Vector3& v) { x += v.x; y += v.y; z += v.z; return *this; }
+		Vector3& operator-=(const Vector3& v) { x -= v.x; y -= v.y; z -= v.z; return *this; }
+		Vector3& operator*=(const Vector3& v) { x *= v.x; y *= v.y; z *= v.z; return *this; }
+		Vector3& operator*=(T s) { x *= s; y *= s; z *= s; return *this; }
+		Vector3& operator/=(T s) { x /= s; y /= s; z /= s; return *this; }
+	};
+
+	template<typename T>
+	struct Vector4
+	{
+		T x, y, z, w;
+
+		Vector4() : x(0), y(0), z(0), w(0) {}
+		explicit Vector4(T s) : x(s), y(s), z(s), w(s) {}
+		Vector4(T x, T y, T z, T w) : x(x), y(y), z(z), w(w) {}
+		Vector4(T x, const Vector3<T>& yzw) : x(x), y(yzw.x), z(yzw.y), w(yzw.z) {}
+		Vector4(const Vector3<T>& xyz, T w) : x(xyz.x), y(xyz.y), z(xyz.z), w(w) {}
+
+		Vector3<T> xyz() const { return Vector3<T>(x, y, z); }
+		Vector3<T> yzw() const { return Vector3<T>(y, z, w); }
+	};
+
+	using float2 = Vector2<float>;
+	using float3 = Vector3<float>;
+	using float4 = Vector4<float>;
+
+	// Vector2 operators
+	template<typename T> Vector2<T> operator-(const Vector2<T>& a) { return Vector2<T>(-a.x, -a.y); }
+	template<typename T> Vector2<T> operator+(const Vector2<T>& a, const Vector2<T>& b) { return Vector2<T>(a.x + b.x, a.y + b.y); }
+	template<typename T> Vector2<T> operator-(const Vector2<T>& a, const Vector2<T>& b) { return Vector2<T>(a.x - b.x, a.y - b.y); }
+	template<typename T> Vector2<T> operator*(const Vector2<T>& a, const Vector2<T>& b) { return Vector2<T>(a.x * b.x, a.y * b.y); }
+	template<typename T> Vector2<T> operator/(const Vector2<T>& a, const Vector2<T>& b) { return Vector2<T>(a.x / b.x, a.y / b.y); }
+	template<typename T> Vector2<T> operator*(const Vector2<T>& a, T s) { return Vector2<T>(a.x * s, a.y * s); }
+	template<typename T> Vector2<T> operator*(T s, const Vector2<T>& a) { return Vector2<T>(a.x * s, a.y * s); }
+	template<typename T> Vector2<T> operator/(const Vector2<T>& a, T s) { return Vector2<T>(a.x / s, a.y / s); }
+
+	// Vector3 operators
+	template<typename T> Vector3<T> operator-(const Vector3<T>& a) { return Vector3<T>(-a.x, -a.y, -a.z); }
+	template<typename T> Vector3<T> operator+(const Vector3<T>& a, const Vector3<T>& b) { return Vector3<T>(a.x + b.x, a.y + b.y, a.z + b.z); }
+	template<typename T> Vector3<T> operator-(const Vector3<T>& a, const Vector3<T>& b) { return Vector3<T>(a.x - b.x, a.y - b.y, a.z - b.z); }
+	template<typename T> Vector3<T> operator*(const Vector3<T>& a, const Vector3<T>& b) { return Vector3<T>(a.x * b.x, a.y * b.y, a.z * b.z); }
+	template<typename T> Vector3<T> operator/(const Vector3<T>& a, const Vector3<T>& b) { return Vector3<T>(a.x / b.x, a.y / b.y, a.z / b.z); }
+	template<typename T> Vector3<T> operator*(const Vector3<T>& a, T s) { return Vector3<T>(a.x * s, a.y * s, a.z * s); }
+	template<typename T> Vector3<T> operator*(T s, const Vector3<T>& a) { return Vector3<T>(a.x * s, a.y * s, a.z * s); }
+	template<typename T> Vector3<T> operator/(const Vector3<T>& a, T s) { return Vector3<T>(a.x / s, a.y / s, a.z / s); }
+
+	// Vector4 operators
+	template<typename T> Vector4<T> operator+(const Vector4<T>& a, const Vector4<T>& b) { return Vector4<T>(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+	template<typename T> Vector4<T> operator-(const Vector4<T>& a, const Vector4<T>& b) { return Vector4<T>(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+	template<typename T> Vector4<T> operator*(const Vector4<T>& a, const Vector4<T>& b) { return Vector4<T>(a.x * b.x, a.y * b.y, a.z * b.z, a.w * b.w); }
+	template<typename T> Vector4<T> operator*(const Vector4<T>& a, T s) { return Vector4<T>(a.x * s, a.y * s, a.z * s, a.w * s); }
+	template<typename T> Vector4<T> operator*(T s, const Vector4<T>& a) { return Vector4<T>(a.x * s, a.y * s, a.z * s, a.w * s); }
+
+	// Vector intrinsics
+	template<typename T> T dot(const Vector2<T>& a, const Vector2<T>& b) { return a.x * b.x + a.y * b.y; }
+	template<typename T> T dot(const Vector3<T>& a, const Vector3<T>& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	template<typename T> T dot(const Vector4<T>& a, const Vector4<T>& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+	template<typename T> T length(const Vector2<T>& v) { using std::sqrt; return sqrt(dot(v, v)); }
+	template<typename T> T length(const Vector3<T>& v) { using std::sqrt; return sqrt(dot(v, v)); }
+
+	template<typename T> Vector2<T> normalize(const Vector2<T>& v) { return v / length(v); }
+	template<typename T> Vector3<T> normalize(const Vector3<T>& v) { return v / length(v); }
+
+	template<typename T> Vector3<T> cross(const Vector3<T>& a, const Vector3<T>& b)
+	{
+		return Vector3<T>(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+
+	template<typename T> Vector3<T> reflect(const Vector3<T>& i, const Vector3<T>& n) { return i - T(2) * dot(i, n) * n; }
+
+	template<typename T> Vector2<T> abs(const Vector2<T>& v) { using std::abs; return Vector2<T>(abs(v.x), abs(v.y)); }
+	template<typename T> Vector3<T> abs(const Vector3<T>& v) { using std::abs; return Vector3<T>(abs(v.x), abs(v.y), abs(v.z)); }
+
+	template<typename T> Vector2<T> min(const Vector2<T>& a, const Vector2<T>& b) { return Vector2<T>(min(a.x, b.x), min(a.y, b.y)); }
+	template<typename T> Vector3<T> min(const Vector3<T>& a, const Vector3<T>& b) { return Vector3<T>(min(a.x, b.x), min(a.y, b.y), min(a.z, b.z)); }
+	template<typename T> Vector2<T> max(const Vector2<T>& a, const Vector2<T>& b) { return Vector2<T>(max(a.x, b.x), max(a.y, b.y)); }
+	template<typename T> Vector3<T> max(const Vector3<T>& a, const Vector3<T>& b) { return Vector3<T>(max(a.x, b.x), max(a.y, b.y), max(a.z, b.z)); }
+	template<typename T> Vector2<T> max(const Vector2<T>& a, T s) { return max(a, Vector2<T>(s)); }
+	template<typename T> Vector3<T> max(const Vector3<T>& a, T s) { return max(a, Vector3<T>(s)); }
+
+	inline float3 floor(const float3& v) { return float3(std::floor(v.x), std::floor(v.y), std::floor(v.z)); }
+	inline float3 frac(const float3& v) { return float3(frac(v.x), frac(v.y), frac(v.z)); }
+	inline float3 saturate(const float3& v) { return float3(saturate(v.x), saturate(v.y), saturate(v.z)); }
+	inline float3 lerp(const float3& a, const float3& b, float t) { return a + (b - a) * t; }
+	inline float3 clamp(const float3& v, float lo, float hi) { return float3(clamp(v.x, lo, hi), clamp(v.y, lo, hi), clamp(v.z, lo, hi)); }
+}
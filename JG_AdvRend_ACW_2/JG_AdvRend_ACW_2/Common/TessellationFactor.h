@@ -0,0 +1,48 @@
+#pragma once
+
+#include "ShaderMath.h"
+
+// CPU mirrors of TessellationFactor.hlsli, line for line
+namespace HLSL
+{
+	struct TessellationTarget
+	{
+		float pixelScale;		// viewport height in pixels over 2 tan(fovY / 2)
+		float edgePixels;		// wanted length of a tessellated segment, in pixels
+		float maxFactor;		// the hull shader's maxtessfactor
+	};
+
+	inline float projectedPixels(const float3& centre, float worldLength, const float3& cameraPosition, const TessellationTarget& target)
+	{
+		return worldLength * target.pixelScale / max(length(centre - cameraPosition), 1e-4f);
+	}
+
+	inline float screenSpaceFactor(float pixels, const TessellationTarget& target)
+	{
+		return clamp(pixels / target.edgePixels, 1.0f, target.maxFactor);
+	}
+
+	inline void orderEdge(float3& p0, float3& p1)
+	{
+		const auto swap = p0.x > p1.x || (p0.x == p1.x && (p0.y > p1.y || (p0.y == p1.y && p0.z > p1.z)));
+		const auto first = swap ? p1 : p0;
+		p1 = swap ? p0 : p1;
+		p0 = first;
+	}
+
+	inline float edgeTessellationFactor(float3 p0, float3 p1, const float3& cameraPosition, const TessellationTarget& target)
+	{
+		orderEdge(p0, p1);
+		return screenSpaceFactor(projectedPixels((p0 + p1) * 0.5f, length(p1 - p0), cameraPosition, target), target);
+	}
+
+	inline float4 triangleTessellationFactors(const float3& p0, const float3& p1, const float3& p2, const float3& cameraPosition, const TessellationTarget& target)
+	{
+		float4 factors;
+		factors.x = edgeTessellationFactor(p1, p2, cameraPosition, target);
+		factors.y = edgeTessellationFactor(p2, p0, cameraPosition, target);
+		factors.z = edgeTessellationFactor(p0, p1, cameraPosition, target);
+		factors.w = max(factors.x, max(factors.y, factors.z));
+		return factors;
+	}
+}
@@ -51,6 +51,7 @@ Sample3DSceneRenderer::Sample3DSceneRenderer(const shared_ptr<DeviceResources>&
 	_rocks = make_unique<Rocks>(deviceResources);
 	_rayTracedSphereCube = make_unique<RayTracedSphereCube>(deviceResources);
 	_rayMarchObjects = make_unique<RayMarchObjects>(deviceResources);
+	_nebula = make_unique<Nebula>(deviceResources);
 	_pottery = make_unique<Pottery>(deviceResources);
 	
 	for(auto i = 0; i < numMeteors; i++)
@@ -159,6 +160,7 @@ void Sample3DSceneRenderer::Update(StepTimer const& timer)
 
 	for (auto& a : _aliens) a->Update(timer);
 	
+	_nebula->Update(timer);
 	_rayMarchObjects->Update(timer);
 	_rayTracedSphereCube->Update(timer);
 }
@@ -270,6 +272,13 @@ void Sample3DSceneRenderer::Render()
 		a->Render();
 	}
 	
+	// The ray passes read the depth of everything rasterized above and stop their rays there
+	m_deviceResources->CopySceneDepth();
+
+	_nebula->SetViewProjectionMatrixCB(viewMatrix, XMLoadFloat4x4(&m_projectionMatrix));
+	_nebula->SetCameraPositionCB(_camera->GetPosition());
+	_nebula->Render();
+
 	_rayMarchObjects->SetViewProjectionMatrixCB(viewMatrix, XMLoadFloat4x4(&m_projectionMatrix));
 	_rayMarchObjects->SetCameraPositionCB(_camera->GetPosition());
 	_rayMarchObjects->Render();
@@ -331,6 +340,7 @@ void Sample3DSceneRenderer::ReleaseDeviceDependentResources()
 	_rocks->ReleaseDeviceDependentResources();
 	_rayTracedSphereCube->ReleaseDeviceDependentResources();
 	_rayMarchObjects->ReleaseDeviceDependentResources();
+	_nebula->ReleaseDeviceDependentResources();
 	_pottery->ReleaseDeviceDependentResources();
 
 	for (auto& m : _meteors) m->ReleaseDeviceDependentResources();
@@ -15,6 +15,7 @@
 #include "Rocks.h"
 #include "RayTracedSphereCube.h"
 #include "RayMarchObjects.h"
+#include "Nebula.h"
 #include "Pottery.h"
 #include "Meteors.h"
 #include "Aliens.h"
@@ -55,6 +56,7 @@ private:
 	unique_ptr<Rocks> _rocks;
 	unique_ptr<RayTracedSphereCube> _rayTracedSphereCube;
 	unique_ptr<RayMarchObjects> _rayMarchObjects;
+	unique_ptr<Nebula> _nebula;
 	unique_ptr<Pottery> _pottery;
 	vector<unique_ptr<Meteors>> _meteors;
 	vector<unique_ptr<Aliens>> _aliens;
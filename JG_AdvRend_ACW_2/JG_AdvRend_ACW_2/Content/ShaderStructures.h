@@ -44,6 +44,26 @@ namespace JG_AdvRend_ACW_2
 		XMFLOAT4X4 inverseView;
 	};
 
+	// One CDLOD chunk of the terrain, from TerrainQuadtree
+	struct TerrainChunkConstantBuffer
+	{
+		XMFLOAT2 origin;
+		float size;
+		float gridDimension;
+		float morphStart;
+		float morphEnd;
+		XMFLOAT2 padding;
+	};
+
+	// Tessellation factors from projected edge length, TessellationFactor.hlsli's TessellationTarget
+	struct TessellationTargetConstantBuffer
+	{
+		float pixelScale;
+		float edgePixels;
+		float maxFactor;
+		float padding;
+	};
+
 	struct TessellationFactorConstantBuffer
 	{
 		float tessellationFactor;
@@ -39,29 +39,22 @@ struct PixelShaderInput
 	float3 viewDirection : TEXCOORD1;
 };
 
-/*Perlin Noise 1*/
-//Hash based 3D Value Noise
-//Ported From https://www.shadertoy.com/view/XslGRr
-//Created by iq (Inigo Quilez)
-
-float hash(float n)
-{
-	return frac(sin(n) * 43758.5453);
-}
-
-float noise(float3 x)
+cbuffer TessellationTargetBuffer : register(b3)
 {
-	float3 p = floor(x);
-	float3 f = frac(x);
+	float pixelScale;
+	float edgePixels;
+	float maxFactor;
+	float targetPadding;
+};
 
-	f = f * f * (3.0 - 2.0 * f);
-	float n = p.x + p.y * 57.0 + 113.0 * p.z;
+//valueNoised of IntegerNoise.hlsli over the plane, baked with its mips by TerrainMaps at load time
+Texture2D<float> heightMap : register(t0);
+//The baked normal's x and z, y is up
+Texture2D<float2> normalMap : register(t1);
+SamplerState terrainSampler : register(s0);
 
-	return lerp(lerp(lerp(hash(n + 0.0), hash(n + 1.0), f.x),
-		lerp(hash(n + 57.0), hash(n + 58.0), f.x), f.y),
-		lerp(lerp(hash(n + 113.0), hash(n + 114.0), f.x),
-			lerp(hash(n + 170.0), hash(n + 171.0), f.x), f.y), f.z);
-}
+//TerrainBakeSettings default, the plane's half size the maps cover
+static float TERRAIN_HALF_SIZE = 20.0;
 
 [domain("tri")]
 PixelShaderInput main(in PatchConstantOutput input, in const float3 uvwCoord : SV_DomainLocation, const OutputPatch<DomainShaderInput, 3> patch)
@@ -79,9 +72,21 @@ PixelShaderInput main(in PatchConstantOutput input, in const float3 uvwCoord : S
 	output.tangent = normalize(output.tangent);
 	output.binormal = normalize(output.binormal);
 
-	float height = noise(output.positionW);
-
-	output.positionW += height * output.normal;
+	//The mip whose texels are as far apart as the tessellated vertices, so the vertices don't alias the
+	//finer detail. HS_Terrain spaces them edgePixels apart on screen, which is this far apart in the
+	//world at the vertex's distance. A function of the vertex alone, so chunks and patches sharing an
+	//edge give its vertices the same height whatever level they are drawn at.
+	float mapWidth, mapHeight, mipCount;
+	heightMap.GetDimensions(0, mapWidth, mapHeight, mipCount);
+	float spacing = edgePixels * distance(output.positionW, cameraPosition) / pixelScale;
+	float mip = max(log2(spacing * mapWidth / (2.0 * TERRAIN_HALF_SIZE)), 0.0);
+	float2 uv = (output.positionW.xz / TERRAIN_HALF_SIZE + 1.0) * 0.5;
+
+	output.positionW += heightMap.SampleLevel(terrainSampler, uv, mip) * output.normal;
+
+	//Baked for the flat, y up plane
+	float2 slope = normalMap.SampleLevel(terrainSampler, uv, mip);
+	output.normal = normalize(float3(slope.x, sqrt(saturate(1.0 - dot(slope, slope))), slope.y));
 
 	output.viewDirection = normalize(cameraPosition.xyz - output.positionW);
 
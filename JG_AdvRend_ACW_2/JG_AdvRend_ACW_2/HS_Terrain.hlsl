@@ -1,3 +1,16 @@
+#include "TessellationFactor.hlsli"
+
+cbuffer CameraBuffer : register(b1)
+{
+	float3 cameraPosition;
+	float cameraPadding;
+};
+
+cbuffer TessellationTargetBuffer : register(b3)
+{
+	TessellationTarget target;
+};
+
 struct HullShaderInput
 {
 	float3 position : POSITION;
@@ -5,7 +18,6 @@ struct HullShaderInput
 	float3 normal : NORMAL;
 	float3 tangent : TANGENT;
 	float3 binormal : BINORMAL;
-	float tessellationFactor : TESS;
 };
 
 struct PatchConstantOutput
@@ -27,11 +39,13 @@ PatchConstantOutput PatchConstantFunction(InputPatch<HullShaderInput, 3> inputPa
 {
 	PatchConstantOutput output;
 
-	output.edges[0] = 0.5f * (inputPatch[1].tessellationFactor + inputPatch[2].tessellationFactor);
-	output.edges[1] = 0.5f * (inputPatch[2].tessellationFactor + inputPatch[0].tessellationFactor);
-	output.edges[2] = 0.5f * (inputPatch[0].tessellationFactor + inputPatch[1].tessellationFactor);
+	//From the flat plane's edges, which every chunk sharing them computes from the same end points
+	float4 factors = triangleTessellationFactors(inputPatch[0].position, inputPatch[1].position, inputPatch[2].position, cameraPosition, target);
+	output.edges[0] = factors.x;
+	output.edges[1] = factors.y;
+	output.edges[2] = factors.z;
 
-	output.inside = output.edges[0];
+	output.inside = factors.w;
 
 	return output;
 }
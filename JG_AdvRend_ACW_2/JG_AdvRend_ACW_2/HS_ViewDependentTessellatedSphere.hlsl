@@ -1,3 +1,22 @@
+#include "TessellationFactor.hlsli"
+
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+}
+
+cbuffer CameraPositionConstantBuffer : register(b1)
+{
+	float3 cameraPosition;
+}
+
+cbuffer TessellationTargetBuffer : register(b2)
+{
+	TessellationTarget target;
+}
+
 struct HS_Tri_Tess_Param
 {
 	float Edges[4] : SV_TessFactor;
@@ -8,7 +27,6 @@ struct HS_INPUT
 {
 	float4 Position : SV_POSITION;
 	float3 Color : COLOR;
-	float TessFactor : TESS;
 };
 
 struct HS_OUTPUT
@@ -20,9 +38,19 @@ struct HS_OUTPUT
 HS_Tri_Tess_Param ConstantHS(InputPatch <HS_INPUT, 4> ip)
 {
 	HS_Tri_Tess_Param output;
-	
-	output.Edges[0] = output.Edges[1] = output.Edges[2] = output.Edges[3] = ip[0].TessFactor;
-	output.Inside[0] = output.Inside[1] = ip[0].TessFactor;
+
+	//DS_TriTess wraps u around the sphere and v from pole to pole, so the u = 0 and u = 1 edges are
+	//the same meridian and the v edges are the poles. Factors come from the arcs' lengths at the
+	//sphere's centre, the same for both sides of the seam.
+	float3 centre = mul(float4(0.0f, 0.0f, 0.0f, 1.0f), model).xyz;
+	float radius = length(mul(float4(1.0f, 0.0f, 0.0f, 0.0f), model).xyz);
+	float meridian = screenSpaceFactor(projectedPixels(centre, 3.14159265f * radius, cameraPosition, target), target);
+	float equator = screenSpaceFactor(projectedPixels(centre, 6.28318530f * radius, cameraPosition, target), target);
+
+	output.Edges[0] = output.Edges[2] = meridian;
+	output.Edges[1] = output.Edges[3] = 1.0f;
+	output.Inside[0] = equator;
+	output.Inside[1] = meridian;
 
 	return output;
 }
@@ -0,0 +1,317 @@
+#include "HeightfieldTracer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include "Common/ParallelFor.h"
+
+using namespace HLSL;
+
+namespace
+{
+	const float Infinity = std::numeric_limits<float>::infinity();
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point startTime)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	int FloorToInt(float value, int low, int high)
+	{
+		return std::min(std::max(static_cast<int>(std::floor(value)), low), high);
+	}
+
+	// Where the ray crosses the plane at coordinate bound, Infinity when it runs along it
+	float Crossing(float origin, float direction, float bound)
+	{
+		return direction != 0.0f ? (bound - origin) / direction : Infinity;
+	}
+}
+
+HeightfieldTracer::HeightfieldTracer(std::vector<float> heights, int resolution, float halfSize, int threads)
+	: _heights(std::move(heights)), _resolution(resolution), _cells(resolution - 1), _halfSize(halfSize),
+	_texelSize(2.0f * halfSize / resolution), _minHeight(0.0f), _maxHeight(0.0f), _buildMilliseconds(0.0)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	BuildLevels(threads);
+	_buildMilliseconds = MillisecondsSince(startTime);
+}
+
+HeightfieldTracer::HeightfieldTracer(const TerrainMaps& maps, int threads)
+	: HeightfieldTracer(maps.GetHeights(0), maps.GetSettings().resolution, maps.GetSettings().halfSize, threads)
+{
+}
+
+std::size_t HeightfieldTracer::GetBytes() const
+{
+	auto bytes = _heights.size() * sizeof(float);
+	for (const auto& level : _levels) bytes += level.size() * sizeof(MinMax);
+	return bytes;
+}
+
+void HeightfieldTracer::BuildLevels(int threads)
+{
+	// Level 1 from the 3 x 3 texel centres under each 2 x 2 block of cells, fewer along the far edges
+	_levels.clear();
+	for (auto size = _resolution / 2; size >= 1; size /= 2)
+	{
+		std::vector<MinMax> level(static_cast<std::size_t>(size) * size);
+		const auto* children = _levels.empty() ? nullptr : &_levels.back();
+		ParallelFor(0, size, threads, [&](int row)
+		{
+			for (auto column = 0; column < size; column++)
+			{
+				MinMax bounds = { Infinity, -Infinity };
+				if (!children)
+				{
+					for (auto z = 2 * row; z <= std::min(2 * row + 2, _cells); z++)
+					{
+						for (auto x = 2 * column; x <= std::min(2 * column + 2, _cells); x++)
+						{
+							const auto height = _heights[static_cast<std::size_t>(z) * _resolution + x];
+							bounds.min = std::min(bounds.min, height);
+							bounds.max = std::max(bounds.max, height);
+						}
+					}
+				}
+				else
+				{
+					const auto childSize = 2 * size;
+					for (auto z = 2 * row; z < 2 * row + 2; z++)
+					{
+						for (auto x = 2 * column; x < 2 * column + 2; x++)
+						{
+							const auto& child = (*children)[static_cast<std::size_t>(z) * childSize + x];
+							bounds.min = std::min(bounds.min, child.min);
+							bounds.max = std::max(bounds.max, child.max);
+						}
+					}
+				}
+				level[static_cast<std::size_t>(row) * size + column] = bounds;
+			}
+		}, std::max(1, 256 / size));
+		_levels.push_back(std::move(level));
+	}
+	_minHeight = _levels.back()[0].min;
+	_maxHeight = _levels.back()[0].max;
+}
+
+HeightfieldTracer::MinMax HeightfieldTracer::Bounds(int level, int x, int z) const
+{
+	if (level > 0) return _levels[level - 1][static_cast<std::size_t>(z) * (_resolution >> level) + x];
+
+	const auto* row = &_heights[static_cast<std::size_t>(z) * _resolution + x];
+	const auto* nextRow = row + _resolution;
+	return { std::min(std::min(row[0], row[1]), std::min(nextRow[0], nextRow[1])), std::max(std::max(row[0], row[1]), std::max(nextRow[0], nextRow[1])) };
+}
+
+bool HeightfieldTracer::MakeCellRay(const float3& origin, const float3& direction, float maxDistance, CellRay& ray) const
+{
+	const auto firstCentre = -_halfSize + 0.5f * _texelSize;
+	ray.origin = float3((origin.x - firstCentre) / _texelSize, origin.y, (origin.z - firstCentre) / _texelSize);
+	ray.direction = float3(direction.x / _texelSize, direction.y, direction.z / _texelSize);
+	ray.start = 0.0f;
+	ray.end = maxDistance;
+
+	// Clipped to the box the cells and the heights span
+	const float low[3] = { 0.0f, _minHeight, 0.0f };
+	const float high[3] = { static_cast<float>(_cells), _maxHeight, static_cast<float>(_cells) };
+	for (auto axis = 0; axis < 3; axis++)
+	{
+		const auto o = ray.origin[axis];
+		const auto d = ray.direction[axis];
+		if (d == 0.0f)
+		{
+			if (o < low[axis] || o > high[axis]) return false;
+			continue;
+		}
+		const auto toLow = (low[axis] - o) / d;
+		const auto toHigh = (high[axis] - o) / d;
+		ray.start = std::max(ray.start, std::min(toLow, toHigh));
+		ray.end = std::min(ray.end, std::max(toLow, toHigh));
+	}
+	return ray.start <= ray.end;
+}
+
+bool HeightfieldTracer::IntersectCell(const CellRay& ray, int x, int z, float start, float end, float& distance) const
+{
+	const auto* row = &_heights[static_cast<std::size_t>(z) * _resolution + x];
+	const auto h00 = row[0];
+	const auto h10 = row[1];
+	const auto h01 = row[_resolution];
+	const auto h11 = row[_resolution + 1];
+	const auto a = h10 - h00;
+	const auto b = h01 - h00;
+	const auto c = h00 - h10 - h01 + h11;
+
+	// The ray from where it enters the cell: s and u across it, its height less the patch's
+	// f(t) = A t^2 + B t + C with t from start
+	const auto s = ray.origin.x + ray.direction.x * start - x;
+	const auto u = ray.origin.z + ray.direction.z * start - z;
+	const auto y = ray.origin.y + ray.direction.y * start;
+	const auto ds = ray.direction.x;
+	const auto du = ray.direction.z;
+	const auto C = y - (h00 + a * s + b * u + c * s * u);
+	const auto B = ray.direction.y - (a * ds + b * du + c * (s * du + u * ds));
+	const auto A = -c * ds * du;
+	const auto span = end - start;
+
+	// Entering under the surface, from a start below it or a grazing hit the last cell just missed
+	if (C <= 0.0f)
+	{
+		distance = start;
+		return true;
+	}
+
+	auto first = Infinity;
+	if (A == 0.0f)
+	{
+		if (B < 0.0f) first = -C / B;
+	}
+	else
+	{
+		const auto discriminant = B * B - 4.0f * A * C;
+		if (discriminant < 0.0f) return false;
+		// The pair without cancellation, C > 0 so neither is 0
+		const auto q = -0.5f * (B + std::copysign(std::sqrt(discriminant), B));
+		if (q == 0.0f) return false;
+		const float roots[2] = { q / A, C / q };
+		for (const auto root : roots)
+		{
+			if (root >= 0.0f) first = std::min(first, root);
+		}
+	}
+	if (!(first <= span)) return false;
+	distance = start + first;
+	return true;
+}
+
+float HeightfieldTracer::CellHeight(float x, float z) const
+{
+	x = clamp(x, 0.0f, static_cast<float>(_cells));
+	z = clamp(z, 0.0f, static_cast<float>(_cells));
+	const auto cellX = std::min(static_cast<int>(x), _cells - 1);
+	const auto cellZ = std::min(static_cast<int>(z), _cells - 1);
+	const auto s = x - cellX;
+	const auto u = z - cellZ;
+	const auto* row = &_heights[static_cast<std::size_t>(cellZ) * _resolution + cellX];
+	return lerp(lerp(row[0], row[1], s), lerp(row[_resolution], row[_resolution + 1], s), u);
+}
+
+float3 HeightfieldTracer::CellNormal(float x, float z) const
+{
+	x = clamp(x, 0.0f, static_cast<float>(_cells));
+	z = clamp(z, 0.0f, static_cast<float>(_cells));
+	const auto cellX = std::min(static_cast<int>(x), _cells - 1);
+	const auto cellZ = std::min(static_cast<int>(z), _cells - 1);
+	const auto s = x - cellX;
+	const auto u = z - cellZ;
+	const auto* row = &_heights[static_cast<std::size_t>(cellZ) * _resolution + cellX];
+	const auto c = row[0] - row[1] - row[_resolution] + row[_resolution + 1];
+	const auto slopeX = (row[1] - row[0] + c * u) / _texelSize;
+	const auto slopeZ = (row[_resolution] - row[0] + c * s) / _texelSize;
+	return normalize(float3(-slopeX, 1.0f, -slopeZ));
+}
+
+void HeightfieldTracer::FinishHit(const CellRay& ray, float distance, HeightfieldHit& hit) const
+{
+	const auto firstCentre = -_halfSize + 0.5f * _texelSize;
+	const auto point = ray.origin + ray.direction * distance;
+	hit.distance = distance;
+	hit.position = float3(firstCentre + point.x * _texelSize, point.y, firstCentre + point.z * _texelSize);
+	hit.normal = CellNormal(point.x, point.z);
+}
+
+float HeightfieldTracer::Height(float x, float z) const
+{
+	const auto firstCentre = -_halfSize + 0.5f * _texelSize;
+	return CellHeight((x - firstCentre) / _texelSize, (z - firstCentre) / _texelSize);
+}
+
+bool HeightfieldTracer::Traverse(const float3& origin, const float3& direction, float maxDistance, int topLevel, HeightfieldHit& hit) const
+{
+	hit.steps = 0;
+	CellRay ray;
+	if (!MakeCellRay(origin, direction, maxDistance, ray)) return false;
+
+	const auto& o = ray.origin;
+	const auto& d = ray.direction;
+	auto t = ray.start;
+	auto x = FloorToInt(o.x + d.x * t, 0, _cells - 1);
+	auto z = FloorToInt(o.z + d.z * t, 0, _cells - 1);
+	auto level = topLevel;
+	for (;;)
+	{
+		hit.steps++;
+		const auto size = 1 << level;
+		const auto lowX = x >> level << level;
+		const auto lowZ = z >> level << level;
+		const auto highX = std::min(lowX + size, _cells);
+		const auto highZ = std::min(lowZ + size, _cells);
+		const auto exitX = Crossing(o.x, d.x, static_cast<float>(d.x > 0.0f ? highX : lowX));
+		const auto exitZ = Crossing(o.z, d.z, static_cast<float>(d.z > 0.0f ? highZ : lowZ));
+		const auto exit = std::min(std::min(exitX, exitZ), ray.end);
+
+		// Over the block the ray's lowest point is at one end or the other
+		const auto bounds = Bounds(level, x >> level, z >> level);
+		if (std::min(o.y + d.y * t, o.y + d.y * exit) <= bounds.max)
+		{
+			if (level > 0)
+			{
+				level--;
+				continue;
+			}
+			float distance;
+			if (IntersectCell(ray, x, z, t, exit, distance))
+			{
+				FinishHit(ray, distance, hit);
+				return true;
+			}
+		}
+
+		// Step out of the block by whole cells, so rounding in the crossing can't stall on its face
+		if (exit >= ray.end) return false;
+		t = exit;
+		x = exitX <= exitZ ? (d.x > 0.0f ? highX : lowX - 1) : FloorToInt(o.x + d.x * t, lowX, highX - 1);
+		z = exitZ <= exitX ? (d.z > 0.0f ? highZ : lowZ - 1) : FloorToInt(o.z + d.z * t, lowZ, highZ - 1);
+		if (x < 0 || x >= _cells || z < 0 || z >= _cells) return false;
+		level = std::min(level + 1, topLevel);
+	}
+}
+
+bool HeightfieldTracer::Trace(const float3& origin, const float3& direction, float maxDistance, HeightfieldHit& hit) const
+{
+	return Traverse(origin, direction, maxDistance, GetLevelCount() - 1, hit);
+}
+
+bool HeightfieldTracer::TraceCells(const float3& origin, const float3& direction, float maxDistance, HeightfieldHit& hit) const
+{
+	return Traverse(origin, direction, maxDistance, 0, hit);
+}
+
+bool HeightfieldTracer::March(const float3& origin, const float3& direction, float maxDistance, float stepTexels, HeightfieldHit& hit) const
+{
+	hit.steps = 0;
+	CellRay ray;
+	if (!MakeCellRay(origin, direction, maxDistance, ray)) return false;
+
+	const auto step = stepTexels * _texelSize;
+	auto previousT = ray.start;
+	auto previousAbove = 0.0f;
+	for (auto t = ray.start;; t = std::min(t + step, ray.end))
+	{
+		hit.steps++;
+		const auto point = ray.origin + ray.direction * t;
+		const auto above = point.y - CellHeight(point.x, point.z);
+		if (above <= 0.0f)
+		{
+			// Where the line between the two samples' heights above the surface crosses zero
+			const auto distance = hit.steps == 1 ? t : previousT + (t - previousT) * previousAbove / (previousAbove - above);
+			FinishHit(ray, distance, hit);
+			return true;
+		}
+		if (t >= ray.end) return false;
+		previousT = t;
+		previousAbove = above;
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include "Common/ShaderMath.h"
+#include "TerrainBaker.h"
+
+struct HeightfieldHit
+{
+	float distance;				// along the ray, 0 for a ray that starts under the surface
+	HLSL::float3 position;
+	HLSL::float3 normal;
+	int steps;					// nodes, cells or samples visited, counted on a miss too
+};
+
+// Rays against a height map's bilinear surface, a min-max quadtree skipping the blocks a ray passes wholly above
+class HeightfieldTracer
+{
+public: // Structors
+	// resolution x resolution heights, a power of two, over the square of the given half size
+	HeightfieldTracer(std::vector<float> heights, int resolution, float halfSize, int threads = 0);
+	explicit HeightfieldTracer(const TerrainMaps& maps, int threads = 0);
+
+public: // Accessors
+	int GetResolution() const { return _resolution; }
+	float GetHalfSize() const { return _halfSize; }
+	int GetLevelCount() const { return static_cast<int>(_levels.size()) + 1; }
+	// Heights and every level of the quadtree
+	std::size_t GetBytes() const;
+	double GetBuildMilliseconds() const { return _buildMilliseconds; }
+
+public: // Functions
+	// Bilinear, with clamped addressing past the outer texel centres
+	float Height(float x, float z) const;
+
+	// The first hit of the ray within maxDistance, direction normalised
+	bool Trace(const HLSL::float3& origin, const HLSL::float3& direction, float maxDistance, HeightfieldHit& hit) const;
+	// Every cell along the ray in turn with the same exact test, the reference Trace must agree with
+	bool TraceCells(const HLSL::float3& origin, const HLSL::float3& direction, float maxDistance, HeightfieldHit& hit) const;
+	// A fixed step march, the hit placed between the last sample above the surface and the first below
+	bool March(const HLSL::float3& origin, const HLSL::float3& direction, float maxDistance, float stepTexels, HeightfieldHit& hit) const;
+
+private: // Types
+	struct MinMax
+	{
+		float min;
+		float max;
+	};
+
+	// x and z in cells from the first texel centre, y and the distance along the ray unchanged
+	struct CellRay
+	{
+		HLSL::float3 origin;
+		HLSL::float3 direction;
+		float start;
+		float end;
+	};
+
+private: // Functions
+	void BuildLevels(int threads);
+	// False when the ray misses the heightfield's bounds within maxDistance
+	bool MakeCellRay(const HLSL::float3& origin, const HLSL::float3& direction, float maxDistance, CellRay& ray) const;
+	// Cell (x, z)'s bounds, level 0 worked out from its corners
+	MinMax Bounds(int level, int x, int z) const;
+	// The ray against cell (x, z)'s patch from start to end, the distance of the first hit
+	bool IntersectCell(const CellRay& ray, int x, int z, float start, float end, float& distance) const;
+	// Descends no further than level 0 and climbs no higher than topLevel, so 0 visits every cell
+	bool Traverse(const HLSL::float3& origin, const HLSL::float3& direction, float maxDistance, int topLevel, HeightfieldHit& hit) const;
+	// The bilinear surface in cell space, clamped to the cells
+	float CellHeight(float x, float z) const;
+	HLSL::float3 CellNormal(float x, float z) const;
+	void FinishHit(const CellRay& ray, float distance, HeightfieldHit& hit) const;
+
+private: // Data
+	std::vector<float> _heights;
+	int _resolution;
+	int _cells;						// along each side, between the resolution texel centres
+	float _halfSize;
+	float _texelSize;
+	float _minHeight;
+	float _maxHeight;
+	std::vector<std::vector<MinMax>> _levels;	// levels 1 up, level l's side resolution >> l
+	double _buildMilliseconds;
+};
@@ -0,0 +1,187 @@
+//Integer hash value, gradient and simplex noise with analytic derivatives, mirrored on the CPU by
+//Common/IntegerNoise.h. Each returns float4(value, d/dx, d/dy, d/dz).
+//
+//The lattice is hashed with uint arithmetic, which wraps the same on every GPU and C++ compiler, so
+//lattice values and gradients are the same bits on both. Only a few float multiplies and adds follow,
+//with no sin to scale up their rounding like the hash in Noise.hlsli. Nor does the lattice repeat, where
+//that hash's n = x + 57y + 113z is the same for every step of (57, -1, 0) and the like, and grows past
+//where the GPU's sin is accurate.
+
+//PCG3D from Jarzynski and Olano, Hash Functions for GPU Rendering (JCGT 2020)
+uint3 pcg3d(uint3 v)
+{
+	v = v * 1664525u + 1013904223u;
+	v.x += v.y * v.z;
+	v.y += v.z * v.x;
+	v.z += v.x * v.y;
+	v ^= v >> 16u;
+	v.x += v.y * v.z;
+	v.y += v.z * v.x;
+	v.z += v.x * v.y;
+	return v;
+}
+
+//Top 24 bits over 2^24, exact in a float
+float hashToUnit(uint h)
+{
+	return float(h >> 8u) * (1.0 / 16777216.0);
+}
+
+//Lattice point's value in [0, 1)
+float latticeValue(int3 p)
+{
+	return hashToUnit(pcg3d(asuint(p)).x);
+}
+
+//Lattice point's gradient, each component in [-1, 1)
+float3 latticeGradient(int3 p)
+{
+	uint3 h = pcg3d(asuint(p));
+	return float3(hashToUnit(h.x), hashToUnit(h.y), hashToUnit(h.z)) * 2.0 - 1.0;
+}
+
+//Quintic fade 6t^5 - 15t^4 + 10t^3 and its derivative, so the noise's second derivative is continuous too
+float3 quinticFade(float3 t)
+{
+	return t * t * t * (t * (t * 6.0 - 15.0) + 10.0);
+}
+
+float3 quinticFadeDerivative(float3 t)
+{
+	return 30.0 * t * t * (t * (t - 2.0) + 1.0);
+}
+
+//Trilinear blend of the corner values through the fade, in [0, 1]
+float4 valueNoised(float3 x)
+{
+	float3 p = floor(x);
+	float3 w = x - p;
+	float3 u = quinticFade(w);
+	float3 du = quinticFadeDerivative(w);
+	int3 i = int3(p);
+
+	float a = latticeValue(i + int3(0, 0, 0));
+	float b = latticeValue(i + int3(1, 0, 0));
+	float c = latticeValue(i + int3(0, 1, 0));
+	float d = latticeValue(i + int3(1, 1, 0));
+	float e = latticeValue(i + int3(0, 0, 1));
+	float f = latticeValue(i + int3(1, 0, 1));
+	float g = latticeValue(i + int3(0, 1, 1));
+	float h = latticeValue(i + int3(1, 1, 1));
+
+	float k0 = a;
+	float k1 = b - a;
+	float k2 = c - a;
+	float k3 = e - a;
+	float k4 = a - b - c + d;
+	float k5 = a - c - e + g;
+	float k6 = a - b - e + f;
+	float k7 = -a + b + c - d + e - f - g + h;
+
+	float value = k0 + k1 * u.x + k2 * u.y + k3 * u.z + k4 * u.x * u.y + k5 * u.y * u.z + k6 * u.z * u.x + k7 * u.x * u.y * u.z;
+	float3 derivative = du * float3(k1 + k4 * u.y + k6 * u.z + k7 * u.y * u.z,
+		k2 + k5 * u.z + k4 * u.x + k7 * u.z * u.x,
+		k3 + k6 * u.x + k5 * u.y + k7 * u.x * u.y);
+	return float4(value, derivative);
+}
+
+//Perlin's gradient noise, the blend of each corner's gradient dotted with the offset from it, about [-1, 1]
+float4 gradientNoised(float3 x)
+{
+	float3 p = floor(x);
+	float3 w = x - p;
+	float3 u = quinticFade(w);
+	float3 du = quinticFadeDerivative(w);
+	int3 i = int3(p);
+
+	float3 ga = latticeGradient(i + int3(0, 0, 0));
+	float3 gb = latticeGradient(i + int3(1, 0, 0));
+	float3 gc = latticeGradient(i + int3(0, 1, 0));
+	float3 gd = latticeGradient(i + int3(1, 1, 0));
+	float3 ge = latticeGradient(i + int3(0, 0, 1));
+	float3 gf = latticeGradient(i + int3(1, 0, 1));
+	float3 gg = latticeGradient(i + int3(0, 1, 1));
+	float3 gh = latticeGradient(i + int3(1, 1, 1));
+
+	float va = dot(ga, w - float3(0.0, 0.0, 0.0));
+	float vb = dot(gb, w - float3(1.0, 0.0, 0.0));
+	float vc = dot(gc, w - float3(0.0, 1.0, 0.0));
+	float vd = dot(gd, w - float3(1.0, 1.0, 0.0));
+	float ve = dot(ge, w - float3(0.0, 0.0, 1.0));
+	float vf = dot(gf, w - float3(1.0, 0.0, 1.0));
+	float vg = dot(gg, w - float3(0.0, 1.0, 1.0));
+	float vh = dot(gh, w - float3(1.0, 1.0, 1.0));
+
+	float k1 = vb - va;
+	float k2 = vc - va;
+	float k3 = ve - va;
+	float k4 = va - vb - vc + vd;
+	float k5 = va - vc - ve + vg;
+	float k6 = va - vb - ve + vf;
+	float k7 = -va + vb + vc - vd + ve - vf - vg + vh;
+
+	float value = va + k1 * u.x + k2 * u.y + k3 * u.z + k4 * u.x * u.y + k5 * u.y * u.z + k6 * u.z * u.x + k7 * u.x * u.y * u.z;
+
+	//The blended gradients, plus the fade's slope times the change in the corners' values
+	float3 derivative = ga + u.x * (gb - ga) + u.y * (gc - ga) + u.z * (ge - ga)
+		+ u.x * u.y * (ga - gb - gc + gd) + u.y * u.z * (ga - gc - ge + gg) + u.z * u.x * (ga - gb - ge + gf)
+		+ u.x * u.y * u.z * (-ga + gb + gc - gd + ge - gf - gg + gh)
+		+ du * float3(k1 + k4 * u.y + k6 * u.z + k7 * u.y * u.z,
+			k2 + k5 * u.z + k4 * u.x + k7 * u.z * u.x,
+			k3 + k6 * u.x + k5 * u.y + k7 * u.x * u.y);
+	return float4(value, derivative);
+}
+
+//One simplex corner's contribution (0.5 - r^2)^4 (g . r) and its derivative. A radius past
+//sqrt(0.5), like the 0.6 often used, reaches over the opposite face and leaves seams.
+float4 simplexCorner(float3 r, int3 p)
+{
+	float t = 0.5 - dot(r, r);
+	if (t <= 0.0) return float4(0.0, 0.0, 0.0, 0.0);
+
+	float3 g = latticeGradient(p);
+	float gr = dot(g, r);
+	float t2 = t * t;
+	float t4 = t2 * t2;
+	return float4(t4 * gr, t4 * g - (8.0 * t2 * t * gr) * r);
+}
+
+//Gustavson's simplex noise over the four corners of the skewed lattice's tetrahedron, about [-1, 1]
+float4 simplexNoised(float3 x)
+{
+	static const float F3 = 1.0 / 3.0;
+	static const float G3 = 1.0 / 6.0;
+
+	float3 s = floor(x + (x.x + x.y + x.z) * F3);
+	float3 x0 = x - s + (s.x + s.y + s.z) * G3;
+
+	//Order of x0's components picks the tetrahedron
+	float3 e = step(float3(0.0, 0.0, 0.0), x0 - x0.yzx);
+	float3 i1 = e * (1.0 - e.zxy);
+	float3 i2 = 1.0 - e.zxy * (1.0 - e);
+
+	float3 x1 = x0 - i1 + G3;
+	float3 x2 = x0 - i2 + 2.0 * G3;
+	float3 x3 = x0 - 1.0 + 3.0 * G3;
+	int3 i = int3(s);
+
+	float4 sum = simplexCorner(x0, i) + simplexCorner(x1, i + int3(i1)) + simplexCorner(x2, i + int3(i2)) + simplexCorner(x3, i + int3(1, 1, 1));
+	return 64.0 * sum;
+}
+
+//fbm of valueNoised with its derivative, each octave's scaled by its frequency, normalised to [0, 1]
+float4 fbmd(float3 x, int octaves, float frequency, float lacunarity, float gain)
+{
+	float4 sum = float4(0.0, 0.0, 0.0, 0.0);
+	float amplitude = 1.0;
+	float totalAmplitude = 0.0;
+	for (int octave = 0; octave < octaves; octave++)
+	{
+		float4 n = valueNoised(x * frequency);
+		sum += amplitude * float4(n.x, n.yzw * frequency);
+		totalAmplitude += amplitude;
+		amplitude *= gain;
+		frequency *= lacunarity;
+	}
+	return sum / totalAmplitude;
+}
@@ -0,0 +1,235 @@
+#include "pch.h"
+#include "Nebula.h"
+#include "NebulaVolume.h"
+
+Nebula::Nebula(const shared_ptr<DeviceResources>& device)
+	: _device(device), _loadingComplete(false), _indexCount(0)
+{
+	CreateDeviceDependentResources();
+}
+
+void Nebula::CreateDeviceDependentResources()
+{
+	// Load shaders asynchronously.
+	auto loadVSTask = DX::ReadDataAsync(L"VS_Nebula.cso");
+	auto loadPSTask = DX::ReadDataAsync(L"PS_Nebula.cso");
+
+	// After the vertex shader file is loaded, create the shader and input layout.
+	auto createVSTask = loadVSTask.then([this](const std::vector<byte>& fileData) {
+		DX::ThrowIfFailed(
+			_device->GetD3DDevice()->CreateVertexShader(
+				&fileData[0],
+				fileData.size(),
+				nullptr,
+				&_vertexShader
+			)
+		);
+
+		static const D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
+		{
+			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0}
+		};
+
+		DX::ThrowIfFailed(
+			_device->GetD3DDevice()->CreateInputLayout(
+				vertexDesc,
+				ARRAYSIZE(vertexDesc),
+				&fileData[0],
+				fileData.size(),
+				&_inputLayout
+			)
+		);
+		});
+
+	// After the pixel shader file is loaded, create the shader, constant buffers and states.
+	auto createPSTask = loadPSTask.then([this](const std::vector<byte>& fileData) {
+		DX::ThrowIfFailed(
+			_device->GetD3DDevice()->CreatePixelShader(
+				&fileData[0],
+				fileData.size(),
+				nullptr,
+				&_pixelShader
+			)
+		);
+
+		CD3D11_BUFFER_DESC MVPBufferDescription(sizeof(ModelViewProjectionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+
+		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&MVPBufferDescription, nullptr, &_mvpBuffer));
+
+		CD3D11_BUFFER_DESC cameraBufferDescription(sizeof(CameraPositionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+
+		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&cameraBufferDescription, nullptr, &_cameraBuffer));
+
+		D3D11_RASTERIZER_DESC raster = CD3D11_RASTERIZER_DESC(D3D11_DEFAULT);
+		raster.CullMode = D3D11_CULL_NONE;
+		raster.FillMode = D3D11_FILL_SOLID;
+		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateRasterizerState(&raster, _rasterState.GetAddressOf()));
+
+		// PS_Nebula returns premultiplied colour
+		D3D11_BLEND_DESC blend = CD3D11_BLEND_DESC(D3D11_DEFAULT);
+		blend.RenderTarget[0].BlendEnable = TRUE;
+		blend.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+		blend.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+		blend.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+		blend.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateBlendState(&blend, _blendState.GetAddressOf()));
+
+		// The quad sits at the near plane, the shader stops its rays at the scene depth instead
+		D3D11_DEPTH_STENCIL_DESC depthStencil = CD3D11_DEPTH_STENCIL_DESC(D3D11_DEFAULT);
+		depthStencil.DepthEnable = FALSE;
+		depthStencil.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateDepthStencilState(&depthStencil, _depthStencilState.GetAddressOf()));
+		});
+
+	// Bounding the density of every cell walks the noise lattice, off the loading thread
+	auto createGridTask = concurrency::create_task([this]() {
+		const NebulaVolume volume{ NebulaSettings() };
+		const auto& settings = volume.GetSettings();
+		const auto& grid = volume.GetMaxDensityGrid();
+
+		CD3D11_TEXTURE3D_DESC gridDesc(DXGI_FORMAT_R32_FLOAT, settings.cellsX, settings.cellsY, settings.cellsZ, 1, D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_IMMUTABLE);
+
+		D3D11_SUBRESOURCE_DATA gridData = { 0 };
+		gridData.pSysMem = grid.data();
+		gridData.SysMemPitch = settings.cellsX * sizeof(float);
+		gridData.SysMemSlicePitch = settings.cellsX * settings.cellsY * sizeof(float);
+		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateTexture3D(&gridDesc, &gridData, &_maxDensityGrid));
+
+		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateShaderResourceView(_maxDensityGrid.Get(), nullptr, &_maxDensityGridView));
+		});
+
+	// Once both shaders are loaded, create the mesh.
+	auto createQuadTask = (createPSTask && createVSTask && createGridTask).then([this]() {
+
+		static const VertexPosition quadVertices[] =
+		{
+			{DirectX::XMFLOAT3(-0.5f, -0.5f, 0.0f)},
+			{DirectX::XMFLOAT3(-0.5f, 0.5f,  0.0f)},
+			{DirectX::XMFLOAT3(0.5f,  -0.5f, 0.0f)},
+			{DirectX::XMFLOAT3(0.5f,  0.5f,  0.0f)},
+		};
+
+		D3D11_SUBRESOURCE_DATA vertexBufferData = { 0 };
+		vertexBufferData.pSysMem = quadVertices;
+		vertexBufferData.SysMemPitch = 0;
+		vertexBufferData.SysMemSlicePitch = 0;
+		CD3D11_BUFFER_DESC vertexBufferDesc(sizeof(quadVertices), D3D11_BIND_VERTEX_BUFFER);
+		DX::ThrowIfFailed(
+			_device->GetD3DDevice()->CreateBuffer(
+				&vertexBufferDesc,
+				&vertexBufferData,
+				&_vertexBuffer
+			)
+		);
+
+		static const unsigned short quadIndices[] =
+		{
+			0, 1, 2,
+			3, 2, 1
+		};
+
+		_indexCount = ARRAYSIZE(quadIndices);
+
+		D3D11_SUBRESOURCE_DATA indexBufferData = { 0 };
+		indexBufferData.pSysMem = quadIndices;
+		indexBufferData.SysMemPitch = 0;
+		indexBufferData.SysMemSlicePitch = 0;
+		CD3D11_BUFFER_DESC indexBufferDesc(sizeof(quadIndices), D3D11_BIND_INDEX_BUFFER);
+		DX::ThrowIfFailed(
+			_device->GetD3DDevice()->CreateBuffer(
+				&indexBufferDesc,
+				&indexBufferData,
+				&_indexBuffer
+			)
+		);
+		});
+
+	// Once the quad is loaded, the object is ready to be rendered.
+	createQuadTask.then([this]() {
+		_loadingComplete = true;
+		});
+}
+
+void Nebula::SetViewProjectionMatrixCB(XMMATRIX& view, XMMATRIX& projection)
+{
+	XMStoreFloat4x4(&_mvpBufferData.view, XMMatrixTranspose(view));
+	XMStoreFloat4x4(&_mvpBufferData.projection, XMMatrixTranspose(projection));
+}
+
+void Nebula::SetCameraPositionCB(XMFLOAT3& position)
+{
+	_cameraBufferData.position = position;
+}
+
+void Nebula::ReleaseDeviceDependentResources()
+{
+	_loadingComplete = false;
+	if (_vertexShader) _vertexShader.Reset();
+	if (_pixelShader) _pixelShader.Reset();
+	if (_inputLayout) _inputLayout.Reset();
+	if (_mvpBuffer) _mvpBuffer.Reset();
+	if (_cameraBuffer) _cameraBuffer.Reset();
+	if (_vertexBuffer) _vertexBuffer.Reset();
+	if (_indexBuffer) _indexBuffer.Reset();
+	if (_rasterState) _rasterState.Reset();
+	if (_blendState) _blendState.Reset();
+	if (_depthStencilState) _depthStencilState.Reset();
+	if (_maxDensityGridView) _maxDensityGridView.Reset();
+	if (_maxDensityGrid) _maxDensityGrid.Reset();
+}
+
+void Nebula::Update(StepTimer const& timer)
+{
+	XMStoreFloat4x4(&_mvpBufferData.model, XMMatrixTranspose(XMMatrixIdentity()));
+}
+
+void Nebula::Render()
+{
+	// Loading is asynchronous. Only draw geometry after it's loaded.
+	if (!_loadingComplete)
+	{
+		return;
+	}
+
+	auto context = _device->GetD3DDeviceContext();
+
+	// Prepare constant buffers to send it to the graphics device.
+	context->UpdateSubresource1(_mvpBuffer.Get(), 0, NULL, &_mvpBufferData, 0, 0, 0);
+	context->UpdateSubresource1(_cameraBuffer.Get(), 0, NULL, &_cameraBufferData, 0, 0, 0);
+
+	UINT stride = sizeof(VertexPosition);
+	UINT offset = 0;
+	context->IASetVertexBuffers(0, 1, _vertexBuffer.GetAddressOf(), &stride, &offset);
+	context->IASetIndexBuffer(_indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+	context->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	context->IASetInputLayout(_inputLayout.Get());
+
+	// Attach our vertex shader.
+	context->VSSetShader(_vertexShader.Get(), nullptr, 0);
+
+	context->HSSetShader(nullptr, nullptr, 0);
+
+	context->DSSetShader(nullptr, nullptr, 0);
+
+	context->GSSetShader(nullptr, nullptr, 0);
+
+	context->RSSetState(_rasterState.Get());
+
+	context->PSSetConstantBuffers1(0, 1, _mvpBuffer.GetAddressOf(), nullptr, nullptr);
+	context->PSSetConstantBuffers1(1, 1, _cameraBuffer.GetAddressOf(), nullptr, nullptr);
+	// Depth of the rasterized geometry, rays stop where it is
+	ID3D11ShaderResourceView* resources[] = { _device->GetSceneDepthShaderResourceView(), _maxDensityGridView.Get() };
+	context->PSSetShaderResources(0, ARRAYSIZE(resources), resources);
+	// Attach our pixel shader.
+	context->PSSetShader(_pixelShader.Get(), nullptr, 0);
+
+	context->OMSetBlendState(_blendState.Get(), nullptr, 0xffffffff);
+	context->OMSetDepthStencilState(_depthStencilState.Get(), 0);
+
+	// Draw the nebula.
+	context->DrawIndexed(_indexCount, 0, 0);
+
+	// Back to the default states the other passes expect
+	context->OMSetBlendState(nullptr, nullptr, 0xffffffff);
+	context->OMSetDepthStencilState(nullptr, 0);
+}
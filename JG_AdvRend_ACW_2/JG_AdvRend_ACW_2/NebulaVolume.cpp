@@ -0,0 +1,236 @@
+#include "NebulaVolume.h"
+#include <algorithm>
+#include <cmath>
+#include "Common/Noise.h"
+#include "Common/ParallelFor.h"
+
+using namespace SDF;
+
+namespace
+{
+	// Lattice cells per octave above which FbmUpperBound gives up and bounds the octave by 1
+	const int MaxLatticeCells = 512;
+}
+
+NebulaVolume::NebulaVolume(const NebulaSettings& settings)
+	: _settings(settings)
+{
+	_cellSize = (_settings.boxMax - _settings.boxMin) / float3(static_cast<float>(_settings.cellsX), static_cast<float>(_settings.cellsY), static_cast<float>(_settings.cellsZ));
+	BuildMaxDensityGrid();
+}
+
+float NebulaVolume::GetOccupiedFraction() const
+{
+	const auto occupied = std::count_if(_maxDensity.begin(), _maxDensity.end(), [](float density) { return density > 0.0f; });
+	return static_cast<float>(occupied) / static_cast<float>(_maxDensity.size());
+}
+
+float NebulaVolume::Density(const float3& p) const
+{
+	const auto fbm = HLSL::fbm(p, _settings.octaves, _settings.frequency, 2.0f, 0.5f);
+
+	const auto edge = min(p - _settings.boxMin, _settings.boxMax - p);
+	const auto fade = saturate(std::min(edge.x, std::min(edge.y, edge.z)) / _settings.fade);
+
+	return saturate((fbm - _settings.threshold) * _settings.gain) * fade;
+}
+
+float3 NebulaVolume::Emission(float density) const
+{
+	return lerp(float3(0.45f, 0.12f, 0.6f), float3(0.25f, 0.75f, 1.0f), density);
+}
+
+void NebulaVolume::Accumulate(NebulaSample& sample, float density, float dt, float& transmittance) const
+{
+	const auto absorbed = 1.0f - std::exp(-_settings.extinction * density * dt);
+	const auto emission = Emission(density) * (transmittance * absorbed);
+	sample.colour.x += emission.x;
+	sample.colour.y += emission.y;
+	sample.colour.z += emission.z;
+	transmittance *= 1.0f - absorbed;
+	sample.colour.w = 1.0f - transmittance;
+}
+
+NebulaSample NebulaVolume::MarchNaive(const SDFRay& ray, float end, const NebulaMarchSettings& settings) const
+{
+	NebulaSample sample = {};
+
+	auto tNear = 0.0f;
+	auto tFar = 0.0f;
+	if (!IntersectBox(ray, end, tNear, tFar)) return sample;
+
+	auto transmittance = 1.0f;
+	for (auto t = tNear; t < tFar; t += settings.fixedStep)
+	{
+		const auto dt = std::min(settings.fixedStep, tFar - t);
+		Accumulate(sample, Density(ray.o + (t + 0.5f * dt) * ray.d), dt, transmittance);
+		sample.samples++;
+	}
+
+	return sample;
+}
+
+NebulaSample NebulaVolume::MarchSkipping(const SDFRay& ray, float end, const NebulaMarchSettings& settings) const
+{
+	NebulaSample sample = {};
+
+	auto tNear = 0.0f;
+	auto tFar = 0.0f;
+	if (!IntersectBox(ray, end, tNear, tFar)) return sample;
+
+	// Cell the ray enters, and per axis the depth of the next cell boundary and the depth between boundaries
+	const int cells[3] = { _settings.cellsX, _settings.cellsY, _settings.cellsZ };
+	const auto entry = (ray.o + tNear * ray.d - _settings.boxMin) / _cellSize;
+	int cell[3];
+	int step[3];
+	float tNext[3];
+	float tDelta[3];
+	for (auto axis = 0; axis < 3; axis++)
+	{
+		cell[axis] = std::min(std::max(static_cast<int>(std::floor(entry[axis])), 0), cells[axis] - 1);
+		if (std::abs(ray.d[axis]) < 1e-8f)
+		{
+			step[axis] = 0;
+			tNext[axis] = 1e10f;
+			tDelta[axis] = 1e10f;
+			continue;
+		}
+		step[axis] = ray.d[axis] > 0.0f ? 1 : -1;
+		const auto boundary = _settings.boxMin[axis] + (cell[axis] + (step[axis] > 0 ? 1 : 0)) * _cellSize[axis];
+		tNext[axis] = (boundary - ray.o[axis]) / ray.d[axis];
+		tDelta[axis] = _cellSize[axis] / std::abs(ray.d[axis]);
+	}
+
+	auto transmittance = 1.0f;
+	auto t = tNear;
+	while (t < tFar)
+	{
+		const auto axis = tNext[0] < tNext[1] ? (tNext[0] < tNext[2] ? 0 : 2) : (tNext[1] < tNext[2] ? 1 : 2);
+		const auto cellExit = std::min(tNext[axis], tFar);
+		const auto maxDensity = _maxDensity[(cell[2] * cells[1] + cell[1]) * cells[0] + cell[0]];
+		sample.cellsVisited++;
+
+		if (maxDensity <= 0.0f)
+		{
+			sample.cellsSkipped++;
+		}
+		else
+		{
+			// Thin density needs few samples, the step absorbs at most maxOpticalDepthPerStep at the cell's densest
+			const auto cellStep = clamp(settings.maxOpticalDepthPerStep / (_settings.extinction * maxDensity), settings.minStep, settings.maxStep);
+			while (t < cellExit)
+			{
+				const auto dt = std::min(cellStep, cellExit - t);
+				Accumulate(sample, Density(ray.o + (t + 0.5f * dt) * ray.d), dt, transmittance);
+				sample.samples++;
+				t += dt;
+
+				if (sample.colour.w >= settings.opacityCutoff || sample.samples >= settings.maxSamples) return sample;
+			}
+		}
+
+		t = cellExit;
+		cell[axis] += step[axis];
+		if (cell[axis] < 0 || cell[axis] >= cells[axis]) break;
+		tNext[axis] += tDelta[axis];
+	}
+
+	return sample;
+}
+
+void NebulaVolume::BuildMaxDensityGrid()
+{
+	const auto cellCount = _settings.cellsX * _settings.cellsY * _settings.cellsZ;
+	_maxDensity.resize(cellCount);
+
+	ParallelFor(0, cellCount, _settings.threads, [&](int index)
+	{
+		const auto x = index % _settings.cellsX;
+		const auto y = (index / _settings.cellsX) % _settings.cellsY;
+		const auto z = index / (_settings.cellsX * _settings.cellsY);
+		const auto low = _settings.boxMin + _cellSize * float3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+		const auto high = low + _cellSize;
+		_maxDensity[index] = saturate((FbmUpperBound(low, high) - _settings.threshold) * _settings.gain) * FadeUpperBound(low, high);
+	}, 64);
+}
+
+float NebulaVolume::FbmUpperBound(const float3& low, const float3& high) const
+{
+	auto bound = 0.0f;
+	auto amplitude = 1.0f;
+	auto totalAmplitude = 0.0f;
+	auto frequency = _settings.frequency;
+	for (auto octave = 0; octave < _settings.octaves; octave++)
+	{
+		const auto noiseLow = low * frequency;
+		const auto noiseHigh = high * frequency;
+		const auto first = floor(noiseLow);
+		const auto last = floor(noiseHigh);
+		const auto count = last - first + float3(1.0f, 1.0f, 1.0f);
+
+		// Inside one lattice cell the noise is multilinear in the smoothstepped coordinates, which rise
+		// with the coordinates, so it peaks at a corner of any box in the cell. The most of the octave
+		// is the most over the corners of the cell's overlap with each lattice cell it covers.
+		auto octaveMax = 1.0f;
+		if (count.x * count.y * count.z <= MaxLatticeCells)
+		{
+			octaveMax = 0.0f;
+			for (auto z = first.z; z <= last.z; z++)
+			{
+				for (auto y = first.y; y <= last.y; y++)
+				{
+					for (auto x = first.x; x <= last.x; x++)
+					{
+						const auto lattice = float3(x, y, z);
+						const auto overlapLow = max(noiseLow, lattice);
+						const auto overlapHigh = min(noiseHigh, lattice + float3(1.0f, 1.0f, 1.0f));
+						for (auto corner = 0; corner < 8; corner++)
+						{
+							const auto p = float3(corner & 1 ? overlapHigh.x : overlapLow.x, corner & 2 ? overlapHigh.y : overlapLow.y, corner & 4 ? overlapHigh.z : overlapLow.z);
+							octaveMax = std::max(octaveMax, HLSL::noise(p));
+						}
+					}
+				}
+			}
+			// Float rounding in the lerps
+			octaveMax = std::min(octaveMax + 1e-4f, 1.0f);
+		}
+
+		bound += amplitude * octaveMax;
+		totalAmplitude += amplitude;
+		amplitude *= 0.5f;
+		frequency *= 2.0f;
+	}
+
+	return bound / totalAmplitude;
+}
+
+float NebulaVolume::FadeUpperBound(const float3& low, const float3& high) const
+{
+	// min(p - boxMin, boxMax - p) on each axis peaks at the point of the cell nearest the box's middle,
+	// the smallest of the three peaks is no less than the fade anywhere in the cell
+	const auto middle = 0.5f * (_settings.boxMin + _settings.boxMax);
+	const auto nearest = min(max(middle, low), high);
+	const auto edge = min(nearest - _settings.boxMin, _settings.boxMax - nearest);
+	return saturate(std::min(edge.x, std::min(edge.y, edge.z)) / _settings.fade);
+}
+
+bool NebulaVolume::IntersectBox(const SDFRay& ray, float end, float& tNear, float& tFar) const
+{
+	tNear = 0.0f;
+	tFar = end;
+	for (auto axis = 0; axis < 3; axis++)
+	{
+		if (std::abs(ray.d[axis]) < 1e-8f)
+		{
+			if (ray.o[axis] < _settings.boxMin[axis] || ray.o[axis] > _settings.boxMax[axis]) return false;
+			continue;
+		}
+		auto t0 = (_settings.boxMin[axis] - ray.o[axis]) / ray.d[axis];
+		auto t1 = (_settings.boxMax[axis] - ray.o[axis]) / ray.d[axis];
+		if (t0 > t1) std::swap(t0, t1);
+		tNear = std::max(tNear, t0);
+		tFar = std::min(tFar, t1);
+	}
+	return tNear < tFar;
+}
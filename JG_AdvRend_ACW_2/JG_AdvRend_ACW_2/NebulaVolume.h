@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include "SDFRayMarcher.h"
+
+// Defaults match the constants at the top of PS_Nebula.hlsl
+struct NebulaSettings
+{
+	float3 boxMin = float3(-30.0f, 6.0f, -30.0f);	// the nebula fills this box above the scene
+	float3 boxMax = float3(30.0f, 18.0f, 30.0f);
+	float fade = 3.0f;								// density fades to 0 over this distance from the box's faces
+	int cellsX = 64;								// max density grid
+	int cellsY = 16;
+	int cellsZ = 64;
+	float frequency = 0.12f;						// noise cells per unit of the first octave
+	int octaves = 4;								// each doubles the frequency and halves the amplitude
+	float threshold = 0.6f;						// fBm below this is empty space
+	float gain = 4.0f;								// density = saturate((fBm - threshold) * gain) * fade
+	float extinction = 0.6f;						// per unit of density and distance
+	int threads = 0;								// building the grid, 0 uses every hardware thread
+};
+
+struct NebulaMarchSettings
+{
+	float fixedStep = 0.25f;			// MarchNaive
+	float maxOpticalDepthPerStep = 0.1f;	// MarchSkipping steps so the densest point of the cell absorbs at most this
+	float minStep = 0.1f;
+	float maxStep = 1.0f;
+	float opacityCutoff = 0.99f;		// MarchSkipping stops once the ray is this opaque
+	int maxSamples = 512;
+};
+
+struct NebulaSample
+{
+	float4 colour;		// premultiplied emission (rgb) and opacity (a)
+	int samples;		// density evaluations
+	int cellsVisited;	// grid cells the DDA stepped into
+	int cellsSkipped;	// of those, cells with no density that were crossed without sampling
+};
+
+// fBm of the hash value noise, marched through a grid of the most density each cell can reach
+class NebulaVolume
+{
+public: // Structors
+	explicit NebulaVolume(const NebulaSettings& settings);
+
+public: // Accessors
+	const NebulaSettings& GetSettings() const { return _settings; }
+	// x fastest, then y, then z, the layout of the Texture3D PS_Nebula reads
+	const std::vector<float>& GetMaxDensityGrid() const { return _maxDensity; }
+	float GetOccupiedFraction() const;
+
+public: // Functions
+	float Density(const float3& p) const;
+	float3 Emission(float density) const;
+	// Fixed steps across the whole box, no skipping and no early termination
+	NebulaSample MarchNaive(const SDFRay& ray, float end, const NebulaMarchSettings& settings) const;
+	// DDA through the grid, empty cells skipped, steps sized by each cell's max density
+	NebulaSample MarchSkipping(const SDFRay& ray, float end, const NebulaMarchSettings& settings) const;
+
+private: // Functions
+	void BuildMaxDensityGrid();
+	float FbmUpperBound(const float3& low, const float3& high) const;
+	float FadeUpperBound(const float3& low, const float3& high) const;
+	bool IntersectBox(const SDFRay& ray, float end, float& tNear, float& tFar) const;
+	// Composites a segment of length dt at the given density behind what the ray has already crossed
+	void Accumulate(NebulaSample& sample, float density, float dt, float& transmittance) const;
+
+private: // Data
+	NebulaSettings _settings;
+	float3 _cellSize;
+	std::vector<float> _maxDensity;
+};
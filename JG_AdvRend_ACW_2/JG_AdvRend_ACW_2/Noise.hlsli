@@ -0,0 +1,59 @@
+//Hash value noise and its fractal sums, mirrored on the CPU by Common/Noise.h (one point)
+//and Common/NoiseSIMD.h (arrays of points)
+
+/*Perlin Noise 1*/
+//Hash based 3D Value Noise
+//Ported From https://www.shadertoy.com/view/XslGRr
+//Created by iq (Inigo Quilez)
+
+float hash(float n)
+{
+	return frac(sin(n) * 43758.5453);
+}
+
+float noise(float3 x)
+{
+	float3 p = floor(x);
+	float3 f = frac(x);
+
+	f = f * f * (3.0 - 2.0 * f);
+	float n = p.x + p.y * 57.0 + 113.0 * p.z;
+
+	return lerp(lerp(lerp(hash(n + 0.0), hash(n + 1.0), f.x),
+		lerp(hash(n + 57.0), hash(n + 58.0), f.x), f.y),
+		lerp(lerp(hash(n + 113.0), hash(n + 114.0), f.x),
+			lerp(hash(n + 170.0), hash(n + 171.0), f.x), f.y), f.z);
+}
+
+//Sum of octaves, each lacunarity times the frequency and gain times the amplitude of the last, normalised to [0, 1]
+float fbm(float3 x, int octaves, float frequency, float lacunarity, float gain)
+{
+	float sum = 0.0;
+	float amplitude = 1.0;
+	float totalAmplitude = 0.0;
+	for (int octave = 0; octave < octaves; octave++)
+	{
+		sum += amplitude * noise(x * frequency);
+		totalAmplitude += amplitude;
+		amplitude *= gain;
+		frequency *= lacunarity;
+	}
+	return sum / totalAmplitude;
+}
+
+//fbm of 1 - |2 noise - 1| squared, sharp crests where the noise crosses 0.5
+float ridged(float3 x, int octaves, float frequency, float lacunarity, float gain)
+{
+	float sum = 0.0;
+	float amplitude = 1.0;
+	float totalAmplitude = 0.0;
+	for (int octave = 0; octave < octaves; octave++)
+	{
+		float ridge = 1.0 - abs(2.0 * noise(x * frequency) - 1.0);
+		sum += amplitude * ridge * ridge;
+		totalAmplitude += amplitude;
+		amplitude *= gain;
+		frequency *= lacunarity;
+	}
+	return sum / totalAmplitude;
+}
@@ -0,0 +1,165 @@
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+};
+
+cbuffer CameraConstantBuffer : register(b1)
+{
+	float3 cameraPosition;
+	float padding;
+}
+
+#include "SceneDepth.hlsli"
+//Most density each cell of the nebula's box can reach, built by NebulaVolume on the CPU, 0 for empty space
+Texture3D<float> maxDensityGrid : register(t1);
+
+struct PixelShaderInput
+{
+	float4 position : SV_POSITION;
+};
+
+static float MIN_DIST = 1.0;
+static float EPSILON = 0.0001;
+
+//NebulaSettings defaults, keep in step with NebulaVolume.h
+static float3 NEBULA_MIN = float3(-30.0, 6.0, -30.0);
+static float3 NEBULA_MAX = float3(30.0, 18.0, 30.0);
+static float NEBULA_FADE = 3.0;
+static int3 NEBULA_CELLS = int3(64, 16, 64);
+static float NEBULA_FREQUENCY = 0.12;
+static int NEBULA_OCTAVES = 4;
+static float NEBULA_THRESHOLD = 0.6;
+static float NEBULA_GAIN = 4.0;
+static float NEBULA_EXTINCTION = 0.6;
+
+//NebulaMarchSettings defaults
+static float MAX_OPTICAL_DEPTH_PER_STEP = 0.1;
+static float MIN_STEP = 0.1;
+static float MAX_STEP = 1.0;
+static float OPACITY_CUTOFF = 0.99;
+static int MAX_SAMPLES = 512;
+static int MAX_CELLS = 144;
+
+struct Ray {
+	float3 o; //origin
+	float3 d; //direction
+};
+
+#include "Noise.hlsli"
+
+float nebulaDensity(float3 p)
+{
+	float density = fbm(p, NEBULA_OCTAVES, NEBULA_FREQUENCY, 2.0, 0.5);
+
+	//Fades out towards the box's faces so the grid's edges never show
+	float3 edge = min(p - NEBULA_MIN, NEBULA_MAX - p);
+	float fade = saturate(min(edge.x, min(edge.y, edge.z)) / NEBULA_FADE);
+
+	return saturate((density - NEBULA_THRESHOLD) * NEBULA_GAIN) * fade;
+}
+
+float3 nebulaEmission(float density)
+{
+	return lerp(float3(0.45, 0.12, 0.6), float3(0.25, 0.75, 1.0), density);
+}
+
+//Where the ray is inside the nebula's box, clipped to [0, end]
+bool nebulaInterval(Ray ray, float end, out float tNear, out float tFar)
+{
+	float3 inverseDirection = 1.0 / ray.d;
+	float3 t0 = (NEBULA_MIN - ray.o) * inverseDirection;
+	float3 t1 = (NEBULA_MAX - ray.o) * inverseDirection;
+	float3 tMin = min(t0, t1);
+	float3 tMax = max(t0, t1);
+	tNear = max(max(tMin.x, tMin.y), max(tMin.z, 0.0));
+	tFar = min(min(tMax.x, tMax.y), min(tMax.z, end));
+	return tNear < tFar;
+}
+
+//Front to back emission and absorption, premultiplied colour in rgb and opacity in a.
+//A DDA walks the max density grid: empty cells are crossed without sampling and occupied cells are
+//stepped so their densest point absorbs at most MAX_OPTICAL_DEPTH_PER_STEP. Same as NebulaVolume::MarchSkipping.
+float4 nebulaMarching(Ray ray, float end)
+{
+	float4 colour = float4(0.0, 0.0, 0.0, 0.0);
+
+	float tNear, tFar;
+	if (!nebulaInterval(ray, end, tNear, tFar)) return colour;
+
+	float3 cellSize = (NEBULA_MAX - NEBULA_MIN) / NEBULA_CELLS;
+	float3 entry = (ray.o + tNear * ray.d - NEBULA_MIN) / cellSize;
+	int3 cell = clamp(int3(floor(entry)), int3(0, 0, 0), NEBULA_CELLS - 1);
+	int3 cellStep = ray.d > 0.0 ? int3(1, 1, 1) : int3(-1, -1, -1);
+	float3 boundary = NEBULA_MIN + (cell + (cellStep > 0 ? 1.0 : 0.0)) * cellSize;
+	float3 tNext = abs(ray.d) > 1e-8 ? (boundary - ray.o) / ray.d : 1e10;
+	float3 tDelta = abs(ray.d) > 1e-8 ? cellSize / abs(ray.d) : 1e10;
+
+	float transmittance = 1.0;
+	float t = tNear;
+	int samples = 0;
+
+	[loop]
+	for (int i = 0; i < MAX_CELLS && t < tFar; i++)
+	{
+		int axis = tNext.x < tNext.y ? (tNext.x < tNext.z ? 0 : 2) : (tNext.y < tNext.z ? 1 : 2);
+		float cellExit = min(tNext[axis], tFar);
+		float maxDensity = maxDensityGrid.Load(int4(cell, 0));
+
+		if (maxDensity > 0.0)
+		{
+			float dt = clamp(MAX_OPTICAL_DEPTH_PER_STEP / (NEBULA_EXTINCTION * maxDensity), MIN_STEP, MAX_STEP);
+
+			[loop]
+			while (t < cellExit)
+			{
+				float segment = min(dt, cellExit - t);
+				float density = nebulaDensity(ray.o + (t + 0.5 * segment) * ray.d);
+				float absorbed = 1.0 - exp(-NEBULA_EXTINCTION * density * segment);
+				colour.rgb += nebulaEmission(density) * (transmittance * absorbed);
+				transmittance *= 1.0 - absorbed;
+				t += segment;
+				samples++;
+
+				if (1.0 - transmittance >= OPACITY_CUTOFF || samples >= MAX_SAMPLES)
+				{
+					colour.a = 1.0 - transmittance;
+					return colour;
+				}
+			}
+		}
+
+		t = cellExit;
+		cell[axis] += cellStep[axis];
+		if (cell[axis] < 0 || cell[axis] >= NEBULA_CELLS[axis]) break;
+		tNext[axis] += tDelta[axis];
+	}
+
+	colour.a = 1.0 - transmittance;
+	return colour;
+}
+
+float4 main(PixelShaderInput input) : SV_TARGET
+{
+	float width, height;
+	sceneDepth.GetDimensions(width, height);
+	float aspectRatio = projection._m00 / projection._m11;
+	float2 canvasXY = float2(2.0f * input.position.x / width - 1.0f, (1.0f - 2.0f * input.position.y / height) * aspectRatio);
+
+	Ray eyeray;
+	eyeray.o = cameraPosition;
+	eyeray.d = normalize(mul(float4(canvasXY, -MIN_DIST, 0.0f), transpose(view)));
+
+	//The nebula is hidden behind the rasterized geometry
+	float rayEnd = sceneDepthDistance(input.position.xy, eyeray.o, eyeray.d, 1e10, view, projection);
+
+	float4 colour = nebulaMarching(eyeray, rayEnd);
+	if (colour.a <= 0.0)
+	{
+		discard;
+	}
+
+	//Premultiplied, blended ONE, INV_SRC_ALPHA over what is already drawn
+	return colour;
+}
@@ -11,11 +11,16 @@ cbuffer CameraConstantBuffer : register(b1)
 	float padding;
 }
 
+#include "SceneDepth.hlsli"
+
 // Per-pixel color data passed through the pixel shader.
+//primitive is -1 for the full-screen quad, or the primitive whose bounding box proxy (VS_RayMarchProxies) covers the pixel
 struct PixelShaderInput
 {
 	float4 position : SV_POSITION;
-	float2 canvasXY : TEXCOORD0;
+	nointerpolation int primitive : PRIMITIVE;
+	nointerpolation float3 boxMin : BOXMIN;
+	nointerpolation float3 boxMax : BOXMAX;
 };
 
 #define NUMBER_OF_LIGHTS 1
@@ -243,6 +248,18 @@ float4 unionSDF(float4 sdfDisOne, float4 sdfDisTwo)
 	return (sdfDisOne.x < sdfDisTwo.x) ? sdfDisOne : sdfDisTwo;
 }
 
+//Polynomial smooth minimum, k is the blend distance, colours blend with the distances
+float4 smoothUnionSDF(float4 sdfDisOne, float4 sdfDisTwo, float k)
+{
+	float h = saturate(0.5 + 0.5 * (sdfDisTwo.x - sdfDisOne.x) / k);
+	return float4(lerp(sdfDisTwo.x, sdfDisOne.x, h) - k * h * (1.0 - h), lerp(sdfDisTwo.yzw, sdfDisOne.yzw, h));
+}
+
+float4 intersectionSDF(float4 sdfDisOne, float4 sdfDisTwo)
+{
+	return (sdfDisOne.x > sdfDisTwo.x) ? sdfDisOne : sdfDisTwo;
+}
+
 float3 twistSDF(float3 p, float rep)
 {
 	float  c = cos(rep * p.y + rep);
@@ -255,87 +272,411 @@ static float3 va = float3(0.0, 0.57735, 0.0);
 static float3 vb = float3(0.0, -1.0, 1.15470);
 static float3 vc = float3(1.0, -1.0, -0.57735);
 static float3 vd = float3(-1.0, -1.0, -0.57735);
+//|v|^2 of each vertex, dot(p - v, p - v) = dot(p, p) - 2 dot(p, v) + |v|^2 and dot(p, p) is shared
+static float4 vLengthSquared = float4(dot(va, va), dot(vb, vb), dot(vc, vc), dot(vd, vd));
+//Rows are the vertices, one mul gives dot(p, v) for all four
+static float4x3 vertices = float4x3(va, vb, vc, vd);
 
-float4 SierpinskiTetrahedron(float3 p)
+//Below 1 keeps more iterations than the pixel footprint needs
+static float FRACTAL_FOOTPRINT_SCALE = 0.5;
+
+//Fewest folds, the proxy box and bounding sphere reach 2 / 2^n past the tetrahedron to hold the level n spheres
+static float SIERPINSKI_MIN_ITERATIONS = 4.0;
+
+//Folding iterations for a pixel footprint in the fractal's own units, past the level
+//whose tetrahedra are half a pixel across the detail cannot be seen
+float sierpinskiIterations(float footprint)
 {
-	float a = 0.0;
-	float s = 1.0;
+	if (footprint <= 0.0) return 8.0;
+	return clamp(log2(2.0 / footprint) + 1.0, SIERPINSKI_MIN_ITERATIONS, 8.0);
+}
+
+//iterations in [1, 8], a fraction blends the two nearest whole counts so the detail does not pop
+float4 SierpinskiTetrahedron(float3 p, float iterations)
+{
+	int whole = (int)iterations;
+	float blend = iterations - whole;
+	int count = blend > 0.0 ? whole + 1 : whole;
+
 	float r = 1.0;
-	float dm;
-	float3 v;
-	for (int i = 0; i < 8; i++)
+	float dm = 0.0;
+	float4 coarse = float4(0.0, 0.0, 0.0, 0.0);
+	for (int i = 0; i < count; i++)
 	{
-		float d, t;
-		d = dot(p - va, p - va);              v = va; dm = d; t = 0.0;
-		d = dot(p - vb, p - vb); if (d < dm) { v = vb; dm = d; t = 1.0; }
-		d = dot(p - vc, p - vc); if (d < dm) { v = vc; dm = d; t = 2.0; }
-		d = dot(p - vd, p - vd); if (d < dm) { v = vd; dm = d; t = 3.0; }
-		p = v + 2.0 * (p - v); r *= 2.0;
+		if (i == whole) coarse = float4((sqrt(dm) - 1.0) / r, saturate(p));
+
+		float4 d = vLengthSquared - 2.0 * mul(vertices, p);
+		float3 v = va; dm = d.x;
+		if (d.y < dm) { v = vb; dm = d.y; }
+		if (d.z < dm) { v = vc; dm = d.z; }
+		if (d.w < dm) { v = vd; dm = d.w; }
+		dm += dot(p, p);
+		p = 2.0 * p - v; r *= 2.0;
 	}
 
-	return float4((sqrt(dm) - 1.0) / r, saturate(p));
+	float4 fine = float4((sqrt(dm) - 1.0) / r, saturate(p));
+	return count == whole ? fine : lerp(coarse, fine, blend);
+}
+
+float4 SierpinskiTetrahedron(float3 p)
+{
+	return SierpinskiTetrahedron(p, 8.0);
+}
+
+#define NUMBER_OF_PRIMITIVES 17
+
+//Bounding sphere of every primitive in sceneSDF, centre (xyz) and radius (w)
+//Generated from SDFScene::ComputeBoundingSphere, keep the order in step with primitiveSDF
+static float4 primitiveBounds[NUMBER_OF_PRIMITIVES] = {
+	{0.3000, 0.5300, 0.3100, 0.0682},
+	{0.0000, 0.5000, 0.0000, 0.0548},
+	{0.3000, 0.5000, 0.0000, 0.0507},
+	{0.0000, 0.5000, 0.3000, 0.0506},
+	{-0.3000, 0.5000, -0.3000, 0.0506},
+	{0.0000, 0.5000, -0.3000, 0.0517},
+	{-0.3000, 0.5000, 0.0000, 0.0876},
+	{-0.3000, 0.5000, 0.3000, 0.0863},
+	{0.3000, 0.5000, -0.3000, 0.0507},
+	{-0.6000, 0.5000, -0.3000, 0.0545},
+	{-0.6090, 0.5290, 0.0100, 0.0510},
+	{-0.6000, 0.5000, 0.3000, 0.0453},
+	{0.3000, 0.5000, 0.6000, 0.0479},
+	{0.0000, 0.5000, 0.6000, 0.0708},
+	{-0.3000, 0.5000, 0.6000, 0.0593},
+	{-0.6000, 0.5300, 0.6000, 0.0708},
+	{-1.0000, 1.6972, -2.0000, 0.6794}
+};
+
+//Distance (x) and colour (yzw) of a single primitive of the scene
+//footprint = world size of a pixel at the sample point, 0 for full detail
+float4 primitiveSDF(int index, float3 samplePoint, float footprint)
+{
+	switch (index)
+	{
+	//Ray Marched Implicit Geometric Primitives
+	case 0: return float4(roundConeSDF(samplePoint - float3(0.3, 0.5f, 0.3), float3(0.02, 0.0, 0.0), float3(-0.02, 0.06, 0.02), 0.03, 0.01), 0.18f, 0.22f, 1.0f);
+	case 1: return float4(coneSDF(samplePoint - float3(0.0, 0.53f, 0.0), float3(0.16, 0.12, 0.06)), 0.55f, 0.23f, 0.38f);
+	case 2: return float4(cappedConeSDF(samplePoint - float3(0.3, 0.5f, 0.0f), 0.03, 0.04, 0.02), 0.80f, 0.78f, 0.45f);
+	case 3: return float4(0.6 * torusSDF(twistSDF(samplePoint - float3(0.0, 0.5f, 0.3), 60.0f), float2(0.04, 0.01)), 0.28f, 0.51f, 0.08f);
+	case 4: return float4(torusSDF(samplePoint - float3(-0.3, 0.5f, -0.3), float2(0.04, 0.01)), 0.41f, 0.27f, 0.54f);
+	case 5: return float4(torus82SDF(samplePoint - float3(0.0, 0.5f, -0.3), float2(0.04, 0.01)), 0.52f, 0.75f, 0.42f);
+	case 6: return float4(boxSDF(samplePoint - float3(-0.3, 0.5f, 0.0), float3(0.05f, 0.05f, 0.05f)), 0.31f, 0.47f, 0.63f);
+	case 7: return float4(roundBoxSDF(samplePoint - float3(-0.3, 0.5f, 0.3), float3(0.04f, 0.04f, 0.04f), 0.016), 1.0f, 0.27f, 0.0f);
+	case 8: return float4(ellipsoidSDF(samplePoint - float3(0.3, 0.5f, -0.3), float3(0.05, 0.05, 0.02)), 0.8f, 0.41f, 0.79f);
+	case 9: return float4(triPrismSDF(samplePoint - float3(-0.6, 0.5f, -0.3), float2(0.05, 0.02)), 0.92f, 0.68f, 0.92f);
+	case 10: return float4(cylinderSDF(samplePoint - float3(-0.6, 0.5f, 0.0), float3(0.002, -0.002, 0.0), float3(-0.02, 0.06, 0.02), 0.016), 0.78f, 0.38f, 0.08f);
+	case 11: return float4(cylinderSDF(samplePoint - float3(-0.6, 0.5f, 0.3), float2(0.02, 0.04)), 0.98f, 0.63f, 0.42f);
+	case 12: return float4(cylinder6SDF(samplePoint - float3(0.3, 0.5f, 0.6), float2(0.02, 0.04)), 0.29f, 0.46f, 0.43f);
+	case 13: return float4(octahedronSDF(samplePoint - float3(0.0, 0.5f, 0.6), 0.07), 0.46f, 0.61f, 0.52f);
+	case 14: return float4(hexPrismSDF(samplePoint - float3(-0.3, 0.5f, 0.6), float2(0.05, 0.01)), 0.59f, 1.0f, 1.0f);
+	case 15: return float4(roundConeSDF(samplePoint - float3(-0.6, 0.5f, 0.6), 0.04, 0.02, 0.06), 1.0f, 0.2f, 0.0f);
+
+	//SierpinskiTetrahedron
+	default: return SierpinskiTetrahedron(2.0f * (samplePoint - float3(-1.0f, 2.0f, -2.0f)), sierpinskiIterations(2.0f * footprint * FRACTAL_FOOTPRINT_SCALE));
+	}
+}
+
+//Asteroid belt of hashed rocks repeated over xz, SDFRepeatedField is the CPU reference
+#define REPEATED_FIELD 0
+
+static float3 REPEATED_ORIGIN = float3(0.0, -0.3, 0.0);
+static float3 REPEATED_SPACING = float3(0.8, 0.0, 0.8);
+static float3 REPEATED_LIMIT = float3(-1.0, 0.0, -1.0);
+static float REPEATED_JITTER = 0.12;
+static float REPEATED_EMPTY = 0.3;
+//Farthest surface of any rock from its cell's centre, from SDFRepeatedField::GetInstanceRadius
+static float REPEATED_INSTANCE_RADIUS = 0.3378;
+
+float hash(float n)
+{
+	return frac(sin(n) * 43758.5453);
+}
+
+//Cell holding p, 0 on axes with no spacing, clamped to +-limit where the limit is not negative
+float3 repeatCell(float3 p, float3 spacing, float3 limit)
+{
+	float3 cell = spacing > 0.0 ? floor(p / max(spacing, 1e-6) + 0.5) : 0.0;
+	return limit >= 0.0 ? clamp(cell, -limit, limit) : cell;
+}
+
+//p relative to the centre of a cell, mirrored repetition flips odd cells
+float3 repeatLocal(float3 p, float3 cell, float3 spacing, bool mirrored)
+{
+	float3 local = p - cell * spacing;
+	return (mirrored && fmod(abs(cell), 2.0) == 1.0) ? -local : local;
+}
+
+//The rock of one cell, its shape, size, offset and colour are hashed from the cell
+float4 repeatedCellSDF(float3 local, float3 cell)
+{
+	float n = cell.x + cell.y * 57.0 + 113.0 * cell.z;
+	if (hash(n) < REPEATED_EMPTY) return float4(1e10, 0.0f, 0.0f, 0.0f);
+
+	int type = min((int)(hash(n + 0.1) * 4.0), 3);
+	float scale = lerp(0.5, 1.0, hash(n + 0.2));
+	float3 offset = (2.0 * float3(hash(n + 0.3), hash(n + 0.4), hash(n + 0.5)) - 1.0) * REPEATED_JITTER * 0.57735;
+	float3 p = (local - offset) / scale;
+
+	float distance;
+	float3 colour;
+	switch (type)
+	{
+	case 0: distance = roundBoxSDF(p, float3(0.1, 0.08, 0.12), 0.04); colour = float3(0.45f, 0.38f, 0.33f); break;
+	case 1: distance = octahedronSDF(p, 0.18); colour = float3(0.52f, 0.5f, 0.47f); break;
+	case 2: distance = boxSDF(p, float3(0.1, 0.12, 0.09)); colour = float3(0.36f, 0.31f, 0.3f); break;
+	default: distance = torusSDF(p, float2(0.12, 0.05)); colour = float3(0.6f, 0.55f, 0.42f); break;
+	}
+
+	return float4(scale * distance, (colour + float3(hash(n + 0.6), hash(n + 0.7), hash(n + 0.8))) * 0.5);
+}
+
+//The whole belt for the price of one rock in most steps, however many cells it has
+float4 repeatedFieldSDF(float3 samplePoint)
+{
+	float3 p = samplePoint - REPEATED_ORIGIN;
+	float3 cell = repeatCell(p, REPEATED_SPACING, REPEATED_LIMIT);
+	float4 closestHit = repeatedCellSDF(repeatLocal(p, cell, REPEATED_SPACING, false), cell);
+
+	//A neighbour's rock is only evaluated when the sphere around it is nearer than what was found
+	for (int x = -1; x <= 1; x++)
+	{
+		for (int z = -1; z <= 1; z++)
+		{
+			float3 neighbour = cell + float3(x, 0.0, z);
+			if ((x == 0 && z == 0) || length(p - neighbour * REPEATED_SPACING) - REPEATED_INSTANCE_RADIUS >= closestHit.x) continue;
+
+			closestHit = unionSDF(closestHit, repeatedCellSDF(repeatLocal(p, neighbour, REPEATED_SPACING, false), neighbour));
+		}
+	}
+
+	//Rocks two or more cells over are at least their sphere's distance away
+	float2 along = 2.0 * REPEATED_SPACING.xz - abs(p.xz - cell.xz * REPEATED_SPACING.xz);
+	float nearest = min(along.x, along.y);
+	closestHit.x = min(closestHit.x, sqrt(nearest * nearest + p.y * p.y) - REPEATED_INSTANCE_RADIUS);
+
+	return closestHit;
 }
 
 //Signed Distance Function for the scene, function return value of called SDF 
 //Determines location of P relative to the surface of the function (sphere)
-float4 sceneSDF(float3 samplePoint)
+float4 sceneSDF(float3 samplePoint, float footprint)
 {
 	//Contains hit distance (x) and colour (yzw)
 	float4 closestHit = float4(1e10, 0.0f, 0.0f, 0.0f);
-	
-	//Ray Marched Implicit Geometric Primitives
-	closestHit = unionSDF(closestHit, float4(roundConeSDF(samplePoint - float3(0.3, 0.5f, 0.3), float3(0.02, 0.0, 0.0), float3(-0.02, 0.06, 0.02), 0.03, 0.01), 0.18f, 0.22f, 1.0f));
-	closestHit = unionSDF(closestHit, float4(coneSDF(samplePoint - float3(0.0, 0.53f, 0.0), float3(0.16, 0.12, 0.06)), 0.55f, 0.23f, 0.38f));
-	closestHit = unionSDF(closestHit, float4(cappedConeSDF(samplePoint - float3(0.3, 0.5f, 0.0f), 0.03, 0.04, 0.02), 0.80f, 0.78f, 0.45f));
-	closestHit = unionSDF(closestHit, float4(0.6 * torusSDF(twistSDF(samplePoint - float3(0.0, 0.5f, 0.3), 60.0f), float2(0.04, 0.01)), 0.28f, 0.51f, 0.08f));
-	closestHit = unionSDF(closestHit, float4(torusSDF(samplePoint - float3(-0.3, 0.5f, -0.3), float2(0.04, 0.01)), 0.41f, 0.27f, 0.54f));
-	closestHit = unionSDF(closestHit, float4(torus82SDF(samplePoint - float3(0.0, 0.5f, -0.3), float2(0.04, 0.01)), 0.52f, 0.75f, 0.42f));
-	closestHit = unionSDF(closestHit, float4(boxSDF(samplePoint - float3(-0.3, 0.5f, 0.0), float3(0.05f, 0.05f, 0.05f)), 0.31f, 0.47f, 0.63f));
-	closestHit = unionSDF(closestHit, float4(roundBoxSDF(samplePoint - float3(-0.3, 0.5f, 0.3), float3(0.04f, 0.04f, 0.04f), 0.016), 1.0f, 0.27f, 0.0f));
-	closestHit = unionSDF(closestHit, float4(ellipsoidSDF(samplePoint - float3(0.3, 0.5f, -0.3), float3(0.05, 0.05, 0.02)), 0.8f, 0.41f, 0.79f));
-	closestHit = unionSDF(closestHit, float4(triPrismSDF(samplePoint - float3(-0.6, 0.5f, -0.3), float2(0.05, 0.02)), 0.92f, 0.68f, 0.92f));
-	closestHit = unionSDF(closestHit, float4(cylinderSDF(samplePoint - float3(-0.6, 0.5f, 0.0), float3(0.002, -0.002, 0.0), float3(-0.02, 0.06, 0.02), 0.016), 0.78f, 0.38f, 0.08f));
-	closestHit = unionSDF(closestHit, float4(cylinderSDF(samplePoint - float3(-0.6, 0.5f, 0.3), float2(0.02, 0.04)), 0.98f, 0.63f, 0.42f));
-	closestHit = unionSDF(closestHit, float4(cylinder6SDF(samplePoint - float3(0.3, 0.5f, 0.6), float2(0.02, 0.04)), 0.29f, 0.46f, 0.43f));
-	closestHit = unionSDF(closestHit, float4(octahedronSDF(samplePoint - float3(0.0, 0.5f, 0.6), 0.07), 0.46f, 0.61f, 0.52f));
-	closestHit = unionSDF(closestHit, float4(hexPrismSDF(samplePoint - float3(-0.3, 0.5f, 0.6), float2(0.05, 0.01)), 0.59f, 1.0f, 1.0f));
-	closestHit = unionSDF(closestHit, float4(roundConeSDF(samplePoint - float3(-0.6, 0.5f, 0.6), 0.04, 0.02, 0.06), 1.0f, 0.2f, 0.0f));
 
-	//SierpinskiTetrahedron
-	closestHit = unionSDF(closestHit, SierpinskiTetrahedron(2.0f * (samplePoint - float3(-1.0f, 2.0f, -2.0f))));
-	
+	for (int i = 0; i < NUMBER_OF_PRIMITIVES; i++)
+	{
+		closestHit = unionSDF(closestHit, primitiveSDF(i, samplePoint, footprint));
+	}
+
+#if REPEATED_FIELD
+	closestHit = unionSDF(closestHit, repeatedFieldSDF(samplePoint));
+#endif
+
 	return closestHit;
 }
 
 //Calculate surface normals using the gradiant around a point by sampling through SDF
-float3 estimateGradiantNormal(float3 p)
+float3 estimateGradiantNormal(float3 p, float footprint)
+{
+	return normalize(float3(sceneSDF(float3(p.x + EPSILON, p.y, p.z), footprint).x - sceneSDF(float3(p.x - EPSILON, p.y, p.z), footprint).x,
+		sceneSDF(float3(p.x, p.y + EPSILON, p.z), footprint).x - sceneSDF(float3(p.x, p.y - EPSILON, p.z), footprint).x,
+		sceneSDF(float3(p.x, p.y, p.z + EPSILON), footprint).x - sceneSDF(float3(p.x, p.y, p.z - EPSILON), footprint).x));
+}
+
+//Ray interval (x = near, y = far) of every primitive's bounding sphere grown by margin
+//Returns a mask of the primitives whose bound the ray hits between start and end
+uint boundIntervals(Ray ray, float start, float end, float margin, out float2 intervals[NUMBER_OF_PRIMITIVES])
+{
+	uint mask = 0;
+
+	for (int i = 0; i < NUMBER_OF_PRIMITIVES; i++)
+	{
+		float3 oc = ray.o - primitiveBounds[i].xyz;
+		float b = dot(oc, ray.d);
+		float radius = primitiveBounds[i].w + margin;
+		float c = dot(oc, oc) - radius * radius;
+		float discriminant = b * b - c;
+
+		intervals[i] = float2(end, start);
+
+		if (discriminant >= 0.0f)
+		{
+			float s = sqrt(discriminant);
+			intervals[i] = float2(-b - s, -b + s);
+
+			if (intervals[i].y >= start && intervals[i].x <= end)
+			{
+				mask |= 1u << i;
+			}
+		}
+	}
+
+	return mask;
+}
+
+//Soft shadow march budget, SDFOcclusion is the CPU reference
+#define SHADOW_STEPS 32
+//k in min(k h / t), larger gives harder penumbrae
+static float SHADOW_SOFTNESS = 16.0;
+static float SHADOW_START = 0.005;
+static float SHADOW_MIN_STEP = 0.001;
+static float SHADOW_CUTOFF = 0.001;
+
+//Ambient occlusion taps along the normal, at most 5
+#define OCCLUSION_TAPS 5
+static float OCCLUSION_REACH = 0.06;
+static float OCCLUSION_STRENGTH = 6.0;
+
+//1 lit to 0 in shadow. Keeps the smallest k h / t along the ray to the light, with the closest
+//approach between two samples triangulated (Quilez, improved soft shadows) so few steps keep the penumbra
+float softShadow(float3 p, float3 normal, float3 lightPosition, float footprint)
+{
+	Ray ray;
+	ray.o = p + normal * SHADOW_START;
+	float end = length(lightPosition - p);
+	ray.d = (lightPosition - p) / end;
+
+	//Outside a bound grown by end / k, k h / t stays above 1 and the primitive cannot dim the light
+	float2 intervals[NUMBER_OF_PRIMITIVES];
+	uint activePrimitives = boundIntervals(ray, SHADOW_START, end, end / SHADOW_SOFTNESS, intervals);
+
+	float shadow = 1.0;
+	float t = SHADOW_START;
+	float previous = 1e10;
+
+	for (int i = 0; i < SHADOW_STEPS; i++)
+	{
+#if !REPEATED_FIELD
+		if (activePrimitives == 0)
+		{
+			//Left every bound, nothing else can shade the point
+			return shadow;
+		}
+#endif
+
+		float3 samplePoint = ray.o + t * ray.d;
+#if REPEATED_FIELD
+		float distance = repeatedFieldSDF(samplePoint).x;
+#else
+		float distance = 1e10;
+#endif
+		float boundStep = 1e10;
+
+		for (int j = 0; j < NUMBER_OF_PRIMITIVES; j++)
+		{
+			if ((activePrimitives & (1u << j)) == 0) continue;
+
+			if (t > intervals[j].y)
+			{
+				activePrimitives &= ~(1u << j);
+			}
+			else if (t < intervals[j].x)
+			{
+				boundStep = min(boundStep, intervals[j].x - t);
+			}
+			else
+			{
+				distance = min(distance, primitiveSDF(j, samplePoint, footprint).x);
+			}
+		}
+
+		//Between grown bounds, or a primitive dropped out and the distance jumped, start a new approach
+		if (distance >= 1e10 || distance > 2.0 * previous) previous = 1e10;
+
+		if (distance < 1e10)
+		{
+			float y = distance * distance / (2.0 * previous);
+			float d = sqrt(max(0.0, distance * distance - y * y));
+			shadow = min(shadow, SHADOW_SOFTNESS * d / max(1e-6, t - y));
+			previous = distance;
+
+			if (shadow < SHADOW_CUTOFF)
+			{
+				//Fully in shadow, further steps cannot brighten it
+				return 0.0;
+			}
+		}
+
+		t += max(min(distance, boundStep), SHADOW_MIN_STEP);
+
+		if (t >= end) break;
+	}
+
+	return shadow;
+}
+
+//1 open to 0 enclosed, compares the distance at taps along the normal with the tap's height
+float ambientOcclusion(float3 p, float3 normal, float footprint)
 {
-	return normalize(float3(sceneSDF(float3(p.x + EPSILON, p.y, p.z)).x - sceneSDF(float3(p.x - EPSILON, p.y, p.z)).x,
-		sceneSDF(float3(p.x, p.y + EPSILON, p.z)).x - sceneSDF(float3(p.x, p.y - EPSILON, p.z)).x,
-		sceneSDF(float3(p.x, p.y, p.z + EPSILON)).x - sceneSDF(float3(p.x, p.y, p.z - EPSILON)).x));
+	//A primitive whose bound is twice the reach away is further from every tap than the tap's height
+	uint candidates = 0;
+	for (int i = 0; i < NUMBER_OF_PRIMITIVES; i++)
+	{
+		if (length(p - primitiveBounds[i].xyz) - primitiveBounds[i].w < 2.0 * OCCLUSION_REACH) candidates |= 1u << i;
+	}
+
+#if !REPEATED_FIELD
+	if (candidates == 0) return 1.0;
+#endif
+
+	float occlusion = 0.0;
+	float weight = 1.0;
+	for (int tap = 0; tap < OCCLUSION_TAPS; tap++)
+	{
+		float h = OCCLUSION_TAPS > 1 ? OCCLUSION_REACH * (0.1 + 0.9 * tap / (OCCLUSION_TAPS - 1)) : OCCLUSION_REACH;
+		float3 samplePoint = p + normal * h;
+
+#if REPEATED_FIELD
+		float distance = repeatedFieldSDF(samplePoint).x;
+#else
+		float distance = 1e10;
+#endif
+		for (int j = 0; j < NUMBER_OF_PRIMITIVES; j++)
+		{
+			if (candidates & (1u << j)) distance = min(distance, primitiveSDF(j, samplePoint, footprint).x);
+		}
+
+		occlusion += max(0.0, h - distance) * weight;
+		weight *= 0.95;
+
+		//Fully occluded
+		if (OCCLUSION_STRENGTH * occlusion >= 1.0) return 0.0;
+
+		//With a slope of at most 1 no later tap can get closer to a surface than its height
+		if (distance >= 2.0 * OCCLUSION_REACH - h) break;
+	}
+
+	return saturate(1.0 - OCCLUSION_STRENGTH * occlusion);
 }
 
-float4 PhongIllumination(float surfacePoint, float3 normal, float shininess, float3 rayDirection, float4 diffuseColour)
+//footprint = world size of a pixel at the surface point, the shadow and occlusion sample the fractal at that detail
+float4 PhongIllumination(float3 surfacePoint, float3 normal, float shininess, float3 rayDirection, float4 diffuseColour, float footprint)
 {
 	float4 totalAmbient = float4(0.0f, 0.0f, 0.0f, 0.0f);
 	float4 totalDiffuse = float4(0.0f, 0.0f, 0.0f, 0.0f);
 	float4 totalSpecular = float4(0.0f, 0.0f, 0.0f, 0.0f);
 
+	float occlusion = ambientOcclusion(surfacePoint, normal, footprint);
+
 	for (int i = 0; i < NUMBER_OF_LIGHTS; i++)
 	{
-		totalAmbient += lights[i].ambientColour * diffuseColour;
+		totalAmbient += lights[i].ambientColour * diffuseColour * occlusion;
 
 		float3 lightDirection = normalize(lights[i].lightPosition - surfacePoint);
 		float nDotL = dot(normal, lightDirection);
 		float3 reflection = normalize(reflect(-lightDirection, normal));
 		float rDotV = max(0.0f, dot(reflection, -rayDirection));
 
-		totalDiffuse += saturate(lights[i].diffuseColour * nDotL * diffuseColour);
-
 		if (nDotL > 0.0f)
 		{
+			//Facing away from the light the surface shades itself, no shadow ray is needed
+			float shadow = softShadow(surfacePoint, normal, lights[i].lightPosition, footprint);
+
+			totalDiffuse += saturate(lights[i].diffuseColour * nDotL * diffuseColour) * shadow;
+
 			float4 specularIntensity = float4(1.0, 1.0, 1.0, 1.0);
-			totalSpecular += lights[i].specularColour * pow(pow(rDotV, lights[i].specularPower), shininess) * specularIntensity;
+			totalSpecular += lights[i].specularColour * pow(pow(rDotV, lights[i].specularPower), shininess) * specularIntensity * shadow;
 		}
 	}
 
@@ -344,13 +685,53 @@ float4 PhongIllumination(float surfacePoint, float3 normal, float shininess, flo
 
 //start = starting distance away from origin
 //end = max travel distance away from origin
-float4 rayMarching(Ray ray, float start, float end)
+//pixelAngle = angle a pixel subtends, the fractal's detail follows the pixel footprint along the ray
+float4 rayMarching(Ray ray, float start, float end, float pixelAngle)
 {
+	float2 intervals[NUMBER_OF_PRIMITIVES];
+	uint activePrimitives = boundIntervals(ray, start, end, 0.0f, intervals);
+
 	float depth = start;
 
 	for (int i = 0; i < MAX_MARCHING_STEPS; i++)
 	{
-		float4 distanceAndColour = sceneSDF(ray.o + depth * ray.d);
+#if !REPEATED_FIELD
+		if (activePrimitives == 0)
+		{
+			//Every bound is behind the ray or missed
+			break;
+		}
+#endif
+
+		float3 samplePoint = ray.o + depth * ray.d;
+#if REPEATED_FIELD
+		//The belt has no bound, it is evaluated every step
+		float4 distanceAndColour = repeatedFieldSDF(samplePoint);
+#else
+		float4 distanceAndColour = float4(1e10, 0.0f, 0.0f, 0.0f);
+#endif
+
+		//Distance to the next bound the ray has not entered yet, stepping further could skip its surface
+		float boundStep = 1e10;
+
+		for (int j = 0; j < NUMBER_OF_PRIMITIVES; j++)
+		{
+			if ((activePrimitives & (1u << j)) == 0) continue;
+
+			if (depth > intervals[j].y)
+			{
+				//Left the bound for good
+				activePrimitives &= ~(1u << j);
+			}
+			else if (depth + EPSILON < intervals[j].x)
+			{
+				boundStep = min(boundStep, intervals[j].x - depth);
+			}
+			else
+			{
+				distanceAndColour = unionSDF(distanceAndColour, primitiveSDF(j, samplePoint, pixelAngle * depth));
+			}
+		}
 
 		if (distanceAndColour.x < EPSILON)
 		{
@@ -359,7 +740,7 @@ float4 rayMarching(Ray ray, float start, float end)
 		}
 
 		//Move along the ray
-		depth += distanceAndColour.x;
+		depth += min(distanceAndColour.x, boundStep);
 
 		if (depth >= end)
 		{
@@ -371,20 +752,97 @@ float4 rayMarching(Ray ray, float start, float end)
 	return float4(end, 0.0f, 0.0f, 0.0f);
 }
 
+//Sphere traces a single primitive between start and end, what the pixels of its proxy march
+float4 proxyMarching(Ray ray, int primitive, float start, float end, float pixelAngle)
+{
+	float depth = start;
+
+	for (int i = 0; i < MAX_MARCHING_STEPS; i++)
+	{
+		float4 distanceAndColour = primitiveSDF(primitive, ray.o + depth * ray.d, pixelAngle * depth);
+
+		if (distanceAndColour.x < EPSILON)
+		{
+			return float4(depth, distanceAndColour.yzw);
+		}
+
+		depth += distanceAndColour.x;
+
+		if (depth >= end)
+		{
+			break;
+		}
+	}
+
+	return float4(end, 0.0f, 0.0f, 0.0f);
+}
+
+//Entry (x) and exit (y) distance of the ray through the box, x > y when it misses
+float2 boxInterval(Ray ray, float3 boxMin, float3 boxMax)
+{
+	float3 inverseDirection = 1.0f / ray.d;
+	float3 t0 = (boxMin - ray.o) * inverseDirection;
+	float3 t1 = (boxMax - ray.o) * inverseDirection;
+	float3 tNear = min(t0, t1);
+	float3 tFar = max(t0, t1);
+	return float2(max(tNear.x, max(tNear.y, tNear.z)), min(tFar.x, min(tFar.y, tFar.z)));
+}
+
+//Normal from a single primitive, a proxy's hit lies on its own primitive
+float3 primitiveNormal(int primitive, float3 p, float footprint)
+{
+	return normalize(float3(primitiveSDF(primitive, float3(p.x + EPSILON, p.y, p.z), footprint).x - primitiveSDF(primitive, float3(p.x - EPSILON, p.y, p.z), footprint).x,
+		primitiveSDF(primitive, float3(p.x, p.y + EPSILON, p.z), footprint).x - primitiveSDF(primitive, float3(p.x, p.y - EPSILON, p.z), footprint).x,
+		primitiveSDF(primitive, float3(p.x, p.y, p.z + EPSILON), footprint).x - primitiveSDF(primitive, float3(p.x, p.y, p.z - EPSILON), footprint).x));
+}
+
 // A pass-through function for the (interpolated) color data.
 outputPS main(PixelShaderInput input)
 {
 	outputPS output;
 
-	float3 PixelPos = float3(input.canvasXY, -MIN_DIST);
+	//Canvas position from the pixel, the same whether a proxy or the full-screen quad covers it
+	float width, height;
+	sceneDepth.GetDimensions(width, height);
+	float aspectRatio = projection._m00 / projection._m11;
+	float2 canvasXY = float2(2.0f * input.position.x / width - 1.0f, (1.0f - 2.0f * input.position.y / height) * aspectRatio);
+
+	float3 PixelPos = float3(canvasXY, -MIN_DIST);
 
 	Ray eyeray;
 	eyeray.o = cameraPosition;
 	eyeray.d = normalize(mul(float4(PixelPos, 0.0f), transpose(view)));
 
-	float4 distanceAndColour = rayMarching(eyeray, EPSILON, MAX_DIST);
+	//The canvas is MIN_DIST in front of the eye and 2 wide, its change across a pixel gives the pixel's angle
+	float pixelAngle = 2.0f / (width * MIN_DIST);
+
+	//Rays stop at the rasterized geometry in front of them, rays that start behind it are skipped
+	float rayEnd = sceneDepthDistance(input.position.xy, eyeray.o, eyeray.d, MAX_DIST, view, projection);
+	if (rayEnd <= EPSILON)
+	{
+		discard;
+	}
+
+	float4 distanceAndColour;
+	if (input.primitive < 0)
+	{
+		distanceAndColour = rayMarching(eyeray, EPSILON, rayEnd, pixelAngle);
+	}
+	else
+	{
+		//Only the box's span of the ray can reach the proxy's primitive
+		float2 span = boxInterval(eyeray, input.boxMin, input.boxMax);
+		rayEnd = min(rayEnd, span.y);
+		float rayStart = max(span.x, EPSILON);
+		if (rayStart >= rayEnd)
+		{
+			discard;
+		}
+
+		distanceAndColour = proxyMarching(eyeray, input.primitive, rayStart, rayEnd, pixelAngle);
+	}
 
-	if (distanceAndColour.x > MAX_DIST - EPSILON)
+	if (distanceAndColour.x > rayEnd - EPSILON)
 	{
 		discard;
 	}
@@ -395,7 +853,9 @@ outputPS main(PixelShaderInput input)
 	pv = mul(pv, projection);
 	output.depth = pv.z / pv.w;
 
-	output.colour = PhongIllumination(surfacePoint, estimateGradiantNormal(surfacePoint), 40.0f, eyeray.d, float4(distanceAndColour.yzw, 1.0));
+	float footprint = pixelAngle * distanceAndColour.x;
+	float3 normal = input.primitive < 0 ? estimateGradiantNormal(surfacePoint, footprint) : primitiveNormal(input.primitive, surfacePoint, footprint);
+	output.colour = PhongIllumination(surfacePoint, normal, 40.0f, eyeray.d, float4(distanceAndColour.yzw, 1.0), footprint);
 
 	output.colour = float4(lerp(output.colour.xyz, float3(1.0f, 0.97255f, 0.86275f), 1.0 - exp(-0.0005 * distanceAndColour.x * distanceAndColour.x * distanceAndColour.x)), 1.0f);
 
@@ -19,6 +19,8 @@ cbuffer InverseCB : register(b1) {
     matrix invView;
 }
 
+#include "SceneDepth.hlsli"
+
 static float4 LightColor = float4(1, 1, 1, 1);
 static float3 LightPos = float3(0, 10, 2);
 
@@ -92,9 +94,10 @@ float PlaneIntersect(Ray ray, float3 normal, float3 centre, out bool hit)
     return t;
 }
 
-float3 NearestHit(Ray ray, out int hitobj, out bool anyhit, out float mint, out float3 n)
+//maxt = furthest distance a hit counts at
+float3 NearestHit(Ray ray, float maxt, out int hitobj, out bool anyhit, out float mint, out float3 n)
 {
-    mint = farPlane;
+    mint = maxt;
     hitobj = -1;
     anyhit = false;
 
@@ -137,7 +140,8 @@ float4 Shade(float3 hitPos, float3 normal, float3 viewDir, int hitobj, float lig
     return LightColor * lightIntensity * Phong(normal, lightDir, viewDir, materials[hitobj].shininess, diff, spec) * shadowFactor;
 }
 
-float4 RayTracing(Ray ray, out bool anyHit)
+//Colour (xyz) and distance to the first hit (w), maxt clamps the eye ray only
+float4 RayTracing(Ray ray, float maxt, out bool anyHit)
 {
     int hitobj;
     bool hit = false;
@@ -146,7 +150,8 @@ float4 RayTracing(Ray ray, out bool anyHit)
     float lightInensity = 1.0;
     float mint = 0.0f;
 
-    float3 i = NearestHit(ray, hitobj, hit, mint, n);
+    float3 i = NearestHit(ray, maxt, hitobj, hit, mint, n);
+    float firstt = mint;
 
     for (int depth = 1; depth < 5; depth++)
     {
@@ -160,10 +165,10 @@ float4 RayTracing(Ray ray, out bool anyHit)
             lightInensity *= materials[hitobj].Kr;
             ray.o = i;
             ray.d = reflect(ray.d, n);
-            i = NearestHit(ray, hitobj, hit, mint, n);
+            i = NearestHit(ray, farPlane, hitobj, hit, mint, n);
         }
     }
-    return float4(c.xyz, mint);
+    return float4(c.xyz, firstt);
 }
 
 struct outputPS
@@ -182,23 +187,27 @@ outputPS main(VS_Quad input)
     eyeray.o = mul(float4(float3(0.0f, 0.0f, 0.0f), 1.0f), invView);
     eyeray.d = normalize(mul(float4(PixelPos, 0.0f), invView));
 
+    //Rays stop at the rasterized geometry in front of them, rays that start behind it are skipped
+    float rayEnd = sceneDepthDistance(input.position.xy, eyeray.o, eyeray.d, farPlane, view, projection);
+    if (rayEnd <= EPSILON) discard;
+
     bool anyhit = false;
-    float4 distanceAndColour = RayTracing(eyeray, anyhit);
+    float4 colourAndDistance = RayTracing(eyeray, rayEnd, anyhit);
 
-    if (distanceAndColour.x > farPlane - EPSILON)
+    if (colourAndDistance.w > rayEnd - EPSILON)
     {
         discard;
     }
 
     if (!anyhit) discard;
 	
-    float3 surfacePoint = cameraPos + distanceAndColour.x * eyeray.d;
+    float3 surfacePoint = cameraPos + colourAndDistance.w * eyeray.d;
 
     float4 pv = mul(float4(surfacePoint, 1.0f), view);
     pv = mul(pv, projection);
     output.depth = pv.z / pv.w;
 
-    output.colour = float4(distanceAndColour.yzw, 1.0f);
+    output.colour = float4(colourAndDistance.xyz, 1.0f);
 
     //output.colour = float4(lerp(output.colour.xyz, float3(1.0f, 0.97255f, 0.86275f), 1.0 - exp(-0.0005 * distanceAndColour.x * distanceAndColour.x * distanceAndColour.x)), 1.0f);
 
@@ -0,0 +1,277 @@
+#include "PatchCulling.h"
+#include <algorithm>
+#include <cmath>
+#include "Common/ParallelFor.h"
+#include "TerrainBaker.h"
+
+#ifdef PATCH_CULLING_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace HLSL;
+
+void PatchBounds::Clear()
+{
+	for (auto array : { &minX, &minY, &minZ, &maxX, &maxY, &maxZ, &axisX, &axisY, &axisZ, &coneSine })
+	{
+		array->clear();
+	}
+}
+
+void PatchBounds::Add(const float3& boxMin, const float3& boxMax, const float3& axis, float sine)
+{
+	minX.push_back(boxMin.x);
+	minY.push_back(boxMin.y);
+	minZ.push_back(boxMin.z);
+	maxX.push_back(boxMax.x);
+	maxY.push_back(boxMax.y);
+	maxZ.push_back(boxMax.z);
+	axisX.push_back(axis.x);
+	axisY.push_back(axis.y);
+	axisZ.push_back(axis.z);
+	coneSine.push_back(sine);
+}
+
+void PatchBounds::AddTerrainCells(const TerrainMaps& maps, float x, float z, float size, int cells)
+{
+	const auto resolution = maps.GetMipResolution(0);
+	const auto halfSize = maps.GetSettings().halfSize;
+	const auto& heights = maps.GetHeights(0);
+	const auto& normals = maps.GetNormals(0);
+	const auto cellSize = size / cells;
+
+	// Texels whose bilinear footprint reaches into [from, to], clamped like the sampler
+	const auto texel = [resolution, halfSize](float position) { return (position / halfSize + 1.0f) * 0.5f * resolution - 0.5f; };
+	const auto first = [resolution, &texel](float from) { return std::min(std::max(static_cast<int>(std::floor(texel(from))), 0), resolution - 1); };
+	const auto last = [resolution, &texel](float to) { return std::min(std::max(static_cast<int>(std::ceil(texel(to))), 0), resolution - 1); };
+
+	for (auto row = 0; row < cells; row++)
+	{
+		const auto z0 = z + row * cellSize;
+		for (auto column = 0; column < cells; column++)
+		{
+			const auto x0 = x + column * cellSize;
+
+			auto minHeight = 1e30f;
+			auto maxHeight = -1e30f;
+			auto sum = float3(0.0f);
+			for (auto v = first(z0); v <= last(z0 + cellSize); v++)
+			{
+				for (auto u = first(x0); u <= last(x0 + cellSize); u++)
+				{
+					minHeight = std::min(minHeight, heights[v * resolution + u]);
+					maxHeight = std::max(maxHeight, heights[v * resolution + u]);
+					sum += TerrainMaps::UnpackNormal(normals[v * resolution + u]);
+				}
+			}
+
+			// The cone's half angle is the widest any normal is from their average
+			const auto axis = normalize(sum);
+			auto minCosine = 1.0f;
+			for (auto v = first(z0); v <= last(z0 + cellSize); v++)
+			{
+				for (auto u = first(x0); u <= last(x0 + cellSize); u++)
+				{
+					minCosine = std::min(minCosine, dot(axis, TerrainMaps::UnpackNormal(normals[v * resolution + u])));
+				}
+			}
+			const auto sine = minCosine > 0.0f ? std::sqrt(1.0f - minCosine * minCosine) : 1.0f;
+
+			Add(float3(x0, minHeight, z0), float3(x0 + cellSize, maxHeight, z0 + cellSize), axis, sine);
+		}
+	}
+}
+
+CullingFrustum MakeCullingFrustum(const float* m)
+{
+	// Gribb and Hartmann: clip = p M, so each clip coordinate is p dotted with a column
+	const auto column = [m](int c) { return float4(m[c], m[4 + c], m[8 + c], m[12 + c]); };
+	const auto x = column(0);
+	const auto y = column(1);
+	const auto z = column(2);
+	const auto w = column(3);
+
+	CullingFrustum frustum;
+	frustum.planes[0] = w + x;		// left
+	frustum.planes[1] = w - x;		// right
+	frustum.planes[2] = w + y;		// bottom
+	frustum.planes[3] = w - y;		// top
+	frustum.planes[4] = z;			// near, depth from 0
+	frustum.planes[5] = w - z;		// far
+	for (auto& plane : frustum.planes)
+	{
+		plane = plane * (1.0f / length(float3(plane.x, plane.y, plane.z)));
+	}
+	return frustum;
+}
+
+namespace
+{
+	const std::uint8_t Visible = 0;
+	const std::uint8_t FrustumCulled = 1;
+	const std::uint8_t BackfaceCulled = 2;
+
+	// Patches per work item, a multiple of the vector width
+	const int BlockSize = 4096;
+
+	std::uint8_t ClassifyPatch(const PatchBounds& bounds, int i, const CullingFrustum& frustum, const float3& camera, const PatchCullingSettings& settings)
+	{
+		if (settings.frustum)
+		{
+			// The corner furthest along each plane's normal, outside when even that one is
+			for (const auto& plane : frustum.planes)
+			{
+				const auto x = plane.x >= 0.0f ? bounds.maxX[i] : bounds.minX[i];
+				const auto y = plane.y >= 0.0f ? bounds.maxY[i] : bounds.minY[i];
+				const auto z = plane.z >= 0.0f ? bounds.maxZ[i] : bounds.minZ[i];
+				if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) return FrustumCulled;
+			}
+		}
+
+		if (settings.backface)
+		{
+			// Every normal in the cone faces away from every point of the box's bounding sphere
+			// when the direction to its centre is more than the cone's angle plus the sphere's
+			// past 90 degrees from the axis; sin(a + b) <= sin a + sin b keeps it conservative.
+			const auto hx = 0.5f * (bounds.maxX[i] - bounds.minX[i]);
+			const auto hy = 0.5f * (bounds.maxY[i] - bounds.minY[i]);
+			const auto hz = 0.5f * (bounds.maxZ[i] - bounds.minZ[i]);
+			const auto vx = bounds.minX[i] + hx - camera.x;
+			const auto vy = bounds.minY[i] + hy - camera.y;
+			const auto vz = bounds.minZ[i] + hz - camera.z;
+			const auto distance = std::sqrt(vx * vx + vy * vy + vz * vz);
+			const auto radius = std::sqrt(hx * hx + hy * hy + hz * hz);
+			if (vx * bounds.axisX[i] + vy * bounds.axisY[i] + vz * bounds.axisZ[i] > bounds.coneSine[i] * distance + radius) return BackfaceCulled;
+		}
+
+		return Visible;
+	}
+
+	void CullBlockScalar(const PatchBounds& bounds, int begin, int end, const CullingFrustum& frustum, const float3& camera,
+		const PatchCullingSettings& settings, std::vector<std::uint32_t>& visible, PatchCullingStats& stats)
+	{
+		for (auto i = begin; i < end; i++)
+		{
+			const auto patchClass = ClassifyPatch(bounds, i, frustum, camera, settings);
+			if (patchClass == Visible) visible.push_back(static_cast<std::uint32_t>(i));
+			stats.frustumCulled += patchClass == FrustumCulled;
+			stats.backfaceCulled += patchClass == BackfaceCulled;
+		}
+	}
+
+#ifdef PATCH_CULLING_SSE2
+	// ClassifyPatch four at a time, the same operations in the same order so the same results
+	void CullBlockSSE2(const PatchBounds& bounds, int begin, int end, const CullingFrustum& frustum, const float3& camera,
+		const PatchCullingSettings& settings, std::vector<std::uint32_t>& visible, PatchCullingStats& stats)
+	{
+		// Each plane's broadcast coefficients and the arrays holding its furthest corners
+		struct Plane
+		{
+			__m128 x, y, z, w;
+			const float* cornerX;
+			const float* cornerY;
+			const float* cornerZ;
+		};
+		Plane planes[6];
+		const auto planeCount = settings.frustum ? 6 : 0;
+		for (auto p = 0; p < planeCount; p++)
+		{
+			const auto& plane = frustum.planes[p];
+			planes[p] = { _mm_set1_ps(plane.x), _mm_set1_ps(plane.y), _mm_set1_ps(plane.z), _mm_set1_ps(plane.w),
+				(plane.x >= 0.0f ? bounds.maxX : bounds.minX).data(),
+				(plane.y >= 0.0f ? bounds.maxY : bounds.minY).data(),
+				(plane.z >= 0.0f ? bounds.maxZ : bounds.minZ).data() };
+		}
+
+		const auto zero = _mm_setzero_ps();
+		const auto half = _mm_set1_ps(0.5f);
+		const auto cameraX = _mm_set1_ps(camera.x);
+		const auto cameraY = _mm_set1_ps(camera.y);
+		const auto cameraZ = _mm_set1_ps(camera.z);
+		static const int bitCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+		auto i = begin;
+		for (; i + 4 <= end; i += 4)
+		{
+			auto outside = zero;
+			for (auto p = 0; p < planeCount; p++)
+			{
+				const auto& plane = planes[p];
+				const auto distance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.x, _mm_loadu_ps(plane.cornerX + i)), _mm_mul_ps(plane.y, _mm_loadu_ps(plane.cornerY + i))),
+					_mm_mul_ps(plane.z, _mm_loadu_ps(plane.cornerZ + i))), plane.w);
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero));
+			}
+			auto outsideBits = _mm_movemask_ps(outside);
+
+			// Skipped when all four are already out
+			auto backBits = 0;
+			if (settings.backface && outsideBits != 15)
+			{
+				const auto minX = _mm_loadu_ps(bounds.minX.data() + i);
+				const auto minY = _mm_loadu_ps(bounds.minY.data() + i);
+				const auto minZ = _mm_loadu_ps(bounds.minZ.data() + i);
+				const auto hx = _mm_mul_ps(half, _mm_sub_ps(_mm_loadu_ps(bounds.maxX.data() + i), minX));
+				const auto hy = _mm_mul_ps(half, _mm_sub_ps(_mm_loadu_ps(bounds.maxY.data() + i), minY));
+				const auto hz = _mm_mul_ps(half, _mm_sub_ps(_mm_loadu_ps(bounds.maxZ.data() + i), minZ));
+				const auto vx = _mm_sub_ps(_mm_add_ps(minX, hx), cameraX);
+				const auto vy = _mm_sub_ps(_mm_add_ps(minY, hy), cameraY);
+				const auto vz = _mm_sub_ps(_mm_add_ps(minZ, hz), cameraZ);
+				const auto distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+				const auto radius = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(hx, hx), _mm_mul_ps(hy, hy)), _mm_mul_ps(hz, hz)));
+				const auto along = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_loadu_ps(bounds.axisX.data() + i)), _mm_mul_ps(vy, _mm_loadu_ps(bounds.axisY.data() + i))),
+					_mm_mul_ps(vz, _mm_loadu_ps(bounds.axisZ.data() + i)));
+				const auto limit = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(bounds.coneSine.data() + i), distance), radius);
+				backBits = _mm_movemask_ps(_mm_cmpgt_ps(along, limit)) & ~outsideBits;
+			}
+
+			const auto visibleBits = ~(outsideBits | backBits) & 15;
+			stats.frustumCulled += bitCounts[outsideBits];
+			stats.backfaceCulled += bitCounts[backBits];
+			for (auto lane = 0; lane < 4; lane++)
+			{
+				if (visibleBits >> lane & 1) visible.push_back(static_cast<std::uint32_t>(i + lane));
+			}
+		}
+
+		CullBlockScalar(bounds, i, end, frustum, camera, settings, visible, stats);
+	}
+#endif
+}
+
+PatchCullingStats CullPatches(const PatchBounds& bounds, const CullingFrustum& frustum, const float3& camera,
+	const PatchCullingSettings& settings, std::vector<std::uint32_t>& visible)
+{
+	const auto count = bounds.GetCount();
+	const auto blocks = (count + BlockSize - 1) / BlockSize;
+	std::vector<std::vector<std::uint32_t>> blockVisible(blocks);
+	std::vector<PatchCullingStats> blockStats(blocks, PatchCullingStats());
+
+	// Each block gathers its own visible indices, then they are joined in block order
+	ParallelFor(0, blocks, settings.threads, [&](int block)
+	{
+		const auto begin = block * BlockSize;
+		const auto end = std::min(begin + BlockSize, count);
+		blockVisible[block].reserve(end - begin);
+#ifdef PATCH_CULLING_SSE2
+		if (settings.simd)
+		{
+			CullBlockSSE2(bounds, begin, end, frustum, camera, settings, blockVisible[block], blockStats[block]);
+			return;
+		}
+#endif
+		CullBlockScalar(bounds, begin, end, frustum, camera, settings, blockVisible[block], blockStats[block]);
+	});
+
+	PatchCullingStats result = {};
+	result.patches = count;
+	visible.clear();
+	for (auto block = 0; block < blocks; block++)
+	{
+		result.frustumCulled += blockStats[block].frustumCulled;
+		result.backfaceCulled += blockStats[block].backfaceCulled;
+		visible.insert(visible.end(), blockVisible[block].begin(), blockVisible[block].end());
+	}
+	result.visible = static_cast<int>(visible.size());
+
+	return result;
+}
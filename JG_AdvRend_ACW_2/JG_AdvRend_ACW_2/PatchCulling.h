@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Common/ShaderMath.h"
+
+class TerrainMaps;
+
+// SSE2 is compiled in on x86 and x64, other platforms only have the scalar path
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PATCH_CULLING_SSE2
+#endif
+
+// Bounds of tessellated patches as structure of arrays, each box holding everything the domain shader can move the patch to
+struct PatchBounds
+{
+	std::vector<float> minX, minY, minZ;
+	std::vector<float> maxX, maxY, maxZ;
+	// A cone holding every normal of the patch, its unit axis and the sine of its half angle, 1 never backface culled
+	std::vector<float> axisX, axisY, axisZ, coneSine;
+
+	int GetCount() const { return static_cast<int>(minX.size()); }
+	void Clear();
+	void Add(const HLSL::float3& boxMin, const HLSL::float3& boxMax, const HLSL::float3& axis = HLSL::float3(0.0f, 1.0f, 0.0f), float sine = 1.0f);
+	// A square of cells x cells terrain cells, rows of x along z, bounding the height and normal map texels under each
+	void AddTerrainCells(const TerrainMaps& maps, float x, float z, float size, int cells);
+};
+
+// Planes with normals pointing in, inside where dot(plane.xyz, p) + plane.w >= 0
+struct CullingFrustum
+{
+	HLSL::float4 planes[6];
+};
+
+// From a row vector view projection matrix with depth in [0, 1], XMFLOAT4X4's m[row * 4 + column]
+CullingFrustum MakeCullingFrustum(const float* viewProjection);
+
+struct PatchCullingSettings
+{
+	bool frustum = true;
+	bool backface = true;	// only where the camera can't see the patch's back, above a heightfield or outside a closed mesh
+	bool simd = true;		// SSE2 where compiled in
+	int threads = 0;		// 0 uses every hardware thread
+};
+
+struct PatchCullingStats
+{
+	int patches;
+	int frustumCulled;
+	int backfaceCulled;		// of those inside the frustum
+	int visible;
+};
+
+// Writes the indices of the patches that may be seen, in order
+PatchCullingStats CullPatches(const PatchBounds& bounds, const CullingFrustum& frustum, const HLSL::float3& camera,
+	const PatchCullingSettings& settings, std::vector<std::uint32_t>& visible);
@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "Pottery.h"
+#include "BezierPatch.h"
 
 Pottery::Pottery(const shared_ptr<DeviceResources>& device)
 	: _device(device), _position(0.0f, 0.9f, 1.0f), _rotation(-XM_PIDIV2, 0.0f, 0.0f), _scale(0.03f, 0.03f, 0.1f), _loadingComplete(false), _indexCount(0)
@@ -112,99 +113,12 @@ void Pottery::CreateDeviceDependentResources()
 
 	// Once both shaders are loaded, create the mesh.
 	auto createSphere = (createPSTask && createVSTask && createHSTask && createDSTask && createGSTask).then([this]() {
-		static VertexPosition pointVertices[168] = {
-			// Handle
-			{ XMFLOAT3(-1.6000, 0.0000, 2.02500)}, { XMFLOAT3(-1.6000, -0.3000, 2.02500)},
-			{ XMFLOAT3(-1.5000, -0.3000, 2.25000)}, { XMFLOAT3(-1.5000, 0.0000, 2.25000)},
-			{ XMFLOAT3(-2.3000, 0.0000, 2.02500)}, { XMFLOAT3(-2.3000, -0.3000, 2.02500)},
-			{ XMFLOAT3(-2.5000, -0.3000, 2.25000)}, { XMFLOAT3(-2.5000, 0.0000, 2.25000)},
-			{ XMFLOAT3(-2.7000, 0.0000, 2.02500)}, { XMFLOAT3(-2.7000, -0.3000, 2.02500)},
-			{ XMFLOAT3(-3.0000, -0.3000, 2.25000)}, { XMFLOAT3(-3.0000, 0.0000, 2.25000)},
-			{ XMFLOAT3(-2.7000, 0.0000, 1.80000)}, { XMFLOAT3(-2.7000, -0.3000, 1.80000)},
-			{ XMFLOAT3(-3.0000, -0.3000, 1.80000)}, { XMFLOAT3(-3.0000, 0.0000, 1.80000)},
-			{ XMFLOAT3(-2.7000, 0.0000, 1.57500)}, { XMFLOAT3(-2.7000, -0.3000, 1.57500)},
-			{ XMFLOAT3(-3.0000, -0.3000, 1.35000)}, { XMFLOAT3(-3.0000, 0.0000, 1.35000)},
-			{ XMFLOAT3(-2.5000, 0.0000, 1.12500)}, { XMFLOAT3(-2.5000, -0.3000, 1.12500)},
-			{ XMFLOAT3(-2.6500, -0.3000, 0.93750)}, { XMFLOAT3(-2.6500, 0.0000, 0.93750)},
-			{ XMFLOAT3(-2.0000, 0.0000, 0.90000)}, { XMFLOAT3(-2.0000, -0.3000, 0.90000)},
-			{ XMFLOAT3(-1.9000, -0.3000, 0.60000)}, { XMFLOAT3(-1.9000, 0.0000, 0.60000)},
-
-			{ XMFLOAT3(-1.6000, 0.0000, 2.02500)}, { XMFLOAT3(-1.6000, 0.3000, 2.02500)},
-			{ XMFLOAT3(-1.5000, 0.3000, 2.25000)}, { XMFLOAT3(-1.5000, 0.0000, 2.25000)},
-			{ XMFLOAT3(-2.3000, 0.0000, 2.02500)}, { XMFLOAT3(-2.3000, 0.3000, 2.02500)},
-			{ XMFLOAT3(-2.5000, 0.3000, 2.25000)}, { XMFLOAT3(-2.5000, 0.0000, 2.25000)},
-			{ XMFLOAT3(-2.7000, 0.0000, 2.02500)}, { XMFLOAT3(-2.7000, 0.3000, 2.02500)},
-			{ XMFLOAT3(-3.0000, 0.3000, 2.25000)}, { XMFLOAT3(-3.0000, 0.0000, 2.25000)},
-			{ XMFLOAT3(-2.7000, 0.0000, 1.80000)}, { XMFLOAT3(-2.7000, 0.3000, 1.80000)},
-			{ XMFLOAT3(-3.0000, 0.3000, 1.80000)}, { XMFLOAT3(-3.0000, 0.0000, 1.80000)},
-			{ XMFLOAT3(-2.7000, 0.0000, 1.57500)}, { XMFLOAT3(-2.7000, 0.3000, 1.57500)},
-			{ XMFLOAT3(-3.0000, 0.3000, 1.35000)}, { XMFLOAT3(-3.0000, 0.0000, 1.35000)},
-			{ XMFLOAT3(-2.5000, 0.0000, 1.12500)}, { XMFLOAT3(-2.5000, 0.3000, 1.12500)},
-			{ XMFLOAT3(-2.6500, 0.3000, 0.93750)}, { XMFLOAT3(-2.6500, 0.0000, 0.93750)},
-			{ XMFLOAT3(-2.0000, 0.0000, 0.90000)}, { XMFLOAT3(-2.0000, 0.3000, 0.90000)},
-			{ XMFLOAT3(-1.9000, 0.3000, 0.60000)}, { XMFLOAT3(-1.9000, 0.0000, 0.60000)},
-
-			//Body
-			{ XMFLOAT3(1.5000,  0.0000, 2.40000)}, { XMFLOAT3(1.5000, -0.8400, 2.40000)},
-			{ XMFLOAT3(0.8400, -1.5000, 2.40000)}, { XMFLOAT3(0.0000, -1.5000, 2.40000)},
-			{ XMFLOAT3(1.7500,  0.0000, 1.87500)}, { XMFLOAT3(1.7500, -0.9800, 1.87500)},
-			{ XMFLOAT3(0.9800, -1.7500, 1.87500)}, { XMFLOAT3(0.0000, -1.7500, 1.87500)},
-			{ XMFLOAT3(2.0000,  0.0000, 1.35000)}, { XMFLOAT3(2.0000, -1.1200, 1.35000)},
-			{ XMFLOAT3(1.1200, -2.0000, 1.35000)}, { XMFLOAT3(0.0000, -2.0000, 1.35000)},
-			{ XMFLOAT3(2.0000,  0.0000, 0.90000)}, { XMFLOAT3(2.0000, -1.1200, 0.90000)},
-			{ XMFLOAT3(1.1200, -2.0000, 0.90000)}, { XMFLOAT3(0.0000, -2.0000, 0.90000)},
-			{ XMFLOAT3(2.0000,  0.0000, 0.45000)}, { XMFLOAT3(2.0000, -1.1200, 0.45000)},
-			{ XMFLOAT3(1.1200, -2.0000, 0.45000)}, { XMFLOAT3(0.0000, -2.0000, 0.45000)},
-			{ XMFLOAT3(1.5000,  0.0000, 0.22500)}, { XMFLOAT3(1.5000, -0.8400, 0.22500)},
-			{ XMFLOAT3(0.8400, -1.5000, 0.22500)}, { XMFLOAT3(0.0000, -1.5000, 0.22500)},
-			{ XMFLOAT3(1.5000,  0.0000, 0.15000)}, { XMFLOAT3(1.5000, -0.8400, 0.15000)},
-			{ XMFLOAT3(0.8400, -1.5000, 0.15000)}, { XMFLOAT3(0.0000, -1.5000, 0.15000)},
-
-			{ XMFLOAT3(1.5000,  0.0000, 2.40000) }, { XMFLOAT3(1.5000, 0.8400, 2.40000) },
-			{ XMFLOAT3(0.8400, 1.5000, 2.40000) }, { XMFLOAT3(0.0000, 1.5000, 2.40000) },
-			{ XMFLOAT3(1.7500,  0.0000, 1.87500) }, { XMFLOAT3(1.7500, 0.9800, 1.87500) },
-			{ XMFLOAT3(0.9800, 1.7500, 1.87500) }, { XMFLOAT3(0.0000, 1.7500, 1.87500) },
-			{ XMFLOAT3(2.0000,  0.0000, 1.35000) }, { XMFLOAT3(2.0000, 1.1200, 1.35000) },
-			{ XMFLOAT3(1.1200, 2.0000, 1.35000) }, { XMFLOAT3(0.0000, 2.0000, 1.35000) },
-			{ XMFLOAT3(2.0000,  0.0000, 0.90000) }, { XMFLOAT3(2.0000, 1.1200, 0.90000) },
-			{ XMFLOAT3(1.1200, 2.0000, 0.90000) }, { XMFLOAT3(0.0000, 2.0000, 0.90000) },
-			{ XMFLOAT3(2.0000,  0.0000, 0.45000) }, { XMFLOAT3(2.0000, 1.1200, 0.45000) },
-			{ XMFLOAT3(1.1200, 2.0000, 0.45000) }, { XMFLOAT3(0.0000, 2.0000, 0.45000) },
-			{ XMFLOAT3(1.5000,  0.0000, 0.22500) }, { XMFLOAT3(1.5000, 0.8400, 0.22500) },
-			{ XMFLOAT3(0.8400, 1.5000, 0.22500) }, { XMFLOAT3(0.0000, 1.5000, 0.22500) },
-			{ XMFLOAT3(1.5000,  0.0000, 0.15000) }, { XMFLOAT3(1.5000, 0.8400, 0.15000) },
-			{ XMFLOAT3(0.8400, 1.5000, 0.15000) }, { XMFLOAT3(0.0000, 1.5000, 0.15000) },
-
-			{ XMFLOAT3(-1.5000,  0.0000, 2.40000) }, { XMFLOAT3(-1.5000, -0.8400, 2.40000) },
-			{ XMFLOAT3(-0.8400, -1.5000, 2.40000) }, { XMFLOAT3(-0.0000, -1.5000, 2.40000) },
-			{ XMFLOAT3(-1.7500,  0.0000, 1.87500) }, { XMFLOAT3(-1.7500, -0.9800, 1.87500) },
-			{ XMFLOAT3(-0.9800, -1.7500, 1.87500) }, { XMFLOAT3(-0.0000, -1.7500, 1.87500) },
-			{ XMFLOAT3(-2.0000,  0.0000, 1.35000) }, { XMFLOAT3(-2.0000, -1.1200, 1.35000) },
-			{ XMFLOAT3(-1.1200, -2.0000, 1.35000) }, { XMFLOAT3(-0.0000, -2.0000, 1.35000) },
-			{ XMFLOAT3(-2.0000,  0.0000, 0.90000) }, { XMFLOAT3(-2.0000, -1.1200, 0.90000) },
-			{ XMFLOAT3(-1.1200, -2.0000, 0.90000) }, { XMFLOAT3(-0.0000, -2.0000, 0.90000) },
-			{ XMFLOAT3(-2.0000,  0.0000, 0.45000) }, { XMFLOAT3(-2.0000, -1.1200, 0.45000) },
-			{ XMFLOAT3(-1.1200, -2.0000, 0.45000) }, { XMFLOAT3(-0.0000, -2.0000, 0.45000) },
-			{ XMFLOAT3(-1.5000,  0.0000, 0.22500) }, { XMFLOAT3(-1.5000, -0.8400, 0.22500) },
-			{ XMFLOAT3(-0.8400, -1.5000, 0.22500) }, { XMFLOAT3(-0.0000, -1.5000, 0.22500) },
-			{ XMFLOAT3(-1.5000,  0.0000, 0.15000) }, { XMFLOAT3(-1.5000, -0.8400, 0.15000) },
-			{ XMFLOAT3(-0.8400, -1.5000, 0.15000) }, { XMFLOAT3(-0.0000, -1.5000, 0.15000) },
-
-			{ XMFLOAT3(-1.5000,  0.0000, 2.40000) }, { XMFLOAT3(-1.5000, 0.8400, 2.40000) },
-			{ XMFLOAT3(-0.8400, 1.5000, 2.40000) }, { XMFLOAT3(-0.0000, 1.5000, 2.40000) },
-			{ XMFLOAT3(-1.7500,  0.0000, 1.87500) }, { XMFLOAT3(-1.7500, 0.9800, 1.87500) },
-			{ XMFLOAT3(-0.9800, 1.7500, 1.87500) }, { XMFLOAT3(-0.0000, 1.7500, 1.87500) },
-			{ XMFLOAT3(-2.0000,  0.0000, 1.35000) }, { XMFLOAT3(-2.0000, 1.1200, 1.35000) },
-			{ XMFLOAT3(-1.1200, 2.0000, 1.35000) }, { XMFLOAT3(-0.0000, 2.0000, 1.35000) },
-			{ XMFLOAT3(-2.0000,  0.0000, 0.90000) }, { XMFLOAT3(-2.0000, 1.1200, 0.90000) },
-			{ XMFLOAT3(-1.1200, 2.0000, 0.90000) }, { XMFLOAT3(-0.0000, 2.0000, 0.90000) },
-			{ XMFLOAT3(-2.0000,  0.0000, 0.45000) }, { XMFLOAT3(-2.0000, 1.1200, 0.45000) },
-			{ XMFLOAT3(-1.1200, 2.0000, 0.45000) }, { XMFLOAT3(-0.0000, 2.0000, 0.45000) },
-			{ XMFLOAT3(-1.5000,  0.0000, 0.22500) }, { XMFLOAT3(-1.5000, 0.8400, 0.22500) },
-			{ XMFLOAT3(-0.8400, 1.5000, 0.22500) }, { XMFLOAT3(-0.0000, 1.5000, 0.22500) },
-			{ XMFLOAT3(-1.5000,  0.0000, 0.15000) }, { XMFLOAT3(-1.5000, 0.8400, 0.15000) },
-			{ XMFLOAT3(-0.8400, 1.5000, 0.15000) }, { XMFLOAT3(-0.0000, 1.5000, 0.15000) },
-		};
+		// The teapot's control points, shared with BezierPatch's CPU evaluator
+		static VertexPosition pointVertices[PotteryControlPointCount];
+		for (auto i = 0; i < PotteryControlPointCount; i++)
+		{
+			pointVertices[i].position = XMFLOAT3(PotteryControlPoints[i]);
+		}
 
 		D3D11_SUBRESOURCE_DATA vertexBufferData = { 0 };
 		vertexBufferData.pSysMem = pointVertices;
@@ -215,48 +129,15 @@ void Pottery::CreateDeviceDependentResources()
 
 		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&vertexBufferDescription, &vertexBufferData, &_vertexBuffer));
 
-		static unsigned int pointIndices[192] = {
-			//Handle
-			0, 1, 2, 3, 4, 5, 6, 7,
-			  8, 9, 10, 11, 12, 13, 14, 15,
-			12, 13, 14, 15, 16, 17, 18, 19,
-			  20, 21, 22, 23, 24, 25, 26, 27,
-
-			28, 29, 30, 31, 32, 33, 34, 35,
-			  36, 37, 38, 39, 40, 41, 42, 43,
-			40, 41, 42, 43, 44, 45, 46, 47,
-			  48, 49, 50, 51, 52, 53, 54, 55,
-
-			// Body
-			56, 57, 58, 59, 60, 61, 62, 63,
-			  64, 65, 66, 67, 68, 69, 70, 71,
-			68, 69, 70, 71, 72, 73, 74, 75,
-			  76, 77, 78, 79, 80, 81, 82, 83,
-
-			84, 85, 86, 87, 88, 89, 90, 91,
-			  92, 93, 94, 95, 96, 97, 98, 99,
-			96, 97, 98, 99, 100, 101, 102, 103,
-			  104, 105, 106, 107, 108, 109, 110, 111,
-
-			112, 113, 114, 115, 116, 117, 118, 119,
-			  120, 121, 122, 123, 124, 125, 126, 127,
-			124, 125, 126, 127, 128, 129, 130, 131,
-			  132, 133, 134, 135, 136, 137, 138, 139,
-
-			140, 141, 142, 143, 144, 145, 146, 147,
-			  148, 149, 150, 151, 152, 153, 154, 155,
-			152, 153, 154, 155, 156, 157, 158, 159,
-			  160, 161, 162, 163, 164, 165, 166, 167,
-		};
 
-		_indexCount = ARRAYSIZE(pointIndices);
+		_indexCount = ARRAYSIZE(PotteryPatchIndices);
 
 		D3D11_SUBRESOURCE_DATA indexBufferData = { 0 };
-		indexBufferData.pSysMem = pointIndices;
+		indexBufferData.pSysMem = PotteryPatchIndices;
 		indexBufferData.SysMemPitch = 0;
 		indexBufferData.SysMemSlicePitch = 0;
 
-		CD3D11_BUFFER_DESC indexBufferDescription(sizeof(pointIndices), D3D11_BIND_INDEX_BUFFER);
+		CD3D11_BUFFER_DESC indexBufferDescription(sizeof(PotteryPatchIndices), D3D11_BIND_INDEX_BUFFER);
 
 		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&indexBufferDescription, &indexBufferData, &_indexBuffer));
 
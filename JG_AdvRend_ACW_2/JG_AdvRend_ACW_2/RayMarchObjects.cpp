@@ -2,7 +2,7 @@
 #include "RayMarchObjects.h"
 
 RayMarchObjects::RayMarchObjects(const shared_ptr<DeviceResources>& device)
-	: _device(device), _loadingComplete(false), _indexCount(0)
+	: _device(device), _loadingComplete(false), _indexCount(0), _proxyIndexCount(0), _proxies(true)
 {
 	CreateDeviceDependentResources();
 }
@@ -12,6 +12,7 @@ void RayMarchObjects::CreateDeviceDependentResources()
 	// Load shaders asynchronously.
 	auto loadVSTask = DX::ReadDataAsync(L"VS_RayMarchObjects.cso");
 	auto loadPSTask = DX::ReadDataAsync(L"PS_RayMarchObjects.cso");
+	auto loadProxyVSTask = DX::ReadDataAsync(L"VS_RayMarchProxies.cso");
 
 	// After the vertex shader file is loaded, create the shader and input layout.
 	auto createVSTask = loadVSTask.then([this](const std::vector<byte>& fileData) {
@@ -40,6 +41,18 @@ void RayMarchObjects::CreateDeviceDependentResources()
 		);
 		});
 
+	// The proxies share the quad's input layout, both take a float3 position
+	auto createProxyVSTask = loadProxyVSTask.then([this](const std::vector<byte>& fileData) {
+		DX::ThrowIfFailed(
+			_device->GetD3DDevice()->CreateVertexShader(
+				&fileData[0],
+				fileData.size(),
+				nullptr,
+				&_proxyVertexShader
+			)
+		);
+		});
+
 	// After the pixel shader file is loaded, create the shader and constant buffer.
 	auto createPSTask = loadPSTask.then([this](const std::vector<byte>& fileData) {
 		DX::ThrowIfFailed(
@@ -63,10 +76,15 @@ void RayMarchObjects::CreateDeviceDependentResources()
 		raster.CullMode = D3D11_CULL_NONE;
 		raster.FillMode = D3D11_FILL_SOLID;
 		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateRasterizerState(&raster, _rasterState.GetAddressOf()));
+
+		// Only the far faces of a proxy, so each pixel is shaded once and a camera inside the box still sees it.
+		// The near faces wind counter-clockwise on screen, which D3D treats as back faces.
+		raster.CullMode = D3D11_CULL_BACK;
+		DX::ThrowIfFailed(_device->GetD3DDevice()->CreateRasterizerState(&raster, _proxyRasterState.GetAddressOf()));
 		});
 
 	// Once both shaders are loaded, create the mesh.
-	auto createGrassPoints = (createPSTask && createVSTask).then([this]() {
+	auto createGrassPoints = (createPSTask && createVSTask && createProxyVSTask).then([this]() {
 
 		// Load mesh vertices. Each vertex has a position and a color.
 		static const VertexPosition quadVertices[] =
@@ -110,6 +128,52 @@ void RayMarchObjects::CreateDeviceDependentResources()
 				&_indexBuffer
 			)
 		);
+
+		// Unit cube for the proxies, VS_RayMarchProxies scales it to each primitive's box
+		static const VertexPosition cubeVertices[] =
+		{
+			{DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f)},
+			{DirectX::XMFLOAT3(1.0f, -1.0f, -1.0f)},
+			{DirectX::XMFLOAT3(-1.0f, 1.0f, -1.0f)},
+			{DirectX::XMFLOAT3(1.0f, 1.0f, -1.0f)},
+			{DirectX::XMFLOAT3(-1.0f, -1.0f, 1.0f)},
+			{DirectX::XMFLOAT3(1.0f, -1.0f, 1.0f)},
+			{DirectX::XMFLOAT3(-1.0f, 1.0f, 1.0f)},
+			{DirectX::XMFLOAT3(1.0f, 1.0f, 1.0f)},
+		};
+
+		vertexBufferData.pSysMem = cubeVertices;
+		CD3D11_BUFFER_DESC cubeVertexBufferDesc(sizeof(cubeVertices), D3D11_BIND_VERTEX_BUFFER);
+		DX::ThrowIfFailed(
+			_device->GetD3DDevice()->CreateBuffer(
+				&cubeVertexBufferDesc,
+				&vertexBufferData,
+				&_proxyVertexBuffer
+			)
+		);
+
+		// Counter-clockwise about the outward normal
+		static const unsigned short cubeIndices[] =
+		{
+			0, 2, 1, 1, 2, 3,	// -z
+			4, 5, 6, 5, 7, 6,	// +z
+			0, 4, 2, 2, 4, 6,	// -x
+			1, 3, 5, 3, 7, 5,	// +x
+			0, 1, 4, 1, 5, 4,	// -y
+			2, 6, 3, 3, 6, 7,	// +y
+		};
+
+		_proxyIndexCount = ARRAYSIZE(cubeIndices);
+
+		indexBufferData.pSysMem = cubeIndices;
+		CD3D11_BUFFER_DESC cubeIndexBufferDesc(sizeof(cubeIndices), D3D11_BIND_INDEX_BUFFER);
+		DX::ThrowIfFailed(
+			_device->GetD3DDevice()->CreateBuffer(
+				&cubeIndexBufferDesc,
+				&indexBufferData,
+				&_proxyIndexBuffer
+			)
+		);
 		});
 
 	// Once the cube is loaded, the object is ready to be rendered.
@@ -139,6 +203,10 @@ void RayMarchObjects::ReleaseDeviceDependentResources()
 	if (_vertexBuffer) _vertexBuffer.Reset();
 	if (_indexBuffer) _indexBuffer.Reset();
 	if (_rasterState) _rasterState.Reset();
+	if (_proxyVertexShader) _proxyVertexShader.Reset();
+	if (_proxyVertexBuffer) _proxyVertexBuffer.Reset();
+	if (_proxyIndexBuffer) _proxyIndexBuffer.Reset();
+	if (_proxyRasterState) _proxyRasterState.Reset();
 }
 
 void RayMarchObjects::Update(StepTimer const& timer)
@@ -163,13 +231,13 @@ void RayMarchObjects::Render()
 	// Each vertex is one instance of the VertexPositionColor struct.
 	UINT stride = sizeof(VertexPosition);
 	UINT offset = 0;
-	context->IASetVertexBuffers(0, 1, _vertexBuffer.GetAddressOf(), &stride, &offset);
-	context->IASetIndexBuffer(_indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
+	context->IASetVertexBuffers(0, 1, _proxies ? _proxyVertexBuffer.GetAddressOf() : _vertexBuffer.GetAddressOf(), &stride, &offset);
+	context->IASetIndexBuffer(_proxies ? _proxyIndexBuffer.Get() : _indexBuffer.Get(), DXGI_FORMAT_R16_UINT, 0);
 	context->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	context->IASetInputLayout(_inputLayout.Get());
 
 	// Attach our vertex shader.
-	context->VSSetShader(_vertexShader.Get(), nullptr, 0);
+	context->VSSetShader(_proxies ? _proxyVertexShader.Get() : _vertexShader.Get(), nullptr, 0);
 	context->VSSetConstantBuffers1(0, 1, _mvpBuffer.GetAddressOf(), nullptr, nullptr);
 
 	context->HSSetShader(nullptr, nullptr, 0);
@@ -178,13 +246,23 @@ void RayMarchObjects::Render()
 
 	context->GSSetShader(nullptr, nullptr, 0);
 
-	context->RSSetState(_rasterState.Get());
+	context->RSSetState(_proxies ? _proxyRasterState.Get() : _rasterState.Get());
 
 	context->PSSetConstantBuffers1(0, 1, _mvpBuffer.GetAddressOf(), nullptr, nullptr);
 	context->PSSetConstantBuffers1(1, 1, _cameraBuffer.GetAddressOf(), nullptr, nullptr);
+	// Depth of the rasterized geometry, rays stop where it is
+	ID3D11ShaderResourceView* sceneDepth = _device->GetSceneDepthShaderResourceView();
+	context->PSSetShaderResources(0, 1, &sceneDepth);
 	// Attach our pixel shader.
 	context->PSSetShader(_pixelShader.Get(), nullptr, 0);
 
 	// Draw the objects.
-	context->DrawIndexed(_indexCount, 0, 0);
+	if (_proxies)
+	{
+		context->DrawIndexedInstanced(_proxyIndexCount, ProxyCount, 0, 0, 0);
+	}
+	else
+	{
+		context->DrawIndexed(_indexCount, 0, 0);
+	}
 }
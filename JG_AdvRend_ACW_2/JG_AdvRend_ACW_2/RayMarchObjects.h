@@ -15,6 +15,8 @@ class RayMarchObjects
 public: // Structors
 	RayMarchObjects(const shared_ptr<DeviceResources>&);
 public: // Accessors
+	bool GetProxies() const { return _proxies; }
+	void SetProxies(bool proxies) { _proxies = proxies; }
 
 public: // Functions
 	void CreateDeviceDependentResources();
@@ -24,6 +26,10 @@ public: // Functions
 	void Update(StepTimer const&);
 	void Render();
 
+private: // Types
+	// NUMBER_OF_PRIMITIVES in VS_RayMarchProxies.hlsl, one proxy instance each
+	static const int ProxyCount = 17;
+
 private: // Data
 	shared_ptr<DeviceResources> _device;
 	ComPtr<ID3D11InputLayout> _inputLayout;
@@ -32,6 +38,11 @@ private: // Data
 	ComPtr<ID3D11VertexShader> _vertexShader;
 	ComPtr<ID3D11PixelShader> _pixelShader;
 	ComPtr<ID3D11RasterizerState> _rasterState;
+	// Bounding box proxies, one instance of the cube per primitive
+	ComPtr<ID3D11VertexShader> _proxyVertexShader;
+	ComPtr<ID3D11Buffer> _proxyVertexBuffer;
+	ComPtr<ID3D11Buffer> _proxyIndexBuffer;
+	ComPtr<ID3D11RasterizerState> _proxyRasterState;
 	ComPtr<ID3D11Buffer> _mvpBuffer;
 	ComPtr<ID3D11Buffer> _cameraBuffer;
 
@@ -39,6 +50,9 @@ private: // Data
 	CameraPositionConstantBuffer _cameraBufferData;
 
 	int _indexCount;
+	int _proxyIndexCount;
+	// Proxies in place of the full-screen quad, the quad is still needed when PS_RayMarchObjects draws the unbounded REPEATED_FIELD
+	bool _proxies;
 	bool _loadingComplete;
 };
 
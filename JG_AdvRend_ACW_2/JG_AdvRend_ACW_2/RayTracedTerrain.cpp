@@ -190,6 +190,9 @@ void RayTracedTerrain::Render()
 	context->PSSetConstantBuffers1(0, 1, _mvpBuffer.GetAddressOf(), nullptr, nullptr);
 	context->PSSetConstantBuffers1(1, 1, _inverseViewBuffer.GetAddressOf(), nullptr, nullptr);
 	context->PSSetConstantBuffers1(2, 1, _cameraBuffer.GetAddressOf(), nullptr, nullptr);
+	// Depth of the rasterized geometry, rays stop where it is
+	ID3D11ShaderResourceView* sceneDepth = _device->GetSceneDepthShaderResourceView();
+	context->PSSetShaderResources(0, 1, &sceneDepth);
 
 	context->GSSetShader(nullptr, nullptr, 0);
 	context->HSSetShader(nullptr, nullptr, 0);
@@ -0,0 +1,239 @@
+#include "SDFBrickMap.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "Common/ParallelFor.h"
+#include "SDFInterval.h"
+
+using namespace SDF;
+
+SDFBrickMap::SDFBrickMap(const SDFScene& scene, const SDFBrickMapSettings& settings)
+	: _scene(scene), _settings(settings), _stats()
+{
+	_cellSize = settings.voxelSize * BrickVoxels;
+	_distanceRange = settings.narrowBand + _cellSize * std::sqrt(3.0f);
+
+	// Bounds of every primitive plus enough room that the band never touches the border
+	auto boundsMin = float3(1e10f, 1e10f, 1e10f);
+	auto boundsMax = float3(-1e10f, -1e10f, -1e10f);
+	for (const auto& primitive : scene.GetPrimitives())
+	{
+		const auto radius = float3(primitive.boundRadius, primitive.boundRadius, primitive.boundRadius);
+		boundsMin = min(boundsMin, primitive.boundCentre - radius);
+		boundsMax = max(boundsMax, primitive.boundCentre + radius);
+	}
+
+	const auto padding = settings.narrowBand + _cellSize;
+	_origin = boundsMin - float3(padding, padding, padding);
+	const auto extent = boundsMax - boundsMin + float3(2.0f * padding, 2.0f * padding, 2.0f * padding);
+
+	_stats.cellsX = static_cast<int>(std::ceil(extent.x / _cellSize));
+	_stats.cellsY = static_cast<int>(std::ceil(extent.y / _cellSize));
+	_stats.cellsZ = static_cast<int>(std::ceil(extent.z / _cellSize));
+}
+
+float3 SDFBrickMap::GetBoundsMax() const
+{
+	return _origin + float3(static_cast<float>(_stats.cellsX), static_cast<float>(_stats.cellsY), static_cast<float>(_stats.cellsZ)) * _cellSize;
+}
+
+void SDFBrickMap::Bake()
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	const auto cellCount = _stats.cellsX * _stats.cellsY * _stats.cellsZ;
+	const auto& primitives = _scene.GetPrimitives();
+	const auto band = _settings.narrowBand;
+
+	_cells.assign(cellCount, Cell{ -1, 0.0f, 0, 0 });
+	std::vector<std::vector<int>> lists(cellCount);
+
+	// Classify every cell with interval arithmetic, cells the band cannot reach only keep a distance bound
+	ParallelFor(0, cellCount, _settings.threads, [&](int index)
+	{
+		const auto x = index % _stats.cellsX;
+		const auto y = (index / _stats.cellsX) % _stats.cellsY;
+		const auto z = index / (_stats.cellsX * _stats.cellsY);
+		const auto cellMin = _origin + float3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * _cellSize;
+		const auto cellMax = cellMin + float3(_cellSize, _cellSize, _cellSize);
+
+		thread_local std::vector<Interval> ranges;
+		ranges.resize(primitives.size());
+
+		auto lowest = 1e10f;
+		auto closestUpper = 1e10f;
+		for (auto i = 0; i < static_cast<int>(primitives.size()); i++)
+		{
+			ranges[i] = EvaluatePrimitiveInterval(primitives[i], cellMin, cellMax);
+			lowest = std::min(lowest, ranges[i].lo);
+			closestUpper = std::min(closestUpper, ranges[i].hi);
+		}
+
+		auto& cell = _cells[index];
+		if (lowest > band)
+		{
+			cell.distance = lowest;
+			return;
+		}
+		if (closestUpper < -band)
+		{
+			cell.distance = closestUpper;
+			return;
+		}
+
+		// Same rule as the tile pruning, only primitives that can be the closest one stay in the brick's list
+		for (auto i = 0; i < static_cast<int>(primitives.size()); i++)
+		{
+			if (ranges[i].lo <= closestUpper + 0.001f) lists[index].push_back(i);
+		}
+	}, 16);
+
+	std::vector<int> brickCells;
+	_primitiveLists.clear();
+	for (auto index = 0; index < cellCount; index++)
+	{
+		if (lists[index].empty()) continue;
+
+		auto& cell = _cells[index];
+		cell.brick = static_cast<int>(brickCells.size());
+		cell.listOffset = static_cast<int>(_primitiveLists.size());
+		cell.listCount = static_cast<int>(lists[index].size());
+		_primitiveLists.insert(_primitiveLists.end(), lists[index].begin(), lists[index].end());
+		brickCells.push_back(index);
+	}
+
+	const auto bytesPerDistance = _settings.distanceBits > 8 ? 2 : 1;
+	_distances.assign(brickCells.size() * SamplesPerBrick * bytesPerDistance, 0);
+	_colours.assign(brickCells.size() * SamplesPerBrick * 3, 0);
+
+	ParallelFor(0, static_cast<int>(brickCells.size()), _settings.threads, [&](int brick)
+	{
+		BakeBrick(brickCells[brick]);
+	});
+
+	_stats.bricks = static_cast<int>(brickCells.size());
+	_stats.indexBytes = _cells.size() * sizeof(Cell);
+	_stats.brickBytes = _distances.size() + _colours.size();
+	_stats.primitiveListBytes = _primitiveLists.size() * sizeof(int);
+	_stats.totalBytes = _stats.indexBytes + _stats.brickBytes + _stats.primitiveListBytes;
+	_stats.denseBytes = static_cast<size_t>(_stats.cellsX * BrickVoxels + 1) * (_stats.cellsY * BrickVoxels + 1) * (_stats.cellsZ * BrickVoxels + 1) * (bytesPerDistance + 3);
+	_stats.threads = ResolveThreadCount(_settings.threads);
+	_stats.bakeMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void SDFBrickMap::BakeBrick(int index)
+{
+	const auto& cell = _cells[index];
+	const auto& primitives = _scene.GetPrimitives();
+	const auto x = index % _stats.cellsX;
+	const auto y = (index / _stats.cellsX) % _stats.cellsY;
+	const auto z = index / (_stats.cellsX * _stats.cellsY);
+	const auto cellMin = _origin + float3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z)) * _cellSize;
+
+	const auto maxCode = _settings.distanceBits > 8 ? 65535.0f : 255.0f;
+
+	for (auto sample = 0; sample < SamplesPerBrick; sample++)
+	{
+		const auto i = sample % BrickSamples;
+		const auto j = (sample / BrickSamples) % BrickSamples;
+		const auto k = sample / (BrickSamples * BrickSamples);
+		const auto samplePoint = cellMin + float3(static_cast<float>(i), static_cast<float>(j), static_cast<float>(k)) * _settings.voxelSize;
+
+		auto closestHit = float4(1e10f, 0.0f, 0.0f, 0.0f);
+		for (auto l = 0; l < cell.listCount; l++)
+		{
+			closestHit = unionSDF(closestHit, SDFScene::EvaluatePrimitive(primitives[_primitiveLists[cell.listOffset + l]], samplePoint));
+		}
+
+		// Distances beyond the range clamp, which only ever shortens a step
+		const auto normalised = clamp(closestHit.x / _distanceRange, -1.0f, 1.0f) * 0.5f + 0.5f;
+		const auto code = static_cast<unsigned int>(normalised * maxCode + 0.5f);
+		const auto offset = cell.brick * SamplesPerBrick + sample;
+		if (_settings.distanceBits > 8)
+		{
+			_distances[offset * 2] = static_cast<uint8_t>(code & 0xff);
+			_distances[offset * 2 + 1] = static_cast<uint8_t>(code >> 8);
+		}
+		else
+		{
+			_distances[offset] = static_cast<uint8_t>(code);
+		}
+
+		const auto colour = saturate(closestHit.yzw());
+		_colours[offset * 3] = static_cast<uint8_t>(colour.x * 255.0f + 0.5f);
+		_colours[offset * 3 + 1] = static_cast<uint8_t>(colour.y * 255.0f + 0.5f);
+		_colours[offset * 3 + 2] = static_cast<uint8_t>(colour.z * 255.0f + 0.5f);
+	}
+}
+
+float SDFBrickMap::DecodeDistance(int brick, int sample) const
+{
+	const auto offset = brick * SamplesPerBrick + sample;
+	const auto normalised = _settings.distanceBits > 8
+		? (_distances[offset * 2] | (_distances[offset * 2 + 1] << 8)) / 65535.0f
+		: _distances[offset] / 255.0f;
+	return (normalised * 2.0f - 1.0f) * _distanceRange;
+}
+
+float4 SDFBrickMap::SampleBaked(const float3& samplePoint) const
+{
+	return Lookup(samplePoint, false);
+}
+
+float4 SDFBrickMap::Evaluate(const float3& samplePoint) const
+{
+	return Lookup(samplePoint, true);
+}
+
+float4 SDFBrickMap::Lookup(const float3& samplePoint, bool fallback) const
+{
+	const auto local = (samplePoint - _origin) / _settings.voxelSize;
+	const auto cx = static_cast<int>(std::floor(local.x / BrickVoxels));
+	const auto cy = static_cast<int>(std::floor(local.y / BrickVoxels));
+	const auto cz = static_cast<int>(std::floor(local.z / BrickVoxels));
+
+	if (cx < 0 || cy < 0 || cz < 0 || cx >= _stats.cellsX || cy >= _stats.cellsY || cz >= _stats.cellsZ)
+	{
+		// Everything is inside the bounds, so the distance to them is a safe step
+		const auto outside = max(max(_origin - samplePoint, samplePoint - GetBoundsMax()), 0.0f);
+		return float4(std::max(length(outside), _settings.voxelSize), 0.0f, 0.0f, 0.0f);
+	}
+
+	const auto& cell = _cells[(cz * _stats.cellsY + cy) * _stats.cellsX + cx];
+	if (cell.brick < 0) return float4(cell.distance, 0.0f, 0.0f, 0.0f);
+
+	const auto fx = local.x - cx * BrickVoxels;
+	const auto fy = local.y - cy * BrickVoxels;
+	const auto fz = local.z - cz * BrickVoxels;
+	const auto i = std::min(static_cast<int>(fx), BrickVoxels - 1);
+	const auto j = std::min(static_cast<int>(fy), BrickVoxels - 1);
+	const auto k = std::min(static_cast<int>(fz), BrickVoxels - 1);
+	const auto tx = fx - i;
+	const auto ty = fy - j;
+	const auto tz = fz - k;
+
+	const auto base = (k * BrickSamples + j) * BrickSamples + i;
+	const auto row = BrickSamples;
+	const auto slice = BrickSamples * BrickSamples;
+	const auto d00 = lerp(DecodeDistance(cell.brick, base), DecodeDistance(cell.brick, base + 1), tx);
+	const auto d10 = lerp(DecodeDistance(cell.brick, base + row), DecodeDistance(cell.brick, base + row + 1), tx);
+	const auto d01 = lerp(DecodeDistance(cell.brick, base + slice), DecodeDistance(cell.brick, base + slice + 1), tx);
+	const auto d11 = lerp(DecodeDistance(cell.brick, base + slice + row), DecodeDistance(cell.brick, base + slice + row + 1), tx);
+	const auto distance = lerp(lerp(d00, d10, ty), lerp(d01, d11, ty), tz);
+
+	if (fallback && distance < _settings.fallbackDistance)
+	{
+		// Close to the surface the baked error matters, use the primitives that can reach this brick
+		const auto& primitives = _scene.GetPrimitives();
+		auto closestHit = float4(1e10f, 0.0f, 0.0f, 0.0f);
+		for (auto l = 0; l < cell.listCount; l++)
+		{
+			closestHit = unionSDF(closestHit, SDFScene::EvaluatePrimitive(primitives[_primitiveLists[cell.listOffset + l]], samplePoint));
+		}
+		return closestHit;
+	}
+
+	const auto nearest = base + (tz >= 0.5f ? slice : 0) + (ty >= 0.5f ? row : 0) + (tx >= 0.5f ? 1 : 0);
+	const auto colour = &_colours[(cell.brick * SamplesPerBrick + nearest) * 3];
+	return float4(distance, colour[0] / 255.0f, colour[1] / 255.0f, colour[2] / 255.0f);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "SDFScene.h"
+
+struct SDFBrickMapSettings
+{
+	float voxelSize = 0.01f;
+	float narrowBand = 0.05f;		// bricks are only stored where the surface is closer than this
+	int distanceBits = 8;			// 8 or 16 bit quantised distances
+	float fallbackDistance = 0.02f;	// baked distances below this are replaced by the analytic SDF
+	int threads = 0;				// 0 uses every hardware thread
+};
+
+struct SDFBrickMapStats
+{
+	int cellsX;
+	int cellsY;
+	int cellsZ;
+	int bricks;
+	size_t indexBytes;
+	size_t brickBytes;
+	size_t primitiveListBytes;
+	size_t totalBytes;
+	size_t denseBytes;				// a dense grid at the same voxel size and quantisation
+	double bakeMilliseconds;
+	int threads;
+};
+
+// Sparse bake of SDFScene::Evaluate, 8^3 bricks sharing their borders in the cells the narrow band may cross
+class SDFBrickMap
+{
+public: // Structors
+	SDFBrickMap(const SDFScene& scene, const SDFBrickMapSettings& settings);
+
+public: // Accessors
+	const SDFBrickMapSettings& GetSettings() const { return _settings; }
+	const SDFBrickMapStats& GetStats() const { return _stats; }
+	const float3& GetBoundsMin() const { return _origin; }
+	float3 GetBoundsMax() const;
+
+public: // Functions
+	void Bake();
+
+	// Trilinear distance (x) and nearest sample colour (yzw), no analytic evaluation
+	float4 SampleBaked(const float3& samplePoint) const;
+	// Same, except near the surface where the primitives kept for the brick are evaluated analytically
+	float4 Evaluate(const float3& samplePoint) const;
+
+private: // Functions
+	float4 Lookup(const float3& samplePoint, bool fallback) const;
+	void BakeBrick(int cell);
+	float DecodeDistance(int brick, int sample) const;
+
+private: // Data
+	static const int BrickSamples = 8;
+	static const int BrickVoxels = BrickSamples - 1;
+	static const int SamplesPerBrick = BrickSamples * BrickSamples * BrickSamples;
+
+	struct Cell
+	{
+		int brick;			// -1 when the cell has no brick
+		float distance;		// bound on the distance for cells without a brick
+		int listOffset;
+		int listCount;
+	};
+
+	const SDFScene& _scene;
+	SDFBrickMapSettings _settings;
+	SDFBrickMapStats _stats;
+
+	float3 _origin;
+	float _cellSize;
+	float _distanceRange;	// quantised distances cover [-range, range]
+
+	std::vector<Cell> _cells;
+	std::vector<int> _primitiveLists;
+	std::vector<uint8_t> _distances;
+	std::vector<uint8_t> _colours;
+};
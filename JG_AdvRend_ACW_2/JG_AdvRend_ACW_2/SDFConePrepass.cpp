@@ -0,0 +1,86 @@
+#include "SDFConePrepass.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+	// A cone stops once a step would be below this fraction of its radius, the remaining depth is not worth the steps
+	const float MinimumStepRatio = 0.1f;
+	// The twisted torus is only scaled by 0.6 for a twist of 60, so its distance can be around twice too large.
+	// Pixel rays get away with that most of the time, a cone that skips it loses the whole tile.
+	const float ConeDistanceScale = 0.5f;
+}
+
+SDFConePrepass::SDFConePrepass(const SDFScene& scene, const SDFMarchSettings& settings, int tileSize)
+	: _scene(scene), _settings(settings), _tileSize(tileSize), _stats()
+{
+}
+
+void SDFConePrepass::Run(const SDFCamera& camera, int width, int height)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	_stats = SDFConePrepassStats();
+	_stats.tileSize = _tileSize;
+	_stats.tilesX = (width + _tileSize - 1) / _tileSize;
+	_stats.tilesY = (height + _tileSize - 1) / _tileSize;
+	_startDepths.assign(_stats.tilesX * _stats.tilesY, _settings.epsilon);
+
+	auto depthTotal = 0.0;
+	for (auto ty = 0; ty < _stats.tilesY; ty++)
+	{
+		for (auto tx = 0; tx < _stats.tilesX; tx++)
+		{
+			const auto x0 = static_cast<float>(tx * _tileSize);
+			const auto y0 = static_cast<float>(ty * _tileSize);
+			const auto x1 = static_cast<float>(std::min((tx + 1) * _tileSize, width));
+			const auto y1 = static_cast<float>(std::min((ty + 1) * _tileSize, height));
+
+			// The cone's axis goes through the middle of the tile and it opens wide enough for the tile's corners
+			const auto axis = camera.GenerateRay(0.5f * (x0 + x1), 0.5f * (y0 + y1), width, height);
+			auto cosHalfAngle = 1.0f;
+			for (auto corner = 0; corner < 4; corner++)
+			{
+				const auto edge = camera.GenerateRay(corner & 1 ? x1 : x0, corner & 2 ? y1 : y0, width, height);
+				cosHalfAngle = std::min(cosHalfAngle, dot(axis.d, edge.d));
+			}
+			const auto tanHalfAngle = std::sqrt(std::max(0.0f, 1.0f - cosHalfAngle * cosHalfAngle)) / cosHalfAngle;
+
+			auto steps = 0;
+			const auto depth = MarchCone(axis, tanHalfAngle, steps);
+
+			_startDepths[ty * _stats.tilesX + tx] = depth;
+			_stats.coneSteps += steps;
+			_stats.maxConeSteps = std::max(_stats.maxConeSteps, steps);
+			if (depth >= _settings.maxDistance) _stats.emptyTiles++;
+			depthTotal += depth;
+		}
+	}
+
+	_stats.averageStartDepth = depthTotal / _startDepths.size();
+	_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+float SDFConePrepass::MarchCone(const SDFRay& axis, float tanHalfAngle, int& steps) const
+{
+	auto depth = _settings.epsilon;
+
+	for (steps = 0; steps < _settings.maxMarchingSteps;)
+	{
+		const auto distance = _scene.Evaluate(axis.o + depth * axis.d).x * ConeDistanceScale;
+		steps++;
+
+		// A point of the cone at axis depth depth + s is at most s + (depth + s) * tan from the sample point,
+		// so the sphere of radius distance keeps the cone clear for s up to (distance - radius) / (1 + tan)
+		const auto radius = depth * tanHalfAngle;
+		const auto step = (distance - radius) / (1.0f + tanHalfAngle);
+		// Back off by the cone radius as well so a slight overestimate near the stopping point is not skipped
+		if (step <= _settings.epsilon || step < radius * MinimumStepRatio) return std::max(_settings.epsilon, depth - radius);
+
+		depth += step;
+		if (depth >= _settings.maxDistance) return _settings.maxDistance;
+	}
+
+	return depth;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include "SDFRayMarcher.h"
+
+struct SDFConePrepassStats
+{
+	int tilesX;
+	int tilesY;
+	int tileSize;
+	long long coneSteps;
+	int maxConeSteps;
+	int emptyTiles;			// the cone reached the max distance, the tile's pixels are not marched
+	double averageStartDepth;
+	double milliseconds;
+};
+
+// Marches one cone per tile of pixels, the depth it reaches is where the tile's rays start
+class SDFConePrepass
+{
+public: // Structors
+	SDFConePrepass(const SDFScene& scene, const SDFMarchSettings& settings, int tileSize);
+
+public: // Accessors
+	const SDFConePrepassStats& GetStats() const { return _stats; }
+	int GetTileSize() const { return _tileSize; }
+	float GetStartDepth(int pixelX, int pixelY) const { return _startDepths[(pixelY / _tileSize) * _stats.tilesX + pixelX / _tileSize]; }
+
+public: // Functions
+	void Run(const SDFCamera& camera, int width, int height);
+
+private: // Functions
+	float MarchCone(const SDFRay& axis, float tanHalfAngle, int& steps) const;
+
+private: // Data
+	const SDFScene& _scene;
+	SDFMarchSettings _settings;
+	int _tileSize;
+	std::vector<float> _startDepths;
+	SDFConePrepassStats _stats;
+};
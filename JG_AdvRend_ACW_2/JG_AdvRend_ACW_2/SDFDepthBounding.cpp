@@ -0,0 +1,28 @@
+#include "SDFDepthBounding.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace SDF;
+
+float SDFDepthProjection::ToDepth(float viewDepth) const
+{
+	return farPlane * (viewDepth - nearPlane) / (viewDepth * (farPlane - nearPlane));
+}
+
+float SDFDepthProjection::ToViewDepth(float depth) const
+{
+	return nearPlane * farPlane / (farPlane - depth * (farPlane - nearPlane));
+}
+
+float DepthBoundDistance(float depth, const SDFRay& ray, const SDFCamera& camera, const SDFDepthProjection& projection, float end)
+{
+	if (depth >= 1.0f) return end;
+
+	const auto viewDepth = projection.ToViewDepth(depth);
+	const auto originDepth = dot(ray.o - camera.position, camera.forward);
+	const auto directionDepth = dot(ray.d, camera.forward);
+	if (std::abs(directionDepth) < 0.0001f) return end;
+
+	const auto t = (viewDepth - originDepth) / directionDepth;
+	return t > 0.0f ? std::min(t, end) : end;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "SDFRayMarcher.h"
+
+// Depth range of XMMatrixPerspectiveFovRH in Sample3DSceneRenderer, 0 at the near plane and 1 at the far plane
+struct SDFDepthProjection
+{
+	float nearPlane = 0.01f;
+	float farPlane = 100.0f;
+
+	float ToDepth(float viewDepth) const;
+	float ToViewDepth(float depth) const;
+};
+
+// Distance along the ray at which its depth reaches the depth buffer's, end where nothing was drawn
+float DepthBoundDistance(float depth, const SDFRay& ray, const SDFCamera& camera, const SDFDepthProjection& projection, float end);
@@ -0,0 +1,342 @@
+#include "SDFInterval.h"
+
+namespace SDF
+{
+namespace
+{
+	const Interval Zero(0.0f);
+
+	// x - clamp(x, lo, hi) never decreases as x grows, so the end points give the exact range
+	Interval MinusClamp(const Interval& x, float lo, float hi)
+	{
+		return Interval(x.lo - HLSL::clamp(x.lo, lo, hi), x.hi - HLSL::clamp(x.hi, lo, hi));
+	}
+
+	// Three valued comparisons, a branch is possible when some value in the range takes it
+	bool PossiblyLess(const Interval& a, const Interval& b) { return a.lo < b.hi; }
+	bool PossiblyGreaterEqual(const Interval& a, const Interval& b) { return a.hi >= b.lo; }
+
+	Interval Merge(bool& any, const Interval& result, const Interval& branch)
+	{
+		const auto merged = any ? Hull(result, branch) : branch;
+		any = true;
+		return merged;
+	}
+
+	// length(max(d, 0.0)) + min(max(d.x, d.y), 0.0), the common tail of the extruded shapes
+	Interval ExtrusionDistance(const Interval& dx, const Interval& dy)
+	{
+		return length(Interval2(max(dx, Zero), max(dy, Zero))) + min(max(dx, dy), Zero);
+	}
+
+	Interval length8(const Interval2& q)
+	{
+		return pow(pow(abs(q.x), 8.0f) + pow(abs(q.y), 8.0f), 1.0f / 8.0f);
+	}
+
+	Interval length6(const Interval2& q)
+	{
+		return pow(pow(abs(q.x), 6.0f) + pow(abs(q.y), 6.0f), 1.0f / 6.0f);
+	}
+
+	Interval equilateralTriangleSDF(Interval2 p)
+	{
+		const float k = 1.73205f;
+		p.x = abs(p.x) - Interval(1.0f);
+		p.y = p.y + Interval(1.0f / k);
+
+		const auto fold = p.x + Interval(k) * p.y;
+		if (fold.hi > 0.0f)
+		{
+			const auto folded = Interval2((p.x - Interval(k) * p.y) * Interval(0.5f), (Interval(-k) * p.x - p.y) * Interval(0.5f));
+			p = fold.lo > 0.0f ? folded : Hull(p, folded);
+		}
+
+		// p.x += 2.0 - 2.0 * clamp((p.x + 2.0) / 2.0, 0.0, 1.0)
+		p.x = Interval(2.0f) * MinusClamp((p.x + Interval(2.0f)) * Interval(0.5f), 0.0f, 1.0f);
+		return -(length(p) * sign(p.y));
+	}
+
+	Interval octahedronBranch(const Interval3& q, float s)
+	{
+		const auto k = clamp(Interval(0.5f) * (q.z - q.y + Interval(s)), 0.0f, s);
+		return length(Interval3(q.x, q.y - Interval(s) + k, q.z - k));
+	}
+}
+
+	Interval torusSDF(const Interval3& p, float2 t)
+	{
+		const auto q = Interval2(length(p.xz()) - Interval(t.x), p.y);
+		return length(q) - Interval(t.y);
+	}
+
+	Interval roundBoxSDF(const Interval3& p, float3 b, float r)
+	{
+		return boxSDF(p, b) - Interval(r);
+	}
+
+	Interval cylinderSDF(const Interval3& p, float2 h)
+	{
+		const auto d = abs(Interval2(length(p.xz()), p.y)) - ToInterval(h);
+		return ExtrusionDistance(d.x, d.y);
+	}
+
+	Interval cylinder6SDF(const Interval3& p, float2 h)
+	{
+		return max(length6(p.xz()) - Interval(h.x), abs(p.y) - Interval(h.y));
+	}
+
+	Interval cylinderSDF(const Interval3& p, float3 a, float3 b, float r)
+	{
+		const auto pa = p - ToInterval(a);
+		const auto ba = b - a;
+		const auto baba = dot(ba, ba);
+		const auto paba = dot(pa, ToInterval(ba));
+
+		const auto x = length(pa * Interval(baba) - ToInterval(ba) * paba) - Interval(r * baba);
+		const auto y = abs(paba - Interval(baba * 0.5f)) - Interval(baba * 0.5f);
+		const auto x2 = sqr(x);
+		const auto y2 = sqr(y) * Interval(baba);
+
+		auto any = false;
+		Interval d;
+		const auto inside = max(x, y);
+		if (inside.lo < 0.0f) d = Merge(any, d, -min(x2, y2));
+		if (inside.hi >= 0.0f)
+		{
+			const auto xPart = x.lo > 0.0f ? x2 : (x.hi <= 0.0f ? Zero : Hull(x2, Zero));
+			const auto yPart = y.lo > 0.0f ? y2 : (y.hi <= 0.0f ? Zero : Hull(y2, Zero));
+			d = Merge(any, d, xPart + yPart);
+		}
+
+		// sign(d) * sqrt(abs(d)) grows with d
+		const auto signedRoot = [](float v) { return HLSL::sign(v) * std::sqrt(std::fabs(v)); };
+		return Interval(signedRoot(d.lo) / baba, signedRoot(d.hi) / baba);
+	}
+
+	Interval torus82SDF(const Interval3& p, float2 t)
+	{
+		const auto q = Interval2(length(p.xz()) - Interval(t.x), p.y);
+		return length8(q) - Interval(t.y);
+	}
+
+	Interval boxSDF(const Interval3& p, float3 b)
+	{
+		const auto d = abs(p) - ToInterval(b);
+		return min(max(d.x, max(d.y, d.z)), Zero) + length(max(d, Zero));
+	}
+
+	Interval coneSDF(const Interval3& p, float3 c)
+	{
+		const auto q = Interval2(length(p.xz()), p.y);
+		const auto d1 = -q.y - Interval(c.z);
+		const auto d2 = max(q.x * Interval(c.x) + q.y * Interval(c.y), q.y);
+		return ExtrusionDistance(d1, d2);
+	}
+
+	Interval cappedConeSDF(const Interval3& p, float h, float r1, float r2)
+	{
+		const auto q = Interval2(length(p.xz()), p.y);
+
+		const auto k1 = Interval2(Interval(r2), Interval(h));
+		const auto k2 = float2(r2 - r1, 2.0f * h);
+		const auto radius = q.y.hi < 0.0f ? Interval(r1) : (q.y.lo >= 0.0f ? Interval(r2) : Hull(Interval(r1), Interval(r2)));
+
+		// q.x - min(q.x, radius) written as max(q.x - radius, 0) to avoid counting q.x twice
+		const auto ca = Interval2(max(q.x - radius, Zero), abs(q.y) - Interval(h));
+		const auto t = clamp(dot(k1 - q, ToInterval(k2)) / Interval(dot(k2, k2)), 0.0f, 1.0f);
+		const auto cb = q - k1 + ToInterval(k2) * t;
+		const auto magnitude = sqrt(min(dot2(ca), dot2(cb)));
+
+		const auto alwaysInside = cb.x.hi < 0.0f && ca.y.hi < 0.0f;
+		const auto neverInside = cb.x.lo >= 0.0f || ca.y.lo >= 0.0f;
+		if (alwaysInside) return -magnitude;
+		if (neverInside) return magnitude;
+		return Interval(-magnitude.hi, magnitude.hi);
+	}
+
+	Interval roundConeSDF(const Interval3& p, float r1, float r2, float h)
+	{
+		const auto q = Interval2(length(p.xz()), p.y);
+
+		const auto b = (r1 - r2) / h;
+		const auto a = std::sqrt(1.0f - b * b);
+		const auto k = q.x * Interval(-b) + q.y * Interval(a);
+
+		auto any = false;
+		Interval result;
+		if (k.lo < 0.0f) result = Merge(any, result, length(q) - Interval(r1));
+		if (k.hi > a * h) result = Merge(any, result, length(Interval2(q.x, q.y - Interval(h))) - Interval(r2));
+		if (k.hi >= 0.0f && k.lo <= a * h) result = Merge(any, result, q.x * Interval(a) + q.y * Interval(b) - Interval(r1));
+		return result;
+	}
+
+	Interval roundConeSDF(const Interval3& p, float3 a, float3 b, float r1, float r2)
+	{
+		const auto ba = b - a;
+		const auto l2 = dot(ba, ba);
+		const auto rr = r1 - r2;
+		const auto a2 = l2 - rr * rr;
+		const auto il2 = 1.0f / l2;
+
+		const auto pa = p - ToInterval(a);
+		const auto y = dot(pa, ToInterval(ba));
+		const auto z = y - Interval(l2);
+		const auto x2 = dot2(pa * Interval(l2) - ToInterval(ba) * y);
+		const auto y2 = sqr(y) * Interval(l2);
+		const auto z2 = sqr(z) * Interval(l2);
+
+		const auto k = Interval(HLSL::sign(rr) * rr * rr) * x2;
+		const auto first = sign(z) * Interval(a2) * z2;
+		const auto second = sign(y) * Interval(a2) * y2;
+
+		auto any = false;
+		Interval result;
+		if (first.hi > k.lo) result = Merge(any, result, sqrt(x2 + z2) * Interval(il2) - Interval(r2));
+		if (first.lo <= k.hi)
+		{
+			if (PossiblyLess(second, k)) result = Merge(any, result, sqrt(x2 + y2) * Interval(il2) - Interval(r1));
+			if (PossiblyGreaterEqual(second, k)) result = Merge(any, result, (sqrt(x2 * Interval(a2 * il2)) + y * Interval(rr)) * Interval(il2) - Interval(r1));
+		}
+		return result;
+	}
+
+	Interval ellipsoidSDF(const Interval3& p, float3 r)
+	{
+		const auto k0 = length(p / ToInterval(r));
+		const auto k1 = length(p / ToInterval(r * r));
+		// k0 * (k0 - 1.0) written as (k0 - 0.5)^2 - 0.25 to avoid counting k0 twice
+		return (sqr(k0 - Interval(0.5f)) - Interval(0.25f)) / k1;
+	}
+
+	Interval triPrismSDF(const Interval3& p, float2 h)
+	{
+		const auto q = abs(p);
+		const auto d1 = q.z - Interval(h.y);
+		const auto hx = h.x * 0.866025f;
+		const auto d2 = equilateralTriangleSDF(Interval2(p.x / Interval(hx), p.y / Interval(hx))) * Interval(hx);
+		return ExtrusionDistance(d1, d2);
+	}
+
+	Interval hexPrismSDF(const Interval3& p, float2 h)
+	{
+		const auto k = float3(-0.8660254f, 0.5f, 0.57735f);
+		auto q = abs(p);
+		const auto fold = Interval(2.0f) * min(q.x * Interval(k.x) + q.y * Interval(k.y), Zero);
+		q.x -= fold * Interval(k.x);
+		q.y -= fold * Interval(k.y);
+		const auto d = Interval2(
+			length(Interval2(MinusClamp(q.x, -k.z * h.x, k.z * h.x), q.y - Interval(h.x))) * sign(q.y - Interval(h.x)),
+			q.z - Interval(h.y));
+		return min(max(d.x, d.y), Zero) + length(max(d, Zero));
+	}
+
+	Interval octahedronSDF(const Interval3& p, float s)
+	{
+		const auto q = abs(p);
+		const auto m = q.x + q.y + q.z - Interval(s);
+
+		auto any = false;
+		Interval result;
+		auto reachable = true;
+
+		const Interval3 permutations[3] = { q, q.yzx(), q.zxy() };
+		const Interval axes[3] = { q.x, q.y, q.z };
+		for (auto i = 0; i < 3 && reachable; i++)
+		{
+			const auto test = Interval(3.0f) * axes[i];
+			if (PossiblyLess(test, m)) result = Merge(any, result, octahedronBranch(permutations[i], s));
+			reachable = PossiblyGreaterEqual(test, m);
+		}
+
+		if (reachable) result = Merge(any, result, m * Interval(0.57735027f));
+		return result;
+	}
+
+	Interval3 twistSDF(const Interval3& p, float rep)
+	{
+		const auto angle = Interval(rep) * p.y + Interval(rep);
+		const auto c = cos(angle);
+		const auto s = sin(angle);
+		return Interval3(p.x * c + p.z * s, -(p.x * s) + p.z * c, p.y);
+	}
+
+	Interval SierpinskiTetrahedron(Interval3 p)
+	{
+		const float3 vertices[4] = { va, vb, vc, vd };
+		auto r = 1.0f;
+		Interval dm;
+
+		for (auto i = 0; i < 8; i++)
+		{
+			Interval distances[4];
+			auto closest = Interval::Everything().hi;
+			for (auto j = 0; j < 4; j++)
+			{
+				distances[j] = dot2(p - ToInterval(vertices[j]));
+				closest = std::fmin(closest, distances[j].hi);
+			}
+
+			// Every vertex that can be the closest one somewhere in the box folds part of it
+			auto any = false;
+			Interval3 folded;
+			for (auto j = 0; j < 4; j++)
+			{
+				if (distances[j].lo > closest) continue;
+
+				const auto v = ToInterval(vertices[j]);
+				const auto image = v + (p - v) * Interval(2.0f);
+				folded = any ? Hull(folded, image) : image;
+				dm = any ? min(dm, distances[j]) : distances[j];
+				any = true;
+			}
+
+			// dm is the smallest distance, so it is at most the closest upper bound
+			dm.hi = std::fmin(dm.hi, closest);
+			p = folded;
+			r *= 2.0f;
+		}
+
+		return (sqrt(dm) - Interval(1.0f)) / Interval(r);
+	}
+}
+
+Interval EvaluatePrimitiveInterval(const SDFPrimitive& primitive, const float3& boxMin, const float3& boxMax)
+{
+	using namespace SDF;
+
+	const auto p = Interval3(
+		Interval(boxMin.x - primitive.position.x, boxMax.x - primitive.position.x),
+		Interval(boxMin.y - primitive.position.y, boxMax.y - primitive.position.y),
+		Interval(boxMin.z - primitive.position.z, boxMax.z - primitive.position.z));
+	const auto& a = primitive.paramsA;
+	const auto& b = primitive.paramsB;
+
+	switch (primitive.type)
+	{
+	case SDFPrimitiveType::RoundConeSegment: return roundConeSDF(p, a.xyz(), b.xyz(), a.w, b.w);
+	case SDFPrimitiveType::Cone: return coneSDF(p, a.xyz());
+	case SDFPrimitiveType::CappedCone: return cappedConeSDF(p, a.x, a.y, a.z);
+	case SDFPrimitiveType::TwistedTorus:
+	{
+		// The twist loses the link between the rotated coordinates, but it keeps |p|, and the torus is never closer than |p| - (t.x + t.y)
+		auto torus = torusSDF(twistSDF(p, a.z), float2(a.x, a.y));
+		torus.lo = std::fmax(torus.lo, length(p).lo - (a.x + a.y));
+		return Interval(a.w) * torus;
+	}
+	case SDFPrimitiveType::Torus: return torusSDF(p, float2(a.x, a.y));
+	case SDFPrimitiveType::Torus82: return torus82SDF(p, float2(a.x, a.y));
+	case SDFPrimitiveType::Box: return boxSDF(p, a.xyz());
+	case SDFPrimitiveType::RoundBox: return roundBoxSDF(p, a.xyz(), a.w);
+	case SDFPrimitiveType::Ellipsoid: return ellipsoidSDF(p, a.xyz());
+	case SDFPrimitiveType::TriPrism: return triPrismSDF(p, float2(a.x, a.y));
+	case SDFPrimitiveType::CylinderSegment: return cylinderSDF(p, a.xyz(), b.xyz(), a.w);
+	case SDFPrimitiveType::Cylinder: return cylinderSDF(p, float2(a.x, a.y));
+	case SDFPrimitiveType::Cylinder6: return cylinder6SDF(p, float2(a.x, a.y));
+	case SDFPrimitiveType::Octahedron: return octahedronSDF(p, a.x);
+	case SDFPrimitiveType::HexPrism: return hexPrismSDF(p, float2(a.x, a.y));
+	case SDFPrimitiveType::RoundCone: return roundConeSDF(p, a.x, a.y, a.z);
+	case SDFPrimitiveType::SierpinskiTetrahedron: return SierpinskiTetrahedron(Interval3(p.x * Interval(a.x), p.y * Interval(a.x), p.z * Interval(a.x)));
+	default: return Interval::Everything();
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Common/Interval.h"
+#include "SDFScene.h"
+
+// Interval versions of PS_RayMarchObjects.hlsl's distance functions, undecided branches take the hull of both sides
+namespace SDF
+{
+	Interval torusSDF(const Interval3& p, float2 t);
+	Interval roundBoxSDF(const Interval3& p, float3 b, float r);
+	Interval cylinderSDF(const Interval3& p, float2 h);
+	Interval cylinder6SDF(const Interval3& p, float2 h);
+	Interval cylinderSDF(const Interval3& p, float3 a, float3 b, float r);
+	Interval torus82SDF(const Interval3& p, float2 t);
+	Interval boxSDF(const Interval3& p, float3 b);
+	Interval coneSDF(const Interval3& p, float3 c);
+	Interval cappedConeSDF(const Interval3& p, float h, float r1, float r2);
+	Interval roundConeSDF(const Interval3& p, float r1, float r2, float h);
+	Interval roundConeSDF(const Interval3& p, float3 a, float3 b, float r1, float r2);
+	Interval ellipsoidSDF(const Interval3& p, float3 r);
+	Interval triPrismSDF(const Interval3& p, float2 h);
+	Interval hexPrismSDF(const Interval3& p, float2 h);
+	Interval octahedronSDF(const Interval3& p, float s);
+	Interval3 twistSDF(const Interval3& p, float rep);
+	Interval SierpinskiTetrahedron(Interval3 p);
+}
+
+// Range of the primitive's distance over the axis aligned box [boxMin, boxMax]
+Interval EvaluatePrimitiveInterval(const SDFPrimitive& primitive, const float3& boxMin, const float3& boxMax);
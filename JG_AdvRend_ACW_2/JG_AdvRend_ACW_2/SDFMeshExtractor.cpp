@@ -0,0 +1,665 @@
+#include "SDFMeshExtractor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include "Common/ParallelFor.h"
+#include "SDFInterval.h"
+
+using namespace SDF;
+
+namespace
+{
+	// Children and corners are numbered x * 4 + y * 2 + z
+	float3 CornerOffset(int corner)
+	{
+		return float3(static_cast<float>((corner >> 2) & 1), static_cast<float>((corner >> 1) & 1), static_cast<float>(corner & 1));
+	}
+
+	// Corners at the ends of each cell edge, 0-3 along x, 4-7 along y, 8-11 along z
+	const int edgeCorners[12][2] = { { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }, { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 }, { 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 } };
+
+	// Tables of the octree contouring recursion (Ju et al. 2002)
+	// Pairs of children sharing a face inside a cell and the face's axis
+	const int cellFaces[12][3] = { { 0, 4, 0 }, { 1, 5, 0 }, { 2, 6, 0 }, { 3, 7, 0 }, { 0, 2, 1 }, { 4, 6, 1 }, { 1, 3, 1 }, { 5, 7, 1 }, { 0, 1, 2 }, { 2, 3, 2 }, { 4, 5, 2 }, { 6, 7, 2 } };
+	// Quadruples of children sharing an edge inside a cell and the edge's axis
+	const int cellEdges[6][5] = { { 0, 1, 2, 3, 0 }, { 4, 5, 6, 7, 0 }, { 0, 4, 1, 5, 1 }, { 2, 6, 3, 7, 1 }, { 0, 2, 4, 6, 2 }, { 1, 3, 5, 7, 2 } };
+	// Child pairs across a face between two cells, per face axis
+	const int faceFaces[3][4][3] = {
+		{ { 4, 0, 0 }, { 5, 1, 0 }, { 6, 2, 0 }, { 7, 3, 0 } },
+		{ { 2, 0, 1 }, { 6, 4, 1 }, { 3, 1, 1 }, { 7, 5, 1 } },
+		{ { 1, 0, 2 }, { 3, 2, 2 }, { 5, 4, 2 }, { 7, 6, 2 } } };
+	// Edges lying in a face between two cells, an order (which cell each of the four comes from), the children and the edge axis
+	const int faceEdges[3][4][6] = {
+		{ { 1, 4, 0, 5, 1, 1 }, { 1, 6, 2, 7, 3, 1 }, { 0, 4, 6, 0, 2, 2 }, { 0, 5, 7, 1, 3, 2 } },
+		{ { 0, 2, 3, 0, 1, 0 }, { 0, 6, 7, 4, 5, 0 }, { 1, 2, 0, 6, 4, 2 }, { 1, 3, 1, 7, 5, 2 } },
+		{ { 1, 1, 0, 3, 2, 0 }, { 1, 5, 4, 7, 6, 0 }, { 0, 1, 5, 0, 4, 1 }, { 0, 3, 7, 2, 6, 1 } } };
+	const int faceEdgeOrders[2][4] = { { 0, 0, 1, 1 }, { 0, 1, 0, 1 } };
+	// The two halves of an edge shared by four cells, the child of each cell and the edge axis
+	const int edgeEdges[3][2][5] = {
+		{ { 3, 2, 1, 0, 0 }, { 7, 6, 5, 4, 0 } },
+		{ { 5, 1, 4, 0, 1 }, { 7, 3, 6, 2, 1 } },
+		{ { 6, 4, 2, 0, 2 }, { 7, 5, 3, 1, 2 } } };
+	// Which edge of each of the four cells around an edge is the shared one
+	const int sharedEdges[3][4] = { { 3, 2, 1, 0 }, { 7, 5, 6, 4 }, { 11, 10, 9, 8 } };
+
+	float Component(const float3& v, int axis)
+	{
+		return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+	}
+
+	float3 Axis(int axis)
+	{
+		return float3(axis == 0 ? 1.0f : 0.0f, axis == 1 ? 1.0f : 0.0f, axis == 2 ? 1.0f : 0.0f);
+	}
+
+	// Eigen decomposition of a symmetric 3x3 matrix by Jacobi rotations, the columns of v are the eigenvectors
+	void SymmetricEigen(float a[3][3], float v[3][3])
+	{
+		for (auto i = 0; i < 3; i++)
+		{
+			for (auto j = 0; j < 3; j++) v[i][j] = i == j ? 1.0f : 0.0f;
+		}
+
+		for (auto sweep = 0; sweep < 8; sweep++)
+		{
+			const auto offDiagonal = std::abs(a[0][1]) + std::abs(a[0][2]) + std::abs(a[1][2]);
+			if (offDiagonal < 1e-12f) return;
+
+			for (auto p = 0; p < 2; p++)
+			{
+				for (auto q = p + 1; q < 3; q++)
+				{
+					if (std::abs(a[p][q]) < 1e-20f) continue;
+
+					const auto theta = (a[q][q] - a[p][p]) / (2.0f * a[p][q]);
+					const auto t = (theta >= 0.0f ? 1.0f : -1.0f) / (std::abs(theta) + std::sqrt(theta * theta + 1.0f));
+					const auto c = 1.0f / std::sqrt(t * t + 1.0f);
+					const auto s = t * c;
+
+					for (auto k = 0; k < 3; k++)
+					{
+						const auto akp = a[k][p];
+						const auto akq = a[k][q];
+						a[k][p] = c * akp - s * akq;
+						a[k][q] = s * akp + c * akq;
+					}
+					for (auto k = 0; k < 3; k++)
+					{
+						const auto apk = a[p][k];
+						const auto aqk = a[q][k];
+						a[p][k] = c * apk - s * aqk;
+						a[q][k] = s * apk + c * aqk;
+					}
+					for (auto k = 0; k < 3; k++)
+					{
+						const auto vkp = v[k][p];
+						const auto vkq = v[k][q];
+						v[k][p] = c * vkp - s * vkq;
+						v[k][q] = s * vkp + c * vkq;
+					}
+				}
+			}
+		}
+	}
+}
+
+void SDFMeshExtractor::QEF::Add(const float3& p, const float3& n)
+{
+	const auto d = dot(n, p);
+	ata[0] += n.x * n.x; ata[1] += n.x * n.y; ata[2] += n.x * n.z;
+	ata[3] += n.y * n.y; ata[4] += n.y * n.z; ata[5] += n.z * n.z;
+	atb = atb + n * d;
+	btb += d * d;
+	massPoint = massPoint + p;
+	count++;
+}
+
+void SDFMeshExtractor::QEF::Add(const QEF& other)
+{
+	for (auto i = 0; i < 6; i++) ata[i] += other.ata[i];
+	atb = atb + other.atb;
+	btb += other.btb;
+	massPoint = massPoint + other.massPoint;
+	count += other.count;
+}
+
+float SDFMeshExtractor::QEF::Solve(const float3& cellMin, float size, float3& position) const
+{
+	const auto centre = massPoint / static_cast<float>(count);
+	const auto multiply = [this](const float3& x)
+	{
+		return float3(ata[0] * x.x + ata[1] * x.y + ata[2] * x.z, ata[1] * x.x + ata[3] * x.y + ata[4] * x.z, ata[2] * x.x + ata[4] * x.y + ata[5] * x.z);
+	};
+
+	// Solve around the mass point with a truncated pseudo inverse, directions the planes
+	// do not constrain (flat or along a crease) stay at the mass point
+	float a[3][3] = { { ata[0], ata[1], ata[2] }, { ata[1], ata[3], ata[4] }, { ata[2], ata[4], ata[5] } };
+	float v[3][3];
+	SymmetricEigen(a, v);
+
+	const auto rhs = atb - multiply(centre);
+	const auto largest = std::max(a[0][0], std::max(a[1][1], a[2][2]));
+	auto offset = float3(0.0f, 0.0f, 0.0f);
+	for (auto i = 0; i < 3; i++)
+	{
+		const auto eigenvalue = a[i][i];
+		if (eigenvalue <= 0.01f * largest || eigenvalue <= 1e-12f) continue;
+
+		const auto axis = float3(v[0][i], v[1][i], v[2][i]);
+		offset = offset + axis * (dot(axis, rhs) / eigenvalue);
+	}
+
+	position = centre + offset;
+
+	// Far outside the cell the planes are nearly parallel and the minimiser is unreliable
+	const auto margin = 1e-3f * size;
+	const auto cellMax = cellMin + float3(size, size, size);
+	if (position.x < cellMin.x - margin || position.y < cellMin.y - margin || position.z < cellMin.z - margin ||
+		position.x > cellMax.x + margin || position.y > cellMax.y + margin || position.z > cellMax.z + margin)
+	{
+		position = centre;
+	}
+
+	return std::max(0.0f, dot(position, multiply(position)) - 2.0f * dot(position, atb) + btb);
+}
+
+SDFMeshExtractor::SDFMeshExtractor(const SDFScene& scene, const SDFMeshSettings& settings)
+	: _scene(scene), _settings(settings), _stats()
+{
+	auto boundsMin = float3(1e10f, 1e10f, 1e10f);
+	auto boundsMax = float3(-1e10f, -1e10f, -1e10f);
+	for (const auto& primitive : scene.GetPrimitives())
+	{
+		const auto radius = float3(primitive.boundRadius, primitive.boundRadius, primitive.boundRadius);
+		boundsMin = min(boundsMin, primitive.boundCentre - radius);
+		boundsMax = max(boundsMax, primitive.boundCentre + radius);
+	}
+
+	// A cube around the bounds with a leaf of room on every side, so the surface never touches the border
+	const auto extent = boundsMax - boundsMin;
+	const auto side = std::max(extent.x, std::max(extent.y, extent.z));
+	_size = side * (1.0f + 2.0f / static_cast<float>(1 << settings.maxDepth)) + 1e-3f;
+	_origin = (boundsMin + boundsMax) * 0.5f - float3(_size, _size, _size) * 0.5f;
+}
+
+int SDFMeshExtractor::Classify(const float3& cellMin, float size, const std::vector<int>& candidates, std::vector<int>& closest) const
+{
+	const auto cellMax = cellMin + float3(size, size, size);
+	const auto& primitives = _scene.GetPrimitives();
+
+	thread_local std::vector<Interval> ranges;
+	ranges.resize(candidates.size());
+
+	// The scene's range is the union's, [min of the lows, min of the highs]
+	auto lowest = 1e10f;
+	auto closestUpper = 1e10f;
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		ranges[i] = EvaluatePrimitiveInterval(primitives[candidates[i]], cellMin, cellMax);
+		lowest = std::min(lowest, ranges[i].lo);
+		closestUpper = std::min(closestUpper, ranges[i].hi);
+	}
+
+	if (lowest > 0.0f) return -1;
+	if (closestUpper < 0.0f) return 1;
+
+	// Same rule as the tile pruning, only primitives that can be the closest one inside the cell stay
+	closest.clear();
+	for (size_t i = 0; i < candidates.size(); i++)
+	{
+		if (ranges[i].lo <= closestUpper + 0.001f) closest.push_back(candidates[i]);
+	}
+	return 0;
+}
+
+float SDFMeshExtractor::Distance(const float3& samplePoint, const std::vector<int>& candidates) const
+{
+	auto distance = 1e10f;
+	for (const auto i : candidates) distance = std::min(distance, SDFScene::EvaluatePrimitive(_scene.GetPrimitives()[i], samplePoint).x);
+	return distance;
+}
+
+void SDFMeshExtractor::BuildNode(std::vector<Node>& nodes, int index, const std::vector<int>& candidates) const
+{
+	std::vector<int> closest;
+	const auto state = Classify(nodes[index].min, nodes[index].size, candidates, closest);
+	if (state != 0)
+	{
+		nodes[index].signs = state > 0 ? 0xFF : 0;
+		return;
+	}
+
+	if (nodes[index].depth == _settings.maxDepth)
+	{
+		BuildLeaf(nodes[index], closest);
+		return;
+	}
+
+	const auto firstChild = static_cast<int>(nodes.size());
+	Split(nodes, index);
+
+	for (auto c = 0; c < 8; c++) BuildNode(nodes, firstChild + c, closest);
+
+	Simplify(nodes, index);
+}
+
+void SDFMeshExtractor::Split(std::vector<Node>& nodes, int index)
+{
+	const auto firstChild = static_cast<int>(nodes.size());
+	const auto childSize = nodes[index].size * 0.5f;
+	for (auto c = 0; c < 8; c++)
+	{
+		auto child = Node();
+		child.min = nodes[index].min + CornerOffset(c) * childSize;
+		child.size = childSize;
+		child.depth = nodes[index].depth + 1;
+		child.firstChild = -1;
+		child.vertex = -1;
+		nodes.push_back(child);
+	}
+	nodes[index].firstChild = firstChild;
+}
+
+void SDFMeshExtractor::BuildLeaf(Node& node, const std::vector<int>& candidates) const
+{
+	float distances[8];
+	for (auto corner = 0; corner < 8; corner++)
+	{
+		distances[corner] = Distance(node.min + CornerOffset(corner) * node.size, candidates);
+		if (distances[corner] < 0.0f) node.signs |= 1 << corner;
+	}
+
+	if (node.signs == 0 || node.signs == 0xFF) return;
+
+	for (auto edge = 0; edge < 12; edge++)
+	{
+		const auto c0 = edgeCorners[edge][0];
+		const auto c1 = edgeCorners[edge][1];
+		if (((node.signs >> c0) & 1) == ((node.signs >> c1) & 1)) continue;
+
+		// Regula falsi along the edge, the distance is close to linear over a leaf
+		auto a = node.min + CornerOffset(c0) * node.size;
+		auto b = node.min + CornerOffset(c1) * node.size;
+		auto da = distances[c0];
+		auto db = distances[c1];
+		auto crossing = a;
+		for (auto i = 0; i < 4; i++)
+		{
+			crossing = a + (b - a) * (da / (da - db));
+			const auto d = Distance(crossing, candidates);
+			if ((d < 0.0f) == (da < 0.0f))
+			{
+				a = crossing;
+				da = d;
+			}
+			else
+			{
+				b = crossing;
+				db = d;
+			}
+		}
+
+		const auto gradient = _scene.EvaluateGradient(crossing).yzw();
+		const auto gradientLength = length(gradient);
+		node.qef.Add(crossing, gradientLength > 1e-6f ? gradient / gradientLength : normalize(b - a));
+	}
+
+	node.qef.Solve(node.min, node.size, node.position);
+	node.vertex = 0;
+}
+
+void SDFMeshExtractor::Simplify(std::vector<Node>& nodes, int index) const
+{
+	if (_settings.simplifyError <= 0.0f) return;
+
+	const auto firstChild = nodes[index].firstChild;
+	auto combined = QEF();
+	auto surface = false;
+	uint8_t signs = 0;
+	for (auto c = 0; c < 8; c++)
+	{
+		const auto& child = nodes[firstChild + c];
+		if (child.firstChild >= 0) return;
+
+		if (child.vertex >= 0)
+		{
+			combined.Add(child.qef);
+			surface = true;
+		}
+		signs |= child.signs & (1 << c);
+	}
+
+	auto& node = nodes[index];
+	if (surface)
+	{
+		auto position = float3();
+		if (combined.Solve(node.min, node.size, position) > _settings.simplifyError) return;
+
+		node.position = position;
+		node.qef = combined;
+		node.vertex = 0;
+	}
+
+	// Everything after the first child was built for this node's subtree
+	node.firstChild = -1;
+	node.signs = signs;
+	nodes.resize(firstChild);
+}
+
+bool SDFMeshExtractor::Defer(int kind, const int* nodes, int count, int direction, std::vector<ContourTask>* deferred) const
+{
+	if (!deferred) return false;
+
+	auto depth = 0;
+	for (auto i = 0; i < count; i++) depth = std::max(depth, _nodes[nodes[i]].depth);
+	if (depth < _settings.parallelDepth) return false;
+
+	auto task = ContourTask();
+	task.kind = kind;
+	std::copy(nodes, nodes + count, task.nodes);
+	task.direction = direction;
+	deferred->push_back(task);
+	return true;
+}
+
+void SDFMeshExtractor::ContourCell(int node, std::vector<uint32_t>& indices, std::vector<ContourTask>* deferred) const
+{
+	const auto firstChild = _nodes[node].firstChild;
+	if (firstChild < 0) return;
+	if (Defer(0, &node, 1, 0, deferred)) return;
+
+	for (auto c = 0; c < 8; c++) ContourCell(firstChild + c, indices, deferred);
+
+	for (auto i = 0; i < 12; i++)
+	{
+		ContourFace(firstChild + cellFaces[i][0], firstChild + cellFaces[i][1], cellFaces[i][2], indices, deferred);
+	}
+
+	for (auto i = 0; i < 6; i++)
+	{
+		const int edgeNodes[4] = { firstChild + cellEdges[i][0], firstChild + cellEdges[i][1], firstChild + cellEdges[i][2], firstChild + cellEdges[i][3] };
+		ContourEdge(edgeNodes, cellEdges[i][4], indices, deferred);
+	}
+}
+
+void SDFMeshExtractor::ContourFace(int a, int b, int direction, std::vector<uint32_t>& indices, std::vector<ContourTask>* deferred) const
+{
+	const int faceNodes[2] = { a, b };
+	if (_nodes[a].firstChild < 0 && _nodes[b].firstChild < 0) return;
+	if (Defer(1, faceNodes, 2, direction, deferred)) return;
+
+	const auto child = [this](int node, int c) { return _nodes[node].firstChild < 0 ? node : _nodes[node].firstChild + c; };
+
+	for (auto i = 0; i < 4; i++)
+	{
+		ContourFace(child(a, faceFaces[direction][i][0]), child(b, faceFaces[direction][i][1]), faceFaces[direction][i][2], indices, deferred);
+	}
+
+	for (auto i = 0; i < 4; i++)
+	{
+		const auto& mask = faceEdges[direction][i];
+		const auto& order = faceEdgeOrders[mask[0]];
+		int edgeNodes[4];
+		for (auto j = 0; j < 4; j++) edgeNodes[j] = child(faceNodes[order[j]], mask[1 + j]);
+		ContourEdge(edgeNodes, mask[5], indices, deferred);
+	}
+}
+
+void SDFMeshExtractor::ContourEdge(const int nodes[4], int direction, std::vector<uint32_t>& indices, std::vector<ContourTask>* deferred) const
+{
+	if (_nodes[nodes[0]].firstChild < 0 && _nodes[nodes[1]].firstChild < 0 && _nodes[nodes[2]].firstChild < 0 && _nodes[nodes[3]].firstChild < 0)
+	{
+		EmitQuad(nodes, direction, indices);
+		return;
+	}
+	if (Defer(2, nodes, 4, direction, deferred)) return;
+
+	for (auto i = 0; i < 2; i++)
+	{
+		int edgeNodes[4];
+		for (auto j = 0; j < 4; j++)
+		{
+			const auto& node = _nodes[nodes[j]];
+			edgeNodes[j] = node.firstChild < 0 ? nodes[j] : node.firstChild + edgeEdges[direction][i][j];
+		}
+		ContourEdge(edgeNodes, edgeEdges[direction][i][4], indices, deferred);
+	}
+}
+
+void SDFMeshExtractor::EmitQuad(const int nodes[4], int direction, std::vector<uint32_t>& indices) const
+{
+	// The smallest of the four leaves owns the minimal edge, its corners decide the crossing
+	auto smallest = 0;
+	for (auto i = 1; i < 4; i++)
+	{
+		if (_nodes[nodes[i]].size < _nodes[nodes[smallest]].size) smallest = i;
+	}
+
+	const auto& owner = _nodes[nodes[smallest]];
+	const auto edge = sharedEdges[direction][smallest];
+	const auto inside0 = (owner.signs >> edgeCorners[edge][0]) & 1;
+	const auto inside1 = (owner.signs >> edgeCorners[edge][1]) & 1;
+	if (inside0 == inside1) return;
+
+	int vertices[4];
+	for (auto i = 0; i < 4; i++)
+	{
+		vertices[i] = _nodes[nodes[i]].vertex;
+		if (vertices[i] < 0) return;
+	}
+
+	// Winding so the faces point out of the surface, along the SDF gradient, split along either diagonal
+	static const int outwards[2][2][3] = { { { 0, 1, 3 }, { 0, 3, 2 } }, { { 0, 1, 2 }, { 1, 3, 2 } } };
+	static const int inwards[2][2][3] = { { { 0, 3, 1 }, { 0, 2, 3 } }, { { 0, 2, 1 }, { 1, 2, 3 } } };
+	const auto& splits = inside0 ? inwards : outwards;
+
+	// A quad folded over one diagonal leaves a triangle facing into the surface, the other diagonal does not
+	auto alignment = [&](const int (&split)[2][3])
+	{
+		auto lowest = 1e10f;
+		for (const auto& triangle : split)
+		{
+			const auto& a = _vertices[vertices[triangle[0]]];
+			const auto& b = _vertices[vertices[triangle[1]]];
+			const auto& c = _vertices[vertices[triangle[2]]];
+			lowest = std::min(lowest, dot(cross(b.position - a.position, c.position - a.position), a.normal + b.normal + c.normal));
+		}
+		return lowest;
+	};
+	const auto& triangles = splits[alignment(splits[1]) > alignment(splits[0]) ? 1 : 0];
+	for (const auto& triangle : triangles)
+	{
+		const auto a = vertices[triangle[0]];
+		const auto b = vertices[triangle[1]];
+		const auto c = vertices[triangle[2]];
+
+		// Merged leaves can appear twice around an edge
+		if (a == b || b == c || a == c) continue;
+
+		indices.push_back(static_cast<uint32_t>(a));
+		indices.push_back(static_cast<uint32_t>(b));
+		indices.push_back(static_cast<uint32_t>(c));
+	}
+}
+
+SDFMeshVertex SDFMeshExtractor::MakeVertex(const float3& position) const
+{
+	const auto gradient = _scene.EvaluateGradient(position).yzw();
+	const auto gradientLength = length(gradient);
+	const auto normal = gradientLength > 1e-6f ? gradient / gradientLength : float3(0.0f, 1.0f, 0.0f);
+
+	// Triplanar coordinates, projected along the normal's largest axis with u flipped on
+	// the negative side so tangent x binormal always gives the normal
+	const auto absolute = abs(normal);
+	const auto axis = absolute.x >= absolute.y && absolute.x >= absolute.z ? 0 : (absolute.y >= absolute.z ? 1 : 2);
+	const auto side = Component(normal, axis) < 0.0f ? -1.0f : 1.0f;
+	const auto uAxis = (axis + 1) % 3;
+	const auto vAxis = (axis + 2) % 3;
+
+	SDFMeshVertex vertex;
+	vertex.position = position;
+	vertex.texcoord = float2(side * Component(position, uAxis), Component(position, vAxis)) * _settings.texcoordScale;
+	vertex.normal = normal;
+	vertex.tangent = normalize(Axis(uAxis) * side - normal * (side * Component(normal, uAxis)));
+	vertex.binormal = cross(normal, vertex.tangent);
+	return vertex;
+}
+
+void SDFMeshExtractor::Extract()
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	auto root = Node();
+	root.min = _origin;
+	root.size = _size;
+	root.firstChild = -1;
+	root.vertex = -1;
+	_nodes.assign(1, root);
+
+	// The top levels are split serially, every node reaching the parallel depth is a task
+	const auto parallelDepth = std::min(_settings.parallelDepth, _settings.maxDepth);
+	std::vector<int> everyPrimitive(_scene.GetPrimitiveCount());
+	for (auto i = 0; i < _scene.GetPrimitiveCount(); i++) everyPrimitive[i] = i;
+
+	std::vector<int> subtrees;
+	std::vector<std::vector<int>> subtreeCandidates;
+	std::vector<std::vector<int>> candidates(1, everyPrimitive);
+	for (auto index = 0; index < static_cast<int>(_nodes.size()); index++)
+	{
+		if (_nodes[index].depth == parallelDepth)
+		{
+			subtrees.push_back(index);
+			subtreeCandidates.push_back(candidates[index]);
+			continue;
+		}
+
+		std::vector<int> closest;
+		const auto state = Classify(_nodes[index].min, _nodes[index].size, candidates[index], closest);
+		if (state != 0)
+		{
+			_nodes[index].signs = state > 0 ? 0xFF : 0;
+			continue;
+		}
+
+		Split(_nodes, index);
+		candidates.resize(_nodes.size(), closest);
+	}
+
+	std::vector<std::vector<Node>> built(subtrees.size());
+	ParallelFor(0, static_cast<int>(subtrees.size()), _settings.threads, [&](int task)
+	{
+		built[task].assign(1, _nodes[subtrees[task]]);
+		BuildNode(built[task], 0, subtreeCandidates[task]);
+	});
+
+	// Splice the subtrees in, their nodes keep their order after the first
+	for (size_t task = 0; task < subtrees.size(); task++)
+	{
+		const auto offset = static_cast<int>(_nodes.size()) - 1;
+		auto& subtree = built[task];
+		for (auto& node : subtree)
+		{
+			if (node.firstChild >= 0) node.firstChild += offset;
+		}
+
+		_nodes[subtrees[task]] = subtree[0];
+		_nodes.insert(_nodes.end(), subtree.begin() + 1, subtree.end());
+		std::vector<Node>().swap(subtree);
+	}
+
+	_stats = SDFMeshStats();
+	auto vertexCount = 0;
+	for (auto& node : _nodes)
+	{
+		if (node.firstChild >= 0) continue;
+
+		_stats.leaves++;
+		if (node.vertex >= 0) node.vertex = vertexCount++;
+		if (node.vertex >= 0 && node.depth < _settings.maxDepth) _stats.collapsedNodes++;
+	}
+
+	// The contouring picks each quad's diagonal from the vertex normals
+	_vertices.resize(vertexCount);
+	ParallelFor(0, static_cast<int>(_nodes.size()), _settings.threads, [&](int index)
+	{
+		const auto& node = _nodes[index];
+		if (node.firstChild < 0 && node.vertex >= 0) _vertices[node.vertex] = MakeVertex(node.position);
+	}, 256);
+
+	const auto buildTime = std::chrono::steady_clock::now();
+
+	// Contour the top levels and collect the calls reaching the parallel depth as tasks
+	std::vector<ContourTask> tasks;
+	_indices.clear();
+	ContourCell(0, _indices, &tasks);
+
+	std::vector<std::vector<uint32_t>> taskIndices(tasks.size());
+	ParallelFor(0, static_cast<int>(tasks.size()), _settings.threads, [&](int i)
+	{
+		const auto& task = tasks[i];
+		if (task.kind == 0) ContourCell(task.nodes[0], taskIndices[i], nullptr);
+		else if (task.kind == 1) ContourFace(task.nodes[0], task.nodes[1], task.direction, taskIndices[i], nullptr);
+		else ContourEdge(task.nodes, task.direction, taskIndices[i], nullptr);
+	});
+
+	for (const auto& indices : taskIndices) _indices.insert(_indices.end(), indices.begin(), indices.end());
+
+	const auto endTime = std::chrono::steady_clock::now();
+
+	_stats.leafSize = _size / static_cast<float>(1 << _settings.maxDepth);
+	_stats.nodes = static_cast<int>(_nodes.size());
+	_stats.surfaceLeaves = vertexCount;
+	_stats.denseCells = 1ll << (3 * _settings.maxDepth);
+	_stats.vertices = vertexCount;
+	_stats.triangles = static_cast<int>(_indices.size() / 3);
+	_stats.buildMilliseconds = std::chrono::duration<double, std::milli>(buildTime - startTime).count();
+	_stats.contourMilliseconds = std::chrono::duration<double, std::milli>(endTime - buildTime).count();
+	_stats.totalMilliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	_stats.threads = ResolveThreadCount(_settings.threads);
+}
+
+bool SDFMeshExtractor::WriteModel(const std::string& fileName) const
+{
+	auto file = std::fopen(fileName.c_str(), "w");
+	if (!file) return false;
+
+	const auto faces = _indices.size() / 3;
+	std::fprintf(file, "vertices\n%d\nnormals\n%d\ntexture\n%d\nfaces\n%d\n\n", static_cast<int>(_vertices.size()), static_cast<int>(_vertices.size()), static_cast<int>(faces * 3), static_cast<int>(faces));
+
+	for (const auto& vertex : _vertices) std::fprintf(file, "v  %.6f %.6f %.6f\n", vertex.position.x, vertex.position.y, vertex.position.z);
+	std::fprintf(file, "\n");
+	for (const auto& vertex : _vertices) std::fprintf(file, "vn %.6f %.6f %.6f\n", vertex.normal.x, vertex.normal.y, vertex.normal.z);
+	std::fprintf(file, "\n");
+
+	for (size_t face = 0; face < faces; face++)
+	{
+		const auto& a = _vertices[_indices[face * 3]].position;
+		const auto& b = _vertices[_indices[face * 3 + 1]].position;
+		const auto& c = _vertices[_indices[face * 3 + 2]].position;
+
+		// Same projection as MakeVertex, along the face normal this time
+		const auto normal = cross(b - a, c - a);
+		const auto absolute = abs(normal);
+		const auto axis = absolute.x >= absolute.y && absolute.x >= absolute.z ? 0 : (absolute.y >= absolute.z ? 1 : 2);
+		const auto side = Component(normal, axis) < 0.0f ? -1.0f : 1.0f;
+		for (const auto& p : { a, b, c })
+		{
+			std::fprintf(file, "vt %.6f %.6f 0.000000\n", side * Component(p, (axis + 1) % 3) * _settings.texcoordScale, Component(p, (axis + 2) % 3) * _settings.texcoordScale);
+		}
+	}
+	std::fprintf(file, "\n");
+
+	for (size_t face = 0; face < faces; face++)
+	{
+		std::fprintf(file, "f");
+		for (auto i = 0; i < 3; i++)
+		{
+			const auto vertex = _indices[face * 3 + i] + 1;
+			std::fprintf(file, " %u/%u/%u", vertex, static_cast<unsigned int>(face * 3 + i + 1), vertex);
+		}
+		std::fprintf(file, " \n");
+	}
+
+	return std::fclose(file) == 0;
+}
@@ -0,0 +1,123 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SDFScene.h"
+
+// Same layout as VertexPositionTexcoordNormalTangentBinormal, the vertex LoadModel builds
+struct SDFMeshVertex
+{
+	float3 position;
+	float2 texcoord;
+	float3 normal;
+	float3 tangent;
+	float3 binormal;
+};
+
+struct SDFMeshSettings
+{
+	int maxDepth = 7;				// finest leaves are the bounds' size / 2^maxDepth across
+	float simplifyError = 0.0f;		// QEF error (squared distance) under which 8 leaves collapse into one, 0 keeps the finest level
+	int parallelDepth = 2;			// subtrees below this depth are built and contoured as separate tasks
+	float texcoordScale = 4.0f;		// triplanar texture repeats per world unit
+	int threads = 0;				// 0 uses every hardware thread
+};
+
+struct SDFMeshStats
+{
+	float leafSize;					// edge of the finest leaves
+	int nodes;
+	int leaves;
+	int surfaceLeaves;				// leaves holding a vertex
+	int collapsedNodes;				// internal nodes turned into leaves by the simplification
+	long long denseCells;			// cells of a uniform grid at the finest level
+	int vertices;
+	int triangles;
+	double buildMilliseconds;		// octree, edge crossings and QEF solves
+	double contourMilliseconds;
+	double totalMilliseconds;
+	int threads;
+};
+
+// Dual contouring of SDFScene::Evaluate on an adaptive octree, pruned with interval evaluation
+class SDFMeshExtractor
+{
+public: // Structors
+	SDFMeshExtractor(const SDFScene& scene, const SDFMeshSettings& settings);
+
+public: // Accessors
+	const SDFMeshSettings& GetSettings() const { return _settings; }
+	const SDFMeshStats& GetStats() const { return _stats; }
+	const std::vector<SDFMeshVertex>& GetVertices() const { return _vertices; }
+	const std::vector<uint32_t>& GetIndices() const { return _indices; }
+
+public: // Functions
+	void Extract();
+
+	// Text format ResourceManager::LoadModel reads, each face gets its own triplanar coordinates
+	bool WriteModel(const std::string& fileName) const;
+
+private: // Types
+	// Least squares system of the tangent planes at the edge crossings of a leaf
+	struct QEF
+	{
+		float ata[6];		// xx, xy, xz, yy, yz, zz
+		float3 atb;
+		float btb;
+		float3 massPoint;	// sum of the crossings
+		int count;
+
+		void Add(const float3& p, const float3& n);
+		void Add(const QEF& other);
+		// Minimiser within [cellMin, cellMin + size], returns the residual
+		float Solve(const float3& cellMin, float size, float3& position) const;
+	};
+
+	struct Node
+	{
+		float3 min;
+		float size;
+		int depth;
+		int firstChild;		// 8 consecutive nodes, -1 for a leaf
+		int vertex;			// -1 unless the surface crosses the leaf
+		uint8_t signs;		// bit i is set when corner i is inside
+		float3 position;
+		QEF qef;
+	};
+
+	struct ContourTask
+	{
+		int kind;			// 0 cell, 1 face, 2 edge
+		int nodes[4];
+		int direction;
+	};
+
+private: // Functions
+	// -1 outside, 1 inside, 0 when the surface may cross the cell and closest gets the nearest candidates
+	int Classify(const float3& cellMin, float size, const std::vector<int>& candidates, std::vector<int>& closest) const;
+	float Distance(const float3& samplePoint, const std::vector<int>& candidates) const;
+	void BuildNode(std::vector<Node>& nodes, int index, const std::vector<int>& candidates) const;
+	void BuildLeaf(Node& node, const std::vector<int>& candidates) const;
+	static void Split(std::vector<Node>& nodes, int index);
+	void Simplify(std::vector<Node>& nodes, int index) const;
+
+	void ContourCell(int node, std::vector<uint32_t>& indices, std::vector<ContourTask>* deferred) const;
+	void ContourFace(int a, int b, int direction, std::vector<uint32_t>& indices, std::vector<ContourTask>* deferred) const;
+	void ContourEdge(const int nodes[4], int direction, std::vector<uint32_t>& indices, std::vector<ContourTask>* deferred) const;
+	void EmitQuad(const int nodes[4], int direction, std::vector<uint32_t>& indices) const;
+	bool Defer(int kind, const int* nodes, int count, int direction, std::vector<ContourTask>* deferred) const;
+
+	SDFMeshVertex MakeVertex(const float3& position) const;
+
+private: // Data
+	const SDFScene& _scene;
+	SDFMeshSettings _settings;
+	SDFMeshStats _stats;
+
+	float3 _origin;
+	float _size;
+
+	std::vector<Node> _nodes;
+	std::vector<SDFMeshVertex> _vertices;
+	std::vector<uint32_t> _indices;
+};
@@ -0,0 +1,33 @@
+#include "SDFNormals.h"
+#include <cmath>
+
+float3 CentralDifferenceNormal(const SDFScene& scene, const float3& p, float epsilon)
+{
+	return normalize(float3(scene.Evaluate(float3(p.x + epsilon, p.y, p.z)).x - scene.Evaluate(float3(p.x - epsilon, p.y, p.z)).x,
+		scene.Evaluate(float3(p.x, p.y + epsilon, p.z)).x - scene.Evaluate(float3(p.x, p.y - epsilon, p.z)).x,
+		scene.Evaluate(float3(p.x, p.y, p.z + epsilon)).x - scene.Evaluate(float3(p.x, p.y, p.z - epsilon)).x));
+}
+
+float3 TetrahedralNormal(const SDFScene& scene, const float3& p, float epsilon)
+{
+	// k.xyy, k.yyx, k.yxy and k.xxx with k = (1, -1)
+	const float3 a = float3(1.0f, -1.0f, -1.0f);
+	const float3 b = float3(-1.0f, -1.0f, 1.0f);
+	const float3 c = float3(-1.0f, 1.0f, -1.0f);
+	const float3 d = float3(1.0f, 1.0f, 1.0f);
+
+	return normalize(a * scene.Evaluate(p + a * epsilon).x + b * scene.Evaluate(p + b * epsilon).x +
+		c * scene.Evaluate(p + c * epsilon).x + d * scene.Evaluate(p + d * epsilon).x);
+}
+
+float3 DualNumberNormal(const SDFScene& scene, const float3& p, bool* fellBack)
+{
+	const auto gradient = scene.EvaluateGradient(p).yzw();
+	const auto squaredLength = dot(gradient, gradient);
+
+	// Zero at sqrt(0) and pow(0, e), not finite if a division blew up
+	const auto usable = std::isfinite(squaredLength) && squaredLength > 1e-12f;
+	if (fellBack) *fellBack = !usable;
+
+	return usable ? gradient / std::sqrt(squaredLength) : TetrahedralNormal(scene, p);
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include "SDFRayMarcher.h"
+
+// Same as estimateGradiantNormal in the shader, six scene evaluations
+float3 CentralDifferenceNormal(const SDFScene& scene, const float3& p, float epsilon = 0.0001f);
+// Four evaluations at the corners of a tetrahedron around p
+float3 TetrahedralNormal(const SDFScene& scene, const float3& p, float epsilon = 0.0001f);
+// One dual number evaluation, falls back to TetrahedralNormal where the gradient is degenerate
+float3 DualNumberNormal(const SDFScene& scene, const float3& p, bool* fellBack = nullptr);
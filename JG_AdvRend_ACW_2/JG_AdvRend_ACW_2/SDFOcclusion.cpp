@@ -0,0 +1,179 @@
+#include "SDFOcclusion.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace SDF;
+
+SDFOcclusion::SDFOcclusion(const SDFScene& scene, const SDFOcclusionSettings& settings)
+	: _scene(scene), _settings(settings), _marcher(scene, SDFMarchSettings())
+{
+}
+
+float SDFOcclusion::Distance(const float3& samplePoint, float footprint, const std::vector<int>* candidates, int& evaluations) const
+{
+	if (!candidates)
+	{
+		evaluations += _scene.GetPrimitiveCount();
+		return _scene.Evaluate(samplePoint, footprint).x;
+	}
+
+	const auto& primitives = _scene.GetPrimitives();
+	auto distance = 1e10f;
+	for (const auto primitive : *candidates)
+	{
+		distance = std::min(distance, SDFScene::EvaluatePrimitive(primitives[primitive], samplePoint, footprint).x);
+	}
+	evaluations += static_cast<int>(candidates->size());
+	return distance;
+}
+
+float SDFOcclusion::SoftShadow(const float3& p, const float3& n, const float3& lightPosition, float footprint, SDFOcclusionStats* stats) const
+{
+	SDFOcclusionStats local = {};
+	auto& result = stats ? *stats : local;
+	result.shadowSteps = 0;
+
+	const auto toLight = lightPosition - p;
+	const auto end = length(toLight);
+	const SDFRay ray = { p + n * _settings.shadowStart, toLight / end };
+	const auto k = _settings.shadowSoftness;
+
+	if (dot(n, ray.d) <= 0.0f)
+	{
+		result.shadowOutcome = SDFShadowOutcome::FacingAway;
+		return 0.0f;
+	}
+
+	thread_local std::vector<SDFBoundInterval> intervals;
+	if (_settings.boundingCulling) _marcher.BuildBoundIntervals(ray, _settings.shadowStart, end, intervals, end / k);
+
+	const auto& primitives = _scene.GetPrimitives();
+	auto shadow = 1.0f;
+	auto t = _settings.shadowStart;
+	auto previous = 1e10f;
+
+	for (auto i = 0; i < _settings.shadowSteps; i++)
+	{
+		if (_settings.boundingCulling && intervals.empty())
+		{
+			result.shadowOutcome = SDFShadowOutcome::LeftBounds;
+			return shadow;
+		}
+
+		const auto samplePoint = ray.o + t * ray.d;
+		auto distance = 1e10f;
+		// Distance to the next grown bound the ray has not entered, stepping further could miss its penumbra
+		auto boundStep = 1e10f;
+
+		if (_settings.boundingCulling)
+		{
+			for (auto j = 0; j < static_cast<int>(intervals.size());)
+			{
+				const auto& interval = intervals[j];
+
+				if (t > interval.tFar)
+				{
+					intervals[j] = intervals.back();
+					intervals.pop_back();
+					continue;
+				}
+
+				if (t < interval.tNear) boundStep = std::min(boundStep, interval.tNear - t);
+				else
+				{
+					distance = std::min(distance, SDFScene::EvaluatePrimitive(primitives[interval.primitive], samplePoint, footprint).x);
+					result.primitiveEvaluations++;
+				}
+
+				j++;
+			}
+		}
+		else
+		{
+			distance = Distance(samplePoint, footprint, nullptr, result.primitiveEvaluations);
+		}
+
+		result.shadowSteps++;
+
+		// Between grown bounds, or a primitive dropped out and the distance jumped, the next sample starts a new approach
+		if (distance >= 1e10f || distance > 2.0f * previous) previous = 1e10f;
+
+		if (distance < 1e10f)
+		{
+			// Closest approach to the surface between this sample and the last one
+			const auto y = distance * distance / (2.0f * previous);
+			const auto d = std::sqrt(std::max(0.0f, distance * distance - y * y));
+			shadow = std::min(shadow, k * d / std::max(1e-6f, t - y));
+			previous = distance;
+
+			if (shadow < _settings.shadowCutoff)
+			{
+				result.shadowOutcome = SDFShadowOutcome::Occluded;
+				return 0.0f;
+			}
+		}
+		else if (boundStep >= 1e10f)
+		{
+			result.shadowOutcome = SDFShadowOutcome::LeftBounds;
+			return shadow;
+		}
+
+		t += std::max(std::min(distance, boundStep), _settings.shadowMinStep);
+
+		if (t >= end)
+		{
+			result.shadowOutcome = SDFShadowOutcome::ReachedLight;
+			return shadow;
+		}
+	}
+
+	result.shadowOutcome = SDFShadowOutcome::OutOfSteps;
+	return shadow;
+}
+
+float SDFOcclusion::AmbientOcclusion(const float3& p, const float3& n, float footprint, SDFOcclusionStats* stats) const
+{
+	SDFOcclusionStats local = {};
+	auto& result = stats ? *stats : local;
+	result.occlusionTaps = 0;
+
+	const auto taps = std::min(_settings.occlusionTaps, 5);
+	if (taps <= 0) return 1.0f;
+
+	const auto reach = _settings.occlusionReach;
+
+	// A primitive whose bound is twice the reach away is further from every tap than the tap's height
+	thread_local std::vector<int> candidates;
+	const std::vector<int>* evaluated = nullptr;
+	if (_settings.boundingCulling)
+	{
+		candidates.clear();
+		const auto& primitives = _scene.GetPrimitives();
+		for (auto i = 0; i < static_cast<int>(primitives.size()); i++)
+		{
+			if (length(p - primitives[i].boundCentre) - primitives[i].boundRadius < 2.0f * reach) candidates.push_back(i);
+		}
+		if (candidates.empty()) return 1.0f;
+		evaluated = &candidates;
+	}
+
+	auto occlusion = 0.0f;
+	auto weight = 1.0f;
+	for (auto i = 0; i < taps; i++)
+	{
+		const auto h = taps > 1 ? reach * (0.1f + 0.9f * i / (taps - 1)) : reach;
+		const auto distance = Distance(p + n * h, footprint, evaluated, result.primitiveEvaluations);
+		result.occlusionTaps++;
+
+		occlusion += std::max(0.0f, h - distance) * weight;
+		weight *= 0.95f;
+
+		// Fully occluded
+		if (_settings.occlusionStrength * occlusion >= 1.0f) return 0.0f;
+
+		// With a slope of at most 1 no later tap can get closer to a surface than its height
+		if (distance >= 2.0f * reach - h) break;
+	}
+
+	return std::max(0.0f, 1.0f - _settings.occlusionStrength * occlusion);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include "SDFRayMarcher.h"
+
+struct SDFOcclusionSettings
+{
+	int shadowSteps = 32;			// budget of the shadow march
+	float shadowSoftness = 16.0f;	// k in min(k h / t), larger gives harder penumbrae
+	float shadowStart = 0.005f;		// first sample along the shadow ray, clears the surface it starts on
+	float shadowMinStep = 0.001f;	// keeps rays grazing a surface moving
+	float shadowCutoff = 0.001f;	// below this the point is fully in shadow
+	int occlusionTaps = 5;			// samples along the normal, 0 leaves the ambient light unoccluded
+	float occlusionReach = 0.06f;	// distance of the last tap from the surface
+	float occlusionStrength = 6.0f;	// occlusion = 1 - strength * weighted sum of (h - d)
+	bool boundingCulling = true;	// only evaluates the primitives whose bound the shadow ray or the taps reach
+};
+
+// Why a shadow march stopped
+enum class SDFShadowOutcome
+{
+	FacingAway,			// the surface faces away from the light and shades itself, no march
+	LeftBounds,			// every remaining bound is behind the ray, nothing else can shade it
+	ReachedLight,
+	Occluded,			// fully in shadow, further steps cannot brighten it
+	OutOfSteps,			// budget used up, the penumbra found so far is kept
+	Count
+};
+
+struct SDFOcclusionStats
+{
+	int shadowSteps;
+	int occlusionTaps;
+	int primitiveEvaluations;
+	SDFShadowOutcome shadowOutcome;
+};
+
+// Soft shadows and ambient occlusion from the scene's distance field, each capped at its budget of steps or taps
+class SDFOcclusion
+{
+public: // Structors
+	SDFOcclusion(const SDFScene& scene, const SDFOcclusionSettings& settings);
+
+public: // Accessors
+	const SDFOcclusionSettings& GetSettings() const { return _settings; }
+
+public: // Functions
+	// 1 lit to 0 in shadow, footprint sets the fractal's detail as in SDFScene::Evaluate
+	float SoftShadow(const float3& p, const float3& n, const float3& lightPosition, float footprint = 0.0f, SDFOcclusionStats* stats = nullptr) const;
+	// 1 open to 0 enclosed
+	float AmbientOcclusion(const float3& p, const float3& n, float footprint = 0.0f, SDFOcclusionStats* stats = nullptr) const;
+
+private: // Functions
+	// Nearest distance over the candidates, or the whole scene when candidates is null
+	float Distance(const float3& samplePoint, float footprint, const std::vector<int>* candidates, int& evaluations) const;
+
+private: // Data
+	const SDFScene& _scene;
+	SDFOcclusionSettings _settings;
+	SDFRayMarcher _marcher;
+};
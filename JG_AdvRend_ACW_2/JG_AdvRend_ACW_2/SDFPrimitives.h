@@ -0,0 +1,317 @@
+#pragma once
+#include "Common/ShaderMath.h"
+
+// CPU ports of PS_RayMarchObjects.hlsl's distance functions, templated on float or Dual (Common/Dual.h)
+namespace SDF
+{
+	using namespace HLSL;
+
+	// Scalar functions called unqualified below, other scalar types provide overloads found by argument dependent lookup
+	inline float sqrt(float x) { return std::sqrt(x); }
+	inline float abs(float x) { return std::abs(x); }
+	inline float pow(float x, float e) { return std::pow(x, e); }
+	inline float cos(float x) { return std::cos(x); }
+	inline float sin(float x) { return std::sin(x); }
+	inline float ValueOf(float x) { return x; }
+
+	template<typename T> T length2(Vector2<T> p)
+	{
+		return sqrt(p.x * p.x + p.y * p.y);
+	}
+
+	template<typename T> T length6(Vector2<T> p)
+	{
+		p = p * p * p;
+		p = p * p;
+		return pow(p.x + p.y, 1.0f / 6.0f);
+	}
+
+	template<typename T> T length8(Vector2<T> p)
+	{
+		p = p * p;
+		p = p * p;
+		p = p * p;
+		return pow(p.x + p.y, 1.0f / 8.0f);
+	}
+
+	template<typename T> T dot2(const Vector2<T>& v)
+	{
+		return dot(v, v);
+	}
+
+	template<typename T> T dot2(const Vector3<T>& v)
+	{
+		return dot(v, v);
+	}
+
+	template<typename T> T torusSDF(Vector3<T> p, float2 t)
+	{
+		const Vector2<T> q = Vector2<T>(length(p.xz()) - t.x, p.y);
+		return length(q) - t.y;
+	}
+
+	template<typename T> T roundBoxSDF(Vector3<T> p, float3 b, float r)
+	{
+		const Vector3<T> q = abs(p) - Vector3<T>(b);
+		return min(max(q.x, max(q.y, q.z)), T(0.0f)) + length(max(q, T(0.0f))) - r;
+	}
+
+	template<typename T> T cylinderSDF(Vector3<T> p, float2 h)
+	{
+		const Vector2<T> d = abs(Vector2<T>(length(p.xz()), p.y)) - Vector2<T>(h);
+		return min(max(d.x, d.y), T(0.0f)) + length(max(d, T(0.0f)));
+	}
+
+	template<typename T> T cylinder6SDF(Vector3<T> p, float2 h)
+	{
+		return max(length6(p.xz()) - h.x, abs(p.y) - h.y);
+	}
+
+	template<typename T> T cylinderSDF(Vector3<T> p, float3 a, float3 b, float r)
+	{
+		const Vector3<T> pa = p - Vector3<T>(a);
+		const float3 ba = b - a;
+		const float baba = dot(ba, ba);
+		const T paba = dot(pa, Vector3<T>(ba));
+
+		const T x = length(pa * T(baba) - Vector3<T>(ba) * paba) - r * baba;
+		const T y = abs(paba - baba * 0.5f) - baba * 0.5f;
+		const T x2 = x * x;
+		const T y2 = y * y * baba;
+		const T d = (max(x, y) < 0.0f) ? -min(x2, y2) : (((x > 0.0f) ? x2 : T(0.0f)) + ((y > 0.0f) ? y2 : T(0.0f)));
+		return sign(d) * sqrt(abs(d)) / baba;
+	}
+
+	template<typename T> T torus82SDF(Vector3<T> p, float2 t)
+	{
+		const Vector2<T> q = Vector2<T>(length2(p.xz()) - t.x, p.y);
+		return length8(q) - t.y;
+	}
+
+	template<typename T> T boxSDF(Vector3<T> p, float3 b)
+	{
+		const Vector3<T> d = abs(p) - Vector3<T>(b);
+		return min(max(d.x, max(d.y, d.z)), T(0.0f)) + length(max(d, T(0.0f)));
+	}
+
+	template<typename T> T coneSDF(Vector3<T> p, float3 c)
+	{
+		const Vector2<T> q = Vector2<T>(length(p.xz()), p.y);
+		const T d1 = -q.y - c.z;
+		const T d2 = max(dot(q, Vector2<T>(c.xy())), q.y);
+		return length(max(Vector2<T>(d1, d2), T(0.0f))) + min(max(d1, d2), T(0.0f));
+	}
+
+	template<typename T> T cappedConeSDF(Vector3<T> p, float h, float r1, float r2)
+	{
+		const Vector2<T> q = Vector2<T>(length(p.xz()), p.y);
+
+		const float2 k1 = float2(r2, h);
+		const float2 k2 = float2(r2 - r1, 2.0f * h);
+		const Vector2<T> ca = Vector2<T>(q.x - min(q.x, T((q.y < 0.0f) ? r1 : r2)), abs(q.y) - h);
+		const Vector2<T> cb = q - Vector2<T>(k1) + Vector2<T>(k2) * clamp(dot(Vector2<T>(k1) - q, Vector2<T>(k2)) / dot2(k2), 0.0f, 1.0f);
+		const float s = (cb.x < 0.0f && ca.y < 0.0f) ? -1.0f : 1.0f;
+		return s * sqrt(min(dot2(ca), dot2(cb)));
+	}
+
+	template<typename T> T roundConeSDF(Vector3<T> p, float r1, float r2, float h)
+	{
+		const Vector2<T> q = Vector2<T>(length(p.xz()), p.y);
+
+		const float b = (r1 - r2) / h;
+		const float a = std::sqrt(1.0f - b * b);
+		const T k = dot(q, Vector2<T>(float2(-b, a)));
+
+		if (k < 0.0f) return length(q) - r1;
+		if (k > a * h) return length(q - Vector2<T>(float2(0.0f, h))) - r2;
+
+		return dot(q, Vector2<T>(float2(a, b))) - r1;
+	}
+
+	template<typename T> T roundConeSDF(Vector3<T> p, float3 a, float3 b, float r1, float r2)
+	{
+		const float3 ba = b - a;
+		const float l2 = dot(ba, ba);
+		const float rr = r1 - r2;
+		const float a2 = l2 - rr * rr;
+		const float il2 = 1.0f / l2;
+
+		const Vector3<T> pa = p - Vector3<T>(a);
+		const T y = dot(pa, Vector3<T>(ba));
+		const T z = y - l2;
+		const T x2 = dot2(pa * T(l2) - Vector3<T>(ba) * y);
+		const T y2 = y * y * l2;
+		const T z2 = z * z * l2;
+
+		const T k = HLSL::sign(rr) * rr * rr * x2;
+		if (sign(z) * a2 * z2 > k) return sqrt(x2 + z2) * il2 - r2;
+		if (sign(y) * a2 * y2 < k) return sqrt(x2 + y2) * il2 - r1;
+		return (sqrt(x2 * a2 * il2) + y * rr) * il2 - r1;
+	}
+
+	template<typename T> T ellipsoidSDF(Vector3<T> p, float3 r)
+	{
+		const T k0 = length(p / Vector3<T>(r));
+		const T k1 = length(p / Vector3<T>(r * r));
+		return k0 * (k0 - 1.0f) / k1;
+	}
+
+	template<typename T> T equilateralTriangleSDF(Vector2<T> p)
+	{
+		const float k = 1.73205f;
+		p.x = abs(p.x) - 1.0f;
+		p.y = p.y + 1.0f / k;
+		if (p.x + k * p.y > 0.0f) p = Vector2<T>(p.x - k * p.y, -k * p.x - p.y) / T(2.0f);
+		p.x += 2.0f - 2.0f * clamp((p.x + 2.0f) / 2.0f, 0.0f, 1.0f);
+		return -length(p) * sign(p.y);
+	}
+
+	template<typename T> T triPrismSDF(Vector3<T> p, float2 h)
+	{
+		const Vector3<T> q = abs(p);
+		const T d1 = q.z - h.y;
+		h.x *= 0.866025f;
+		const T d2 = equilateralTriangleSDF(p.xy() / T(h.x)) * h.x;
+		return length(max(Vector2<T>(d1, d2), T(0.0f))) + min(max(d1, d2), T(0.0f));
+	}
+
+	template<typename T> T hexPrismSDF(Vector3<T> p, float2 h)
+	{
+		const float3 k = float3(-0.8660254f, 0.5f, 0.57735f);
+		p = abs(p);
+		const T fold = 2.0f * min(dot(Vector2<T>(k.xy()), p.xy()), T(0.0f));
+		p.x -= fold * k.x;
+		p.y -= fold * k.y;
+		const Vector2<T> d = Vector2<T>(
+			length(p.xy() - Vector2<T>(clamp(p.x, -k.z * h.x, k.z * h.x), T(h.x))) * sign(p.y - h.x),
+			p.z - h.y);
+		return min(max(d.x, d.y), T(0.0f)) + length(max(d, T(0.0f)));
+	}
+
+	template<typename T> T octahedronSDF(Vector3<T> p, float s)
+	{
+		p = abs(p);
+
+		const T m = p.x + p.y + p.z - s;
+
+		Vector3<T> q;
+		if (3.0f * p.x < m) q = p;
+		else if (3.0f * p.y < m) q = p.yzx();
+		else if (3.0f * p.z < m) q = p.zxy();
+		else return m * 0.57735027f;
+
+		const T k = clamp(0.5f * (q.z - q.y + s), 0.0f, s);
+		return length(Vector3<T>(q.x, q.y - s + k, q.z - k));
+	}
+
+	inline float4 unionSDF(const float4& sdfDisOne, const float4& sdfDisTwo)
+	{
+		return (sdfDisOne.x < sdfDisTwo.x) ? sdfDisOne : sdfDisTwo;
+	}
+
+	template<typename T> Vector4<T> smoothUnionSDF(const Vector4<T>& sdfDisOne, const Vector4<T>& sdfDisTwo, float k)
+	{
+		const T h = clamp(0.5f + 0.5f * (sdfDisTwo.x - sdfDisOne.x) / k, 0.0f, 1.0f);
+		const T blend = T(k) * h * (T(1.0f) - h);
+		return Vector4<T>(sdfDisTwo.x + (sdfDisOne.x - sdfDisTwo.x) * h - blend,
+			sdfDisTwo.y + (sdfDisOne.y - sdfDisTwo.y) * h,
+			sdfDisTwo.z + (sdfDisOne.z - sdfDisTwo.z) * h,
+			sdfDisTwo.w + (sdfDisOne.w - sdfDisTwo.w) * h);
+	}
+
+	template<typename T> Vector4<T> intersectionSDF(const Vector4<T>& sdfDisOne, const Vector4<T>& sdfDisTwo)
+	{
+		return (sdfDisOne.x > sdfDisTwo.x) ? sdfDisOne : sdfDisTwo;
+	}
+
+	template<typename T> Vector3<T> twistSDF(Vector3<T> p, float rep)
+	{
+		const T c = cos(rep * p.y + rep);
+		const T s = sin(rep * p.y + rep);
+		// mul(p.xz, float2x2(c, -s, s, c))
+		return Vector3<T>(p.x * c + p.z * s, -p.x * s + p.z * c, p.y);
+	}
+
+	// Cell p falls in, axes with a spacing of 0 aren't repeated and a negative limit repeats forever
+	inline float3 repeatCell(const float3& p, const float3& spacing, const float3& limit)
+	{
+		float3 cell;
+		for (auto i = 0; i < 3; i++)
+		{
+			cell[i] = spacing[i] > 0.0f ? std::floor(p[i] / spacing[i] + 0.5f) : 0.0f;
+			if (limit[i] >= 0.0f) cell[i] = clamp(cell[i], -limit[i], limit[i]);
+		}
+		return cell;
+	}
+
+	// p relative to the cell's centre, mirrored flips odd cells so neighbours meet face to face
+	inline float3 repeatLocal(const float3& p, const float3& cell, const float3& spacing, bool mirrored)
+	{
+		auto local = p - cell * spacing;
+		if (mirrored)
+		{
+			for (auto i = 0; i < 3; i++)
+			{
+				if (std::fmod(std::abs(cell[i]), 2.0f) == 1.0f) local[i] = -local[i];
+			}
+		}
+		return local;
+	}
+
+	static const float3 va = float3(0.0f, 0.57735f, 0.0f);
+	static const float3 vb = float3(0.0f, -1.0f, 1.15470f);
+	static const float3 vc = float3(1.0f, -1.0f, -0.57735f);
+	static const float3 vd = float3(-1.0f, -1.0f, -0.57735f);
+	// |v|^2 of each vertex, dot(p - v, p - v) = dot(p, p) - 2 dot(p, v) + |v|^2 and dot(p, p) is shared
+	static const float4 vLengthSquared = float4(dot(va, va), dot(vb, vb), dot(vc, vc), dot(vd, vd));
+
+	// Fewest folds the LOD drops to, n folds leave spheres of radius 2 / 2^n the bounds must cover
+	static const float SierpinskiMinIterations = 4.0f;
+
+	// Folds for a pixel footprint in the fractal's units, stopping once tetrahedra are half a pixel across
+	inline float SierpinskiIterations(float footprint)
+	{
+		if (footprint <= 0.0f) return 8.0f;
+		return clamp(std::log2(2.0f / footprint) + 1.0f, SierpinskiMinIterations, 8.0f);
+	}
+
+	template<typename T> Vector4<T> sierpinskiDistanceAndColour(const T& dm, float r, const Vector3<T>& p)
+	{
+		const float3 colour = saturate(float3(ValueOf(p.x), ValueOf(p.y), ValueOf(p.z)));
+		return Vector4<T>((sqrt(dm) - 1.0f) / r, T(colour.x), T(colour.y), T(colour.z));
+	}
+
+	// iterations in [1, 8], a fraction blends the two nearest whole counts so the LOD doesn't pop
+	template<typename T> Vector4<T> SierpinskiTetrahedron(Vector3<T> p, float iterations)
+	{
+		const int whole = static_cast<int>(iterations);
+		const float blend = iterations - whole;
+		const int count = blend > 0.0f ? whole + 1 : whole;
+
+		float r = 1.0f;
+		T dm = T(0.0f);
+		Vector4<T> coarse;
+		for (int i = 0; i < count; i++)
+		{
+			if (i == whole) coarse = sierpinskiDistanceAndColour(dm, r, p);
+
+			const T k = dot(p, p);
+			T d;
+			d = vLengthSquared.x - 2.0f * dot(p, Vector3<T>(va));              float3 v = va; dm = d;
+			d = vLengthSquared.y - 2.0f * dot(p, Vector3<T>(vb)); if (d < dm) { v = vb; dm = d; }
+			d = vLengthSquared.z - 2.0f * dot(p, Vector3<T>(vc)); if (d < dm) { v = vc; dm = d; }
+			d = vLengthSquared.w - 2.0f * dot(p, Vector3<T>(vd)); if (d < dm) { v = vd; dm = d; }
+			dm = dm + k;
+			p = T(2.0f) * p - Vector3<T>(v); r *= 2.0f;
+		}
+
+		const Vector4<T> fine = sierpinskiDistanceAndColour(dm, r, p);
+		if (count == whole) return fine;
+		return coarse + (fine - coarse) * T(blend);
+	}
+
+	template<typename T> Vector4<T> SierpinskiTetrahedron(Vector3<T> p)
+	{
+		return SierpinskiTetrahedron(p, 8.0f);
+	}
+}
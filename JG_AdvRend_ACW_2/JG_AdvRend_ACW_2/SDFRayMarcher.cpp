@@ -0,0 +1,349 @@
+#include "SDFRayMarcher.h"
+#include <algorithm>
+#include <chrono>
+#include "SDFConePrepass.h"
+#include "SDFStepHeatmap.h"
+#include "SDFTilePruning.h"
+
+using namespace SDF;
+
+SDFCamera SDFCamera::LookAt(const float3& position, const float3& target)
+{
+	SDFCamera camera;
+	camera.position = position;
+	camera.forward = normalize(target - position);
+	camera.right = normalize(cross(camera.forward, float3(0.0f, 1.0f, 0.0f)));
+	camera.up = cross(camera.right, camera.forward);
+	camera.imagePlaneDistance = 1.0f;
+	return camera;
+}
+
+SDFCamera SDFCamera::FromRotation(const float3& position, const float3& rotation)
+{
+	const auto yaw = rotation.x * 0.01745329f;
+	const auto pitch = rotation.y * 0.01745329f;
+
+	// (0, 0, 1) through XMMatrixRotationRollPitchYaw, the LH view with the RH projection looks down -lookAt
+	const auto lookAt = float3(std::sin(yaw) * std::cos(pitch), -std::sin(pitch), std::cos(yaw) * std::cos(pitch));
+	return LookAt(position, position - lookAt);
+}
+
+float2 SDFCamera::PixelToCanvas(float pixelX, float pixelY, int width, int height) const
+{
+	// canvasXY spans [-1, 1] horizontally and is scaled by the inverse aspect ratio vertically
+	return float2(2.0f * pixelX / width - 1.0f, (1.0f - 2.0f * pixelY / height) * static_cast<float>(height) / width);
+}
+
+SDFRay SDFCamera::GenerateRay(float pixelX, float pixelY, int width, int height) const
+{
+	const auto canvas = PixelToCanvas(pixelX, pixelY, width, height);
+
+	SDFRay ray;
+	ray.o = position;
+	ray.d = normalize(right * canvas.x + up * canvas.y + forward * imagePlaneDistance);
+	return ray;
+}
+
+bool SDFCamera::WorldToPixel(const float3& p, int width, int height, float2& pixel) const
+{
+	const auto v = p - position;
+	const auto z = dot(v, forward);
+	if (z <= 0.0f) return false;
+
+	const auto canvas = float2(dot(v, right), dot(v, up)) * (imagePlaneDistance / z);
+	pixel = float2((canvas.x + 1.0f) * 0.5f * width, (1.0f - canvas.y * width / height) * 0.5f * height);
+	return true;
+}
+
+SDFRayMarcher::SDFRayMarcher(const SDFScene& scene, const SDFMarchSettings& settings)
+	: _scene(scene), _settings(settings)
+{
+}
+
+SDFMarchResult SDFRayMarcher::March(const SDFRay& ray, float start, float end) const
+{
+	SDFMarchResult result = { end, float3(), false, 0, 0, SDFMarchOutcome::Escaped, false };
+	auto depth = start;
+	auto omega = _settings.overRelaxation;
+	auto previousRadius = 0.0f;
+	auto stepLength = 0.0f;
+	auto distance = 0.0f;
+
+	for (auto i = 0; i < _settings.maxMarchingSteps; i++)
+	{
+		const auto distanceAndColour = _scene.Evaluate(ray.o + depth * ray.d, _settings.fractalPixelAngle * depth);
+		result.steps++;
+		result.primitiveEvaluations += _scene.GetPrimitiveCount();
+		distance = distanceAndColour.x;
+
+		const auto radius = std::abs(distance);
+		// Gap between the spheres around this sample and the last one, a surface could sit in it
+		const auto relaxationFailed = omega > 1.0f && radius + previousRadius < stepLength;
+
+		if (relaxationFailed)
+		{
+			//Step back inside the last sphere and stop relaxing
+			stepLength -= omega * stepLength;
+			omega = 1.0f;
+			result.relaxationFellBack = true;
+		}
+		else
+		{
+			if (distance < HitEpsilon(depth))
+			{
+				//Hit the surface
+				result.depth = depth;
+				result.colour = distanceAndColour.yzw();
+				result.hit = true;
+				result.outcome = SDFMarchOutcome::Hit;
+				return result;
+			}
+
+			stepLength = distance * omega;
+		}
+
+		previousRadius = radius;
+
+		//Move along the ray
+		depth += stepLength;
+
+		if (depth >= end)
+		{
+			//Give up, nothing hit along max travel distance
+			return result;
+		}
+	}
+
+	result.outcome = StepLimitOutcome(depth, distance);
+	return result;
+}
+
+SDFMarchOutcome SDFRayMarcher::StepLimitOutcome(float depth, float distance) const
+{
+	// A ray still this close to a surface when the steps ran out was creeping along it
+	const auto grazingDistanceScale = 0.01f;
+
+	return distance < grazingDistanceScale * depth ? SDFMarchOutcome::Grazed : SDFMarchOutcome::OutOfSteps;
+}
+
+void SDFRayMarcher::BuildBoundIntervals(const SDFRay& ray, float start, float end, std::vector<SDFBoundInterval>& intervals, float margin) const
+{
+	intervals.clear();
+
+	const auto& primitives = _scene.GetPrimitives();
+	for (auto i = 0; i < static_cast<int>(primitives.size()); i++)
+	{
+		const auto oc = ray.o - primitives[i].boundCentre;
+		const auto b = dot(oc, ray.d);
+		const auto radius = primitives[i].boundRadius + margin;
+		const auto c = dot(oc, oc) - radius * radius;
+		const auto discriminant = b * b - c;
+
+		// The ray misses the bound, the primitive can never be hit
+		if (discriminant < 0.0f) continue;
+
+		const auto s = std::sqrt(discriminant);
+		const auto tNear = -b - s;
+		const auto tFar = -b + s;
+
+		if (tFar < start || tNear > end) continue;
+
+		intervals.push_back({ i, tNear, tFar });
+	}
+}
+
+SDFMarchResult SDFRayMarcher::MarchCulled(const SDFRay& ray, float start, float end, std::vector<SDFBoundInterval>& intervals) const
+{
+	SDFMarchResult result = { end, float3(), false, 0, 0, SDFMarchOutcome::Escaped, false };
+
+	BuildBoundIntervals(ray, start, end, intervals);
+
+	const auto& primitives = _scene.GetPrimitives();
+	auto depth = start;
+	auto closestHit = float4(1e10f, 0.0f, 0.0f, 0.0f);
+
+	for (auto i = 0; i < _settings.maxMarchingSteps; i++)
+	{
+		if (intervals.empty())
+		{
+			//Every bound is behind us or missed
+			return result;
+		}
+
+		const auto samplePoint = ray.o + depth * ray.d;
+		closestHit = float4(1e10f, 0.0f, 0.0f, 0.0f);
+		// Distance along the ray to the next bound we are not inside yet, stepping further could skip its surface
+		auto boundStep = 1e10f;
+
+		for (auto j = 0; j < static_cast<int>(intervals.size());)
+		{
+			const auto& interval = intervals[j];
+
+			if (depth > interval.tFar)
+			{
+				// The ray has left this bound for good
+				intervals[j] = intervals.back();
+				intervals.pop_back();
+				continue;
+			}
+
+			if (depth + _settings.epsilon < interval.tNear)
+			{
+				boundStep = min(boundStep, interval.tNear - depth);
+			}
+			else
+			{
+				closestHit = unionSDF(closestHit, SDFScene::EvaluatePrimitive(primitives[interval.primitive], samplePoint, _settings.fractalPixelAngle * depth));
+				result.primitiveEvaluations++;
+			}
+
+			j++;
+		}
+
+		result.steps++;
+
+		if (closestHit.x < HitEpsilon(depth))
+		{
+			//Hit the surface
+			result.depth = depth;
+			result.colour = closestHit.yzw();
+			result.hit = true;
+			result.outcome = SDFMarchOutcome::Hit;
+			return result;
+		}
+
+		//Move along the ray
+		depth += min(closestHit.x, boundStep);
+
+		if (depth >= end)
+		{
+			//Give up, nothing hit along max travel distance
+			return result;
+		}
+	}
+
+	result.outcome = StepLimitOutcome(depth, closestHit.x);
+	return result;
+}
+
+SDFMarchResult SDFRayMarcher::MarchPruned(const SDFRay& ray, float start, float end, const SDFTileGrid& grid, int pixelX, int pixelY) const
+{
+	SDFMarchResult result = { end, float3(), false, 0, 0, SDFMarchOutcome::Escaped, false };
+
+	const auto& primitives = _scene.GetPrimitives();
+	auto depth = start;
+	auto slab = 0;
+	auto count = 0;
+	const int* list = grid.GetPrimitiveList(pixelX, pixelY, slab, count);
+	auto closestHit = float4(1e10f, 0.0f, 0.0f, 0.0f);
+
+	for (auto i = 0; i < _settings.maxMarchingSteps; i++)
+	{
+		// Depth only grows, so the slab index does too
+		if (depth >= grid.GetSlabEnd(slab))
+		{
+			while (slab + 1 < grid.GetSlabCount() && depth >= grid.GetSlabEnd(slab)) slab++;
+			list = grid.GetPrimitiveList(pixelX, pixelY, slab, count);
+		}
+
+		const auto samplePoint = ray.o + depth * ray.d;
+		closestHit = float4(1e10f, 0.0f, 0.0f, 0.0f);
+
+		for (auto j = 0; j < count; j++)
+		{
+			closestHit = unionSDF(closestHit, SDFScene::EvaluatePrimitive(primitives[list[j]], samplePoint, _settings.fractalPixelAngle * depth));
+		}
+
+		result.steps++;
+		result.primitiveEvaluations += count;
+
+		if (closestHit.x < HitEpsilon(depth))
+		{
+			//Hit the surface
+			result.depth = depth;
+			result.colour = closestHit.yzw();
+			result.hit = true;
+			result.outcome = SDFMarchOutcome::Hit;
+			return result;
+		}
+
+		//Move along the ray
+		depth += closestHit.x;
+
+		if (depth >= end)
+		{
+			//Give up, nothing hit along max travel distance
+			return result;
+		}
+	}
+
+	result.outcome = StepLimitOutcome(depth, closestHit.x);
+	return result;
+}
+
+SDFImageStats SDFRayMarcher::RenderImage(const SDFCamera& camera, int width, int height, std::vector<float4>* image, const SDFConePrepass* prepass, SDFStepHeatmap* heatmap) const
+{
+	SDFImageStats stats = { width, height, 0, 0, 0, 0, 0.0 };
+	std::vector<SDFBoundInterval> intervals;
+	intervals.reserve(_scene.GetPrimitiveCount());
+
+	if (image) image->assign(width * height, float4());
+	if (heatmap) heatmap->Reset(width, height, _settings.maxMarchingSteps);
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	for (auto y = 0; y < height; y++)
+	{
+		for (auto x = 0; x < width; x++)
+		{
+			const auto ray = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+			const auto start = prepass ? prepass->GetStartDepth(x, y) : _settings.epsilon;
+			const auto result = start >= _settings.maxDistance
+				? SDFMarchResult{ _settings.maxDistance, float3(), false, 0, 0, SDFMarchOutcome::Escaped, false }
+				: _settings.boundingCulling
+				? MarchCulled(ray, start, _settings.maxDistance, intervals)
+				: March(ray, start, _settings.maxDistance);
+
+			stats.steps += result.steps;
+			stats.maxPixelSteps = std::max(stats.maxPixelSteps, result.steps);
+			stats.primitiveEvaluations += result.primitiveEvaluations;
+			if (result.hit) stats.hitPixels++;
+
+			if (image) (*image)[y * width + x] = float4(result.colour, result.hit ? result.depth : _settings.maxDistance);
+			if (heatmap) heatmap->Record(x, y, result);
+		}
+	}
+
+	stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	return stats;
+}
+
+SDFImageStats SDFRayMarcher::RenderImagePruned(const SDFTileGrid& grid, std::vector<float4>* image) const
+{
+	const auto width = grid.GetWidth();
+	const auto height = grid.GetHeight();
+	SDFImageStats stats = { width, height, 0, 0, 0, 0, 0.0 };
+
+	if (image) image->assign(width * height, float4());
+
+	const auto startTime = std::chrono::steady_clock::now();
+
+	for (auto y = 0; y < height; y++)
+	{
+		for (auto x = 0; x < width; x++)
+		{
+			const auto ray = grid.GetCamera().GenerateRay(x + 0.5f, y + 0.5f, width, height);
+			const auto result = MarchPruned(ray, _settings.epsilon, _settings.maxDistance, grid, x, y);
+
+			stats.steps += result.steps;
+			stats.maxPixelSteps = std::max(stats.maxPixelSteps, result.steps);
+			stats.primitiveEvaluations += result.primitiveEvaluations;
+			if (result.hit) stats.hitPixels++;
+
+			if (image) (*image)[y * width + x] = float4(result.colour, result.hit ? result.depth : _settings.maxDistance);
+		}
+	}
+
+	stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	return stats;
+}
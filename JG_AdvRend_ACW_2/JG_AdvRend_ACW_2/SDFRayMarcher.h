@@ -0,0 +1,119 @@
+#pragma once
+#include <algorithm>
+#include <vector>
+#include "SDFScene.h"
+
+class SDFTileGrid;
+class SDFConePrepass;
+class SDFStepHeatmap;
+
+struct SDFRay
+{
+	float3 o; //origin
+	float3 d; //direction
+};
+
+// Mirrors the canvas set up by VS_RayMarchObjects and the eye ray built in PS_RayMarchObjects
+struct SDFCamera
+{
+	float3 position;
+	float3 forward;
+	float3 right;
+	float3 up;
+	float imagePlaneDistance;	// MIN_DIST in the shader
+
+	static SDFCamera LookAt(const float3& position, const float3& target);
+	// Same view as Camera::Render for the position and rotation (yaw, pitch and roll in degrees), roll is ignored
+	static SDFCamera FromRotation(const float3& position, const float3& rotation);
+	float2 PixelToCanvas(float pixelX, float pixelY, int width, int height) const;
+	SDFRay GenerateRay(float pixelX, float pixelY, int width, int height) const;
+	// Inverse of GenerateRay, false for points behind the camera
+	bool WorldToPixel(const float3& p, int width, int height, float2& pixel) const;
+	// Angle one pixel subtends at the centre of the image, the cone radius per unit of depth
+	float PixelAngle(int width) const { return 2.0f / (width * imagePlaneDistance); }
+};
+
+struct SDFMarchSettings
+{
+	int maxMarchingSteps = 255;
+	float epsilon = 0.0001f;
+	float maxDistance = 50.0f;
+	bool boundingCulling = false;
+	float overRelaxation = 1.0f;	// step scale for March in [1, 2), 1 is plain sphere tracing
+	float relativeEpsilon = 0.0f;	// a hit is a distance below max(epsilon, relativeEpsilon * depth)
+	float fractalPixelAngle = 0.0f;	// SDFCamera::PixelAngle, sets the fractal's iterations from the pixel footprint at each depth, 0 runs all 8
+};
+
+// Why a march stopped
+enum class SDFMarchOutcome
+{
+	Hit,
+	Escaped,			// passed the max distance
+	OutOfSteps,			// used every step far from any surface
+	Grazed,				// used every step creeping along a surface it never got within epsilon of
+	Count
+};
+
+struct SDFMarchResult
+{
+	float depth;
+	float3 colour;
+	bool hit;
+	int steps;
+	int primitiveEvaluations;
+	SDFMarchOutcome outcome;
+	bool relaxationFellBack;	// an over-relaxed step overshot and March went back to plain steps
+};
+
+// Ray interval of a primitive's bounding sphere, used to skip primitives a ray cannot reach
+struct SDFBoundInterval
+{
+	int primitive;
+	float tNear;
+	float tFar;
+};
+
+struct SDFImageStats
+{
+	int width;
+	int height;
+	long long steps;
+	int maxPixelSteps;
+	long long primitiveEvaluations;
+	int hitPixels;
+	double milliseconds;
+};
+
+class SDFRayMarcher
+{
+public: // Structors
+	SDFRayMarcher(const SDFScene& scene, const SDFMarchSettings& settings);
+
+public: // Accessors
+	const SDFMarchSettings& GetSettings() const { return _settings; }
+
+public: // Functions
+	// Same as rayMarching() in the shader, over-relaxed steps fall back to plain ones when they overshoot
+	SDFMarchResult March(const SDFRay& ray, float start, float end) const;
+	// Drops primitives whose bound the ray misses and only evaluates the ones whose bound covers the current depth
+	SDFMarchResult MarchCulled(const SDFRay& ray, float start, float end, std::vector<SDFBoundInterval>& intervals) const;
+	// Only evaluates the primitives the tile grid kept for the pixel's tile and the slab holding the current depth
+	SDFMarchResult MarchPruned(const SDFRay& ray, float start, float end, const SDFTileGrid& grid, int pixelX, int pixelY) const;
+
+	// margin grows every bound, shadow rays use it to keep primitives that can darken a penumbra
+	void BuildBoundIntervals(const SDFRay& ray, float start, float end, std::vector<SDFBoundInterval>& intervals, float margin = 0.0f) const;
+
+	// One ray per pixel into image (rgb and depth) when not null, starting at the prepass's tile depth when given
+	SDFImageStats RenderImage(const SDFCamera& camera, int width, int height, std::vector<float4>* image, const SDFConePrepass* prepass = nullptr, SDFStepHeatmap* heatmap = nullptr) const;
+	// Same using MarchPruned with the grid's camera and resolution
+	SDFImageStats RenderImagePruned(const SDFTileGrid& grid, std::vector<float4>* image) const;
+
+private: // Functions
+	float HitEpsilon(float depth) const { return std::max(_settings.epsilon, _settings.relativeEpsilon * depth); }
+	// Out of steps, tells grazing rays apart from ones that were still far from everything
+	SDFMarchOutcome StepLimitOutcome(float depth, float distance) const;
+
+private: // Data
+	const SDFScene& _scene;
+	SDFMarchSettings _settings;
+};
@@ -0,0 +1,171 @@
+#include "SDFRepetition.h"
+#include <algorithm>
+#include <cmath>
+#include "Common/Noise.h"
+
+using namespace SDF;
+
+SDFRepeatedField::SDFRepeatedField(const SDFScene& palette, const float3& origin, const SDFRepetitionSettings& settings)
+	: _palette(palette), _settings(settings), _origin(origin), _instanceRadius(0.0f)
+{
+	for (const auto& primitive : _palette.GetPrimitives())
+	{
+		_instanceRadius = std::max(_instanceRadius, length(primitive.boundCentre) + primitive.boundRadius);
+	}
+	_instanceRadius = _instanceRadius * settings.maxScale + settings.jitter;
+}
+
+SDFScene SDFRepeatedField::CreateRockPalette()
+{
+	SDFScene palette;
+	palette.AddPrimitive(SDFPrimitiveType::RoundBox, float3(), float4(0.1f, 0.08f, 0.12f, 0.04f), float4(), float3(0.45f, 0.38f, 0.33f));
+	palette.AddPrimitive(SDFPrimitiveType::Octahedron, float3(), float4(0.18f, 0.0f, 0.0f, 0.0f), float4(), float3(0.52f, 0.5f, 0.47f));
+	palette.AddPrimitive(SDFPrimitiveType::Box, float3(), float4(0.1f, 0.12f, 0.09f, 0.0f), float4(), float3(0.36f, 0.31f, 0.3f));
+	palette.AddPrimitive(SDFPrimitiveType::Torus, float3(), float4(0.12f, 0.05f, 0.0f, 0.0f), float4(), float3(0.6f, 0.55f, 0.42f));
+	return palette;
+}
+
+SDFRepetitionSettings SDFRepeatedField::GetAsteroidBeltSettings()
+{
+	SDFRepetitionSettings settings;
+	settings.spacing = float3(0.8f, 0.0f, 0.8f);
+	settings.limit = float3(-1.0f, 0.0f, -1.0f);
+	settings.minScale = 0.5f;
+	settings.maxScale = 1.0f;
+	settings.jitter = 0.12f;
+	settings.emptyFraction = 0.3f;
+	return settings;
+}
+
+long long SDFRepeatedField::GetCellCount() const
+{
+	auto count = 1ll;
+	for (auto axis = 0; axis < 3; axis++)
+	{
+		if (_settings.spacing[axis] <= 0.0f) continue;
+		if (_settings.limit[axis] < 0.0f) return -1;
+		count *= 2 * static_cast<long long>(_settings.limit[axis]) + 1;
+	}
+	return count;
+}
+
+bool SDFRepeatedField::CellExists(float cell, int axis) const
+{
+	return _settings.limit[axis] < 0.0f || std::abs(cell) <= _settings.limit[axis];
+}
+
+SDFRepeatedField::Instance SDFRepeatedField::CellInstance(const float3& cell) const
+{
+	// Same cell numbering as noise(), fractional offsets give independent values per cell
+	const auto n = cell.x + cell.y * 57.0f + 113.0f * cell.z + _settings.seed;
+	const auto& primitives = _palette.GetPrimitives();
+
+	Instance instance;
+	instance.primitive = nullptr;
+	if (hash(n) < _settings.emptyFraction || primitives.empty()) return instance;
+
+	const auto type = std::min(static_cast<int>(hash(n + 0.1f) * primitives.size()), static_cast<int>(primitives.size()) - 1);
+	instance.primitive = &primitives[type];
+	instance.scale = lerp(_settings.minScale, _settings.maxScale, hash(n + 0.2f));
+
+	// Per axis within jitter / sqrt(3), so the offset's length stays under jitter
+	const auto jitter = _settings.jitter * 0.57735f;
+	instance.offset = float3(2.0f * hash(n + 0.3f) - 1.0f, 2.0f * hash(n + 0.4f) - 1.0f, 2.0f * hash(n + 0.5f) - 1.0f) * jitter;
+	instance.colour = (instance.primitive->colour + float3(hash(n + 0.6f), hash(n + 0.7f), hash(n + 0.8f))) * 0.5f;
+	return instance;
+}
+
+float4 SDFRepeatedField::EvaluateCell(const float3& samplePoint, const float3& cell) const
+{
+	const auto instance = CellInstance(cell);
+	if (!instance.primitive) return float4(1e10f, 0.0f, 0.0f, 0.0f);
+
+	// Scaling the domain by s and the distance by s keeps the distance exact
+	const auto local = repeatLocal(samplePoint, cell, _settings.spacing, _settings.mirrored) - instance.offset;
+	const auto distance = instance.scale * SDFScene::EvaluatePrimitive(*instance.primitive, local / instance.scale).x;
+	return float4(distance, instance.colour);
+}
+
+float4 SDFRepeatedField::Evaluate(const float3& samplePoint, int* cellsEvaluated) const
+{
+	const auto p = samplePoint - _origin;
+	const auto cell = repeatCell(p, _settings.spacing, _settings.limit);
+	const auto local = p - cell * _settings.spacing;
+
+	auto closestHit = EvaluateCell(p, cell);
+	auto count = 1;
+
+	// Instances sit on the cell centres' plane or line along the axes that are not repeated
+	auto across = 0.0f;
+	int repeated[3];
+	auto repeatedCount = 0;
+	for (auto axis = 0; axis < 3; axis++)
+	{
+		if (_settings.spacing[axis] > 0.0f) repeated[repeatedCount++] = axis;
+		else across += p[axis] * p[axis];
+	}
+
+	// A neighbour is only evaluated when the sphere around its instance is nearer than what was found
+	auto neighbours = 1;
+	for (auto i = 0; i < repeatedCount; i++) neighbours *= 3;
+	for (auto n = 0; n < neighbours; n++)
+	{
+		auto neighbour = cell;
+		auto exists = true;
+		auto centered = true;
+		for (auto i = 0, code = n; i < repeatedCount; i++, code /= 3)
+		{
+			const auto axis = repeated[i];
+			const auto offset = static_cast<float>(code % 3 - 1);
+			neighbour[axis] += offset;
+			exists = exists && CellExists(neighbour[axis], axis);
+			centered = centered && offset == 0.0f;
+		}
+		if (centered || !exists) continue;
+
+		const auto toCentre = p - neighbour * _settings.spacing;
+		if (std::sqrt(dot(toCentre, toCentre)) - _instanceRadius >= closestHit.x) continue;
+
+		closestHit = unionSDF(closestHit, EvaluateCell(p, neighbour));
+		count++;
+	}
+
+	// Everything further away is at least two cells over on some axis
+	auto bound = 1e10f;
+	for (auto i = 0; i < repeatedCount; i++)
+	{
+		const auto axis = repeated[i];
+		const auto spacing = _settings.spacing[axis];
+		for (auto side = -1.0f; side <= 1.0f; side += 2.0f)
+		{
+			if (!CellExists(cell[axis] + 2.0f * side, axis)) continue;
+
+			const auto along = 2.0f * spacing - side * local[axis];
+			bound = std::min(bound, std::sqrt(along * along + across) - _instanceRadius);
+		}
+	}
+	closestHit.x = std::min(closestHit.x, bound);
+
+	if (cellsEvaluated) *cellsEvaluated += count;
+	return closestHit;
+}
+
+float4 SDFRepeatedField::EvaluateBruteForce(const float3& samplePoint) const
+{
+	const auto p = samplePoint - _origin;
+	float3 extent;
+	for (auto axis = 0; axis < 3; axis++) extent[axis] = _settings.spacing[axis] > 0.0f ? _settings.limit[axis] : 0.0f;
+
+	auto closestHit = float4(1e10f, 0.0f, 0.0f, 0.0f);
+	for (auto x = -extent.x; x <= extent.x; x += 1.0f)
+	{
+		for (auto y = -extent.y; y <= extent.y; y += 1.0f)
+		{
+			for (auto z = -extent.z; z <= extent.z; z += 1.0f)
+			{
+				closestHit = unionSDF(closestHit, EvaluateCell(p, float3(x, y, z)));
+			}
+		}
+	}
+	return closestHit;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include "SDFRayMarcher.h"
+
+struct SDFRepetitionSettings
+{
+	float3 spacing = float3(1.0f, 0.0f, 1.0f);	// cell size per axis, 0 leaves the axis unrepeated
+	float3 limit = float3(-1.0f, 0.0f, -1.0f);	// cells either side of the centre cell, negative repeats forever
+	bool mirrored = false;
+	float minScale = 0.5f;						// instance sizes are hashed between these
+	float maxScale = 1.0f;
+	float jitter = 0.0f;						// largest offset of an instance from its cell's centre
+	float emptyFraction = 0.0f;					// cells left without an instance
+	float seed = 0.0f;							// added to the cell's hash input
+};
+
+// One instance per cell of a domain repetition, hashed from the cell, Evaluate never overestimates
+class SDFRepeatedField
+{
+public: // Structors
+	// Instances are drawn from the palette's primitives placed around the origin
+	SDFRepeatedField(const SDFScene& palette, const float3& origin, const SDFRepetitionSettings& settings);
+
+	// The rocks and layout of the belt PS_RayMarchObjects.hlsl draws when REPEATED_FIELD is enabled
+	static SDFScene CreateRockPalette();
+	static SDFRepetitionSettings GetAsteroidBeltSettings();
+	static float3 GetAsteroidBeltOrigin() { return float3(0.0f, -0.3f, 0.0f); }
+
+public: // Accessors
+	const SDFRepetitionSettings& GetSettings() const { return _settings; }
+	float GetInstanceRadius() const { return _instanceRadius; }
+	// Cells within the limits, -1 when any repeated axis is infinite
+	long long GetCellCount() const;
+
+public: // Functions
+	// Distance (x) and colour (yzw), cellsEvaluated counts the instances looked at
+	float4 Evaluate(const float3& samplePoint, int* cellsEvaluated = nullptr) const;
+	// Every instance within the limits, the per object cost the repetition avoids
+	float4 EvaluateBruteForce(const float3& samplePoint) const;
+
+private: // Types
+	struct Instance
+	{
+		const SDFPrimitive* primitive;	// nullptr for an empty cell
+		float scale;
+		float3 offset;
+		float3 colour;
+	};
+
+private: // Functions
+	Instance CellInstance(const float3& cell) const;
+	float4 EvaluateCell(const float3& samplePoint, const float3& cell) const;
+	bool CellExists(float cell, int axis) const;
+
+private: // Data
+	SDFScene _palette;
+	SDFRepetitionSettings _settings;
+	float3 _origin;
+	float _instanceRadius;	// bound on the distance from a cell's centre to its instance's surface
+};
@@ -0,0 +1,176 @@
+#include "SDFReprojectionCache.h"
+#include <algorithm>
+#include <cmath>
+#include "SDFNormals.h"
+
+SDFReprojectionCache::SDFReprojectionCache(const SDFReprojectionSettings& settings)
+	: _settings(settings), _stats(), _camera(), _width(0), _height(0), _frame(0)
+{
+}
+
+void SDFReprojectionCache::Reproject(const SDFCamera& camera, int width, int height)
+{
+	const auto pixels = width * height;
+	_stats = { pixels, 0, 0, 0, 0, 0, 0 };
+
+	_previousSamples.swap(_samples);
+	_samples.assign(pixels, { float3(), float3(), float3(), _settings.maxDistance, false });
+	_retrace.assign(pixels, 1);
+
+	if (_frame == 0 || _width != width || _height != height)
+	{
+		_frame = 0;
+		_stats.retraced = pixels;
+		return;
+	}
+
+	// Scatter every hit into the pixel its world position lands on, nearest first
+	auto depths = std::vector<float>(pixels, 1e10f);
+	for (const auto& sample : _previousSamples)
+	{
+		float2 pixel;
+		if (!sample.hit || !camera.WorldToPixel(sample.position, width, height, pixel)) continue;
+
+		const auto x = static_cast<int>(std::floor(pixel.x));
+		const auto y = static_cast<int>(std::floor(pixel.y));
+		if (x < 0 || y < 0 || x >= width || y >= height) continue;
+
+		const auto depth = length(sample.position - camera.position);
+		const auto i = y * width + x;
+		if (depth < depths[i])
+		{
+			depths[i] = depth;
+			_samples[i] = sample;
+			_samples[i].depth = depth;
+			_retrace[i] = 0;
+		}
+	}
+
+	// The background has a known depth, so gather it instead: the escape point
+	// of the pixel's ray must have been background in the last frame too
+	for (auto y = 0; y < height; y++)
+	{
+		for (auto x = 0; x < width; x++)
+		{
+			const auto i = y * width + x;
+			if (!_retrace[i]) continue;
+
+			const auto ray = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+			const auto escapePoint = ray.o + _settings.maxDistance * ray.d;
+			float2 pixel;
+			if (!_camera.WorldToPixel(escapePoint, width, height, pixel)) continue;
+
+			const auto px = static_cast<int>(std::floor(pixel.x));
+			const auto py = static_cast<int>(std::floor(pixel.y));
+			if (px < 0 || py < 0 || px >= width || py >= height) continue;
+
+			if (!_previousSamples[py * width + px].hit)
+			{
+				_samples[i] = { escapePoint, float3(), float3(), _settings.maxDistance, false };
+				_retrace[i] = 0;
+			}
+		}
+	}
+
+	Validate(camera, width, height);
+
+	for (auto i = 0; i < pixels; i++)
+	{
+		if (_retrace[i]) _stats.retraced++;
+	}
+}
+
+void SDFReprojectionCache::Validate(const SDFCamera& camera, int width, int height)
+{
+	// Landed depths before any pixel is rejected, a hole is 0 so it counts as nearer than anything
+	auto depths = std::vector<float>(width * height);
+	auto hits = std::vector<unsigned char>(width * height);
+	for (auto i = 0; i < width * height; i++)
+	{
+		depths[i] = _retrace[i] ? 0.0f : _samples[i].depth;
+		hits[i] = !_retrace[i] && _samples[i].hit;
+	}
+
+	for (auto y = 0; y < height; y++)
+	{
+		for (auto x = 0; x < width; x++)
+		{
+			const auto i = y * width + x;
+			if (_retrace[i])
+			{
+				_stats.holes++;
+				continue;
+			}
+
+			if (_settings.refreshPeriod > 0 && (x + 3 * y + _frame) % _settings.refreshPeriod == 0)
+			{
+				_retrace[i] = 1;
+				_stats.refreshed++;
+				continue;
+			}
+
+			auto& sample = _samples[i];
+
+			// A nearer sample around a hit means it may have leaked through an occluder, background
+			// or a hole means it is on a silhouette. Any hit or hole around background may cover it.
+			auto occluded = false;
+			for (auto ny = std::max(0, y - 1); ny <= std::min(height - 1, y + 1) && !occluded; ny++)
+			{
+				for (auto nx = std::max(0, x - 1); nx <= std::min(width - 1, x + 1); nx++)
+				{
+					const auto j = ny * width + nx;
+					if (sample.hit ? (!hits[j] || depths[j] < sample.depth * (1.0f - _settings.occlusionTolerance)) : (hits[j] || depths[j] == 0.0f))
+					{
+						occluded = true;
+						break;
+					}
+				}
+			}
+
+			if (occluded)
+			{
+				_retrace[i] = 1;
+				_stats.rejectedOcclusion++;
+				continue;
+			}
+
+			if (!sample.hit) continue;
+
+			const auto ray = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+			const auto cosine = -dot(ray.d, sample.normal);
+			if (cosine < _settings.grazingCosine)
+			{
+				_retrace[i] = 1;
+				_stats.rejectedNormal++;
+				continue;
+			}
+
+			// Where this pixel's ray meets the sample's tangent plane
+			const auto depth = dot(sample.position - ray.o, sample.normal) / dot(ray.d, sample.normal);
+			if (std::abs(depth - sample.depth) > _settings.depthTolerance * sample.depth)
+			{
+				_retrace[i] = 1;
+				_stats.rejectedDepth++;
+				continue;
+			}
+
+			sample.depth = depth;
+		}
+	}
+}
+
+SDFCachedSample TraceSDFSample(const SDFRayMarcher& marcher, const SDFScene& scene, const SDFRay& ray, std::vector<SDFBoundInterval>& intervals)
+{
+	const auto& settings = marcher.GetSettings();
+	const auto result = settings.boundingCulling
+		? marcher.MarchCulled(ray, settings.epsilon, settings.maxDistance, intervals)
+		: marcher.March(ray, settings.epsilon, settings.maxDistance);
+
+	SDFCachedSample sample;
+	sample.hit = result.hit;
+	sample.depth = result.hit ? result.depth : settings.maxDistance;
+	sample.position = ray.o + sample.depth * ray.d;
+	sample.normal = result.hit ? DualNumberNormal(scene, sample.position) : float3();
+	sample.colour = result.colour;
+	return sample;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <vector>
+#include "SDFRayMarcher.h"
+
+// What a pass leaves behind for one pixel, the colour is the view independent part of the shading
+struct SDFCachedSample
+{
+	float3 position;	// world space hit
+	float3 normal;
+	float3 colour;
+	float depth;		// along the eye ray, the max distance for a miss
+	bool hit;
+};
+
+struct SDFReprojectionSettings
+{
+	float depthTolerance = 0.01f;		// relative, between the cached depth and the depth of the current ray on the cached tangent plane
+	float occlusionTolerance = 0.05f;	// relative, a neighbour this much nearer means the sample leaked through a gap in the occluder
+	float grazingCosine = 0.1f;			// samples seen this close to edge on are re-traced
+	int refreshPeriod = 0;				// every pixel is re-traced once in this many frames, 0 never
+	float maxDistance = 50.0f;
+};
+
+struct SDFReprojectionStats
+{
+	int pixels;
+	int retraced;
+	int holes;				// no previous sample landed on the pixel, disoccluded or magnified
+	int rejectedDepth;		// the sample is not on the current ray's surface
+	int rejectedNormal;		// the sample faces away from or is edge on to the camera
+	int rejectedOcclusion;	// a nearer sample next to it, or a hit or hole next to a background sample
+	int refreshed;
+};
+
+// CPU reference of a reprojection cache for passes whose scene does not move
+class SDFReprojectionCache
+{
+public: // Structors
+	explicit SDFReprojectionCache(const SDFReprojectionSettings& settings);
+
+public: // Accessors
+	const SDFReprojectionStats& GetStats() const { return _stats; }
+	const std::vector<SDFCachedSample>& GetSamples() const { return _samples; }
+	int GetFrame() const { return _frame; }
+
+public: // Functions
+	// Renders a frame, trace(SDFRay) returns an SDFCachedSample and is only called for re-traced pixels
+	template<typename Trace>
+	void Update(const SDFCamera& camera, int width, int height, const Trace& trace);
+
+	void Invalidate() { _frame = 0; }
+
+private: // Functions
+	// Fills _samples from the previous frame and marks the pixels to re-trace
+	void Reproject(const SDFCamera& camera, int width, int height);
+	void Validate(const SDFCamera& camera, int width, int height);
+
+private: // Data
+	SDFReprojectionSettings _settings;
+	SDFReprojectionStats _stats;
+	SDFCamera _camera;
+	int _width;
+	int _height;
+	int _frame;
+	std::vector<SDFCachedSample> _samples;
+	std::vector<SDFCachedSample> _previousSamples;
+	std::vector<unsigned char> _retrace;
+};
+
+template<typename Trace>
+void SDFReprojectionCache::Update(const SDFCamera& camera, int width, int height, const Trace& trace)
+{
+	Reproject(camera, width, height);
+
+	for (auto y = 0; y < height; y++)
+	{
+		for (auto x = 0; x < width; x++)
+		{
+			if (_retrace[y * width + x]) _samples[y * width + x] = trace(camera.GenerateRay(x + 0.5f, y + 0.5f, width, height));
+		}
+	}
+
+	_camera = camera;
+	_width = width;
+	_height = height;
+	_frame++;
+}
+
+// Traces a pixel of the ray marched scene for the cache
+SDFCachedSample TraceSDFSample(const SDFRayMarcher& marcher, const SDFScene& scene, const SDFRay& ray, std::vector<SDFBoundInterval>& intervals);
@@ -0,0 +1,372 @@
+#include "SDFScene.h"
+#include <random>
+#include "Common/Dual.h"
+
+using namespace SDF;
+
+SDFScene SDFScene::CreateDefaultScene()
+{
+	SDFScene scene;
+
+	//Ray Marched Implicit Geometric Primitives
+	scene.AddPrimitive(SDFPrimitiveType::RoundConeSegment, float3(0.3f, 0.5f, 0.3f), float4(0.02f, 0.0f, 0.0f, 0.03f), float4(-0.02f, 0.06f, 0.02f, 0.01f), float3(0.18f, 0.22f, 1.0f));
+	scene.AddPrimitive(SDFPrimitiveType::Cone, float3(0.0f, 0.53f, 0.0f), float4(0.16f, 0.12f, 0.06f, 0.0f), float4(), float3(0.55f, 0.23f, 0.38f));
+	scene.AddPrimitive(SDFPrimitiveType::CappedCone, float3(0.3f, 0.5f, 0.0f), float4(0.03f, 0.04f, 0.02f, 0.0f), float4(), float3(0.80f, 0.78f, 0.45f));
+	scene.AddPrimitive(SDFPrimitiveType::TwistedTorus, float3(0.0f, 0.5f, 0.3f), float4(0.04f, 0.01f, 60.0f, 0.6f), float4(), float3(0.28f, 0.51f, 0.08f));
+	scene.AddPrimitive(SDFPrimitiveType::Torus, float3(-0.3f, 0.5f, -0.3f), float4(0.04f, 0.01f, 0.0f, 0.0f), float4(), float3(0.41f, 0.27f, 0.54f));
+	scene.AddPrimitive(SDFPrimitiveType::Torus82, float3(0.0f, 0.5f, -0.3f), float4(0.04f, 0.01f, 0.0f, 0.0f), float4(), float3(0.52f, 0.75f, 0.42f));
+	scene.AddPrimitive(SDFPrimitiveType::Box, float3(-0.3f, 0.5f, 0.0f), float4(0.05f, 0.05f, 0.05f, 0.0f), float4(), float3(0.31f, 0.47f, 0.63f));
+	scene.AddPrimitive(SDFPrimitiveType::RoundBox, float3(-0.3f, 0.5f, 0.3f), float4(0.04f, 0.04f, 0.04f, 0.016f), float4(), float3(1.0f, 0.27f, 0.0f));
+	scene.AddPrimitive(SDFPrimitiveType::Ellipsoid, float3(0.3f, 0.5f, -0.3f), float4(0.05f, 0.05f, 0.02f, 0.0f), float4(), float3(0.8f, 0.41f, 0.79f));
+	scene.AddPrimitive(SDFPrimitiveType::TriPrism, float3(-0.6f, 0.5f, -0.3f), float4(0.05f, 0.02f, 0.0f, 0.0f), float4(), float3(0.92f, 0.68f, 0.92f));
+	scene.AddPrimitive(SDFPrimitiveType::CylinderSegment, float3(-0.6f, 0.5f, 0.0f), float4(0.002f, -0.002f, 0.0f, 0.016f), float4(-0.02f, 0.06f, 0.02f, 0.0f), float3(0.78f, 0.38f, 0.08f));
+	scene.AddPrimitive(SDFPrimitiveType::Cylinder, float3(-0.6f, 0.5f, 0.3f), float4(0.02f, 0.04f, 0.0f, 0.0f), float4(), float3(0.98f, 0.63f, 0.42f));
+	scene.AddPrimitive(SDFPrimitiveType::Cylinder6, float3(0.3f, 0.5f, 0.6f), float4(0.02f, 0.04f, 0.0f, 0.0f), float4(), float3(0.29f, 0.46f, 0.43f));
+	scene.AddPrimitive(SDFPrimitiveType::Octahedron, float3(0.0f, 0.5f, 0.6f), float4(0.07f, 0.0f, 0.0f, 0.0f), float4(), float3(0.46f, 0.61f, 0.52f));
+	scene.AddPrimitive(SDFPrimitiveType::HexPrism, float3(-0.3f, 0.5f, 0.6f), float4(0.05f, 0.01f, 0.0f, 0.0f), float4(), float3(0.59f, 1.0f, 1.0f));
+	scene.AddPrimitive(SDFPrimitiveType::RoundCone, float3(-0.6f, 0.5f, 0.6f), float4(0.04f, 0.02f, 0.06f, 0.0f), float4(), float3(1.0f, 0.2f, 0.0f));
+
+	//SierpinskiTetrahedron
+	scene.AddPrimitive(SDFPrimitiveType::SierpinskiTetrahedron, float3(-1.0f, 2.0f, -2.0f), float4(2.0f, 0.0f, 0.0f, 0.0f), float4(), float3());
+
+	return scene;
+}
+
+SDFScene SDFScene::CreateRandomScene(int count, unsigned int seed, float halfSize)
+{
+	const auto templateScene = CreateDefaultScene();
+	const auto& templates = templateScene.GetPrimitives();
+
+	std::mt19937 generator(seed);
+	std::uniform_real_distribution<float> horizontal(-halfSize, halfSize);
+	std::uniform_real_distribution<float> vertical(0.2f, 1.2f);
+	// The fractal is far larger than the other primitives, so only use the small ones
+	std::uniform_int_distribution<int> type(0, static_cast<int>(templates.size()) - 2);
+
+	SDFScene scene;
+	for (auto i = 0; i < count; i++)
+	{
+		const auto& t = templates[type(generator)];
+		scene.AddPrimitive(t.type, float3(horizontal(generator), vertical(generator), horizontal(generator)), t.paramsA, t.paramsB, t.colour);
+	}
+
+	return scene;
+}
+
+void SDFScene::AddPrimitive(SDFPrimitiveType type, const float3& position, const float4& paramsA, const float4& paramsB, const float3& colour)
+{
+	SDFPrimitive primitive;
+	primitive.type = type;
+	primitive.position = position;
+	primitive.paramsA = paramsA;
+	primitive.paramsB = paramsB;
+	primitive.colour = colour;
+	ComputeBoundingSphere(primitive);
+	ComputeBoundingBox(primitive);
+
+	_primitives.push_back(primitive);
+}
+
+float4 SDFScene::Evaluate(const float3& samplePoint, float footprint) const
+{
+	//Contains hit distance (x) and colour (yzw)
+	float4 closestHit = float4(1e10f, 0.0f, 0.0f, 0.0f);
+
+	for (const auto& primitive : _primitives)
+	{
+		closestHit = unionSDF(closestHit, EvaluatePrimitive(primitive, samplePoint, footprint));
+	}
+
+	return closestHit;
+}
+
+namespace
+{
+	// Shared by the float and dual number paths, colour is carried along as constants
+	template<typename T> Vector4<T> EvaluatePrimitiveT(const SDFPrimitive& primitive, const Vector3<T>& samplePoint, float footprint = 0.0f)
+	{
+		const auto p = samplePoint - Vector3<T>(primitive.position);
+		const auto& a = primitive.paramsA;
+		const auto& b = primitive.paramsB;
+		auto distance = T(0.0f);
+
+		switch (primitive.type)
+		{
+		case SDFPrimitiveType::RoundConeSegment: distance = roundConeSDF(p, a.xyz(), b.xyz(), a.w, b.w); break;
+		case SDFPrimitiveType::Cone: distance = coneSDF(p, a.xyz()); break;
+		case SDFPrimitiveType::CappedCone: distance = cappedConeSDF(p, a.x, a.y, a.z); break;
+		case SDFPrimitiveType::TwistedTorus: distance = a.w * torusSDF(twistSDF(p, a.z), float2(a.x, a.y)); break;
+		case SDFPrimitiveType::Torus: distance = torusSDF(p, float2(a.x, a.y)); break;
+		case SDFPrimitiveType::Torus82: distance = torus82SDF(p, float2(a.x, a.y)); break;
+		case SDFPrimitiveType::Box: distance = boxSDF(p, a.xyz()); break;
+		case SDFPrimitiveType::RoundBox: distance = roundBoxSDF(p, a.xyz(), a.w); break;
+		case SDFPrimitiveType::Ellipsoid: distance = ellipsoidSDF(p, a.xyz()); break;
+		case SDFPrimitiveType::TriPrism: distance = triPrismSDF(p, float2(a.x, a.y)); break;
+		case SDFPrimitiveType::CylinderSegment: distance = cylinderSDF(p, a.xyz(), b.xyz(), a.w); break;
+		case SDFPrimitiveType::Cylinder: distance = cylinderSDF(p, float2(a.x, a.y)); break;
+		case SDFPrimitiveType::Cylinder6: distance = cylinder6SDF(p, float2(a.x, a.y)); break;
+		case SDFPrimitiveType::Octahedron: distance = octahedronSDF(p, a.x); break;
+		case SDFPrimitiveType::HexPrism: distance = hexPrismSDF(p, float2(a.x, a.y)); break;
+		case SDFPrimitiveType::RoundCone: distance = roundConeSDF(p, a.x, a.y, a.z); break;
+		case SDFPrimitiveType::SierpinskiTetrahedron: return SierpinskiTetrahedron(T(a.x) * p, SierpinskiIterations(footprint * a.x));
+		default: break;
+		}
+
+		return Vector4<T>(distance, T(primitive.colour.x), T(primitive.colour.y), T(primitive.colour.z));
+	}
+}
+
+float4 SDFScene::EvaluateGradient(const float3& samplePoint) const
+{
+	// The union's gradient is the gradient of the primitive it picks, so only that one needs dual numbers
+	const SDFPrimitive* closestPrimitive = nullptr;
+	auto closestDistance = 1e10f;
+
+	for (const auto& primitive : _primitives)
+	{
+		const auto distance = EvaluatePrimitiveT(primitive, samplePoint).x;
+		if (distance < closestDistance)
+		{
+			closestDistance = distance;
+			closestPrimitive = &primitive;
+		}
+	}
+
+	if (!closestPrimitive) return float4(closestDistance, 0.0f, 0.0f, 0.0f);
+
+	const auto distance = EvaluatePrimitiveT(*closestPrimitive, MakeDualPoint(samplePoint)).x;
+	return float4(distance.v, distance.d);
+}
+
+float4 SDFScene::EvaluatePrimitive(const SDFPrimitive& primitive, const float3& samplePoint, float footprint)
+{
+	return EvaluatePrimitiveT(primitive, samplePoint, footprint);
+}
+
+void SDFScene::ComputeBoundingSphere(SDFPrimitive& primitive)
+{
+	const auto& a = primitive.paramsA;
+	const auto& b = primitive.paramsB;
+	auto centre = float3(0.0f, 0.0f, 0.0f);
+	auto radius = 0.0f;
+
+	switch (primitive.type)
+	{
+	case SDFPrimitiveType::RoundConeSegment:
+		centre = 0.5f * (a.xyz() + b.xyz());
+		radius = 0.5f * length(b.xyz() - a.xyz()) + max(a.w, b.w);
+		break;
+	case SDFPrimitiveType::Cone:
+	{
+		// Apex at the origin, base of height c.z where dot(q, c.xy) = 0
+		const auto baseRadius = a.z * a.y / a.x;
+		centre = float3(0.0f, -0.5f * a.z, 0.0f);
+		radius = length(float2(0.5f * a.z, baseRadius));
+		break;
+	}
+	case SDFPrimitiveType::CappedCone:
+		radius = length(float2(a.x, max(a.y, a.z)));
+		break;
+	case SDFPrimitiveType::TwistedTorus:
+		// The twist is a rotation so it keeps the distance to the origin
+	case SDFPrimitiveType::Torus:
+		radius = a.x + a.y;
+		break;
+	case SDFPrimitiveType::Torus82:
+		// length8 is bounded by the max norm
+		radius = length(float2(a.x + a.y, a.y));
+		break;
+	case SDFPrimitiveType::Box:
+		radius = length(a.xyz());
+		break;
+	case SDFPrimitiveType::RoundBox:
+		radius = length(a.xyz()) + a.w;
+		break;
+	case SDFPrimitiveType::Ellipsoid:
+		radius = max(a.x, max(a.y, a.z));
+		break;
+	case SDFPrimitiveType::TriPrism:
+		// h.x is the circumradius of the triangle
+		radius = length(float2(a.x, a.y));
+		break;
+	case SDFPrimitiveType::CylinderSegment:
+		centre = 0.5f * (a.xyz() + b.xyz());
+		radius = 0.5f * length(b.xyz() - a.xyz()) + a.w;
+		break;
+	case SDFPrimitiveType::Cylinder:
+		radius = length(float2(a.x, a.y));
+		break;
+	case SDFPrimitiveType::Cylinder6:
+		// 2D euclidean length is at most 2^(1/2 - 1/6) times length6
+		radius = length(float2(1.2599211f * a.x, a.y));
+		break;
+	case SDFPrimitiveType::Octahedron:
+		radius = a.x;
+		break;
+	case SDFPrimitiveType::HexPrism:
+		// h.x is the apothem of the hexagon
+		radius = length(float2(1.1547005f * a.x, a.y));
+		break;
+	case SDFPrimitiveType::RoundCone:
+		centre = float3(0.0f, 0.5f * a.z, 0.0f);
+		radius = 0.5f * a.z + max(a.x, a.y);
+		break;
+	case SDFPrimitiveType::SierpinskiTetrahedron:
+	{
+		// The attractor stays inside the tetrahedron va..vd, the coarsest level adds spheres of radius 2 / 2^n
+		const auto vertexCentre = 0.25f * (va + vb + vc + vd);
+		const auto vertexRadius = max(max(length(va - vertexCentre), length(vb - vertexCentre)), max(length(vc - vertexCentre), length(vd - vertexCentre)));
+		centre = vertexCentre / a.x;
+		radius = (vertexRadius + 2.0f / std::exp2(SierpinskiMinIterations)) / a.x;
+		break;
+	}
+	default:
+		break;
+	}
+
+	// Small margin so rounding never puts the surface outside the bound
+	primitive.boundCentre = primitive.position + centre;
+	primitive.boundRadius = radius * 1.01f + 1e-4f;
+}
+
+void SDFScene::ComputeBoundingBox(SDFPrimitive& primitive)
+{
+	const auto& a = primitive.paramsA;
+	const auto& b = primitive.paramsB;
+	// Half extents around the primitive's position unless the case sets low and high itself
+	auto extent = float3(0.0f, 0.0f, 0.0f);
+	auto low = float3(0.0f, 0.0f, 0.0f);
+	auto high = float3(0.0f, 0.0f, 0.0f);
+	auto centred = true;
+
+	switch (primitive.type)
+	{
+	case SDFPrimitiveType::RoundConeSegment:
+		// Hull of the two end spheres
+		low = min(a.xyz() - float3(a.w, a.w, a.w), b.xyz() - float3(b.w, b.w, b.w));
+		high = max(a.xyz() + float3(a.w, a.w, a.w), b.xyz() + float3(b.w, b.w, b.w));
+		centred = false;
+		break;
+	case SDFPrimitiveType::Cone:
+	{
+		const auto baseRadius = a.z * a.y / a.x;
+		low = float3(-baseRadius, -a.z, -baseRadius);
+		high = float3(baseRadius, 0.0f, baseRadius);
+		centred = false;
+		break;
+	}
+	case SDFPrimitiveType::CappedCone:
+		extent = float3(max(a.y, a.z), a.x, max(a.y, a.z));
+		break;
+	case SDFPrimitiveType::TwistedTorus:
+	{
+		// twistSDF turns xz by an angle that grows with y and the torus lies in that
+		// turned frame, its ring in the plane of x' and y and its tube along z'. So
+		// |y| and |x'| stay within R + r and |z'| within r, and x and z are the largest
+		// |cos| |x'| + |sin| |z'| over the angles the twist reaches.
+		const auto outer = a.x + a.y;
+		const auto angleLow = a.z * (1.0f - outer);
+		const auto angleHigh = a.z * (1.0f + outer);
+		auto extentX = 0.0f;
+		auto extentZ = 0.0f;
+		const auto reach = [&](float angle)
+		{
+			const auto c = std::abs(std::cos(angle));
+			const auto s = std::abs(std::sin(angle));
+			extentX = max(extentX, c * outer + s * a.y);
+			extentZ = max(extentZ, s * outer + c * a.y);
+		};
+		reach(min(angleLow, angleHigh));
+		reach(max(angleLow, angleHigh));
+		// Maxima of |cos| A + |sin| B and |sin| A + |cos| B sit at +-atan(B / A) + k pi / 2
+		const auto halfPi = 1.5707963f;
+		const auto critical = std::atan2(a.y, outer);
+		for (auto k = std::floor(min(angleLow, angleHigh) / halfPi) - 1.0f; k * halfPi <= max(angleLow, angleHigh) + halfPi; k += 1.0f)
+		{
+			for (const auto angle : { k * halfPi + critical, k * halfPi - critical })
+			{
+				if (angle >= min(angleLow, angleHigh) && angle <= max(angleLow, angleHigh)) reach(angle);
+			}
+		}
+		// The twist keeps the distance to the origin
+		extent = float3(min(extentX, outer), outer, min(extentZ, outer));
+		break;
+	}
+	case SDFPrimitiveType::Torus:
+	case SDFPrimitiveType::Torus82:
+		// length8 is at least the max norm, so the tube stays within r of the ring on each axis
+		extent = float3(a.x + a.y, a.y, a.x + a.y);
+		break;
+	case SDFPrimitiveType::Box:
+		extent = a.xyz();
+		break;
+	case SDFPrimitiveType::RoundBox:
+		extent = a.xyz() + float3(a.w, a.w, a.w);
+		break;
+	case SDFPrimitiveType::Ellipsoid:
+		extent = a.xyz();
+		break;
+	case SDFPrimitiveType::TriPrism:
+	{
+		// Equilateral triangle with half side h.x * sqrt(3) / 2, centroid at the origin and apex up
+		const auto halfSide = 0.866025f * a.x;
+		low = float3(-halfSide, -halfSide * 0.57735f, -a.y);
+		high = float3(halfSide, halfSide * 1.1547f, a.y);
+		centred = false;
+		break;
+	}
+	case SDFPrimitiveType::CylinderSegment:
+	{
+		// The end discs reach r sqrt(1 - axis^2) along each axis
+		const auto axis = normalize(b.xyz() - a.xyz());
+		const auto disc = float3(std::sqrt(max(0.0f, 1.0f - axis.x * axis.x)), std::sqrt(max(0.0f, 1.0f - axis.y * axis.y)), std::sqrt(max(0.0f, 1.0f - axis.z * axis.z))) * a.w;
+		low = min(a.xyz(), b.xyz()) - disc;
+		high = max(a.xyz(), b.xyz()) + disc;
+		centred = false;
+		break;
+	}
+	case SDFPrimitiveType::Cylinder:
+	case SDFPrimitiveType::Cylinder6:
+		// length6 is at least the max norm
+		extent = float3(a.x, a.y, a.x);
+		break;
+	case SDFPrimitiveType::Octahedron:
+		extent = float3(a.x, a.x, a.x);
+		break;
+	case SDFPrimitiveType::HexPrism:
+		// Flat sides at y = +-h.x, corners at x = +-2 h.x / sqrt(3)
+		extent = float3(1.1547005f * a.x, a.x, a.y);
+		break;
+	case SDFPrimitiveType::RoundCone:
+	{
+		const auto radius = max(a.x, a.y);
+		low = float3(-radius, -a.x, -radius);
+		high = float3(radius, a.z + a.y, radius);
+		centred = false;
+		break;
+	}
+	case SDFPrimitiveType::SierpinskiTetrahedron:
+	{
+		// The tetrahedron va..vd grown by the coarsest level's spheres, in the fractal's units
+		const auto margin = 2.0f / std::exp2(SierpinskiMinIterations);
+		low = (min(min(va, vb), min(vc, vd)) - float3(margin, margin, margin)) / a.x;
+		high = (max(max(va, vb), max(vc, vd)) + float3(margin, margin, margin)) / a.x;
+		centred = false;
+		break;
+	}
+	default:
+		break;
+	}
+
+	if (centred)
+	{
+		low = -extent;
+		high = extent;
+	}
+
+	// Same margin as the sphere so rounding never puts the surface outside the box
+	const auto centre = 0.5f * (low + high);
+	const auto halfSize = 0.5f * (high - low) * 1.01f + float3(1e-4f, 1e-4f, 1e-4f);
+	primitive.boundMin = primitive.position + centre - halfSize;
+	primitive.boundMax = primitive.position + centre + halfSize;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include <vector>
+#include "SDFPrimitives.h"
+
+using namespace HLSL;
+
+// Every primitive type used by sceneSDF in PS_RayMarchObjects.hlsl.
+enum class SDFPrimitiveType
+{
+	RoundConeSegment,	// a = paramsA.xyz, r1 = paramsA.w, b = paramsB.xyz, r2 = paramsB.w
+	Cone,				// c = paramsA.xyz
+	CappedCone,			// h = paramsA.x, r1 = paramsA.y, r2 = paramsA.z
+	TwistedTorus,		// t = paramsA.xy, twist = paramsA.z, distance scale = paramsA.w
+	Torus,				// t = paramsA.xy
+	Torus82,			// t = paramsA.xy
+	Box,				// b = paramsA.xyz
+	RoundBox,			// b = paramsA.xyz, r = paramsA.w
+	Ellipsoid,			// r = paramsA.xyz
+	TriPrism,			// h = paramsA.xy
+	CylinderSegment,	// a = paramsA.xyz, r = paramsA.w, b = paramsB.xyz
+	Cylinder,			// h = paramsA.xy
+	Cylinder6,			// h = paramsA.xy
+	Octahedron,			// s = paramsA.x
+	HexPrism,			// h = paramsA.xy
+	RoundCone,			// r1 = paramsA.x, r2 = paramsA.y, h = paramsA.z
+	SierpinskiTetrahedron,	// domain scale = paramsA.x, colour comes from the fractal
+	Count
+};
+
+struct SDFPrimitive
+{
+	SDFPrimitiveType type;
+	float3 position;
+	float4 paramsA;
+	float4 paramsB;
+	float3 colour;
+
+	// Bounding sphere in world space, the surface lies entirely inside it
+	float3 boundCentre;
+	float boundRadius;
+	// Axis aligned bounding box in world space, the proxy RayMarchObjects draws for the primitive
+	float3 boundMin;
+	float3 boundMax;
+};
+
+class SDFScene
+{
+public: // Structors
+	SDFScene() = default;
+
+	// The 17 objects of sceneSDF in PS_RayMarchObjects.hlsl
+	static SDFScene CreateDefaultScene();
+	// count copies of the default primitives scattered over a square of the given half size
+	static SDFScene CreateRandomScene(int count, unsigned int seed, float halfSize);
+
+public: // Accessors
+	const std::vector<SDFPrimitive>& GetPrimitives() const { return _primitives; }
+	int GetPrimitiveCount() const { return static_cast<int>(_primitives.size()); }
+
+public: // Functions
+	void AddPrimitive(SDFPrimitiveType type, const float3& position, const float4& paramsA, const float4& paramsB, const float3& colour);
+
+	// Distance (x) and colour (yzw) like sceneSDF, a footprint above 0 drops the fractal's sub-pixel iterations
+	float4 Evaluate(const float3& samplePoint, float footprint = 0.0f) const;
+	// Distance (x) and its analytic gradient (yzw) from one dual number evaluation
+	float4 EvaluateGradient(const float3& samplePoint) const;
+
+	static float4 EvaluatePrimitive(const SDFPrimitive& primitive, const float3& samplePoint, float footprint = 0.0f);
+	static void ComputeBoundingSphere(SDFPrimitive& primitive);
+	static void ComputeBoundingBox(SDFPrimitive& primitive);
+
+private: // Data
+	std::vector<SDFPrimitive> _primitives;
+};
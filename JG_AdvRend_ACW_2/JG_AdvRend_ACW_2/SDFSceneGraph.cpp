@@ -0,0 +1,70 @@
+#include "SDFSceneGraph.h"
+#include <cstdio>
+#include <cstdlib>
+
+namespace SDFGraph
+{
+	std::string SDFHLSLEmitter::DeclarePoint(const std::string& expression)
+	{
+		const auto name = "p" + std::to_string(_points++);
+		_statements.push_back("float3 " + name + " = " + expression + ";");
+		return name;
+	}
+
+	std::string SDFHLSLEmitter::DeclareDistance(const std::string& expression)
+	{
+		const auto name = "d" + std::to_string(_distances++);
+		_statements.push_back("float4 " + name + " = " + expression + ";");
+		return name;
+	}
+
+	void SDFHLSLEmitter::AddStatement(const std::string& statement)
+	{
+		_statements.push_back(statement);
+	}
+
+	void SDFHLSLEmitter::ScaleDistance(const std::string& distance, float scale)
+	{
+		if (_scaledStatements == _statements.size() && _scaledDistance == distance)
+		{
+			if (_distanceScale != 1.0f) _statements.pop_back();
+			scale *= _distanceScale;
+		}
+		_scaledDistance = distance;
+		_distanceScale = scale;
+		if (scale != 1.0f) _statements.push_back(distance + ".x *= " + Literal(scale) + ";");
+		_scaledStatements = _statements.size();
+	}
+
+	std::string SDFHLSLEmitter::BuildFunction(const std::string& functionName, const std::string& point, const std::string& result) const
+	{
+		auto source = "//Generated from an SDFGraph scene description, distance (x) and colour (yzw)\nfloat4 " + functionName + "(float3 " + point + ")\n{\n";
+		for (const auto& statement : _statements) source += "\t" + statement + "\n";
+		source += "\n\treturn " + result + ";\n}\n";
+		return source;
+	}
+
+	std::string SDFHLSLEmitter::Literal(float value)
+	{
+		char buffer[64];
+		auto found = false;
+		for (auto decimals = 1; decimals <= 12 && !found; decimals++)
+		{
+			std::snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+			found = std::strtof(buffer, nullptr) == value;
+		}
+
+		if (!found) std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+		return std::string(buffer) + "f";
+	}
+
+	std::string SDFHLSLEmitter::Literal(const float2& value)
+	{
+		return "float2(" + Literal(value.x) + ", " + Literal(value.y) + ")";
+	}
+
+	std::string SDFHLSLEmitter::Literal(const float3& value)
+	{
+		return "float3(" + Literal(value.x) + ", " + Literal(value.y) + ", " + Literal(value.z) + ")";
+	}
+}
@@ -0,0 +1,516 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+#include "SDFPrimitives.h"
+
+// Compile time scene description for the ray marched objects, every node can Evaluate, Emit HLSL and BuildRuntime
+namespace SDFGraph
+{
+	using namespace HLSL;
+
+	// Writes the body of the generated function one statement per node
+	class SDFHLSLEmitter
+	{
+	public: // Functions
+		// Declares a float3 (point) or float4 (distance and colour) holding the expression, returns its name
+		std::string DeclarePoint(const std::string& expression);
+		std::string DeclareDistance(const std::string& expression);
+		void AddStatement(const std::string& statement);
+		// Multiplies the distance's x, folded into the scale just written to it and left out when they cancel
+		void ScaleDistance(const std::string& distance, float scale);
+
+		std::string BuildFunction(const std::string& functionName, const std::string& point, const std::string& result) const;
+
+		// Shortest literal that reads back as the same float
+		static std::string Literal(float value);
+		static std::string Literal(const float2& value);
+		static std::string Literal(const float3& value);
+
+	private: // Data
+		std::vector<std::string> _statements;
+		int _points = 0;
+		int _distances = 0;
+		std::string _scaledDistance;		// the last ScaleDistance's, while nothing has been added since
+		float _distanceScale = 1.0f;
+		std::size_t _scaledStatements = 0;
+	};
+
+	// Interpreted counterpart of the nodes, walked through virtual calls
+	class SDFRuntimeNode
+	{
+	public: // Structors
+		virtual ~SDFRuntimeNode() = default;
+
+	public: // Functions
+		virtual float4 Evaluate(const float3& p) const = 0;
+	};
+
+	// Shapes, the distance functions of SDFPrimitives.h with their parameters
+
+	struct TorusShape
+	{
+		float2 t;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::torusSDF(p, t); }
+		std::string Call(const std::string& p) const { return "torusSDF(" + p + ", " + SDFHLSLEmitter::Literal(t) + ")"; }
+	};
+
+	struct Torus82Shape
+	{
+		float2 t;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::torus82SDF(p, t); }
+		std::string Call(const std::string& p) const { return "torus82SDF(" + p + ", " + SDFHLSLEmitter::Literal(t) + ")"; }
+	};
+
+	struct BoxShape
+	{
+		float3 b;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::boxSDF(p, b); }
+		std::string Call(const std::string& p) const { return "boxSDF(" + p + ", " + SDFHLSLEmitter::Literal(b) + ")"; }
+	};
+
+	struct RoundBoxShape
+	{
+		float3 b;
+		float r;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::roundBoxSDF(p, b, r); }
+		std::string Call(const std::string& p) const { return "roundBoxSDF(" + p + ", " + SDFHLSLEmitter::Literal(b) + ", " + SDFHLSLEmitter::Literal(r) + ")"; }
+	};
+
+	struct ConeShape
+	{
+		float3 c;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::coneSDF(p, c); }
+		std::string Call(const std::string& p) const { return "coneSDF(" + p + ", " + SDFHLSLEmitter::Literal(c) + ")"; }
+	};
+
+	struct CappedConeShape
+	{
+		float h, r1, r2;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::cappedConeSDF(p, h, r1, r2); }
+		std::string Call(const std::string& p) const
+		{
+			return "cappedConeSDF(" + p + ", " + SDFHLSLEmitter::Literal(h) + ", " + SDFHLSLEmitter::Literal(r1) + ", " + SDFHLSLEmitter::Literal(r2) + ")";
+		}
+	};
+
+	struct RoundConeShape
+	{
+		float r1, r2, h;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::roundConeSDF(p, r1, r2, h); }
+		std::string Call(const std::string& p) const
+		{
+			return "roundConeSDF(" + p + ", " + SDFHLSLEmitter::Literal(r1) + ", " + SDFHLSLEmitter::Literal(r2) + ", " + SDFHLSLEmitter::Literal(h) + ")";
+		}
+	};
+
+	struct RoundConeSegmentShape
+	{
+		float3 a, b;
+		float r1, r2;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::roundConeSDF(p, a, b, r1, r2); }
+		std::string Call(const std::string& p) const
+		{
+			return "roundConeSDF(" + p + ", " + SDFHLSLEmitter::Literal(a) + ", " + SDFHLSLEmitter::Literal(b) + ", " +
+				SDFHLSLEmitter::Literal(r1) + ", " + SDFHLSLEmitter::Literal(r2) + ")";
+		}
+	};
+
+	struct EllipsoidShape
+	{
+		float3 r;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::ellipsoidSDF(p, r); }
+		std::string Call(const std::string& p) const { return "ellipsoidSDF(" + p + ", " + SDFHLSLEmitter::Literal(r) + ")"; }
+	};
+
+	struct TriPrismShape
+	{
+		float2 h;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::triPrismSDF(p, h); }
+		std::string Call(const std::string& p) const { return "triPrismSDF(" + p + ", " + SDFHLSLEmitter::Literal(h) + ")"; }
+	};
+
+	struct CylinderShape
+	{
+		float2 h;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::cylinderSDF(p, h); }
+		std::string Call(const std::string& p) const { return "cylinderSDF(" + p + ", " + SDFHLSLEmitter::Literal(h) + ")"; }
+	};
+
+	struct Cylinder6Shape
+	{
+		float2 h;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::cylinder6SDF(p, h); }
+		std::string Call(const std::string& p) const { return "cylinder6SDF(" + p + ", " + SDFHLSLEmitter::Literal(h) + ")"; }
+	};
+
+	struct CylinderSegmentShape
+	{
+		float3 a, b;
+		float r;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::cylinderSDF(p, a, b, r); }
+		std::string Call(const std::string& p) const
+		{
+			return "cylinderSDF(" + p + ", " + SDFHLSLEmitter::Literal(a) + ", " + SDFHLSLEmitter::Literal(b) + ", " + SDFHLSLEmitter::Literal(r) + ")";
+		}
+	};
+
+	struct OctahedronShape
+	{
+		float s;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::octahedronSDF(p, s); }
+		std::string Call(const std::string& p) const { return "octahedronSDF(" + p + ", " + SDFHLSLEmitter::Literal(s) + ")"; }
+	};
+
+	struct HexPrismShape
+	{
+		float2 h;
+		template<typename T> T Distance(const Vector3<T>& p) const { return SDF::hexPrismSDF(p, h); }
+		std::string Call(const std::string& p) const { return "hexPrismSDF(" + p + ", " + SDFHLSLEmitter::Literal(h) + ")"; }
+	};
+
+	// Runtime nodes
+
+	template<typename Shape>
+	class RuntimeShape : public SDFRuntimeNode
+	{
+	public: // Structors
+		RuntimeShape(const Shape& shape, const float3& colour) : _shape(shape), _colour(colour) {}
+
+	public: // Functions
+		float4 Evaluate(const float3& p) const override { return float4(_shape.Distance(p), _colour); }
+
+	private: // Data
+		Shape _shape;
+		float3 _colour;
+	};
+
+	class RuntimeSierpinski : public SDFRuntimeNode
+	{
+	public: // Functions
+		float4 Evaluate(const float3& p) const override { return SDF::SierpinskiTetrahedron(p); }
+	};
+
+	// Transforms of the sample point (translate, twist, scale) or of the distance
+	class RuntimeTransform : public SDFRuntimeNode
+	{
+	public: // Types
+		enum class Kind { Translate, Twist, Scale, DistanceScale };
+
+	public: // Structors
+		RuntimeTransform(Kind kind, const float3& parameter, std::unique_ptr<SDFRuntimeNode> child) : _kind(kind), _parameter(parameter), _child(std::move(child)) {}
+
+	public: // Functions
+		float4 Evaluate(const float3& p) const override
+		{
+			switch (_kind)
+			{
+			case Kind::Translate: return _child->Evaluate(p - _parameter);
+			case Kind::Twist: return _child->Evaluate(SDF::twistSDF(p, _parameter.x));
+			case Kind::Scale:
+			{
+				auto result = _child->Evaluate(p / _parameter.x);
+				result.x *= _parameter.x;
+				return result;
+			}
+			default:
+			{
+				auto result = _child->Evaluate(p);
+				result.x *= _parameter.x;
+				return result;
+			}
+			}
+		}
+
+	private: // Data
+		Kind _kind;
+		float3 _parameter;
+		std::unique_ptr<SDFRuntimeNode> _child;
+	};
+
+	class RuntimeCombine : public SDFRuntimeNode
+	{
+	public: // Types
+		enum class Kind { Union, SmoothUnion, Intersection };
+
+	public: // Structors
+		RuntimeCombine(Kind kind, float k, std::unique_ptr<SDFRuntimeNode> a, std::unique_ptr<SDFRuntimeNode> b) : _kind(kind), _k(k), _a(std::move(a)), _b(std::move(b)) {}
+
+	public: // Functions
+		float4 Evaluate(const float3& p) const override
+		{
+			const auto a = _a->Evaluate(p);
+			const auto b = _b->Evaluate(p);
+
+			switch (_kind)
+			{
+			case Kind::Union: return SDF::unionSDF(a, b);
+			case Kind::SmoothUnion: return SDF::smoothUnionSDF(a, b, _k);
+			default: return SDF::intersectionSDF(a, b);
+			}
+		}
+
+	private: // Data
+		Kind _kind;
+		float _k;
+		std::unique_ptr<SDFRuntimeNode> _a;
+		std::unique_ptr<SDFRuntimeNode> _b;
+	};
+
+	// Nodes
+
+	template<typename Shape>
+	struct ShapeNode
+	{
+		Shape shape;
+		float3 colour;
+
+		template<typename T> Vector4<T> Evaluate(const Vector3<T>& p) const
+		{
+			return Vector4<T>(shape.Distance(p), T(colour.x), T(colour.y), T(colour.z));
+		}
+
+		std::string Emit(SDFHLSLEmitter& emitter, const std::string& point) const
+		{
+			return emitter.DeclareDistance("float4(" + shape.Call(point) + ", " + SDFHLSLEmitter::Literal(colour.x) + ", " +
+				SDFHLSLEmitter::Literal(colour.y) + ", " + SDFHLSLEmitter::Literal(colour.z) + ")");
+		}
+
+		std::unique_ptr<SDFRuntimeNode> BuildRuntime() const { return std::unique_ptr<SDFRuntimeNode>(new RuntimeShape<Shape>(shape, colour)); }
+	};
+
+	// Colours itself from the folded point like the shader's fractal
+	struct SierpinskiNode
+	{
+		template<typename T> Vector4<T> Evaluate(const Vector3<T>& p) const { return SDF::SierpinskiTetrahedron(p); }
+		std::string Emit(SDFHLSLEmitter& emitter, const std::string& point) const { return emitter.DeclareDistance("SierpinskiTetrahedron(" + point + ")"); }
+		std::unique_ptr<SDFRuntimeNode> BuildRuntime() const { return std::unique_ptr<SDFRuntimeNode>(new RuntimeSierpinski()); }
+	};
+
+	template<typename Child>
+	struct TranslateNode
+	{
+		float3 offset;
+		Child child;
+
+		template<typename T> Vector4<T> Evaluate(const Vector3<T>& p) const { return child.Evaluate(p - Vector3<T>(offset)); }
+
+		std::string Emit(SDFHLSLEmitter& emitter, const std::string& point) const
+		{
+			return child.Emit(emitter, emitter.DeclarePoint(point + " - " + SDFHLSLEmitter::Literal(offset)));
+		}
+
+		std::unique_ptr<SDFRuntimeNode> BuildRuntime() const
+		{
+			return std::unique_ptr<SDFRuntimeNode>(new RuntimeTransform(RuntimeTransform::Kind::Translate, offset, child.BuildRuntime()));
+		}
+	};
+
+	// Rotates xz about y by rate radians per unit of y, bends space so the distance is no longer exact
+	template<typename Child>
+	struct TwistNode
+	{
+		float rate;
+		Child child;
+
+		template<typename T> Vector4<T> Evaluate(const Vector3<T>& p) const { return child.Evaluate(SDF::twistSDF(p, rate)); }
+
+		std::string Emit(SDFHLSLEmitter& emitter, const std::string& point) const
+		{
+			return child.Emit(emitter, emitter.DeclarePoint("twistSDF(" + point + ", " + SDFHLSLEmitter::Literal(rate) + ")"));
+		}
+
+		std::unique_ptr<SDFRuntimeNode> BuildRuntime() const
+		{
+			return std::unique_ptr<SDFRuntimeNode>(new RuntimeTransform(RuntimeTransform::Kind::Twist, float3(rate), child.BuildRuntime()));
+		}
+	};
+
+	// Uniform scale, the distance is scaled back so it stays exact
+	template<typename Child>
+	struct ScaleNode
+	{
+		float scale;
+		Child child;
+
+		template<typename T> Vector4<T> Evaluate(const Vector3<T>& p) const
+		{
+			auto result = child.Evaluate(p / T(scale));
+			result.x = result.x * scale;
+			return result;
+		}
+
+		std::string Emit(SDFHLSLEmitter& emitter, const std::string& point) const
+		{
+			const auto result = child.Emit(emitter, emitter.DeclarePoint(point + " / " + SDFHLSLEmitter::Literal(scale)));
+			emitter.ScaleDistance(result, scale);
+			return result;
+		}
+
+		std::unique_ptr<SDFRuntimeNode> BuildRuntime() const
+		{
+			return std::unique_ptr<SDFRuntimeNode>(new RuntimeTransform(RuntimeTransform::Kind::Scale, float3(scale), child.BuildRuntime()));
+		}
+	};
+
+	// Multiplies the distance only, below 1 makes a bent distance field (twist) safe to march again
+	template<typename Child>
+	struct DistanceScaleNode
+	{
+		float scale;
+		Child child;
+
+		template<typename T> Vector4<T> Evaluate(const Vector3<T>& p) const
+		{
+			auto result = child.Evaluate(p);
+			result.x = scale * result.x;
+			return result;
+		}
+
+		std::string Emit(SDFHLSLEmitter& emitter, const std::string& point) const
+		{
+			const auto result = child.Emit(emitter, point);
+			emitter.ScaleDistance(result, scale);
+			return result;
+		}
+
+		std::unique_ptr<SDFRuntimeNode> BuildRuntime() const
+		{
+			return std::unique_ptr<SDFRuntimeNode>(new RuntimeTransform(RuntimeTransform::Kind::DistanceScale, float3(scale), child.BuildRuntime()));
+		}
+	};
+
+	template<typename A, typename B>
+	struct UnionNode
+	{
+		A a;
+		B b;
+
+		template<typename T> Vector4<T> Evaluate(const Vector3<T>& p) const
+		{
+			const auto distanceA = a.Evaluate(p);
+			const auto distanceB = b.Evaluate(p);
+			return (distanceA.x < distanceB.x) ? distanceA : distanceB;
+		}
+
+		std::string Emit(SDFHLSLEmitter& emitter, const std::string& point) const
+		{
+			const auto distanceA = a.Emit(emitter, point);
+			const auto distanceB = b.Emit(emitter, point);
+			return emitter.DeclareDistance("unionSDF(" + distanceA + ", " + distanceB + ")");
+		}
+
+		std::unique_ptr<SDFRuntimeNode> BuildRuntime() const
+		{
+			return std::unique_ptr<SDFRuntimeNode>(new RuntimeCombine(RuntimeCombine::Kind::Union, 0.0f, a.BuildRuntime(), b.BuildRuntime()));
+		}
+	};
+
+	template<typename A, typename B>
+	struct SmoothUnionNode
+	{
+		float k;
+		A a;
+		B b;
+
+		template<typename T> Vector4<T> Evaluate(const Vector3<T>& p) const { return SDF::smoothUnionSDF(a.Evaluate(p), b.Evaluate(p), k); }
+
+		std::string Emit(SDFHLSLEmitter& emitter, const std::string& point) const
+		{
+			const auto distanceA = a.Emit(emitter, point);
+			const auto distanceB = b.Emit(emitter, point);
+			return emitter.DeclareDistance("smoothUnionSDF(" + distanceA + ", " + distanceB + ", " + SDFHLSLEmitter::Literal(k) + ")");
+		}
+
+		std::unique_ptr<SDFRuntimeNode> BuildRuntime() const
+		{
+			return std::unique_ptr<SDFRuntimeNode>(new RuntimeCombine(RuntimeCombine::Kind::SmoothUnion, k, a.BuildRuntime(), b.BuildRuntime()));
+		}
+	};
+
+	template<typename A, typename B>
+	struct IntersectionNode
+	{
+		A a;
+		B b;
+
+		template<typename T> Vector4<T> Evaluate(const Vector3<T>& p) const { return SDF::intersectionSDF(a.Evaluate(p), b.Evaluate(p)); }
+
+		std::string Emit(SDFHLSLEmitter& emitter, const std::string& point) const
+		{
+			const auto distanceA = a.Emit(emitter, point);
+			const auto distanceB = b.Emit(emitter, point);
+			return emitter.DeclareDistance("intersectionSDF(" + distanceA + ", " + distanceB + ")");
+		}
+
+		std::unique_ptr<SDFRuntimeNode> BuildRuntime() const
+		{
+			return std::unique_ptr<SDFRuntimeNode>(new RuntimeCombine(RuntimeCombine::Kind::Intersection, 0.0f, a.BuildRuntime(), b.BuildRuntime()));
+		}
+	};
+
+	// Builders
+
+	inline ShapeNode<TorusShape> Torus(const float2& t, const float3& colour) { return { { t }, colour }; }
+	inline ShapeNode<Torus82Shape> Torus82(const float2& t, const float3& colour) { return { { t }, colour }; }
+	inline ShapeNode<BoxShape> Box(const float3& b, const float3& colour) { return { { b }, colour }; }
+	inline ShapeNode<RoundBoxShape> RoundBox(const float3& b, float r, const float3& colour) { return { { b, r }, colour }; }
+	inline ShapeNode<ConeShape> Cone(const float3& c, const float3& colour) { return { { c }, colour }; }
+	inline ShapeNode<CappedConeShape> CappedCone(float h, float r1, float r2, const float3& colour) { return { { h, r1, r2 }, colour }; }
+	inline ShapeNode<RoundConeShape> RoundCone(float r1, float r2, float h, const float3& colour) { return { { r1, r2, h }, colour }; }
+	inline ShapeNode<RoundConeSegmentShape> RoundCone(const float3& a, const float3& b, float r1, float r2, const float3& colour) { return { { a, b, r1, r2 }, colour }; }
+	inline ShapeNode<EllipsoidShape> Ellipsoid(const float3& r, const float3& colour) { return { { r }, colour }; }
+	inline ShapeNode<TriPrismShape> TriPrism(const float2& h, const float3& colour) { return { { h }, colour }; }
+	inline ShapeNode<CylinderShape> Cylinder(const float2& h, const float3& colour) { return { { h }, colour }; }
+	inline ShapeNode<Cylinder6Shape> Cylinder6(const float2& h, const float3& colour) { return { { h }, colour }; }
+	inline ShapeNode<CylinderSegmentShape> Cylinder(const float3& a, const float3& b, float r, const float3& colour) { return { { a, b, r }, colour }; }
+	inline ShapeNode<OctahedronShape> Octahedron(float s, const float3& colour) { return { { s }, colour }; }
+	inline ShapeNode<HexPrismShape> HexPrism(const float2& h, const float3& colour) { return { { h }, colour }; }
+	inline SierpinskiNode Sierpinski() { return {}; }
+
+	template<typename Child> TranslateNode<Child> Translate(const float3& offset, const Child& child) { return { offset, child }; }
+	template<typename Child> TwistNode<Child> Twist(float rate, const Child& child) { return { rate, child }; }
+	template<typename Child> ScaleNode<Child> Scale(float scale, const Child& child) { return { scale, child }; }
+	template<typename Child> DistanceScaleNode<Child> DistanceScale(float scale, const Child& child) { return { scale, child }; }
+
+	template<typename A, typename B> UnionNode<A, B> Union(const A& a, const B& b) { return { a, b }; }
+	// Folds from the left, so ties go to the earlier child like the shader's loop over primitives
+	template<typename A, typename B, typename C, typename... Rest> auto Union(const A& a, const B& b, const C& c, const Rest&... rest)
+	{
+		return Union(Union(a, b), c, rest...);
+	}
+
+	template<typename A, typename B> SmoothUnionNode<A, B> SmoothUnion(float k, const A& a, const B& b) { return { k, a, b }; }
+	template<typename A, typename B> IntersectionNode<A, B> Intersection(const A& a, const B& b) { return { a, b }; }
+
+	template<typename Node> std::string EmitHLSL(const Node& node, const std::string& functionName = "sceneSDF")
+	{
+		SDFHLSLEmitter emitter;
+		const auto result = node.Emit(emitter, "samplePoint");
+		return emitter.BuildFunction(functionName, "samplePoint", result);
+	}
+
+	// The 17 objects of sceneSDF in PS_RayMarchObjects.hlsl, in the same order as SDFScene::CreateDefaultScene
+	inline auto CreateDefaultSceneGraph()
+	{
+		return Union(
+			Translate(float3(0.3f, 0.5f, 0.3f), RoundCone(float3(0.02f, 0.0f, 0.0f), float3(-0.02f, 0.06f, 0.02f), 0.03f, 0.01f, float3(0.18f, 0.22f, 1.0f))),
+			Translate(float3(0.0f, 0.53f, 0.0f), Cone(float3(0.16f, 0.12f, 0.06f), float3(0.55f, 0.23f, 0.38f))),
+			Translate(float3(0.3f, 0.5f, 0.0f), CappedCone(0.03f, 0.04f, 0.02f, float3(0.80f, 0.78f, 0.45f))),
+			Translate(float3(0.0f, 0.5f, 0.3f), DistanceScale(0.6f, Twist(60.0f, Torus(float2(0.04f, 0.01f), float3(0.28f, 0.51f, 0.08f))))),
+			Translate(float3(-0.3f, 0.5f, -0.3f), Torus(float2(0.04f, 0.01f), float3(0.41f, 0.27f, 0.54f))),
+			Translate(float3(0.0f, 0.5f, -0.3f), Torus82(float2(0.04f, 0.01f), float3(0.52f, 0.75f, 0.42f))),
+			Translate(float3(-0.3f, 0.5f, 0.0f), Box(float3(0.05f, 0.05f, 0.05f), float3(0.31f, 0.47f, 0.63f))),
+			Translate(float3(-0.3f, 0.5f, 0.3f), RoundBox(float3(0.04f, 0.04f, 0.04f), 0.016f, float3(1.0f, 0.27f, 0.0f))),
+			Translate(float3(0.3f, 0.5f, -0.3f), Ellipsoid(float3(0.05f, 0.05f, 0.02f), float3(0.8f, 0.41f, 0.79f))),
+			Translate(float3(-0.6f, 0.5f, -0.3f), TriPrism(float2(0.05f, 0.02f), float3(0.92f, 0.68f, 0.92f))),
+			Translate(float3(-0.6f, 0.5f, 0.0f), Cylinder(float3(0.002f, -0.002f, 0.0f), float3(-0.02f, 0.06f, 0.02f), 0.016f, float3(0.78f, 0.38f, 0.08f))),
+			Translate(float3(-0.6f, 0.5f, 0.3f), Cylinder(float2(0.02f, 0.04f), float3(0.98f, 0.63f, 0.42f))),
+			Translate(float3(0.3f, 0.5f, 0.6f), Cylinder6(float2(0.02f, 0.04f), float3(0.29f, 0.46f, 0.43f))),
+			Translate(float3(0.0f, 0.5f, 0.6f), Octahedron(0.07f, float3(0.46f, 0.61f, 0.52f))),
+			Translate(float3(-0.3f, 0.5f, 0.6f), HexPrism(float2(0.05f, 0.01f), float3(0.59f, 1.0f, 1.0f))),
+			Translate(float3(-0.6f, 0.5f, 0.6f), RoundCone(0.04f, 0.02f, 0.06f, float3(1.0f, 0.2f, 0.0f))),
+			// The shader samples the fractal at twice the offset without scaling the distance back, so the two distance scales cancel
+			Translate(float3(-1.0f, 2.0f, -2.0f), DistanceScale(2.0f, Scale(0.5f, Sierpinski()))));
+	}
+}
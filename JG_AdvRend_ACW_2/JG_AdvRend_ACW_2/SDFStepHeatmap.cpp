@@ -0,0 +1,132 @@
+#include "SDFStepHeatmap.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+SDFStepHeatmap::SDFStepHeatmap()
+	: _width(0), _height(0), _maxMarchingSteps(0), _outcomeCounts(), _relaxationFallbacks(0), _maxSteps(0), _totalSteps(0)
+{
+}
+
+void SDFStepHeatmap::Reset(int width, int height, int maxMarchingSteps)
+{
+	_width = width;
+	_height = height;
+	_maxMarchingSteps = maxMarchingSteps;
+	_steps.assign(width * height, 0);
+	_outcomes.assign(width * height, SDFMarchOutcome::Escaped);
+	std::fill(std::begin(_outcomeCounts), std::end(_outcomeCounts), 0);
+	_relaxationFallbacks = 0;
+	_maxSteps = 0;
+	_totalSteps = 0;
+}
+
+void SDFStepHeatmap::Record(int pixelX, int pixelY, const SDFMarchResult& result)
+{
+	_steps[pixelY * _width + pixelX] = result.steps;
+	_outcomes[pixelY * _width + pixelX] = result.outcome;
+	_outcomeCounts[static_cast<int>(result.outcome)]++;
+	if (result.relaxationFellBack) _relaxationFallbacks++;
+	_maxSteps = std::max(_maxSteps, result.steps);
+	_totalSteps += result.steps;
+}
+
+int SDFStepHeatmap::GetStepPercentile(double fraction) const
+{
+	if (_steps.empty()) return 0;
+
+	auto sorted = _steps;
+	const auto index = static_cast<size_t>(std::min(1.0, std::max(0.0, fraction)) * (sorted.size() - 1));
+	std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+	return sorted[index];
+}
+
+std::vector<std::vector<int>> SDFStepHeatmap::BuildHistogram(int binWidth) const
+{
+	const auto bins = _maxMarchingSteps / binWidth + 1;
+	std::vector<std::vector<int>> histogram(static_cast<int>(SDFMarchOutcome::Count), std::vector<int>(bins, 0));
+
+	for (size_t i = 0; i < _steps.size(); i++)
+	{
+		histogram[static_cast<int>(_outcomes[i])][std::min(_steps[i] / binWidth, bins - 1)]++;
+	}
+
+	return histogram;
+}
+
+bool SDFStepHeatmap::WriteImage(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file) return false;
+
+	file << "P6\n" << _width << " " << _height << "\n255\n";
+
+	// Black, blue, green, yellow, red
+	const float3 ramp[] = { float3(0.0f, 0.0f, 0.0f), float3(0.0f, 0.0f, 1.0f), float3(0.0f, 1.0f, 0.0f), float3(1.0f, 1.0f, 0.0f), float3(1.0f, 0.0f, 0.0f) };
+	const auto stops = static_cast<int>(sizeof(ramp) / sizeof(ramp[0])) - 1;
+
+	std::vector<unsigned char> row(_width * 3);
+	for (auto y = 0; y < _height; y++)
+	{
+		for (auto x = 0; x < _width; x++)
+		{
+			const auto outcome = GetOutcome(x, y);
+			float3 colour;
+
+			if (outcome == SDFMarchOutcome::OutOfSteps)
+			{
+				colour = float3(1.0f, 0.0f, 1.0f);
+			}
+			else if (outcome == SDFMarchOutcome::Grazed)
+			{
+				colour = float3(1.0f, 1.0f, 1.0f);
+			}
+			else
+			{
+				const auto t = HLSL::saturate(static_cast<float>(GetSteps(x, y)) / std::max(1, _maxMarchingSteps)) * stops;
+				const auto stop = std::min(static_cast<int>(t), stops - 1);
+				colour = HLSL::lerp(ramp[stop], ramp[stop + 1], t - stop);
+				if (outcome == SDFMarchOutcome::Escaped) colour = colour * 0.5f;
+			}
+
+			for (auto c = 0; c < 3; c++) row[x * 3 + c] = static_cast<unsigned char>(std::lround(colour[c] * 255.0f));
+		}
+
+		file.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+
+	return static_cast<bool>(file);
+}
+
+bool SDFStepHeatmap::WriteHistogram(const std::string& path, int binWidth) const
+{
+	std::ofstream file(path);
+	if (!file) return false;
+
+	const auto histogram = BuildHistogram(binWidth);
+
+	file << "steps";
+	for (auto o = 0; o < static_cast<int>(SDFMarchOutcome::Count); o++) file << "," << GetOutcomeName(static_cast<SDFMarchOutcome>(o));
+	file << "\n";
+
+	for (size_t bin = 0; bin < histogram[0].size(); bin++)
+	{
+		file << bin * binWidth;
+		for (const auto& counts : histogram) file << "," << counts[bin];
+		file << "\n";
+	}
+
+	return static_cast<bool>(file);
+}
+
+const char* GetOutcomeName(SDFMarchOutcome outcome)
+{
+	switch (outcome)
+	{
+	case SDFMarchOutcome::Hit: return "hit";
+	case SDFMarchOutcome::Escaped: return "escaped";
+	case SDFMarchOutcome::OutOfSteps: return "out of steps";
+	case SDFMarchOutcome::Grazed: return "grazed";
+	default: return "unknown";
+	}
+}
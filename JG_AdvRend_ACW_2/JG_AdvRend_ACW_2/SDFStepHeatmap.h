@@ -0,0 +1,48 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "SDFRayMarcher.h"
+
+// Per pixel step counts and outcomes of a RenderImage call
+class SDFStepHeatmap
+{
+public: // Structors
+	SDFStepHeatmap();
+
+public: // Accessors
+	int GetWidth() const { return _width; }
+	int GetHeight() const { return _height; }
+	int GetSteps(int pixelX, int pixelY) const { return _steps[pixelY * _width + pixelX]; }
+	SDFMarchOutcome GetOutcome(int pixelX, int pixelY) const { return _outcomes[pixelY * _width + pixelX]; }
+	int GetOutcomeCount(SDFMarchOutcome outcome) const { return _outcomeCounts[static_cast<int>(outcome)]; }
+	int GetRelaxationFallbacks() const { return _relaxationFallbacks; }
+	int GetMaxSteps() const { return _maxSteps; }
+	long long GetTotalSteps() const { return _totalSteps; }
+
+public: // Functions
+	void Reset(int width, int height, int maxMarchingSteps);
+	void Record(int pixelX, int pixelY, const SDFMarchResult& result);
+
+	// Step count below which the given fraction (0 to 1) of the pixels fall
+	int GetStepPercentile(double fraction) const;
+	// Pixel count per bin of binWidth steps, one row per outcome
+	std::vector<std::vector<int>> BuildHistogram(int binWidth) const;
+
+	// Binary PPM of the steps, escaped rays at half brightness, out of steps magenta and grazing white
+	bool WriteImage(const std::string& path) const;
+	// CSV with a row per bin: first step, then the pixel count of each outcome
+	bool WriteHistogram(const std::string& path, int binWidth) const;
+
+private: // Data
+	int _width;
+	int _height;
+	int _maxMarchingSteps;
+	std::vector<int> _steps;
+	std::vector<SDFMarchOutcome> _outcomes;
+	int _outcomeCounts[static_cast<int>(SDFMarchOutcome::Count)];
+	int _relaxationFallbacks;
+	int _maxSteps;
+	long long _totalSteps;
+};
+
+const char* GetOutcomeName(SDFMarchOutcome outcome);
@@ -0,0 +1,162 @@
+#include "SDFTilePruning.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "SDFInterval.h"
+
+SDFTileGrid::SDFTileGrid(const SDFScene& scene, const SDFCamera& camera, int width, int height, float maxDistance, const SDFTileSettings& settings)
+	: _scene(scene), _camera(camera), _width(width), _height(height), _settings(settings), _stats(), _rootPrimitiveTotal(0)
+{
+	_leavesX = (width + settings.leafTileSize - 1) / settings.leafTileSize;
+	_leavesY = (height + settings.leafTileSize - 1) / settings.leafTileSize;
+
+	for (auto end = settings.firstSlabDepth; ; end *= 2.0f)
+	{
+		_slabEnds.push_back(std::min(end, maxDistance));
+		if (end >= maxDistance) break;
+	}
+}
+
+void SDFTileGrid::Build()
+{
+	const auto startTime = std::chrono::steady_clock::now();
+
+	_cells.assign(_leavesX * _leavesY * GetSlabCount(), Cell{ 0, 0 });
+	_indices.clear();
+	_stats = SDFTileStats();
+	_rootPrimitiveTotal = 0;
+
+	std::vector<int> everything(_scene.GetPrimitiveCount());
+	for (auto i = 0; i < static_cast<int>(everything.size()); i++) everything[i] = i;
+
+	auto roots = 0;
+	std::vector<int> kept;
+	for (auto y = 0; y < _height; y += _settings.rootTileSize)
+	{
+		for (auto x = 0; x < _width; x += _settings.rootTileSize)
+		{
+			for (auto slab = 0; slab < GetSlabCount(); slab++)
+			{
+				float3 boxMin, boxMax;
+				RegionBounds(x, y, x + _settings.rootTileSize, y + _settings.rootTileSize, slab, boxMin, boxMax);
+				Prune(boxMin, boxMax, everything, kept);
+				_rootPrimitiveTotal += kept.size();
+				roots++;
+
+				BuildNode(x, y, _settings.rootTileSize, slab, kept);
+			}
+		}
+	}
+
+	long long leafTotal = 0;
+	for (const auto& cell : _cells) leafTotal += cell.count;
+
+	_stats.leafTiles = _leavesX * _leavesY;
+	_stats.slabs = GetSlabCount();
+	_stats.averagePrimitivesPerRootTile = static_cast<double>(_rootPrimitiveTotal) / roots;
+	_stats.averagePrimitivesPerLeafTile = static_cast<double>(leafTotal) / _cells.size();
+	_stats.buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+const int* SDFTileGrid::GetPrimitiveList(int pixelX, int pixelY, int slab, int& count) const
+{
+	const auto& cell = _cells[(slab * _leavesY + pixelY / _settings.leafTileSize) * _leavesX + pixelX / _settings.leafTileSize];
+	count = cell.count;
+	return _indices.data() + cell.offset;
+}
+
+void SDFTileGrid::BuildNode(int x0, int y0, int size, int slab, const std::vector<int>& candidates)
+{
+	// Subdivide while the children can still drop primitives
+	if (size > _settings.leafTileSize && candidates.size() > 1)
+	{
+		const auto half = size / 2;
+		std::vector<int> kept;
+		for (auto child = 0; child < 4; child++)
+		{
+			const auto cx = x0 + (child & 1) * half;
+			const auto cy = y0 + (child >> 1) * half;
+			if (cx >= _width || cy >= _height) continue;
+
+			float3 boxMin, boxMax;
+			RegionBounds(cx, cy, cx + half, cy + half, slab, boxMin, boxMax);
+			Prune(boxMin, boxMax, candidates, kept);
+			BuildNode(cx, cy, half, slab, kept);
+		}
+		return;
+	}
+
+	// Every leaf tile under this node shares the list
+	const auto offset = static_cast<int>(_indices.size());
+	_indices.insert(_indices.end(), candidates.begin(), candidates.end());
+
+	const auto leafX0 = x0 / _settings.leafTileSize;
+	const auto leafY0 = y0 / _settings.leafTileSize;
+	const auto leafX1 = std::min(_leavesX, (x0 + size) / _settings.leafTileSize);
+	const auto leafY1 = std::min(_leavesY, (y0 + size) / _settings.leafTileSize);
+	for (auto ly = leafY0; ly < leafY1; ly++)
+	{
+		for (auto lx = leafX0; lx < leafX1; lx++)
+		{
+			_cells[(slab * _leavesY + ly) * _leavesX + lx] = Cell{ offset, static_cast<int>(candidates.size()) };
+		}
+	}
+}
+
+void SDFTileGrid::RegionBounds(int x0, int y0, int x1, int y1, int slab, float3& boxMin, float3& boxMax) const
+{
+	x1 = std::min(x1, _width);
+	y1 = std::min(y1, _height);
+
+	const auto canvasMin = _camera.PixelToCanvas(static_cast<float>(x0), static_cast<float>(y1), _width, _height);
+	const auto canvasMax = _camera.PixelToCanvas(static_cast<float>(x1), static_cast<float>(y0), _width, _height);
+
+	// Ray directions through the tile are right * x + up * y + forward * d before normalisation,
+	// so the slab [t0, t1] lies inside the frustum between parameters t0 / |dir|max and t1 / |dir|min
+	const auto d = _camera.imagePlaneDistance;
+	const auto nearestX = HLSL::clamp(0.0f, canvasMin.x, canvasMax.x);
+	const auto nearestY = HLSL::clamp(0.0f, canvasMin.y, canvasMax.y);
+	const auto furthestX = std::max(std::fabs(canvasMin.x), std::fabs(canvasMax.x));
+	const auto furthestY = std::max(std::fabs(canvasMin.y), std::fabs(canvasMax.y));
+	const auto lengthMin = std::sqrt(d * d + nearestX * nearestX + nearestY * nearestY);
+	const auto lengthMax = std::sqrt(d * d + furthestX * furthestX + furthestY * furthestY);
+
+	const auto t0 = slab == 0 ? 0.0f : _slabEnds[slab - 1];
+	const auto t1 = _slabEnds[slab];
+	const float scales[2] = { t0 / lengthMax, t1 / lengthMin };
+
+	boxMin = float3(1e10f, 1e10f, 1e10f);
+	boxMax = float3(-1e10f, -1e10f, -1e10f);
+	for (auto corner = 0; corner < 8; corner++)
+	{
+		const auto canvasX = corner & 1 ? canvasMax.x : canvasMin.x;
+		const auto canvasY = corner & 2 ? canvasMax.y : canvasMin.y;
+		const auto point = _camera.position + (_camera.right * canvasX + _camera.up * canvasY + _camera.forward * d) * scales[corner >> 2];
+		boxMin = min(boxMin, point);
+		boxMax = max(boxMax, point);
+	}
+
+	const auto padding = 0.0001f * (1.0f + t1);
+	boxMin = boxMin - float3(padding, padding, padding);
+	boxMax = boxMax + float3(padding, padding, padding);
+}
+
+void SDFTileGrid::Prune(const float3& boxMin, const float3& boxMax, const std::vector<int>& candidates, std::vector<int>& kept)
+{
+	_ranges.resize(candidates.size());
+
+	const auto& primitives = _scene.GetPrimitives();
+	auto closestUpper = 1e10f;
+	for (auto i = 0; i < static_cast<int>(candidates.size()); i++)
+	{
+		_ranges[i] = EvaluatePrimitiveInterval(primitives[candidates[i]], boxMin, boxMax);
+		closestUpper = std::min(closestUpper, _ranges[i].hi);
+	}
+	_stats.intervalEvaluations += candidates.size();
+
+	kept.clear();
+	for (auto i = 0; i < static_cast<int>(candidates.size()); i++)
+	{
+		if (_ranges[i].lo <= closestUpper + _settings.tolerance) kept.push_back(candidates[i]);
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include "Common/Interval.h"
+#include "SDFRayMarcher.h"
+
+struct SDFTileSettings
+{
+	int rootTileSize = 64;
+	int leafTileSize = 8;
+	float firstSlabDepth = 0.25f;	// depth slabs double in length from here out to the max distance
+	float tolerance = 0.001f;		// slack for float rounding when comparing interval bounds
+};
+
+struct SDFTileStats
+{
+	int leafTiles;
+	int slabs;
+	long long intervalEvaluations;
+	double averagePrimitivesPerRootTile;	// per root tile and slab
+	double averagePrimitivesPerLeafTile;	// per leaf tile and slab
+	double buildMilliseconds;
+};
+
+// Screen tiles by depth slabs, each keeping the primitives whose interval distance can be the closest in it
+class SDFTileGrid
+{
+public: // Structors
+	SDFTileGrid(const SDFScene& scene, const SDFCamera& camera, int width, int height, float maxDistance, const SDFTileSettings& settings);
+
+public: // Accessors
+	const SDFCamera& GetCamera() const { return _camera; }
+	int GetWidth() const { return _width; }
+	int GetHeight() const { return _height; }
+	int GetSlabCount() const { return static_cast<int>(_slabEnds.size()); }
+	float GetSlabEnd(int slab) const { return _slabEnds[slab]; }
+	const SDFTileStats& GetStats() const { return _stats; }
+
+public: // Functions
+	void Build();
+
+	// Primitives left for the leaf tile holding the pixel at the given slab
+	const int* GetPrimitiveList(int pixelX, int pixelY, int slab, int& count) const;
+
+private: // Functions
+	void BuildNode(int x0, int y0, int size, int slab, const std::vector<int>& candidates);
+	void RegionBounds(int x0, int y0, int x1, int y1, int slab, float3& boxMin, float3& boxMax) const;
+	void Prune(const float3& boxMin, const float3& boxMax, const std::vector<int>& candidates, std::vector<int>& kept);
+
+private: // Data
+	struct Cell
+	{
+		int offset;
+		int count;
+	};
+
+	const SDFScene& _scene;
+	SDFCamera _camera;
+	int _width;
+	int _height;
+	SDFTileSettings _settings;
+
+	int _leavesX;
+	int _leavesY;
+	std::vector<float> _slabEnds;
+	std::vector<Cell> _cells;	// leaf tiles by slab
+	std::vector<int> _indices;
+	std::vector<Interval> _ranges;	// scratch for Prune
+	SDFTileStats _stats;
+	long long _rootPrimitiveTotal;
+};
@@ -0,0 +1,19 @@
+//Depth of the geometry rasterized before this pass, see DeviceResources::CopySceneDepth
+Texture2D<float> sceneDepth : register(t0);
+
+//Distance along the ray to where its projected depth reaches the rasterized geometry at this pixel,
+//a hit any further would fail the depth test. end when nothing was drawn at the pixel.
+float sceneDepthDistance(float2 pixel, float3 origin, float3 direction, float end, matrix view, matrix projection)
+{
+	float depth = sceneDepth.Load(int3(pixel, 0));
+	if (depth >= 1.0) return end;
+
+	//Inverts depth = (z p33 + p43) / (z p34 + p44) for the view space z, then finds it along the ray
+	float viewZ = (projection._43 - depth * projection._44) / (depth * projection._34 - projection._33);
+	float originZ = mul(float4(origin, 1.0f), view).z;
+	float directionZ = mul(float4(direction, 0.0f), view).z;
+	if (abs(directionZ) < 0.0001) return end;
+
+	float t = (viewZ - originZ) / directionZ;
+	return t > 0.0 ? min(t, end) : end;
+}
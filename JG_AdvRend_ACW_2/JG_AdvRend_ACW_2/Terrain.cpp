@@ -2,8 +2,12 @@
 #include "Terrain.h"
 
 Terrain::Terrain(const shared_ptr<DeviceResources>& device, const shared_ptr<ResourceManager>& resourceManager)
-	: _device(device), _resourceManager(resourceManager), _position(0.0f, 0.0f, 0.0f), _rotation(0.0f, 0.0f, 0.0f), _scale(40.0f, 1.0f, 40.0f), _loadingComplete(false), _indexCount(0)
+	: _device(device), _resourceManager(resourceManager), _loadingComplete(false)
 {
+	// Tessellated segments about 8 pixels long, up to HS_Terrain's maxtessfactor
+	_targetBufferData.edgePixels = 8.0f;
+	_targetBufferData.maxFactor = 64.0f;
+	_targetBufferData.pixelScale = 1.0f;
 	CreateDeviceDependentResources();
 }
 
@@ -25,13 +29,10 @@ void Terrain::CreateDeviceDependentResources()
 			)
 		);
 
+		// The grid's positions in [0, 1] across a chunk
 		static const D3D11_INPUT_ELEMENT_DESC vertexDesc[] =
 		{
-			{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"TANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0},
-			{"BINORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0}
+			{"POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0}
 		};
 
 		ThrowIfFailed(
@@ -91,27 +92,78 @@ void Terrain::CreateDeviceDependentResources()
 
 		CD3D11_BUFFER_DESC cameraBufferDesc(sizeof(CameraPositionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
 		ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&cameraBufferDesc, nullptr, &_cameraBuffer));
-		
+
+		CD3D11_BUFFER_DESC chunkBufferDesc(sizeof(TerrainChunkConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+		ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&chunkBufferDesc, nullptr, &_chunkBuffer));
+
+		CD3D11_BUFFER_DESC targetBufferDesc(sizeof(TessellationTargetConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+		ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&targetBufferDesc, nullptr, &_targetBuffer));
+
 		D3D11_RASTERIZER_DESC raster = CD3D11_RASTERIZER_DESC(D3D11_DEFAULT);
 		raster.CullMode = D3D11_CULL_NONE;
 		raster.FillMode = D3D11_FILL_SOLID;
 		ThrowIfFailed(_device->GetD3DDevice()->CreateRasterizerState(&raster, _rasterState.GetAddressOf()));
+
+		D3D11_SAMPLER_DESC sampDesc = CD3D11_SAMPLER_DESC(D3D11_DEFAULT);
+		sampDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+		sampDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+		ThrowIfFailed(_device->GetD3DDevice()->CreateSamplerState(&sampDesc, &_samplerState));
 	});
 
-	// Once both shaders are loaded, create the mesh.
-	auto createSphere = (createPSTask && createVSTask && createHSTask && createDSTask).then([this]() {
-		ThrowIfFailed(
-			_resourceManager->LoadModel(
-				_device,
-				"plane.obj",
-				_indexCount,
-				_vertexBuffer,
-				_indexBuffer
-			)
-		);
+	// Baking evaluates the noise once per texel on every core, off the loading thread,
+	// and the quadtree's min max heights come from the baked top mip
+	auto createMapsTask = concurrency::create_task([this]() {
+		_quadtree.reset();
+		_maps = make_unique<TerrainMaps>(TerrainBakeSettings());
+		_quadtree = make_unique<TerrainQuadtree>(*_maps, TerrainQuadtreeSettings());
+		const auto& maps = *_maps;
+		const auto resolution = maps.GetSettings().resolution;
+		const auto mipCount = maps.GetMipCount();
+
+		vector<D3D11_SUBRESOURCE_DATA> heightData(mipCount);
+		vector<D3D11_SUBRESOURCE_DATA> normalData(mipCount);
+		for (auto mip = 0; mip < mipCount; mip++)
+		{
+			heightData[mip].pSysMem = maps.GetHeights(mip).data();
+			heightData[mip].SysMemPitch = maps.GetMipResolution(mip) * sizeof(float);
+			normalData[mip].pSysMem = maps.GetNormals(mip).data();
+			normalData[mip].SysMemPitch = maps.GetMipResolution(mip) * sizeof(uint32_t);
+		}
+
+		CD3D11_TEXTURE2D_DESC heightDesc(DXGI_FORMAT_R32_FLOAT, resolution, resolution, 1, mipCount, D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_IMMUTABLE);
+		ThrowIfFailed(_device->GetD3DDevice()->CreateTexture2D(&heightDesc, heightData.data(), &_heightMap));
+		ThrowIfFailed(_device->GetD3DDevice()->CreateShaderResourceView(_heightMap.Get(), nullptr, &_heightMapView));
+
+		CD3D11_TEXTURE2D_DESC normalDesc(DXGI_FORMAT_R16G16_SNORM, resolution, resolution, 1, mipCount, D3D11_BIND_SHADER_RESOURCE, D3D11_USAGE_IMMUTABLE);
+		ThrowIfFailed(_device->GetD3DDevice()->CreateTexture2D(&normalDesc, normalData.data(), &_normalMap));
+		ThrowIfFailed(_device->GetD3DDevice()->CreateShaderResourceView(_normalMap.Get(), nullptr, &_normalMapView));
+	});
+
+	// Once both shaders are loaded, create the grid every chunk is drawn with.
+	auto createGridTask = (createPSTask && createVSTask && createHSTask && createDSTask && createMapsTask).then([this]() {
+		const auto gridVertices = _quadtree->BuildGridVertices();
+		D3D11_SUBRESOURCE_DATA vertexBufferData = { 0 };
+		vertexBufferData.pSysMem = gridVertices.data();
+		vertexBufferData.SysMemPitch = 0;
+		vertexBufferData.SysMemSlicePitch = 0;
+		CD3D11_BUFFER_DESC vertexBufferDesc(static_cast<UINT>(gridVertices.size() * sizeof(HLSL::float2)), D3D11_BIND_VERTEX_BUFFER);
+		ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&vertexBufferDesc, &vertexBufferData, &_vertexBuffer));
+
+		// Quarter by quarter, so a chunk drawing one quarter draws one range
+		const auto gridIndices = _quadtree->BuildGridIndices();
+		D3D11_SUBRESOURCE_DATA indexBufferData = { 0 };
+		indexBufferData.pSysMem = gridIndices.data();
+		indexBufferData.SysMemPitch = 0;
+		indexBufferData.SysMemSlicePitch = 0;
+		CD3D11_BUFFER_DESC indexBufferDesc(static_cast<UINT>(gridIndices.size() * sizeof(unsigned int)), D3D11_BIND_INDEX_BUFFER);
+		ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&indexBufferDesc, &indexBufferData, &_indexBuffer));
+
+		// Shared by every chunk
+		const auto& settings = _quadtree->GetSettings();
+		_chunkBufferData.gridDimension = static_cast<float>(settings.gridDimension);
 	});
 
-	(createSphere).then([this]() {
+	(createGridTask).then([this]() {
 		_loadingComplete = true;
 		});
 }
@@ -120,6 +172,11 @@ void Terrain::SetViewProjectionMatrixCB(XMMATRIX& view, XMMATRIX& projection)
 {
 	XMStoreFloat4x4(&_mvpBufferData.view, XMMatrixTranspose(view));
 	XMStoreFloat4x4(&_mvpBufferData.projection, XMMatrixTranspose(projection));
+	XMStoreFloat4x4(&_viewProjection, XMMatrixMultiply(view, projection));
+
+	// Pixels one unit spans one unit in front of the camera, half the output's height times
+	// the projection's [1][1], whichever way the display orientation turned it
+	_targetBufferData.pixelScale = 0.5f * _device->GetOutputSize().Height * XMVectorGetX(XMVector2Length(projection.r[1]));
 }
 
 void Terrain::SetCameraPositionCB(XMFLOAT3& position)
@@ -136,20 +193,23 @@ void Terrain::ReleaseDeviceDependentResources()
 	if (_pixelShader) _pixelShader.Reset();
 	if (_inputLayout) _inputLayout.Reset();
 	if (_mvpBuffer) _mvpBuffer.Reset();
+	if (_cameraBuffer) _cameraBuffer.Reset();
+	if (_chunkBuffer) _chunkBuffer.Reset();
+	if (_targetBuffer) _targetBuffer.Reset();
 	if (_vertexBuffer) _vertexBuffer.Reset();
 	if (_indexBuffer) _indexBuffer.Reset();
 	if (_rasterState) _rasterState.Reset();
+	if (_heightMap) _heightMap.Reset();
+	if (_heightMapView) _heightMapView.Reset();
+	if (_normalMap) _normalMap.Reset();
+	if (_normalMapView) _normalMapView.Reset();
+	if (_samplerState) _samplerState.Reset();
 }
 
 void Terrain::Update(StepTimer const& timer)
 {
-	auto worldMatrix = XMMatrixIdentity();
-
-	worldMatrix = XMMatrixMultiply(worldMatrix, DirectX::XMMatrixScaling(_scale.x, _scale.y, _scale.z));
-	worldMatrix = XMMatrixMultiply(worldMatrix, DirectX::XMMatrixRotationQuaternion(DirectX::XMQuaternionRotationRollPitchYaw(_rotation.x, _rotation.y, _rotation.z)));
-	worldMatrix = XMMatrixMultiply(worldMatrix, DirectX::XMMatrixTranslation(_position.x, _position.y, _position.z));
-
-	XMStoreFloat4x4(&_mvpBufferData.model, XMMatrixTranspose(worldMatrix));
+	// The chunks are placed in world space by VS_Terrain
+	XMStoreFloat4x4(&_mvpBufferData.model, XMMatrixIdentity());
 }
 
 void Terrain::Render()
@@ -163,9 +223,10 @@ void Terrain::Render()
 	// Prepare the constant buffer to send it to the graphics device.
 	context->UpdateSubresource1(_mvpBuffer.Get(), 0, NULL, &_mvpBufferData, 0, 0, 0);
 	context->UpdateSubresource1(_cameraBuffer.Get(), 0, NULL, &_cameraBufferData, 0, 0, 0);
+	context->UpdateSubresource1(_targetBuffer.Get(), 0, NULL, &_targetBufferData, 0, 0, 0);
 
-	// Each vertex is one instance of the VertexPositionColor struct.
-	UINT stride = sizeof(VertexPositionTexcoordNormalTangentBinormal);
+	// Each vertex is a grid position.
+	UINT stride = sizeof(HLSL::float2);
 	UINT offset = 0;
 	context->IASetVertexBuffers(0, 1, _vertexBuffer.GetAddressOf(), &stride, &offset);
 	context->IASetIndexBuffer(_indexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
@@ -173,6 +234,10 @@ void Terrain::Render()
 	// Attach our vertex shader.
 	context->VSSetShader(_vertexShader.Get(), nullptr, 0);
 	context->VSSetConstantBuffers1(0, 1, _mvpBuffer.GetAddressOf(), nullptr, nullptr);
+	context->VSSetConstantBuffers1(1, 1, _cameraBuffer.GetAddressOf(), nullptr, nullptr);
+	context->VSSetConstantBuffers1(2, 1, _chunkBuffer.GetAddressOf(), nullptr, nullptr);
+	context->VSSetShaderResources(0, 1, _heightMapView.GetAddressOf());
+	context->VSSetSamplers(0, 1, _samplerState.GetAddressOf());
 	// Attach our pixel shader.
 	context->PSSetShader(_pixelShader.Get(), nullptr, 0);
 	context->PSSetConstantBuffers1(0, 1, _mvpBuffer.GetAddressOf(), nullptr, nullptr);
@@ -181,11 +246,43 @@ void Terrain::Render()
 	context->GSSetShader(nullptr, nullptr, 0);
 
 	context->HSSetShader(_hullShader.Get(), nullptr, 0);
+	context->HSSetConstantBuffers1(1, 1, _cameraBuffer.GetAddressOf(), nullptr, nullptr);
+	context->HSSetConstantBuffers1(3, 1, _targetBuffer.GetAddressOf(), nullptr, nullptr);
 
 	context->DSSetShader(_domainShader.Get(), nullptr, 0);
 	context->DSSetConstantBuffers1(0, 1, _mvpBuffer.GetAddressOf(), nullptr, nullptr);
 	context->DSSetConstantBuffers1(1, 1, _cameraBuffer.GetAddressOf(), nullptr, nullptr);
+	context->DSSetConstantBuffers1(3, 1, _targetBuffer.GetAddressOf(), nullptr, nullptr);
+	ID3D11ShaderResourceView* maps[] = { _heightMapView.Get(), _normalMapView.Get() };
+	context->DSSetShaderResources(0, ARRAYSIZE(maps), maps);
+	context->DSSetSamplers(0, 1, _samplerState.GetAddressOf());
+
+	// Select the chunks, each a whole node or the quarter of it its finer children leave
+	const auto camera = HLSL::float3(_cameraBufferData.position.x, _cameraBufferData.position.y, _cameraBufferData.position.z);
+	_quadtree->Select(camera, _chunks);
+
+	// A chunk's normal cone is too wide to ever face away (PatchCulling's chunk benchmark culls none), so only the frustum test runs.
+	_chunkBounds.Clear();
+	for (const auto& chunk : _chunks)
+	{
+		const auto size = chunk.quadrant < 0 ? chunk.size : 0.5f * chunk.size;
+		const auto x = chunk.quadrant < 0 ? chunk.x : chunk.x + (chunk.quadrant & 1) * size;
+		const auto z = chunk.quadrant < 0 ? chunk.z : chunk.z + (chunk.quadrant >> 1) * size;
+		_chunkBounds.Add(HLSL::float3(x, chunk.minHeight, z), HLSL::float3(x + size, chunk.maxHeight, z + size));
+	}
+	PatchCullingSettings culling;
+	culling.backface = false;
+	culling.threads = 1;
+	CullPatches(_chunkBounds, MakeCullingFrustum(&_viewProjection.m[0][0]), camera, culling, _visibleChunks);
 
-	// Draw the objects.
-	context->DrawIndexed(_indexCount, 0, 0);
+	for (const auto index : _visibleChunks)
+	{
+		const auto& chunk = _chunks[index];
+		_chunkBufferData.origin = XMFLOAT2(chunk.x, chunk.z);
+		_chunkBufferData.size = chunk.size;
+		_chunkBufferData.morphStart = chunk.morphStart;
+		_chunkBufferData.morphEnd = chunk.morphEnd;
+		context->UpdateSubresource1(_chunkBuffer.Get(), 0, NULL, &_chunkBufferData, 0, 0, 0);
+		context->DrawIndexed(_quadtree->GetGridIndexCount(chunk.quadrant), _quadtree->GetGridIndexStart(chunk.quadrant), 0);
+	}
 }
@@ -4,6 +4,8 @@
 #include "..\Common\StepTimer.h"
 #include "..\Content\ShaderStructures.h"
 #include "ResourceManager.h"
+#include "PatchCulling.h"
+#include "TerrainQuadtree.h"
 
 using namespace DX;
 using namespace std;
@@ -11,6 +13,7 @@ using namespace DirectX;
 using namespace Microsoft::WRL;
 using namespace JG_AdvRend_ACW_2;
 
+// The 40 x 40 terrain, TerrainQuadtree's chunks frustum culled, morphed by VS_Terrain and displaced from TerrainMaps' bake
 class Terrain
 {
 public: // Structors
@@ -36,17 +39,27 @@ private: // Data
 	ComPtr<ID3D11DomainShader> _domainShader;
 	ComPtr<ID3D11PixelShader> _pixelShader;
 	ComPtr<ID3D11RasterizerState> _rasterState;
+	ComPtr<ID3D11Texture2D> _heightMap;
+	ComPtr<ID3D11ShaderResourceView> _heightMapView;
+	ComPtr<ID3D11Texture2D> _normalMap;
+	ComPtr<ID3D11ShaderResourceView> _normalMapView;
+	ComPtr<ID3D11SamplerState> _samplerState;
 	ComPtr<ID3D11Buffer> _mvpBuffer;
 	ComPtr<ID3D11Buffer> _cameraBuffer;
+	ComPtr<ID3D11Buffer> _chunkBuffer;
+	ComPtr<ID3D11Buffer> _targetBuffer;
 
 	ModelViewProjectionConstantBuffer _mvpBufferData;
 	CameraPositionConstantBuffer _cameraBufferData;
-	
-	int _indexCount;
-	bool _loadingComplete;
+	TerrainChunkConstantBuffer _chunkBufferData;
+	TessellationTargetConstantBuffer _targetBufferData;
+	XMFLOAT4X4 _viewProjection;
 
-	XMFLOAT3 _position;
-	XMFLOAT3 _rotation;
-	XMFLOAT3 _scale;
+	unique_ptr<TerrainMaps> _maps;
+	unique_ptr<TerrainQuadtree> _quadtree;
+	vector<TerrainChunk> _chunks;
+	PatchBounds _chunkBounds;
+	vector<uint32_t> _visibleChunks;
+	bool _loadingComplete;
 };
 
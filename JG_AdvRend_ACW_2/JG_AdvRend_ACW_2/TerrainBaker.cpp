@@ -0,0 +1,188 @@
+#include "TerrainBaker.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include "Common/IntegerNoise.h"
+#include "Common/ParallelFor.h"
+
+using namespace HLSL;
+
+namespace
+{
+	double MillisecondsSince(std::chrono::steady_clock::time_point startTime)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+}
+
+float4 EvaluateTerrain(float x, float z, int octaves, float frequency, float amplitude)
+{
+	return fbmd(float3(x, 0.0f, z), octaves, frequency, 2.0f, 0.5f) * amplitude;
+}
+
+TerrainMaps::TerrainMaps(const TerrainBakeSettings& settings)
+	: _settings(settings), _bakeMilliseconds(0.0), _mipMilliseconds(0.0)
+{
+	auto startTime = std::chrono::steady_clock::now();
+	BakeTopMip();
+	_bakeMilliseconds = MillisecondsSince(startTime);
+
+	startTime = std::chrono::steady_clock::now();
+	BuildMips();
+	_mipMilliseconds = MillisecondsSince(startTime);
+}
+
+std::size_t TerrainMaps::GetBytes() const
+{
+	std::size_t bytes = 0;
+	for (auto mip = 0; mip < GetMipCount(); mip++)
+	{
+		bytes += _heights[mip].size() * sizeof(float) + _normals[mip].size() * sizeof(std::uint32_t);
+	}
+	return bytes;
+}
+
+float4 TerrainMaps::Evaluate(float x, float z) const
+{
+	return EvaluateTerrain(x, z, _settings.octaves, _settings.frequency, _settings.amplitude);
+}
+
+float TerrainMaps::Height(float x, float z) const
+{
+	return Evaluate(x, z).x;
+}
+
+float3 TerrainMaps::Normal(float x, float z) const
+{
+	// The plane is y up, so the gradient's x and z are the slope along it
+	const auto n = Evaluate(x, z);
+	return normalize(float3(-n.y, 1.0f, -n.w));
+}
+
+float TerrainMaps::SampleHeight(float x, float z, int mip) const
+{
+	int x0, z0, x1, z1;
+	float fx, fz;
+	Footprint(x, z, mip, x0, z0, x1, z1, fx, fz);
+
+	const auto& heights = _heights[mip];
+	const auto size = GetMipResolution(mip);
+	return lerp(lerp(heights[z0 * size + x0], heights[z0 * size + x1], fx),
+		lerp(heights[z1 * size + x0], heights[z1 * size + x1], fx), fz);
+}
+
+float3 TerrainMaps::SampleNormal(float x, float z, int mip) const
+{
+	int x0, z0, x1, z1;
+	float fx, fz;
+	Footprint(x, z, mip, x0, z0, x1, z1, fx, fz);
+
+	// The GPU filters the stored x and z, then DS_Terrain rebuilds y
+	const auto& normals = _normals[mip];
+	const auto size = GetMipResolution(mip);
+	const auto n00 = UnpackNormal(normals[z0 * size + x0]);
+	const auto n10 = UnpackNormal(normals[z0 * size + x1]);
+	const auto n01 = UnpackNormal(normals[z1 * size + x0]);
+	const auto n11 = UnpackNormal(normals[z1 * size + x1]);
+	const auto nx = lerp(lerp(n00.x, n10.x, fx), lerp(n01.x, n11.x, fx), fz);
+	const auto nz = lerp(lerp(n00.z, n10.z, fx), lerp(n01.z, n11.z, fx), fz);
+	return normalize(float3(nx, std::sqrt(saturate(1.0f - nx * nx - nz * nz)), nz));
+}
+
+std::uint32_t TerrainMaps::PackNormal(const float3& normal)
+{
+	const auto x = static_cast<std::int16_t>(std::lround(clamp(normal.x, -1.0f, 1.0f) * 32767.0f));
+	const auto z = static_cast<std::int16_t>(std::lround(clamp(normal.z, -1.0f, 1.0f) * 32767.0f));
+	return static_cast<std::uint16_t>(x) | static_cast<std::uint32_t>(static_cast<std::uint16_t>(z)) << 16;
+}
+
+float3 TerrainMaps::UnpackNormal(std::uint32_t packed)
+{
+	const auto x = std::max(static_cast<std::int16_t>(packed & 0xffffu) / 32767.0f, -1.0f);
+	const auto z = std::max(static_cast<std::int16_t>(packed >> 16) / 32767.0f, -1.0f);
+	return float3(x, std::sqrt(saturate(1.0f - x * x - z * z)), z);
+}
+
+void TerrainMaps::BakeTopMip()
+{
+	const auto size = _settings.resolution;
+	const auto texelSize = 2.0f * _settings.halfSize / size;
+	_heights.assign(1, std::vector<float>(static_cast<std::size_t>(size) * size));
+	_normals.assign(1, std::vector<std::uint32_t>(static_cast<std::size_t>(size) * size));
+
+	// One noise evaluation per texel gives both maps
+	ParallelFor(0, size, _settings.threads, [&](int row)
+	{
+		const auto z = -_settings.halfSize + (row + 0.5f) * texelSize;
+		for (auto column = 0; column < size; column++)
+		{
+			const auto x = -_settings.halfSize + (column + 0.5f) * texelSize;
+			const auto n = Evaluate(x, z);
+			_heights[0][row * size + column] = n.x;
+			_normals[0][row * size + column] = PackNormal(normalize(float3(-n.y, 1.0f, -n.w)));
+		}
+	}, 8);
+}
+
+void TerrainMaps::BuildMips()
+{
+	for (auto size = _settings.resolution / 2; size >= 1; size /= 2)
+	{
+		const auto& heights = _heights.back();
+		const auto& normals = _normals.back();
+		std::vector<float> mipHeights(static_cast<std::size_t>(size) * size);
+		std::vector<std::uint32_t> mipNormals(static_cast<std::size_t>(size) * size);
+		const auto parentSize = size * 2;
+
+		ParallelFor(0, size, _settings.threads, [&](int row)
+		{
+			for (auto column = 0; column < size; column++)
+			{
+				const auto i00 = (2 * row) * parentSize + 2 * column;
+				const auto i01 = (2 * row + 1) * parentSize + 2 * column;
+				mipHeights[row * size + column] = 0.25f * (heights[i00] + heights[i00 + 1] + heights[i01] + heights[i01 + 1]);
+
+				const auto sum = UnpackNormal(normals[i00]) + UnpackNormal(normals[i00 + 1]) + UnpackNormal(normals[i01]) + UnpackNormal(normals[i01 + 1]);
+				mipNormals[row * size + column] = PackNormal(normalize(sum));
+			}
+		}, 16);
+
+		_heights.push_back(std::move(mipHeights));
+		_normals.push_back(std::move(mipNormals));
+	}
+}
+
+void TerrainMaps::Footprint(float x, float z, int mip, int& x0, int& z0, int& x1, int& z1, float& fx, float& fz) const
+{
+	const auto size = GetMipResolution(mip);
+	// Texel space, centres at whole numbers
+	const auto u = (x / _settings.halfSize + 1.0f) * 0.5f * size - 0.5f;
+	const auto v = (z / _settings.halfSize + 1.0f) * 0.5f * size - 0.5f;
+	const auto u0 = std::floor(u);
+	const auto v0 = std::floor(v);
+	fx = u - u0;
+	fz = v - v0;
+
+	const auto clampTexel = [size](float t) { return std::min(std::max(static_cast<int>(t), 0), size - 1); };
+	x0 = clampTexel(u0);
+	z0 = clampTexel(v0);
+	x1 = clampTexel(u0 + 1.0f);
+	z1 = clampTexel(v0 + 1.0f);
+}
+
+std::vector<float> BakeTerrainHeights(const TerrainBakeSettings& settings)
+{
+	const auto size = settings.resolution;
+	const auto texelSize = 2.0f * settings.halfSize / size;
+	std::vector<float> heights(static_cast<std::size_t>(size) * size);
+	ParallelFor(0, size, settings.threads, [&](int row)
+	{
+		const auto z = -settings.halfSize + (row + 0.5f) * texelSize;
+		for (auto column = 0; column < size; column++)
+		{
+			const auto x = -settings.halfSize + (column + 0.5f) * texelSize;
+			heights[static_cast<std::size_t>(row) * size + column] = EvaluateTerrain(x, z, settings.octaves, settings.frequency, settings.amplitude).x;
+		}
+	}, 8);
+	return heights;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Common/ShaderMath.h"
+
+// Defaults match the constants at the top of DS_Terrain.hlsl
+struct TerrainBakeSettings
+{
+	float halfSize = 20.0f;		// Terrain's 40 x 40 plane about the origin
+	int resolution = 1024;		// texels along each side of the top mip, a power of two
+	// Height is amplitude times fbmd of the noise, one octave of frequency 1 is DS_Terrain's valueNoised
+	int octaves = 1;
+	float frequency = 1.0f;
+	float amplitude = 1.0f;
+	int threads = 0;			// baking, 0 uses every hardware thread
+};
+
+// DS_Terrain's height and normal maps, baked from fbmd of IntegerNoise.h with texel centres spanning the plane
+class TerrainMaps
+{
+public: // Structors
+	explicit TerrainMaps(const TerrainBakeSettings& settings);
+
+public: // Accessors
+	const TerrainBakeSettings& GetSettings() const { return _settings; }
+	int GetMipCount() const { return static_cast<int>(_heights.size()); }
+	int GetMipResolution(int mip) const { return _settings.resolution >> mip; }
+	// Row major with z down the rows, DXGI_FORMAT_R32_FLOAT
+	const std::vector<float>& GetHeights(int mip) const { return _heights[mip]; }
+	// DXGI_FORMAT_R16G16_SNORM holding the normal's x and z, y is up and sqrt(1 - x^2 - z^2)
+	const std::vector<std::uint32_t>& GetNormals(int mip) const { return _normals[mip]; }
+	// Every mip of both maps
+	std::size_t GetBytes() const;
+	double GetBakeMilliseconds() const { return _bakeMilliseconds; }
+	double GetMipMilliseconds() const { return _mipMilliseconds; }
+
+public: // Functions
+	// The procedural surface the maps are baked from, float4(height, gradient)
+	HLSL::float4 Evaluate(float x, float z) const;
+	float Height(float x, float z) const;
+	HLSL::float3 Normal(float x, float z) const;
+
+	// Bilinear with clamped addressing, like DS_Terrain's sampler
+	float SampleHeight(float x, float z, int mip) const;
+	HLSL::float3 SampleNormal(float x, float z, int mip) const;
+
+	static std::uint32_t PackNormal(const HLSL::float3& normal);
+	static HLSL::float3 UnpackNormal(std::uint32_t packed);
+
+private: // Functions
+	void BakeTopMip();
+	// Each texel the average of the four under it, normals renormalised
+	void BuildMips();
+	// Texel coordinates and weights of the bilinear footprint around a point
+	void Footprint(float x, float z, int mip, int& x0, int& z0, int& x1, int& z1, float& fx, float& fz) const;
+
+private: // Data
+	TerrainBakeSettings _settings;
+	std::vector<std::vector<float>> _heights;
+	std::vector<std::vector<std::uint32_t>> _normals;
+	double _bakeMilliseconds;
+	double _mipMilliseconds;
+};
+
+// fbmd of IntegerNoise.h at the point on the plane, float4(height, gradient), what TerrainMaps bakes
+HLSL::float4 EvaluateTerrain(float x, float z, int octaves, float frequency, float amplitude);
+
+// TerrainMaps' top mip of heights alone, for maps too big to keep normals and mips of
+std::vector<float> BakeTerrainHeights(const TerrainBakeSettings& settings);
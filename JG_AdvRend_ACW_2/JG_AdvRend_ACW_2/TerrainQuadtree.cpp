@@ -0,0 +1,212 @@
+#include "TerrainQuadtree.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace HLSL;
+
+TerrainQuadtree::TerrainQuadtree(const TerrainMaps& maps, const TerrainQuadtreeSettings& settings)
+	: _maps(maps), _settings(settings), _rootSize(2.0f * maps.GetSettings().halfSize)
+{
+	BuildHeightRanges();
+}
+
+float TerrainQuadtree::GetNodeSize(int level) const
+{
+	return _rootSize / static_cast<float>(1 << (_settings.levels - 1 - level));
+}
+
+float TerrainQuadtree::GetRange(int level) const
+{
+	return _settings.lodRange * static_cast<float>(1 << level);
+}
+
+int TerrainQuadtree::GetGridIndexStart(int quadrant) const
+{
+	return quadrant < 0 ? 0 : quadrant * GetGridIndexCount(0);
+}
+
+int TerrainQuadtree::GetGridIndexCount(int quadrant) const
+{
+	const auto quads = _settings.gridDimension * _settings.gridDimension;
+	return 6 * (quadrant < 0 ? quads : quads / 4);
+}
+
+void TerrainQuadtree::Select(const float3& camera, std::vector<TerrainChunk>& chunks) const
+{
+	chunks.clear();
+
+	// Beyond even the root's range the whole terrain is drawn at the coarsest level
+	const auto top = _settings.levels - 1;
+	if (!SelectNode(top, 0, 0, camera, chunks)) chunks.push_back(MakeChunk(top, 0, 0, -1));
+}
+
+float2 TerrainQuadtree::MorphVertex(const TerrainChunk& chunk, const float2& gridPosition, const float3& camera) const
+{
+	const auto vertex = float2(chunk.x, chunk.z) + gridPosition * chunk.size;
+	const auto k = MorphFactor(chunk, vertex, camera);
+
+	// Odd vertices slide onto their even neighbour, halving the grid
+	const auto dimension = static_cast<float>(_settings.gridDimension);
+	const auto halfGrid = gridPosition * (dimension * 0.5f);
+	const auto fracPart = float2(frac(halfGrid.x), frac(halfGrid.y)) * (2.0f / dimension);
+	return vertex - fracPart * (chunk.size * k);
+}
+
+float TerrainQuadtree::MorphFactor(const TerrainChunk& chunk, const float2& position, const float3& camera) const
+{
+	const auto height = _maps.SampleHeight(position.x, position.y, 0);
+	const auto distance = length(float3(position.x, height, position.y) - camera);
+	return saturate((distance - chunk.morphStart) / (chunk.morphEnd - chunk.morphStart));
+}
+
+int TerrainQuadtree::GetTriangleCount(const TerrainChunk& chunk) const
+{
+	return GetGridIndexCount(chunk.quadrant) / 3;
+}
+
+std::vector<float2> TerrainQuadtree::BuildGridVertices() const
+{
+	const auto dimension = _settings.gridDimension;
+	std::vector<float2> vertices;
+	vertices.reserve((dimension + 1) * (dimension + 1));
+	for (auto z = 0; z <= dimension; z++)
+	{
+		for (auto x = 0; x <= dimension; x++)
+		{
+			vertices.push_back(float2(static_cast<float>(x), static_cast<float>(z)) / static_cast<float>(dimension));
+		}
+	}
+	return vertices;
+}
+
+std::vector<unsigned int> TerrainQuadtree::BuildGridIndices() const
+{
+	const auto dimension = _settings.gridDimension;
+	const auto half = dimension / 2;
+	std::vector<unsigned int> indices;
+	indices.reserve(GetGridIndexCount(-1));
+	for (auto quadrant = 0; quadrant < 4; quadrant++)
+	{
+		const auto startX = (quadrant & 1) * half;
+		const auto startZ = (quadrant >> 1) * half;
+		for (auto z = startZ; z < startZ + half; z++)
+		{
+			for (auto x = startX; x < startX + half; x++)
+			{
+				const unsigned int corner = z * (dimension + 1) + x;
+				const unsigned int row = dimension + 1;
+				indices.insert(indices.end(), { corner, corner + row, corner + 1, corner + 1, corner + row, corner + row + 1 });
+			}
+		}
+	}
+	return indices;
+}
+
+void TerrainQuadtree::BuildHeightRanges()
+{
+	const auto& heights = _maps.GetHeights(0);
+	const auto resolution = _maps.GetMipResolution(0);
+	const auto leaves = 1 << (_settings.levels - 1);
+
+	// Leaves take every texel whose bilinear footprint reaches into them, one past each side
+	_heightRanges.assign(_settings.levels, std::vector<HeightRange>());
+	_heightRanges[0].resize(leaves * leaves);
+	for (auto z = 0; z < leaves; z++)
+	{
+		for (auto x = 0; x < leaves; x++)
+		{
+			const auto first = [resolution, leaves](int i) { return std::max(i * resolution / leaves - 1, 0); };
+			const auto last = [resolution, leaves](int i) { return std::min((i + 1) * resolution / leaves, resolution - 1); };
+
+			HeightRange range = { 1e30f, -1e30f };
+			for (auto row = first(z); row <= last(z); row++)
+			{
+				for (auto column = first(x); column <= last(x); column++)
+				{
+					const auto height = heights[row * resolution + column];
+					range.minHeight = std::min(range.minHeight, height);
+					range.maxHeight = std::max(range.maxHeight, height);
+				}
+			}
+			_heightRanges[0][z * leaves + x] = range;
+		}
+	}
+
+	for (auto level = 1; level < _settings.levels; level++)
+	{
+		const auto nodes = leaves >> level;
+		const auto& children = _heightRanges[level - 1];
+		auto& ranges = _heightRanges[level];
+		ranges.resize(nodes * nodes);
+		for (auto z = 0; z < nodes; z++)
+		{
+			for (auto x = 0; x < nodes; x++)
+			{
+				HeightRange range = { 1e30f, -1e30f };
+				for (auto child = 0; child < 4; child++)
+				{
+					const auto& childRange = children[(2 * z + (child >> 1)) * nodes * 2 + 2 * x + (child & 1)];
+					range.minHeight = std::min(range.minHeight, childRange.minHeight);
+					range.maxHeight = std::max(range.maxHeight, childRange.maxHeight);
+				}
+				ranges[z * nodes + x] = range;
+			}
+		}
+	}
+}
+
+bool TerrainQuadtree::SelectNode(int level, int x, int z, const float3& camera, std::vector<TerrainChunk>& chunks) const
+{
+	const auto distance = DistanceToNode(level, x, z, camera);
+	if (distance > GetRange(level)) return false;
+
+	// Leaves, and nodes the next range in does not reach, are drawn whole
+	if (level == 0 || distance > GetRange(level - 1))
+	{
+		chunks.push_back(MakeChunk(level, x, z, -1));
+		return true;
+	}
+
+	// Children out of the next range's reach are drawn as this node's quarters
+	for (auto quadrant = 0; quadrant < 4; quadrant++)
+	{
+		if (!SelectNode(level - 1, 2 * x + (quadrant & 1), 2 * z + (quadrant >> 1), camera, chunks))
+		{
+			chunks.push_back(MakeChunk(level, x, z, quadrant));
+		}
+	}
+	return true;
+}
+
+float TerrainQuadtree::DistanceToNode(int level, int x, int z, const float3& camera) const
+{
+	const auto size = GetNodeSize(level);
+	const auto nodes = 1 << (_settings.levels - 1 - level);
+	const auto& range = _heightRanges[level][z * nodes + x];
+	const auto halfSize = 0.5f * _rootSize;
+
+	const float3 boxMin(-halfSize + x * size, range.minHeight, -halfSize + z * size);
+	const float3 boxMax(boxMin.x + size, range.maxHeight, boxMin.z + size);
+	const auto nearest = float3(clamp(camera.x, boxMin.x, boxMax.x), clamp(camera.y, boxMin.y, boxMax.y), clamp(camera.z, boxMin.z, boxMax.z));
+	return length(camera - nearest);
+}
+
+TerrainChunk TerrainQuadtree::MakeChunk(int level, int x, int z, int quadrant) const
+{
+	const auto size = GetNodeSize(level);
+	const auto halfSize = 0.5f * _rootSize;
+	const auto previousRange = level > 0 ? GetRange(level - 1) : 0.0f;
+	const auto& range = _heightRanges[level][z * (1 << (_settings.levels - 1 - level)) + x];
+
+	TerrainChunk chunk;
+	chunk.x = -halfSize + x * size;
+	chunk.z = -halfSize + z * size;
+	chunk.size = size;
+	chunk.level = level;
+	chunk.quadrant = quadrant;
+	chunk.morphEnd = GetRange(level);
+	chunk.morphStart = previousRange + (chunk.morphEnd - previousRange) * _settings.morphStartRatio;
+	chunk.minHeight = range.minHeight;
+	chunk.maxHeight = range.maxHeight;
+	return chunk;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <vector>
+#include "TerrainBaker.h"
+
+// Defaults match Terrain's 40 x 40 plane
+struct TerrainQuadtreeSettings
+{
+	int levels = 4;					// leaves are the terrain's size over 2^(levels - 1)
+	int gridDimension = 16;			// quads along each side of the shared grid mesh, a power of two of 4 or more
+	float lodRange = 10.0f;			// distance within which leaves are drawn, doubling each level up
+	float morphStartRatio = 0.66f;	// morphing to the next level up starts this far from the last range to this one
+};
+
+// A node drawn with the shared grid mesh scaled over it, or one quarter of it
+struct TerrainChunk
+{
+	float x;				// the node's corner at its least x and z
+	float z;
+	float size;
+	int level;				// 0 for leaves
+	int quadrant;			// -1 for the whole node, else x + 2z of the quarter drawn
+	float morphStart;		// distances over which the vertices move to the next level up's grid
+	float morphEnd;
+	float minHeight;		// the node's heights, its box with x, z and size
+	float maxHeight;
+};
+
+// CDLOD (Strugar, 2010) over min max height boxes, vertices morphing onto the next level's grid through each range's outer part
+class TerrainQuadtree
+{
+public: // Structors
+	TerrainQuadtree(const TerrainMaps& maps, const TerrainQuadtreeSettings& settings);
+
+public: // Accessors
+	const TerrainQuadtreeSettings& GetSettings() const { return _settings; }
+	const TerrainMaps& GetMaps() const { return _maps; }
+	float GetNodeSize(int level) const;
+	float GetRange(int level) const;
+	// Index range of a chunk's quadrant (-1 for the whole grid) in BuildGridIndices
+	int GetGridIndexStart(int quadrant) const;
+	int GetGridIndexCount(int quadrant) const;
+
+public: // Functions
+	// Chunks to draw from the camera, tiling the terrain
+	void Select(const HLSL::float3& camera, std::vector<TerrainChunk>& chunks) const;
+
+	// VS_Terrain's morph of a grid vertex, gridPosition in [0, 1] across the node
+	HLSL::float2 MorphVertex(const TerrainChunk& chunk, const HLSL::float2& gridPosition, const HLSL::float3& camera) const;
+	float MorphFactor(const TerrainChunk& chunk, const HLSL::float2& position, const HLSL::float3& camera) const;
+
+	int GetTriangleCount(const TerrainChunk& chunk) const;
+
+	// The shared grid: (gridDimension + 1)^2 positions in [0, 1] and triangle indices
+	// ordered quarter by quarter, so each quarter is a contiguous range
+	std::vector<HLSL::float2> BuildGridVertices() const;
+	std::vector<unsigned int> BuildGridIndices() const;
+
+private: // Types
+	struct HeightRange
+	{
+		float minHeight;
+		float maxHeight;
+	};
+
+private: // Functions
+	void BuildHeightRanges();
+	// False when the node is beyond its range, so its parent draws its area instead
+	bool SelectNode(int level, int x, int z, const HLSL::float3& camera, std::vector<TerrainChunk>& chunks) const;
+	float DistanceToNode(int level, int x, int z, const HLSL::float3& camera) const;
+	TerrainChunk MakeChunk(int level, int x, int z, int quadrant) const;
+
+private: // Data
+	const TerrainMaps& _maps;
+	TerrainQuadtreeSettings _settings;
+	float _rootSize;
+	// Per level, leaves first, nodes row major
+	std::vector<std::vector<HeightRange>> _heightRanges;
+};
@@ -0,0 +1,242 @@
+#include "TerrainTileService.h"
+#include <algorithm>
+#include <cmath>
+#include "Common/ParallelFor.h"
+#include "TerrainBaker.h"
+
+using namespace HLSL;
+
+namespace
+{
+	double MillisecondsBetween(std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime)
+	{
+		return std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	}
+
+	// World coordinate of sample index i counted from the origin, so shared edge samples are the same float
+	float SamplePosition(long long i, const TerrainTileSettings& settings)
+	{
+		return static_cast<float>(i * (static_cast<double>(settings.tileSize) / (settings.resolution - 1)));
+	}
+}
+
+TerrainTileService::TerrainTileService(const TerrainTileSettings& settings)
+	: _settings(settings),
+	_tileBytes(static_cast<std::size_t>(settings.resolution) * settings.resolution * (sizeof(float) + sizeof(std::uint32_t))),
+	_frame(0), _inFlight(0), _requests(settings.maxInFlight), _finished(settings.maxInFlight), _queuedRequests(0), _stopping(false)
+{
+	const auto threads = settings.threads > 0 ? settings.threads : std::max(1, ResolveThreadCount(0) - 1);
+	for (auto i = 0; i < threads; i++) _workers.emplace_back([this]() { WorkerLoop(); });
+}
+
+TerrainTileService::~TerrainTileService()
+{
+	{
+		std::lock_guard<std::mutex> lock(_wakeMutex);
+		_stopping = true;
+	}
+	_wake.notify_all();
+	for (auto& worker : _workers) worker.join();
+
+	TerrainTile* tile;
+	while (_finished.TryPop(tile)) delete tile;
+}
+
+std::uint64_t TerrainTileService::Key(int x, int z)
+{
+	return static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32 | static_cast<std::uint32_t>(z);
+}
+
+template<typename Visit>
+void TerrainTileService::ForTilesAround(const float3& point, float radius, const Visit& visit) const
+{
+	const auto size = _settings.tileSize;
+	const auto lowX = static_cast<int>(std::floor((point.x - radius) / size));
+	const auto highX = static_cast<int>(std::floor((point.x + radius) / size));
+	const auto lowZ = static_cast<int>(std::floor((point.z - radius) / size));
+	const auto highZ = static_cast<int>(std::floor((point.z + radius) / size));
+
+	struct Candidate
+	{
+		float distanceSquared;
+		int x, z;
+	};
+	std::vector<Candidate> tiles;
+	for (auto z = lowZ; z <= highZ; z++)
+	{
+		for (auto x = lowX; x <= highX; x++)
+		{
+			// From the point to the nearest point of the tile's square
+			const auto dx = std::max(std::max(x * size - point.x, point.x - (x + 1) * size), 0.0f);
+			const auto dz = std::max(std::max(z * size - point.z, point.z - (z + 1) * size), 0.0f);
+			const auto distanceSquared = dx * dx + dz * dz;
+			if (distanceSquared <= radius * radius) tiles.push_back({ distanceSquared, x, z });
+		}
+	}
+	std::sort(tiles.begin(), tiles.end(), [](const Candidate& a, const Candidate& b) { return a.distanceSquared < b.distanceSquared; });
+	for (const auto& tile : tiles) visit(tile.x, tile.z);
+}
+
+bool TerrainTileService::Request(int x, int z, TerrainTileFrameStats& stats)
+{
+	const auto key = Key(x, z);
+	if (_inFlight >= _settings.maxInFlight || !_requests.TryPush(key)) return false;
+
+	auto& entry = _entries[key];
+	entry.requestTime = std::chrono::steady_clock::now();
+	entry.neededFrame = -1;
+	_inFlight++;
+	stats.requestedTiles++;
+	{
+		std::lock_guard<std::mutex> lock(_wakeMutex);
+		_queuedRequests++;
+	}
+	_wake.notify_one();
+	return true;
+}
+
+void TerrainTileService::WorkerLoop()
+{
+	for (;;)
+	{
+		std::uint64_t key;
+		if (_requests.TryPop(key))
+		{
+			_queuedRequests--;
+			auto* tile = new TerrainTile();
+			Generate(_settings, static_cast<std::int32_t>(key >> 32), static_cast<std::int32_t>(key & 0xffffffffu), *tile);
+			// There is room for every request in flight, so this only waits on a slot being released
+			while (!_finished.TryPush(tile)) std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_wakeMutex);
+		_wake.wait(lock, [this]() { return _stopping || _queuedRequests > 0; });
+		if (_stopping) return;
+	}
+}
+
+TerrainTileFrameStats TerrainTileService::Update(const float3& position, const float3& velocity)
+{
+	TerrainTileFrameStats stats = {};
+	_frame++;
+
+	// Finished tiles join the cache as the most recently used
+	const auto now = std::chrono::steady_clock::now();
+	TerrainTile* tile;
+	while (_finished.TryPop(tile))
+	{
+		const auto key = Key(tile->x, tile->z);
+		auto& entry = _entries[key];
+		entry.tile.reset(tile);
+		_lru.push_front(key);
+		entry.lru = _lru.begin();
+		_inFlight--;
+
+		const auto latency = MillisecondsBetween(entry.requestTime, now);
+		stats.finishedTiles++;
+		stats.latencyMilliseconds += latency;
+		stats.maxLatencyMilliseconds = std::max(stats.maxLatencyMilliseconds, latency);
+		stats.generateMilliseconds += tile->generateMilliseconds;
+	}
+
+	ForTilesAround(position, _settings.viewRadius, [&](int x, int z)
+	{
+		stats.neededTiles++;
+		const auto found = _entries.find(Key(x, z));
+		if (found == _entries.end())
+		{
+			if (Request(x, z, stats)) _entries[Key(x, z)].neededFrame = _frame;
+			stats.waited = true;
+			return;
+		}
+		found->second.neededFrame = _frame;
+		if (!found->second.tile)
+		{
+			stats.waited = true;
+			return;
+		}
+		stats.readyTiles++;
+		_lru.splice(_lru.begin(), _lru, found->second.lru);
+	});
+
+	// Where the camera will be, a tile apart, requested after everything needed now
+	const auto distance = std::sqrt(velocity.x * velocity.x + velocity.z * velocity.z) * _settings.prefetchSeconds;
+	if (distance > 0.0f)
+	{
+		const auto points = std::min(32, static_cast<int>(std::ceil(distance / _settings.tileSize)));
+		for (auto i = 1; i <= points; i++)
+		{
+			const auto ahead = position + velocity * (_settings.prefetchSeconds * i / points);
+			ForTilesAround(ahead, _settings.viewRadius, [&](int x, int z)
+			{
+				if (_entries.find(Key(x, z)) == _entries.end()) Request(x, z, stats);
+			});
+		}
+	}
+
+	// Least recently needed first, stopping at the tiles this frame needs
+	while (GetCachedBytes() > _settings.memoryBytes)
+	{
+		const auto entry = _entries.find(_lru.back());
+		if (entry->second.neededFrame == _frame) break;
+		_lru.pop_back();
+		_entries.erase(entry);
+		stats.evictedTiles++;
+	}
+	return stats;
+}
+
+void TerrainTileService::Preload(const float3& position)
+{
+	while (Update(position, float3(0.0f, 0.0f, 0.0f)).waited) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+const TerrainTile* TerrainTileService::FindTile(int x, int z) const
+{
+	const auto found = _entries.find(Key(x, z));
+	return found != _entries.end() ? found->second.tile.get() : nullptr;
+}
+
+bool TerrainTileService::SampleHeight(float x, float z, float& height) const
+{
+	const auto cells = _settings.resolution - 1;
+	const auto tileX = static_cast<int>(std::floor(x / _settings.tileSize));
+	const auto tileZ = static_cast<int>(std::floor(z / _settings.tileSize));
+	const auto* tile = FindTile(tileX, tileZ);
+	if (!tile) return false;
+
+	// Samples from the tile's first, in double as they are placed
+	const auto spacing = static_cast<double>(_settings.tileSize) / cells;
+	const auto u = clamp(static_cast<float>(x / spacing - static_cast<double>(tileX) * cells), 0.0f, static_cast<float>(cells));
+	const auto v = clamp(static_cast<float>(z / spacing - static_cast<double>(tileZ) * cells), 0.0f, static_cast<float>(cells));
+	const auto column = std::min(static_cast<int>(u), cells - 1);
+	const auto row = std::min(static_cast<int>(v), cells - 1);
+	const auto* heights = &tile->heights[static_cast<std::size_t>(row) * _settings.resolution + column];
+	const auto fx = u - column;
+	const auto fz = v - row;
+	height = lerp(lerp(heights[0], heights[1], fx), lerp(heights[_settings.resolution], heights[_settings.resolution + 1], fx), fz);
+	return true;
+}
+
+void TerrainTileService::Generate(const TerrainTileSettings& settings, int x, int z, TerrainTile& tile)
+{
+	const auto startTime = std::chrono::steady_clock::now();
+	const auto size = settings.resolution;
+	const auto cells = static_cast<long long>(size - 1);
+	tile.x = x;
+	tile.z = z;
+	tile.heights.resize(static_cast<std::size_t>(size) * size);
+	tile.normals.resize(static_cast<std::size_t>(size) * size);
+	for (auto row = 0; row < size; row++)
+	{
+		const auto sampleZ = SamplePosition(z * cells + row, settings);
+		for (auto column = 0; column < size; column++)
+		{
+			const auto n = EvaluateTerrain(SamplePosition(x * cells + column, settings), sampleZ, settings.octaves, settings.frequency, settings.amplitude);
+			tile.heights[row * size + column] = n.x;
+			tile.normals[row * size + column] = TerrainMaps::PackNormal(normalize(float3(-n.y, 1.0f, -n.w)));
+		}
+	}
+	tile.generateMilliseconds = MillisecondsBetween(startTime, std::chrono::steady_clock::now());
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Common/LockFreeQueue.h"
+#include "Common/ShaderMath.h"
+
+struct TerrainTileSettings
+{
+	float tileSize = 16.0f;			// world units along each side
+	int resolution = 129;			// samples along each side, the edge rows shared with the neighbours
+	// EvaluateTerrain's, broader and higher than Terrain's plane for ground flown over
+	int octaves = 6;
+	float frequency = 0.05f;
+	float amplitude = 8.0f;
+	float viewRadius = 48.0f;		// tiles within this of the camera in xz are needed for the frame
+	float prefetchSeconds = 1.0f;	// how far ahead along the camera's velocity tiles are requested, 0 for none
+	std::size_t memoryBytes = 32u << 20;	// cap on the cached tiles, the frame's needed ones are kept over it
+	int threads = 0;				// generating, 0 uses every hardware thread but the render thread's
+	int maxInFlight = 256;			// requests handed to the workers and not yet back
+};
+
+struct TerrainTile
+{
+	int x, z;						// covers [x, x + 1) x [z, z + 1) tileSize
+	std::vector<float> heights;		// resolution x resolution, row major with z down the rows
+	std::vector<std::uint32_t> normals;	// TerrainMaps::PackNormal's
+	double generateMilliseconds;	// on the worker
+};
+
+struct TerrainTileFrameStats
+{
+	int neededTiles;
+	int readyTiles;					// of the needed ones, in the cache
+	int requestedTiles;				// handed to the workers this frame, needed and prefetched
+	int finishedTiles;				// taken back from the workers this frame
+	int evictedTiles;
+	// Over the finished tiles, from the request to the render thread taking the tile
+	double latencyMilliseconds;		// summed
+	double maxLatencyMilliseconds;
+	double generateMilliseconds;	// summed
+	bool waited;					// a needed tile wasn't ready, so the frame would stall or draw a hole
+};
+
+// Procedural terrain tiles generated by worker threads into an LRU cache updated once a frame, headless until the app draws them
+class TerrainTileService
+{
+public: // Structors
+	explicit TerrainTileService(const TerrainTileSettings& settings);
+	~TerrainTileService();
+	TerrainTileService(const TerrainTileService&) = delete;
+	TerrainTileService& operator=(const TerrainTileService&) = delete;
+
+public: // Accessors
+	const TerrainTileSettings& GetSettings() const { return _settings; }
+	int GetThreadCount() const { return static_cast<int>(_workers.size()); }
+	int GetCachedTileCount() const { return static_cast<int>(_lru.size()); }
+	std::size_t GetCachedBytes() const { return _lru.size() * _tileBytes; }
+	std::size_t GetTileBytes() const { return _tileBytes; }
+
+public: // Functions
+	// Velocity in units a second, the tiles it leads to over prefetchSeconds requested after the needed ones
+	TerrainTileFrameStats Update(const HLSL::float3& position, const HLSL::float3& velocity);
+	// Updates until every tile needed at the position is ready, for loading before the first frame
+	void Preload(const HLSL::float3& position);
+	// Null until the tile is generated and after it is evicted
+	const TerrainTile* FindTile(int x, int z) const;
+	// Bilinear height from the cached tile under the point, false when it isn't cached
+	bool SampleHeight(float x, float z, float& height) const;
+
+	// Tile (x, z) as the workers make it
+	static void Generate(const TerrainTileSettings& settings, int x, int z, TerrainTile& tile);
+
+private: // Types
+	struct Entry
+	{
+		std::unique_ptr<TerrainTile> tile;	// null while the workers have it
+		std::chrono::steady_clock::time_point requestTime;
+		std::list<std::uint64_t>::iterator lru;
+		long long neededFrame;				// the last frame it was needed in
+	};
+
+private: // Functions
+	static std::uint64_t Key(int x, int z);
+	// Calls visit(x, z) for each tile within radius of the point in xz, nearest first
+	template<typename Visit>
+	void ForTilesAround(const HLSL::float3& point, float radius, const Visit& visit) const;
+	// False when too many requests are in flight
+	bool Request(int x, int z, TerrainTileFrameStats& stats);
+	void WorkerLoop();
+
+private: // Data
+	TerrainTileSettings _settings;
+	std::size_t _tileBytes;
+	std::unordered_map<std::uint64_t, Entry> _entries;	// cached and requested tiles
+	std::list<std::uint64_t> _lru;						// cached tiles, most recently needed first
+	long long _frame;
+	int _inFlight;
+
+	LockFreeQueue<std::uint64_t> _requests;
+	LockFreeQueue<TerrainTile*> _finished;
+	std::atomic<int> _queuedRequests;
+	std::atomic<bool> _stopping;
+	std::mutex _wakeMutex;
+	std::condition_variable _wake;
+	std::vector<std::thread> _workers;
+};
@@ -0,0 +1,55 @@
+//Tessellation factors from projected size, mirrored on the CPU by Common/TessellationFactor.h.
+//
+//An edge is split into as many segments as its projected length in pixels over the target length of a
+//segment. The projected length is that of a sphere with the edge as its diameter, seen at the distance of
+//its centre, which does not change as the camera turns, so factors don't swim. Every patch sharing an
+//edge computes its factor from the edge's two end points alone, ordered the same way whichever patch
+//asks, so the factors are the same bits and the tessellated vertices along it meet without cracks.
+
+//Pixels one unit covers one unit in front of the camera: the viewport's height in pixels over
+//2 tan(fovY / 2), or half the height times the projection's [1][1]
+struct TessellationTarget
+{
+	float pixelScale;
+	float edgePixels;		//wanted length of a tessellated segment, in pixels
+	float maxFactor;		//the hull shader's maxtessfactor
+};
+
+//Pixels a length at a point spans on screen, however it is turned
+float projectedPixels(float3 centre, float worldLength, float3 cameraPosition, TessellationTarget target)
+{
+	return worldLength * target.pixelScale / max(distance(centre, cameraPosition), 1e-4);
+}
+
+float screenSpaceFactor(float pixels, TessellationTarget target)
+{
+	return clamp(pixels / target.edgePixels, 1.0, target.maxFactor);
+}
+
+//The lesser of two points, by x then y then z, comes first
+void orderEdge(inout float3 p0, inout float3 p1)
+{
+	bool swap = p0.x > p1.x || (p0.x == p1.x && (p0.y > p1.y || (p0.y == p1.y && p0.z > p1.z)));
+	float3 first = swap ? p1 : p0;
+	p1 = swap ? p0 : p1;
+	p0 = first;
+}
+
+//The factor of the straight edge from p0 to p1, the same bits for p1 to p0
+float edgeTessellationFactor(float3 p0, float3 p1, float3 cameraPosition, TessellationTarget target)
+{
+	orderEdge(p0, p1);
+	return screenSpaceFactor(projectedPixels((p0 + p1) * 0.5, length(p1 - p0), cameraPosition, target), target);
+}
+
+//Edge i of a triangle patch is the one opposite control point i, the inside factor the largest edge's
+//so no edge is finer than the interior
+float4 triangleTessellationFactors(float3 p0, float3 p1, float3 p2, float3 cameraPosition, TessellationTarget target)
+{
+	float4 factors;
+	factors.x = edgeTessellationFactor(p1, p2, cameraPosition, target);
+	factors.y = edgeTessellationFactor(p2, p0, cameraPosition, target);
+	factors.z = edgeTessellationFactor(p0, p1, cameraPosition, target);
+	factors.w = max(factors.x, max(factors.y, factors.z));
+	return factors;
+}
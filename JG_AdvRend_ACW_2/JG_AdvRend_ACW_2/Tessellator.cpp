@@ -0,0 +1,815 @@
+#include "Tessellator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Common/TessellationFactor.h"
+
+using namespace HLSL;
+
+namespace
+{
+	// 16.16 fixed point, as the tessellator places points in
+	typedef std::int32_t Fixed;
+	const int FractionBits = 16;
+	const Fixed FixedOne = 1 << FractionBits;
+	const Fixed FixedHalf = 0x00008000;
+	const Fixed FixedOneThird = 0x00005555;
+	const Fixed FixedTwoThirds = 0x0000aaaa;
+	const Fixed FixedFractionMask = 0x0000ffff;
+	const Fixed FixedIntegerMask = 0x7fff0000;
+
+	const float MinOddFactor = 1.0f;
+	const float MaxOddFactor = 63.0f;
+	const float MinEvenFactor = 2.0f;
+	const float MaxEvenFactor = 64.0f;
+	const float FixedEpsilon = 1.0f / 65536.0f;		// the least fixed point fraction
+
+	enum Parity { Even, Odd };
+
+	enum Diagonals { InsideToOutside, Mirrored };
+
+	Fixed ToFixed(float value)
+	{
+		return static_cast<Fixed>(value * FixedOne + 0.5f);
+	}
+
+	float ToFloat(Fixed value)
+	{
+		return static_cast<float>(value) / FixedOne;
+	}
+
+	Fixed FixedFloor(Fixed value)
+	{
+		return value & FixedIntegerMask;
+	}
+
+	Fixed FixedCeil(Fixed value)
+	{
+		return (value & FixedFractionMask) ? (value & FixedIntegerMask) + FixedOne : value;
+	}
+
+	// 1 / n in fixed point, for n segments
+	Fixed FixedReciprocal(int n)
+	{
+		return n > 0 ? (FixedOne + n / 2) / n : -1;
+	}
+
+	int RemoveMostSignificantBit(int value)
+	{
+		for (auto bit = 30; bit >= 0; bit--)
+		{
+			if (value & (1 << bit)) return value & ~(1 << bit);
+		}
+		return 0;
+	}
+
+	bool IsEven(float value)
+	{
+		return (static_cast<int>(value) & 1) == 0;
+	}
+
+	// Where vertex i of a half edge ends up at the largest factor, splitting in ruler function
+	// order. Vertices are added or moved on an edge in this order as its factor grows, and the
+	// transition stitching advances along a row whenever the row has reached vertex i.
+	const int FinalPointPosition[33] =
+	{
+		0, 32, 16, 8, 17, 4, 18, 9, 19, 2, 20, 10, 21, 5, 22, 11, 23,
+		1, 24, 12, 25, 6, 26, 13, 27, 3, 28, 14, 29, 7, 30, 15, 31
+	};
+
+	// Culls, clamps and rounds the factors as the tessellator does before anything else.
+	// False for a culled patch.
+	bool ProcessFactors(TessellatorDomain domain, TessellatorPartitioning partitioning, const TessellationFactors& factors, float edges[4], float inside[2])
+	{
+		const auto edgeCount = domain == TessellatorDomain::Triangle ? 3 : 4;
+		const auto insideCount = domain == TessellatorDomain::Triangle ? 1 : 2;
+		for (auto i = 0; i < edgeCount; i++)
+		{
+			// NaN is culled too
+			if (!(factors.edges[i] > 0.0f)) return false;
+		}
+
+		auto lower = MinOddFactor;
+		auto upper = MaxOddFactor;
+		if (partitioning == TessellatorPartitioning::Integer) upper = MaxEvenFactor;
+		if (partitioning == TessellatorPartitioning::FractionalEven)
+		{
+			lower = MinEvenFactor;
+			upper = MaxEvenFactor;
+		}
+
+		// Written so NaN goes to the lower bound
+		const auto clampFactor = [&](float factor)
+		{
+			factor = factor > lower ? factor : lower;
+			factor = factor < upper ? factor : upper;
+			return partitioning == TessellatorPartitioning::Integer ? std::ceil(factor) : factor;
+		};
+
+		std::fill(edges, edges + 4, 0.0f);
+		std::fill(inside, inside + 2, 0.0f);
+		for (auto i = 0; i < edgeCount; i++) edges[i] = clampFactor(factors.edges[i]);
+
+		// When any factor rounds above 1, the inside ones are kept above 1 so there is a ring
+		// of inside points for the edges to stitch to. Only a quad's inside factors count,
+		// a triangle's one is left for the edges to decide.
+		if (partitioning == TessellatorPartitioning::FractionalOdd)
+		{
+			const auto threshold = MinOddFactor + 0.5f * FixedEpsilon;
+			auto frame = false;
+			for (auto i = 0; i < edgeCount; i++) frame = frame || edges[i] > threshold;
+			if (domain == TessellatorDomain::Quad) frame = frame || factors.inside[0] > threshold || factors.inside[1] > threshold;
+			if (frame) lower = MinOddFactor + FixedEpsilon;
+		}
+		for (auto i = 0; i < insideCount; i++) inside[i] = clampFactor(factors.inside[i]);
+		return true;
+	}
+
+	// Reference tessellator state for one patch, writing straight into the patch
+	class PatchBuilder
+	{
+	public:
+		PatchBuilder(TessellatorPartitioning partitioning, TessellatedPatch& patch);
+
+		void BuildTriangle(const float edges[3], float inside);
+		void BuildQuad(const float edges[4], const float inside[2]);
+		// Points the outer ring has, which the builders define first, after building as it changes the parity
+		int OuterRingPoints(const float edges[], int edgeCount);
+
+	private:
+		struct FactorContext
+		{
+			Fixed halfFactorFraction;
+			int halfFactorPoints;
+			int splitPoint;				// where the floor half factor's points start to lag the ceiling's
+			Fixed inverseFloorSegments;
+			Fixed inverseCeilSegments;
+		};
+
+		// Remaps indices of the last edge of a ring, which wraps around to the ring's first point
+		struct RingWrap
+		{
+			int insideDelta;
+			int insideStep;				// -1 where a degenerate ring's row comes back the other way
+			int insideLast;
+			int insideFirst;
+			int outsideBase;
+			int outsideDelta;
+			int outsideLast;
+			int outsideFirst;
+		};
+
+		// Remaps indices of a quad's middle strip, whose inside row runs backwards
+		struct StripInversion
+		{
+			int invertFrom;
+			int cornerBad;
+			int cornerReplacement;
+			int inversionEnd;
+		};
+
+		Parity OriginalParity() const;
+		bool IntegerPartitioning() const { return _partitioning == TessellatorPartitioning::Integer; }
+		Parity FactorParity(float factor, bool inside) const;
+
+		void ComputeContext(Fixed factor, FactorContext& context) const;
+		int PointCount(Fixed factor) const;
+		Fixed PlacePoint(const FactorContext& context, int point) const;
+
+		void DefinePoint(Fixed u, Fixed v);
+		int PatchIndex(int index) const;
+		void DefineTriangle(int index0, int index1, int index2);
+
+		void StitchRegular(bool trapezoid, Diagonals diagonals, int insidePoints, int insideBase, int outsideBase);
+		void StitchTransition(int insideBase, int insideHalfPoints, Parity insideParity, int outsideBase, int outsideHalfPoints, Parity outsideParity);
+
+		TessellatorPartitioning _partitioning;
+		TessellatedPatch& _patch;
+		bool _triangle;
+		Parity _parity;					// of the factor being worked on
+		int _remap;						// 0 none, 1 ring wrap, 2 strip inversion
+		RingWrap _wrap;
+		StripInversion _inversion;
+	};
+
+	PatchBuilder::PatchBuilder(TessellatorPartitioning partitioning, TessellatedPatch& patch)
+		: _partitioning(partitioning), _patch(patch), _triangle(false), _parity(OriginalParity()), _remap(0)
+	{
+		_patch.locations.clear();
+		_patch.indices.clear();
+		_patch.outerRingPoints = 0;
+	}
+
+	Parity PatchBuilder::OriginalParity() const
+	{
+		return _partitioning == TessellatorPartitioning::FractionalEven ? Even : Odd;
+	}
+
+	Parity PatchBuilder::FactorParity(float factor, bool inside) const
+	{
+		if (!IntegerPartitioning()) return OriginalParity();
+		// An inside factor of 1 is treated as even, so the inside is a single point
+		return IsEven(factor) || (inside && factor == 1.0f) ? Even : Odd;
+	}
+
+	void PatchBuilder::ComputeContext(Fixed factor, FactorContext& context) const
+	{
+		auto half = (factor + 1) / 2;
+		// Half of 1 is 1/2, which even partitioning treats as odd would
+		if (_parity == Odd || half == FixedHalf) half += FixedHalf;
+		const auto floorHalf = FixedFloor(half);
+		const auto ceilHalf = FixedCeil(half);
+		context.halfFactorFraction = half - floorHalf;
+		// Even factors leave out the point always at the middle
+		context.halfFactorPoints = ceilHalf >> FractionBits;
+		if (ceilHalf == floorHalf) context.splitPoint = context.halfFactorPoints + 1;
+		else if (_parity == Odd) context.splitPoint = floorHalf == FixedOne ? 0 : (RemoveMostSignificantBit((floorHalf >> FractionBits) - 1) << 1) + 1;
+		else context.splitPoint = (RemoveMostSignificantBit(floorHalf >> FractionBits) << 1) + 1;
+
+		auto floorSegments = (floorHalf * 2) >> FractionBits;
+		auto ceilSegments = (ceilHalf * 2) >> FractionBits;
+		if (_parity == Odd)
+		{
+			floorSegments--;
+			ceilSegments--;
+		}
+		context.inverseFloorSegments = FixedReciprocal(floorSegments);
+		context.inverseCeilSegments = FixedReciprocal(ceilSegments);
+	}
+
+	int PatchBuilder::PointCount(Fixed factor) const
+	{
+		if (_parity == Odd) return (FixedCeil(FixedHalf + (factor + 1) / 2) * 2) >> FractionBits;
+		return ((FixedCeil((factor + 1) / 2) * 2) >> FractionBits) + 1;
+	}
+
+	// Location in [0, 1] of a point along an edge, the second half mirroring the first
+	Fixed PatchBuilder::PlacePoint(const FactorContext& context, int point) const
+	{
+		auto flip = false;
+		if (point >= context.halfFactorPoints)
+		{
+			point = (context.halfFactorPoints << 1) - point;
+			if (_parity == Odd) point--;
+			flip = true;
+		}
+		// 16 bit fixed point can't hit the middle exactly
+		if (point == context.halfFactorPoints) return FixedHalf;
+
+		const auto ceilIndex = point;
+		const auto floorIndex = point > context.splitPoint ? point - 1 : point;
+		// Both are about 1/2 at most, which is 2^31 once multiplied, so the lerp is in 64 bits
+		const std::int64_t onFloor = floorIndex * context.inverseFloorSegments;
+		const std::int64_t onCeil = ceilIndex * context.inverseCeilSegments;
+		const auto lerped = onFloor * (FixedOne - context.halfFactorFraction) + onCeil * context.halfFactorFraction;
+		// The reciprocals are rounded, so the last points before the middle can land a few units
+		// past it, which would put them out of order with their mirror images
+		const auto location = std::min(static_cast<Fixed>((lerped + FixedHalf) >> FractionBits), FixedHalf);
+		return flip ? FixedOne - location : location;
+	}
+
+	void PatchBuilder::DefinePoint(Fixed u, Fixed v)
+	{
+		const auto fu = ToFloat(u);
+		const auto fv = ToFloat(v);
+		_patch.locations.push_back(_triangle ? float3(fu, fv, 1.0f - fu - fv) : float3(fu, fv, 0.0f));
+	}
+
+	int PatchBuilder::PatchIndex(int index) const
+	{
+		if (_remap == 1)
+		{
+			// Remapped outside indices come after the inside ones
+			if (index >= _wrap.outsideBase) return index == _wrap.outsideLast ? _wrap.outsideFirst : index + _wrap.outsideDelta;
+			return index == _wrap.insideLast ? _wrap.insideFirst : _wrap.insideDelta + index * _wrap.insideStep;
+		}
+		if (_remap == 2)
+		{
+			if (index == _inversion.cornerBad) return _inversion.cornerReplacement;
+			if (index >= _inversion.invertFrom) return _inversion.inversionEnd - index;
+		}
+		return index;
+	}
+
+	void PatchBuilder::DefineTriangle(int index0, int index1, int index2)
+	{
+		_patch.indices.push_back(static_cast<std::uint32_t>(PatchIndex(index0)));
+		_patch.indices.push_back(static_cast<std::uint32_t>(PatchIndex(index1)));
+		_patch.indices.push_back(static_cast<std::uint32_t>(PatchIndex(index2)));
+	}
+
+	// Two rows of points, the outside one a point longer at each end for a trapezoid
+	void PatchBuilder::StitchRegular(bool trapezoid, Diagonals diagonals, int insidePoints, int insideBase, int outsideBase)
+	{
+		auto inside = insideBase;
+		auto outside = outsideBase;
+		if (trapezoid)
+		{
+			DefineTriangle(outside, outside + 1, inside);
+			outside++;
+		}
+
+		auto p = 0;
+		switch (diagonals)
+		{
+		case InsideToOutside:
+			for (p = 0; p < insidePoints - 1; p++, inside++, outside++)
+			{
+				DefineTriangle(inside, outside, outside + 1);
+				DefineTriangle(inside, outside + 1, inside + 1);
+			}
+			break;
+
+		case Mirrored:
+			// Diagonals from the outside row's outer end to the inside row's middle, then back
+			for (p = 0; p < insidePoints / 2; p++, inside++, outside++)
+			{
+				DefineTriangle(outside, inside + 1, inside);
+				DefineTriangle(outside, outside + 1, inside + 1);
+			}
+			for (; p < insidePoints - 1; p++, inside++, outside++)
+			{
+				DefineTriangle(inside, outside, outside + 1);
+				DefineTriangle(inside, outside + 1, inside + 1);
+			}
+			break;
+		}
+
+		if (trapezoid) DefineTriangle(outside, outside + 1, inside);
+	}
+
+	// The outer ring to the first inside ring, rows of any two factors, each half walked in
+	// ruler function order so the triangles grow and shrink smoothly with the factors
+	void PatchBuilder::StitchTransition(int insideBase, int insideHalfPoints, Parity insideParity, int outsideBase, int outsideHalfPoints, Parity outsideParity)
+	{
+		if (insideParity == Odd) insideHalfPoints--;
+		if (outsideParity == Odd) outsideHalfPoints--;
+
+		auto inside = insideBase;
+		auto outside = outsideBase;
+		const auto advanceInside = [&]()
+		{
+			DefineTriangle(inside, outside, inside + 1);
+			inside++;
+		};
+		const auto advanceOutside = [&]()
+		{
+			DefineTriangle(outside, outside + 1, inside);
+			outside++;
+		};
+
+		// First half, vertex 0 of the table first
+		if (FinalPointPosition[0] < outsideHalfPoints) advanceOutside();
+		for (auto i = 1; i <= 32; i++)
+		{
+			if (FinalPointPosition[i] < insideHalfPoints) advanceInside();
+			if (FinalPointPosition[i] < outsideHalfPoints) advanceOutside();
+		}
+
+		// The middle
+		if (insideParity != outsideParity || insideParity == Odd)
+		{
+			if (insideParity == outsideParity)
+			{
+				DefineTriangle(inside, outside, inside + 1);
+				DefineTriangle(inside + 1, outside, outside + 1);
+				inside++;
+				outside++;
+			}
+			else if (insideParity == Even)
+			{
+				// Pointing in
+				DefineTriangle(inside, outside, outside + 1);
+				outside++;
+			}
+			else
+			{
+				// Pointing out
+				DefineTriangle(inside, outside, inside + 1);
+				inside++;
+			}
+		}
+
+		// Second half, mirrored
+		for (auto i = 32; i >= 1; i--)
+		{
+			if (FinalPointPosition[i] < outsideHalfPoints) advanceOutside();
+			if (FinalPointPosition[i] < insideHalfPoints) advanceInside();
+		}
+		if (FinalPointPosition[0] < outsideHalfPoints) advanceOutside();
+	}
+
+	int PatchBuilder::OuterRingPoints(const float edges[], int edgeCount)
+	{
+		auto points = 0;
+		for (auto edge = 0; edge < edgeCount; edge++)
+		{
+			_parity = FactorParity(edges[edge], false);
+			points += PointCount(ToFixed(edges[edge])) - 1;
+		}
+		return points;
+	}
+
+	void PatchBuilder::BuildTriangle(const float edges[3], float inside)
+	{
+		_triangle = true;
+		Parity edgeParity[3];
+		Fixed edgeFactor[3];
+		for (auto edge = 0; edge < 3; edge++)
+		{
+			edgeParity[edge] = FactorParity(edges[edge], false);
+			edgeFactor[edge] = ToFixed(edges[edge]);
+		}
+		const auto insideParity = FactorParity(inside, true);
+		const auto insideFactor = ToFixed(inside);
+
+		if ((IntegerPartitioning() || OriginalParity() == Odd) && insideFactor == FixedOne &&
+			edgeFactor[0] == FixedOne && edgeFactor[1] == FixedOne && edgeFactor[2] == FixedOne)
+		{
+			// The patch as it is: v = 1, w = 1 and u = 1, the starts of edges 0, 1 and 2
+			DefinePoint(0, FixedOne);
+			DefinePoint(0, 0);
+			DefinePoint(FixedOne, 0);
+			DefineTriangle(0, 1, 2);
+			return;
+		}
+
+		FactorContext edgeContext[3];
+		int edgePoints[3];
+		for (auto edge = 0; edge < 3; edge++)
+		{
+			_parity = edgeParity[edge];
+			ComputeContext(edgeFactor[edge], edgeContext[edge]);
+			edgePoints[edge] = PointCount(edgeFactor[edge]);
+		}
+		FactorContext insideContext;
+		_parity = insideParity;
+		ComputeContext(insideFactor, insideContext);
+		// At least one inside ring, degenerate where the inside factor is 1
+		const auto insidePoints = std::max(insideParity == Odd ? 4 : 3, PointCount(insideFactor));
+		const auto insideBaseOffset = edgePoints[0] + edgePoints[1] + edgePoints[2] - 3;
+
+		// The outer ring, clockwise from v = 1 down edge 0 (u = 0), along edge 1 (v = 0) and
+		// back up edge 2 (w = 0). Each edge leaves out its end, the next edge's start.
+		for (auto edge = 0; edge < 3; edge++)
+		{
+			_parity = edgeParity[edge];
+			const auto end = edgePoints[edge] - 1;
+			for (auto p = 0; p < end; p++)
+			{
+				// Edges 0 and 2 run with v and u falling, so their points are taken in reverse
+				const auto location = PlacePoint(edgeContext[edge], (edge & 1) ? p : end - p);
+				if (edge == 0) DefinePoint(0, location);
+				else DefinePoint(location, edge == 2 ? FixedOne - location : 0);
+			}
+		}
+
+		// Inside rings, spiralling in clockwise. Points along each ring edge are the inside
+		// factor's, pushed in by the ring's place along it and spaced over 2/3 as much
+		_parity = insideParity;
+		const auto rings = insidePoints >> 1;
+		for (auto ring = 1; ring < rings; ring++)
+		{
+			const auto start = ring;
+			const auto end = insidePoints - 1 - start;
+			const auto placed = PlacePoint(insideContext, start);
+			const auto perpendicular = (placed * FixedTwoThirds + FixedHalf) >> FractionBits;
+			// Half the perpendicular distance, taken as what is left of the placed point so each
+			// ring's first corner is exactly as far from both edges
+			const auto shift = placed - perpendicular;
+			for (auto edge = 0; edge < 3; edge++)
+			{
+				for (auto p = start; p < end; p++)
+				{
+					const auto location = PlacePoint(insideContext, (edge & 1) ? p : end - (p - start));
+					if (edge == 0) DefinePoint(perpendicular, location - shift);
+					else if (edge == 1) DefinePoint(location - shift, perpendicular);
+					else DefinePoint(location - shift, FixedOne - (location - shift) - perpendicular);
+				}
+			}
+		}
+		// Even factors end at the centre
+		if (insideParity == Even) DefinePoint(FixedOneThird, FixedOneThird);
+
+		// Stitch each ring to the next, the outer ring with the transition tables
+		int outsideEdgePoints[3] = { edgePoints[0], edgePoints[1], edgePoints[2] };
+		const FactorContext* outsideContext[3] = { &edgeContext[0], &edgeContext[1], &edgeContext[2] };
+		Parity outsideParity[3] = { edgeParity[0], edgeParity[1], edgeParity[2] };
+		auto insideOffset = insideBaseOffset;
+		auto outsideOffset = 0;
+		const auto ringCount = (insidePoints + 1) >> 1;		// even factors count the centre
+		for (auto ring = 1; ring < ringCount; ring++)
+		{
+			const auto ringInsidePoints = insidePoints - 2 * ring;
+			const auto firstInside = insideOffset;
+			const auto firstOutside = outsideOffset;
+			for (auto edge = 0; edge < 3; edge++)
+			{
+				auto insideBase = insideOffset;
+				auto outsideBase = outsideOffset;
+				if (edge == 2)
+				{
+					// The last edge ends on the ring's first points, so both rows are numbered
+					// as if they ran on and the last points remapped to the first
+					_wrap.insideDelta = insideOffset;
+					_wrap.insideStep = 1;
+					_wrap.insideLast = ringInsidePoints - 1;
+					_wrap.insideFirst = firstInside;
+					_wrap.outsideBase = _wrap.insideLast + 1;
+					_wrap.outsideDelta = outsideOffset - _wrap.outsideBase;
+					_wrap.outsideLast = _wrap.outsideBase + outsideEdgePoints[edge] - 1;
+					_wrap.outsideFirst = firstOutside;
+					_remap = 1;
+					insideBase = 0;
+					outsideBase = _wrap.outsideBase;
+				}
+				if (ring == 1) StitchTransition(insideBase, insideContext.halfFactorPoints, insideParity, outsideBase, outsideContext[edge]->halfFactorPoints, outsideParity[edge]);
+				else StitchRegular(true, Mirrored, ringInsidePoints, insideBase, outsideBase);
+				_remap = 0;
+
+				outsideOffset += outsideEdgePoints[edge] - 1;
+				insideOffset += ringInsidePoints - 1;
+				outsideEdgePoints[edge] = ringInsidePoints;
+			}
+			if (ring == 1)
+			{
+				for (auto edge = 0; edge < 3; edge++)
+				{
+					outsideContext[edge] = &insideContext;
+					outsideParity[edge] = insideParity;
+				}
+			}
+		}
+		// Odd factors end at a triangle
+		if (insideParity == Odd) DefineTriangle(outsideOffset, outsideOffset + 1, outsideOffset + 2);
+	}
+
+	void PatchBuilder::BuildQuad(const float edges[4], const float inside[2])
+	{
+		_triangle = false;
+		Parity edgeParity[4];
+		Fixed edgeFactor[4];
+		for (auto edge = 0; edge < 4; edge++)
+		{
+			edgeParity[edge] = FactorParity(edges[edge], false);
+			edgeFactor[edge] = ToFixed(edges[edge]);
+		}
+		Parity insideParity[2];
+		Fixed insideFactor[2];
+		for (auto axis = 0; axis < 2; axis++)
+		{
+			insideParity[axis] = FactorParity(inside[axis], true);
+			insideFactor[axis] = ToFixed(inside[axis]);
+		}
+
+		if ((IntegerPartitioning() || OriginalParity() == Odd) && insideFactor[0] == FixedOne && insideFactor[1] == FixedOne &&
+			edgeFactor[0] == FixedOne && edgeFactor[1] == FixedOne && edgeFactor[2] == FixedOne && edgeFactor[3] == FixedOne)
+		{
+			DefinePoint(0, 0);
+			DefinePoint(FixedOne, 0);
+			DefinePoint(FixedOne, FixedOne);
+			DefinePoint(0, FixedOne);
+			DefineTriangle(0, 1, 3);
+			DefineTriangle(1, 2, 3);
+			return;
+		}
+
+		FactorContext edgeContext[4];
+		int edgePoints[4];
+		auto insideBaseOffset = -4;
+		for (auto edge = 0; edge < 4; edge++)
+		{
+			_parity = edgeParity[edge];
+			ComputeContext(edgeFactor[edge], edgeContext[edge]);
+			edgePoints[edge] = PointCount(edgeFactor[edge]);
+			insideBaseOffset += edgePoints[edge];
+		}
+		FactorContext insideContext[2];
+		int insidePoints[2];
+		for (auto axis = 0; axis < 2; axis++)
+		{
+			_parity = insideParity[axis];
+			ComputeContext(insideFactor[axis], insideContext[axis]);
+			insidePoints[axis] = std::max(insideParity[axis] == Odd ? 4 : 3, PointCount(insideFactor[axis]));
+		}
+
+		// The outer ring, clockwise from (0, 1) down the u = 0 edge, along v = 0, up u = 1
+		// and back along v = 1
+		for (auto edge = 0; edge < 4; edge++)
+		{
+			_parity = edgeParity[edge];
+			const auto end = edgePoints[edge] - 1;
+			for (auto p = 0; p < end; p++)
+			{
+				const auto location = PlacePoint(edgeContext[edge], (edge == 1 || edge == 2) ? p : end - p);
+				if (edge & 1) DefinePoint(location, edge == 3 ? FixedOne : 0);
+				else DefinePoint(edge == 2 ? FixedOne : 0, location);
+			}
+		}
+
+		// Inside rings the same way, each edge at the inside factor's point ring along the other axis
+		const auto rings = std::min(insidePoints[0], insidePoints[1]) >> 1;
+		for (auto ring = 1; ring < rings; ring++)
+		{
+			const auto start = ring;
+			const int end[2] = { insidePoints[0] - 1 - start, insidePoints[1] - 1 - start };
+			for (auto edge = 0; edge < 4; edge++)
+			{
+				const auto across = edge & 1;		// axis the edge's perpendicular position is on
+				const auto along = across ^ 1;
+				_parity = insideParity[across];
+				const auto perpendicular = PlacePoint(insideContext[across], edge < 2 ? start : end[across]);
+				_parity = insideParity[along];
+				for (auto p = start; p < end[along]; p++)
+				{
+					const auto location = PlacePoint(insideContext[along], (edge == 1 || edge == 2) ? p : end[along] - (p - start));
+					if (along) DefinePoint(perpendicular, location);
+					else DefinePoint(location, perpendicular);
+				}
+			}
+		}
+		// An even inside factor on the shorter axis leaves a row of points through the middle
+		if (insidePoints[0] > insidePoints[1] && insideParity[1] == Even)
+		{
+			_parity = insideParity[0];
+			for (auto p = rings; p <= insidePoints[0] - 1 - rings; p++) DefinePoint(PlacePoint(insideContext[0], p), FixedHalf);
+		}
+		else if (insidePoints[1] >= insidePoints[0] && insideParity[0] == Even)
+		{
+			_parity = insideParity[1];
+			for (auto p = insidePoints[1] - 1 - rings; p >= rings; p--) DefinePoint(FixedHalf, PlacePoint(insideContext[1], p));
+		}
+
+		// Stitch each ring to the next, the outer ring with the transition tables
+		const int halfRows[2] = { (insidePoints[0] + 1) >> 1, (insidePoints[1] + 1) >> 1 };	// even factors count the middle
+		const auto ringCount = std::min(halfRows[0], halfRows[1]);
+		// The ring where an even factor's middle row is, one point wide across the axis, which
+		// the two edges along the row stitch to from either side, the second walking it backwards
+		const int degenerateRing[2] =
+		{
+			insideParity[1] == Even ? halfRows[1] - 1 : -1,
+			insideParity[0] == Even ? halfRows[0] - 1 : -1,
+		};
+		const FactorContext* outsideContext[4] = { &edgeContext[0], &edgeContext[1], &edgeContext[2], &edgeContext[3] };
+		Parity outsideParity[4] = { edgeParity[0], edgeParity[1], edgeParity[2], edgeParity[3] };
+		int outsideEdgePoints[4] = { edgePoints[0], edgePoints[1], edgePoints[2], edgePoints[3] };
+		auto insideOffset = insideBaseOffset;
+		auto outsideOffset = 0;
+		for (auto ring = 1; ring < ringCount; ring++)
+		{
+			const int ringInsidePoints[2] = { insidePoints[0] - 2 * ring, insidePoints[1] - 2 * ring };
+			const auto firstInside = insideOffset;
+			const auto firstOutside = outsideOffset;
+			for (auto edge = 0; edge < 4; edge++)
+			{
+				const auto axis = (edge + 1) & 1;	// the axis the edge runs along
+				auto insideBase = insideOffset;
+				auto outsideBase = outsideOffset;
+				const auto degenerate = ring == degenerateRing[axis];
+				if (edge == 2 && degenerate)
+				{
+					_inversion.invertFrom = insideOffset;
+					_inversion.cornerBad = -1;
+					_inversion.cornerReplacement = -1;
+					_inversion.inversionEnd = 2 * insideOffset;
+					_remap = 2;
+				}
+				if (edge == 3)
+				{
+					_wrap.insideDelta = insideOffset;
+					_wrap.insideStep = degenerate ? -1 : 1;
+					_wrap.insideLast = ringInsidePoints[axis] - 1;
+					_wrap.insideFirst = firstInside;
+					_wrap.outsideBase = _wrap.insideLast + 1;
+					_wrap.outsideDelta = outsideOffset - _wrap.outsideBase;
+					_wrap.outsideLast = _wrap.outsideBase + outsideEdgePoints[edge] - 1;
+					_wrap.outsideFirst = firstOutside;
+					_remap = 1;
+					insideBase = 0;
+					outsideBase = _wrap.outsideBase;
+				}
+				if (ring == 1) StitchTransition(insideBase, insideContext[axis].halfFactorPoints, insideParity[axis], outsideBase, outsideContext[edge]->halfFactorPoints, outsideParity[edge]);
+				else StitchRegular(true, Mirrored, ringInsidePoints[axis], insideBase, outsideBase);
+				_remap = 0;
+
+				outsideOffset += outsideEdgePoints[edge] - 1;
+				insideOffset += ringInsidePoints[axis] - 1;
+				outsideEdgePoints[edge] = ringInsidePoints[axis];
+			}
+			if (ring == 1)
+			{
+				for (auto edge = 0; edge < 4; edge++)
+				{
+					outsideContext[edge] = &insideContext[edge & 1];
+					outsideParity[edge] = insideParity[edge & 1];
+				}
+			}
+		}
+
+		// The middle, where the shorter inside factor is odd: what is left is a ring one segment
+		// wide, stitched as a strip from one long side to the other. The far side runs backwards
+		// round the ring, so its indices are numbered as if it ran forwards and mapped back.
+		const auto shortAxis = insidePoints[1] >= insidePoints[0] ? 0 : 1;
+		if (insideParity[shortAxis] == Odd)
+		{
+			const auto stripPoints = insidePoints[shortAxis ^ 1] - 2 * (ringCount - 1);
+			if (shortAxis == 0)
+			{
+				// Down the u = low side, then back up the u = high one
+				_inversion.invertFrom = outsideOffset + stripPoints;
+				_inversion.cornerBad = -1;
+				_inversion.cornerReplacement = -1;
+				_inversion.inversionEnd = 2 * _inversion.invertFrom + stripPoints - 1;
+				_remap = 2;
+				StitchRegular(false, InsideToOutside, stripPoints, _inversion.invertFrom, outsideOffset);
+			}
+			else
+			{
+				// Along the v = low side from the ring's second point, then back along v = high,
+				// which ends on the ring's first
+				_inversion.invertFrom = outsideOffset + stripPoints + 1;
+				_inversion.cornerBad = _inversion.invertFrom;
+				_inversion.cornerReplacement = outsideOffset;
+				_inversion.inversionEnd = outsideOffset + 2 * stripPoints + _inversion.invertFrom;
+				_remap = 2;
+				StitchRegular(false, InsideToOutside, stripPoints, _inversion.invertFrom, outsideOffset + 1);
+			}
+			_remap = 0;
+		}
+	}
+}
+
+Tessellator::Tessellator(TessellatorDomain domain, TessellatorPartitioning partitioning)
+	: _domain(domain), _partitioning(partitioning)
+{
+}
+
+bool Tessellator::Key::operator==(const Key& other) const
+{
+	return std::memcmp(factors, other.factors, sizeof(factors)) == 0;
+}
+
+std::size_t Tessellator::KeyHash::operator()(const Key& key) const
+{
+	// FNV-1a over the six factors
+	std::uint64_t hash = 14695981039346656037ull;
+	for (const auto factor : key.factors)
+	{
+		hash ^= static_cast<std::uint32_t>(factor);
+		hash *= 1099511628211ull;
+	}
+	return static_cast<std::size_t>(hash);
+}
+
+Tessellator::Key Tessellator::MakeKey(const TessellationFactors& factors) const
+{
+	Key key;
+	float edges[4];
+	float inside[2];
+	if (!ProcessFactors(_domain, _partitioning, factors, edges, inside))
+	{
+		// No real factor is negative
+		std::fill(key.factors, key.factors + 6, -1);
+		return key;
+	}
+	for (auto i = 0; i < 4; i++) key.factors[i] = ToFixed(edges[i]);
+	for (auto i = 0; i < 2; i++) key.factors[4 + i] = ToFixed(inside[i]);
+	return key;
+}
+
+TessellatedPatch& Tessellator::Find(const TessellationFactors& factors, bool& created)
+{
+	auto& patch = _cache[MakeKey(factors)];
+	created = !patch;
+	if (created) patch.reset(new TessellatedPatch());
+	return *patch;
+}
+
+const TessellatedPatch& Tessellator::Tessellate(const TessellationFactors& factors)
+{
+	auto created = false;
+	auto& patch = Find(factors, created);
+	if (created) Generate(_domain, _partitioning, factors, patch);
+	return patch;
+}
+
+void Tessellator::ClearCache()
+{
+	_cache.clear();
+}
+
+void Tessellator::Generate(TessellatorDomain domain, TessellatorPartitioning partitioning, const TessellationFactors& factors, TessellatedPatch& patch)
+{
+	PatchBuilder builder(partitioning, patch);
+	float edges[4];
+	float inside[2];
+	if (!ProcessFactors(domain, partitioning, factors, edges, inside)) return;
+	if (domain == TessellatorDomain::Triangle) builder.BuildTriangle(edges, inside[0]);
+	else builder.BuildQuad(edges, inside);
+	patch.outerRingPoints = builder.OuterRingPoints(edges, domain == TessellatorDomain::Triangle ? 3 : 4);
+}
+
+bool Tessellator::RoundFactors(TessellatorDomain domain, TessellatorPartitioning partitioning, const TessellationFactors& factors, TessellationFactors& rounded)
+{
+	return ProcessFactors(domain, partitioning, factors, rounded.edges, rounded.inside);
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Common/ParallelFor.h"
+#include "Common/ShaderMath.h"
+
+// A hull shader's [domain(...)] and [partitioning(...)]
+enum class TessellatorDomain { Triangle, Quad };
+enum class TessellatorPartitioning { Integer, FractionalOdd, FractionalEven };
+
+// SV_TessFactor and SV_InsideTessFactor, triangle edge i where location component i is 0, quad edges u = 0, v = 0, u = 1, v = 1
+struct TessellationFactors
+{
+	float edges[4];
+	float inside[2];
+};
+
+// What the fixed function tessellator hands on for one patch
+struct TessellatedPatch
+{
+	std::vector<HLSL::float3> locations;	// SV_DomainLocation, uvw for triangles and uv0 for quads
+	std::vector<std::uint32_t> indices;		// triangle_cw, as every hull shader here outputs
+	int outerRingPoints;					// the first locations, those along the domain's edges
+};
+
+// Many patches, each patch's vertices one after the other in patch order
+template<typename Vertex>
+struct TessellatedMesh
+{
+	std::vector<Vertex> vertices;
+	std::vector<std::uint32_t> indices;
+	std::vector<int> patchVertexStart;		// per patch, then the vertex count
+	std::vector<int> patchIndexStart;
+};
+
+// The D3D11 reference tessellator on the CPU, patches cached by the 16.16 fixed point factors they round to
+class Tessellator
+{
+public: // Structors
+	Tessellator(TessellatorDomain domain, TessellatorPartitioning partitioning);
+
+public: // Accessors
+	TessellatorDomain GetDomain() const { return _domain; }
+	TessellatorPartitioning GetPartitioning() const { return _partitioning; }
+	int GetCachedPatchCount() const { return static_cast<int>(_cache.size()); }
+
+public: // Functions
+	// Tessellated the first time the factors are seen, no locations when culled. Not for several threads at once.
+	const TessellatedPatch& Tessellate(const TessellationFactors& factors);
+	void ClearCache();
+
+	// Runs factors(patch) and domain(patch, location) over patchCount patches into one mesh, on threads
+	template<typename Vertex, typename FactorFunction, typename DomainFunction>
+	void TessellatePatches(int patchCount, const FactorFunction& factors, const DomainFunction& domain,
+		TessellatedMesh<Vertex>& mesh, int threads = 0);
+
+	// Uncached
+	static void Generate(TessellatorDomain domain, TessellatorPartitioning partitioning, const TessellationFactors& factors, TessellatedPatch& patch);
+	// The factors culled, clamped and rounded as the tessellator does first, false for a culled patch
+	static bool RoundFactors(TessellatorDomain domain, TessellatorPartitioning partitioning, const TessellationFactors& factors, TessellationFactors& rounded);
+
+private: // Types
+	// The factors after rounding to fixed point, which decide the tessellation
+	struct Key
+	{
+		std::int32_t factors[6];
+
+		bool operator==(const Key& other) const;
+	};
+
+	struct KeyHash
+	{
+		std::size_t operator()(const Key& key) const;
+	};
+
+private: // Functions
+	Key MakeKey(const TessellationFactors& factors) const;
+	// The cached patch for the factors, or a new empty one to fill when created is set
+	TessellatedPatch& Find(const TessellationFactors& factors, bool& created);
+
+private: // Data
+	TessellatorDomain _domain;
+	TessellatorPartitioning _partitioning;
+	std::unordered_map<Key, std::unique_ptr<TessellatedPatch>, KeyHash> _cache;
+};
+
+template<typename Vertex, typename FactorFunction, typename DomainFunction>
+void Tessellator::TessellatePatches(int patchCount, const FactorFunction& factors, const DomainFunction& domain,
+	TessellatedMesh<Vertex>& mesh, int threads)
+{
+	std::vector<TessellationFactors> patchFactors(patchCount);
+	ParallelFor(0, patchCount, threads, [&](int patch)
+	{
+		patchFactors[patch] = factors(patch);
+	}, 256);
+
+	// Look the patches up in order, then fill the new ones
+	std::vector<const TessellatedPatch*> patches(patchCount);
+	std::vector<int> created;
+	std::vector<TessellatedPatch*> createdPatches;
+	for (auto patch = 0; patch < patchCount; patch++)
+	{
+		auto isNew = false;
+		auto& tessellated = Find(patchFactors[patch], isNew);
+		patches[patch] = &tessellated;
+		if (!isNew) continue;
+		created.push_back(patch);
+		createdPatches.push_back(&tessellated);
+	}
+	ParallelFor(0, static_cast<int>(created.size()), threads, [&](int i)
+	{
+		Generate(_domain, _partitioning, patchFactors[created[i]], *createdPatches[i]);
+	});
+
+	mesh.patchVertexStart.resize(patchCount + 1);
+	mesh.patchIndexStart.resize(patchCount + 1);
+	mesh.patchVertexStart[0] = 0;
+	mesh.patchIndexStart[0] = 0;
+	for (auto patch = 0; patch < patchCount; patch++)
+	{
+		mesh.patchVertexStart[patch + 1] = mesh.patchVertexStart[patch] + static_cast<int>(patches[patch]->locations.size());
+		mesh.patchIndexStart[patch + 1] = mesh.patchIndexStart[patch] + static_cast<int>(patches[patch]->indices.size());
+	}
+	mesh.vertices.resize(mesh.patchVertexStart[patchCount]);
+	mesh.indices.resize(mesh.patchIndexStart[patchCount]);
+
+	ParallelFor(0, patchCount, threads, [&](int patch)
+	{
+		const auto& tessellated = *patches[patch];
+		const auto vertexStart = mesh.patchVertexStart[patch];
+		const auto indexStart = mesh.patchIndexStart[patch];
+		for (std::size_t i = 0; i < tessellated.locations.size(); i++) mesh.vertices[vertexStart + i] = domain(patch, tessellated.locations[i]);
+		for (std::size_t i = 0; i < tessellated.indices.size(); i++) mesh.indices[indexStart + i] = vertexStart + tessellated.indices[i];
+	}, 16);
+}
@@ -0,0 +1,18 @@
+struct VertexShaderInput
+{
+	float3 position : POSITION;
+};
+
+struct PixelShaderInput
+{
+	float4 position : SV_POSITION;
+};
+
+//Full-screen quad, PS_Nebula builds its eye rays from the pixel position
+PixelShaderInput main(VertexShaderInput input)
+{
+	PixelShaderInput output;
+	output.position = float4(sign(input.position.xy), 0, 1);
+
+	return output;
+}
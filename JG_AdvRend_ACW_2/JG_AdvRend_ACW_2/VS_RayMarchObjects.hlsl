@@ -13,7 +13,9 @@ struct VertexShaderInput
 struct PixelShaderInput
 {
 	float4 position : SV_POSITION;
-	float2 canvasXY : TEXCOORD0;
+	nointerpolation int primitive : PRIMITIVE;
+	nointerpolation float3 boxMin : BOXMIN;
+	nointerpolation float3 boxMax : BOXMAX;
 };
 
 PixelShaderInput main(VertexShaderInput input)
@@ -21,8 +23,10 @@ PixelShaderInput main(VertexShaderInput input)
 	PixelShaderInput output;
 	output.position = float4(sign(input.position.xy), 0, 1);
 
-	float aspectRatio = projection._m00 / projection._m11;
-	output.canvasXY = sign(input.position.xy) * float2(1.0, aspectRatio);
+	//Every primitive, with a box that holds them all
+	output.primitive = -1;
+	output.boxMin = float3(-1e10, -1e10, -1e10);
+	output.boxMax = float3(1e10, 1e10, 1e10);
 
 	return output;
 }
\ No newline at end of file
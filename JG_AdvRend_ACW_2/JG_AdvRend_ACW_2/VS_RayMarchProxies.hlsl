@@ -0,0 +1,66 @@
+cbuffer ModelViewProjectionConstantBuffer : register(b0)
+{
+	matrix model;
+	matrix view;
+	matrix projection;
+};
+
+#define NUMBER_OF_PRIMITIVES 17
+
+//Bounding box of every primitive in sceneSDF, centre and half size
+//Generated from SDFScene::ComputeBoundingBox, keep the order in step with primitiveSDF in PS_RayMarchObjects, half sizes rounded up so the boxes still hold the bounds
+static float3 primitiveBoxes[NUMBER_OF_PRIMITIVES][2] = {
+	{{0.3100, 0.5200, 0.3000}, {0.0405, 0.0506, 0.0304}},
+	{{0.0000, 0.5000, 0.0000}, {0.0456, 0.0304, 0.0456}},
+	{{0.3000, 0.5000, 0.0000}, {0.0405, 0.0304, 0.0405}},
+	{{0.0000, 0.5000, 0.3000}, {0.0506, 0.0506, 0.0506}},
+	{{-0.3000, 0.5000, -0.3000}, {0.0506, 0.0102, 0.0506}},
+	{{0.0000, 0.5000, -0.3000}, {0.0506, 0.0102, 0.0506}},
+	{{-0.3000, 0.5000, 0.0000}, {0.0506, 0.0506, 0.0506}},
+	{{-0.3000, 0.5000, 0.3000}, {0.0567, 0.0567, 0.0567}},
+	{{0.3000, 0.5000, -0.3000}, {0.0506, 0.0506, 0.0203}},
+	{{-0.6000, 0.5125, -0.3000}, {0.0439, 0.0380, 0.0203}},
+	{{-0.6090, 0.5290, 0.0100}, {0.0266, 0.0384, 0.0257}},
+	{{-0.6000, 0.5000, 0.3000}, {0.0203, 0.0405, 0.0203}},
+	{{0.3000, 0.5000, 0.6000}, {0.0203, 0.0405, 0.0203}},
+	{{0.0000, 0.5000, 0.6000}, {0.0708, 0.0708, 0.0708}},
+	{{-0.3000, 0.5000, 0.6000}, {0.0585, 0.0506, 0.0102}},
+	{{-0.6000, 0.5200, 0.6000}, {0.0405, 0.0607, 0.0405}},
+	{{-1.0000, 1.8943, -1.8557}, {0.5683, 0.4616, 0.5007}}
+};
+
+struct VertexShaderInput
+{
+	float3 position : POSITION;
+	uint instance : SV_InstanceID;
+};
+
+struct PixelShaderInput
+{
+	float4 position : SV_POSITION;
+	nointerpolation int primitive : PRIMITIVE;
+	nointerpolation float3 boxMin : BOXMIN;
+	nointerpolation float3 boxMax : BOXMAX;
+};
+
+//One instance per primitive, the unit cube's corners are at +-1
+PixelShaderInput main(VertexShaderInput input)
+{
+	PixelShaderInput output;
+
+	float3 centre = primitiveBoxes[input.instance][0];
+	float3 halfSize = primitiveBoxes[input.instance][1];
+	float3 worldPosition = centre + input.position * halfSize;
+
+	//Project onto the same canvas PS_RayMarchObjects builds its eye rays from, MIN_DIST in front
+	//of the eye along -z of the view, rather than with the rasterized geometry's projection
+	float4 viewPosition = mul(float4(worldPosition, 1.0f), view);
+	float aspectRatio = projection._m00 / projection._m11;
+	output.position = float4(viewPosition.x, viewPosition.y / aspectRatio, 0.0f, -viewPosition.z);
+
+	output.primitive = input.instance;
+	output.boxMin = centre - halfSize;
+	output.boxMax = centre + halfSize;
+
+	return output;
+}
@@ -6,14 +6,34 @@ cbuffer ModelViewProjectionConstantBuffer : register(b0)
 	matrix projection;
 };
 
+cbuffer CameraBuffer : register(b1)
+{
+	float3 cameraPosition;
+	float cameraPadding;
+};
+
+//The chunk TerrainQuadtree selected, drawn with the shared grid scaled over it
+cbuffer TerrainChunkBuffer : register(b2)
+{
+	float2 chunkOrigin;
+	float chunkSize;
+	float gridDimension;
+	float morphStart;
+	float morphEnd;
+	float2 chunkPadding;
+};
+
+Texture2D<float> heightMap : register(t0);
+SamplerState terrainSampler : register(s0);
+
+//TerrainBakeSettings default, the plane's half size the maps cover
+static float TERRAIN_HALF_SIZE = 20.0;
+
 // Per-vertex data used as input to the vertex shader.
 struct VertexShaderInput
 {
-	float3 position : POSITION;
-	float2 tex : TEXCOORD0;
-	float3 normal : NORMAL;
-	float3 tangent : TANGENT;
-	float3 binormal : BINORMAL;
+	//In [0, 1] across the chunk
+	float2 gridPosition : POSITION;
 };
 
 // Per-pixel color data passed through the pixel shader.
@@ -25,7 +45,6 @@ struct HullShaderInput
 	float3 normal : NORMAL;
 	float3 tangent : TANGENT;
 	float3 binormal : BINORMAL;
-	float tessellationFactor : TESS;
 };
 
 // Simple shader to do vertex processing on the GPU.
@@ -33,14 +52,19 @@ HullShaderInput main(VertexShaderInput input)
 {
 	HullShaderInput output;
 
-	output.position = mul(float4(input.position, 1.0f), model).xyz;
-
-	output.tex = input.tex;
-	output.normal = normalize(mul(input.normal, (float3x3)model));
-	output.tangent = normalize(mul(input.tangent, (float3x3)model));
-	output.binormal = normalize(mul(input.binormal, (float3x3)model));
+	//TerrainQuadtree::MorphVertex, odd vertices slide onto their even neighbours through the
+	//outer part of the chunk's range, so at its end the grid is the next level up's
+	float2 vertex = chunkOrigin + input.gridPosition * chunkSize;
+	float height = heightMap.SampleLevel(terrainSampler, (vertex / TERRAIN_HALF_SIZE + 1.0) * 0.5, 0);
+	float morph = saturate((distance(float3(vertex.x, height, vertex.y), cameraPosition) - morphStart) / (morphEnd - morphStart));
+	vertex -= frac(input.gridPosition * gridDimension * 0.5) * 2.0 / gridDimension * chunkSize * morph;
 
-	output.tessellationFactor = 64.0f;
+	//The flat plane, DS_Terrain displaces it
+	output.position = float3(vertex.x, 0.0f, vertex.y);
+	output.tex = (vertex / TERRAIN_HALF_SIZE + 1.0) * 0.5;
+	output.normal = float3(0.0f, 1.0f, 0.0f);
+	output.tangent = float3(1.0f, 0.0f, 0.0f);
+	output.binormal = float3(0.0f, 0.0f, 1.0f);
 
 	return output;
-}
\ No newline at end of file
+}
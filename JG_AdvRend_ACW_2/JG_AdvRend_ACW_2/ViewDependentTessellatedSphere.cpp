@@ -4,6 +4,10 @@
 ViewDependentTessellatedSphere::ViewDependentTessellatedSphere(const shared_ptr<DeviceResources>& device)
 	: _device(device), _position(2.0f, 2.0f, 1.0f), _rotation(0.0f, 0.0f, 0.0f), _scale(0.6f, 0.6f, 0.6f), _loadingComplete(false), _indexCount(0)
 {
+	// Tessellated segments about 8 pixels long, up to HS_TriTess's maxtessfactor
+	_targetBufferData.edgePixels = 8.0f;
+	_targetBufferData.maxFactor = 64.0f;
+	_targetBufferData.pixelScale = 1.0f;
 	CreateDeviceDependentResources();
 }
 
@@ -92,6 +96,9 @@ void ViewDependentTessellatedSphere::CreateDeviceDependentResources()
 		CD3D11_BUFFER_DESC cameraBufferDesc(sizeof(CameraPositionConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
 		ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&cameraBufferDesc, nullptr, &_cameraBuffer));
 
+		CD3D11_BUFFER_DESC targetBufferDesc(sizeof(TessellationTargetConstantBuffer), D3D11_BIND_CONSTANT_BUFFER);
+		ThrowIfFailed(_device->GetD3DDevice()->CreateBuffer(&targetBufferDesc, nullptr, &_targetBuffer));
+
 		D3D11_RASTERIZER_DESC raster = CD3D11_RASTERIZER_DESC(D3D11_DEFAULT);
 		raster.CullMode = D3D11_CULL_NONE;
 		raster.FillMode = D3D11_FILL_WIREFRAME;
@@ -154,6 +161,10 @@ void ViewDependentTessellatedSphere::SetViewProjectionMatrixCB(XMMATRIX& view, X
 {
 	XMStoreFloat4x4(&_mvpBufferData.view, XMMatrixTranspose(view));
 	XMStoreFloat4x4(&_mvpBufferData.projection, XMMatrixTranspose(projection));
+
+	// Pixels one unit spans one unit in front of the camera, half the output's height times
+	// the projection's [1][1], whichever way the display orientation turned it
+	_targetBufferData.pixelScale = 0.5f * _device->GetOutputSize().Height * XMVectorGetX(XMVector2Length(projection.r[1]));
 }
 
 void ViewDependentTessellatedSphere::SetCameraPositionCB(XMFLOAT3& position)
@@ -171,6 +182,7 @@ void ViewDependentTessellatedSphere::ReleaseDeviceDependentResources()
 	if (_inputLayout) _inputLayout.Reset();
 	if (_mvpBuffer) _mvpBuffer.Reset();
 	if (_cameraBuffer) _cameraBuffer.Reset();
+	if (_targetBuffer) _targetBuffer.Reset();
 	if (_vertexBuffer) _vertexBuffer.Reset();
 	if (_indexBuffer) _indexBuffer.Reset();
 	if (_rasterState) _rasterState.Reset();
@@ -201,6 +213,7 @@ void ViewDependentTessellatedSphere::Render()
 	// Prepare the constant buffer to send it to the graphics device.
 	context->UpdateSubresource1(_mvpBuffer.Get(), 0, NULL, &_mvpBufferData, 0, 0, 0);
 	context->UpdateSubresource1(_cameraBuffer.Get(), 0, NULL, &_cameraBufferData, 0, 0, 0);
+	context->UpdateSubresource1(_targetBuffer.Get(), 0, NULL, &_targetBufferData, 0, 0, 0);
 
 	// Each vertex is one instance of the VertexPositionColor struct.
 	UINT stride = sizeof(VertexPositionColor);
@@ -211,13 +224,15 @@ void ViewDependentTessellatedSphere::Render()
 	// Attach our vertex shader.
 	context->VSSetShader(_vertexShader.Get(), nullptr, 0);
 	context->VSSetConstantBuffers1(0, 1, _mvpBuffer.GetAddressOf(), nullptr, nullptr);
-	context->VSSetConstantBuffers1(1, 1, _cameraBuffer.GetAddressOf(), nullptr, nullptr);
 	// Attach our pixel shader.
 	context->PSSetShader(_pixelShader.Get(), nullptr, 0);
 
 	context->GSSetShader(nullptr, nullptr, 0);
 
 	context->HSSetShader(_hullShader.Get(), nullptr, 0);
+	context->HSSetConstantBuffers1(0, 1, _mvpBuffer.GetAddressOf(), nullptr, nullptr);
+	context->HSSetConstantBuffers1(1, 1, _cameraBuffer.GetAddressOf(), nullptr, nullptr);
+	context->HSSetConstantBuffers1(2, 1, _targetBuffer.GetAddressOf(), nullptr, nullptr);
 
 	context->DSSetShader(_domainShader.Get(), nullptr, 0);
 	context->DSSetConstantBuffers1(0, 1, _mvpBuffer.GetAddressOf(), nullptr, nullptr);
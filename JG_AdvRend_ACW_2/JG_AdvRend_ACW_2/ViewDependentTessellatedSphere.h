@@ -36,9 +36,11 @@ private: // Data
 	ComPtr<ID3D11RasterizerState> _rasterState;
 	ComPtr<ID3D11Buffer> _mvpBuffer;
 	ComPtr<ID3D11Buffer> _cameraBuffer;
+	ComPtr<ID3D11Buffer> _targetBuffer;
 
 	ModelViewProjectionConstantBuffer _mvpBufferData;
 	CameraPositionConstantBuffer _cameraBufferData;
+	TessellationTargetConstantBuffer _targetBufferData;
 
 	uint32 _indexCount;
 	bool _loadingComplete;
@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "BezierPatch.h"
+#include "Tests.h"
+
+using namespace HLSL;
+
+namespace
+{
+	struct BezierCheck
+	{
+		int patches;
+		long long vertices;
+		float maxTablePositionError;		// grid from the basis tables against the naive evaluator, units
+		float maxTableNormalError;			// 1 - cos of the angle between their normals
+		long long simdMismatches;			// vertices the SSE2 path gives different bits for than the scalar one
+		int sharedEdges;					// patch edges two patches share the control points of
+		int crackedEdges;					// shared edges whose flatness tessellations differ along them
+		float maxFlatnessErrorRatio;		// surface to triangle over the tolerance, above 1 only in the strips joining a flat edge to the inside
+		int cappedPatches;					// patches that needed a factor above 64, over every tolerance
+	};
+
+	struct BezierBenchmarkResult
+	{
+		int patches;
+		int segments;
+		long long evaluations;					// vertices per pass
+		double naiveEvaluationsPerSecond;		// one thread
+		double tableEvaluationsPerSecond;		// scalar, one thread
+		double simdEvaluationsPerSecond;		// SSE2, one thread, 0 where it isn't compiled in
+		double threadedEvaluationsPerSecond;	// SIMD on every hardware thread
+		int threads;
+	};
+
+	struct BezierLODResult
+	{
+		float tolerance;
+		int triangles;
+		int uniformTriangles;				// every patch on the grid the most curved one needs
+		double buildMilliseconds;			// the first time, tessellator and basis caches cold
+		double warmBuildMilliseconds;		// built again with both caches warm
+	};
+
+	// The control point indices along each edge, as TessellationFactors numbers them
+	const int EdgePoints[4][4] =
+	{
+		{ 0, 4, 8, 12 },
+		{ 0, 1, 2, 3 },
+		{ 3, 7, 11, 15 },
+		{ 12, 13, 14, 15 },
+	};
+
+	struct SharedPatchEdge
+	{
+		int patches[2];
+		int edges[2];
+	};
+
+	bool SamePoint(const float3& a, const float3& b)
+	{
+		return a.x == b.x && a.y == b.y && a.z == b.z;
+	}
+
+	// Edges whose control points two patches share, in either direction, skipping edges collapsed to a point
+	std::vector<SharedPatchEdge> FindSharedEdges(const std::vector<BezierPatch>& patches)
+	{
+		std::vector<SharedPatchEdge> shared;
+		const auto count = static_cast<int>(patches.size());
+		for (auto a = 0; a < count; a++)
+		{
+			for (auto edgeA = 0; edgeA < 4; edgeA++)
+			{
+				const auto* pointsA = EdgePoints[edgeA];
+				const auto& pa = patches[a].points;
+				if (SamePoint(pa[pointsA[0]], pa[pointsA[1]]) && SamePoint(pa[pointsA[0]], pa[pointsA[2]]) && SamePoint(pa[pointsA[0]], pa[pointsA[3]])) continue;
+
+				for (auto b = a; b < count; b++)
+				{
+					for (auto edgeB = b == a ? edgeA + 1 : 0; edgeB < 4; edgeB++)
+					{
+						const auto* pointsB = EdgePoints[edgeB];
+						const auto& pb = patches[b].points;
+						auto forward = true;
+						auto backward = true;
+						for (auto i = 0; i < 4; i++)
+						{
+							forward = forward && SamePoint(pa[pointsA[i]], pb[pointsB[i]]);
+							backward = backward && SamePoint(pa[pointsA[i]], pb[pointsB[3 - i]]);
+						}
+						if (forward || backward) shared.push_back({ { a, b }, { edgeA, edgeB } });
+					}
+				}
+			}
+		}
+		return shared;
+	}
+
+	// The positions of a patch's vertices on one of its edges, sorted
+	std::vector<float3> EdgePositions(const TessellatedMesh<BezierVertex>& mesh, int patch, int edge)
+	{
+		std::vector<float3> positions;
+		for (auto i = mesh.patchVertexStart[patch]; i < mesh.patchVertexStart[patch + 1]; i++)
+		{
+			const auto& vertex = mesh.vertices[i];
+			const auto coordinate = edge % 2 == 0 ? vertex.uv.x : vertex.uv.y;
+			if (coordinate == (edge < 2 ? 0.0f : 1.0f)) positions.push_back(vertex.position);
+		}
+		std::sort(positions.begin(), positions.end(), [](const float3& a, const float3& b)
+		{
+			return a.x != b.x ? a.x < b.x : a.y != b.y ? a.y < b.y : a.z < b.z;
+		});
+		return positions;
+	}
+
+	// The teapot on grids of 1, 4, 16 and 64 segments and to tolerances of 0.1, 0.01 and 0.001
+	BezierCheck CheckBezierPatches()
+	{
+		std::vector<BezierPatch> patches;
+		GetPotteryPatches(patches);
+		BezierCheck check = { static_cast<int>(patches.size()), 0, 0.0f, 0.0f, 0, 0, 0, 0.0f, 0 };
+
+		const int segmentCounts[] = { 1, 4, 16, 64 };
+		TessellatedMesh<BezierVertex> scalar, simd;
+		for (const auto segments : segmentCounts)
+		{
+			const auto basis = MakeBezierGridBasis(segments);
+			EvaluateBezierGrid(patches, basis, { false, 1 }, scalar);
+			EvaluateBezierGrid(patches, basis, { true, 1 }, simd);
+			for (std::size_t i = 0; i < scalar.vertices.size(); i++)
+			{
+				const auto& vertex = scalar.vertices[i];
+				const auto patch = static_cast<int>(i / ((segments + 1) * (segments + 1)));
+				BezierVertex naive;
+				EvaluateBezierNaive(patches[patch], vertex.uv.x, vertex.uv.y, naive);
+				check.maxTablePositionError = std::max(check.maxTablePositionError, length(vertex.position - naive.position));
+				check.maxTableNormalError = std::max(check.maxTableNormalError, 1.0f - dot(vertex.normal, naive.normal));
+				if (std::memcmp(&vertex, &simd.vertices[i], sizeof(vertex)) != 0) check.simdMismatches++;
+			}
+			check.vertices += static_cast<long long>(scalar.vertices.size());
+		}
+
+		const auto shared = FindSharedEdges(patches);
+		check.sharedEdges = static_cast<int>(shared.size());
+		std::vector<bool> cracked(shared.size());
+
+		const float tolerances[] = { 0.1f, 0.01f, 0.001f };
+		BezierTessellator tessellator(patches);
+		TessellatedMesh<BezierVertex> mesh;
+		for (const auto tolerance : tolerances)
+		{
+			tessellator.Tessellate(tolerance, mesh, 1);
+			for (std::size_t edge = 0; edge < shared.size(); edge++)
+			{
+				const auto a = EdgePositions(mesh, shared[edge].patches[0], shared[edge].edges[0]);
+				const auto b = EdgePositions(mesh, shared[edge].patches[1], shared[edge].edges[1]);
+				auto same = a.size() == b.size();
+				for (std::size_t i = 0; same && i < a.size(); i++) same = length(a[i] - b[i]) <= 1e-5f;
+				if (!same) cracked[edge] = true;
+			}
+
+			for (auto patch = 0; patch < check.patches; patch++)
+			{
+				const auto factors = BezierFlatnessFactors(patches[patch], tolerance);
+				if (*std::max_element(factors.edges, factors.edges + 4) > 64.0f || std::max(factors.inside[0], factors.inside[1]) > 64.0f)
+				{
+					check.cappedPatches++;
+					continue;
+				}
+
+				// The surface against the triangle at its centre and the middle of its edges
+				for (auto i = mesh.patchIndexStart[patch]; i < mesh.patchIndexStart[patch + 1]; i += 3)
+				{
+					const BezierVertex* corners[3] = { &mesh.vertices[mesh.indices[i]], &mesh.vertices[mesh.indices[i + 1]], &mesh.vertices[mesh.indices[i + 2]] };
+					const float weights[4][3] = { { 1.0f / 3, 1.0f / 3, 1.0f / 3 }, { 0.5f, 0.5f, 0.0f }, { 0.0f, 0.5f, 0.5f }, { 0.5f, 0.0f, 0.5f } };
+					for (const auto& weight : weights)
+					{
+						const auto uv = corners[0]->uv * weight[0] + corners[1]->uv * weight[1] + corners[2]->uv * weight[2];
+						const auto flat = corners[0]->position * weight[0] + corners[1]->position * weight[1] + corners[2]->position * weight[2];
+						BezierVertex surface;
+						EvaluateBezierNaive(patches[patch], uv.x, uv.y, surface);
+						check.maxFlatnessErrorRatio = std::max(check.maxFlatnessErrorRatio, length(surface.position - flat) / tolerance);
+					}
+				}
+			}
+		}
+		check.crackedEdges = static_cast<int>(std::count(cracked.begin(), cracked.end(), true));
+		return check;
+	}
+
+	// Into a mesh EvaluateBezierGrid has already laid out for the same grid, so only the evaluation is timed
+	void EvaluateBezierGridNaive(const std::vector<BezierPatch>& patches, int segments, TessellatedMesh<BezierVertex>& mesh)
+	{
+		auto* vertex = mesh.vertices.data();
+		for (const auto& patch : patches)
+		{
+			for (auto row = 0; row <= segments; row++)
+			{
+				for (auto column = 0; column <= segments; column++)
+				{
+					EvaluateBezierNaive(patch, static_cast<float>(column) / segments, static_cast<float>(row) / segments, *vertex++);
+				}
+			}
+		}
+	}
+
+	double Seconds(std::chrono::steady_clock::time_point startTime)
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	// Evaluations per second of run, which evaluates evaluations vertices, repeated for a fifth of a second
+	template<typename Run>
+	double EvaluationsPerSecond(long long evaluations, const Run& run)
+	{
+		auto passes = 0;
+		const auto startTime = std::chrono::steady_clock::now();
+		do
+		{
+			run();
+			passes++;
+		} while (Seconds(startTime) < 0.2);
+		return passes * evaluations / Seconds(startTime);
+	}
+
+	// 240 patches, twenty teapots moved about, on grids of 4 to 64 segments
+	std::vector<BezierBenchmarkResult> BenchmarkBezierEvaluation()
+	{
+		std::vector<BezierPatch> teapot;
+		GetPotteryPatches(teapot);
+
+		std::mt19937 random(5489u);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<BezierPatch> patches;
+		for (auto copy = 0; copy < 20; copy++)
+		{
+			const auto offset = float3(unit(random), unit(random), unit(random)) * 20.0f;
+			const auto scale = 0.5f + unit(random);
+			for (auto patch : teapot)
+			{
+				for (auto& point : patch.points) point = point * scale + offset;
+				patches.push_back(patch);
+			}
+		}
+
+		std::vector<BezierBenchmarkResult> results;
+		const int segmentCounts[] = { 4, 8, 16, 32, 64 };
+		TessellatedMesh<BezierVertex> mesh;
+		for (const auto segments : segmentCounts)
+		{
+			BezierBenchmarkResult result = { static_cast<int>(patches.size()), segments, 0, 0.0, 0.0, 0.0, 0.0, ResolveThreadCount(0) };
+			result.evaluations = static_cast<long long>(patches.size()) * (segments + 1) * (segments + 1);
+			const auto basis = MakeBezierGridBasis(segments);
+
+			result.tableEvaluationsPerSecond = EvaluationsPerSecond(result.evaluations, [&]() { EvaluateBezierGrid(patches, basis, { false, 1 }, mesh); });
+			result.naiveEvaluationsPerSecond = EvaluationsPerSecond(result.evaluations, [&]() { EvaluateBezierGridNaive(patches, segments, mesh); });
+#ifdef BEZIER_PATCH_SSE2
+			result.simdEvaluationsPerSecond = EvaluationsPerSecond(result.evaluations, [&]() { EvaluateBezierGrid(patches, basis, { true, 1 }, mesh); });
+#endif
+			result.threadedEvaluationsPerSecond = EvaluationsPerSecond(result.evaluations, [&]() { EvaluateBezierGrid(patches, basis, { true, 0 }, mesh); });
+			results.push_back(result);
+		}
+		return results;
+	}
+
+	// The teapot's LOD levels from a tolerance of 0.0005 up
+	std::vector<BezierLODResult> BenchmarkBezierLOD()
+	{
+		std::vector<BezierPatch> patches;
+		GetPotteryPatches(patches);
+
+		std::vector<BezierLODResult> results;
+		BezierTessellator tessellator(patches);
+		TessellatedMesh<BezierVertex> mesh;
+		for (auto level = 0; level < 8; level++)
+		{
+			BezierLODResult result = { std::ldexp(0.0005f, level), 0, 0, 0.0, 0.0 };
+
+			auto startTime = std::chrono::steady_clock::now();
+			tessellator.Tessellate(result.tolerance, mesh);
+			result.buildMilliseconds = 1000.0 * Seconds(startTime);
+			result.triangles = static_cast<int>(mesh.indices.size() / 3);
+
+			const auto repeats = 10;
+			startTime = std::chrono::steady_clock::now();
+			for (auto repeat = 0; repeat < repeats; repeat++) tessellator.Tessellate(result.tolerance, mesh);
+			result.warmBuildMilliseconds = 1000.0 * Seconds(startTime) / repeats;
+
+			auto largest = 1.0f;
+			for (const auto& patch : patches)
+			{
+				const auto factors = BezierFlatnessFactors(patch, result.tolerance);
+				largest = std::max(largest, std::max(factors.inside[0], factors.inside[1]));
+			}
+			const auto segments = static_cast<int>(std::min(largest, 64.0f));
+			result.uniformTriangles = static_cast<int>(patches.size()) * 2 * segments * segments;
+			results.push_back(result);
+		}
+		return results;
+	}
+}
+
+void RunBezierPatchChecks(TestReport& report)
+{
+	const auto check = CheckBezierPatches();
+	report.ExpectAtMost("basis table position error against the naive evaluator", check.maxTablePositionError, 1e-5);
+	report.ExpectAtMost("basis table normal error, 1 - cos", check.maxTableNormalError, 1e-5);
+	report.ExpectZero("vertices the SSE2 path gives different bits for", check.simdMismatches);
+	report.Expect(check.sharedEdges > 0, "edges the teapot's patches share");
+	report.ExpectZero("shared edges tessellated differently either side", check.crackedEdges);
+	report.ExpectZero("patches needing a factor over 64", check.cappedPatches);
+	// Only the strips joining an edge flatter than the inside miss the tolerance, by the edge's coarser spacing
+	report.ExpectAtMost("surface distance over the tolerance", check.maxFlatnessErrorRatio, 4.0);
+}
+
+void RunBezierPatchBenchmarks()
+{
+	const auto check = CheckBezierPatches();
+	std::printf("%d patches, %lld vertices, table error %g and %g, %lld SIMD mismatches, %d shared edges, %d cracked, flatness ratio %.2f, %d capped\n",
+		check.patches, check.vertices, check.maxTablePositionError, check.maxTableNormalError, check.simdMismatches, check.sharedEdges, check.crackedEdges,
+		check.maxFlatnessErrorRatio, check.cappedPatches);
+
+	std::printf("\nevaluations in millions a second\n");
+	std::printf("%7s %8s %11s %7s %7s %7s %8s %7s\n", "patches", "segments", "evaluations", "naive", "table", "SSE2", "threaded", "threads");
+	for (const auto& result : BenchmarkBezierEvaluation())
+	{
+		std::printf("%7d %8d %11lld %7.1f %7.1f %7.1f %8.1f %7d\n", result.patches, result.segments, result.evaluations, result.naiveEvaluationsPerSecond / 1e6,
+			result.tableEvaluationsPerSecond / 1e6, result.simdEvaluationsPerSecond / 1e6, result.threadedEvaluationsPerSecond / 1e6, result.threads);
+	}
+
+	std::printf("\nthe teapot's LOD levels\n");
+	std::printf("%9s %9s %9s %8s %8s\n", "tolerance", "triangles", "uniform", "cold ms", "warm ms");
+	for (const auto& result : BenchmarkBezierLOD())
+	{
+		std::printf("%9.4f %9d %9d %8.2f %8.3f\n", result.tolerance, result.triangles, result.uniformTriangles, result.buildMilliseconds, result.warmBuildMilliseconds);
+	}
+}
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "HeightfieldTracer.h"
+#include "Common/ParallelFor.h"
+#include "Tests.h"
+
+using namespace HLSL;
+
+namespace
+{
+	struct HeightfieldTraceCheck
+	{
+		int rays;
+		int hits;
+		int mismatchedHits;				// rays Trace and TraceCells disagree on hitting
+		float maxDistanceError;			// between their hits
+		float maxHeightError;			// of Trace's hits off the bilinear surface, for rays starting above it
+		double meanTraceSteps;
+		double meanCellSteps;
+	};
+
+	struct HeightfieldTraceBenchmarkResult
+	{
+		int resolution;
+		int levels;
+		std::size_t bytes;				// heights and quadtree
+		double bakeMilliseconds;		// the heights from the noise
+		double buildMilliseconds;		// the quadtree
+		int rays;
+		int hits;
+		double traceRaysPerSecond;		// min-max quadtree, every hardware thread
+		double traceMeanSteps;
+		double marchRaysPerSecond;		// a sample per texel, every hardware thread
+		double marchMeanSteps;
+		int marchMissedHits;			// rays the quadtree hits and the march passes through
+		float marchMeanDistanceError;	// of the march's hits from the exact ones, in texels
+		int threads;
+	};
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point startTime)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	// Random rays from above, below and inside the bounds of a small, steep height map
+	HeightfieldTraceCheck CheckHeightfieldTracer(int rays)
+	{
+		// Four octaves three units high over eight units, so slopes often pass 45 degrees
+		TerrainBakeSettings settings;
+		settings.halfSize = 4.0f;
+		settings.resolution = 64;
+		settings.octaves = 4;
+		settings.amplitude = 3.0f;
+		const HeightfieldTracer tracer(BakeTerrainHeights(settings), settings.resolution, settings.halfSize);
+
+		const auto edge = settings.halfSize * (1.0f - 1.0f / settings.resolution) - 1e-4f;
+
+		HeightfieldTraceCheck check = { rays, 0, 0, 0.0f, 0.0f, 0.0, 0.0 };
+		std::mt19937 random(5489u);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		for (auto i = 0; i < rays; i++)
+		{
+			const auto origin = float3(unit(random) * 6.0f, 1.5f + unit(random) * 3.0f, unit(random) * 6.0f);
+			float3 direction;
+			do direction = float3(unit(random), unit(random), unit(random)); while (dot(direction, direction) > 1.0f || dot(direction, direction) < 1e-4f);
+			direction = normalize(direction);
+			// Every tenth ray in the plane of an axis, which never crosses the other axis' faces
+			if (i % 10 == 0) direction = normalize(i % 20 == 0 ? float3(1.0f, -0.1f, 0.0f) : float3(0.0f, -0.1f, -1.0f));
+
+			HeightfieldHit trace, cells;
+			const auto traceHit = tracer.Trace(origin, direction, 30.0f, trace);
+			const auto cellsHit = tracer.TraceCells(origin, direction, 30.0f, cells);
+			check.meanTraceSteps += trace.steps;
+			check.meanCellSteps += cells.steps;
+			if (traceHit != cellsHit)
+			{
+				check.mismatchedHits++;
+				continue;
+			}
+			if (!traceHit) continue;
+
+			check.hits++;
+			check.maxDistanceError = std::max(check.maxDistanceError, std::abs(trace.distance - cells.distance));
+			// Rays from under the surface stop where they enter the bounds, which may be on a side
+			const auto inside = std::max(std::abs(trace.position.x), std::abs(trace.position.z)) < edge;
+			if (origin.y > tracer.Height(origin.x, origin.z) && inside)
+			{
+				check.maxHeightError = std::max(check.maxHeightError, std::abs(trace.position.y - tracer.Height(trace.position.x, trace.position.z)));
+			}
+		}
+		check.meanTraceSteps /= rays;
+		check.meanCellSteps /= rays;
+		return check;
+	}
+
+	// Heights baked from the settings' noise, traced from over the start, grazing a corner and looking down from high up
+	HeightfieldTraceBenchmarkResult BenchmarkHeightfieldTracer(const TerrainBakeSettings& settings, int width, int height)
+	{
+		HeightfieldTraceBenchmarkResult result = {};
+		result.resolution = settings.resolution;
+		result.threads = ResolveThreadCount(settings.threads);
+
+		const auto startTime = std::chrono::steady_clock::now();
+		auto heights = BakeTerrainHeights(settings);
+		result.bakeMilliseconds = MillisecondsSince(startTime);
+		const HeightfieldTracer tracer(std::move(heights), settings.resolution, settings.halfSize, settings.threads);
+		result.levels = tracer.GetLevelCount();
+		result.bytes = tracer.GetBytes();
+		result.buildMilliseconds = tracer.GetBuildMilliseconds();
+
+		// Cameras a little over the ground where they stand
+		const auto over = float3(0.0f, tracer.Height(0.0f, -0.5f) + 0.5f, -0.5f);
+		const auto low = float3(-18.0f, tracer.Height(-18.0f, -18.0f) + 0.1f, -18.0f);
+		const auto high = float3(5.0f, settings.amplitude + 10.0f, 5.0f);
+		const float3 views[][2] =
+		{
+			{ over, float3(0.0f, over.y - 0.5f, 10.0f) },
+			{ low, float3(18.0f, low.y - 0.2f, 18.0f) },
+			{ high, float3(0.0f, 0.0f, 0.0f) },
+		};
+
+		// VS_RayTracedTerrain's canvas, x across [-1, 1] and y over the aspect ratio, a unit in front
+		std::vector<float3> origins;
+		std::vector<float3> directions;
+		for (const auto& view : views)
+		{
+			const auto forward = normalize(view[1] - view[0]);
+			const auto right = normalize(cross(float3(0.0f, 1.0f, 0.0f), forward));
+			const auto up = cross(forward, right);
+			for (auto y = 0; y < height; y++)
+			{
+				for (auto x = 0; x < width; x++)
+				{
+					const auto canvasX = 2.0f * (x + 0.5f) / width - 1.0f;
+					const auto canvasY = (1.0f - 2.0f * (y + 0.5f) / height) * height / width;
+					origins.push_back(view[0]);
+					directions.push_back(normalize(forward + right * canvasX + up * canvasY));
+				}
+			}
+		}
+		result.rays = static_cast<int>(origins.size());
+
+		const auto maxDistance = 100.0f;
+		std::vector<HeightfieldHit> traced(result.rays);
+		std::vector<HeightfieldHit> marched(result.rays);
+		std::vector<char> traceHits(result.rays);
+		std::vector<char> marchHits(result.rays);
+
+		auto rayStart = std::chrono::steady_clock::now();
+		ParallelFor(0, result.rays, settings.threads, [&](int i)
+		{
+			traceHits[i] = tracer.Trace(origins[i], directions[i], maxDistance, traced[i]);
+		}, 64);
+		result.traceRaysPerSecond = result.rays / (MillisecondsSince(rayStart) / 1000.0);
+
+		rayStart = std::chrono::steady_clock::now();
+		ParallelFor(0, result.rays, settings.threads, [&](int i)
+		{
+			marchHits[i] = tracer.March(origins[i], directions[i], maxDistance, 1.0f, marched[i]);
+		}, 64);
+		result.marchRaysPerSecond = result.rays / (MillisecondsSince(rayStart) / 1000.0);
+
+		auto bothHit = 0;
+		auto distanceError = 0.0;
+		const auto texelSize = 2.0f * settings.halfSize / settings.resolution;
+		for (auto i = 0; i < result.rays; i++)
+		{
+			result.traceMeanSteps += traced[i].steps;
+			result.marchMeanSteps += marched[i].steps;
+			if (!traceHits[i]) continue;
+			result.hits++;
+			if (!marchHits[i])
+			{
+				result.marchMissedHits++;
+				continue;
+			}
+			bothHit++;
+			distanceError += std::abs(marched[i].distance - traced[i].distance) / texelSize;
+		}
+		result.traceMeanSteps /= result.rays;
+		result.marchMeanSteps /= result.rays;
+		result.marchMeanDistanceError = bothHit > 0 ? static_cast<float>(distanceError / bothHit) : 0.0f;
+		return result;
+	}
+}
+
+void RunHeightfieldTracerChecks(TestReport& report)
+{
+	const auto check = CheckHeightfieldTracer(200000);
+	report.Expect(check.hits > 0, "random rays hitting the steep map");
+	report.ExpectZero("rays the quadtree and the cell walk disagree on hitting", check.mismatchedHits);
+	report.ExpectAtMost("distance between their hits", check.maxDistanceError, 1e-4);
+	report.ExpectAtMost("hit height off the bilinear surface", check.maxHeightError, 1e-4);
+}
+
+void RunHeightfieldTracerBenchmarks()
+{
+	const auto check = CheckHeightfieldTracer(200000);
+	std::printf("%d rays, %d hits, %d mismatched, distance error %g, height error %g, %.1f quadtree steps against %.1f cells\n", check.rays, check.hits,
+		check.mismatchedHits, check.maxDistanceError, check.maxHeightError, check.meanTraceSteps, check.meanCellSteps);
+
+	std::printf("\nfour octaves, 43200 rays over three views, rays in millions a second\n");
+	std::printf("%10s %6s %8s %8s %8s %8s %8s %8s %8s %8s %6s %10s %7s\n", "resolution", "levels", "MB", "bake ms", "build ms", "hits",
+		"quadtree", "steps", "march", "steps", "missed", "error tx", "threads");
+	const int resolutions[] = { 1024, 4096, 16384 };
+	for (const auto resolution : resolutions)
+	{
+		TerrainBakeSettings settings;
+		settings.resolution = resolution;
+		settings.octaves = 4;
+		settings.frequency = 0.25f;
+		settings.amplitude = 2.0f;
+		const auto result = BenchmarkHeightfieldTracer(settings, 160, 90);
+		std::printf("%10d %6d %8.0f %8.0f %8.0f %8d %8.2f %8.1f %8.2f %8.1f %6d %10.3f %7d\n", result.resolution, result.levels, result.bytes / 1048576.0,
+			result.bakeMilliseconds, result.buildMilliseconds, result.hits, result.traceRaysPerSecond / 1e6, result.traceMeanSteps,
+			result.marchRaysPerSecond / 1e6, result.marchMeanSteps, result.marchMissedHits, result.marchMeanDistanceError, result.threads);
+	}
+}
@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "Common/IntegerNoise.h"
+#include "Common/Noise.h"
+#include "Tests.h"
+
+using namespace HLSL;
+
+namespace
+{
+	struct HashGolden
+	{
+		int input[3];
+		std::uint32_t output[3];
+	};
+
+	// pcg3d as written, including the wrap of the int range
+	const HashGolden HashGoldens[] =
+	{
+		{ { 0, 0, 0 }, { 0x9bafd7c6u, 0xa8e88a6bu, 0x3f15482cu } },
+		{ { 1, 2, 3 }, { 0xfa9f79a6u, 0x48f2f44cu, 0x596f5ab1u } },
+		{ { -1, -1, -1 }, { 0xa5f48f40u, 0xa4533e83u, 0x515b8a62u } },
+		{ { 57, -1, 0 }, { 0x080e49d3u, 0x3592c542u, 0x9a1a8bbfu } },
+		{ { 2147483647, -2147483647 - 1, 12345 }, { 0x63085acbu, 0x95853bd5u, 0x730b6099u } },
+	};
+
+	const float GoldenPoints[][3] =
+	{
+		{ 0.5f, 0.25f, 0.125f },
+		{ -3.7f, 12.1f, 0.3f },
+		{ 1000.25f, -2000.5f, 3.75f },
+	};
+
+	// Bits of float4(value, derivative) at each golden point, per function. A compiler that
+	// fuses multiplies and adds (GCC with FMA and -ffp-contract=fast, MSVC's /fp:contract)
+	// changes the last bits, as does a GPU's mad.
+	const std::uint32_t FunctionGoldens[][3][4] =
+	{
+		{
+			{ 0x3f1afa84u, 0x3e3e3fb6u, 0xbdc4ff2fu, 0xbdca37e5u },
+			{ 0x3f3f8cdau, 0xbefce6edu, 0xbc5c2677u, 0xbe5343f7u },
+			{ 0x3e869c56u, 0xbd4d1c82u, 0xbe79f597u, 0xbdbefbfbu },
+		},
+		{
+			{ 0xbde4f351u, 0xbf1ace95u, 0xbf204e18u, 0xbe7ee013u },
+			{ 0x3ec16707u, 0x3f1b4fcfu, 0xbcc68621u, 0x3f38867cu },
+			{ 0x3e8452f7u, 0xbdb60504u, 0x3e890733u, 0xbf0914bfu },
+		},
+		{
+			{ 0x3d0c0036u, 0x3db35320u, 0x3e4fb560u, 0x3ec02c26u },
+			{ 0xbe6ac172u, 0xbf2a959fu, 0xbff3e882u, 0xbf4f4911u },
+			{ 0x3d73aaa5u, 0x3efe78c8u, 0x3f015f9fu, 0xbf8857cfu },
+		},
+		{
+			{ 0x3f1041fcu, 0x3dcaeea0u, 0x3e9a4365u, 0xbe9b5abau },
+			{ 0x3f26a837u, 0xbf1de20du, 0x3d951880u, 0x3f0add43u },
+			{ 0x3e9605deu, 0x3ebd7892u, 0xbe054fc8u, 0xbed04536u },
+		},
+	};
+
+	// Central differences in the derivative check
+	const float DifferenceStep = 1.0f / 256.0f;
+
+	struct Function
+	{
+		const char* name;
+		float4(*evaluate)(const float3&);
+	};
+
+	float4 Fbmd(const float3& x)
+	{
+		return fbmd(x, 4, 1.0f, 2.0f, 0.5f);
+	}
+
+	const Function Functions[] =
+	{
+		{ "value", valueNoised },
+		{ "gradient", gradientNoised },
+		{ "simplex", simplexNoised },
+		{ "fbmd", Fbmd },
+	};
+
+	std::uint32_t Bits(float value)
+	{
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	std::vector<float3> RandomPoints(int points, float halfSize)
+	{
+		std::mt19937 random(5489u);
+		std::uniform_real_distribution<float> coordinate(-halfSize, halfSize);
+		std::vector<float3> result(points);
+		for (auto& p : result)
+		{
+			p.x = coordinate(random);
+			p.y = coordinate(random);
+			p.z = coordinate(random);
+		}
+		return result;
+	}
+
+	// The terrain's normal, y up, from the height's slope along x and z
+	float3 HeightFieldNormal(float dx, float dz)
+	{
+		return normalize(float3(-dx, 1.0f, -dz));
+	}
+
+	struct IntegerNoiseFunctionCheck
+	{
+		const char* name;				// value, gradient, simplex or fbmd (4 octaves)
+		float minValue;
+		float maxValue;
+		float maxDerivative;			// longest analytic derivative
+		float maxDerivativeError;		// analytic derivative against central differences of the value, over maxDerivative
+		int goldenMismatches;			// points whose value and derivative are not the bits recorded from the C++ mirror
+	};
+
+	struct IntegerNoiseCheck
+	{
+		int hashMismatches;				// pcg3d outputs not the ones recorded when it was written
+		// Lattice points with the same value one step of (57, -1, 0) along, where the sin hash's n is unchanged
+		float latticeRepeats;
+		float sinHashRepeats;
+		std::vector<IntegerNoiseFunctionCheck> functions;
+	};
+
+	struct IntegerNoiseBenchmarkResult
+	{
+		const char* name;				// sin hash value noise, then as IntegerNoiseFunctionCheck
+		double pointsPerSecond;			// value and derivative, or the value alone for the sin hash
+		// Terrain normals, from the derivative or, for the sin hash, central differences
+		double normalsPerSecond;
+	};
+
+	// Random points in a cube of the given half size about the origin
+	IntegerNoiseCheck CheckIntegerNoise(int points, float halfSize)
+	{
+		IntegerNoiseCheck result = {};
+
+		for (const auto& golden : HashGoldens)
+		{
+			const auto h = pcg3d(asuint(int3(golden.input[0], golden.input[1], golden.input[2])));
+			if (h.x != golden.output[0] || h.y != golden.output[1] || h.z != golden.output[2]) result.hashMismatches++;
+		}
+
+		// Lattice points at the whole numbers under the random points
+		const auto samples = RandomPoints(points, halfSize);
+		auto latticeRepeats = 0;
+		auto sinHashRepeats = 0;
+		for (const auto& sample : samples)
+		{
+			const auto p = floor(sample);
+			const auto i = int3(p);
+			if (latticeValue(i) == latticeValue(i + int3(57, -1, 0))) latticeRepeats++;
+			const auto n = p.x + p.y * 57.0f + 113.0f * p.z;
+			const auto stepped = (p.x + 57.0f) + (p.y - 1.0f) * 57.0f + 113.0f * p.z;
+			if (hash(n) == hash(stepped)) sinHashRepeats++;
+		}
+		result.latticeRepeats = static_cast<float>(latticeRepeats) / points;
+		result.sinHashRepeats = static_cast<float>(sinHashRepeats) / points;
+
+		for (auto function = 0; function < 4; function++)
+		{
+			IntegerNoiseFunctionCheck check = {};
+			check.name = Functions[function].name;
+			check.minValue = 1e10f;
+			check.maxValue = -1e10f;
+
+			for (auto point = 0; point < 3; point++)
+			{
+				const auto golden = FunctionGoldens[function][point];
+				const auto n = Functions[function].evaluate(float3(GoldenPoints[point][0], GoldenPoints[point][1], GoldenPoints[point][2]));
+				if (Bits(n.x) != golden[0] || Bits(n.y) != golden[1] || Bits(n.z) != golden[2] || Bits(n.w) != golden[3]) check.goldenMismatches++;
+			}
+
+			auto maxError = 0.0f;
+			for (const auto& sample : samples)
+			{
+				const auto n = Functions[function].evaluate(sample);
+				check.minValue = std::min(check.minValue, n.x);
+				check.maxValue = std::max(check.maxValue, n.x);
+				check.maxDerivative = std::max(check.maxDerivative, length(n.yzw()));
+
+				for (auto axis = 0; axis < 3; axis++)
+				{
+					auto high = sample;
+					auto low = sample;
+					high[axis] += DifferenceStep;
+					low[axis] -= DifferenceStep;
+					// The step actually taken, after rounding the coordinates
+					const auto difference = (Functions[function].evaluate(high).x - Functions[function].evaluate(low).x) / (high[axis] - low[axis]);
+					const auto analytic = axis == 0 ? n.y : axis == 1 ? n.z : n.w;
+					maxError = std::max(maxError, std::abs(analytic - difference));
+				}
+			}
+			check.maxDerivativeError = check.maxDerivative > 0.0f ? maxError / check.maxDerivative : 0.0f;
+
+			result.functions.push_back(check);
+		}
+
+		return result;
+	}
+
+	std::vector<IntegerNoiseBenchmarkResult> BenchmarkIntegerNoise(int points, float halfSize)
+	{
+		const auto samples = RandomPoints(points, halfSize);
+		const auto seconds = [](std::chrono::steady_clock::time_point startTime)
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		};
+
+		// Summed so the evaluations are not optimised away
+		volatile float sink = 0.0f;
+		std::vector<IntegerNoiseBenchmarkResult> results;
+
+		{
+			IntegerNoiseBenchmarkResult result = {};
+			result.name = "sin hash";
+
+			auto sum = 0.0f;
+			auto startTime = std::chrono::steady_clock::now();
+			for (const auto& sample : samples)
+			{
+				sum += noise(sample);
+			}
+			result.pointsPerSecond = points / seconds(startTime);
+
+			startTime = std::chrono::steady_clock::now();
+			for (const auto& sample : samples)
+			{
+				const auto dx = (noise(float3(sample.x + DifferenceStep, 0.0f, sample.z)) - noise(float3(sample.x - DifferenceStep, 0.0f, sample.z))) / (2.0f * DifferenceStep);
+				const auto dz = (noise(float3(sample.x, 0.0f, sample.z + DifferenceStep)) - noise(float3(sample.x, 0.0f, sample.z - DifferenceStep))) / (2.0f * DifferenceStep);
+				sum += HeightFieldNormal(dx, dz).y;
+			}
+			result.normalsPerSecond = points / seconds(startTime);
+
+			sink = sink + sum;
+			results.push_back(result);
+		}
+
+		for (const auto& function : Functions)
+		{
+			IntegerNoiseBenchmarkResult result = {};
+			result.name = function.name;
+
+			auto sum = 0.0f;
+			auto startTime = std::chrono::steady_clock::now();
+			for (const auto& sample : samples)
+			{
+				sum += function.evaluate(sample).x;
+			}
+			result.pointsPerSecond = points / seconds(startTime);
+
+			startTime = std::chrono::steady_clock::now();
+			for (const auto& sample : samples)
+			{
+				const auto n = function.evaluate(float3(sample.x, 0.0f, sample.z));
+				sum += HeightFieldNormal(n.y, n.w).y;
+			}
+			result.normalsPerSecond = points / seconds(startTime);
+
+			sink = sink + sum;
+			results.push_back(result);
+		}
+
+		return results;
+	}
+}
+
+void RunIntegerNoiseChecks(TestReport& report)
+{
+	const auto result = CheckIntegerNoise(100000, 100.0f);
+	report.ExpectZero("pcg3d outputs differing from the recorded bits", result.hashMismatches);
+	report.ExpectAtMost("lattice values repeating one step of (57, -1, 0) along", result.latticeRepeats, 0.001);
+	for (const auto& function : result.functions)
+	{
+		const std::string name(function.name);
+		report.ExpectZero(name + " values and derivatives differing from the recorded bits", function.goldenMismatches);
+		report.Expect(function.minValue >= -1.0f && function.maxValue <= 1.0f, name + " values within [-1, 1]");
+		report.ExpectAtMost(name + " derivative error against central differences, over the largest derivative", function.maxDerivativeError, 0.005);
+	}
+}
+
+void RunIntegerNoiseBenchmarks()
+{
+	const auto check = CheckIntegerNoise(2000000, 100.0f);
+	std::printf("2000000 random points in a cube of half size 100, %d pcg3d outputs differing from the recorded bits\n", check.hashMismatches);
+	std::printf("lattice values repeating one step of (57, -1, 0) along: integer hash %.4f, sin hash %.4f\n", check.latticeRepeats, check.sinHashRepeats);
+	std::printf("%-9s %8s %8s %10s %16s %9s\n", "function", "min", "max", "derivative", "derivative error", "differing");
+	for (const auto& function : check.functions)
+	{
+		std::printf("%-9s %8.4f %8.4f %10.4f %16.2e %9d\n", function.name, function.minValue, function.maxValue, function.maxDerivative, function.maxDerivativeError, function.goldenMismatches);
+	}
+
+	std::printf("\n%-9s %12s %13s\n", "function", "points M/s", "normals M/s");
+	for (const auto& result : BenchmarkIntegerNoise(2000000, 100.0f))
+	{
+		std::printf("%-9s %12.1f %13.1f\n", result.name, result.pointsPerSecond / 1e6, result.normalsPerSecond / 1e6);
+	}
+}
@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "NebulaVolume.h"
+#include "Tests.h"
+
+using namespace SDF;
+
+namespace
+{
+	struct NebulaBenchmarkResult
+	{
+		int pixels;
+		int coveredPixels;					// rays that pass through the box
+		float occupiedFraction;				// cells of the grid with any density
+
+		double naiveSamplesPerPixel;		// over the covered pixels
+		int naiveMaxPixelSamples;
+		double naiveMilliseconds;
+
+		double samplesPerPixel;				// MarchSkipping
+		int maxPixelSamples;
+		double cellsVisitedPerPixel;
+		double cellsSkippedPerPixel;
+		double milliseconds;
+		int terminatedPixels;				// stopped by the opacity cutoff
+
+		// Against a fixed step march at an eighth of the naive step, largest channel difference
+		double naiveMeanError;
+		double naiveMaxError;
+		double meanError;
+		double maxError;
+	};
+
+	// Marches the nebula from every pixel both ways
+	NebulaBenchmarkResult BenchmarkNebula(const NebulaVolume& volume, const SDFCamera& camera, int width, int height, const NebulaMarchSettings& settings)
+	{
+		NebulaBenchmarkResult result = {};
+		result.pixels = width * height;
+		result.occupiedFraction = volume.GetOccupiedFraction();
+
+		std::vector<SDFRay> rays(result.pixels);
+		for (auto y = 0; y < height; y++)
+		{
+			for (auto x = 0; x < width; x++)
+			{
+				rays[y * width + x] = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+			}
+		}
+
+		const auto end = 1e10f;
+		std::vector<NebulaSample> naive(result.pixels);
+		auto startTime = std::chrono::steady_clock::now();
+		for (auto pixel = 0; pixel < result.pixels; pixel++)
+		{
+			naive[pixel] = volume.MarchNaive(rays[pixel], end, settings);
+		}
+		result.naiveMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		std::vector<NebulaSample> skipping(result.pixels);
+		startTime = std::chrono::steady_clock::now();
+		for (auto pixel = 0; pixel < result.pixels; pixel++)
+		{
+			skipping[pixel] = volume.MarchSkipping(rays[pixel], end, settings);
+		}
+		result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		auto referenceSettings = settings;
+		referenceSettings.fixedStep = settings.fixedStep / 8.0f;
+
+		long long naiveSamples = 0;
+		long long samples = 0;
+		long long cellsVisited = 0;
+		long long cellsSkipped = 0;
+		for (auto pixel = 0; pixel < result.pixels; pixel++)
+		{
+			if (naive[pixel].samples == 0) continue;
+
+			result.coveredPixels++;
+			naiveSamples += naive[pixel].samples;
+			result.naiveMaxPixelSamples = std::max(result.naiveMaxPixelSamples, naive[pixel].samples);
+			samples += skipping[pixel].samples;
+			result.maxPixelSamples = std::max(result.maxPixelSamples, skipping[pixel].samples);
+			cellsVisited += skipping[pixel].cellsVisited;
+			cellsSkipped += skipping[pixel].cellsSkipped;
+			if (skipping[pixel].colour.w >= settings.opacityCutoff) result.terminatedPixels++;
+
+			const auto reference = volume.MarchNaive(rays[pixel], end, referenceSettings).colour;
+			const auto error = [&reference](const float4& colour)
+			{
+				return std::max(std::max(std::abs(colour.x - reference.x), std::abs(colour.y - reference.y)), std::max(std::abs(colour.z - reference.z), std::abs(colour.w - reference.w)));
+			};
+			const auto naiveError = error(naive[pixel].colour);
+			const auto skippingError = error(skipping[pixel].colour);
+			result.naiveMeanError += naiveError;
+			result.naiveMaxError = std::max(result.naiveMaxError, static_cast<double>(naiveError));
+			result.meanError += skippingError;
+			result.maxError = std::max(result.maxError, static_cast<double>(skippingError));
+		}
+
+		if (result.coveredPixels > 0)
+		{
+			const auto covered = static_cast<double>(result.coveredPixels);
+			result.naiveSamplesPerPixel = naiveSamples / covered;
+			result.samplesPerPixel = samples / covered;
+			result.cellsVisitedPerPixel = cellsVisited / covered;
+			result.cellsSkippedPerPixel = cellsSkipped / covered;
+			result.naiveMeanError /= covered;
+			result.meanError /= covered;
+		}
+
+		return result;
+	}
+
+	// Densities at random points in the box above the bound of their cell
+	int CountBoundViolations(const NebulaVolume& volume, int pointCount, unsigned int seed)
+	{
+		const auto& settings = volume.GetSettings();
+		const auto extent = settings.boxMax - settings.boxMin;
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		auto violations = 0;
+		for (auto i = 0; i < pointCount; i++)
+		{
+			const auto p = settings.boxMin + float3(unit(generator) * extent.x, unit(generator) * extent.y, unit(generator) * extent.z);
+			const auto x = std::min(static_cast<int>((p.x - settings.boxMin.x) / extent.x * settings.cellsX), settings.cellsX - 1);
+			const auto y = std::min(static_cast<int>((p.y - settings.boxMin.y) / extent.y * settings.cellsY), settings.cellsY - 1);
+			const auto z = std::min(static_cast<int>((p.z - settings.boxMin.z) / extent.z * settings.cellsZ), settings.cellsZ - 1);
+			if (volume.Density(p) > volume.GetMaxDensityGrid()[(z * settings.cellsY + y) * settings.cellsX + x] + 1e-6f) violations++;
+		}
+		return violations;
+	}
+
+	struct NebulaView
+	{
+		const char* name;
+		SDFCamera camera;
+	};
+
+	const NebulaView NebulaViews[] =
+	{
+		{ "looking up", SDFCamera::LookAt(float3(0.0f, 0.5f, -0.5f), float3(0.0f, 8.0f, 20.0f)) },
+		{ "overhead", SDFCamera::LookAt(float3(0.0f, 1.0f, 0.0f), float3(0.1f, 20.0f, 0.3f)) },
+		{ "inside", SDFCamera::LookAt(float3(0.0f, 12.0f, 0.0f), float3(10.0f, 12.0f, 10.0f)) },
+		{ "horizon", SDFCamera::LookAt(float3(0.0f, 0.5f, -0.5f), float3(0.0f, 0.5f, 20.0f)) },
+	};
+}
+
+void RunNebulaVolumeChecks(TestReport& report)
+{
+	const NebulaVolume volume{ NebulaSettings() };
+	report.ExpectZero("densities above their cell's bound at 200000 random points", CountBoundViolations(volume, 200000, 5));
+	report.Expect(volume.GetOccupiedFraction() < 1.0f, "empty cells in the max density grid");
+
+	const NebulaMarchSettings settings;
+	for (const auto& view : NebulaViews)
+	{
+		const auto result = BenchmarkNebula(volume, view.camera, 80, 45, settings);
+		const std::string name(view.name);
+		report.Expect(result.coveredPixels > 0, name + " view pixels through the nebula");
+		report.Expect(result.samplesPerPixel < result.naiveSamplesPerPixel, name + " view fewer samples with skipping");
+		report.ExpectAtMost(name + " view largest skipping error", result.maxError, 0.05);
+	}
+}
+
+void RunNebulaVolumeBenchmarks()
+{
+	const NebulaVolume volume{ NebulaSettings() };
+	std::printf("%.1f%% of the grid occupied, %d of 2000000 random points above their cell's bound\n", 100.0 * volume.GetOccupiedFraction(), CountBoundViolations(volume, 2000000, 5));
+
+	const NebulaMarchSettings settings;
+	std::printf("the nebula at 320x180, naive -> skipping, errors against an eighth of the naive step\n");
+	std::printf("%-10s %7s %16s %13s %18s %7s %7s %10s %17s %17s\n", "view", "covered", "samples/pixel", "max samples", "ms", "cells", "skipped", "terminated", "mean error", "max error");
+	for (const auto& view : NebulaViews)
+	{
+		const auto result = BenchmarkNebula(volume, view.camera, 320, 180, settings);
+		std::printf("%-10s %7d %6.1f -> %6.1f %4d -> %4d %7.0f -> %7.0f %7.1f %7.1f %10d %7.4f -> %6.4f %7.4f -> %6.4f\n", view.name, result.coveredPixels,
+			result.naiveSamplesPerPixel, result.samplesPerPixel, result.naiveMaxPixelSamples, result.maxPixelSamples, result.naiveMilliseconds, result.milliseconds,
+			result.cellsVisitedPerPixel, result.cellsSkippedPerPixel, result.terminatedPixels, result.naiveMeanError, result.meanError, result.naiveMaxError, result.maxError);
+	}
+}
@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "PatchCulling.h"
+#include "TerrainQuadtree.h"
+#include "Tests.h"
+
+using namespace HLSL;
+
+namespace
+{
+	struct PatchCullingBenchmarkResult
+	{
+		const char* name;
+		int patches;
+		int frames;
+		// Over every frame
+		double frustumCulledFraction;
+		double backfaceCulledFraction;
+		// Per frame
+		double scalarMicroseconds;
+		double simdMicroseconds;
+		double threadedMicroseconds;	// SIMD on every hardware thread
+		int mismatches;					// patches the SIMD paths and the scalar one disagree on
+	};
+
+	// XMMatrixLookToRH times XMMatrixPerspectiveFovRH, yaw 0 looking down -z like Camera
+	void ViewProjection(const float3& eye, float yaw, float pitch, float aspect, float nearZ, float farZ, float* m)
+	{
+		const auto forward = float3(std::sin(yaw) * std::cos(pitch), std::sin(pitch), -std::cos(yaw) * std::cos(pitch));
+		const auto r2 = -forward;
+		const auto r0 = normalize(cross(float3(0.0f, 1.0f, 0.0f), r2));
+		const auto r1 = cross(r2, r0);
+		const float view[16] =
+		{
+			r0.x, r1.x, r2.x, 0.0f,
+			r0.y, r1.y, r2.y, 0.0f,
+			r0.z, r1.z, r2.z, 0.0f,
+			-dot(r0, eye), -dot(r1, eye), -dot(r2, eye), 1.0f,
+		};
+
+		const auto h = 1.0f / std::tan(0.5f * 70.0f * 3.14159265f / 180.0f);
+		const auto range = farZ / (nearZ - farZ);
+		const float projection[16] =
+		{
+			h / aspect, 0.0f, 0.0f, 0.0f,
+			0.0f, h, 0.0f, 0.0f,
+			0.0f, 0.0f, range, -1.0f,
+			0.0f, 0.0f, range * nearZ, 0.0f,
+		};
+
+		for (auto row = 0; row < 4; row++)
+		{
+			for (auto column = 0; column < 4; column++)
+			{
+				auto sum = 0.0f;
+				for (auto k = 0; k < 4; k++) sum += view[row * 4 + k] * projection[k * 4 + column];
+				m[row * 4 + column] = sum;
+			}
+		}
+	}
+
+	struct Frame
+	{
+		float3 camera;
+		CullingFrustum frustum;
+	};
+
+	double MicrosecondsSince(std::chrono::steady_clock::time_point startTime)
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	// Times each path over the frames, bounds[f] being frame f's patches
+	PatchCullingBenchmarkResult Measure(const char* name, const std::vector<PatchBounds>& bounds, const std::vector<Frame>& frames)
+	{
+		PatchCullingBenchmarkResult result = {};
+		result.name = name;
+		result.frames = static_cast<int>(frames.size());
+
+		std::vector<std::uint32_t> scalarVisible;
+		std::vector<std::uint32_t> simdVisible;
+		long long patches = 0;
+		long long frustumCulled = 0;
+		long long backfaceCulled = 0;
+		for (auto f = 0; f < result.frames; f++)
+		{
+			const auto& frame = frames[f];
+			const auto& patchBounds = bounds[bounds.size() == 1 ? 0 : f];
+
+			PatchCullingSettings settings;
+			settings.simd = false;
+			settings.threads = 1;
+			auto startTime = std::chrono::steady_clock::now();
+			const auto stats = CullPatches(patchBounds, frame.frustum, frame.camera, settings, scalarVisible);
+			result.scalarMicroseconds += MicrosecondsSince(startTime);
+
+			settings.simd = true;
+			startTime = std::chrono::steady_clock::now();
+			CullPatches(patchBounds, frame.frustum, frame.camera, settings, simdVisible);
+			result.simdMicroseconds += MicrosecondsSince(startTime);
+
+			const auto countMismatches = [&scalarVisible](const std::vector<std::uint32_t>& other)
+			{
+				std::vector<std::uint32_t> difference;
+				std::set_symmetric_difference(scalarVisible.begin(), scalarVisible.end(), other.begin(), other.end(), std::back_inserter(difference));
+				return static_cast<int>(difference.size());
+			};
+			result.mismatches += countMismatches(simdVisible);
+
+			settings.threads = 0;
+			startTime = std::chrono::steady_clock::now();
+			CullPatches(patchBounds, frame.frustum, frame.camera, settings, simdVisible);
+			result.threadedMicroseconds += MicrosecondsSince(startTime);
+			result.mismatches += countMismatches(simdVisible);
+
+			result.patches = std::max(result.patches, stats.patches);
+			patches += stats.patches;
+			frustumCulled += stats.frustumCulled;
+			backfaceCulled += stats.backfaceCulled;
+		}
+
+		result.frustumCulledFraction = static_cast<double>(frustumCulled) / patches;
+		result.backfaceCulledFraction = static_cast<double>(backfaceCulled) / patches;
+		result.scalarMicroseconds /= result.frames;
+		result.simdMicroseconds /= result.frames;
+		result.threadedMicroseconds /= result.frames;
+		return result;
+	}
+
+	// The app's camera turning on the spot over its terrain's cells and chunks, then a low flight over a 4 km x 4 km terrain's 1024 x 1024 cells
+	std::vector<PatchCullingBenchmarkResult> BenchmarkPatchCulling(int frames)
+	{
+		std::vector<PatchCullingBenchmarkResult> results;
+		const auto aspect = 16.0f / 9.0f;
+
+		// The app's camera turning on the spot, half a unit over the ground, each frame's chunks' cells
+		{
+			const TerrainMaps maps{ TerrainBakeSettings() };
+			const TerrainQuadtree quadtree(maps, TerrainQuadtreeSettings());
+			const auto cells = quadtree.GetSettings().gridDimension;
+
+			std::vector<Frame> sceneFrames(frames);
+			std::vector<PatchBounds> sceneBounds(frames);
+			std::vector<PatchBounds> chunkBounds(frames);
+			std::vector<TerrainChunk> chunks;
+			for (auto f = 0; f < frames; f++)
+			{
+				auto& frame = sceneFrames[f];
+				frame.camera = float3(0.0f, maps.SampleHeight(0.0f, -0.5f, 0) + 0.5f, -0.5f);
+				float m[16];
+				ViewProjection(frame.camera, 6.2831853f * f / frames, -0.2f, aspect, 0.01f, 100.0f, m);
+				frame.frustum = MakeCullingFrustum(m);
+
+				quadtree.Select(frame.camera, chunks);
+				for (const auto& chunk : chunks)
+				{
+					const auto half = chunk.quadrant < 0 ? 0.0f : 0.5f * chunk.size;
+					const auto x = chunk.x + (chunk.quadrant & 1) * half;
+					const auto z = chunk.z + (chunk.quadrant >> 1) * half;
+					sceneBounds[f].AddTerrainCells(maps, x, z, chunk.quadrant < 0 ? chunk.size : half, chunk.quadrant < 0 ? cells : cells / 2);
+					chunkBounds[f].AddTerrainCells(maps, x, z, chunk.quadrant < 0 ? chunk.size : half, 1);
+				}
+			}
+			results.push_back(Measure("scene terrain cells", sceneBounds, sceneFrames));
+			// What Terrain culls, one box and cone per chunk
+			results.push_back(Measure("scene terrain chunks", chunkBounds, sceneFrames));
+		}
+
+		// Every cell of a large terrain, flown over low and looking ahead
+		{
+			TerrainBakeSettings settings;
+			settings.halfSize = 2000.0f;
+			settings.resolution = 1024;
+			settings.octaves = 6;
+			settings.frequency = 1.0f / 400.0f;
+			settings.amplitude = 400.0f;
+			const TerrainMaps maps(settings);
+
+			std::vector<PatchBounds> terrainBounds(1);
+			terrainBounds[0].AddTerrainCells(maps, -settings.halfSize, -settings.halfSize, 2.0f * settings.halfSize, 1024);
+
+			std::vector<Frame> flightFrames(frames);
+			for (auto f = 0; f < frames; f++)
+			{
+				const auto t = f / static_cast<float>(std::max(frames - 1, 1));
+				const auto x = -0.8f * settings.halfSize + 1.6f * settings.halfSize * t;
+				const auto z = 0.8f * settings.halfSize - 1.6f * settings.halfSize * t;
+				auto& frame = flightFrames[f];
+				frame.camera = float3(x, maps.SampleHeight(x, z, 0) + 0.05f * settings.amplitude, z);
+				float m[16];
+				ViewProjection(frame.camera, 0.785f + 0.5f * std::sin(6.2831853f * t), -0.15f, aspect, 1.0f, 2.0f * settings.halfSize, m);
+				frame.frustum = MakeCullingFrustum(m);
+			}
+			results.push_back(Measure("1M cell terrain", terrainBounds, flightFrames));
+		}
+
+		return results;
+	}
+}
+
+void RunPatchCullingChecks(TestReport& report)
+{
+	for (const auto& result : BenchmarkPatchCulling(4))
+	{
+		const std::string name(result.name);
+		report.ExpectZero(name + " patches the SIMD and threaded paths disagree with the scalar one on", result.mismatches);
+		report.Expect(result.frustumCulledFraction > 0.0, name + " patches frustum culled");
+	}
+}
+
+void RunPatchCullingBenchmarks()
+{
+	std::printf("60 frames on one core, microseconds per frame\n");
+	std::printf("%-20s %8s %8s %8s %9s %8s %8s %10s\n", "case", "patches", "frustum", "backface", "scalar", "SIMD", "threaded", "mismatches");
+	for (const auto& result : BenchmarkPatchCulling(60))
+	{
+		std::printf("%-20s %8d %7.1f%% %7.2f%% %9.0f %8.0f %8.0f %10d\n", result.name, result.patches, 100.0 * result.frustumCulledFraction,
+			100.0 * result.backfaceCulledFraction, result.scalarMicroseconds, result.simdMicroseconds, result.threadedMicroseconds, result.mismatches);
+	}
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "SDFBrickMap.h"
+#include "Tests.h"
+
+namespace
+{
+	struct SDFBrickMapBenchmarkResult
+	{
+		SDFBrickMapStats stats;
+		double singleThreadBakeMilliseconds;
+
+		// Over points spread through the bounds and over points inside the narrow band
+		double analyticLookupsPerSecond;
+		double bakedLookupsPerSecond;
+		double fallbackLookupsPerSecond;
+		double analyticBandLookupsPerSecond;
+		double bakedBandLookupsPerSecond;
+		double fallbackBandLookupsPerSecond;
+
+		double meanBandError;		// baked against analytic in the narrow band
+		double maxBandError;
+		double maxSurfaceError;		// Evaluate closer than the fallback distance, 0 unless the fallback is missed
+		double maxOverestimate;		// baked over analytic outside the band
+	};
+
+	SDFBrickMapBenchmarkResult BenchmarkBrickMap(const SDFScene& scene, const SDFBrickMapSettings& settings, int sampleCount, unsigned int seed)
+	{
+		SDFBrickMapBenchmarkResult result;
+
+		auto singleThread = settings;
+		singleThread.threads = 1;
+		SDFBrickMap singleThreadMap(scene, singleThread);
+		singleThreadMap.Bake();
+		result.singleThreadBakeMilliseconds = singleThreadMap.GetStats().bakeMilliseconds;
+
+		SDFBrickMap map(scene, settings);
+		map.Bake();
+		result.stats = map.GetStats();
+
+		// Points spread through the bounds, and points inside the narrow band where a marcher spends most steps
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		const auto boundsMin = map.GetBoundsMin();
+		const auto extent = map.GetBoundsMax() - boundsMin;
+
+		std::vector<float3> points, bandPoints;
+		std::vector<float> analytic, bandAnalytic;
+		while (static_cast<int>(bandPoints.size()) < sampleCount)
+		{
+			const auto p = boundsMin + float3(unit(generator) * extent.x, unit(generator) * extent.y, unit(generator) * extent.z);
+			const auto distance = scene.Evaluate(p).x;
+			if (static_cast<int>(points.size()) < sampleCount)
+			{
+				points.push_back(p);
+				analytic.push_back(distance);
+			}
+			if (std::fabs(distance) < settings.narrowBand)
+			{
+				bandPoints.push_back(p);
+				bandAnalytic.push_back(distance);
+			}
+		}
+
+		const auto throughput = [](const std::vector<float3>& set, const auto& lookup)
+		{
+			auto sink = 0.0f;
+			const auto startTime = std::chrono::steady_clock::now();
+			for (const auto& p : set) sink += lookup(p).x;
+			const auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+			volatile auto keep = sink;
+			(void)keep;
+			return set.size() / seconds;
+		};
+
+		const auto analyticLookup = [&](const float3& p) { return scene.Evaluate(p); };
+		const auto bakedLookup = [&](const float3& p) { return map.SampleBaked(p); };
+		const auto fallbackLookup = [&](const float3& p) { return map.Evaluate(p); };
+
+		result.analyticLookupsPerSecond = throughput(points, analyticLookup);
+		result.bakedLookupsPerSecond = throughput(points, bakedLookup);
+		result.fallbackLookupsPerSecond = throughput(points, fallbackLookup);
+		result.analyticBandLookupsPerSecond = throughput(bandPoints, analyticLookup);
+		result.bakedBandLookupsPerSecond = throughput(bandPoints, bakedLookup);
+		result.fallbackBandLookupsPerSecond = throughput(bandPoints, fallbackLookup);
+
+		result.meanBandError = 0.0;
+		result.maxBandError = 0.0;
+		result.maxSurfaceError = 0.0;
+		for (auto i = 0; i < static_cast<int>(bandPoints.size()); i++)
+		{
+			const auto error = std::fabs(map.SampleBaked(bandPoints[i]).x - bandAnalytic[i]);
+			result.meanBandError += error;
+			result.maxBandError = std::max(result.maxBandError, static_cast<double>(error));
+
+			const auto evaluated = map.Evaluate(bandPoints[i]).x;
+			if (evaluated < settings.fallbackDistance)
+			{
+				result.maxSurfaceError = std::max(result.maxSurfaceError, static_cast<double>(std::fabs(evaluated - bandAnalytic[i])));
+			}
+		}
+		result.meanBandError /= bandPoints.size();
+
+		result.maxOverestimate = 0.0;
+		for (auto i = 0; i < static_cast<int>(points.size()); i++)
+		{
+			if (std::fabs(analytic[i]) < settings.narrowBand) continue;
+			result.maxOverestimate = std::max(result.maxOverestimate, static_cast<double>(map.SampleBaked(points[i]).x - analytic[i]));
+		}
+
+		return result;
+	}
+}
+
+void RunSDFBrickMapChecks(TestReport& report)
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	SDFBrickMapSettings settings;
+	settings.voxelSize = 0.04f;
+	settings.narrowBand = 0.2f;
+	settings.fallbackDistance = 0.08f;
+	const auto result = BenchmarkBrickMap(scene, settings, 5000, 3);
+	report.ExpectAtMost("distance error with the analytic fallback near the surface", result.maxSurfaceError, 1e-6);
+	report.ExpectAtMost("largest baked distance error in the band, in voxels", result.maxBandError / settings.voxelSize, 1.0);
+	report.ExpectAtMost("largest overestimate outside the band, in voxels", result.maxOverestimate / settings.voxelSize, 1.0);
+}
+
+void RunSDFBrickMapBenchmarks()
+{
+	struct Case
+	{
+		const char* name;
+		SDFScene scene;
+		int distanceBits;
+	};
+	const Case cases[] =
+	{
+		{ "default", SDFScene::CreateDefaultScene(), 8 },
+		{ "default", SDFScene::CreateDefaultScene(), 16 },
+		{ "200 random", SDFScene::CreateRandomScene(200, 7, 3.0f), 8 },
+	};
+
+	std::printf("brick maps at voxel 0.01, band 0.05, fallback 0.02, lookups in millions a second\n");
+	std::printf("%-11s %4s %7s %9s %9s %11s %9s %9s %9s %9s %9s %9s %9s %10s %10s %10s\n", "scene", "bits", "bricks", "MB", "dense MB", "1 thread ms", "bake ms",
+		"analytic", "baked", "fallback", "band", "baked", "fallback", "band error", "max", "over");
+	for (const auto& test : cases)
+	{
+		SDFBrickMapSettings settings;
+		settings.distanceBits = test.distanceBits;
+		const auto result = BenchmarkBrickMap(test.scene, settings, 100000, 3);
+		const auto& stats = result.stats;
+		std::printf("%-11s %4d %7d %9.2f %9.1f %11.0f %9.0f %9.2f %9.2f %9.2f %9.2f %9.2f %9.2f %10.5f %10.5f %10.5f\n", test.name, test.distanceBits, stats.bricks, stats.totalBytes / 1e6,
+			stats.denseBytes / 1e6, result.singleThreadBakeMilliseconds, stats.bakeMilliseconds, result.analyticLookupsPerSecond / 1e6, result.bakedLookupsPerSecond / 1e6,
+			result.fallbackLookupsPerSecond / 1e6, result.analyticBandLookupsPerSecond / 1e6, result.bakedBandLookupsPerSecond / 1e6, result.fallbackBandLookupsPerSecond / 1e6,
+			result.meanBandError, result.maxBandError, result.maxOverestimate);
+	}
+}
@@ -0,0 +1,103 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "SDFConePrepass.h"
+#include "Tests.h"
+
+namespace
+{
+	struct SDFConePrepassBenchmarkResult
+	{
+		int width;
+		int height;
+		SDFConePrepassStats prepass;
+		SDFImageStats full;			// every pixel starts at epsilon
+		SDFImageStats withPrepass;	// pixels start at their tile's depth
+		long long stepsSaved;		// full steps minus prepass and full resolution steps
+		double averageStepsFull;
+		double averageStepsWithPrepass;	// per pixel, cone steps included
+		int skippedSurfaces;		// the full march hit a surface in front of the prepass result
+		int recoveredSurfaces;		// the full march stepped over a thin surface the prepass march hit
+	};
+
+	SDFConePrepassBenchmarkResult BenchmarkConePrepass(const SDFScene& scene, const SDFCamera& camera, int width, int height, int tileSize)
+	{
+		SDFConePrepassBenchmarkResult result;
+		result.width = width;
+		result.height = height;
+
+		SDFMarchSettings settings;
+		const SDFRayMarcher marcher(scene, settings);
+		std::vector<float4> fullImage, prepassImage;
+
+		result.full = marcher.RenderImage(camera, width, height, &fullImage);
+
+		SDFConePrepass prepass(scene, settings, tileSize);
+		prepass.Run(camera, width, height);
+		result.prepass = prepass.GetStats();
+		result.withPrepass = marcher.RenderImage(camera, width, height, &prepassImage, &prepass);
+
+		const auto pixels = static_cast<double>(width) * height;
+		result.stepsSaved = result.full.steps - (result.prepass.coneSteps + result.withPrepass.steps);
+		result.averageStepsFull = result.full.steps / pixels;
+		result.averageStepsWithPrepass = (result.prepass.coneSteps + result.withPrepass.steps) / pixels;
+
+		result.skippedSurfaces = 0;
+		result.recoveredSurfaces = 0;
+		for (auto i = 0; i < width * height; i++)
+		{
+			if (prepassImage[i].w > fullImage[i].w + 0.001f) result.skippedSurfaces++;
+			if (prepassImage[i].w < fullImage[i].w - 0.001f) result.recoveredSurfaces++;
+		}
+
+		return result;
+	}
+
+	struct PrepassCamera
+	{
+		const char* name;
+		SDFCamera camera;
+	};
+
+	std::vector<PrepassCamera> GetPrepassCameras()
+	{
+		return
+		{
+			{ "close", SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f)) },
+			{ "wide", SDFCamera::LookAt(float3(0.0f, 1.5f, -4.0f), float3(0.0f, 0.5f, 0.0f)) },
+		};
+	}
+}
+
+void RunSDFConePrepassChecks(TestReport& report)
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	for (const auto& camera : GetPrepassCameras())
+	{
+		for (auto tileSize : { 8, 16 })
+		{
+			const auto result = BenchmarkConePrepass(scene, camera.camera, 160, 90, tileSize);
+			const auto name = std::string(camera.name) + " camera, " + std::to_string(tileSize) + "px tiles";
+			report.ExpectAtMost(name + ", pixels whose surface the prepass skipped", result.skippedSurfaces, 2);
+			report.Expect(result.stepsSaved > 0, name + ", steps saved by the prepass");
+		}
+	}
+}
+
+void RunSDFConePrepassBenchmarks()
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	std::printf("default scene at 1920x1080, steps in millions\n");
+	std::printf("%-6s %5s %9s %8s %10s %10s %8s %8s %8s %8s %8s %8s\n", "camera", "tile", "full", "per px", "cone", "pixel", "per px",
+		"saved", "saved %", "empty", "skipped", "recovered");
+	for (const auto& camera : GetPrepassCameras())
+	{
+		for (auto tileSize : { 8, 16 })
+		{
+			const auto r = BenchmarkConePrepass(scene, camera.camera, 1920, 1080, tileSize);
+			std::printf("%-6s %5d %9.2f %8.2f %10.2f %10.2f %8.2f %8.1f %8.1f %8d %8d %8d\n", camera.name, tileSize, r.full.steps / 1e6, r.averageStepsFull,
+				r.prepass.coneSteps / 1e6, r.withPrepass.steps / 1e6, r.averageStepsWithPrepass, r.stepsSaved / 1e6, 100.0 * r.stepsSaved / r.full.steps,
+				r.prepass.emptyTiles, r.skippedSurfaces, r.recoveredSurfaces);
+		}
+	}
+}
@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "Common/IntegerNoise.h"
+#include "SDFDepthBounding.h"
+#include "Tests.h"
+
+using namespace SDF;
+
+namespace
+{
+	struct SDFDepthBoundingResult
+	{
+		int pixels;
+		int coveredPixels;					// depth below 1, something was rasterized there
+		int skippedPixels;					// the ray starts behind the rasterized geometry and is not marched
+
+		// PS_RayMarchObjects, MarchCulled to MAX_DIST against the same march clamped to the depth
+		long long steps;
+		long long boundedSteps;
+		long long primitiveEvaluations;
+		long long boundedPrimitiveEvaluations;
+		double milliseconds;
+		double boundedMilliseconds;
+		int mismatchedPixels;				// visible through the depth test in one pass and not the other, or at another depth
+		// March without bounding culling, where rays that miss every primitive run on to MAX_DIST
+		long long unculledSteps;
+		long long boundedUnculledSteps;
+
+		// PS_RayTracedTerrain, plane tests of the eye ray and its reflections
+		long long planeIntersections;
+		long long boundedPlaneIntersections;
+		long long shadedHits;
+		long long boundedShadedHits;
+	};
+
+	// Terrain's scale and the range of valueNoised(), baked by TerrainMaps, that DS_Terrain adds to y
+	const auto TerrainHalfSize = 20.0f;
+	const auto TerrainMaxHeight = 1.0f;
+	// The quintic fade in valueNoised() has a slope of at most 30 / 16 per axis, so the
+	// height changes by at most 1.875 sqrt(2) per unit across the plane and a point's
+	// height above the surface over sqrt(1 + 1.875^2 * 2) is a safe step
+	const auto TerrainStepScale = 1.0f / 2.84f;
+
+	float TerrainHeight(float x, float z)
+	{
+		return HLSL::valueNoised(float3(x, 0.0f, z)).x;
+	}
+
+	// Distance along the ray to the displaced terrain, or -1 for a miss
+	float IntersectTerrain(const SDFRay& ray, float end)
+	{
+		// Clip to the box the terrain lies in
+		auto tNear = 0.0f;
+		auto tFar = end;
+		const float3 boxMin(-TerrainHalfSize, 0.0f, -TerrainHalfSize);
+		const float3 boxMax(TerrainHalfSize, TerrainMaxHeight, TerrainHalfSize);
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			if (std::abs(ray.d[axis]) < 1e-8f)
+			{
+				if (ray.o[axis] < boxMin[axis] || ray.o[axis] > boxMax[axis]) return -1.0f;
+				continue;
+			}
+			auto t0 = (boxMin[axis] - ray.o[axis]) / ray.d[axis];
+			auto t1 = (boxMax[axis] - ray.o[axis]) / ray.d[axis];
+			if (t0 > t1) std::swap(t0, t1);
+			tNear = std::max(tNear, t0);
+			tFar = std::min(tFar, t1);
+		}
+		if (tNear > tFar) return -1.0f;
+
+		auto previous = tNear;
+		auto t = tNear;
+		for (auto i = 0; i < 1024 && t <= tFar; i++)
+		{
+			const auto p = ray.o + t * ray.d;
+			const auto gap = p.y - TerrainHeight(p.x, p.z);
+
+			if (gap < 0.0f)
+			{
+				// Crossed the surface since the last sample, bisect for it
+				auto low = previous;
+				auto high = t;
+				for (auto j = 0; j < 16; j++)
+				{
+					const auto middle = 0.5f * (low + high);
+					const auto q = ray.o + middle * ray.d;
+					if (q.y - TerrainHeight(q.x, q.z) < 0.0f) high = middle;
+					else low = middle;
+				}
+				return high;
+			}
+			if (gap < 0.0001f) return t;
+
+			previous = t;
+			// The minimum step keeps grazing rays moving, the bisection catches what it skips
+			t += std::max(gap * TerrainStepScale, 0.001f * t);
+		}
+		return -1.0f;
+	}
+
+	// Plane tests and shaded hits of RayTracing in PS_RayTracedTerrain, the
+	// eye ray clamped to end and its reflections to the far plane
+	void TraceReflectivePlane(const SDFRay& eyeRay, float end, float farPlane, long long& intersections, long long& shadedHits)
+	{
+		const auto planeHeight = -15.0f;
+		auto ray = eyeRay;
+		auto maxt = end;
+
+		for (auto bounce = 0; bounce < 5; bounce++)
+		{
+			intersections++;
+			if (std::abs(ray.d.y) <= 0.0001f) return;
+
+			const auto t = (planeHeight - ray.o.y) / ray.d.y;
+			if (t <= 0.0001f || t >= maxt) return;
+
+			shadedHits++;
+			ray.o = ray.o + t * ray.d;
+			ray.d = float3(ray.d.x, -ray.d.y, ray.d.z);
+			maxt = farPlane;
+		}
+	}
+
+	// Depth buffer of Terrain's 40 x 40 plane displaced by DS_Terrain's noise, without the small animated models
+	std::vector<float> RenderTerrainDepth(const SDFCamera& camera, int width, int height, const SDFDepthProjection& projection)
+	{
+		std::vector<float> depthBuffer(width * height, 1.0f);
+
+		for (auto y = 0; y < height; y++)
+		{
+			for (auto x = 0; x < width; x++)
+			{
+				const auto ray = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+				const auto t = IntersectTerrain(ray, projection.farPlane * 2.0f);
+				if (t < 0.0f) continue;
+
+				const auto viewDepth = t * dot(ray.d, camera.forward);
+				if (viewDepth > projection.nearPlane && viewDepth < projection.farPlane) depthBuffer[y * width + x] = projection.ToDepth(viewDepth);
+			}
+		}
+
+		return depthBuffer;
+	}
+
+	// Runs both ray passes over every pixel with and without their rays clamped to depthBuffer
+	SDFDepthBoundingResult BenchmarkDepthBounding(const SDFScene& scene, const SDFCamera& camera, int width, int height, const std::vector<float>& depthBuffer, const SDFDepthProjection& projection)
+	{
+		SDFDepthBoundingResult result = {};
+		result.pixels = width * height;
+
+		SDFMarchSettings settings;
+		settings.boundingCulling = true;
+		settings.fractalPixelAngle = camera.PixelAngle(width);
+		const SDFRayMarcher marcher(scene, settings);
+		std::vector<SDFBoundInterval> intervals;
+
+		std::vector<SDFRay> rays(result.pixels);
+		std::vector<float> ends(result.pixels);
+		for (auto y = 0; y < height; y++)
+		{
+			for (auto x = 0; x < width; x++)
+			{
+				const auto pixel = y * width + x;
+				rays[pixel] = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+				ends[pixel] = DepthBoundDistance(depthBuffer[pixel], rays[pixel], camera, projection, settings.maxDistance);
+				if (depthBuffer[pixel] < 1.0f) result.coveredPixels++;
+				if (ends[pixel] <= settings.epsilon) result.skippedPixels++;
+			}
+		}
+
+		// Each pass's depth, -1 where the depth test would reject or nothing was hit
+		std::vector<float> visible(result.pixels);
+
+		auto startTime = std::chrono::steady_clock::now();
+		for (auto pixel = 0; pixel < result.pixels; pixel++)
+		{
+			const auto hit = marcher.MarchCulled(rays[pixel], settings.epsilon, settings.maxDistance, intervals);
+			result.steps += hit.steps;
+			result.primitiveEvaluations += hit.primitiveEvaluations;
+			visible[pixel] = hit.hit && hit.depth < ends[pixel] - settings.epsilon ? hit.depth : -1.0f;
+		}
+		result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		startTime = std::chrono::steady_clock::now();
+		for (auto pixel = 0; pixel < result.pixels; pixel++)
+		{
+			const auto end = ends[pixel];
+			auto depth = -1.0f;
+			if (end > settings.epsilon)
+			{
+				const auto hit = marcher.MarchCulled(rays[pixel], settings.epsilon, end, intervals);
+				result.boundedSteps += hit.steps;
+				result.boundedPrimitiveEvaluations += hit.primitiveEvaluations;
+				if (hit.hit && hit.depth < end - settings.epsilon) depth = hit.depth;
+			}
+
+			if ((depth < 0.0f) != (visible[pixel] < 0.0f) || std::abs(depth - visible[pixel]) > 0.0001f) result.mismatchedPixels++;
+		}
+		result.boundedMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		for (auto pixel = 0; pixel < result.pixels; pixel++)
+		{
+			result.unculledSteps += marcher.March(rays[pixel], settings.epsilon, settings.maxDistance).steps;
+			if (ends[pixel] > settings.epsilon) result.boundedUnculledSteps += marcher.March(rays[pixel], settings.epsilon, ends[pixel]).steps;
+
+			TraceReflectivePlane(rays[pixel], projection.farPlane, projection.farPlane, result.planeIntersections, result.shadedHits);
+			if (ends[pixel] > 0.0001f) TraceReflectivePlane(rays[pixel], DepthBoundDistance(depthBuffer[pixel], rays[pixel], camera, projection, projection.farPlane), projection.farPlane, result.boundedPlaneIntersections, result.boundedShadedHits);
+		}
+
+		return result;
+	}
+
+	struct DepthBoundingView
+	{
+		const char* name;
+		SDFCamera camera;
+	};
+
+	const DepthBoundingView DepthBoundingViews[] =
+	{
+		{ "default", SDFCamera::FromRotation(float3(0.0f, 0.5f, -0.5f), float3(0.0f, 0.0f, 0.0f)) },
+		{ "close", SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f)) },
+		{ "above", SDFCamera::LookAt(float3(0.0f, 1.5f, -2.5f), float3(0.0f, 0.5f, 0.0f)) },
+		{ "low", SDFCamera::LookAt(float3(0.0f, 1.1f, -3.5f), float3(0.0f, 0.6f, 1.0f)) },
+	};
+}
+
+void RunSDFDepthBoundingChecks(TestReport& report)
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	const SDFDepthProjection projection;
+	for (const auto& view : DepthBoundingViews)
+	{
+		const auto depthBuffer = RenderTerrainDepth(view.camera, 80, 45, projection);
+		const auto result = BenchmarkDepthBounding(scene, view.camera, 80, 45, depthBuffer, projection);
+		const std::string name(view.name);
+		report.ExpectZero((name + " view pixels changing visibility or depth with the clamp").c_str(), result.mismatchedPixels);
+		report.Expect(result.boundedSteps <= result.steps, (name + " view culled steps with the clamp at most the steps without"));
+		report.Expect(result.boundedUnculledSteps < result.unculledSteps, (name + " view unculled steps fewer with the clamp"));
+		report.Expect(result.boundedPlaneIntersections <= result.planeIntersections, (name + " view plane tests with the clamp at most the tests without"));
+	}
+}
+
+void RunSDFDepthBoundingBenchmarks()
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	const SDFDepthProjection projection;
+
+	std::printf("the default scene over the terrain's depth at 320x180, without -> with the clamp\n");
+	std::printf("%-8s %7s %7s %8s %17s %21s %19s %19s %15s %10s\n", "view", "covered", "skipped", "mismatch", "culled steps", "unculled steps", "evaluations", "ms", "plane tests", "hits");
+	for (const auto& view : DepthBoundingViews)
+	{
+		const auto depthBuffer = RenderTerrainDepth(view.camera, 320, 180, projection);
+		const auto result = BenchmarkDepthBounding(scene, view.camera, 320, 180, depthBuffer, projection);
+		std::printf("%-8s %7d %7d %8d %8lld -> %6lld %10lld -> %7lld %9lld -> %6lld %8.1f -> %6.1f %6lld -> %5lld %4lld -> %2lld\n", view.name, result.coveredPixels,
+			result.skippedPixels, result.mismatchedPixels, result.steps, result.boundedSteps, result.unculledSteps, result.boundedUnculledSteps, result.primitiveEvaluations,
+			result.boundedPrimitiveEvaluations, result.milliseconds, result.boundedMilliseconds, result.planeIntersections, result.boundedPlaneIntersections, result.shadedHits,
+			result.boundedShadedHits);
+	}
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "SDFRayMarcher.h"
+#include "Tests.h"
+
+namespace
+{
+	struct SDFFractalLODViewResult
+	{
+		float distance;					// camera to the fractal's centre
+		SDFImageStats fixed;			// all 8 folding iterations everywhere
+		SDFImageStats lod;				// iterations from the pixel footprint
+		double averageIterations;		// at the fractal pixels of the LOD image, 8 for the fixed one
+		int fractalPixels;				// hit the fractal in either image
+		int mismatchedPixels;			// hit in one image and miss in the other
+		double meanColourDifference;	// over pixels hit in both, largest channel
+		double meanDepthDifference;		// over pixels hit in both, relative to the depth
+	};
+
+	// Renders the default scene from several distances to the fractal with 8 iterations and with the footprint LOD
+	std::vector<SDFFractalLODViewResult> BenchmarkFractalLOD(const SDFScene& scene, int width, int height, const std::vector<float>& distances, float footprintScale = 1.0f)
+	{
+		std::vector<SDFFractalLODViewResult> results;
+
+		const auto& primitives = scene.GetPrimitives();
+		const auto fractal = std::find_if(primitives.begin(), primitives.end(), [](const SDFPrimitive& p) { return p.type == SDFPrimitiveType::SierpinskiTetrahedron; });
+		if (fractal == primitives.end()) return results;
+
+		const auto centre = fractal->boundCentre;
+		const auto lineOfSight = normalize(float3(0.3f, 0.25f, -1.0f));
+
+		for (const auto distance : distances)
+		{
+			SDFFractalLODViewResult result = {};
+			result.distance = distance;
+
+			const auto camera = SDFCamera::LookAt(centre + lineOfSight * distance, centre);
+			SDFMarchSettings settings;
+			settings.boundingCulling = true;
+			std::vector<float4> fixedImage, lodImage;
+
+			result.fixed = SDFRayMarcher(scene, settings).RenderImage(camera, width, height, &fixedImage);
+
+			settings.fractalPixelAngle = camera.PixelAngle(width) * footprintScale;
+			result.lod = SDFRayMarcher(scene, settings).RenderImage(camera, width, height, &lodImage);
+
+			auto sameHits = 0;
+			for (auto y = 0; y < height; y++)
+			{
+				for (auto x = 0; x < width; x++)
+				{
+					const auto i = y * width + x;
+					const auto fixedHit = fixedImage[i].w < settings.maxDistance;
+					const auto lodHit = lodImage[i].w < settings.maxDistance;
+					if (!fixedHit && !lodHit) continue;
+
+					// A pixel belongs to the fractal when the fractal is the closest primitive at its hit
+					const auto ray = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+					const auto depth = fixedHit ? fixedImage[i].w : lodImage[i].w;
+					const auto hitPoint = ray.o + depth * ray.d;
+					if (SDFScene::EvaluatePrimitive(*fractal, hitPoint).x > scene.Evaluate(hitPoint).x + settings.epsilon) continue;
+
+					result.fractalPixels++;
+					if (fixedHit != lodHit)
+					{
+						result.mismatchedPixels++;
+						continue;
+					}
+
+					const auto colourDifference = abs(fixedImage[i].xyz() - lodImage[i].xyz());
+					result.meanColourDifference += std::max(colourDifference.x, std::max(colourDifference.y, colourDifference.z));
+					result.meanDepthDifference += std::abs(fixedImage[i].w - lodImage[i].w) / fixedImage[i].w;
+					result.averageIterations += SDF::SierpinskiIterations(settings.fractalPixelAngle * lodImage[i].w * fractal->paramsA.x);
+					sameHits++;
+				}
+			}
+
+			if (sameHits > 0)
+			{
+				result.meanColourDifference /= sameHits;
+				result.meanDepthDifference /= sameHits;
+				result.averageIterations /= sameHits;
+			}
+
+			results.push_back(result);
+		}
+
+		return results;
+	}
+}
+
+void RunSDFFractalLODChecks(TestReport& report)
+{
+	auto previous = 8.0f;
+	auto increases = 0;
+	for (auto footprint = 1e-4f; footprint < 10.0f; footprint *= 1.1f)
+	{
+		const auto iterations = SDF::SierpinskiIterations(footprint);
+		if (iterations > previous || iterations < SDF::SierpinskiMinIterations) increases++;
+		previous = iterations;
+	}
+	report.ExpectZero("footprints whose iteration count rises or leaves the clamp range", increases);
+
+	const auto scene = SDFScene::CreateDefaultScene();
+	const auto results = BenchmarkFractalLOD(scene, 640, 360, { 3.0f, 6.0f }, 0.5f);
+	for (const auto& result : results)
+	{
+		const auto name = "fractal at distance " + std::to_string(static_cast<int>(result.distance));
+		report.Expect(result.fractalPixels > 0, name + " covers pixels");
+		report.ExpectAtMost(name + ", mean relative depth difference from 8 iterations", result.meanDepthDifference, 0.004);
+		report.ExpectAtMost(name + ", fraction of fractal pixels whose hit changes", static_cast<double>(result.mismatchedPixels) / result.fractalPixels, 0.05);
+	}
+}
+
+void RunSDFFractalLODBenchmarks()
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	std::printf("default scene at 640x360, fixed 8 iterations against the footprint LOD\n");
+	std::printf("%-5s %8s %7s %6s %9s %9s %8s %8s %10s %8s %8s\n", "scale", "distance", "fractal", "iters", "fixed ms", "LOD ms", "steps", "steps", "mismatched", "colour", "depth");
+	for (auto footprintScale : { 1.0f, 0.5f })
+	{
+		for (const auto& r : BenchmarkFractalLOD(scene, 640, 360, { 1.5f, 3.0f, 6.0f, 12.0f, 24.0f, 40.0f }, footprintScale))
+		{
+			const auto pixels = 640.0 * 360.0;
+			std::printf("%-5.1f %8.1f %7d %6.2f %9.0f %9.0f %8.1f %8.1f %10d %8.4f %8.5f\n", footprintScale, r.distance, r.fractalPixels, r.averageIterations,
+				r.fixed.milliseconds, r.lod.milliseconds, r.fixed.steps / pixels, r.lod.steps / pixels, r.mismatchedPixels, r.meanColourDifference, r.meanDepthDifference);
+		}
+	}
+}
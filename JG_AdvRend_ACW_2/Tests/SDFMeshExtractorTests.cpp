@@ -0,0 +1,133 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include "SDFMeshExtractor.h"
+#include "Tests.h"
+
+namespace
+{
+	struct SDFMeshBenchmarkResult
+	{
+		SDFMeshStats stats;
+		double singleThreadMilliseconds;
+		int openEdges;					// triangle edges used by one triangle only, 0 for a closed mesh
+		int nonManifoldEdges;			// used by more than two
+		double meanVertexDistance;		// |SDF| at the vertices, in units of the finest leaf size
+		double maxVertexDistance;
+		double flippedTriangles;		// fraction whose winding disagrees with the SDF gradient
+	};
+
+	SDFMeshBenchmarkResult BenchmarkMeshExtraction(const SDFScene& scene, const SDFMeshSettings& settings)
+	{
+		SDFMeshBenchmarkResult result = {};
+
+		auto singleThreadSettings = settings;
+		singleThreadSettings.threads = 1;
+		SDFMeshExtractor singleThread(scene, singleThreadSettings);
+		singleThread.Extract();
+		result.singleThreadMilliseconds = singleThread.GetStats().totalMilliseconds;
+
+		SDFMeshExtractor extractor(scene, settings);
+		extractor.Extract();
+		result.stats = extractor.GetStats();
+
+		const auto& vertices = extractor.GetVertices();
+		const auto& indices = extractor.GetIndices();
+
+		// Every edge of a closed two manifold mesh is shared by exactly two triangles
+		std::unordered_map<unsigned long long, int> edgeUses;
+		edgeUses.reserve(indices.size());
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (auto e = 0; e < 3; e++)
+			{
+				const unsigned long long a = indices[i + e];
+				const unsigned long long b = indices[i + (e + 1) % 3];
+				edgeUses[std::min(a, b) << 32 | std::max(a, b)]++;
+			}
+		}
+		for (const auto& edge : edgeUses)
+		{
+			if (edge.second == 1) result.openEdges++;
+			else if (edge.second > 2) result.nonManifoldEdges++;
+		}
+
+		for (const auto& vertex : vertices)
+		{
+			const auto distance = std::abs(scene.Evaluate(vertex.position).x) / result.stats.leafSize;
+			result.meanVertexDistance += distance;
+			result.maxVertexDistance = std::max(result.maxVertexDistance, static_cast<double>(distance));
+		}
+		if (!vertices.empty()) result.meanVertexDistance /= vertices.size();
+
+		auto flipped = 0;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const auto& a = vertices[indices[i]];
+			const auto& b = vertices[indices[i + 1]];
+			const auto& c = vertices[indices[i + 2]];
+			const auto faceNormal = cross(b.position - a.position, c.position - a.position);
+			if (dot(faceNormal, a.normal + b.normal + c.normal) < 0.0f) flipped++;
+		}
+		if (!indices.empty()) result.flippedTriangles = static_cast<double>(flipped) / (indices.size() / 3);
+
+		return result;
+	}
+}
+
+void RunSDFMeshExtractorChecks(TestReport& report)
+{
+	const struct
+	{
+		const char* name;
+		SDFPrimitiveType type;
+		float4 paramsA;
+	} shapes[] =
+	{
+		{ "ellipsoid", SDFPrimitiveType::Ellipsoid, float4(0.5f, 0.5f, 0.5f, 0.0f) },
+		{ "box", SDFPrimitiveType::Box, float4(0.4f, 0.3f, 0.5f, 0.0f) },
+		{ "torus", SDFPrimitiveType::Torus, float4(0.4f, 0.15f, 0.0f, 0.0f) },
+	};
+
+	for (const auto& shape : shapes)
+	{
+		SDFScene scene;
+		scene.AddPrimitive(shape.type, float3(0.1f, 0.2f, 0.3f), shape.paramsA, float4(), float3(1.0f, 1.0f, 1.0f));
+		for (auto depth : { 4, 5 })
+		{
+			SDFMeshSettings settings;
+			settings.maxDepth = depth;
+			const auto result = BenchmarkMeshExtraction(scene, settings);
+			const auto name = std::string(shape.name) + " at depth " + std::to_string(depth);
+			report.Expect(result.stats.triangles > 0, name + " has triangles");
+			report.ExpectZero(name + ", open edges", result.openEdges);
+			report.ExpectZero(name + ", non-manifold edges", result.nonManifoldEdges);
+			report.ExpectAtMost(name + ", fraction of wrongly wound triangles", result.flippedTriangles, 0.0);
+			report.ExpectAtMost(name + ", largest vertex distance from the surface in leaves", result.maxVertexDistance, 1.0);
+		}
+	}
+}
+
+void RunSDFMeshExtractorBenchmarks()
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	std::printf("default scene, simplify error 0 and then (0.1 leaf)^2\n");
+	std::printf("%-5s %8s %8s %10s %8s %8s %9s %9s %9s %9s %5s %8s %8s %8s\n", "depth", "leaf", "nodes", "dense", "tris", "merged", "build ms", "contour ms",
+		"total ms", "1 thread", "open", "non-man", "flipped", "max dist");
+	for (auto relativeError : { 0.0f, 0.1f })
+	{
+		for (auto depth : { 6, 7, 8, 9 })
+		{
+			SDFMeshSettings settings;
+			settings.maxDepth = depth;
+			const auto leaf = 3.3f / (1 << depth);
+			settings.simplifyError = (relativeError * leaf) * (relativeError * leaf);
+			const auto r = BenchmarkMeshExtraction(scene, settings);
+			std::printf("%-5d %8.4f %8d %10lld %8d %8d %9.1f %9.1f %9.1f %9.1f %5d %8d %8.4f %8.3f\n", depth, r.stats.leafSize, r.stats.nodes, r.stats.denseCells,
+				r.stats.triangles, r.stats.collapsedNodes, r.stats.buildMilliseconds, r.stats.contourMilliseconds, r.stats.totalMilliseconds, r.singleThreadMilliseconds,
+				r.openEdges, r.nonManifoldEdges, r.flippedTriangles, r.maxVertexDistance);
+		}
+	}
+}
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "SDFNormals.h"
+#include "Tests.h"
+
+namespace
+{
+	struct SDFNormalMethodStats
+	{
+		double nanosecondsPerNormal;
+		double sceneEvaluations;		// cost in units of one SDFScene::Evaluate
+		double meanErrorDegrees;
+		double percentile99ErrorDegrees;
+		double maxErrorDegrees;
+		int fallbacks;
+	};
+
+	struct SDFNormalBenchmarkResult
+	{
+		int surfacePoints;
+		double evaluateNanoseconds;
+		SDFNormalMethodStats centralDifferences;
+		SDFNormalMethodStats tetrahedral;
+		SDFNormalMethodStats dualNumbers;
+	};
+
+	float3 ReferenceNormal(const SDFScene& scene, const float3& p)
+	{
+		const auto gradient = [&](float h)
+		{
+			return float3(scene.Evaluate(float3(p.x + h, p.y, p.z)).x - scene.Evaluate(float3(p.x - h, p.y, p.z)).x,
+				scene.Evaluate(float3(p.x, p.y + h, p.z)).x - scene.Evaluate(float3(p.x, p.y - h, p.z)).x,
+				scene.Evaluate(float3(p.x, p.y, p.z + h)).x - scene.Evaluate(float3(p.x, p.y, p.z - h)).x) / (2.0f * h);
+		};
+
+		// Cancels the h^2 error term of the two central differences
+		return normalize((4.0f * gradient(0.0005f) - gradient(0.001f)) / 3.0f);
+	}
+
+	template<typename Method>
+	SDFNormalMethodStats MeasureMethod(const std::vector<float3>& points, const std::vector<float3>& references, double evaluateNanoseconds, const Method& method)
+	{
+		SDFNormalMethodStats stats = {};
+		std::vector<double> errors(points.size());
+		std::vector<float3> normals(points.size());
+
+		const auto startTime = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < points.size(); i++) normals[i] = method(points[i], stats.fallbacks);
+		const auto nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+
+		stats.nanosecondsPerNormal = nanoseconds / points.size();
+		stats.sceneEvaluations = stats.nanosecondsPerNormal / evaluateNanoseconds;
+
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			errors[i] = std::acos(std::min(1.0, std::max(-1.0, static_cast<double>(dot(normals[i], references[i]))))) * 57.29577951308232;
+			stats.meanErrorDegrees += errors[i];
+		}
+		stats.meanErrorDegrees /= points.size();
+
+		std::sort(errors.begin(), errors.end());
+		stats.percentile99ErrorDegrees = errors[static_cast<size_t>(0.99 * (errors.size() - 1))];
+		stats.maxErrorDegrees = errors.back();
+		return stats;
+	}
+
+	// Normals at the hit points, against a Richardson extrapolated central difference
+	SDFNormalBenchmarkResult BenchmarkNormals(const SDFScene& scene, const SDFCamera& camera, int width, int height)
+	{
+		SDFNormalBenchmarkResult result;
+
+		// Surface points are wherever a pixel ray hits
+		SDFMarchSettings settings;
+		settings.boundingCulling = true;
+		const SDFRayMarcher marcher(scene, settings);
+		std::vector<SDFBoundInterval> intervals;
+		std::vector<float3> points;
+		for (auto y = 0; y < height; y++)
+		{
+			for (auto x = 0; x < width; x++)
+			{
+				const auto ray = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+				const auto hit = marcher.MarchCulled(ray, settings.epsilon, settings.maxDistance, intervals);
+				if (hit.hit) points.push_back(ray.o + hit.depth * ray.d);
+			}
+		}
+		result.surfacePoints = static_cast<int>(points.size());
+
+		std::vector<float3> references(points.size());
+		for (size_t i = 0; i < points.size(); i++) references[i] = ReferenceNormal(scene, points[i]);
+
+		auto sink = 0.0f;
+		const auto startTime = std::chrono::steady_clock::now();
+		for (const auto& p : points) sink += scene.Evaluate(p).x;
+		result.evaluateNanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / points.size();
+		volatile auto keep = sink;
+		(void)keep;
+
+		result.centralDifferences = MeasureMethod(points, references, result.evaluateNanoseconds,
+			[&](const float3& p, int&) { return CentralDifferenceNormal(scene, p); });
+		result.tetrahedral = MeasureMethod(points, references, result.evaluateNanoseconds,
+			[&](const float3& p, int&) { return TetrahedralNormal(scene, p); });
+		result.dualNumbers = MeasureMethod(points, references, result.evaluateNanoseconds,
+			[&](const float3& p, int& fallbacks)
+			{
+				auto fellBack = false;
+				const auto normal = DualNumberNormal(scene, p, &fellBack);
+				if (fellBack) fallbacks++;
+				return normal;
+			});
+
+		return result;
+	}
+}
+
+void RunSDFNormalsChecks(TestReport& report)
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	const auto result = BenchmarkNormals(scene, SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f)), 160, 90);
+	report.Expect(result.surfacePoints > 0, "surface points in the close view");
+	report.ExpectAtMost("central difference mean error in degrees", result.centralDifferences.meanErrorDegrees, 0.5);
+	report.ExpectAtMost("tetrahedral mean error in degrees", result.tetrahedral.meanErrorDegrees, 0.5);
+	report.ExpectAtMost("dual number mean error in degrees", result.dualNumbers.meanErrorDegrees, 0.5);
+	report.ExpectZero("dual number fallbacks in the close view", result.dualNumbers.fallbacks);
+}
+
+void RunSDFNormalsBenchmarks()
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	const struct
+	{
+		const char* name;
+		SDFCamera camera;
+	} views[] =
+	{
+		{ "close", SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f)) },
+		{ "wide", SDFCamera::LookAt(float3(0.0f, 1.5f, -4.0f), float3(0.0f, 0.5f, 0.0f)) },
+	};
+
+	std::printf("normals at the hit points at 640x360, cost in scene evaluations, errors in degrees\n");
+	std::printf("%-6s %7s %-12s %8s %6s %8s %8s %8s %9s\n", "view", "points", "method", "ns", "evals", "mean", "p99", "max", "fallbacks");
+	for (const auto& view : views)
+	{
+		const auto result = BenchmarkNormals(scene, view.camera, 640, 360);
+		const struct
+		{
+			const char* name;
+			const SDFNormalMethodStats& stats;
+		} methods[] =
+		{
+			{ "central", result.centralDifferences },
+			{ "tetrahedral", result.tetrahedral },
+			{ "dual", result.dualNumbers },
+		};
+		for (const auto& method : methods)
+		{
+			std::printf("%-6s %7d %-12s %8.0f %6.2f %8.3f %8.2f %8.2f %9d\n", view.name, result.surfacePoints, method.name, method.stats.nanosecondsPerNormal,
+				method.stats.sceneEvaluations, method.stats.meanErrorDegrees, method.stats.percentile99ErrorDegrees, method.stats.maxErrorDegrees, method.stats.fallbacks);
+		}
+	}
+}
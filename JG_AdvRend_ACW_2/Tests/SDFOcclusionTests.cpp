@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "SDFOcclusion.h"
+#include "Tests.h"
+
+namespace
+{
+	struct SDFOcclusionBudgetResult
+	{
+		SDFOcclusionSettings settings;
+		double nanosecondsPerPixel;				// shadow and occlusion added to each hit pixel
+		double primitiveEvaluationsPerPixel;
+		double shadowStepsPerPixel;
+		double occlusionTapsPerPixel;
+		double outcomes[static_cast<int>(SDFShadowOutcome::Count)];	// fraction of hit pixels per shadow outcome
+		double meanShadowError;					// |shadow - reference| over the hit pixels
+		double maxShadowError;
+		double meanOcclusionError;
+		double maxOcclusionError;
+		int overBudgetPixels;					// took more shadow steps or occlusion taps than the budget
+	};
+
+	struct SDFOcclusionBenchmarkResult
+	{
+		int hitPixels;
+		double primaryNanosecondsPerPixel;		// MarchCulled and the normal, what the lighting is added to
+		std::vector<SDFOcclusionBudgetResult> budgets;
+	};
+
+	const char* const outcomeNames[] = { "away", "left", "light", "occl", "out" };
+
+	// Shades every pixel the camera's rays hit with each budget, against a 1024 step shadow and 5 tap occlusion without culling
+	SDFOcclusionBenchmarkResult BenchmarkOcclusion(const SDFScene& scene, const SDFCamera& camera, int width, int height, const float3& lightPosition, const std::vector<SDFOcclusionSettings>& budgets)
+	{
+		SDFOcclusionBenchmarkResult result = {};
+
+		// Surface points, normals and footprints wherever a pixel ray hits
+		SDFMarchSettings marchSettings;
+		marchSettings.boundingCulling = true;
+		marchSettings.fractalPixelAngle = camera.PixelAngle(width);
+		const SDFRayMarcher marcher(scene, marchSettings);
+		std::vector<SDFBoundInterval> intervals;
+		std::vector<float3> points;
+		std::vector<float3> normals;
+		std::vector<float> footprints;
+
+		const auto startTime = std::chrono::steady_clock::now();
+		for (auto y = 0; y < height; y++)
+		{
+			for (auto x = 0; x < width; x++)
+			{
+				const auto ray = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+				const auto hit = marcher.MarchCulled(ray, marchSettings.epsilon, marchSettings.maxDistance, intervals);
+				if (!hit.hit) continue;
+
+				const auto p = ray.o + hit.depth * ray.d;
+				const auto footprint = marchSettings.fractalPixelAngle * hit.depth;
+				const auto epsilon = marchSettings.epsilon;
+				points.push_back(p);
+				footprints.push_back(footprint);
+				normals.push_back(normalize(float3(scene.Evaluate(float3(p.x + epsilon, p.y, p.z), footprint).x - scene.Evaluate(float3(p.x - epsilon, p.y, p.z), footprint).x,
+					scene.Evaluate(float3(p.x, p.y + epsilon, p.z), footprint).x - scene.Evaluate(float3(p.x, p.y - epsilon, p.z), footprint).x,
+					scene.Evaluate(float3(p.x, p.y, p.z + epsilon), footprint).x - scene.Evaluate(float3(p.x, p.y, p.z - epsilon), footprint).x)));
+			}
+		}
+		result.hitPixels = static_cast<int>(points.size());
+		if (points.empty()) return result;
+		result.primaryNanosecondsPerPixel = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / points.size();
+
+		SDFOcclusionSettings referenceSettings;
+		referenceSettings.shadowSteps = 1024;
+		referenceSettings.occlusionTaps = 5;
+		referenceSettings.boundingCulling = false;
+		const SDFOcclusion reference(scene, referenceSettings);
+		std::vector<float> referenceShadows(points.size());
+		std::vector<float> referenceOcclusion(points.size());
+		for (size_t i = 0; i < points.size(); i++)
+		{
+			referenceShadows[i] = reference.SoftShadow(points[i], normals[i], lightPosition, footprints[i]);
+			referenceOcclusion[i] = reference.AmbientOcclusion(points[i], normals[i], footprints[i]);
+		}
+
+		for (const auto& settings : budgets)
+		{
+			SDFOcclusionBudgetResult budget = {};
+			budget.settings = settings;
+			const SDFOcclusion occlusion(scene, settings);
+
+			std::vector<float> shadows(points.size());
+			std::vector<float> ambient(points.size());
+			std::vector<SDFOcclusionStats> stats(points.size(), SDFOcclusionStats());
+
+			const auto budgetStart = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < points.size(); i++)
+			{
+				shadows[i] = occlusion.SoftShadow(points[i], normals[i], lightPosition, footprints[i], &stats[i]);
+				ambient[i] = occlusion.AmbientOcclusion(points[i], normals[i], footprints[i], &stats[i]);
+			}
+			budget.nanosecondsPerPixel = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - budgetStart).count() / points.size();
+
+			for (size_t i = 0; i < points.size(); i++)
+			{
+				budget.primitiveEvaluationsPerPixel += stats[i].primitiveEvaluations;
+				budget.shadowStepsPerPixel += stats[i].shadowSteps;
+				budget.occlusionTapsPerPixel += stats[i].occlusionTaps;
+				budget.outcomes[static_cast<int>(stats[i].shadowOutcome)] += 1.0;
+				if (stats[i].shadowSteps > settings.shadowSteps || stats[i].occlusionTaps > settings.occlusionTaps) budget.overBudgetPixels++;
+
+				const auto shadowError = std::abs(shadows[i] - referenceShadows[i]);
+				const auto occlusionError = std::abs(ambient[i] - referenceOcclusion[i]);
+				budget.meanShadowError += shadowError;
+				budget.maxShadowError = std::max(budget.maxShadowError, static_cast<double>(shadowError));
+				budget.meanOcclusionError += occlusionError;
+				budget.maxOcclusionError = std::max(budget.maxOcclusionError, static_cast<double>(occlusionError));
+			}
+
+			const auto count = static_cast<double>(points.size());
+			budget.primitiveEvaluationsPerPixel /= count;
+			budget.shadowStepsPerPixel /= count;
+			budget.occlusionTapsPerPixel /= count;
+			for (auto& outcome : budget.outcomes) outcome /= count;
+			budget.meanShadowError /= count;
+			budget.meanOcclusionError /= count;
+
+			result.budgets.push_back(budget);
+		}
+
+		return result;
+	}
+}
+
+void RunSDFOcclusionChecks(TestReport& report)
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	const auto camera = SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f));
+	std::vector<SDFOcclusionSettings> budgets(3);
+	budgets[0].shadowSteps = 8;
+	budgets[0].occlusionTaps = 2;
+	budgets[1].boundingCulling = false;
+
+	const auto result = BenchmarkOcclusion(scene, camera, 80, 45, float3(-2.0f, 5.0f, 0.0f), budgets);
+	report.Expect(result.hitPixels > 0, "close camera hits the scene");
+	for (const auto& budget : result.budgets)
+	{
+		const auto name = std::to_string(budget.settings.shadowSteps) + " steps and " + std::to_string(budget.settings.occlusionTaps) + " taps" +
+			(budget.settings.boundingCulling ? " culled" : "");
+		report.ExpectZero(name + ", pixels over the budget", budget.overBudgetPixels);
+	}
+	report.ExpectAtMost("culled 32 step shadow, mean error against the reference", result.budgets[2].meanShadowError, 0.005);
+	report.ExpectAtMost("culled 32 step shadow, largest error against the reference", result.budgets[2].maxShadowError, 0.05);
+	report.ExpectAtMost("unculled 32 step shadow, mean error against the reference", result.budgets[1].meanShadowError, 0.005);
+	report.ExpectAtMost("unculled 5 tap occlusion, largest error against the reference", result.budgets[1].maxOcclusionError, 0.0);
+	report.ExpectAtMost("culled 5 tap occlusion, mean error against the reference", result.budgets[2].meanOcclusionError, 0.05);
+}
+
+void RunSDFOcclusionBenchmarks()
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	const struct
+	{
+		const char* name;
+		SDFCamera camera;
+	} views[] =
+	{
+		{ "close", SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f)) },
+		{ "far", SDFCamera::LookAt(float3(0.0f, 1.5f, -4.0f), float3(-0.3f, 0.9f, -1.0f)) },
+	};
+
+	std::vector<SDFOcclusionSettings> budgets;
+	const int steps[] = { 8, 16, 32, 64, 128 };
+	const int taps[] = { 2, 3, 5, 5, 5 };
+	for (auto culling : { false, true })
+	{
+		for (auto i = 0; i < 5; i++)
+		{
+			SDFOcclusionSettings settings;
+			settings.shadowSteps = steps[i];
+			settings.occlusionTaps = taps[i];
+			settings.boundingCulling = culling;
+			budgets.push_back(settings);
+		}
+	}
+
+	for (const auto& view : views)
+	{
+		const auto result = BenchmarkOcclusion(scene, view.camera, 320, 180, float3(-2.0f, 5.0f, 0.0f), budgets);
+		std::printf("%s camera at 320x180, %d hit pixels, primary pass %.0f ns per pixel, outcomes as fractions of the hit pixels\n", view.name, result.hitPixels,
+			result.primaryNanosecondsPerPixel);
+		std::printf("%-4s %5s %4s %8s %7s %6s %5s", "cull", "steps", "taps", "ns/px", "evals", "steps", "taps");
+		for (auto o = 0; o < static_cast<int>(SDFShadowOutcome::Count); o++) std::printf(" %6s", outcomeNames[o]);
+		std::printf(" %8s %7s %8s %7s %5s\n", "shadow", "max", "ao", "max", "over");
+		for (const auto& b : result.budgets)
+		{
+			std::printf("%-4s %5d %4d %8.0f %7.1f %6.1f %5.2f", b.settings.boundingCulling ? "yes" : "no", b.settings.shadowSteps, b.settings.occlusionTaps,
+				b.nanosecondsPerPixel, b.primitiveEvaluationsPerPixel, b.shadowStepsPerPixel, b.occlusionTapsPerPixel);
+			for (auto outcome : b.outcomes) std::printf(" %6.2f", outcome);
+			std::printf(" %8.4f %7.3f %8.4f %7.3f %5d\n", b.meanShadowError, b.maxShadowError, b.meanOcclusionError, b.maxOcclusionError, b.overBudgetPixels);
+		}
+	}
+}
@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "SDFRayMarcher.h"
+#include "Tests.h"
+
+using namespace SDF;
+
+// RayMarchObjects draws each primitive's bounding box as a back-face proxy that marches that
+// primitive alone, in place of one full-screen quad
+namespace
+{
+	const char* const primitiveNames[] = { "RoundConeSegment", "Cone", "CappedCone", "TwistedTorus", "Torus", "Torus82", "Box", "RoundBox",
+		"Ellipsoid", "TriPrism", "CylinderSegment", "Cylinder", "Cylinder6", "Octahedron", "HexPrism", "RoundCone", "SierpinskiTetrahedron" };
+
+	struct SDFProxyBoundsCheck
+	{
+		SDFPrimitiveType type;
+		int samplesOutside;			// grid samples outside the box
+		int violations;				// of those, inside the surface
+		float maxViolation;			// furthest such sample from the box
+		float3 slackLow;			// gap between each face and the furthest sample inside the surface
+		float3 slackHigh;
+		float boxVolume;
+		float sphereBoxVolume;		// box around the bounding sphere
+	};
+
+	struct SDFProxyCoverageResult
+	{
+		int pixels;							// of the full-screen quad
+		long long proxyInvocations;			// pixels under several proxies count for each
+		int coveredPixels;
+		long long sphereProxyInvocations;	// boxes around the bounding spheres
+
+		long long steps;					// MarchCulled from every pixel of the quad
+		long long proxySteps;
+		long long primitiveEvaluations;
+		long long proxyPrimitiveEvaluations;
+		double milliseconds;
+		double proxyMilliseconds;			// marching only, finding the pixels is the rasterizer's work
+		int hitPixels;
+		int mismatchedPixels;				// hit in one and not the other, or depths more than 0.001 apart
+	};
+
+	struct ProxyCamera
+	{
+		const char* name;
+		SDFCamera camera;
+	};
+
+	std::vector<ProxyCamera> GetProxyCameras()
+	{
+		return
+		{
+			{ "default", SDFCamera::FromRotation(float3(0.0f, 0.5f, -0.5f), float3(0.0f, 0.0f, 0.0f)) },
+			{ "close", SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f)) },
+			{ "far", SDFCamera::LookAt(float3(0.0f, 1.5f, -4.0f), float3(-0.3f, 0.9f, -1.0f)) },
+		};
+	}
+
+	// Slab test, false when the ray misses the box or it is behind the ray
+	bool IntersectBox(const SDFRay& ray, const float3& boxMin, const float3& boxMax, float& tNear, float& tFar)
+	{
+		tNear = -1e10f;
+		tFar = 1e10f;
+		for (auto axis = 0; axis < 3; axis++)
+		{
+			if (std::abs(ray.d[axis]) < 1e-8f)
+			{
+				if (ray.o[axis] < boxMin[axis] || ray.o[axis] > boxMax[axis]) return false;
+				continue;
+			}
+			auto t0 = (boxMin[axis] - ray.o[axis]) / ray.d[axis];
+			auto t1 = (boxMax[axis] - ray.o[axis]) / ray.d[axis];
+			if (t0 > t1) std::swap(t0, t1);
+			tNear = std::max(tNear, t0);
+			tFar = std::min(tFar, t1);
+		}
+		return tNear <= tFar && tFar > 0.0f;
+	}
+
+	// Plain sphere tracing of one primitive, what the pixel shader does for a proxy
+	SDFMarchResult MarchProxy(const SDFPrimitive& primitive, const SDFRay& ray, float start, float end, const SDFMarchSettings& settings)
+	{
+		SDFMarchResult result = { end, float3(), false, 0, 0, SDFMarchOutcome::Escaped, false };
+
+		auto depth = start;
+		for (auto i = 0; i < settings.maxMarchingSteps; i++)
+		{
+			const auto distanceAndColour = SDFScene::EvaluatePrimitive(primitive, ray.o + depth * ray.d, settings.fractalPixelAngle * depth);
+			result.steps++;
+			result.primitiveEvaluations++;
+
+			if (distanceAndColour.x < settings.epsilon)
+			{
+				result.depth = depth;
+				result.colour = distanceAndColour.yzw();
+				result.hit = true;
+				result.outcome = SDFMarchOutcome::Hit;
+				return result;
+			}
+
+			depth += distanceAndColour.x;
+			if (depth >= end) return result;
+		}
+
+		result.outcome = SDFMarchOutcome::OutOfSteps;
+		return result;
+	}
+
+	// Samples a grid over each primitive's box grown by a quarter on every side, the fractal at
+	// full detail and at its coarsest level of detail
+	std::vector<SDFProxyBoundsCheck> CheckProxyBounds(const SDFScene& scene, int samplesPerAxis)
+	{
+		std::vector<SDFProxyBoundsCheck> checks;
+
+		for (const auto& primitive : scene.GetPrimitives())
+		{
+			SDFProxyBoundsCheck check = {};
+			check.type = primitive.type;
+
+			const auto size = primitive.boundMax - primitive.boundMin;
+			check.boxVolume = size.x * size.y * size.z;
+			check.sphereBoxVolume = 8.0f * primitive.boundRadius * primitive.boundRadius * primitive.boundRadius;
+
+			const auto low = primitive.boundMin - 0.25f * size;
+			const auto step = 1.5f * size / static_cast<float>(samplesPerAxis - 1);
+
+			// Furthest samples inside the surface
+			auto insideMin = float3(1e10f, 1e10f, 1e10f);
+			auto insideMax = float3(-1e10f, -1e10f, -1e10f);
+
+			for (auto z = 0; z < samplesPerAxis; z++)
+			{
+				for (auto y = 0; y < samplesPerAxis; y++)
+				{
+					for (auto x = 0; x < samplesPerAxis; x++)
+					{
+						const auto p = low + step * float3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+						// Full detail, and a footprint large enough to drop the fractal to its coarsest level
+						const auto distance = std::min(SDFScene::EvaluatePrimitive(primitive, p).x, SDFScene::EvaluatePrimitive(primitive, p, 1e3f).x);
+
+						if (distance < 0.0f)
+						{
+							insideMin = min(insideMin, p);
+							insideMax = max(insideMax, p);
+						}
+
+						const auto outside = max(max(primitive.boundMin - p, p - primitive.boundMax), 0.0f);
+						const auto gap = length(outside);
+						if (gap <= 0.0f) continue;
+
+						check.samplesOutside++;
+						if (distance <= 0.0f)
+						{
+							check.violations++;
+							check.maxViolation = std::max(check.maxViolation, gap);
+						}
+					}
+				}
+			}
+
+			check.slackLow = insideMin - primitive.boundMin;
+			check.slackHigh = primitive.boundMax - insideMax;
+			checks.push_back(check);
+		}
+
+		return checks;
+	}
+
+	// Primitives whose box in VS_RayMarchProxies.hlsl's primitiveBoxes does not contain SDFScene::ComputeBoundingBox's,
+	// -1 when the table is missing or has a different number of boxes
+	int CountUncontainedShaderBoxes(const SDFScene& scene, const std::string& shader)
+	{
+		const auto table = shader.find("primitiveBoxes[");
+		if (table == std::string::npos) return -1;
+
+		// Centre and half size of each box, the numbers between the table's = and };
+		std::vector<float> numbers;
+		const auto end = shader.find("};", table);
+		for (auto i = shader.find('=', table); i < end;)
+		{
+			char* next;
+			const auto value = std::strtof(shader.c_str() + i, &next);
+			if (next == shader.c_str() + i)
+			{
+				i++;
+				continue;
+			}
+			numbers.push_back(value);
+			i = next - shader.c_str();
+		}
+
+		const auto& primitives = scene.GetPrimitives();
+		if (numbers.size() != 6 * primitives.size()) return -1;
+
+		auto uncontained = 0;
+		for (size_t i = 0; i < primitives.size(); i++)
+		{
+			const auto centre = float3(numbers[6 * i], numbers[6 * i + 1], numbers[6 * i + 2]);
+			const auto halfSize = float3(numbers[6 * i + 3], numbers[6 * i + 4], numbers[6 * i + 5]);
+			const auto below = max(centre - halfSize - primitives[i].boundMin, 0.0f);
+			const auto above = max(primitives[i].boundMax - centre - halfSize, 0.0f);
+			if (length(below) + length(above) > 1e-6f)		// allowing for the float rounding of centre +- half size
+			{
+				std::printf("%s's shader box is short of its bounds by %g below and %g above\n", primitiveNames[static_cast<int>(primitives[i].type)], length(below), length(above));
+				uncontained++;
+			}
+		}
+		return uncontained;
+	}
+
+	// The scene with the full-screen quad and with the proxies from the same camera
+	SDFProxyCoverageResult BenchmarkProxyCoverage(const SDFScene& scene, const SDFCamera& camera, int width, int height)
+	{
+		SDFProxyCoverageResult result = {};
+		result.pixels = width * height;
+
+		SDFMarchSettings settings;
+		settings.boundingCulling = true;
+		settings.fractalPixelAngle = camera.PixelAngle(width);
+		const SDFRayMarcher marcher(scene, settings);
+		const auto& primitives = scene.GetPrimitives();
+
+		std::vector<SDFRay> rays(result.pixels);
+		for (auto y = 0; y < height; y++)
+		{
+			for (auto x = 0; x < width; x++)
+			{
+				rays[y * width + x] = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+			}
+		}
+
+		// Full-screen quad, the nearest hit of every pixel or -1
+		std::vector<float> quadDepth(result.pixels, -1.0f);
+		std::vector<SDFBoundInterval> intervals;
+		auto startTime = std::chrono::steady_clock::now();
+		for (auto pixel = 0; pixel < result.pixels; pixel++)
+		{
+			const auto hit = marcher.MarchCulled(rays[pixel], settings.epsilon, settings.maxDistance, intervals);
+			result.steps += hit.steps;
+			result.primitiveEvaluations += hit.primitiveEvaluations;
+			if (hit.hit) quadDepth[pixel] = hit.depth;
+		}
+		result.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		// Pixels under each proxy and the box's span along their rays, what the rasterizer hands the pixel shader
+		struct Invocation
+		{
+			int primitive;
+			int pixel;
+			float start;
+			float end;
+		};
+		std::vector<Invocation> invocations;
+		std::vector<bool> covered(result.pixels, false);
+		for (auto i = 0; i < static_cast<int>(primitives.size()); i++)
+		{
+			for (auto pixel = 0; pixel < result.pixels; pixel++)
+			{
+				auto tNear = 0.0f;
+				auto tFar = 0.0f;
+				if (!IntersectBox(rays[pixel], primitives[i].boundMin, primitives[i].boundMax, tNear, tFar)) continue;
+
+				covered[pixel] = true;
+				invocations.push_back({ i, pixel, std::max(tNear, settings.epsilon), std::min(tFar, settings.maxDistance) });
+			}
+		}
+		result.proxyInvocations = static_cast<long long>(invocations.size());
+
+		// The depth test keeps the nearest hit of the proxies over a pixel
+		std::vector<float> proxyDepth(result.pixels, -1.0f);
+		startTime = std::chrono::steady_clock::now();
+		for (const auto& invocation : invocations)
+		{
+			if (invocation.start >= invocation.end) continue;
+
+			const auto hit = MarchProxy(primitives[invocation.primitive], rays[invocation.pixel], invocation.start, invocation.end, settings);
+			result.proxySteps += hit.steps;
+			result.proxyPrimitiveEvaluations += hit.primitiveEvaluations;
+
+			auto& depth = proxyDepth[invocation.pixel];
+			if (hit.hit && (depth < 0.0f || hit.depth < depth)) depth = hit.depth;
+		}
+		result.proxyMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+		for (const auto& primitive : primitives)
+		{
+			const auto radius = float3(primitive.boundRadius, primitive.boundRadius, primitive.boundRadius);
+			for (auto pixel = 0; pixel < result.pixels; pixel++)
+			{
+				auto tNear = 0.0f;
+				auto tFar = 0.0f;
+				if (IntersectBox(rays[pixel], primitive.boundCentre - radius, primitive.boundCentre + radius, tNear, tFar)) result.sphereProxyInvocations++;
+			}
+		}
+
+		for (auto pixel = 0; pixel < result.pixels; pixel++)
+		{
+			if (covered[pixel]) result.coveredPixels++;
+			if (quadDepth[pixel] >= 0.0f) result.hitPixels++;
+			if ((quadDepth[pixel] < 0.0f) != (proxyDepth[pixel] < 0.0f) || std::abs(quadDepth[pixel] - proxyDepth[pixel]) > 0.001f) result.mismatchedPixels++;
+		}
+
+		return result;
+	}
+}
+
+void RunSDFProxyGeometryChecks(TestReport& report)
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	for (const auto& check : CheckProxyBounds(scene, 32))
+	{
+		report.ExpectZero(std::string(primitiveNames[static_cast<int>(check.type)]) + " samples outside its box inside the surface", check.violations);
+	}
+	report.ExpectZero("primitives whose box in VS_RayMarchProxies.hlsl does not contain their bounds", CountUncontainedShaderBoxes(scene, ReadAppFile("VS_RayMarchProxies.hlsl")));
+	for (const auto& camera : GetProxyCameras())
+	{
+		report.ExpectZero(std::string(camera.name) + " pixels the proxies shade differently", BenchmarkProxyCoverage(scene, camera.camera, 80, 45).mismatchedPixels);
+	}
+}
+
+void RunSDFProxyGeometryBenchmarks()
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	std::printf("box bounds, 64^3 samples over each box grown by a quarter\n");
+	std::printf("%-22s %8s %10s %9s %26s %26s %10s\n", "primitive", "outside", "violations", "max", "slack low", "slack high", "sphere box");
+	for (const auto& check : CheckProxyBounds(scene, 64))
+	{
+		std::printf("%-22s %8d %10d %9.5f %8.4f %8.4f %8.4f %8.4f %8.4f %8.4f %9.2fx\n", primitiveNames[static_cast<int>(check.type)], check.samplesOutside, check.violations, check.maxViolation,
+			check.slackLow.x, check.slackLow.y, check.slackLow.z, check.slackHigh.x, check.slackHigh.y, check.slackHigh.z, check.sphereBoxVolume / check.boxVolume);
+	}
+
+	std::printf("\ncoverage at 320x180\n");
+	std::printf("%-8s %12s %8s %12s %10s %10s %9s %9s %6s %10s\n", "camera", "invocations", "covered", "sphere boxes", "steps", "proxy", "ms", "proxy ms", "hits", "mismatches");
+	for (const auto& camera : GetProxyCameras())
+	{
+		const auto result = BenchmarkProxyCoverage(scene, camera.camera, 320, 180);
+		std::printf("%-8s %12lld %8d %12lld %10lld %10lld %9.1f %9.1f %6d %10d\n", camera.name, result.proxyInvocations, result.coveredPixels, result.sphereProxyInvocations,
+			result.steps, result.proxySteps, result.milliseconds, result.proxyMilliseconds, result.hitPixels, result.mismatchedPixels);
+	}
+}
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "SDFRayMarcher.h"
+#include "Tests.h"
+
+using namespace SDF;
+
+namespace
+{
+	struct SDFCullingBenchmarkResult
+	{
+		int primitiveCount;
+		SDFImageStats full;
+		SDFImageStats culled;
+		double evaluationsPerPixelFull;
+		double evaluationsPerPixelCulled;
+		double speedup;
+		int mismatchedPixels;	// hit in one image and miss in the other
+	};
+
+	// Random points around each primitive's bounding sphere inside the surface but outside the sphere
+	int CountBoundingSphereViolations(const SDFPrimitive& primitive, int samples)
+	{
+		std::mt19937 generator(1);
+		std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+		auto violations = 0;
+		for (auto i = 0; i < samples; i++)
+		{
+			const auto p = primitive.boundCentre + float3(unit(generator), unit(generator), unit(generator)) * (1.5f * primitive.boundRadius);
+			if (SDFScene::EvaluatePrimitive(primitive, p).x < 0.0f && length(p - primitive.boundCentre) > primitive.boundRadius) violations++;
+		}
+		return violations;
+	}
+
+	SDFCullingBenchmarkResult BenchmarkBoundingCulling(const SDFScene& scene, const SDFCamera& camera, int width, int height)
+	{
+		SDFCullingBenchmarkResult result;
+		result.primitiveCount = scene.GetPrimitiveCount();
+
+		SDFMarchSettings settings;
+		std::vector<float4> fullImage, culledImage;
+
+		settings.boundingCulling = false;
+		result.full = SDFRayMarcher(scene, settings).RenderImage(camera, width, height, &fullImage);
+
+		settings.boundingCulling = true;
+		result.culled = SDFRayMarcher(scene, settings).RenderImage(camera, width, height, &culledImage);
+
+		const auto pixels = static_cast<double>(width) * height;
+		result.evaluationsPerPixelFull = result.full.primitiveEvaluations / pixels;
+		result.evaluationsPerPixelCulled = result.culled.primitiveEvaluations / pixels;
+		result.speedup = result.full.milliseconds / result.culled.milliseconds;
+
+		result.mismatchedPixels = 0;
+		for (auto i = 0; i < width * height; i++)
+		{
+			const auto fullHit = fullImage[i].w < settings.maxDistance;
+			const auto culledHit = culledImage[i].w < settings.maxDistance;
+			if (fullHit != culledHit) result.mismatchedPixels++;
+		}
+
+		return result;
+	}
+
+	// Row vector matrix as DirectXMath builds them
+	struct Matrix
+	{
+		float4 rows[4];
+	};
+
+	float4 Transform(const float4& v, const Matrix& m)
+	{
+		return v.x * m.rows[0] + v.y * m.rows[1] + v.z * m.rows[2] + v.w * m.rows[3];
+	}
+
+	Matrix LookAtLH(const float3& eye, const float3& focus, const float3& up)
+	{
+		const auto r2 = normalize(focus - eye);
+		const auto r0 = normalize(cross(up, r2));
+		const auto r1 = cross(r2, r0);
+		return
+		{ {
+			float4(r0.x, r1.x, r2.x, 0.0f),
+			float4(r0.y, r1.y, r2.y, 0.0f),
+			float4(r0.z, r1.z, r2.z, 0.0f),
+			float4(-dot(r0, eye), -dot(r1, eye), -dot(r2, eye), 1.0f),
+		} };
+	}
+
+	Matrix PerspectiveFovRH(float fovAngleY, float aspectRatio, float nearZ, float farZ)
+	{
+		const auto height = 1.0f / std::tan(0.5f * fovAngleY);
+		const auto range = farZ / (nearZ - farZ);
+		return
+		{ {
+			float4(height / aspectRatio, 0.0f, 0.0f, 0.0f),
+			float4(0.0f, height, 0.0f, 0.0f),
+			float4(0.0f, 0.0f, range, -1.0f),
+			float4(0.0f, 0.0f, range * nearZ, 0.0f),
+		} };
+	}
+
+	// Largest distance in pixels between a pixel and where a point on its ray lands through Camera::Render's view and the app's projection
+	float MeasureProjectionRoundTrip(const float3& position, const float3& rotation, int width, int height)
+	{
+		const auto yaw = rotation.x * 0.01745329f;
+		const auto pitch = rotation.y * 0.01745329f;
+		const auto lookAt = float3(std::sin(yaw) * std::cos(pitch), -std::sin(pitch), std::cos(yaw) * std::cos(pitch));
+		const auto up = float3(std::sin(pitch) * std::sin(yaw), std::cos(pitch), std::sin(pitch) * std::cos(yaw));
+		const auto view = LookAtLH(position, position + lookAt, up);
+
+		// The shader's canvas is 2 wide at MIN_DIST, so the field of view is the one that canvas spans
+		const auto camera = SDFCamera::FromRotation(position, rotation);
+		const auto aspectRatio = static_cast<float>(width) / height;
+		const auto projection = PerspectiveFovRH(2.0f * std::atan(1.0f / (aspectRatio * camera.imagePlaneDistance)), aspectRatio, 0.01f, 100.0f);
+
+		auto maxError = 0.0f;
+		for (auto y = 0; y < height; y += 5)
+		{
+			for (auto x = 0; x < width; x += 5)
+			{
+				const auto ray = camera.GenerateRay(x + 0.5f, y + 0.5f, width, height);
+				const auto clip = Transform(Transform(float4(ray.o + 3.0f * ray.d, 1.0f), view), projection);
+				if (clip.w <= 0.0f) return 1e10f;
+
+				const auto pixel = float2((clip.x / clip.w + 1.0f) * 0.5f * width, (1.0f - clip.y / clip.w) * 0.5f * height);
+				maxError = std::max(maxError, length(pixel - float2(x + 0.5f, y + 0.5f)));
+			}
+		}
+		return maxError;
+	}
+}
+
+void RunSDFRayMarcherChecks(TestReport& report)
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	for (const auto& primitive : scene.GetPrimitives())
+	{
+		report.ExpectZero("samples of primitive type " + std::to_string(static_cast<int>(primitive.type)) + " outside its bounding sphere inside the surface", CountBoundingSphereViolations(primitive, 20000));
+	}
+
+	const auto camera = SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f));
+	report.ExpectZero("default scene pixels culling changes the hit of", BenchmarkBoundingCulling(scene, camera, 80, 45).mismatchedPixels);
+	const auto crowd = SDFScene::CreateRandomScene(50, 7, 3.0f);
+	const auto crowdCamera = SDFCamera::LookAt(float3(0.0f, 1.5f, -4.0f), float3(0.0f, 0.5f, 0.0f));
+	report.ExpectZero("50 object scene pixels culling changes the hit of", BenchmarkBoundingCulling(crowd, crowdCamera, 80, 45).mismatchedPixels);
+
+	const float3 rotations[] = { float3(0.0f, 0.0f, 0.0f), float3(30.0f, 0.0f, 0.0f), float3(-120.0f, 20.0f, 0.0f), float3(200.0f, -45.0f, 0.0f) };
+	for (const auto& rotation : rotations)
+	{
+		report.ExpectAtMost("pixels between a ray of FromRotation and its projection through the app's matrices", MeasureProjectionRoundTrip(float3(0.0f, 0.5f, -0.5f), rotation, 160, 90), 0.01);
+	}
+}
+
+void RunSDFRayMarcherBenchmarks()
+{
+	struct Case
+	{
+		const char* name;
+		SDFScene scene;
+		SDFCamera camera;
+	};
+	const Case cases[] =
+	{
+		{ "default", SDFScene::CreateDefaultScene(), SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f)) },
+		{ "500 objects", SDFScene::CreateRandomScene(500, 7, 3.0f), SDFCamera::LookAt(float3(0.0f, 1.5f, -4.0f), float3(0.0f, 0.5f, 0.0f)) },
+	};
+
+	std::printf("bounding sphere culling at 160x90\n");
+	std::printf("%-12s %10s %14s %14s %9s %9s %10s\n", "scene", "primitives", "evaluations/px", "culled", "ms", "culled ms", "mismatches");
+	for (const auto& test : cases)
+	{
+		const auto result = BenchmarkBoundingCulling(test.scene, test.camera, 160, 90);
+		std::printf("%-12s %10d %14.1f %14.1f %9.1f %9.1f %10d\n", test.name, result.primitiveCount, result.evaluationsPerPixelFull, result.evaluationsPerPixelCulled,
+			result.full.milliseconds, result.culled.milliseconds, result.mismatchedPixels);
+	}
+}
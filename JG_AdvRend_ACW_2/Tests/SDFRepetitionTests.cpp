@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "SDFRepetition.h"
+#include "Tests.h"
+
+namespace
+{
+	struct SDFRepetitionBenchmarkResult
+	{
+		int limit;
+		long long instances;				// -1 for infinite repetition
+		double stepsPerPixel;
+		double cellsPerStep;				// instances evaluated per march step
+		double nanosecondsPerStep;
+		double bruteForceNanosecondsPerStep;	// same steps evaluating every instance, 0 when skipped
+		int hitPixels;
+		float maxUnderestimate;				// Evaluate below the brute force distance, the price of the cell bound
+		float maxOverestimate;				// Evaluate above the brute force distance, 0 when the bound is correct
+		float maxLipschitz;					// largest |d(a) - d(b)| / |a - b| over nearby point pairs, jumps where the two-cells-away bound takes over
+	};
+
+	// Sphere traces one pixel, returns the hit depth or the max distance
+	template<typename Evaluate>
+	float MarchField(const SDFRay& ray, const SDFMarchSettings& settings, int& steps, const Evaluate& evaluate)
+	{
+		auto depth = 0.0f;
+		for (steps = 0; steps < settings.maxMarchingSteps; steps++)
+		{
+			const auto distance = evaluate(ray.o + depth * ray.d);
+			if (distance < settings.epsilon) return depth;
+
+			depth += distance;
+			if (depth >= settings.maxDistance) return settings.maxDistance;
+		}
+		return settings.maxDistance;
+	}
+
+	// Marches the rock palette repeated with each of limits on x and z, brute force and the bound checks run up to bruteForceLimit
+	std::vector<SDFRepetitionBenchmarkResult> BenchmarkRepetition(const SDFRepetitionSettings& settings, const std::vector<int>& limits, int width, int height, int bruteForceLimit)
+	{
+		std::vector<SDFRepetitionBenchmarkResult> results;
+
+		const auto palette = SDFRepeatedField::CreateRockPalette();
+		const auto origin = SDFRepeatedField::GetAsteroidBeltOrigin();
+		const auto camera = SDFCamera::LookAt(origin + float3(0.3f, 1.2f, -2.1f), origin + float3(3.0f, 0.0f, 4.0f));
+		const SDFMarchSettings marchSettings;
+
+		for (const auto limit : limits)
+		{
+			auto fieldSettings = settings;
+			fieldSettings.limit = float3(static_cast<float>(limit), settings.limit.y, static_cast<float>(limit));
+			const SDFRepeatedField field(palette, origin, fieldSettings);
+
+			SDFRepetitionBenchmarkResult result = {};
+			result.limit = limit;
+			result.instances = field.GetCellCount();
+
+			auto steps = 0ll;
+			auto cells = 0ll;
+			const auto startTime = std::chrono::steady_clock::now();
+			for (auto y = 0; y < height; y++)
+			{
+				for (auto x = 0; x < width; x++)
+				{
+					auto pixelSteps = 0;
+					const auto depth = MarchField(camera.GenerateRay(x + 0.5f, y + 0.5f, width, height), marchSettings, pixelSteps, [&](const float3& p)
+					{
+						auto count = 0;
+						const auto distance = field.Evaluate(p, &count).x;
+						cells += count;
+						return distance;
+					});
+					steps += pixelSteps;
+					if (depth < marchSettings.maxDistance) result.hitPixels++;
+				}
+			}
+			const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+
+			result.stepsPerPixel = static_cast<double>(steps) / (width * height);
+			result.cellsPerStep = static_cast<double>(cells) / std::max(1ll, steps);
+			result.nanosecondsPerStep = elapsed / std::max(1ll, steps);
+
+			if (limit >= 0 && limit <= bruteForceLimit)
+			{
+				// Time the same kind of steps with every instance evaluated, on a subset of the rows
+				auto bruteSteps = 0ll;
+				const auto rowStride = std::max(1, height / 16);
+				const auto bruteStart = std::chrono::steady_clock::now();
+				for (auto y = 0; y < height; y += rowStride)
+				{
+					for (auto x = 0; x < width; x++)
+					{
+						auto pixelSteps = 0;
+						MarchField(camera.GenerateRay(x + 0.5f, y + 0.5f, width, height), marchSettings, pixelSteps, [&](const float3& p) { return field.EvaluateBruteForce(p).x; });
+						bruteSteps += pixelSteps;
+					}
+				}
+				result.bruteForceNanosecondsPerStep = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - bruteStart).count() / std::max(1ll, bruteSteps);
+
+				// The cell bound against the exact distance, and the field's slope between nearby points
+				std::mt19937 generator(limit + 1);
+				const auto reach = (limit + 1.0f) * std::max(settings.spacing.x, settings.spacing.z);
+				std::uniform_real_distribution<float> horizontal(-reach, reach), vertical(-0.6f, 0.6f), offset(-0.05f, 0.05f);
+				for (auto i = 0; i < 20000; i++)
+				{
+					const auto a = origin + float3(horizontal(generator), vertical(generator), horizontal(generator));
+					const auto b = a + float3(offset(generator), offset(generator), offset(generator));
+					const auto distance = field.Evaluate(a).x;
+					const auto exact = field.EvaluateBruteForce(a).x;
+
+					result.maxOverestimate = std::max(result.maxOverestimate, distance - exact);
+					result.maxUnderestimate = std::max(result.maxUnderestimate, exact - distance);
+					result.maxLipschitz = std::max(result.maxLipschitz, std::abs(distance - field.Evaluate(b).x) / length(b - a));
+				}
+			}
+
+			results.push_back(result);
+		}
+
+		return results;
+	}
+}
+
+void RunSDFRepetitionChecks(TestReport& report)
+{
+	const char* layouts[] = { "belt", "mirrored", "jittered" };
+	for (auto layout = 0; layout < 3; layout++)
+	{
+		auto settings = SDFRepeatedField::GetAsteroidBeltSettings();
+		settings.mirrored = layout == 1;
+		if (layout == 2) settings.jitter = 0.3f;
+
+		for (const auto& result : BenchmarkRepetition(settings, { 1, 3 }, 80, 45, 3))
+		{
+			const auto name = std::string(layouts[layout]) + " layout with limit " + std::to_string(result.limit);
+			report.Expect(result.hitPixels > 0, name + " hits rocks");
+			report.ExpectAtMost(name + ", largest overestimate against brute force", result.maxOverestimate, 0.0);
+		}
+	}
+}
+
+void RunSDFRepetitionBenchmarks()
+{
+	const char* layouts[] = { "belt", "mirrored", "jittered" };
+	std::printf("rock palette at 320x180, brute force up to limit 15\n");
+	std::printf("%-9s %6s %9s %8s %10s %8s %10s %6s %9s %11s %9s\n", "layout", "limit", "instances", "steps/px", "cells/step", "ns/step", "brute ns", "hits",
+		"over", "under", "slope");
+	for (auto layout = 0; layout < 3; layout++)
+	{
+		auto settings = SDFRepeatedField::GetAsteroidBeltSettings();
+		settings.mirrored = layout == 1;
+		if (layout == 2) settings.jitter = 0.3f;
+
+		for (const auto& r : BenchmarkRepetition(settings, { 1, 3, 7, 15, 63, 255, -1 }, 320, 180, 15))
+		{
+			std::printf("%-9s %6d %9lld %8.2f %10.2f %8.1f %10.1f %6d %9.2e %11.3f %9.3f\n", layouts[layout], r.limit, r.instances, r.stepsPerPixel, r.cellsPerStep,
+				r.nanosecondsPerStep, r.bruteForceNanosecondsPerStep, r.hitPixels, r.maxOverestimate, r.maxUnderestimate, r.maxLipschitz);
+		}
+	}
+}
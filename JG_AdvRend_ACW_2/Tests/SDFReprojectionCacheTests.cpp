@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "SDFReprojectionCache.h"
+#include "Tests.h"
+
+namespace
+{
+	enum class SDFCameraPath
+	{
+		Orbit,		// circles the scene looking at its centre
+		Dolly,		// walks towards the scene
+		Strafe,		// sidesteps across the scene
+		Pan,		// turns on the spot
+		Count
+	};
+
+	struct SDFReprojectionBenchmarkResult
+	{
+		int frames;
+		int width;
+		int height;
+		long long pixels;
+		long long retraced;			// after the first frame, which traces everything
+		long long holes;
+		long long rejectedDepth;
+		long long rejectedNormal;
+		long long rejectedOcclusion;
+		long long refreshed;
+		double retracedFraction;
+		long long coverageErrors;	// hit in the cached frame and miss in a full trace of it, or the other way round
+		long long colourErrors;		// colour differs by more than 0.1, mostly the fractal whose colour changes within a pixel
+		double millisecondsFull;	// per frame, tracing every pixel
+		double millisecondsCached;	// per frame, reprojection included
+	};
+
+	const char* GetCameraPathName(SDFCameraPath path)
+	{
+		switch (path)
+		{
+		case SDFCameraPath::Orbit: return "orbit";
+		case SDFCameraPath::Dolly: return "dolly";
+		case SDFCameraPath::Strafe: return "strafe";
+		case SDFCameraPath::Pan: return "pan";
+		default: return "unknown";
+		}
+	}
+
+	// Camera rotation (yaw, pitch, roll in degrees) looking from position at target
+	float3 RotationTowards(const float3& position, const float3& target)
+	{
+		// The app looks down -lookAt
+		const auto d = normalize(position - target);
+		return float3(std::atan2(d.x, d.z), -std::asin(d.y), 0.0f) * 57.29578f;
+	}
+
+	// Camera at a frame of a scripted path, driven through Camera's position and rotation like the app
+	SDFCamera GetCameraPathFrame(SDFCameraPath path, int frame)
+	{
+		// Speeds are per frame at 60 frames per second
+		const auto target = float3(0.0f, 0.5f, 0.0f);
+		float3 position;
+		float3 rotation;
+
+		switch (path)
+		{
+		case SDFCameraPath::Orbit:
+		{
+			const auto angle = -1.5707963f + frame * 0.00873f;	// half a degree
+			position = float3(4.0f * std::cos(angle), 1.5f, 4.0f * std::sin(angle));
+			rotation = RotationTowards(position, target);
+			break;
+		}
+		case SDFCameraPath::Dolly:
+			position = float3(0.0f, 1.5f, -5.0f + frame * 0.02f);
+			rotation = RotationTowards(float3(0.0f, 1.5f, -5.0f), target);
+			break;
+		case SDFCameraPath::Strafe:
+			position = float3(-1.0f + frame * 0.02f, 1.5f, -4.0f);
+			rotation = RotationTowards(float3(0.0f, 1.5f, -4.0f), target);
+			break;
+		default:
+			position = float3(0.0f, 1.5f, -4.0f);
+			rotation = RotationTowards(position, target) + float3(-15.0f + frame * 0.5f, 0.0f, 0.0f);
+			break;
+		}
+
+		return SDFCamera::FromRotation(position, rotation);
+	}
+
+	SDFReprojectionBenchmarkResult BenchmarkReprojection(const SDFScene& scene, SDFCameraPath path, int frames, int width, int height, const SDFReprojectionSettings& settings)
+	{
+		SDFReprojectionBenchmarkResult result = {};
+		result.frames = frames;
+		result.width = width;
+		result.height = height;
+
+		SDFMarchSettings marchSettings;
+		marchSettings.boundingCulling = true;
+		marchSettings.maxDistance = settings.maxDistance;
+		const SDFRayMarcher marcher(scene, marchSettings);
+		std::vector<SDFBoundInterval> intervals;
+		const auto trace = [&](const SDFRay& ray) { return TraceSDFSample(marcher, scene, ray, intervals); };
+
+		SDFReprojectionCache cache(settings);
+		std::vector<SDFCachedSample> reference(width * height);
+		auto fullMilliseconds = 0.0;
+		auto cachedMilliseconds = 0.0;
+
+		for (auto frame = 0; frame < frames; frame++)
+		{
+			const auto camera = GetCameraPathFrame(path, frame);
+
+			auto startTime = std::chrono::steady_clock::now();
+			cache.Update(camera, width, height, trace);
+			const auto cached = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+			startTime = std::chrono::steady_clock::now();
+			for (auto y = 0; y < height; y++)
+			{
+				for (auto x = 0; x < width; x++) reference[y * width + x] = trace(camera.GenerateRay(x + 0.5f, y + 0.5f, width, height));
+			}
+			const auto full = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+			// The first frame has nothing to reproject
+			if (frame == 0) continue;
+
+			const auto& stats = cache.GetStats();
+			result.pixels += stats.pixels;
+			result.retraced += stats.retraced;
+			result.holes += stats.holes;
+			result.rejectedDepth += stats.rejectedDepth;
+			result.rejectedNormal += stats.rejectedNormal;
+			result.rejectedOcclusion += stats.rejectedOcclusion;
+			result.refreshed += stats.refreshed;
+			cachedMilliseconds += cached;
+			fullMilliseconds += full;
+
+			const auto& samples = cache.GetSamples();
+			for (auto i = 0; i < width * height; i++)
+			{
+				const auto& a = samples[i];
+				const auto& b = reference[i];
+				const auto difference = abs(a.colour - b.colour);
+				if (a.hit != b.hit) result.coverageErrors++;
+				else if (std::max(difference.x, std::max(difference.y, difference.z)) > 0.1f) result.colourErrors++;
+			}
+		}
+
+		result.retracedFraction = result.pixels ? static_cast<double>(result.retraced) / result.pixels : 1.0;
+		result.millisecondsFull = frames > 1 ? fullMilliseconds / (frames - 1) : 0.0;
+		result.millisecondsCached = frames > 1 ? cachedMilliseconds / (frames - 1) : 0.0;
+		return result;
+	}
+}
+
+void RunSDFReprojectionCacheChecks(TestReport& report)
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	for (auto p = 0; p < static_cast<int>(SDFCameraPath::Count); p++)
+	{
+		const auto path = static_cast<SDFCameraPath>(p);
+		const auto result = BenchmarkReprojection(scene, path, 10, 160, 90, SDFReprojectionSettings());
+		const auto name = std::string(GetCameraPathName(path)) + " path";
+		report.ExpectAtMost(name + ", fraction of pixels re-traced", result.retracedFraction, 0.2);
+		report.ExpectAtMost(name + ", fraction of pixels whose coverage differs from a full trace", static_cast<double>(result.coverageErrors) / result.pixels, 0.001);
+		report.ExpectAtMost(name + ", fraction of pixels whose colour differs from a full trace", static_cast<double>(result.colourErrors) / result.pixels, 0.02);
+	}
+}
+
+void RunSDFReprojectionCacheBenchmarks()
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	std::printf("default scene at 320x180, 30 frames per path against a full trace of each, pixels in %%\n");
+	std::printf("%-7s %7s %9s %7s %9s %7s %7s %8s %9s %9s %8s %9s\n", "refresh", "path", "re-traced", "holes", "occlusion", "depth", "normal", "refresh",
+		"coverage", "colour", "full ms", "cached ms");
+	for (auto refreshPeriod : { 0, 8 })
+	{
+		for (auto p = 0; p < static_cast<int>(SDFCameraPath::Count); p++)
+		{
+			SDFReprojectionSettings settings;
+			settings.refreshPeriod = refreshPeriod;
+			const auto r = BenchmarkReprojection(scene, static_cast<SDFCameraPath>(p), 30, 320, 180, settings);
+			const auto percent = 100.0 / r.pixels;
+			std::printf("%-7d %7s %9.2f %7.2f %9.2f %7.2f %7.2f %8.2f %9.3f %9.3f %8.1f %9.1f\n", refreshPeriod, GetCameraPathName(static_cast<SDFCameraPath>(p)),
+				100.0 * r.retracedFraction, r.holes * percent, r.rejectedOcclusion * percent, r.rejectedDepth * percent, r.rejectedNormal * percent,
+				r.refreshed * percent, r.coverageErrors * percent, r.colourErrors * percent, r.millisecondsFull, r.millisecondsCached);
+		}
+	}
+}
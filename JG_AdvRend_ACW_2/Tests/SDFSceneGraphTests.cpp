@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "SDFScene.h"
+#include "SDFSceneGraph.h"
+#include "Tests.h"
+
+namespace
+{
+	struct SDFSceneGraphBenchmarkResult
+	{
+		int points;
+		double compiledNanoseconds;		// per evaluation of the expression template scene
+		double runtimeNanoseconds;		// the same description walked as a runtime node tree
+		double flatSceneNanoseconds;	// SDFScene::Evaluate, a loop over a switch
+		float maxRuntimeDifference;		// largest distance or colour difference from the compiled scene
+		float maxFlatSceneDifference;
+		int hlslStatements;
+	};
+
+	float MaxDifference(const float4& a, const float4& b)
+	{
+		return std::max(std::max(std::abs(a.x - b.x), std::abs(a.y - b.y)), std::max(std::abs(a.z - b.z), std::abs(a.w - b.w)));
+	}
+
+	template<typename Evaluate>
+	double TimeEvaluations(const std::vector<float3>& points, std::vector<float4>& results, const Evaluate& evaluate)
+	{
+		const auto startTime = std::chrono::steady_clock::now();
+		for (size_t i = 0; i < points.size(); i++) results[i] = evaluate(points[i]);
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count() / points.size();
+	}
+
+	// Evaluates the default scene at random points around the objects with each form
+	SDFSceneGraphBenchmarkResult BenchmarkSceneGraph(int points, unsigned int seed)
+	{
+		SDFSceneGraphBenchmarkResult result;
+		result.points = points;
+
+		const auto graph = SDFGraph::CreateDefaultSceneGraph();
+		const auto runtime = graph.BuildRuntime();
+		const auto scene = SDFScene::CreateDefaultScene();
+
+		// Around the grid of primitives and the fractal above it
+		std::mt19937 generator(seed);
+		std::uniform_real_distribution<float> x(-2.0f, 1.0f), y(0.0f, 3.0f), z(-3.0f, 1.0f);
+		std::vector<float3> samplePoints(points);
+		for (auto& p : samplePoints) p = float3(x(generator), y(generator), z(generator));
+
+		std::vector<float4> compiled(points), interpreted(points), flat(points);
+		result.compiledNanoseconds = TimeEvaluations(samplePoints, compiled, [&](const float3& p) { return graph.Evaluate(p); });
+		result.runtimeNanoseconds = TimeEvaluations(samplePoints, interpreted, [&](const float3& p) { return runtime->Evaluate(p); });
+		result.flatSceneNanoseconds = TimeEvaluations(samplePoints, flat, [&](const float3& p) { return scene.Evaluate(p); });
+
+		result.maxRuntimeDifference = 0.0f;
+		result.maxFlatSceneDifference = 0.0f;
+		for (auto i = 0; i < points; i++)
+		{
+			result.maxRuntimeDifference = std::max(result.maxRuntimeDifference, MaxDifference(compiled[i], interpreted[i]));
+			result.maxFlatSceneDifference = std::max(result.maxFlatSceneDifference, MaxDifference(compiled[i], flat[i]));
+		}
+
+		const auto hlsl = SDFGraph::EmitHLSL(graph);
+		result.hlslStatements = static_cast<int>(std::count(hlsl.begin(), hlsl.end(), ';'));
+		return result;
+	}
+
+	// Called functions and number literals of one object of the scene, a primitiveSDF case or the emitted lines making it
+	struct HLSLObject
+	{
+		float3 translation;
+		std::vector<std::string> calls;
+		std::vector<float> literals;
+	};
+
+	bool IsIdentifierCharacter(char c)
+	{
+		return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+	}
+
+	// Adds the calls and literals of a line, skipping the constructors and the operations that only join the objects
+	void ReadHLSLLine(const std::string& line, HLSLObject& object)
+	{
+		for (size_t i = 0; i < line.size();)
+		{
+			const auto previous = i > 0 ? line[i - 1] : ' ';
+			if (std::isdigit(static_cast<unsigned char>(line[i])) || (line[i] == '-' && i + 1 < line.size() && std::isdigit(static_cast<unsigned char>(line[i + 1])) && !IsIdentifierCharacter(previous)))
+			{
+				char* end;
+				object.literals.push_back(std::strtof(line.c_str() + i, &end));
+				i = end - line.c_str();
+				if (i < line.size() && line[i] == 'f') i++;
+			}
+			else if (IsIdentifierCharacter(line[i]))
+			{
+				const auto start = i;
+				while (i < line.size() && IsIdentifierCharacter(line[i])) i++;
+				const auto name = line.substr(start, i - start);
+				static const std::vector<std::string> ignored = { "float2", "float3", "float4", "unionSDF", "sierpinskiIterations" };
+				if (i < line.size() && line[i] == '(' && std::find(ignored.begin(), ignored.end(), name) == ignored.end()) object.calls.push_back(name);
+			}
+			else i++;
+		}
+	}
+
+	// Splits the lines into objects, each starting at the line that offsets the sample point to it
+	std::vector<HLSLObject> ReadHLSLObjects(const std::string& code)
+	{
+		std::vector<HLSLObject> objects;
+		std::istringstream lines(code);
+		std::string line;
+		while (std::getline(lines, line))
+		{
+			const auto offset = line.find("samplePoint - float3(");
+			if (offset != std::string::npos)
+			{
+				HLSLObject translation;
+				ReadHLSLLine(line.substr(offset), translation);
+				objects.emplace_back();
+				if (translation.literals.size() >= 3) objects.back().translation = float3(translation.literals[0], translation.literals[1], translation.literals[2]);
+			}
+			const auto label = line.find("case ");
+			if (!objects.empty()) ReadHLSLLine(label == std::string::npos ? line : line.substr(line.find(':', label) + 1), objects.back());
+		}
+		for (auto& object : objects)
+		{
+			std::sort(object.calls.begin(), object.calls.end());
+			std::sort(object.literals.begin(), object.literals.end());
+		}
+		return objects;
+	}
+
+	// Emitted calls that PS_RayMarchObjects.hlsl does not define
+	int CountUndefinedCalls(const std::string& hlsl, const std::string& shader)
+	{
+		HLSLObject emitted;
+		std::istringstream lines(hlsl);
+		std::string line;
+		while (std::getline(lines, line))
+		{
+			if (line.find("sceneSDF(") == std::string::npos) ReadHLSLLine(line, emitted);
+		}
+		emitted.calls.push_back("unionSDF");
+
+		auto undefined = 0;
+		for (const auto& name : emitted.calls)
+		{
+			auto defined = false;
+			for (const auto type : { "float ", "float2 ", "float3 ", "float4 " })
+			{
+				defined = defined || shader.find("\n" + std::string(type) + name + "(") != std::string::npos;
+			}
+			if (!defined)
+			{
+				std::printf("%s is not defined by the shader\n", name.c_str());
+				undefined++;
+			}
+		}
+		return undefined;
+	}
+
+	// Objects of the emitted sceneSDF that differ from the shader's primitiveSDF cases, in order, in translation, the functions
+	// they call or, except for the fractal whose iterations the shader picks from the footprint, their literals
+	int CountShaderMismatches(const std::string& hlsl, const std::string& shader)
+	{
+		const auto start = shader.find("float4 primitiveSDF(");
+		if (start == std::string::npos) return -1;
+		const auto emitted = ReadHLSLObjects(hlsl);
+		const auto cases = ReadHLSLObjects(shader.substr(start, shader.find("\n}\n", start) - start));
+		if (emitted.size() != cases.size() || emitted.empty())
+		{
+			std::printf("%d emitted objects, %d shader cases\n", static_cast<int>(emitted.size()), static_cast<int>(cases.size()));
+			return -1;
+		}
+
+		auto mismatches = 0;
+		for (size_t i = 0; i < emitted.size(); i++)
+		{
+			const auto& a = emitted[i].translation;
+			const auto& b = cases[i].translation;
+			const auto literalsDiffer = i + 1 < emitted.size() && emitted[i].literals != cases[i].literals;
+			if (a.x != b.x || a.y != b.y || a.z != b.z || emitted[i].calls != cases[i].calls || literalsDiffer)
+			{
+				std::printf("emitted object %d differs from the shader's\n", static_cast<int>(i));
+				mismatches++;
+			}
+		}
+		return mismatches;
+	}
+}
+
+void RunSDFSceneGraphChecks(TestReport& report)
+{
+	const auto result = BenchmarkSceneGraph(20000, 7);
+	report.ExpectAtMost("largest difference between the runtime node tree and the compiled scene", result.maxRuntimeDifference, 0.0);
+	report.ExpectAtMost("largest difference between SDFScene::Evaluate and the compiled scene", result.maxFlatSceneDifference, 0.0);
+
+	std::mt19937 generator(3);
+	std::uniform_real_distribution<float> unit(-10.0f, 10.0f);
+	auto misread = 0;
+	for (auto i = 0; i < 10000; i++)
+	{
+		const auto value = unit(generator) * std::pow(10.0f, static_cast<float>(i % 9 - 4));
+		if (std::strtof(SDFGraph::SDFHLSLEmitter::Literal(value).c_str(), nullptr) != value) misread++;
+	}
+	report.ExpectZero("emitted literals that do not read back as the same float", misread);
+
+	const auto hlsl = SDFGraph::EmitHLSL(SDFGraph::CreateDefaultSceneGraph());
+	const auto shader = ReadAppFile("PS_RayMarchObjects.hlsl");
+	report.Expect(!shader.empty(), "PS_RayMarchObjects.hlsl can be read");
+	report.ExpectZero("functions the emitted HLSL calls that PS_RayMarchObjects.hlsl does not define", CountUndefinedCalls(hlsl, shader));
+	report.ExpectZero("emitted objects that differ from PS_RayMarchObjects.hlsl's primitiveSDF", CountShaderMismatches(hlsl, shader));
+
+	const auto cancelled = SDFGraph::EmitHLSL(SDFGraph::DistanceScale(2.0f, SDFGraph::Scale(0.5f, SDFGraph::Sierpinski())));
+	report.Expect(cancelled.find(".x *=") == std::string::npos, "distance scales that cancel are left out of the emitted HLSL");
+}
+
+void RunSDFSceneGraphBenchmarks()
+{
+	const auto result = BenchmarkSceneGraph(2000000, 7);
+	std::printf("default scene at %d random points, %d statements of emitted HLSL\n", result.points, result.hlslStatements);
+	std::printf("%-22s %8s %8s %14s\n", "form", "ns/eval", "slower", "max difference");
+	std::printf("%-22s %8.1f %8.2f %14g\n", "expression template", result.compiledNanoseconds, 1.0, 0.0);
+	std::printf("%-22s %8.1f %8.2f %14g\n", "runtime node tree", result.runtimeNanoseconds, result.runtimeNanoseconds / result.compiledNanoseconds, result.maxRuntimeDifference);
+	std::printf("%-22s %8.1f %8.2f %14g\n", "SDFScene switch loop", result.flatSceneNanoseconds, result.flatSceneNanoseconds / result.compiledNanoseconds, result.maxFlatSceneDifference);
+}
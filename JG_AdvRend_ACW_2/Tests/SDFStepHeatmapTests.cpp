@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "SDFStepHeatmap.h"
+#include "Tests.h"
+
+namespace
+{
+	struct SDFRelaxationBenchmarkResult
+	{
+		float overRelaxation;
+		float relativeEpsilon;
+		SDFImageStats plain;		// overRelaxation 1, relativeEpsilon 0
+		SDFImageStats relaxed;
+		int plainOutcomes[static_cast<int>(SDFMarchOutcome::Count)];
+		int relaxedOutcomes[static_cast<int>(SDFMarchOutcome::Count)];
+		int relaxationFallbacks;	// pixels whose march went back to plain steps
+		int plainPercentile99Steps;
+		int relaxedPercentile99Steps;
+		int mismatchedPixels;		// hit in one image and miss in the other
+		float maxDepthError;		// over pixels hit in both
+	};
+
+	// Plain against enhanced sphere tracing of the same view, the relaxed steps go to relaxedHeatmap when not null
+	SDFRelaxationBenchmarkResult BenchmarkOverRelaxation(const SDFScene& scene, const SDFCamera& camera, int width, int height,
+		float overRelaxation, float relativeEpsilon, SDFStepHeatmap* relaxedHeatmap = nullptr)
+	{
+		SDFRelaxationBenchmarkResult result;
+		result.overRelaxation = overRelaxation;
+		result.relativeEpsilon = relativeEpsilon;
+
+		SDFMarchSettings settings;
+		SDFStepHeatmap plainHeatmap, localHeatmap;
+		auto& heatmap = relaxedHeatmap ? *relaxedHeatmap : localHeatmap;
+		std::vector<float4> plainImage, relaxedImage;
+
+		result.plain = SDFRayMarcher(scene, settings).RenderImage(camera, width, height, &plainImage, nullptr, &plainHeatmap);
+
+		settings.overRelaxation = overRelaxation;
+		settings.relativeEpsilon = relativeEpsilon;
+		result.relaxed = SDFRayMarcher(scene, settings).RenderImage(camera, width, height, &relaxedImage, nullptr, &heatmap);
+
+		for (auto o = 0; o < static_cast<int>(SDFMarchOutcome::Count); o++)
+		{
+			result.plainOutcomes[o] = plainHeatmap.GetOutcomeCount(static_cast<SDFMarchOutcome>(o));
+			result.relaxedOutcomes[o] = heatmap.GetOutcomeCount(static_cast<SDFMarchOutcome>(o));
+		}
+		result.relaxationFallbacks = heatmap.GetRelaxationFallbacks();
+		result.plainPercentile99Steps = plainHeatmap.GetStepPercentile(0.99);
+		result.relaxedPercentile99Steps = heatmap.GetStepPercentile(0.99);
+
+		result.mismatchedPixels = 0;
+		result.maxDepthError = 0.0f;
+		for (auto i = 0; i < width * height; i++)
+		{
+			const auto plainHit = plainImage[i].w < settings.maxDistance;
+			const auto relaxedHit = relaxedImage[i].w < settings.maxDistance;
+			if (plainHit != relaxedHit) result.mismatchedPixels++;
+			else if (plainHit) result.maxDepthError = std::max(result.maxDepthError, std::abs(plainImage[i].w - relaxedImage[i].w));
+		}
+
+		return result;
+	}
+}
+
+void RunSDFStepHeatmapChecks(TestReport& report)
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	const auto camera = SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f));
+	SDFStepHeatmap heatmap;
+	const auto result = BenchmarkOverRelaxation(scene, camera, 160, 90, 1.4f, 0.0f, &heatmap);
+	report.Expect(result.relaxed.steps < result.plain.steps, "over-relaxation saves steps in the close view");
+	report.ExpectAtMost("pixels hit in one image and missed in the other", result.mismatchedPixels, 1);
+	report.ExpectAtMost("largest depth difference where both hit", result.maxDepthError, 1e-3);
+	report.Expect(heatmap.GetTotalSteps() == result.relaxed.steps, "heatmap step total matches the render");
+
+	auto recorded = 0;
+	for (auto o = 0; o < static_cast<int>(SDFMarchOutcome::Count); o++) recorded += heatmap.GetOutcomeCount(static_cast<SDFMarchOutcome>(o));
+	report.Expect(recorded == 160 * 90, "heatmap records an outcome for every pixel");
+}
+
+void RunSDFStepHeatmapBenchmarks()
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	const struct
+	{
+		const char* name;
+		SDFCamera camera;
+	} views[] =
+	{
+		{ "close", SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f)) },
+		{ "wide", SDFCamera::LookAt(float3(0.0f, 1.5f, -4.0f), float3(0.0f, 0.5f, 0.0f)) },
+	};
+	const auto width = 640;
+	const auto height = 360;
+	const auto pixels = static_cast<double>(width) * height;
+
+	std::printf("plain against over-relaxed sphere tracing at %dx%d, relative epsilon in pixels\n", width, height);
+	std::printf("%-6s %5s %7s %8s %8s %7s %6s %6s %6s %6s %9s %10s %9s", "view", "omega", "rel eps", "plain", "relaxed", "saved %", "p99", "p99", "max", "max",
+		"fallbacks", "mismatches", "max dz");
+	for (auto o = 0; o < static_cast<int>(SDFMarchOutcome::Count); o++) std::printf(" %8s", GetOutcomeName(static_cast<SDFMarchOutcome>(o)));
+	std::printf("\n");
+
+	for (const auto& view : views)
+	{
+		for (auto overRelaxation : { 1.0f, 1.2f, 1.4f, 1.6f, 1.8f })
+		{
+			for (auto pixelFraction : { 0.0f, 0.5f })
+			{
+				const auto r = BenchmarkOverRelaxation(scene, view.camera, width, height, overRelaxation, pixelFraction * view.camera.PixelAngle(width));
+				std::printf("%-6s %5.1f %7.1f %8.2f %8.2f %7.1f %6d %6d %6d %6d %9d %10d %9.5f", view.name, overRelaxation, pixelFraction, r.plain.steps / pixels,
+					r.relaxed.steps / pixels, 100.0 * (1.0 - static_cast<double>(r.relaxed.steps) / r.plain.steps), r.plainPercentile99Steps, r.relaxedPercentile99Steps,
+					r.plain.maxPixelSteps, r.relaxed.maxPixelSteps, r.relaxationFallbacks, r.mismatchedPixels, r.maxDepthError);
+				for (auto o = 0; o < static_cast<int>(SDFMarchOutcome::Count); o++) std::printf(" %8d", r.relaxedOutcomes[o] - r.plainOutcomes[o]);
+				std::printf("\n");
+			}
+		}
+	}
+	std::printf("outcome columns are relaxed minus plain pixel counts\n");
+}
@@ -0,0 +1,114 @@
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "SDFInterval.h"
+#include "SDFTilePruning.h"
+#include "Tests.h"
+
+namespace
+{
+	struct SDFTilePruningBenchmarkResult
+	{
+		int primitiveCount;
+		SDFTileStats tiles;
+		SDFImageStats full;
+		SDFImageStats pruned;
+		double evaluationsPerPixelFull;
+		double evaluationsPerPixelPruned;
+		double marchSpeedup;		// marching only
+		double endToEndSpeedup;		// grid build included
+		int mismatchedPixels;		// hit or depth differs between the two images
+	};
+
+	// Point samples in random boxes around the primitive whose distance falls outside the box's interval
+	int CountIntervalViolations(const SDFPrimitive& primitive, int boxes, int samplesPerBox)
+	{
+		std::mt19937 generator(3);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		const auto reach = 1.5f * primitive.boundRadius;
+		auto violations = 0;
+		for (auto box = 0; box < boxes; box++)
+		{
+			const auto corner = primitive.boundCentre + reach * float3(2.0f * unit(generator) - 1.0f, 2.0f * unit(generator) - 1.0f, 2.0f * unit(generator) - 1.0f);
+			const auto size = reach * unit(generator) * float3(unit(generator), unit(generator), unit(generator));
+			const auto range = EvaluatePrimitiveInterval(primitive, corner, corner + size);
+			for (auto i = 0; i < samplesPerBox; i++)
+			{
+				const auto p = corner + size * float3(unit(generator), unit(generator), unit(generator));
+				const auto distance = SDFScene::EvaluatePrimitive(primitive, p).x;
+				const auto tolerance = 1e-4f * (1.0f + std::abs(distance));
+				if (distance < range.lo - tolerance || distance > range.hi + tolerance) violations++;
+			}
+		}
+		return violations;
+	}
+
+	SDFTilePruningBenchmarkResult BenchmarkTilePruning(const SDFScene& scene, const SDFCamera& camera, int width, int height, const SDFTileSettings& settings)
+	{
+		SDFTilePruningBenchmarkResult result;
+		result.primitiveCount = scene.GetPrimitiveCount();
+
+		SDFMarchSettings marchSettings;
+		const SDFRayMarcher marcher(scene, marchSettings);
+		std::vector<float4> fullImage, prunedImage;
+
+		result.full = marcher.RenderImage(camera, width, height, &fullImage);
+
+		SDFTileGrid grid(scene, camera, width, height, marchSettings.maxDistance, settings);
+		grid.Build();
+		result.tiles = grid.GetStats();
+		result.pruned = marcher.RenderImagePruned(grid, &prunedImage);
+
+		const auto pixels = static_cast<double>(width) * height;
+		result.evaluationsPerPixelFull = result.full.primitiveEvaluations / pixels;
+		result.evaluationsPerPixelPruned = result.pruned.primitiveEvaluations / pixels;
+		result.marchSpeedup = result.full.milliseconds / result.pruned.milliseconds;
+		result.endToEndSpeedup = result.full.milliseconds / (result.tiles.buildMilliseconds + result.pruned.milliseconds);
+
+		result.mismatchedPixels = 0;
+		for (auto i = 0; i < width * height; i++)
+		{
+			if (std::fabs(fullImage[i].w - prunedImage[i].w) > marchSettings.epsilon) result.mismatchedPixels++;
+		}
+
+		return result;
+	}
+}
+
+void RunSDFTilePruningChecks(TestReport& report)
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	for (const auto& primitive : scene.GetPrimitives())
+	{
+		report.ExpectZero("samples of primitive type " + std::to_string(static_cast<int>(primitive.type)) + " outside their box's distance interval", CountIntervalViolations(primitive, 300, 40));
+	}
+
+	const auto camera = SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f));
+	report.ExpectZero("pixels whose pruned depth differs", BenchmarkTilePruning(scene, camera, 96, 64, SDFTileSettings()).mismatchedPixels);
+}
+
+void RunSDFTilePruningBenchmarks()
+{
+	const auto scene = SDFScene::CreateDefaultScene();
+	const auto random = SDFScene::CreateRandomScene(200, 7, 10.0f);
+	const auto close = SDFCamera::LookAt(float3(0.0f, 0.9f, -1.2f), float3(0.0f, 0.5f, 0.15f));
+	const auto wide = SDFCamera::LookAt(float3(0.0f, 1.5f, -4.0f), float3(0.0f, 0.5f, 0.0f));
+	struct Case
+	{
+		const char* name;
+		const SDFScene& scene;
+		SDFCamera camera;
+	};
+	const Case cases[] = { { "default close", scene, close }, { "default wide", scene, wide }, { "200 random", random, wide } };
+
+	std::printf("interval tile pruning at 320x180\n");
+	std::printf("%-14s %10s %10s %10s %9s %9s %9s %8s %8s %10s\n", "scene", "primitives", "root/tile", "leaf/tile", "build ms", "ms", "pruned ms", "march", "overall", "mismatches");
+	for (const auto& test : cases)
+	{
+		const auto result = BenchmarkTilePruning(test.scene, test.camera, 320, 180, SDFTileSettings());
+		std::printf("%-14s %10d %10.1f %10.1f %9.1f %9.1f %9.1f %7.2fx %7.2fx %10d\n", test.name, result.primitiveCount, result.tiles.averagePrimitivesPerRootTile, result.tiles.averagePrimitivesPerLeafTile,
+			result.tiles.buildMilliseconds, result.full.milliseconds, result.pruned.milliseconds, result.marchSpeedup, result.endToEndSpeedup, result.mismatchedPixels);
+	}
+}
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "TerrainBaker.h"
+#include "Tests.h"
+
+using namespace HLSL;
+
+namespace
+{
+	struct TerrainBakeMipError
+	{
+		int resolution;
+		// Bilinear samples of the mip against the procedural surface at the same points
+		float maxHeightError;
+		float meanHeightError;
+		float maxNormalErrorDegrees;
+		float meanNormalErrorDegrees;
+	};
+
+	struct TerrainBakeBenchmarkResult
+	{
+		int resolution;
+		int mips;
+		std::size_t textureBytes;				// both maps, every mip
+		double bakeMilliseconds;				// top mip, noise and derivative per texel
+		double mipMilliseconds;					// the rest of the chain
+		std::vector<TerrainBakeMipError> mipErrors;
+		// Height and normal per domain vertex, by evaluating the noise and by sampling the top mip
+		double proceduralSamplesPerSecond;
+		double bakedSamplesPerSecond;
+	};
+
+	double MillisecondsSince(std::chrono::steady_clock::time_point startTime)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	float AngleDegrees(const float3& a, const float3& b)
+	{
+		return std::acos(clamp(dot(a, b), -1.0f, 1.0f)) * 57.2957795f;
+	}
+
+	// Bakes with the settings and compares against the noise at about samples points jittered over the plane
+	TerrainBakeBenchmarkResult BenchmarkTerrainBake(const TerrainBakeSettings& settings, int samples)
+	{
+		const TerrainMaps maps(settings);
+
+		TerrainBakeBenchmarkResult result = {};
+		result.resolution = settings.resolution;
+		result.mips = maps.GetMipCount();
+		result.textureBytes = maps.GetBytes();
+		result.bakeMilliseconds = maps.GetBakeMilliseconds();
+		result.mipMilliseconds = maps.GetMipMilliseconds();
+
+		// A jittered grid walked row by row, in the order a patch's domain vertices come
+		const auto side = std::max(1, static_cast<int>(std::sqrt(static_cast<float>(samples))));
+		samples = side * side;
+		const auto spacing = 2.0f * settings.halfSize / side;
+		std::mt19937 random(5489u);
+		std::uniform_real_distribution<float> jitter(0.0f, spacing);
+		std::vector<float> x(samples);
+		std::vector<float> z(samples);
+		for (auto i = 0; i < samples; i++)
+		{
+			x[i] = -settings.halfSize + (i % side) * spacing + jitter(random);
+			z[i] = -settings.halfSize + (i / side) * spacing + jitter(random);
+		}
+
+		std::vector<float> heights(samples);
+		std::vector<float3> normals(samples);
+		auto startTime = std::chrono::steady_clock::now();
+		for (auto i = 0; i < samples; i++)
+		{
+			// One evaluation for both, as DS_Terrain did
+			const auto n = maps.Evaluate(x[i], z[i]);
+			heights[i] = n.x;
+			normals[i] = normalize(float3(-n.y, 1.0f, -n.w));
+		}
+		result.proceduralSamplesPerSecond = samples / (MillisecondsSince(startTime) / 1000.0);
+
+		// Summed so the samples are not optimised away
+		volatile float sink = 0.0f;
+		auto sum = 0.0f;
+		startTime = std::chrono::steady_clock::now();
+		for (auto i = 0; i < samples; i++)
+		{
+			sum += maps.SampleHeight(x[i], z[i], 0) + maps.SampleNormal(x[i], z[i], 0).y;
+		}
+		result.bakedSamplesPerSecond = samples / (MillisecondsSince(startTime) / 1000.0);
+		sink = sink + sum;
+
+		for (auto mip = 0; mip < maps.GetMipCount(); mip++)
+		{
+			TerrainBakeMipError error = {};
+			error.resolution = maps.GetMipResolution(mip);
+			for (auto i = 0; i < samples; i++)
+			{
+				const auto heightError = std::abs(maps.SampleHeight(x[i], z[i], mip) - heights[i]);
+				const auto normalError = AngleDegrees(maps.SampleNormal(x[i], z[i], mip), normals[i]);
+				error.maxHeightError = std::max(error.maxHeightError, heightError);
+				error.meanHeightError += heightError;
+				error.maxNormalErrorDegrees = std::max(error.maxNormalErrorDegrees, normalError);
+				error.meanNormalErrorDegrees += normalError;
+			}
+			error.meanHeightError /= samples;
+			error.meanNormalErrorDegrees /= samples;
+			result.mipErrors.push_back(error);
+		}
+
+		return result;
+	}
+}
+
+void RunTerrainBakerChecks(TestReport& report)
+{
+	const TerrainBakeSettings settings;
+	const auto result = BenchmarkTerrainBake(settings, 20000);
+	report.Expect(result.mips == 11 && result.mipErrors.back().resolution == 1, "a full mip chain down to 1 x 1");
+
+	const auto& top = result.mipErrors.front();
+	report.ExpectAtMost("largest top mip height error", top.maxHeightError, 0.005);
+	report.ExpectAtMost("largest top mip normal error in degrees", top.maxNormalErrorDegrees, 1.5);
+
+	auto coarsening = 0;
+	for (size_t mip = 1; mip < result.mipErrors.size(); mip++)
+	{
+		if (result.mipErrors[mip].meanHeightError < result.mipErrors[mip - 1].meanHeightError) coarsening++;
+	}
+	report.ExpectZero("mips with a smaller mean height error than the mip above", coarsening);
+}
+
+void RunTerrainBakerBenchmarks()
+{
+	std::printf("terrain maps against the noise at 200000 jittered points, samples in millions a second, errors of the top mip\n");
+	std::printf("%-5s %5s %9s %8s %8s %10s %6s %10s %10s %10s %10s\n", "size", "mips", "MB", "bake ms", "mips ms", "procedural", "baked", "max height", "mean",
+		"max normal", "mean");
+	for (const auto resolution : { 512, 1024, 2048 })
+	{
+		TerrainBakeSettings settings;
+		settings.resolution = resolution;
+		const auto result = BenchmarkTerrainBake(settings, 200000);
+		const auto& top = result.mipErrors.front();
+		std::printf("%-5d %5d %9.2f %8.1f %8.1f %10.2f %6.2f %10.5f %10.6f %10.3f %10.4f\n", result.resolution, result.mips, result.textureBytes / 1048576.0,
+			result.bakeMilliseconds, result.mipMilliseconds, result.proceduralSamplesPerSecond / 1e6, result.bakedSamplesPerSecond / 1e6, top.maxHeightError,
+			top.meanHeightError, top.maxNormalErrorDegrees, top.meanNormalErrorDegrees);
+	}
+}
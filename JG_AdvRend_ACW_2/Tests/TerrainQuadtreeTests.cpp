@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "TerrainQuadtree.h"
+#include "Tests.h"
+
+using namespace HLSL;
+
+namespace
+{
+	struct Rectangle
+	{
+		float minX, minZ, maxX, maxZ;
+
+		bool Contains(float x, float z) const { return x >= minX && x < maxX && z >= minZ && z < maxZ; }
+	};
+
+	Rectangle ChunkArea(const TerrainChunk& chunk)
+	{
+		if (chunk.quadrant < 0) return { chunk.x, chunk.z, chunk.x + chunk.size, chunk.z + chunk.size };
+
+		const auto half = 0.5f * chunk.size;
+		const auto x = chunk.x + (chunk.quadrant & 1) * half;
+		const auto z = chunk.z + (chunk.quadrant >> 1) * half;
+		return { x, z, x + half, z + half };
+	}
+
+	double MicrosecondsSince(std::chrono::steady_clock::time_point startTime)
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+	}
+
+	struct TerrainSelectionCheck
+	{
+		int chunks;
+		float coveredArea;				// summed over the chunks, the terrain's area when they tile it
+		int levelJumps;					// chunk edges meeting a chunk more than one level away
+		int crackVertices;				// edge vertices facing a coarser chunk not fully morphed onto its grid
+	};
+
+	// Walks every chunk's edges and what lies across them
+	TerrainSelectionCheck CheckTerrainSelection(const TerrainQuadtree& quadtree, const float3& camera)
+	{
+		std::vector<TerrainChunk> chunks;
+		quadtree.Select(camera, chunks);
+
+		TerrainSelectionCheck result = {};
+		result.chunks = static_cast<int>(chunks.size());
+
+		std::vector<Rectangle> areas;
+		for (const auto& chunk : chunks)
+		{
+			areas.push_back(ChunkArea(chunk));
+			result.coveredArea += (areas.back().maxX - areas.back().minX) * (areas.back().maxZ - areas.back().minZ);
+		}
+
+		const auto dimension = quadtree.GetSettings().gridDimension;
+		for (auto i = 0; i < static_cast<int>(chunks.size()); i++)
+		{
+			const auto& chunk = chunks[i];
+			const auto& area = areas[i];
+			const auto spacing = chunk.size / dimension;
+
+			// Edges as a start corner and a step along them, each probed just outside between its vertices
+			const struct { float x, z, stepX, stepZ, outX, outZ; } edges[] =
+			{
+				{ area.minX, area.minZ, 1.0f, 0.0f, 0.0f, -1.0f },
+				{ area.minX, area.maxZ, 1.0f, 0.0f, 0.0f, 1.0f },
+				{ area.minX, area.minZ, 0.0f, 1.0f, -1.0f, 0.0f },
+				{ area.maxX, area.minZ, 0.0f, 1.0f, 1.0f, 0.0f },
+			};
+			const auto vertices = static_cast<int>(std::lround((area.maxX - area.minX) / spacing));
+
+			for (const auto& edge : edges)
+			{
+				auto jumped = false;
+				for (auto vertex = 0; vertex < vertices; vertex++)
+				{
+					const auto along = (vertex + 0.5f) * spacing;
+					const auto probeX = edge.x + edge.stepX * along + edge.outX * 0.25f * spacing;
+					const auto probeZ = edge.z + edge.stepZ * along + edge.outZ * 0.25f * spacing;
+
+					const TerrainChunk* neighbour = nullptr;
+					for (auto j = 0; j < static_cast<int>(chunks.size()); j++)
+					{
+						if (areas[j].Contains(probeX, probeZ)) neighbour = &chunks[j];
+					}
+					if (neighbour == nullptr || neighbour->level <= chunk.level) continue;
+					if (neighbour->level > chunk.level + 1) jumped = true;
+
+					// The vertex past the probe, odd ones in the node's grid have to have morphed away
+					const auto x = edge.x + edge.stepX * (vertex + 1) * spacing;
+					const auto z = edge.z + edge.stepZ * (vertex + 1) * spacing;
+					const auto index = static_cast<int>(std::lround((edge.stepX != 0.0f ? x - chunk.x : z - chunk.z) / spacing));
+					if (index % 2 == 1 && quadtree.MorphFactor(chunk, float2(x, z), camera) < 1.0f) result.crackVertices++;
+				}
+				if (jumped) result.levelJumps++;
+			}
+		}
+
+		return result;
+	}
+
+	struct TerrainFlightResult
+	{
+		const char* name;
+		int frames;
+		double meanSelectionMicroseconds;
+		double maxSelectionMicroseconds;
+		double meanChunks;
+		int maxChunks;
+		double meanTriangles;			// grid triangles, before tessellation
+		int maxTriangles;
+		long long uniformTriangles;	// the whole terrain at the leaves' density
+		// CheckTerrainSelection on every frame
+		int levelJumps;
+		int crackVertices;
+		float minCoverage;				// covered area over the terrain's
+	};
+
+	// Scripted flights scaled to the terrain: a low pass, a climbing spiral, a dive and a low run along the edge
+	std::vector<TerrainFlightResult> BenchmarkTerrainFlights(const TerrainQuadtree& quadtree, int frames)
+	{
+		const auto& maps = quadtree.GetMaps();
+		const auto halfSize = maps.GetSettings().halfSize;
+		const auto amplitude = maps.GetSettings().amplitude;
+		const auto& settings = quadtree.GetSettings();
+
+		// Camera at a point of the flight, t in [0, 1], as xz and height over the ground
+		struct Flight
+		{
+			const char* name;
+			float3(*path)(float t, float halfSize, float amplitude);
+		};
+		const Flight flights[] =
+		{
+			{ "low pass", [](float t, float h, float a) { return float3(-0.9f * h + 1.8f * h * t, 0.05f * a, -0.6f * h + 1.2f * h * t); } },
+			{ "climbing spiral", [](float t, float h, float a) { const auto angle = 12.566f * t; return float3(0.6f * h * std::cos(angle), 0.02f * a + 2.0f * a * t, 0.6f * h * std::sin(angle)); } },
+			{ "dive", [](float t, float h, float a) { return float3(0.1f * h * t, 0.5f * h * (1.0f - t) + 0.02f * a, 0.2f * h * t); } },
+			{ "edge run", [](float t, float h, float a) { return float3(0.97f * h, 0.01f * a, -0.97f * h + 1.94f * h * t); } },
+		};
+
+		const auto leaves = 1 << (settings.levels - 1);
+		const auto uniformSide = static_cast<long long>(leaves) * settings.gridDimension;
+
+		std::vector<TerrainFlightResult> results;
+		std::vector<TerrainChunk> chunks;
+		for (const auto& flight : flights)
+		{
+			TerrainFlightResult result = {};
+			result.name = flight.name;
+			result.frames = frames;
+			result.uniformTriangles = 2 * uniformSide * uniformSide;
+			result.minCoverage = 1.0f;
+
+			for (auto frame = 0; frame < frames; frame++)
+			{
+				const auto point = flight.path(frame / static_cast<float>(std::max(frames - 1, 1)), halfSize, amplitude);
+				const float3 camera(point.x, maps.SampleHeight(point.x, point.z, 0) + point.y, point.z);
+
+				const auto startTime = std::chrono::steady_clock::now();
+				quadtree.Select(camera, chunks);
+				const auto microseconds = MicrosecondsSince(startTime);
+
+				auto triangles = 0;
+				for (const auto& chunk : chunks) triangles += quadtree.GetTriangleCount(chunk);
+
+				result.meanSelectionMicroseconds += microseconds;
+				result.maxSelectionMicroseconds = std::max(result.maxSelectionMicroseconds, microseconds);
+				result.meanChunks += static_cast<double>(chunks.size());
+				result.maxChunks = std::max(result.maxChunks, static_cast<int>(chunks.size()));
+				result.meanTriangles += triangles;
+				result.maxTriangles = std::max(result.maxTriangles, triangles);
+
+				const auto check = CheckTerrainSelection(quadtree, camera);
+				result.levelJumps += check.levelJumps;
+				result.crackVertices += check.crackVertices;
+				result.minCoverage = std::min(result.minCoverage, check.coveredArea / (4.0f * halfSize * halfSize));
+			}
+
+			result.meanSelectionMicroseconds /= frames;
+			result.meanChunks /= frames;
+			result.meanTriangles /= frames;
+			results.push_back(result);
+		}
+
+		return results;
+	}
+
+	struct TerrainSize
+	{
+		const char* name;
+		TerrainBakeSettings bake;
+		TerrainQuadtreeSettings quadtree;
+	};
+
+	// 8 levels over 4 km x 4 km, 31.25 m leaves
+	TerrainSize MakeLargeTerrain()
+	{
+		TerrainSize terrain = { "4 km", TerrainBakeSettings(), TerrainQuadtreeSettings() };
+		terrain.bake.halfSize = 2000.0f;
+		terrain.bake.octaves = 6;
+		terrain.bake.frequency = 1.0f / 400.0f;
+		terrain.bake.amplitude = 400.0f;
+		terrain.quadtree.levels = 8;
+		terrain.quadtree.gridDimension = 32;
+		terrain.quadtree.lodRange = 80.0f;
+		return terrain;
+	}
+
+	const TerrainSize TerrainSizes[] =
+	{
+		{ "app", TerrainBakeSettings(), TerrainQuadtreeSettings() },
+		MakeLargeTerrain(),
+	};
+}
+
+void RunTerrainQuadtreeChecks(TestReport& report)
+{
+	for (const auto& terrain : TerrainSizes)
+	{
+		const TerrainMaps maps(terrain.bake);
+		const TerrainQuadtree quadtree(maps, terrain.quadtree);
+		for (const auto& result : BenchmarkTerrainFlights(quadtree, 50))
+		{
+			const auto name = std::string(terrain.name) + " terrain " + result.name;
+			report.ExpectZero(name + " crack vertices", result.crackVertices);
+			report.ExpectZero(name + " level jumps", result.levelJumps);
+			report.ExpectAtMost(name + " terrain area left uncovered by the chunks", 1.0 - result.minCoverage, 1e-5);
+		}
+	}
+}
+
+void RunTerrainQuadtreeBenchmarks()
+{
+	std::printf("200 frame flights, selection in microseconds, grid triangles before tessellation\n");
+	std::printf("%-7s %-16s %8s %8s %8s %6s %9s %9s %12s %5s %6s %8s\n", "terrain", "flight", "mean us", "max us", "chunks", "max", "triangles", "max",
+		"uniform", "jumps", "cracks", "coverage");
+	for (const auto& terrain : TerrainSizes)
+	{
+		const TerrainMaps maps(terrain.bake);
+		const TerrainQuadtree quadtree(maps, terrain.quadtree);
+		for (const auto& result : BenchmarkTerrainFlights(quadtree, 200))
+		{
+			std::printf("%-7s %-16s %8.1f %8.1f %8.1f %6d %9.0f %9d %12lld %5d %6d %8.6f\n", terrain.name, result.name, result.meanSelectionMicroseconds,
+				result.maxSelectionMicroseconds, result.meanChunks, result.maxChunks, result.meanTriangles, result.maxTriangles, result.uniformTriangles,
+				result.levelJumps, result.crackVertices, result.minCoverage);
+		}
+	}
+}
@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <initializer_list>
+#include <thread>
+#include <vector>
+#include "TerrainBaker.h"
+#include "TerrainTileService.h"
+#include "Tests.h"
+
+using namespace HLSL;
+
+namespace
+{
+	struct TerrainTileCheck
+	{
+		int tiles;
+		int seamMismatches;				// samples on an edge that differ from the neighbour's same sample
+		float maxHeightError;			// SampleHeight at the sample positions against EvaluateTerrain there
+		int overCapFrames;				// frames left over the memory cap while the needed tiles fit under it
+	};
+
+	struct TerrainTilePathResult
+	{
+		const char* name;
+		float prefetchSeconds;
+		int frames;
+		int framesWaited;
+		double hitRate;					// needed tiles ready when asked for, over every frame's
+		int tilesGenerated;
+		int tilesEvicted;
+		double meanLatencyMilliseconds;	// request to the render thread
+		double maxLatencyMilliseconds;
+		double meanGenerateMilliseconds;
+		std::size_t peakBytes;
+		int threads;
+	};
+
+	// The service's sample placement, counted from the origin
+	float SamplePosition(long long i, const TerrainTileSettings& settings)
+	{
+		return static_cast<float>(i * (static_cast<double>(settings.tileSize) / (settings.resolution - 1)));
+	}
+
+	// A small cap flown across so the cache evicts every frame
+	TerrainTileCheck CheckTerrainTiles()
+	{
+		// About 13 tiles needed at a time against a cap of 24
+		TerrainTileSettings settings;
+		settings.tileSize = 8.0f;
+		settings.resolution = 33;
+		settings.viewRadius = 12.0f;
+		settings.prefetchSeconds = 0.5f;
+		settings.memoryBytes = 24 * static_cast<std::size_t>(settings.resolution) * settings.resolution * (sizeof(float) + sizeof(std::uint32_t));
+		TerrainTileService service(settings);
+
+		TerrainTileCheck check = {};
+		const auto velocity = float3(40.0f, 0.0f, 15.0f);
+		const auto frameSeconds = 1.0f / 60.0f;
+		for (auto frame = 0; frame < 240; frame++)
+		{
+			const auto position = float3(-50.0f, 10.0f, -20.0f) + velocity * (frame * frameSeconds);
+			const auto stats = service.Update(position, velocity);
+			if (stats.neededTiles * service.GetTileBytes() <= settings.memoryBytes && service.GetCachedBytes() > settings.memoryBytes) check.overCapFrames++;
+			// Every frame's tiles finished before the next, so each frame evicts
+			service.Preload(position);
+		}
+
+		const auto last = settings.resolution - 1;
+		for (auto z = -20; z <= 20; z++)
+		{
+			for (auto x = -20; x <= 20; x++)
+			{
+				const auto* tile = service.FindTile(x, z);
+				if (!tile) continue;
+				check.tiles++;
+
+				const auto* right = service.FindTile(x + 1, z);
+				const auto* above = service.FindTile(x, z + 1);
+				for (auto i = 0; i < settings.resolution; i++)
+				{
+					if (right && tile->heights[i * settings.resolution + last] != right->heights[i * settings.resolution]) check.seamMismatches++;
+					if (above && tile->heights[last * settings.resolution + i] != above->heights[i]) check.seamMismatches++;
+				}
+
+				// Away from the edges, where the point could fall in the neighbour
+				const auto cells = static_cast<long long>(last);
+				for (auto row = 1; row < last; row += 7)
+				{
+					for (auto column = 1; column < last; column += 7)
+					{
+						const auto sampleX = SamplePosition(x * cells + column, settings);
+						const auto sampleZ = SamplePosition(z * cells + row, settings);
+						float height;
+						if (!service.SampleHeight(sampleX, sampleZ, height)) continue;
+						const auto expected = EvaluateTerrain(sampleX, sampleZ, settings.octaves, settings.frequency, settings.amplitude).x;
+						check.maxHeightError = std::max(check.maxHeightError, std::abs(height - expected));
+					}
+				}
+			}
+		}
+		return check;
+	}
+
+	// Scripted flights at 60 frames a second in real time, each preloaded at its start, with and without prefetching
+	std::vector<TerrainTilePathResult> BenchmarkTerrainTiles(const TerrainTileSettings& settings, float seconds)
+	{
+		const auto speed = 2.0f * settings.tileSize;
+		struct Path
+		{
+			const char* name;
+			float3(*position)(float time, float speed);
+		};
+		const Path paths[] =
+		{
+			{ "straight", [](float time, float speed) { return float3(speed * time, 20.0f, 0.0f); } },
+			{ "circling", [](float time, float speed)
+			{
+				const auto radius = 5.0f * speed;
+				const auto angle = time * speed / radius;
+				return float3(radius * std::cos(angle), 20.0f, radius * std::sin(angle));
+			} },
+			// Turning 90 degrees every two seconds, alternately left and right of north
+			{ "zig-zag", [](float time, float speed)
+			{
+				const auto leg = std::floor(time / 2.0f);
+				const auto along = time - 2.0f * leg;
+				const auto across = static_cast<int>(leg) % 2 == 0 ? along : 2.0f - along;
+				const auto step = speed * 0.70710678f;
+				return float3(across * step, 20.0f, (2.0f * leg + along) * step);
+			} },
+		};
+
+		std::vector<TerrainTilePathResult> results;
+		const auto frameSeconds = 1.0f / 60.0f;
+		const auto frames = static_cast<int>(std::lround(seconds / frameSeconds));
+		for (const auto& path : paths)
+		{
+			for (const auto prefetchSeconds : { 0.0f, settings.prefetchSeconds })
+			{
+				auto pathSettings = settings;
+				pathSettings.prefetchSeconds = prefetchSeconds;
+				TerrainTileService service(pathSettings);
+				service.Preload(path.position(0.0f, speed));
+
+				TerrainTilePathResult result = { path.name, prefetchSeconds, frames, 0, 0.0, 0, 0, 0.0, 0.0, 0.0, 0, service.GetThreadCount() };
+				auto needed = 0LL;
+				auto ready = 0LL;
+				auto latency = 0.0;
+				auto generate = 0.0;
+				const auto startTime = std::chrono::steady_clock::now();
+				for (auto frame = 1; frame <= frames; frame++)
+				{
+					// The render thread's frames come at their time whatever the workers are doing
+					const auto time = frame * frameSeconds;
+					std::this_thread::sleep_until(startTime + std::chrono::duration<double>(time));
+
+					const auto position = path.position(time, speed);
+					const auto velocity = (position - path.position(time - frameSeconds, speed)) / frameSeconds;
+					const auto stats = service.Update(position, velocity);
+					needed += stats.neededTiles;
+					ready += stats.readyTiles;
+					if (stats.waited) result.framesWaited++;
+					result.tilesGenerated += stats.finishedTiles;
+					result.tilesEvicted += stats.evictedTiles;
+					latency += stats.latencyMilliseconds;
+					generate += stats.generateMilliseconds;
+					result.maxLatencyMilliseconds = std::max(result.maxLatencyMilliseconds, stats.maxLatencyMilliseconds);
+					result.peakBytes = std::max(result.peakBytes, service.GetCachedBytes());
+				}
+				result.hitRate = needed > 0 ? static_cast<double>(ready) / needed : 1.0;
+				result.meanLatencyMilliseconds = result.tilesGenerated > 0 ? latency / result.tilesGenerated : 0.0;
+				result.meanGenerateMilliseconds = result.tilesGenerated > 0 ? generate / result.tilesGenerated : 0.0;
+				results.push_back(result);
+			}
+		}
+		return results;
+	}
+}
+
+void RunTerrainTileServiceChecks(TestReport& report)
+{
+	const auto check = CheckTerrainTiles();
+	report.Expect(check.tiles > 0, "tiles cached at the end of the flight");
+	report.ExpectZero("edge samples differing from the neighbour's", check.seamMismatches);
+	report.ExpectAtMost("height error at the samples", check.maxHeightError, 0.0);
+	report.ExpectZero("frames over the memory cap", check.overCapFrames);
+}
+
+void RunTerrainTileServiceBenchmarks()
+{
+	const auto check = CheckTerrainTiles();
+	std::printf("%d tiles, %d seam mismatches, height error %g, %d frames over the cap\n", check.tiles, check.seamMismatches, check.maxHeightError, check.overCapFrames);
+
+	std::printf("\n5 s flights at 60 frames a second, the default settings\n");
+	std::printf("%-9s %8s %6s %6s %7s %9s %7s %8s %8s %8s %7s %7s\n", "path", "prefetch", "frames", "waited", "hits", "generated", "evicted",
+		"mean ms", "max ms", "make ms", "peak MB", "threads");
+	for (const auto& result : BenchmarkTerrainTiles(TerrainTileSettings(), 5.0f))
+	{
+		std::printf("%-9s %8.1f %6d %6d %7.4f %9d %7d %8.1f %8.1f %8.2f %7.1f %7d\n", result.name, result.prefetchSeconds, result.frames, result.framesWaited,
+			result.hitRate, result.tilesGenerated, result.tilesEvicted, result.meanLatencyMilliseconds, result.maxLatencyMilliseconds,
+			result.meanGenerateMilliseconds, result.peakBytes / 1048576.0, result.threads);
+	}
+}
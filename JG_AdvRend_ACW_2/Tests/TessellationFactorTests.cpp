@@ -0,0 +1,328 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Common/TessellationFactor.h"
+#include "TerrainQuadtree.h"
+#include "Tests.h"
+
+using namespace HLSL;
+
+namespace
+{
+	// Sample3DSceneRenderer's field of view
+	const float FieldOfView = 70.0f * 3.14159265f / 180.0f;
+	const float Pi = 3.14159265f;
+
+	TessellationTarget MakeTarget(float viewportHeight, float edgePixels)
+	{
+		return { 0.5f * viewportHeight / std::tan(0.5f * FieldOfView), edgePixels, 64.0f };
+	}
+
+	std::uint32_t Bits(float value)
+	{
+		std::uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	// Segments fractional_odd partitioning puts along a factor, counting the two short ones
+	float OddSegments(float factor)
+	{
+		return 2.0f * std::ceil(0.5f * (factor - 1.0f)) + 1.0f;
+	}
+
+	// VS_ViewDependentTessellatedSphere's factor before screen-space factors replaced it
+	float DistanceRamp(float distance)
+	{
+		return 1.0f + saturate((3.0f - distance) / (3.0f - 1.0f)) * (64.0f - 1.0f);
+	}
+
+	struct SharedEdge
+	{
+		std::uint32_t factor;
+		std::uint32_t firstPointFactor;
+	};
+
+	struct TessellationCrackCheck
+	{
+		int meshes;
+		int cameras;					// per mesh
+		long long sharedEdges;			// edges two triangles share, once per camera
+		long long crackedEdges;			// shared edges the two triangles give factors of different bits
+		long long badFactors;			// factors outside [1, maxFactor], or insides below one of their edges
+		// The same edges with each patch's factors from its first control point, as HS_ViewDependentTessellatedSphere had them
+		long long firstPointCrackedEdges;
+	};
+
+	// Random height fields with random diagonals, control point order and winding, seen from random cameras
+	TessellationCrackCheck CheckTessellationCracks(int meshes, int cameras)
+	{
+		TessellationCrackCheck check = { meshes, cameras, 0, 0, 0, 0 };
+		const auto target = MakeTarget(1080.0f, 8.0f);
+
+		std::mt19937 random(5489u);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<float3> points;
+		std::vector<int> triangles;
+		std::unordered_map<std::uint64_t, SharedEdge> edges;
+
+		for (auto mesh = 0; mesh < meshes; mesh++)
+		{
+			// Sized about the sphere's distance ramp, so both schemes give factors that vary
+			const auto cells = 2 + static_cast<int>(random() % 31);
+			const auto spacing = 4.0f / cells * (0.5f + unit(random));
+			const auto extent = spacing * cells;
+			points.clear();
+			for (auto z = 0; z <= cells; z++)
+			{
+				for (auto x = 0; x <= cells; x++)
+				{
+					const auto jitterX = (unit(random) - 0.5f) * 0.6f * spacing;
+					const auto jitterZ = (unit(random) - 0.5f) * 0.6f * spacing;
+					points.push_back(float3(x * spacing + jitterX, unit(random) * 0.25f * extent, z * spacing + jitterZ));
+				}
+			}
+
+			triangles.clear();
+			const auto addTriangle = [&](int a, int b, int c)
+			{
+				int corners[3] = { a, b, c };
+				if (random() & 1) std::swap(corners[1], corners[2]);
+				const auto rotation = static_cast<int>(random() % 3);
+				for (auto i = 0; i < 3; i++) triangles.push_back(corners[(i + rotation) % 3]);
+			};
+			for (auto z = 0; z < cells; z++)
+			{
+				for (auto x = 0; x < cells; x++)
+				{
+					const auto corner = z * (cells + 1) + x;
+					const auto right = corner + 1;
+					const auto up = corner + cells + 1;
+					const auto diagonal = up + 1;
+					if (random() & 1)
+					{
+						addTriangle(corner, up, diagonal);
+						addTriangle(corner, diagonal, right);
+					}
+					else
+					{
+						addTriangle(corner, up, right);
+						addTriangle(right, up, diagonal);
+					}
+				}
+			}
+
+			for (auto camera = 0; camera < cameras; camera++)
+			{
+				const auto position = float3((unit(random) * 2.0f - 0.5f) * extent, 0.05f + unit(random) * extent, (unit(random) * 2.0f - 0.5f) * extent);
+				edges.clear();
+				for (std::size_t t = 0; t < triangles.size(); t += 3)
+				{
+					const int corners[3] = { triangles[t], triangles[t + 1], triangles[t + 2] };
+					const auto& p0 = points[corners[0]];
+					const auto factors = triangleTessellationFactors(p0, points[corners[1]], points[corners[2]], position, target);
+					const auto firstPointFactor = Bits(DistanceRamp(length(p0 - position)));
+
+					const float edgeFactors[3] = { factors.x, factors.y, factors.z };
+					for (auto i = 0; i < 3; i++)
+					{
+						if (!(edgeFactors[i] >= 1.0f && edgeFactors[i] <= target.maxFactor) || factors.w < edgeFactors[i]) check.badFactors++;
+
+						// Edge i is opposite corner i
+						const auto a = corners[(i + 1) % 3];
+						const auto b = corners[(i + 2) % 3];
+						const auto key = static_cast<std::uint64_t>(std::min(a, b)) << 32 | static_cast<std::uint32_t>(std::max(a, b));
+						const SharedEdge edge = { Bits(edgeFactors[i]), firstPointFactor };
+						const auto inserted = edges.insert(std::make_pair(key, edge));
+						if (inserted.second) continue;
+
+						check.sharedEdges++;
+						if (inserted.first->second.factor != edge.factor) check.crackedEdges++;
+						if (inserted.first->second.firstPointFactor != edge.firstPointFactor) check.firstPointCrackedEdges++;
+					}
+				}
+			}
+		}
+		return check;
+	}
+
+	struct TessellationSavingsResult
+	{
+		const char* name;
+		int patches;					// per view, mean
+		int views;
+		// Mean triangles per view, from each patch's inside factors rounded up to fractional_odd's odd segment counts
+		double screenSpaceTriangles;
+		double uniformTriangles;		// every patch at the largest screen-space factor of its view, nowhere coarser
+		double previousTriangles;		// the factors the hull shader had before
+		// Tessellated segments on screen in pixels, over every patch edge of every view
+		float screenSpaceMaxSegmentPixels;
+		float previousMaxSegmentPixels;
+		float screenSpaceMeanSegmentPixels;
+		float previousMeanSegmentPixels;
+	};
+
+	// Terrain's chunks, previously tessellated by 8, and the app's sphere, previously ramped from 1 to 64 between 3 and 1 units
+	std::vector<TessellationSavingsResult> BenchmarkTessellationSavings(float viewportHeight, float edgePixels)
+	{
+		const auto target = MakeTarget(viewportHeight, edgePixels);
+		std::vector<TessellationSavingsResult> results;
+
+		// Terrain's chunks, each grid triangle a patch on the flat plane HS_Terrain sees
+		{
+			const TerrainMaps maps{ TerrainBakeSettings() };
+			const TerrainQuadtree quadtree(maps, TerrainQuadtreeSettings());
+			const auto gridVertices = quadtree.BuildGridVertices();
+			const auto gridIndices = quadtree.BuildGridIndices();
+			const float previousFactor = 8.0f;
+
+			// The app's start, then over the middle, low across a corner and high over an edge
+			const float3 cameras[] =
+			{
+				float3(0.0f, 0.5f, -0.5f),
+				float3(10.0f, 1.0f, 10.0f),
+				float3(0.0f, 4.0f, 0.0f),
+				float3(-15.0f, 0.3f, 15.0f),
+				float3(0.0f, 12.0f, -18.0f),
+			};
+
+			TessellationSavingsResult result = { "terrain chunks", 0, 0, 0.0, 0.0, 0.0, 0.0f, 0.0f, 0.0f, 0.0f };
+			auto segmentEdges = 0.0;
+			auto screenSpaceSegmentPixels = 0.0;
+			auto previousSegmentPixels = 0.0;
+			std::vector<TerrainChunk> chunks;
+			for (const auto& camera : cameras)
+			{
+				quadtree.Select(camera, chunks);
+				auto patches = 0;
+				auto largest = 1.0f;
+				for (const auto& chunk : chunks)
+				{
+					const auto start = quadtree.GetGridIndexStart(chunk.quadrant);
+					const auto end = start + quadtree.GetGridIndexCount(chunk.quadrant);
+					for (auto i = start; i < end; i += 3)
+					{
+						float3 p[3];
+						for (auto corner = 0; corner < 3; corner++)
+						{
+							const auto vertex = quadtree.MorphVertex(chunk, gridVertices[gridIndices[i + corner]], camera);
+							p[corner] = float3(vertex.x, 0.0f, vertex.y);
+						}
+						const auto factors = triangleTessellationFactors(p[0], p[1], p[2], camera, target);
+						const float edgeFactors[3] = { factors.x, factors.y, factors.z };
+						for (auto edge = 0; edge < 3; edge++)
+						{
+							const auto& a = p[(edge + 1) % 3];
+							const auto& b = p[(edge + 2) % 3];
+							const auto pixels = projectedPixels((a + b) * 0.5f, length(b - a), camera, target);
+							// Edges morphed to nothing have no segments to measure
+							if (pixels <= 0.0f) continue;
+							result.screenSpaceMaxSegmentPixels = max(result.screenSpaceMaxSegmentPixels, pixels / edgeFactors[edge]);
+							result.previousMaxSegmentPixels = max(result.previousMaxSegmentPixels, pixels / previousFactor);
+							screenSpaceSegmentPixels += pixels / edgeFactors[edge];
+							previousSegmentPixels += pixels / previousFactor;
+							segmentEdges++;
+						}
+						const auto segments = OddSegments(factors.w);
+						result.screenSpaceTriangles += segments * segments;
+						largest = max(largest, factors.w);
+						patches++;
+					}
+				}
+				const auto uniformSegments = OddSegments(largest);
+				const auto previousSegments = OddSegments(previousFactor);
+				result.uniformTriangles += static_cast<double>(patches) * uniformSegments * uniformSegments;
+				result.previousTriangles += static_cast<double>(patches) * previousSegments * previousSegments;
+				result.patches += patches;
+				result.views++;
+			}
+			result.patches /= result.views;
+			result.screenSpaceMeanSegmentPixels = static_cast<float>(screenSpaceSegmentPixels / segmentEdges);
+			result.previousMeanSegmentPixels = static_cast<float>(previousSegmentPixels / segmentEdges);
+			result.screenSpaceTriangles /= result.views;
+			result.uniformTriangles /= result.views;
+			result.previousTriangles /= result.views;
+			results.push_back(result);
+		}
+
+		// The sphere, one quad patch around it, from in close out along the line to the app's start
+		{
+			const auto centre = float3(2.0f, 2.0f, 1.0f);
+			const auto radius = 0.6f;
+			const auto direction = normalize(float3(0.0f, 0.5f, -0.5f) - centre);
+			const float distances[] = { 0.8f, 1.0f, 1.5f, 2.0f, 2.9f, 4.0f, 6.0f, 10.0f, 20.0f };
+
+			TessellationSavingsResult result = { "sphere", 1, 0, 0.0, 0.0, 0.0, 0.0f, 0.0f, 0.0f, 0.0f };
+			for (const auto distance : distances)
+			{
+				const auto camera = centre + direction * distance;
+				// HS_ViewDependentTessellatedSphere's, around the equator and along the meridians
+				const auto equatorPixels = projectedPixels(centre, 2.0f * Pi * radius, camera, target);
+				const auto meridianPixels = projectedPixels(centre, Pi * radius, camera, target);
+				const auto equator = screenSpaceFactor(equatorPixels, target);
+				const auto meridian = screenSpaceFactor(meridianPixels, target);
+				const auto previous = DistanceRamp(distance);
+
+				result.screenSpaceTriangles += 2.0 * OddSegments(equator) * OddSegments(meridian);
+				const auto uniformSegments = OddSegments(max(equator, meridian));
+				result.uniformTriangles += 2.0 * uniformSegments * uniformSegments;
+				result.previousTriangles += 2.0 * OddSegments(previous) * OddSegments(previous);
+
+				result.screenSpaceMaxSegmentPixels = max(result.screenSpaceMaxSegmentPixels, max(equatorPixels / equator, meridianPixels / meridian));
+				result.previousMaxSegmentPixels = max(result.previousMaxSegmentPixels, equatorPixels / previous);
+				result.screenSpaceMeanSegmentPixels += 0.5f * (equatorPixels / equator + meridianPixels / meridian);
+				result.previousMeanSegmentPixels += 0.5f * (equatorPixels + meridianPixels) / previous;
+				result.views++;
+			}
+			result.screenSpaceTriangles /= result.views;
+			result.uniformTriangles /= result.views;
+			result.previousTriangles /= result.views;
+			result.screenSpaceMeanSegmentPixels /= result.views;
+			result.previousMeanSegmentPixels /= result.views;
+			results.push_back(result);
+		}
+
+		return results;
+	}
+}
+
+void RunTessellationFactorChecks(TestReport& report)
+{
+	const auto result = CheckTessellationCracks(200, 8);
+	report.Expect(result.sharedEdges > 0, "shared edges in the random meshes");
+	report.ExpectZero("shared edges the two triangles give different factor bits", result.crackedEdges);
+	report.ExpectZero("factors outside [1, maxFactor] or insides below an edge", result.badFactors);
+	report.Expect(result.firstPointCrackedEdges > 0, "shared edges first control point factors crack");
+
+	for (const auto& savings : BenchmarkTessellationSavings(1080.0f, 8.0f))
+	{
+		const std::string name(savings.name);
+		report.Expect(savings.screenSpaceTriangles <= savings.uniformTriangles, name + " triangles at most the uniform factor's");
+	}
+}
+
+void RunTessellationFactorBenchmarks()
+{
+	const auto check = CheckTessellationCracks(200, 8);
+	std::printf("%d random meshes from %d cameras each: %lld shared edges, %lld cracked, %lld bad factors, %lld cracked with first control point factors\n",
+		check.meshes, check.cameras, check.sharedEdges, check.crackedEdges, check.badFactors, check.firstPointCrackedEdges);
+
+	std::printf("\n8 pixel segments, triangles per view and segments in pixels, screen-space against the previous factors\n");
+	std::printf("%-5s %-14s %8s %5s %12s %12s %12s %9s %9s %9s %9s\n", "lines", "mesh", "patches", "views", "screen-space", "uniform", "previous", "max", "previous",
+		"mean", "previous");
+	for (const auto viewportHeight : { 720.0f, 1080.0f })
+	{
+		for (const auto& savings : BenchmarkTessellationSavings(viewportHeight, 8.0f))
+		{
+			std::printf("%-5.0f %-14s %8d %5d %12.0f %12.0f %12.0f %9.2f %9.2f %9.2f %9.2f\n", viewportHeight, savings.name, savings.patches, savings.views,
+				savings.screenSpaceTriangles, savings.uniformTriangles, savings.previousTriangles, savings.screenSpaceMaxSegmentPixels,
+				savings.previousMaxSegmentPixels, savings.screenSpaceMeanSegmentPixels, savings.previousMeanSegmentPixels);
+		}
+	}
+}
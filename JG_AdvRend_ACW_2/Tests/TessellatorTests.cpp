@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+#include "Common/TessellationFactor.h"
+#include "Tessellator.h"
+#include "Tests.h"
+
+using namespace HLSL;
+
+namespace
+{
+	struct TessellatorCheck
+	{
+		int patches;					// factor sets tessellated
+		int culled;
+		long long triangles;
+		int badIndices;					// indices past the patch's locations
+		int unusedLocations;			// locations no triangle uses
+		int flippedTriangles;			// triangles anticlockwise in (u, v)
+		// Triangles with no area, which fractional_odd's inside factors of just over 1 leave along the edges
+		int degenerateTriangles;
+		int openEdges;					// edges one triangle uses that are not on the domain's boundary
+		int nonManifoldEdges;			// edges more than two triangles use, or two with the same direction
+		float maxAreaError;				// |sum of the triangles' areas - the domain's| over the domain's
+		// Uniform factor patches without the regular rings' 3 n^2 / 2 triangles, rounded down, or 2 n^2 for quads
+		int irregularUniformPatches;
+		// Edges placed differently from another patch's with the same factor, which would crack the mesh
+		int mismatchedEdgeLocations;
+	};
+
+	const TessellatorPartitioning Partitionings[] =
+	{
+		TessellatorPartitioning::Integer,
+		TessellatorPartitioning::FractionalOdd,
+		TessellatorPartitioning::FractionalEven,
+	};
+
+	TessellationFactors UniformFactors(float factor)
+	{
+		return { { factor, factor, factor, factor }, { factor, factor } };
+	}
+
+	// 16.16 fixed point, as the tessellator places points in
+	std::int32_t ToFixed(float value)
+	{
+		return static_cast<std::int32_t>(value * 65536.0f + 0.5f);
+	}
+
+	// 1D location of a domain location on edge i, or -1 off it
+	float EdgeLocation(TessellatorDomain domain, const float3& location, int edge)
+	{
+		if (domain == TessellatorDomain::Triangle)
+		{
+			const float uvw[3] = { location.x, location.y, location.z };
+			// Along the edge from its start, the corner where the next component is 1
+			return uvw[edge] == 0.0f ? uvw[(edge + 1) % 3] : -1.0f;
+		}
+		switch (edge)
+		{
+		case 0: return location.x == 0.0f ? location.y : -1.0f;
+		case 1: return location.y == 0.0f ? location.x : -1.0f;
+		case 2: return location.x == 1.0f ? location.y : -1.0f;
+		default: return location.y == 1.0f ? location.x : -1.0f;
+		}
+	}
+
+	void CheckPatch(TessellatorDomain domain, TessellatorPartitioning partitioning, const TessellationFactors& factors,
+		std::map<std::pair<int, std::int32_t>, std::vector<float>>& edgeLocations, TessellatorCheck& check)
+	{
+		TessellatedPatch patch;
+		Tessellator::Generate(domain, partitioning, factors, patch);
+		check.patches++;
+
+		TessellationFactors rounded;
+		if (!Tessellator::RoundFactors(domain, partitioning, factors, rounded))
+		{
+			check.culled++;
+			return;
+		}
+
+		const auto locationCount = static_cast<int>(patch.locations.size());
+		std::vector<bool> used(locationCount, false);
+		std::map<std::pair<std::uint32_t, std::uint32_t>, int> directedEdges;
+		auto area = 0.0;
+		for (std::size_t i = 0; i < patch.indices.size(); i += 3)
+		{
+			check.triangles++;
+			const std::uint32_t corners[3] = { patch.indices[i], patch.indices[i + 1], patch.indices[i + 2] };
+			if (corners[0] >= static_cast<std::uint32_t>(locationCount) || corners[1] >= static_cast<std::uint32_t>(locationCount) ||
+				corners[2] >= static_cast<std::uint32_t>(locationCount))
+			{
+				check.badIndices++;
+				continue;
+			}
+			const auto& a = patch.locations[corners[0]];
+			const auto& b = patch.locations[corners[1]];
+			const auto& c = patch.locations[corners[2]];
+			// Clockwise in D3D's sense is anticlockwise with u right and v up
+			const auto doubleArea = static_cast<double>(b.x - a.x) * (c.y - a.y) - static_cast<double>(b.y - a.y) * (c.x - a.x);
+			// Within the rounding of 16.16 fixed point, a unit across a unit long edge, is no area
+			const auto tolerance = 1.0 / 65536.0;
+			if (doubleArea < -tolerance) check.flippedTriangles++;
+			if (std::abs(doubleArea) <= tolerance) check.degenerateTriangles++;
+			area += 0.5 * doubleArea;
+			for (auto corner = 0; corner < 3; corner++)
+			{
+				used[corners[corner]] = true;
+				directedEdges[std::make_pair(corners[corner], corners[(corner + 1) % 3])]++;
+			}
+		}
+		for (const auto isUsed : used) check.unusedLocations += isUsed ? 0 : 1;
+
+		for (const auto& edge : directedEdges)
+		{
+			const auto reverse = directedEdges.find(std::make_pair(edge.first.second, edge.first.first));
+			const auto reverseCount = reverse == directedEdges.end() ? 0 : reverse->second;
+			if (edge.second > 1 || reverseCount > 1) check.nonManifoldEdges++;
+			if (reverseCount > 0) continue;
+
+			// Unshared edges have to lie along one of the domain's
+			auto onBoundary = false;
+			for (auto side = 0; side < (domain == TessellatorDomain::Triangle ? 3 : 4); side++)
+			{
+				onBoundary = onBoundary || (EdgeLocation(domain, patch.locations[edge.first.first], side) >= 0.0f &&
+					EdgeLocation(domain, patch.locations[edge.first.second], side) >= 0.0f);
+			}
+			if (!onBoundary) check.openEdges++;
+		}
+
+		const auto domainArea = domain == TessellatorDomain::Triangle ? 0.5 : 1.0;
+		check.maxAreaError = std::max(check.maxAreaError, static_cast<float>(std::abs(area - domainArea) / domainArea));
+
+		// Each edge's locations against the first patch seen with the same factor on an edge. Only
+		// the outer ring's count, as fractional_odd's inside rings can fall on the edges too.
+		for (auto side = 0; side < (domain == TessellatorDomain::Triangle ? 3 : 4); side++)
+		{
+			std::vector<float> locations;
+			for (auto i = 0; i < patch.outerRingPoints; i++)
+			{
+				const auto along = EdgeLocation(domain, patch.locations[i], side);
+				if (along >= 0.0f) locations.push_back(along);
+			}
+			std::sort(locations.begin(), locations.end());
+			const auto key = std::make_pair(static_cast<int>(partitioning), ToFixed(rounded.edges[side]));
+			const auto seen = edgeLocations.insert(std::make_pair(key, locations));
+			if (!seen.second && seen.first->second != locations) check.mismatchedEdgeLocations++;
+		}
+	}
+
+	// Every integer factor and random fractional ones for both domains and each partitioning
+	TessellatorCheck CheckTessellator(int randomPatches)
+	{
+		TessellatorCheck check = {};
+		std::mt19937 random(5489u);
+		std::uniform_real_distribution<float> factor(0.25f, 70.0f);
+
+		for (const auto domain : { TessellatorDomain::Triangle, TessellatorDomain::Quad })
+		{
+			for (const auto partitioning : Partitionings)
+			{
+				std::map<std::pair<int, std::int32_t>, std::vector<float>> edgeLocations;
+
+				// Uniform factors the partitioning lands on exactly give the regular grid
+				for (auto n = 1; n <= 64; n++)
+				{
+					const auto exact = partitioning == TessellatorPartitioning::Integer ||
+						(partitioning == TessellatorPartitioning::FractionalOdd && (n & 1) && n <= 63) ||
+						(partitioning == TessellatorPartitioning::FractionalEven && !(n & 1));
+					const auto before = check.triangles;
+					CheckPatch(domain, partitioning, UniformFactors(static_cast<float>(n)), edgeLocations, check);
+					const auto expected = domain == TessellatorDomain::Triangle ? 3 * n * n / 2 : 2 * n * n;
+					if (exact && check.triangles - before != expected) check.irregularUniformPatches++;
+				}
+
+				for (auto patch = 0; patch < randomPatches; patch++)
+				{
+					TessellationFactors factors;
+					for (auto& edge : factors.edges)
+					{
+						edge = factor(random);
+						// Whole factors and factors of 1 are common from hull shaders
+						const auto kind = random() % 8;
+						if (kind == 0) edge = std::floor(edge);
+						if (kind == 1) edge = 1.0f;
+					}
+					for (auto& insideFactor : factors.inside) insideFactor = random() % 8 == 0 ? 1.0f : factor(random);
+					if (random() % 64 == 0) factors.edges[random() % 3] = random() % 2 ? 0.0f : std::nanf("");
+					CheckPatch(domain, partitioning, factors, edgeLocations, check);
+				}
+			}
+		}
+		return check;
+	}
+
+	struct TessellatorBenchmarkResult
+	{
+		const char* name;
+		int patches;
+		long long triangles;
+		double generateTrianglesPerSecond;	// uncached, one thread
+		double cachedTrianglesPerSecond;	// TessellatePatches with a domain function, cache warm, every thread
+		int distinctPatches;				// factor sets the cache held
+		int threads;
+	};
+
+	// Terrain's grid with HS_Terrain's factors, the sphere's patch from 1 to 20 units away and random factors
+	std::vector<TessellatorBenchmarkResult> BenchmarkTessellator()
+	{
+		const auto seconds = [](std::chrono::steady_clock::time_point startTime)
+		{
+			return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+		};
+
+		struct Scene
+		{
+			const char* name;
+			TessellatorDomain domain;
+			TessellatorPartitioning partitioning;
+			std::vector<TessellationFactors> factors;
+			std::vector<float3> corners;			// three or four per patch
+		};
+		std::vector<Scene> scenes;
+
+		// Leaves of Terrain's 40 x 40 plane, 128 x 128 cells of two triangles, from the app's start
+		{
+			Scene scene = { "terrain grid", TessellatorDomain::Triangle, TessellatorPartitioning::FractionalOdd, {}, {} };
+			const TessellationTarget target = { 540.0f / std::tan(35.0f * 3.14159265f / 180.0f), 8.0f, 64.0f };
+			const auto camera = float3(0.0f, 0.5f, -0.5f);
+			const auto cells = 128;
+			const auto cellSize = 40.0f / cells;
+			for (auto z = 0; z < cells; z++)
+			{
+				for (auto x = 0; x < cells; x++)
+				{
+					const auto corner = float3(-20.0f + x * cellSize, 0.0f, -20.0f + z * cellSize);
+					const float3 quad[4] = { corner, corner + float3(0.0f, 0.0f, cellSize), corner + float3(cellSize, 0.0f, cellSize), corner + float3(cellSize, 0.0f, 0.0f) };
+					const int triangles[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+					for (const auto& triangle : triangles)
+					{
+						const auto f = triangleTessellationFactors(quad[triangle[0]], quad[triangle[1]], quad[triangle[2]], camera, target);
+						scene.factors.push_back({ { f.x, f.y, f.z, 0.0f }, { f.w, 0.0f } });
+						for (const auto corner : triangle) scene.corners.push_back(quad[corner]);
+					}
+				}
+			}
+			scenes.push_back(scene);
+		}
+
+		// HS_ViewDependentTessellatedSphere's patch from 1 to 20 units, 4096 distances
+		{
+			Scene scene = { "sphere", TessellatorDomain::Quad, TessellatorPartitioning::FractionalOdd, {}, {} };
+			const TessellationTarget target = { 540.0f / std::tan(35.0f * 3.14159265f / 180.0f), 8.0f, 64.0f };
+			const auto radius = 0.6f;
+			for (auto i = 0; i < 4096; i++)
+			{
+				const auto distance = 1.0f + 19.0f * i / 4095.0f;
+				const auto centre = float3(0.0f, 0.0f, distance);
+				const auto meridian = screenSpaceFactor(projectedPixels(centre, 3.14159265f * radius, float3(0.0f, 0.0f, 0.0f), target), target);
+				const auto equator = screenSpaceFactor(projectedPixels(centre, 6.28318530f * radius, float3(0.0f, 0.0f, 0.0f), target), target);
+				scene.factors.push_back({ { meridian, 1.0f, meridian, 1.0f }, { equator, meridian } });
+				for (auto corner = 0; corner < 4; corner++) scene.corners.push_back(float3(radius, 0.0f, 0.0f));
+			}
+			scenes.push_back(scene);
+		}
+
+		// Random factors, every patch its own
+		{
+			Scene scene = { "random triangles", TessellatorDomain::Triangle, TessellatorPartitioning::Integer, {}, {} };
+			std::mt19937 random(5489u);
+			std::uniform_real_distribution<float> factor(1.0f, 64.0f);
+			for (auto i = 0; i < 4096; i++)
+			{
+				scene.factors.push_back({ { factor(random), factor(random), factor(random), 0.0f }, { factor(random), 0.0f } });
+				scene.corners.push_back(float3(0.0f, 0.0f, 0.0f));
+				scene.corners.push_back(float3(0.0f, 0.0f, 1.0f));
+				scene.corners.push_back(float3(1.0f, 0.0f, 0.0f));
+			}
+			scenes.push_back(scene);
+		}
+
+		std::vector<TessellatorBenchmarkResult> results;
+		for (const auto& scene : scenes)
+		{
+			TessellatorBenchmarkResult result = { scene.name, static_cast<int>(scene.factors.size()), 0, 0.0, 0.0, 0, ResolveThreadCount(0) };
+			const auto cornerCount = scene.domain == TessellatorDomain::Triangle ? 3 : 4;
+
+			TessellatedPatch patch;
+			auto startTime = std::chrono::steady_clock::now();
+			for (const auto& factors : scene.factors)
+			{
+				Tessellator::Generate(scene.domain, scene.partitioning, factors, patch);
+				result.triangles += static_cast<long long>(patch.indices.size() / 3);
+			}
+			result.generateTrianglesPerSecond = result.triangles / seconds(startTime);
+
+			// The domain shaders: DS_Terrain's interpolation of the flat triangle and
+			// DS_ViewDependentTessellatedSphere's sphere
+			Tessellator tessellator(scene.domain, scene.partitioning);
+			const auto factorsOf = [&](int i) { return scene.factors[i]; };
+			const auto domainOf = [&](int i, const float3& location)
+			{
+				const auto* corners = &scene.corners[i * cornerCount];
+				if (cornerCount == 3) return corners[0] * location.x + corners[1] * location.y + corners[2] * location.z;
+				const auto u = location.x * 6.28318530f;
+				const auto v = location.y * 3.14159265f;
+				return corners[0].x * float3(std::cos(u) * std::sin(v), std::sin(u) * std::sin(v), std::cos(v));
+			};
+			TessellatedMesh<float3> mesh;
+			tessellator.TessellatePatches(result.patches, factorsOf, domainOf, mesh);
+			result.distinctPatches = tessellator.GetCachedPatchCount();
+
+			const auto repeats = 3;
+			startTime = std::chrono::steady_clock::now();
+			for (auto repeat = 0; repeat < repeats; repeat++) tessellator.TessellatePatches(result.patches, factorsOf, domainOf, mesh);
+			result.cachedTrianglesPerSecond = repeats * (mesh.indices.size() / 3) / seconds(startTime);
+			results.push_back(result);
+		}
+		return results;
+	}
+}
+
+void RunTessellatorChecks(TestReport& report)
+{
+	const auto check = CheckTessellator(2000);
+	report.Expect(check.triangles > 0, "triangles over every uniform and random factor set");
+	report.ExpectZero("indices past the patch's locations", check.badIndices);
+	report.ExpectZero("locations no triangle uses", check.unusedLocations);
+	report.ExpectZero("triangles anticlockwise in (u, v)", check.flippedTriangles);
+	report.ExpectZero("open edges inside the domain", check.openEdges);
+	report.ExpectZero("non-manifold edges", check.nonManifoldEdges);
+	report.ExpectAtMost("summed triangle area error over the domain's", check.maxAreaError, 1e-5);
+	report.ExpectZero("uniform factor patches without the regular rings", check.irregularUniformPatches);
+	report.ExpectZero("edges placed differently from another patch's with the same factor", check.mismatchedEdgeLocations);
+	report.ExpectAtMost("fraction of triangles with no area", static_cast<double>(check.degenerateTriangles) / check.triangles, 0.01);
+}
+
+void RunTessellatorBenchmarks()
+{
+	const auto check = CheckTessellator(20000);
+	std::printf("%d factor sets, %d culled, %lld triangles, %d degenerate, %d flipped, %d open edges, %d non-manifold, %d mismatched edges, area error %g\n",
+		check.patches, check.culled, check.triangles, check.degenerateTriangles, check.flippedTriangles, check.openEdges, check.nonManifoldEdges,
+		check.mismatchedEdgeLocations, check.maxAreaError);
+
+	std::printf("\ntriangles in millions a second\n");
+	std::printf("%-16s %7s %10s %9s %7s %8s %7s\n", "case", "patches", "triangles", "generated", "cached", "distinct", "threads");
+	for (const auto& result : BenchmarkTessellator())
+	{
+		std::printf("%-16s %7d %10lld %9.1f %7.1f %8d %7d\n", result.name, result.patches, result.triangles, result.generateTrianglesPerSecond / 1e6,
+			result.cachedTrianglesPerSecond / 1e6, result.distinctPatches, result.threads);
+	}
+}
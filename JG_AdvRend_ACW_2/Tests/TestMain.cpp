@@ -0,0 +1,84 @@
+#include <cstdio>
+#include <cstring>
+#include "Tests.h"
+
+namespace
+{
+	struct TestModule
+	{
+		const char* name;
+		void (*checks)(TestReport& report);
+		void (*benchmarks)();
+	};
+
+	const TestModule modules[] =
+	{
+		{ "BezierPatch", RunBezierPatchChecks, RunBezierPatchBenchmarks },
+		{ "HeightfieldTracer", RunHeightfieldTracerChecks, RunHeightfieldTracerBenchmarks },
+		{ "IntegerNoise", RunIntegerNoiseChecks, RunIntegerNoiseBenchmarks },
+		{ "NebulaVolume", RunNebulaVolumeChecks, RunNebulaVolumeBenchmarks },
+		{ "NoiseSIMD", RunNoiseSIMDChecks, RunNoiseSIMDBenchmarks },
+		{ "PatchCulling", RunPatchCullingChecks, RunPatchCullingBenchmarks },
+		{ "SDFBrickMap", RunSDFBrickMapChecks, RunSDFBrickMapBenchmarks },
+		{ "SDFConePrepass", RunSDFConePrepassChecks, RunSDFConePrepassBenchmarks },
+		{ "SDFDepthBounding", RunSDFDepthBoundingChecks, RunSDFDepthBoundingBenchmarks },
+		{ "SDFFractalLOD", RunSDFFractalLODChecks, RunSDFFractalLODBenchmarks },
+		{ "SDFMeshExtractor", RunSDFMeshExtractorChecks, RunSDFMeshExtractorBenchmarks },
+		{ "SDFNormals", RunSDFNormalsChecks, RunSDFNormalsBenchmarks },
+		{ "SDFOcclusion", RunSDFOcclusionChecks, RunSDFOcclusionBenchmarks },
+		{ "SDFProxyGeometry", RunSDFProxyGeometryChecks, RunSDFProxyGeometryBenchmarks },
+		{ "SDFRayMarcher", RunSDFRayMarcherChecks, RunSDFRayMarcherBenchmarks },
+		{ "SDFRepetition", RunSDFRepetitionChecks, RunSDFRepetitionBenchmarks },
+		{ "SDFReprojectionCache", RunSDFReprojectionCacheChecks, RunSDFReprojectionCacheBenchmarks },
+		{ "SDFSceneGraph", RunSDFSceneGraphChecks, RunSDFSceneGraphBenchmarks },
+		{ "SDFStepHeatmap", RunSDFStepHeatmapChecks, RunSDFStepHeatmapBenchmarks },
+		{ "SDFTilePruning", RunSDFTilePruningChecks, RunSDFTilePruningBenchmarks },
+		{ "TerrainBaker", RunTerrainBakerChecks, RunTerrainBakerBenchmarks },
+		{ "TerrainQuadtree", RunTerrainQuadtreeChecks, RunTerrainQuadtreeBenchmarks },
+		{ "TerrainTileService", RunTerrainTileServiceChecks, RunTerrainTileServiceBenchmarks },
+		{ "TessellationFactor", RunTessellationFactorChecks, RunTessellationFactorBenchmarks },
+		{ "Tessellator", RunTessellatorChecks, RunTessellatorBenchmarks },
+	};
+
+	int Usage()
+	{
+		std::printf("usage: JG_AdvRend_ACW_2Tests check|benchmark [all|module]\nmodules:");
+		for (const auto& module : modules) std::printf(" %s", module.name);
+		std::printf("\n");
+		return 2;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2 || argc > 3) return Usage();
+	const auto check = std::strcmp(argv[1], "check") == 0;
+	if (!check && std::strcmp(argv[1], "benchmark") != 0) return Usage();
+	const auto* name = argc == 3 ? argv[2] : "all";
+
+	auto ran = 0;
+	auto failures = 0;
+	for (const auto& module : modules)
+	{
+		if (std::strcmp(name, "all") != 0 && std::strcmp(name, module.name) != 0) continue;
+		ran++;
+
+		const auto startTime = std::chrono::steady_clock::now();
+		if (check)
+		{
+			TestReport report(module.name);
+			module.checks(report);
+			failures += report.GetFailureCount();
+			std::printf("%s: %d of %d expectations met, %.0f ms\n", module.name, report.GetExpectationCount() - report.GetFailureCount(), report.GetExpectationCount(), MillisecondsSince(startTime));
+		}
+		else
+		{
+			std::printf("== %s\n", module.name);
+			module.benchmarks();
+			std::printf("%.1f s\n\n", MillisecondsSince(startTime) / 1000.0);
+		}
+	}
+
+	if (ran == 0) return Usage();
+	return failures == 0 ? 0 : 1;
+}
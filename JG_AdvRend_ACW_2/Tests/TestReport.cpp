@@ -0,0 +1,40 @@
+#include "TestReport.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+TestReport::TestReport(const std::string& module) : _module(module), _expectations(0), _failures(0)
+{
+}
+
+void TestReport::Expect(bool passed, const std::string& description)
+{
+	_expectations++;
+	if (passed) return;
+
+	_failures++;
+	std::printf("FAILED %s: %s\n", _module.c_str(), description.c_str());
+}
+
+void TestReport::ExpectZero(const std::string& description, long long count)
+{
+	Expect(count == 0, description + " is " + std::to_string(count) + ", expected 0");
+}
+
+void TestReport::ExpectAtMost(const std::string& description, double value, double limit)
+{
+	Expect(value <= limit, description + " is " + std::to_string(value) + ", expected at most " + std::to_string(limit));
+}
+
+double MillisecondsSince(std::chrono::steady_clock::time_point startTime)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+std::string ReadAppFile(const std::string& path)
+{
+	std::ifstream file(std::string(APP_DIR) + "/" + path);
+	std::ostringstream contents;
+	contents << file.rdbuf();
+	return contents.str();
+}
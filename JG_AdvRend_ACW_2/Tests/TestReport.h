@@ -0,0 +1,28 @@
+#pragma once
+#include <chrono>
+#include <string>
+
+// Counts one module's failed expectations, printing each one
+class TestReport
+{
+public: // Structors
+	explicit TestReport(const std::string& module);
+
+public: // Accessors
+	int GetExpectationCount() const { return _expectations; }
+	int GetFailureCount() const { return _failures; }
+
+public: // Functions
+	void Expect(bool passed, const std::string& description);
+	void ExpectZero(const std::string& description, long long count);
+	void ExpectAtMost(const std::string& description, double value, double limit);
+
+private: // Data
+	std::string _module;
+	int _expectations;
+	int _failures;
+};
+
+double MillisecondsSince(std::chrono::steady_clock::time_point startTime);
+// A file of the app's project, such as a shader, empty when it can't be read
+std::string ReadAppFile(const std::string& path);
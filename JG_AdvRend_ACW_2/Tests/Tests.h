@@ -0,0 +1,55 @@
+#pragma once
+#include "TestReport.h"
+
+// Each module's checks, run by ctest, and its benchmarks, which print the tables the
+// commits that added them quote
+void RunBezierPatchChecks(TestReport& report);
+void RunBezierPatchBenchmarks();
+void RunHeightfieldTracerChecks(TestReport& report);
+void RunHeightfieldTracerBenchmarks();
+void RunIntegerNoiseChecks(TestReport& report);
+void RunIntegerNoiseBenchmarks();
+void RunNebulaVolumeChecks(TestReport& report);
+void RunNebulaVolumeBenchmarks();
+void RunNoiseSIMDChecks(TestReport& report);
+void RunNoiseSIMDBenchmarks();
+void RunPatchCullingChecks(TestReport& report);
+void RunPatchCullingBenchmarks();
+void RunSDFBrickMapChecks(TestReport& report);
+void RunSDFBrickMapBenchmarks();
+void RunSDFConePrepassChecks(TestReport& report);
+void RunSDFConePrepassBenchmarks();
+void RunSDFDepthBoundingChecks(TestReport& report);
+void RunSDFDepthBoundingBenchmarks();
+void RunSDFFractalLODChecks(TestReport& report);
+void RunSDFFractalLODBenchmarks();
+void RunSDFMeshExtractorChecks(TestReport& report);
+void RunSDFMeshExtractorBenchmarks();
+void RunSDFNormalsChecks(TestReport& report);
+void RunSDFNormalsBenchmarks();
+void RunSDFOcclusionChecks(TestReport& report);
+void RunSDFOcclusionBenchmarks();
+void RunSDFProxyGeometryChecks(TestReport& report);
+void RunSDFProxyGeometryBenchmarks();
+void RunSDFRayMarcherChecks(TestReport& report);
+void RunSDFRayMarcherBenchmarks();
+void RunSDFRepetitionChecks(TestReport& report);
+void RunSDFRepetitionBenchmarks();
+void RunSDFReprojectionCacheChecks(TestReport& report);
+void RunSDFReprojectionCacheBenchmarks();
+void RunSDFSceneGraphChecks(TestReport& report);
+void RunSDFSceneGraphBenchmarks();
+void RunSDFStepHeatmapChecks(TestReport& report);
+void RunSDFStepHeatmapBenchmarks();
+void RunSDFTilePruningChecks(TestReport& report);
+void RunSDFTilePruningBenchmarks();
+void RunTerrainBakerChecks(TestReport& report);
+void RunTerrainBakerBenchmarks();
+void RunTerrainQuadtreeChecks(TestReport& report);
+void RunTerrainQuadtreeBenchmarks();
+void RunTerrainTileServiceChecks(TestReport& report);
+void RunTerrainTileServiceBenchmarks();
+void RunTessellationFactorChecks(TestReport& report);
+void RunTessellationFactorBenchmarks();
+void RunTessellatorChecks(TestReport& report);
+void RunTessellatorBenchmarks();